@@ -15,8 +15,15 @@ app.use(express.urlencoded({ extended: true }));
 // (instead of piping through a streaming compressor) lets us set a real
 // Content-Length instead of Transfer-Encoding: chunked, matching ConfigServer.cpp's
 // send_P(), which always knows the final gzipped length up front.
+// Shared files referenced by <link rel="stylesheet" href="x.css"> / <script src="x.js">
+// are inlined first, as the build step does.
 function gzipPage(filename) {
-    return zlib.gzipSync(fs.readFileSync(__dirname + '/' + filename), { level: 9 });
+    const html = fs.readFileSync(__dirname + '/' + filename, 'utf8')
+        .replace(/<link rel="stylesheet" href="([\w.-]+\.css)">/g,
+                 (m, f) => '<style>' + fs.readFileSync(__dirname + '/' + f, 'utf8') + '</style>')
+        .replace(/<script src="([\w.-]+\.js)"><\/script>/g,
+                 (m, f) => '<script>' + fs.readFileSync(__dirname + '/' + f, 'utf8') + '</script>');
+    return zlib.gzipSync(html, { level: 9 });
 }
 
 const gzippedPages = {
@@ -36,6 +43,8 @@ function sendGzippedPage(res, buf) {
 
 // Mock state data (simulates NVS storage on ESP32)
 let mockState = {
+    // Runtime log category mask (LogTags.h)
+    logMask: ['general', 'setup', 'state', 'status', 'sensor', 'network'],
     // WiFi settings
     ssid: 'MyWiFi',
     password: 'password123',
@@ -160,6 +169,20 @@ app.get('/wifi/networks', (req, res) => {
     res.json(mockState.storedNetworks);
 });
 
+// GET /wifi/scan — cached nearby networks (matches WiFiManager's ScanCache)
+let mockScan = { doneAt: 0, until: 0 };   // last scan finished / in-flight scan ends
+app.get('/wifi/scan', (req, res) => {
+    const now = Date.now();
+    if (mockScan.until && now >= mockScan.until) { mockScan.doneAt = mockScan.until; mockScan.until = 0; }
+    if (!mockScan.until && (req.query.refresh === '1' || now - mockScan.doneAt > 30000)) mockScan.until = now + 3000;
+    const networks = [
+        { ssid: 'MarinaGuest', rssi: -58, channel: 6, open: true },
+        { ssid: mockState.ssid || 'DockWiFi', rssi: -64, channel: 11, open: false },
+        { ssid: 'Slip42', rssi: -79, channel: 1, open: false },
+    ].map(n => ({ ...n, stored: mockState.storedNetworks.includes(n.ssid) }));
+    res.json({ scanning: !!mockScan.until, ageMs: mockScan.doneAt ? now - mockScan.doneAt : null, networks: mockScan.doneAt ? networks : [] });
+});
+
 // POST /wifi/remove — remove a stored network by SSID
 app.post('/wifi/remove', (req, res) => {
     const ssid = req.body.ssid;
@@ -193,9 +216,79 @@ app.get('/debug/init', (req, res) => {
             level_cm: mockState.currentLevel_cm,
         },
         calibration,
+        logMask: logMaskJson(),
+        notifyLatency: {
+            SMS: {
+                queue:   { n: 4, p50: 64,   p95: 97,    max: 97,    b: [0, 1, 2, 1] },
+                deliver: { n: 4, p50: 2048, p95: 21000, max: 21000, b: [0, 0, 0, 0, 0, 0, 0, 2, 1, 0, 0, 1] },
+                send:    { n: 5, p50: 2048, p95: 10012, max: 10012, b: [0, 0, 0, 0, 0, 0, 0, 3, 1, 0, 1] },
+            },
+            Discord: {
+                queue:   { n: 4, p50: 64,  p95: 101, max: 101, b: [0, 1, 2, 1] },
+                deliver: { n: 4, p50: 433, p95: 433, max: 433, b: [0, 0, 0, 0, 1, 3] },
+                send:    { n: 4, p50: 380, p95: 380, max: 380, b: [0, 0, 0, 0, 1, 3] },
+            },
+        },
+        loopProfile: {
+            iter: { n: 91234, min: 2, mean: 61, p95: 128, max: 182004, b: [1802, 20511, 41090, 17870, 6011, 3104, 712, 98, 21, 9, 3, 2, 1, 0, 1, 0, 0, 1] },
+            budget_pct: 1.8,
+            worst: { us: 182004, at: 40512, s: { mqtt: 180950, light: 12 } },
+            s: {
+                control:   { n: 91234, min: 18, mean: 41, p95: 64, max: 2210 },
+                sensor:    { n: 91234, min: 1, mean: 3, p95: 4, max: 38 },
+                state:     { n: 91234, min: 9, mean: 22, p95: 32, max: 410 },
+                mqtt:      { n: 45617, min: 3, mean: 18, p95: 32, max: 180950 },
+                light:     { n: 45617, min: 1, mean: 2, p95: 4, max: 14 },
+                wifi:      { n: 1825, min: 4, mean: 9, p95: 16, max: 121 },
+                rtc:       { n: 912, min: 2, mean: 4, p95: 8, max: 88012 },
+                ota:       { n: 912, min: 1, mean: 1, p95: 2, max: 6 },
+                status:    { n: 91, min: 1910, mean: 2305, p95: 4096, max: 5120 },
+                telemetry: { n: 15, min: 3402, mean: 4110, p95: 8192, max: 9840 },
+                serialize: { n: 15, min: 1208, mean: 1490, p95: 2048, max: 2101 },
+                backfill:  { n: 912, min: 1, mean: 2, p95: 4, max: 11 },
+            },
+        },
     });
 });
 
+// ============================================================================
+// LOG MASK ENDPOINTS
+// ============================================================================
+
+const LOG_TAGS = ['general', 'setup', 'state', 'status', 'sensor', 'network'];
+
+function logMaskJson() {
+    const m = mockState.logMask;
+    return {
+        mask: m.length === LOG_TAGS.length ? 'all' : (m.length ? m.join(',') : 'none'),
+        default: 'all',
+        revert_s: 0,
+        tags: LOG_TAGS,
+    };
+}
+
+app.get('/debug/log-mask', (req, res) => res.json(logMaskJson()));
+
+app.post('/debug/log-mask', (req, res) => {
+    let mask = mockState.logMask.slice();
+    let absolute = false;
+    for (const tok of String(req.body.mask || '').split(/[ ,]+/).filter(Boolean)) {
+        const op = tok[0] === '+' || tok[0] === '-' ? tok[0] : '';
+        const name = op ? tok.slice(1) : tok;
+        const set = name === 'all' || name === 'default' ? LOG_TAGS : name === 'none' ? [] : [name];
+        if (set.length === 1 && !LOG_TAGS.includes(name)) {
+            return res.status(400).json({ error: 'Unknown log category' });
+        }
+        if (op === '+') mask = [...new Set([...mask, ...set])];
+        else if (op === '-') mask = mask.filter(t => !set.includes(t));
+        else if (set.length !== 1) { mask = set.slice(); absolute = true; }
+        else { if (!absolute) mask = []; absolute = true; mask = [...new Set([...mask, ...set])]; }
+    }
+    mockState.logMask = LOG_TAGS.filter(t => mask.includes(t));
+    console.log(`[LOG] Category mask: ${logMaskJson().mask}`);
+    res.json({ success: true, message: 'Log mask updated', mask: logMaskJson().mask, revert_s: Number(req.body.for) || 0 });
+});
+
 // ============================================================================
 // SENSOR READING ENDPOINTS
 // ============================================================================
@@ -210,6 +303,33 @@ app.get('/read', (req, res) => {
     });
 });
 
+// Live reading stream (Server-Sent Events), one frame per interval_ms
+app.get('/events', (req, res) => {
+    const interval = Math.min(10000, Math.max(100, parseInt(req.query.interval_ms, 10) || 500));
+    res.writeHead(200, {
+        'Content-Type': 'text/event-stream',
+        'Cache-Control': 'no-cache',
+        'Connection': 'keep-alive',
+    });
+    res.write('retry: 2000\n\n');
+    const timer = setInterval(() => {
+        const event = {
+            sensorAvailable: true,
+            channel: 0,
+            valid: mockState.sensorValid,
+            millivolts: mockState.currentMillivolts + (Math.random() - 0.5) * 4,
+            level_cm: mockState.currentLevel_cm,
+            rate_cm_30min: mockState.rate_cm_30min,
+            sample_ms: Date.now() % 4294967296,
+            state: 'CONFIG',
+            notifier: { pending: 0, dropped: 0 },
+            rssi: -55,
+        };
+        res.write(`data: ${JSON.stringify(event)}\n\n`);
+    }, interval);
+    req.on('close', () => clearInterval(timer));
+});
+
 // ============================================================================
 // CALIBRATION ENDPOINTS
 // ============================================================================
@@ -283,7 +403,7 @@ app.post('/emergency/urgent-level', (req, res) => {
 
 app.post('/emergency/test-pin', (req, res) => {
     console.log('[TEST] Emergency pin test requested');
-    res.json({ success: true, message: 'Emergency pin test completed (2 second pulse)' });
+    res.json({ success: true, message: 'Emergency pin test started (2 second pulse)' });
 });
 
 // ============================================================================
@@ -357,16 +477,31 @@ app.post('/notifications/mqtt', (req, res) => {
     res.json({ success: true });
 });
 
+// Test sends are queued on the device's notifier task and polled by id
+let testId = 0;
+let testDoneAt = 0;
+function startTest(res) {
+    testId++;
+    testDoneAt = Date.now() + 2000;
+    res.status(202).json({ success: true, pending: true, id: testId });
+}
+
 app.post('/notifications/test/sms', (req, res) => {
     if (!mockState.hasPhoneNumber) { res.status(400).json({ error: 'No phone number configured' }); return; }
     console.log(`[TEST] Sending test SMS to ${mockState.phoneNumber}`);
-    res.json({ success: true, message: 'Test SMS sent successfully!' });
+    startTest(res);
 });
 
 app.post('/notifications/test/discord', (req, res) => {
     if (!mockState.hasDiscordWebhook) { res.status(400).json({ error: 'No Discord webhook configured' }); return; }
     console.log(`[TEST] Sending test Discord message`);
-    res.json({ success: true, message: 'Test Discord message sent successfully!' });
+    startTest(res);
+});
+
+app.get('/notifications/test/status', (req, res) => {
+    if (parseInt(req.query.id, 10) !== testId) { res.status(404).json({ error: 'Unknown test id' }); return; }
+    if (Date.now() < testDoneAt) { res.json({ success: true, pending: true, id: testId }); return; }
+    res.json({ success: true, pending: false, message: 'Test message sent!' });
 });
 
 app.post('/notifications/test/mqtt', (req, res) => {
@@ -0,0 +1,68 @@
+#pragma once
+
+/*
+    AlertFormatter.h
+
+    Owner-facing notification text for state-machine events. The state
+    machine only reports typed events (StateMachineEventRecord); the
+    NotificationWorker task calls formatAlert() on Core 0 just before
+    delivery, so loop() never builds message strings on its stack.
+
+    Every message is prefixed "[MSG:<traceId>]" so an alert seen on a phone
+    can be matched to the MQTT log line that raised it.
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "StateMachine.h"
+
+// True for events that produce an owner notification.
+inline bool alertHasMessage(StateMachineEvent type) {
+    return type == SM_EVENT_EMERGENCY || type == SM_EVENT_SENSOR_FAILURE ||
+           type == SM_EVENT_SENSOR_RECOVERED || type == SM_EVENT_SILENCED;
+}
+
+// Writes the message for `ev` into buf (always NUL-terminated when len > 0).
+// Returns the snprintf-style length, or 0 for events with no owner message
+// (SM_EVENT_UNSILENCED is logged only).
+inline int formatAlert(char* buf, size_t len, const StateMachineEventRecord& ev, uint32_t traceId) {
+    if (len == 0) return 0;
+    buf[0] = '\0';
+
+    switch (ev.type) {
+        case SM_EVENT_EMERGENCY: {
+            const StateMachineEventRecord::Emergency& e = ev.emergency;
+            char ratePart[28] = "";
+            if (!e.sensorFault && !isnan(e.rate_cm30min)) {
+                snprintf(ratePart, sizeof(ratePart), " (%+.1f cm/30min)", e.rate_cm30min);
+            }
+            const char* sensorNote = e.sensorFault ? " — SENSOR FAULT (level stale)" : "";
+            char compartmentPart[20] = "";
+            if (ev.compartmentCount > 1) {
+                snprintf(compartmentPart, sizeof(compartmentPart), " in compartment %u",
+                         (unsigned)ev.compartment + 1);
+            }
+            return snprintf(buf, len, e.urgent
+                                ? "[MSG:%u] BilgeRise URGENT Alert: Tier 2 Emergency Level %.2f cm%s%s%s"
+                                : "[MSG:%u] BilgeRise Alert: Emergency Level %.2f cm%s%s%s",
+                            (unsigned)traceId, e.level_cm, compartmentPart, ratePart, sensorNote);
+        }
+        case SM_EVENT_SENSOR_FAILURE:
+            return snprintf(buf, len,
+                            "[MSG:%u] BilgeRise: Sensor failure — no valid reading for %us. "
+                            "Flood detection is OFFLINE; device needs inspection.",
+                            (unsigned)traceId, (unsigned)ev.sensorFailure.downSeconds);
+        case SM_EVENT_SENSOR_RECOVERED:
+            return snprintf(buf, len,
+                            "[MSG:%u] BilgeRise: Sensor recovered — water-level monitoring restored.",
+                            (unsigned)traceId);
+        case SM_EVENT_SILENCED:
+            return snprintf(buf, len, "[MSG:%u] BilgeRise: Emergency alerts silenced", (unsigned)traceId);
+        default:
+            return 0;
+    }
+}
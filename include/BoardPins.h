@@ -24,3 +24,4 @@ static constexpr int ALERT_PIN    = 26; // Emergency horn/alert output
 static constexpr int LIGHT_PIN    = 12; // Status LED (LightCode patterns)
 static constexpr int I2C_SDA_PIN  = 21; // ADS1115 water-level sensor
 static constexpr int I2C_SCL_PIN  = 22; // ADS1115 water-level sensor
+static constexpr int ADS_ALERT_PIN = 4;  // ADS1115 ALERT/RDY (open-drain, INPUT_PULLUP, ISR)
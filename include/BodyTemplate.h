@@ -0,0 +1,300 @@
+#pragma once
+
+/*
+    BodyTemplate.h
+
+    Compiled CustomChannel body template. compile() parses the stored
+    template once (at loadCache) into a list of segments: literal spans that
+    point into the template text, and typed placeholders
+
+        {{message}}    notification text
+        {{level}}      water level, cm (2 dp)
+        {{rate}}       level trend, cm / 30 min (2 dp)
+        {{state}}      state-machine state, e.g. "EMERGENCY"
+        {{device_id}}  "boat-xxxxxx"
+        {{timestamp}}  unix seconds (0 until the clock is set)
+
+    Unknown {{names}} are kept as literal text. Placeholder values are
+    escaped for the content type (JSON string / form / raw) as they are
+    emitted; literals never are. A missing level or rate renders as "null"
+    in JSON and as nothing otherwise.
+
+    Reader renders the body in caller-sized pieces without building it in
+    memory, so the HTTP request streams straight from the template and the
+    message has no escape-buffer size cap. length() walks the segments once
+    for the Content-Length header. The context (and the template text) must
+    stay unchanged while a Reader is in use.
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// Values for the placeholders, snapshotted once per send.
+struct TemplateContext {
+    const char* message   = "";
+    float       level_cm  = NAN;
+    float       rate_cm_30min = NAN;
+    const char* state     = "";
+    const char* deviceId  = "";
+    uint32_t    timestamp = 0;
+};
+
+class BodyTemplate {
+public:
+    static constexpr uint8_t MAX_SEGMENTS = 24;
+    static constexpr size_t  VALUE_MAX    = 24;   // formatted number
+
+    enum Escape : uint8_t { ESCAPE_RAW, ESCAPE_JSON, ESCAPE_FORM };
+    enum Field : uint8_t {
+        FIELD_LITERAL,
+        FIELD_MESSAGE,
+        FIELD_LEVEL,
+        FIELD_RATE,
+        FIELD_STATE,
+        FIELD_DEVICE_ID,
+        FIELD_TIMESTAMP,
+    };
+
+    struct Segment {
+        Field    field;
+        uint16_t offset;   // FIELD_LITERAL: span within the template text
+        uint16_t len;
+    };
+
+    BodyTemplate() : text(""), count(0), escape(ESCAPE_RAW) {}
+
+    // Escape mode from a Content-Type header value.
+    static Escape escapeFor(const char* contentType) {
+        if (!contentType) return ESCAPE_RAW;
+        if (strstr(contentType, "json") || strstr(contentType, "JSON")) return ESCAPE_JSON;
+        if (strstr(contentType, "form") || strstr(contentType, "urlencoded")) return ESCAPE_FORM;
+        return ESCAPE_RAW;
+    }
+
+    // tmpl must outlive this object (literal segments point into it). A
+    // template with more than MAX_SEGMENTS pieces keeps the rest as one
+    // trailing literal.
+    void compile(const char* tmpl, Escape esc) {
+        text = tmpl ? tmpl : "";
+        escape = esc;
+        count = 0;
+        size_t pos = 0;
+        size_t litStart = 0;
+        size_t n = strlen(text);
+        while (pos < n) {
+            const char* open = strstr(text + pos, "{{");
+            if (!open) break;
+            const char* close = strstr(open + 2, "}}");
+            if (!close) break;
+            size_t at = (size_t)(open - text);
+            Field f = lookup(open + 2, (size_t)(close - open - 2));
+            pos = (size_t)(close - text) + 2;
+            if (f == FIELD_LITERAL) continue;
+            // Leading literal + placeholder, and room for a trailing literal
+            if (count + 3 > MAX_SEGMENTS) {
+                pos = at;
+                break;
+            }
+            addLiteral(litStart, at);
+            segs[count].field = f;
+            segs[count].offset = 0;
+            segs[count].len = 0;
+            count++;
+            litStart = pos;
+        }
+        addLiteral(litStart, n);
+    }
+
+    uint8_t segmentCount() const { return count; }
+    const Segment& segment(uint8_t i) const { return segs[i]; }
+
+    bool hasPlaceholder() const {
+        for (uint8_t i = 0; i < count; i++) {
+            if (segs[i].field != FIELD_LITERAL) return true;
+        }
+        return false;
+    }
+
+    // Rendered body size in bytes.
+    size_t length(const TemplateContext& ctx) const {
+        size_t total = 0;
+        char scratch[VALUE_MAX];
+        char esc[6];
+        for (uint8_t i = 0; i < count; i++) {
+            if (segs[i].field == FIELD_LITERAL) {
+                total += segs[i].len;
+                continue;
+            }
+            for (const char* v = value(segs[i].field, ctx, scratch); *v; v++) {
+                total += escapeChar(*v, esc);
+            }
+        }
+        return total;
+    }
+
+    class Reader {
+    public:
+        Reader(const BodyTemplate& t, const TemplateContext& ctx) : t(t), ctx(ctx) { rewind(); }
+
+        void rewind() {
+            seg = 0;
+            off = 0;
+            pendLen = pendPos = 0;
+            enter();
+        }
+
+        bool done() const { return seg >= t.count && pendPos >= pendLen; }
+
+        // Copy up to n bytes of the rendered body into out. Returns the
+        // number written; 0 once the body is complete.
+        size_t read(char* out, size_t n) {
+            size_t w = 0;
+            while (w < n) {
+                if (pendPos < pendLen) {
+                    out[w++] = pend[pendPos++];
+                    continue;
+                }
+                if (seg >= t.count) break;
+                const Segment& s = t.segs[seg];
+                if (s.field == FIELD_LITERAL) {
+                    size_t k = s.len - off;
+                    if (k > n - w) k = n - w;
+                    memcpy(out + w, t.text + s.offset + off, k);
+                    off += k;
+                    w += k;
+                    if (off >= s.len) next();
+                    continue;
+                }
+                char c = cur[off];
+                if (!c) {
+                    next();
+                    continue;
+                }
+                off++;
+                pendLen = (uint8_t)t.escapeChar(c, pend);
+                pendPos = 0;
+            }
+            return w;
+        }
+
+    private:
+        void next() {
+            seg++;
+            off = 0;
+            enter();
+        }
+
+        void enter() {
+            if (seg < t.count && t.segs[seg].field != FIELD_LITERAL) {
+                cur = t.value(t.segs[seg].field, ctx, scratch);
+            }
+        }
+
+        const BodyTemplate&    t;
+        const TemplateContext& ctx;
+        uint8_t     seg;
+        size_t      off;
+        const char* cur = "";
+        char        scratch[VALUE_MAX];
+        char        pend[6];          // escape sequence of the current value char
+        uint8_t     pendLen;
+        uint8_t     pendPos;
+    };
+
+private:
+    static Field lookup(const char* name, size_t len) {
+        static const struct { const char* name; Field field; } NAMES[] = {
+            { "message",   FIELD_MESSAGE },
+            { "level",     FIELD_LEVEL },
+            { "rate",      FIELD_RATE },
+            { "state",     FIELD_STATE },
+            { "device_id", FIELD_DEVICE_ID },
+            { "timestamp", FIELD_TIMESTAMP },
+        };
+        for (const auto& e : NAMES) {
+            if (strlen(e.name) == len && strncmp(e.name, name, len) == 0) return e.field;
+        }
+        return FIELD_LITERAL;
+    }
+
+    void addLiteral(size_t from, size_t to) {
+        if (to <= from) return;
+        segs[count].field = FIELD_LITERAL;
+        segs[count].offset = (uint16_t)from;
+        segs[count].len = (uint16_t)(to - from);
+        count++;
+    }
+
+    // Text for a placeholder; numbers are formatted into scratch.
+    const char* value(Field f, const TemplateContext& ctx, char* scratch) const {
+        switch (f) {
+            case FIELD_MESSAGE:   return ctx.message ? ctx.message : "";
+            case FIELD_STATE:     return ctx.state ? ctx.state : "";
+            case FIELD_DEVICE_ID: return ctx.deviceId ? ctx.deviceId : "";
+            case FIELD_LEVEL:     return number(ctx.level_cm, scratch);
+            case FIELD_RATE:      return number(ctx.rate_cm_30min, scratch);
+            case FIELD_TIMESTAMP:
+                snprintf(scratch, VALUE_MAX, "%lu", (unsigned long)ctx.timestamp);
+                return scratch;
+            default:              return "";
+        }
+    }
+
+    const char* number(float v, char* scratch) const {
+        if (isnan(v)) return escape == ESCAPE_JSON ? "null" : "";
+        snprintf(scratch, VALUE_MAX, "%.2f", (double)v);
+        return scratch;
+    }
+
+    // Escaped form of one value character; returns its length (1..6).
+    size_t escapeChar(char c, char* out) const {
+        static const char HEX[] = "0123456789ABCDEF";
+        unsigned char u = (unsigned char)c;
+        if (escape == ESCAPE_JSON) {
+            switch (c) {
+                case '"':  out[0] = '\\'; out[1] = '"';  return 2;
+                case '\\': out[0] = '\\'; out[1] = '\\'; return 2;
+                case '\n': out[0] = '\\'; out[1] = 'n';  return 2;
+                case '\r': out[0] = '\\'; out[1] = 'r';  return 2;
+                case '\t': out[0] = '\\'; out[1] = 't';  return 2;
+                default:
+                    if (u < 0x20) {
+                        memcpy(out, "\\u00", 4);
+                        out[4] = HEX[u >> 4];
+                        out[5] = HEX[u & 0x0F];
+                        return 6;
+                    }
+                    out[0] = c;
+                    return 1;
+            }
+        }
+        if (escape == ESCAPE_FORM) {
+            // Same unreserved set as TextEscape::urlEncode
+            if ((u >= '0' && u <= '9') || (u >= 'A' && u <= 'Z') || (u >= 'a' && u <= 'z') ||
+                c == '-' || c == '_' || c == '.' || c == '~') {
+                out[0] = c;
+                return 1;
+            }
+            if (c == ' ') {
+                out[0] = '+';
+                return 1;
+            }
+            out[0] = '%';
+            out[1] = HEX[u >> 4];
+            out[2] = HEX[u & 0x0F];
+            return 3;
+        }
+        out[0] = c;
+        return 1;
+    }
+
+    const char* text;
+    Segment     segs[MAX_SEGMENTS];
+    uint8_t     count;
+    Escape      escape;
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+/*
+    CalibrationTable.h
+
+    Piecewise-linear level calibration over up to MAX_POINTS (millivolts,
+    level_cm) pairs, evaluated straight from the raw ADS1115 code.
+
+    build() sorts the points and precomputes, per segment, the start code,
+    the start level in Q16 (cm * 65536) and an integer slope in Q32 cm per
+    code. A lookup is then a binary search over the segment starts plus one
+    64-bit multiply-add — no float division and no computeVolts() on the
+    sampling path. Codes outside the table extrapolate along the first/last
+    segment, matching the old two-point formula's behaviour above the top
+    calibration point.
+
+    Millivolts are the unit the config UI and NVS use; codes are derived at
+    GAIN_ONE (4.096 V full scale => 8 codes per mV), which is the only gain
+    WaterPressureSensor configures.
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <math.h>
+#include <stdint.h>
+
+// ADS1115 at GAIN_ONE: +/-4.096 V over 16 bits => 0.125 mV per code
+static constexpr int32_t ADS_GAIN_ONE_CODES_PER_MV = 8;
+static constexpr float   ADS_GAIN_ONE_MV_PER_CODE  = 0.125f;
+static constexpr int32_t ADS_FULL_SCALE_CODE       = 32767;
+
+struct CalibrationPoint {
+    int32_t millivolts;
+    float   level_cm;
+};
+
+class CalibrationTable {
+public:
+    static constexpr uint8_t MAX_POINTS = 8;
+
+    CalibrationTable() : count(0) {}
+
+    // Replace the table. Points may arrive in any order; two points with the
+    // same millivolt value keep the later one. Returns false and leaves the
+    // table empty when fewer than two distinct points remain.
+    bool build(const CalibrationPoint* pts, uint8_t n) {
+        count = 0;
+        if (n > MAX_POINTS) n = MAX_POINTS;
+
+        for (uint8_t i = 0; i < n; i++) {
+            // Insertion sort by millivolts; a duplicate overwrites in place.
+            uint8_t j = 0;
+            while (j < count && points[j].millivolts < pts[i].millivolts) j++;
+            if (j < count && points[j].millivolts == pts[i].millivolts) {
+                points[j] = pts[i];
+                continue;
+            }
+            for (uint8_t k = count; k > j; k--) points[k] = points[k - 1];
+            points[j] = pts[i];
+            count++;
+        }
+        if (count < 2) {
+            count = 0;
+            return false;
+        }
+
+        for (uint8_t i = 0; i < count; i++) {
+            xCode[i] = points[i].millivolts * ADS_GAIN_ONE_CODES_PER_MV;
+            yQ16[i]  = (int64_t)llround((double)points[i].level_cm * 65536.0);
+        }
+        for (uint8_t i = 0; i + 1 < count; i++) {
+            int64_t dy = yQ16[i + 1] - yQ16[i];
+            int64_t dx = xCode[i + 1] - xCode[i]; // > 0: sorted, distinct
+            slopeQ32[i] = (dy * 65536) / dx;
+        }
+        return true;
+    }
+
+    void clear() { count = 0; }
+    bool active() const { return count >= 2; }
+    uint8_t size() const { return count; }
+    const CalibrationPoint& point(uint8_t i) const { return points[i]; }
+
+    // Level in cm for a raw conversion code; 0 when the table is empty.
+    float levelFromCode(int32_t code) const {
+        if (!active()) return 0.0f;
+        uint8_t seg = segmentFor(code);
+        int64_t dx = (int64_t)code - xCode[seg];
+        // Round-to-nearest on the Q32 -> Q16 step (arithmetic shift on
+        // negative products: GCC/Xtensa and every host toolchain we use).
+        int64_t y = yQ16[seg] + ((slopeQ32[seg] * dx + 32768) >> 16);
+        return (float)y / 65536.0f;
+    }
+
+    float levelFromMillivolts(int32_t millivolts) const {
+        return levelFromCode(millivolts * ADS_GAIN_ONE_CODES_PER_MV);
+    }
+
+    // Inverse of levelFromCode for the comparator: the lowest non-negative
+    // code that reads as at least level_cm. False when the table is empty,
+    // any segment is flat or falling (a rising pressure would not mean a
+    // rising level), or the level is beyond positive full scale.
+    bool codeForLevel(float level_cm, int32_t& code) const {
+        if (!active()) return false;
+        for (uint8_t i = 0; i + 1 < count; i++) {
+            if (slopeQ32[i] <= 0) return false;
+        }
+        int32_t lo = 0;
+        int32_t hi = ADS_FULL_SCALE_CODE;
+        if (levelFromCode(hi) < level_cm) return false;
+        while (lo < hi) {
+            int32_t mid = lo + (hi - lo) / 2;
+            if (levelFromCode(mid) >= level_cm) hi = mid;
+            else lo = mid + 1;
+        }
+        code = lo;
+        return true;
+    }
+
+private:
+    CalibrationPoint points[MAX_POINTS]; // sorted by millivolts, as configured
+    int32_t  xCode[MAX_POINTS];          // segment start, ADS1115 code
+    int64_t  yQ16[MAX_POINTS];           // level at xCode, cm * 2^16
+    int64_t  slopeQ32[MAX_POINTS - 1];   // cm * 2^32 per code
+    uint8_t  count;
+
+    // Largest segment whose start is <= code, clamped to the end segments.
+    uint8_t segmentFor(int32_t code) const {
+        uint8_t lo = 0;
+        uint8_t hi = count - 2; // last segment index
+        while (lo < hi) {
+            uint8_t mid = (uint8_t)((lo + hi + 1) / 2);
+            if (xCode[mid] <= code) lo = mid;
+            else hi = mid - 1;
+        }
+        return lo;
+    }
+};
@@ -3,7 +3,9 @@
 #include <Arduino.h>
 #include <WebServer.h>
 #include <DNSServer.h>
-#include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
 #include "WiFiManager.h"
 #include "WaterPressureSensor.h"
 #include "SmsChannel.h"
@@ -13,6 +15,9 @@
 #include "MQTTService.h"
 #include "SettingsStore.h"
 
+class NotificationWorker;
+struct StaticAsset;
+
 /**
  * ConfigServer - Web-based configuration server for ESP32 boat monitoring system
  * 
@@ -25,12 +30,39 @@
  * 
  * The server runs in AP mode (Access Point) on 192.168.4.1 and provides
  * a user-friendly web interface for all system configuration needs.
+ *
+ * Requests are served on a dedicated Core 0 task (alongside the notifier
+ * and OTA check tasks), started and stopped with setup mode, so a slow
+ * client never holds up the loop task. Handlers must return quickly: test
+ * sends go to the NotificationWorker task and are polled via
+ * /notifications/test/status, an OTA check is picked up by the OTA check
+ * task and polled via /ota/status, and the alert pin test pulse is driven
+ * by the loop (isAlertPinTestActive()).
  */
 constexpr const char SENSOR_CALIBRATION_NAMESPACE[] = "sensor_cal";
 constexpr const char AP_SSID[] = "ESP32-BilgeRise-Setup";
 constexpr unsigned long SERVER_TIMEOUT_MS = 240000;
 constexpr int DNS_PORT = 53; // Standard DNS port for captive portal
 
+// Web server task: DNS + HTTP polled every CONFIG_SERVER_POLL_MS. On stop the
+// loop waits up to CONFIG_SERVER_STOP_WAIT_MS for a request in progress; a
+// longer one defers the teardown to handleClient() after the task exits.
+constexpr uint32_t    CONFIG_SERVER_TASK_STACK    = 8192;
+constexpr UBaseType_t CONFIG_SERVER_TASK_PRIORITY = 1;
+constexpr BaseType_t  CONFIG_SERVER_TASK_CORE     = 0;
+constexpr uint32_t    CONFIG_SERVER_POLL_MS       = 2;
+constexpr uint32_t    CONFIG_SERVER_STOP_WAIT_MS  = 3000;
+constexpr uint32_t    ALERT_PIN_TEST_MS           = 2000;
+
+// GET /events live stream (Server-Sent Events). Each client picks its rate
+// with ?interval_ms=, clamped to the limits below; a stream with no new
+// reading to send gets a comment line every SSE_KEEPALIVE_MS.
+constexpr uint8_t     SSE_MAX_CLIENTS             = 2;
+constexpr uint32_t    SSE_DEFAULT_INTERVAL_MS     = 500;
+constexpr uint32_t    SSE_MIN_INTERVAL_MS         = 100;
+constexpr uint32_t    SSE_MAX_INTERVAL_MS         = 10000;
+constexpr uint32_t    SSE_KEEPALIVE_MS            = 15000;
+
 // Emergency settings validation limits
 constexpr float MIN_EMERGENCY_WATER_LEVEL_CM = WATER_LEVEL_RANGE_MIN_CM; // 5.0 cm
 constexpr float MAX_EMERGENCY_WATER_LEVEL_CM = WATER_LEVEL_RANGE_MAX_CM; // 100 cm (max sensor range)
@@ -51,9 +83,37 @@ private:
     OTAManager* otaManager;
     MQTTService* mqttService;
     SettingsStore* settingsStore;           // Single source of truth for alarm thresholds
-    Preferences calibrationPrefs;           // NVS storage for calibration data
-    unsigned long serverStartTime;
+    NotificationWorker* notifier = nullptr; // Latency histograms for /debug/init
+    volatile unsigned long serverStartTime; // last request, written by the server task
     bool setupModeActive = false;
+
+    // === Server Task ===
+    TaskHandle_t      taskHandle    = nullptr;
+    SemaphoreHandle_t taskDone      = nullptr; // given by the task as it exits
+    volatile bool     stopRequested = false;
+    volatile uint32_t pinTestEndMs  = 0;       // alert pin test pulse, 0 = none
+    static void taskEntry(void* arg);
+    void run();
+    void serve();                           // one DNS + HTTP poll, then pushEvents()
+
+    // === Live Event Stream (GET /events) ===
+    struct EventClient {
+        WiFiClient client;
+        bool       active       = false;
+        uint8_t    channel      = 0;
+        uint32_t   intervalMs   = SSE_DEFAULT_INTERVAL_MS;
+        uint32_t   nextMs       = 0;   // next push due
+        uint32_t   lastSentMs   = 0;   // last event or keepalive
+        int64_t    lastSampleUs = 0;   // tickUs of the reading last sent
+    };
+    EventClient eventClients[SSE_MAX_CLIENTS];
+    const char* (*stateSource)(void* ctx) = nullptr;
+    void*       stateSourceCtx = nullptr;
+    size_t (*loopProfileSource)(char* out, size_t len, void* ctx) = nullptr;
+    void*       loopProfileCtx = nullptr;
+    void handleEvents();                    // GET /events — open a stream
+    void pushEvents();                      // server task: send whatever is due
+    void closeEventClients();
     String apPassword;                      // Unique per-device AP password generated from chip ID
     
     // === WiFi Configuration Handlers ===
@@ -64,18 +124,23 @@ private:
     void handleInit();                      // GET /init — merged JSON for main page load
     void handleSettingsInit();              // GET /settings/init — merged JSON for settings page load
     void handleDebugInit();                 // GET /debug/init — merged JSON for debug page load
+    void handleGetLogMask();                // GET /debug/log-mask — runtime log category mask
+    void handleSetLogMask();                // POST /debug/log-mask — set it (LogTags.h syntax)
     void handleCaptivePortalProbe();        // 302 redirect for captive-portal probe URLs
     void handleSubmit();                    // Process WiFi configuration submission
     void handleStatus();                    // Return WiFi connection status JSON
     void handleWiFiNetworks();              // GET /wifi/networks — stored SSID list JSON
+    void handleWiFiScan();                  // GET /wifi/scan — cached nearby networks JSON
     void handleWiFiRemove();               // POST /wifi/remove — remove a stored network
     
     // === Sensor Calibration Handlers ===
     void handleCalibrateZero();             // POST: Set zero calibration point
     void handleCalibratePoint2();           // POST: Set second calibration point
+    void handleCalibrateTable();            // POST: Set/clear the N-point calibration table
     void handleGetCalibration();            // GET: Return current calibration settings
     void loadCalibration();                 // Load calibration from NVS
     void saveCalibration();                 // Save calibration to NVS
+    bool parseChannelArg(uint8_t& channel); // Optional ?channel= (default 0); sends 400 when out of range
     
     // === Emergency Settings Handlers ===
     void handleSetEmergencyLevel();         // POST: Set emergency water level threshold (Tier 1)
@@ -96,9 +161,11 @@ private:
     void handleTestCustom();                // POST: Send a test custom channel message
     void handleSetMqttConfig();             // POST: Configure MQTT broker
     void handleTestMqtt();                  // POST: Send a test MQTT message
+    void handleTestStatus();                // GET: Poll a test send started by handleTest*()
+    void dispatchTest(NotificationChannel* channel, const char* message); // 202 + id, or an error
     
     // === Page Serving Helper ===
-    void sendCachedPage(const char* data, size_t len, const char* contentType);
+    void sendCachedPage(const StaticAsset& page); // generated by scripts/compress_html.py
 
     // === Debug and Monitoring Handlers ===
     void handleDebug();                     // Serve debug page (gzipped)
@@ -130,8 +197,20 @@ public:
     // Check if in setup mode
     bool isSetupModeActive();
     
-    // Should be called in main loop
+    // Should be called in main loop: enforces the idle timeout and finishes a
+    // deferred stop (requests are served on the server task; inline here
+    // only if the task failed to start)
     void handleClient();
+
+    // True while a /emergency/test-pin pulse is running; the loop ORs this
+    // into the alert pin it drives.
+    bool isAlertPinTestActive() const {
+        uint32_t end = pinTestEndMs;
+        return end != 0 && (int32_t)(end - millis()) > 0;
+    }
+
+    // Stack high-water mark of the server task; 0 when setup mode is off.
+    uint32_t getStackHighWaterMark() const;
     
     // === Emergency Settings Getters — delegate to SettingsStore ===
     float getEmergencyWaterLevel()       const { return settingsStore ? settingsStore->getEmergencyWaterLevel()       : SETTINGS_DEFAULTS().emergencyWaterLevel_cm; }
@@ -145,6 +224,21 @@ public:
     
     // === OTA Manager Setter ===
     void setOTAManager(OTAManager* ota) { otaManager = ota; }
+
+    // === Notifier Setter (notification latency on /debug) ===
+    void setNotifier(NotificationWorker* worker) { notifier = worker; }
+
+    // === State Source (the "state" field of /events) ===
+    // cb is called on the server task and must only read; ctx is passed back.
+    void setStateSource(const char* (*cb)(void* ctx), void* ctx) { stateSource = cb; stateSourceCtx = ctx; }
+
+    // === Loop Profile Source (the "loopProfile" object of /debug/init) ===
+    // cb copies the loop profiler's JSON into out on the server task and
+    // returns its length (0: nothing yet). Unset in builds without it.
+    void setLoopProfileSource(size_t (*cb)(char* out, size_t len, void* ctx), void* ctx) {
+        loopProfileSource = cb;
+        loopProfileCtx = ctx;
+    }
 };
 
 
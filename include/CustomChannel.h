@@ -12,22 +12,28 @@
       custom.auth      — auth type: "none", "basic", or "bearer"
       custom.user      — Basic: username; Bearer: token; none: unused
       custom.secret    — Basic: password; bearer/none: unused
-      custom.tmpl      — body template containing {{message}} placeholder
+      custom.tmpl      — body template with {{message}}, {{level}}, {{rate}},
+                         {{state}}, {{device_id}} and {{timestamp}} placeholders
+
+    The template is compiled once in loadCache() (BodyTemplate.h) and the
+    body is streamed from it straight into the request, escaping values on
+    the fly — no intermediate escape or body buffers.
 
     Body substitution rules:
-      - If content-type contains "json"           → jsonEscape the message before substitution
-      - If content-type contains "form"           → urlEncode the message before substitution
-      - Otherwise                                 → substitute raw (no escaping)
-      - If {{message}} is absent from the template → template is used verbatim (no message injected)
-      - Message body is bounded to 160 chars (NotifMsg.body size)
+      - If content-type contains "json"           → placeholder values are JSON-string escaped
+      - If content-type contains "form"           → placeholder values are URL-encoded
+      - Otherwise                                 → substituted raw (no escaping)
+      - A template without placeholders is sent verbatim (no message injected)
+      - {{level}}/{{rate}}/{{state}} come from the context provider set by
+        setContextProvider(); without one they render empty
 
     isConfigured() = endpoint + template are both non-empty.
 */
 
 #include "NotificationChannel.h"
+#include "BodyTemplate.h"
 
-// Max field sizes — chosen to fit on-stack buffers without blowing the notifier task stack.
-// The notifier task has 6 KB stack; keep buffers proportionate.
+// Max field sizes — the in-RAM cache is bounded; the body itself is streamed.
 static constexpr size_t CUSTOM_ENDPOINT_MAX = 256;
 static constexpr size_t CUSTOM_CTYPE_MAX    = 64;
 static constexpr size_t CUSTOM_AUTH_MAX     = 8;    // "none" / "basic" / "bearer"
@@ -37,7 +43,6 @@ static constexpr size_t CUSTOM_TMPL_MAX     = 512;
 
 #ifndef UNIT_TESTING
 
-#include "TextEscape.h"
 #include "HttpPoster.h"
 #include "NvsChannelBase.h"
 #include <Arduino.h>
@@ -52,6 +57,8 @@ public:
     bool        isConfigured()            const override;
     const char* name()                    const override { return "Custom"; }
     uint8_t     channelFlag()             const override;
+    size_t      maxMessageLength()        const override { return NOTIFY_BODY_MAX; } // streamed, no escape buffer
+    bool        endpointHost(char* host, size_t len) const override;
     void        loadCache()                     override;
 
     // --- Config helpers (called from ConfigServer) ---
@@ -71,6 +78,11 @@ public:
     bool hasEndpoint()  const { return endpointCache[0] != '\0'; }
     bool hasTemplate()  const { return tmplCache[0]     != '\0'; }
 
+    // Fills the sensor/state placeholders at send time. Called on the
+    // notifier task, so it must only read state that is safe across cores.
+    typedef void (*ContextProvider)(TemplateContext& ctx);
+    void setContextProvider(ContextProvider provider) { contextProvider = provider; }
+
 private:
     // In-RAM cache
     char endpointCache[CUSTOM_ENDPOINT_MAX];
@@ -79,11 +91,10 @@ private:
     char userCache[CUSTOM_USER_MAX];
     char secretCache[CUSTOM_SECRET_MAX];
     char tmplCache[CUSTOM_TMPL_MAX];
+    char deviceId[16];                  // "boat-xxxxxx", same as the MQTT client id
 
-    // Substitute {{message}} in tmplCache, writing to outBuf (size outSize).
-    // escapedMsg must already be escaped appropriately for the content type.
-    bool substituteTemplate(const char* escapedMsg,
-                            char* outBuf, size_t outSize) const;
+    BodyTemplate    compiled;           // segments point into tmplCache
+    ContextProvider contextProvider = nullptr;
 };
 
 #endif // UNIT_TESTING
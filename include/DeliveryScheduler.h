@@ -0,0 +1,179 @@
+#pragma once
+
+/*
+    DeliveryScheduler.h
+
+    Per-channel delivery bookkeeping for NotificationWorker. Every channel
+    (registry index) has its own lane: an ordered list of in-flight message
+    slots, each with its own attempt count and next-attempt deadline. A
+    failed send re-arms only that lane's head on the retry backoff, so one
+    unreachable provider no longer stalls the others — healthy lanes keep
+    draining while the failing one sleeps.
+
+    Slot EMERGENCY_SLOT is reserved for the latest-wins emergency snapshot.
+    admitEmergency() puts it at the head of every requested lane, due now,
+    ahead of any FIFO message that is waiting out a backoff. When a newer
+    snapshot arrives while the old one is still pending on some lane, the
+    lane keeps its place and simply sends the newer text (the worker
+    overwrites the slot body) with a fresh attempt budget.
+
+    Each slot remembers which lanes still hold it; it becomes free again once
+    every lane has delivered or given up on it. The worker owns the message
+    bodies (indexed by slot) — this class only decides who sends what, when.
+
+    Lanes pick among at most MAX_CHANNELS heads, so "next deadline" is a
+    linear scan rather than a heap. All deadline comparisons are wrap-safe.
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+
+class DeliveryScheduler {
+public:
+    static constexpr uint8_t MAX_CHANNELS   = 4;
+    static constexpr uint8_t MAX_SLOTS      = 6;
+    static constexpr uint8_t EMERGENCY_SLOT = 0;
+    static constexpr uint8_t SEND_ATTEMPTS  = 4;   // backoff table has SEND_ATTEMPTS - 1 entries
+
+    enum Result : uint8_t { SENT, RETRY, GAVE_UP };
+
+    // One send for the worker to make: lane `channel` sending `slot`.
+    struct Attempt {
+        uint8_t slot;
+        uint8_t channel;
+        uint8_t attempt;   // 1-based
+    };
+
+    explicit DeliveryScheduler(const uint32_t* backoffMs) : backoffMs(backoffMs) {
+        for (uint8_t s = 0; s < MAX_SLOTS; s++) slotLanes[s] = 0;
+        for (uint8_t c = 0; c < MAX_CHANNELS; c++) laneLen[c] = 0;
+    }
+
+    // Free regular (non-emergency) slot index, or -1 when all are in flight.
+    // Only a lookup: the slot stays free until admit() queues it on a lane.
+    int8_t findFreeSlot() const {
+        for (uint8_t s = EMERGENCY_SLOT + 1; s < MAX_SLOTS; s++) {
+            if (slotLanes[s] == 0) return (int8_t)s;
+        }
+        return -1;
+    }
+
+    bool slotAvailable() const { return findFreeSlot() >= 0; }
+
+    bool slotInUse(uint8_t slot) const { return slotLanes[slot] != 0; }
+
+    // Queue a regular slot at the tail of every lane in laneMask (bit i =
+    // lane i), due immediately. An empty mask leaves the slot free.
+    void admit(uint8_t slot, uint8_t laneMask, uint32_t nowMs) {
+        for (uint8_t c = 0; c < MAX_CHANNELS; c++) {
+            if (!(laneMask & (1u << c)) || laneHolds(c, slot) >= 0) continue;
+            Entry& e = lanes[c][laneLen[c]++];
+            e.slot = slot;
+            e.attempt = 1;
+            e.dueMs = nowMs;
+            slotLanes[slot] |= (uint8_t)(1u << c);
+        }
+    }
+
+    // Put the emergency slot at the head of every lane in laneMask, due now.
+    // A lane that still holds an older snapshot keeps it in place with a
+    // fresh attempt budget (the worker has replaced the body).
+    void admitEmergency(uint8_t laneMask, uint32_t nowMs) {
+        for (uint8_t c = 0; c < MAX_CHANNELS; c++) {
+            if (!(laneMask & (1u << c))) continue;
+            int8_t at = laneHolds(c, EMERGENCY_SLOT);
+            if (at < 0) {
+                for (uint8_t i = laneLen[c]; i > 0; i--) lanes[c][i] = lanes[c][i - 1];
+                laneLen[c]++;
+                at = 0;
+            }
+            Entry& e = lanes[c][at];
+            e.slot = EMERGENCY_SLOT;
+            e.attempt = 1;
+            e.dueMs = nowMs;
+            slotLanes[EMERGENCY_SLOT] |= (uint8_t)(1u << c);
+        }
+    }
+
+    // The send to make now, if any lane head is due. Emergency heads win,
+    // then the most overdue head.
+    bool nextDue(uint32_t nowMs, Attempt& out) const {
+        int8_t best = -1;
+        int32_t bestLate = 0;
+        bool bestEmergency = false;
+        for (uint8_t c = 0; c < MAX_CHANNELS; c++) {
+            if (laneLen[c] == 0) continue;
+            const Entry& head = lanes[c][0];
+            int32_t late = (int32_t)(nowMs - head.dueMs);
+            if (late < 0) continue;
+            bool emergency = head.slot == EMERGENCY_SLOT;
+            if (best < 0 || (emergency && !bestEmergency) ||
+                (emergency == bestEmergency && late > bestLate)) {
+                best = (int8_t)c;
+                bestLate = late;
+                bestEmergency = emergency;
+            }
+        }
+        if (best < 0) return false;
+        out.slot = lanes[best][0].slot;
+        out.channel = (uint8_t)best;
+        out.attempt = lanes[best][0].attempt;
+        return true;
+    }
+
+    // Record the outcome of an Attempt returned by nextDue(). A failure
+    // re-arms that lane's head after the backoff for this attempt; only that
+    // lane waits.
+    Result complete(const Attempt& a, bool ok, uint32_t nowMs) {
+        Entry& head = lanes[a.channel][0];
+        if (!ok && head.attempt < SEND_ATTEMPTS) {
+            head.dueMs = nowMs + backoffMs[head.attempt - 1];
+            head.attempt++;
+            return RETRY;
+        }
+        slotLanes[head.slot] &= (uint8_t)~(1u << a.channel);
+        for (uint8_t i = 1; i < laneLen[a.channel]; i++) {
+            lanes[a.channel][i - 1] = lanes[a.channel][i];
+        }
+        laneLen[a.channel]--;
+        return ok ? SENT : GAVE_UP;
+    }
+
+    // Retry delay armed by the last RETRY for this lane's head.
+    uint32_t backoffFor(uint8_t attempt) const { return backoffMs[attempt - 1]; }
+
+    // ms until the earliest lane head is due (0 if one is due now),
+    // UINT32_MAX when nothing is in flight.
+    uint32_t msUntilNextDue(uint32_t nowMs) const {
+        uint32_t best = UINT32_MAX;
+        for (uint8_t c = 0; c < MAX_CHANNELS; c++) {
+            if (laneLen[c] == 0) continue;
+            int32_t wait = (int32_t)(lanes[c][0].dueMs - nowMs);
+            if (wait <= 0) return 0;
+            if ((uint32_t)wait < best) best = (uint32_t)wait;
+        }
+        return best;
+    }
+
+    uint8_t laneDepth(uint8_t channel) const { return laneLen[channel]; }
+
+private:
+    struct Entry {
+        uint8_t  slot;
+        uint8_t  attempt;
+        uint32_t dueMs;
+    };
+
+    int8_t laneHolds(uint8_t c, uint8_t slot) const {
+        for (uint8_t i = 0; i < laneLen[c]; i++) {
+            if (lanes[c][i].slot == slot) return (int8_t)i;
+        }
+        return -1;
+    }
+
+    const uint32_t* backoffMs;
+    Entry   lanes[MAX_CHANNELS][MAX_SLOTS];
+    uint8_t laneLen[MAX_CHANNELS];
+    uint8_t slotLanes[MAX_SLOTS];   // bit c set while lane c still holds the slot
+};
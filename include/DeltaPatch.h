@@ -0,0 +1,269 @@
+#pragma once
+
+/*
+    DeltaPatch.h
+
+    Streaming applier for the delta OTA format produced by
+    scripts/make_delta.py. OTAManager inflates the release's .delta asset
+    and feeds the result to DeltaApplier in whatever chunks it has. The
+    applier reads the running firmware (the base) and writes the new image
+    in order through the DeltaIo callbacks. It uses two 256-byte buffers
+    and no heap, however big the patch is.
+
+    Format (little-endian, after zlib inflation):
+
+        header   "BRD1"  u32 baseSize  u8[32] baseSha256  u32 targetSize
+        ops      0x01 COPY    len, srcDelta          base bytes as-is
+                 0x02 ADD     len, srcDelta, len B   base byte + patch byte (mod 256)
+                 0x03 INSERT  len, len B             literal bytes
+                 0x00 END
+
+    `len` is an unsigned LEB128 varint. `srcDelta` is a zigzag varint that
+    moves the base cursor before the op; COPY/ADD then advance it by len.
+    This follows bsdiff: relocated code mostly lines up with the base at a
+    fixed offset, so its ADD bytes are mostly zero and deflate squeezes
+    them to almost nothing.
+
+    The base check is the caller's: checkBase() gets the header and
+    returns false if the running image isn't the one the patch was made
+    against. The result is checked against the release's SHA-256 the same
+    way a full download is (the applier knows nothing about hashes).
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+struct DeltaIo {
+    void* ctx;
+    bool (*checkBase)(void* ctx, uint32_t baseSize, const uint8_t sha256[32], uint32_t targetSize);
+    bool (*readBase)(void* ctx, uint32_t offset, uint8_t* buf, size_t len);
+    bool (*writeTarget)(void* ctx, const uint8_t* data, size_t len);
+};
+
+class DeltaApplier {
+public:
+    enum Status : uint8_t {
+        OK = 0,         // fed, waiting for more
+        DONE,           // END op seen and the target is complete
+        ERR_MAGIC,      // not a delta patch
+        ERR_BASE,       // checkBase() refused it
+        ERR_OP,         // unknown opcode or malformed varint
+        ERR_RANGE,      // base read or target write out of bounds
+        ERR_READ,       // readBase() failed
+        ERR_WRITE,      // writeTarget() failed
+        ERR_TRAILING,   // bytes after END, or END before targetSize
+    };
+
+    enum Op : uint8_t { OP_END = 0, OP_COPY = 1, OP_ADD = 2, OP_INSERT = 3 };
+    static constexpr size_t  HEADER_SIZE = 4 + 4 + 32 + 4;
+    static constexpr size_t  CHUNK = 256;
+
+    explicit DeltaApplier(const DeltaIo& io) : io_(io) {}
+
+    // Feed the next `len` inflated bytes. Once the result isn't OK, it
+    // stays that way and further input is ignored.
+    Status feed(const uint8_t* data, size_t len) {
+        while (len > 0 && status_ == OK) {
+            size_t used = step(data, len);
+            data += used;
+            len -= used;
+        }
+        if (len > 0 && status_ == DONE) status_ = ERR_TRAILING;
+        return status_;
+    }
+
+    // Call once the input has ended: DONE only if the END op was seen and
+    // the whole target was written.
+    Status finish() {
+        if (status_ == OK) status_ = ERR_TRAILING;     // stream ended before END
+        return status_;
+    }
+
+    Status   status()     const { return status_; }
+    uint32_t baseSize()   const { return baseSize_; }
+    uint32_t targetSize() const { return targetSize_; }
+    uint32_t written()    const { return outPos_ + outLen_; }
+
+private:
+    enum Phase : uint8_t { HEADER, OPCODE, LEN, SRC, BODY };
+
+    // Consume a prefix of data; returns how many bytes were used
+    size_t step(const uint8_t* data, size_t len) {
+        switch (phase_) {
+            case HEADER: {
+                size_t k = HEADER_SIZE - hdrLen_;
+                if (k > len) k = len;
+                memcpy(hdr_ + hdrLen_, data, k);
+                hdrLen_ += k;
+                if (hdrLen_ == HEADER_SIZE) parseHeader();
+                return k;
+            }
+            case OPCODE:
+                op_ = data[0];
+                if (op_ == OP_END) {
+                    end();
+                } else if (op_ > OP_INSERT) {
+                    status_ = ERR_OP;
+                } else {
+                    startVarint(LEN);
+                }
+                return 1;
+            case LEN:
+            case SRC:
+                varintByte(data[0]);
+                return 1;
+            case BODY:
+                return body(data, len);
+        }
+        return len;
+    }
+
+    void parseHeader() {
+        if (memcmp(hdr_, "BRD1", 4) != 0) {
+            status_ = ERR_MAGIC;
+            return;
+        }
+        baseSize_   = le32(hdr_ + 4);
+        targetSize_ = le32(hdr_ + 40);
+        if (io_.checkBase && !io_.checkBase(io_.ctx, baseSize_, hdr_ + 8, targetSize_)) {
+            status_ = ERR_BASE;
+            return;
+        }
+        phase_ = OPCODE;
+    }
+
+    void startVarint(Phase p) {
+        phase_ = p;
+        varint_ = 0;
+        shift_ = 0;
+    }
+
+    void varintByte(uint8_t b) {
+        if (shift_ > 28) {
+            status_ = ERR_OP;
+            return;
+        }
+        varint_ |= (uint32_t)(b & 0x7f) << shift_;
+        shift_ += 7;
+        if (b & 0x80) return;
+
+        if (phase_ == LEN) {
+            remaining_ = varint_;
+            if (op_ == OP_INSERT) {
+                beginBody();
+            } else {
+                startVarint(SRC);
+            }
+            return;
+        }
+        // zigzag: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...
+        int64_t delta = (int64_t)(varint_ >> 1) ^ -(int64_t)(varint_ & 1);
+        int64_t src = (int64_t)srcPos_ + delta;
+        if (src < 0 || src + remaining_ > baseSize_) {
+            status_ = ERR_RANGE;
+            return;
+        }
+        srcPos_ = (uint32_t)src;
+        if (op_ == OP_COPY) {
+            copyFromBase();
+        } else {
+            beginBody();
+        }
+    }
+
+    void beginBody() {
+        if ((uint64_t)written() + remaining_ > targetSize_) {
+            status_ = ERR_RANGE;
+            return;
+        }
+        phase_ = remaining_ ? BODY : OPCODE;
+    }
+
+    // COPY needs no patch bytes: run it to completion right away
+    void copyFromBase() {
+        if ((uint64_t)written() + remaining_ > targetSize_) {
+            status_ = ERR_RANGE;
+            return;
+        }
+        uint8_t base[CHUNK];
+        while (remaining_ > 0 && status_ == OK) {
+            size_t k = remaining_ < CHUNK ? remaining_ : CHUNK;
+            if (!io_.readBase(io_.ctx, srcPos_, base, k)) {
+                status_ = ERR_READ;
+                return;
+            }
+            put(base, k);
+            srcPos_ += k;
+            remaining_ -= k;
+        }
+        phase_ = OPCODE;
+    }
+
+    size_t body(const uint8_t* data, size_t len) {
+        size_t k = remaining_ < len ? remaining_ : len;
+        if (k > CHUNK) k = CHUNK;
+        if (op_ == OP_INSERT) {
+            put(data, k);
+        } else {
+            uint8_t base[CHUNK];
+            if (!io_.readBase(io_.ctx, srcPos_, base, k)) {
+                status_ = ERR_READ;
+                return k;
+            }
+            for (size_t i = 0; i < k; i++) base[i] = (uint8_t)(base[i] + data[i]);
+            put(base, k);
+            srcPos_ += k;
+        }
+        remaining_ -= k;
+        if (remaining_ == 0) phase_ = OPCODE;
+        return k;
+    }
+
+    void end() {
+        flush();
+        if (status_ != OK) return;
+        status_ = outPos_ == targetSize_ ? DONE : ERR_TRAILING;
+    }
+
+    void put(const uint8_t* data, size_t n) {
+        while (n > 0 && status_ == OK) {
+            size_t k = CHUNK - outLen_;
+            if (k > n) k = n;
+            memcpy(out_ + outLen_, data, k);
+            outLen_ += k;
+            data += k;
+            n -= k;
+            if (outLen_ == CHUNK) flush();
+        }
+    }
+
+    void flush() {
+        if (outLen_ == 0) return;
+        if (!io_.writeTarget(io_.ctx, out_, outLen_)) status_ = ERR_WRITE;
+        outPos_ += outLen_;
+        outLen_ = 0;
+    }
+
+    static uint32_t le32(const uint8_t* p) {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    DeltaIo  io_;
+    Status   status_     = OK;
+    Phase    phase_      = HEADER;
+    uint8_t  hdr_[HEADER_SIZE];
+    size_t   hdrLen_     = 0;
+    uint32_t baseSize_   = 0;
+    uint32_t targetSize_ = 0;
+    uint8_t  op_         = 0;
+    uint32_t varint_     = 0;
+    uint8_t  shift_      = 0;
+    uint32_t remaining_  = 0;
+    uint32_t srcPos_     = 0;
+    uint32_t outPos_     = 0;       // bytes already handed to writeTarget
+    uint8_t  out_[CHUNK];
+    size_t   outLen_     = 0;
+};
@@ -28,6 +28,8 @@ public:
     bool        isConfigured()            const override;
     const char* name()                    const override { return "Discord"; }
     uint8_t     channelFlag()             const override;
+    size_t      maxMessageLength()        const override { return NOTIFY_BODY_MAX; }
+    bool        endpointHost(char* host, size_t len) const override;
     void        loadCache()                     override;
 
     // --- Config helpers (called from ConfigServer) ---
@@ -0,0 +1,159 @@
+#pragma once
+
+/*
+    DnsCache.h
+
+    Host name -> IPv4 table behind HostResolver. An alert should not wait on
+    a DNS round trip (or fail because the router's resolver is briefly
+    down), so outbound hosts are looked up ahead of time and the answer is
+    kept here.
+
+    Policy:
+      - lookup() reports FRESH for an entry younger than its TTL, STALE for
+        one past it but younger than STALE_MAX_MS, else MISS. The caller
+        resolves on a MISS and may use a STALE address if that fails.
+      - watch() marks a host to be kept warm; nextRefresh() hands the
+        refresher the watched hosts that are unresolved or within
+        REFRESH_LEAD_MS of expiring, at most once per RETRY_MS each.
+      - A new host takes a free entry, else the least recently used
+        unwatched one, else the least recently used one.
+
+    Ages are unsigned millis() differences, so they survive the 49-day wrap.
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+class DnsCache {
+public:
+    static constexpr uint8_t  SIZE            = 8;
+    static constexpr size_t   HOST_MAX        = 64;
+    static constexpr uint32_t STALE_MAX_MS    = 86400000;   // 24 h
+    static constexpr uint32_t REFRESH_LEAD_MS = 30000;
+    static constexpr uint32_t RETRY_MS        = 30000;
+
+    enum Result : uint8_t { MISS, FRESH, STALE };
+
+    struct Entry {
+        char     host[HOST_MAX];
+        uint32_t addr;          // network byte order as IPAddress stores it; 0 = unresolved
+        uint32_t resolvedMs;
+        uint32_t ttlMs;
+        uint32_t lastUsedMs;
+        uint32_t attemptMs;     // last refresh handed out by nextRefresh()
+        bool     attempted;
+        bool     watched;
+    };
+
+    DnsCache() { clear(); }
+
+    void clear() {
+        for (uint8_t i = 0; i < SIZE; i++) {
+            memset(&entries[i], 0, sizeof(Entry));
+        }
+    }
+
+    Result lookup(const char* host, uint32_t nowMs, uint32_t& addr) {
+        int8_t i = find(host);
+        if (i < 0 || entries[i].addr == 0) return MISS;
+        Entry& e = entries[i];
+        e.lastUsedMs = nowMs;
+        uint32_t age = nowMs - e.resolvedMs;
+        if (age >= STALE_MAX_MS) return MISS;
+        addr = e.addr;
+        return age < e.ttlMs ? FRESH : STALE;
+    }
+
+    // Record a successful lookup. Returns false if host is too long to cache.
+    bool store(const char* host, uint32_t addr, uint32_t nowMs, uint32_t ttlMs) {
+        int8_t i = claim(host, nowMs);
+        if (i < 0) return false;
+        Entry& e = entries[i];
+        e.addr = addr;
+        e.resolvedMs = nowMs;
+        e.ttlMs = ttlMs;
+        e.attempted = false;
+        return true;
+    }
+
+    bool watch(const char* host, uint32_t nowMs) {
+        int8_t i = claim(host, nowMs);
+        if (i < 0) return false;
+        entries[i].watched = true;
+        return true;
+    }
+
+    // Forget which hosts are watched, before the caller re-registers the
+    // current set. Addresses stay cached.
+    void unwatchAll() {
+        for (uint8_t i = 0; i < SIZE; i++) entries[i].watched = false;
+    }
+
+    // A watched entry due for a lookup, or -1. The entry is marked as
+    // attempted so a failing host isn't retried before RETRY_MS.
+    int8_t nextRefresh(uint32_t nowMs) {
+        for (uint8_t i = 0; i < SIZE; i++) {
+            Entry& e = entries[i];
+            if (!e.watched) continue;
+            if (e.attempted && nowMs - e.attemptMs < RETRY_MS) continue;
+            bool due = e.addr == 0 ||
+                       nowMs - e.resolvedMs + REFRESH_LEAD_MS >= e.ttlMs;
+            if (!due) continue;
+            e.attempted = true;
+            e.attemptMs = nowMs;
+            return (int8_t)i;
+        }
+        return -1;
+    }
+
+    uint8_t resolvedCount() const {
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < SIZE; i++) n += entries[i].addr != 0 ? 1 : 0;
+        return n;
+    }
+
+    const Entry& entry(uint8_t i) const { return entries[i]; }
+
+private:
+    int8_t find(const char* host) const {
+        for (uint8_t i = 0; i < SIZE; i++) {
+            if (entries[i].host[0] && strcmp(entries[i].host, host) == 0) return (int8_t)i;
+        }
+        return -1;
+    }
+
+    int8_t claim(const char* host, uint32_t nowMs) {
+        if (!host || !host[0] || strlen(host) >= HOST_MAX) return -1;
+        int8_t i = find(host);
+        if (i >= 0) return i;
+
+        int8_t freeSlot = -1;
+        int8_t lruUnwatched = -1;
+        uint8_t lru = 0;
+        for (uint8_t j = 0; j < SIZE; j++) {
+            const Entry& e = entries[j];
+            if (!e.host[0]) {
+                if (freeSlot < 0) freeSlot = (int8_t)j;
+                continue;
+            }
+            uint32_t idle = nowMs - e.lastUsedMs;
+            if (!e.watched &&
+                (lruUnwatched < 0 || idle > nowMs - entries[lruUnwatched].lastUsedMs)) {
+                lruUnwatched = (int8_t)j;
+            }
+            if (idle > nowMs - entries[lru].lastUsedMs) lru = j;
+        }
+        i = freeSlot >= 0 ? freeSlot : lruUnwatched >= 0 ? lruUnwatched : (int8_t)lru;
+
+        Entry& e = entries[i];
+        memset(&e, 0, sizeof(Entry));
+        strcpy(e.host, host);
+        e.lastUsedMs = nowMs;
+        return i;
+    }
+
+    Entry entries[SIZE];
+};
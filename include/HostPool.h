@@ -0,0 +1,183 @@
+#pragma once
+
+/*
+    HostPool.h
+
+    Bookkeeping for HttpPoster's keep-alive connection pool: which pooled
+    connection belongs to which scheme/host/port, when it was last used, and
+    which one to give up when a new host needs a slot. The connections
+    themselves (WiFiClientSecure + HTTPClient) live in HttpPoster.cpp, indexed
+    by the slot numbers handed out here.
+
+    Policy:
+      - claim() returns the slot already bound to the host, else a never
+        used slot, else a closed one, else the least recently used one (the
+        caller closes it first).
+      - An open slot idle for IDLE_MS or longer is expired by the caller
+        (nextExpired()), which frees its TLS buffers between incidents.
+      - At most TLS_PARKED_MAX TLS connections stay open: each holds
+        ~40-50 KB of mbedTLS buffers, so before a new handshake the caller
+        closes the least recently used ones (tlsToClose()). Plain HTTP
+        connections cost only a socket and are not capped.
+
+    parseUrlHost() extracts the pool key from a URL without allocating.
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// Splits "http[s]://host[:port]/..." into host, port and scheme. Returns
+// false for other schemes, an empty host or a host too long for hostLen.
+inline bool parseUrlHost(const char* url, char* host, size_t hostLen,
+                         uint16_t& port, bool& secure) {
+    if (!url || hostLen == 0) return false;
+    const char* p;
+    if (strncmp(url, "https://", 8) == 0) {
+        secure = true;
+        port = 443;
+        p = url + 8;
+    } else if (strncmp(url, "http://", 7) == 0) {
+        secure = false;
+        port = 80;
+        p = url + 7;
+    } else {
+        return false;
+    }
+
+    size_t n = 0;
+    while (p[n] && p[n] != '/' && p[n] != ':' && p[n] != '?') n++;
+    if (n == 0 || n >= hostLen) return false;
+    memcpy(host, p, n);
+    host[n] = '\0';
+
+    if (p[n] == ':') {
+        uint32_t v = 0;
+        const char* d = p + n + 1;
+        if (*d < '0' || *d > '9') return false;
+        while (*d >= '0' && *d <= '9') {
+            v = v * 10 + (uint32_t)(*d - '0');
+            if (v > 65535) return false;
+            d++;
+        }
+        if (v == 0) return false;
+        port = (uint16_t)v;
+    }
+    return true;
+}
+
+class HostPool {
+public:
+    static constexpr uint8_t  SIZE     = 3;       // one per notification channel
+    static constexpr size_t   HOST_MAX = 64;
+    static constexpr uint32_t IDLE_MS  = 60000;
+    static constexpr uint8_t  TLS_PARKED_MAX = 1;
+
+    struct Slot {
+        char     host[HOST_MAX];
+        uint16_t port;
+        bool     secure;
+        bool     open;          // a live connection is parked in this slot
+        uint32_t lastUsedMs;
+    };
+
+    HostPool() {
+        for (uint8_t i = 0; i < SIZE; i++) {
+            slots[i].host[0] = '\0';
+            slots[i].port = 0;
+            slots[i].secure = false;
+            slots[i].open = false;
+            slots[i].lastUsedMs = 0;
+        }
+    }
+
+    // Slot for host:port. `evict` is set when the slot is open for a
+    // different host, which the caller must close before reusing it.
+    uint8_t claim(const char* host, uint16_t port, bool secure, uint32_t nowMs, bool& evict) {
+        evict = false;
+        int8_t unbound = -1;
+        int8_t closed = -1;
+        uint8_t lru = 0;
+        for (uint8_t i = 0; i < SIZE; i++) {
+            Slot& s = slots[i];
+            if (s.host[0] && s.port == port && s.secure == secure && strcmp(s.host, host) == 0) {
+                return i;
+            }
+            if (!s.host[0] && unbound < 0) unbound = (int8_t)i;
+            if (!s.open && closed < 0) closed = (int8_t)i;
+            if (nowMs - s.lastUsedMs > nowMs - slots[lru].lastUsedMs) lru = i;
+        }
+        uint8_t i = unbound >= 0 ? (uint8_t)unbound : closed >= 0 ? (uint8_t)closed : lru;
+        evict = slots[i].open;
+        bind(i, host, port, secure);
+        return i;
+    }
+
+    // Record the outcome of a request on slot i: whether the connection is
+    // still parked open afterwards (server allowed keep-alive).
+    void markUsed(uint8_t i, bool stillOpen, uint32_t nowMs) {
+        slots[i].open = stillOpen;
+        slots[i].lastUsedMs = nowMs;
+    }
+
+    void markClosed(uint8_t i) { slots[i].open = false; }
+
+    // An open slot idle for IDLE_MS or more, or -1.
+    int8_t nextExpired(uint32_t nowMs) const {
+        for (uint8_t i = 0; i < SIZE; i++) {
+            if (slots[i].open && nowMs - slots[i].lastUsedMs >= IDLE_MS) return (int8_t)i;
+        }
+        return -1;
+    }
+
+    // Before a TLS handshake on slot i: another open TLS slot to close
+    // first (least recently used), or -1 once fewer than TLS_PARKED_MAX
+    // remain. The caller closes and asks again.
+    int8_t tlsToClose(uint8_t i, uint32_t nowMs) const {
+        uint8_t open = 0;
+        int8_t lru = -1;
+        for (uint8_t j = 0; j < SIZE; j++) {
+            if (j == i || !slots[j].open || !slots[j].secure) continue;
+            open++;
+            if (lru < 0 || nowMs - slots[j].lastUsedMs > nowMs - slots[lru].lastUsedMs) {
+                lru = (int8_t)j;
+            }
+        }
+        return open >= TLS_PARKED_MAX ? lru : -1;
+    }
+
+    // ms until the next open slot expires (0 if one already has),
+    // UINT32_MAX when nothing is open.
+    uint32_t msUntilExpiry(uint32_t nowMs) const {
+        uint32_t best = UINT32_MAX;
+        for (uint8_t i = 0; i < SIZE; i++) {
+            if (!slots[i].open) continue;
+            uint32_t idle = nowMs - slots[i].lastUsedMs;
+            if (idle >= IDLE_MS) return 0;
+            if (IDLE_MS - idle < best) best = IDLE_MS - idle;
+        }
+        return best;
+    }
+
+    uint8_t openCount() const {
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < SIZE; i++) n += slots[i].open ? 1 : 0;
+        return n;
+    }
+
+    const Slot& slot(uint8_t i) const { return slots[i]; }
+
+private:
+    void bind(uint8_t i, const char* host, uint16_t port, bool secure) {
+        Slot& s = slots[i];
+        strncpy(s.host, host, HOST_MAX - 1);
+        s.host[HOST_MAX - 1] = '\0';
+        s.port = port;
+        s.secure = secure;
+        s.open = false;
+    }
+
+    Slot slots[SIZE];
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+/*
+    HostResolver.h
+
+    Cached DNS for outbound connections (HttpPoster, MQTTService,
+    OTAManager). resolve() answers from DnsCache.h when it can, so an alert
+    or a broker reconnect doesn't wait on a lookup, and falls back to the
+    last known address (up to DnsCache::STALE_MAX_MS old) when a lookup
+    fails, e.g. while the router's resolver is still starting after a power
+    cut.
+
+    Hosts the device will need are registered through sources (the
+    notification channels' endpoints, the MQTT broker). A low-priority task
+    on Core 0 looks them up as soon as WiFi has an IP and again before each
+    entry expires, off the send path.
+
+    lwIP doesn't report record TTLs through the Arduino API, so every answer
+    is kept for TTL_MS. Lookups are serialised: WiFi.hostByName() waits on
+    one shared event bit and can't run on two tasks at once.
+
+    Callers connect to the returned address themselves and still pass the
+    host name to TLS for SNI and certificate checks.
+*/
+
+#ifndef UNIT_TESTING
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "DnsCache.h"
+
+class HostResolver {
+public:
+    static HostResolver& getInstance();
+
+    // Start the refresh task. resolve() works before begin(), without
+    // prefetching.
+    void begin();
+
+    // Address for host: a fresh cache entry, else a lookup on the calling
+    // task, else a stale entry. IP literals are parsed, not cached.
+    // Returns false if none of those produced an address.
+    bool resolve(const char* host, IPAddress& out);
+
+    // Writes the index'th host the source wants kept warm into host (empty
+    // if that one isn't configured) and returns true; false once index is
+    // past its last host. Called on the refresh task.
+    typedef bool (*HostSource)(void* ctx, uint8_t index, char* host, size_t len);
+    void addSource(HostSource fn, void* ctx);
+
+    // Re-read the sources and refresh due entries now (new config saved).
+    void kick();
+
+private:
+    HostResolver();
+    HostResolver(const HostResolver&) = delete;
+    HostResolver& operator=(const HostResolver&) = delete;
+
+    bool lookup(const char* host, uint32_t& addr);
+    void refresh();
+    static void taskEntry(void* arg);
+
+    static constexpr uint32_t TTL_MS         = 300000;  // 5 min
+    static constexpr uint32_t POLL_MS        = 15000;
+    static constexpr uint8_t  SOURCE_MAX     = 4;
+    static constexpr uint8_t  SOURCE_HOSTS   = 4;       // hosts read per source
+
+    static constexpr uint32_t    TASK_STACK    = 4096;
+    static constexpr UBaseType_t TASK_PRIORITY = 1;
+    static constexpr BaseType_t  TASK_CORE     = 0;
+
+    struct Source {
+        HostSource fn;
+        void*      ctx;
+    };
+
+    DnsCache          cache;
+    SemaphoreHandle_t cacheMux;       // guards cache + sources (short holds)
+    SemaphoreHandle_t lookupMux;      // one hostByName() at a time
+    Source            sources[SOURCE_MAX];
+    uint8_t           sourceCount;
+    TaskHandle_t      taskHandle;
+};
+
+#endif // UNIT_TESTING
@@ -14,6 +14,23 @@
       AUTH_BASIC  — Basic user:pass (base64 via HTTPClient::setAuthorization)
       AUTH_BEARER — Bearer token
 
+    Connections are pooled per scheme/host/port (HostPool.h) and kept
+    alive between requests, so a repeated Tier 1 alert or a retry to the
+    same provider skips the TCP + TLS handshake and its heap spike. A
+    parked connection the server has since dropped is detected on use and
+    replaced with a fresh one within the same post(). Connections idle for
+    HostPool::IDLE_MS are closed by closeIdle(), as is every parked one
+    while free heap is low. Only HostPool::TLS_PARKED_MAX TLS connections
+    are kept: a handshake to a new host first closes the oldest parked
+    one. New connections go to the
+    address cached by HostResolver, without a DNS lookup on the send path.
+
+    A body can also be streamed from an HttpBody (CustomChannel renders its
+    template this way) instead of being assembled in a buffer first; it is
+    sent with a Content-Length, in TCP-sized pieces.
+
+    Not thread-safe: only the notifier task posts.
+
     Rules:
       - Auth credentials are NEVER logged.
       - The url is logged at DEBUG level (no secrets in well-formed URLs, but
@@ -28,6 +45,16 @@ enum class HttpAuthMode : uint8_t {
     BEARER = 2,
 };
 
+/// Request body produced on demand. length() must be exact; rewind() restarts
+/// it when a stale pooled connection forces a resend.
+class HttpBody {
+public:
+    virtual ~HttpBody() = default;
+    virtual size_t length() const = 0;
+    virtual size_t read(char* out, size_t n) = 0;
+    virtual void   rewind() = 0;
+};
+
 class HttpPoster {
 public:
     /// POST body to url with optional auth.
@@ -47,6 +74,23 @@ public:
                      HttpAuthMode authMode  = HttpAuthMode::NONE,
                      const char*  authUser   = nullptr,
                      const char*  authSecret = nullptr);
+
+    /// As above, streaming the body from `body`.
+    static bool post(const char* tag,
+                     const char* url,
+                     const char* contentType,
+                     HttpBody&   body,
+                     HttpAuthMode authMode  = HttpAuthMode::NONE,
+                     const char*  authUser   = nullptr,
+                     const char*  authSecret = nullptr);
+
+    /// Close pooled connections idle past HostPool::IDLE_MS, or all of them
+    /// when free heap is low.
+    /// @return ms until the next one expires, UINT32_MAX if none are open
+    static uint32_t closeIdle();
+
+    /// Close every pooled connection.
+    static void closeAll();
 };
 
 #endif // UNIT_TESTING
@@ -0,0 +1,126 @@
+#pragma once
+
+/*
+    I2cBusRecovery.h
+
+    Incremental I2C bus-recovery sequencer. The caller probes the bus, reports
+    failures with onBusError() and successes with onBusOk(), and on every tick
+    calls step() and performs the single Action it returns. No step blocks for
+    more than a few microseconds, so a wedged ADS1115 costs the sampling task
+    one short action per tick instead of a burst of bit-banged clock pulses.
+
+    One recovery cycle:
+        TAKE_PINS   detach the I2C driver, drive SDA high / SCL high as GPIO
+        CLOCK_PULSE x RECOVERY_CLOCK_PULSES (one per tick) — frees a slave
+                    holding SDA low mid-byte
+        STOP        SDA low -> SCL high -> SDA high
+        REINIT      restart the I2C driver and the ADS1115
+    then waits before the next probe: RETRY_MS while attempts remain, then an
+    exponential backoff (BACKOFF_BASE_MS doubling up to BACKOFF_MAX_MS) once
+    maxAttempts consecutive cycles have failed. Exhausting the attempts sets
+    unrecoverable() for alerting, but recovery keeps running on the backoff
+    schedule; the first good probe clears it and records how long the
+    episode (first failure -> first good probe) lasted.
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+
+class I2cBusRecovery {
+public:
+    enum Action : uint8_t {
+        NONE,
+        TAKE_PINS,
+        CLOCK_PULSE,
+        STOP,
+        REINIT
+    };
+
+    static constexpr uint8_t  RECOVERY_CLOCK_PULSES = 9;
+    static constexpr uint32_t RETRY_MS              = 1000;
+    static constexpr uint32_t BACKOFF_BASE_MS       = 30000;  // 30 s
+    static constexpr uint32_t BACKOFF_MAX_MS        = 600000; // 10 min
+
+    explicit I2cBusRecovery(uint8_t maxAttempts)
+        : maxAttempts(maxAttempts), phase(IDLE), pulsesLeft(0), attempts(0),
+          waitStart(0), waitMs(0), episodeStart(0), lastDurationMs(0),
+          recoveries(0), unrecoverableFlag(false) {}
+
+    // A probe found the bus dead. Starts a recovery cycle (ignored while one
+    // is already running or waiting).
+    void onBusError(uint32_t nowMs) {
+        if (phase != IDLE) return;
+        if (attempts == 0) episodeStart = nowMs;
+        if (attempts < UINT16_MAX) attempts++;
+        if (attempts >= maxAttempts) unrecoverableFlag = true;
+        phase = TAKE;
+    }
+
+    // A probe succeeded. Ends the current episode, if any.
+    void onBusOk(uint32_t nowMs) {
+        if (attempts == 0) return;
+        lastDurationMs = nowMs - episodeStart;
+        recoveries++;
+        attempts = 0;
+        unrecoverableFlag = false;
+        phase = IDLE;
+    }
+
+    // Advance one step; the caller performs the returned action this tick.
+    Action step(uint32_t nowMs) {
+        switch (phase) {
+            case IDLE:
+                return NONE;
+            case TAKE:
+                pulsesLeft = RECOVERY_CLOCK_PULSES;
+                phase = PULSE;
+                return TAKE_PINS;
+            case PULSE:
+                if (--pulsesLeft == 0) phase = STOPPING;
+                return CLOCK_PULSE;
+            case STOPPING:
+                phase = RESTART;
+                return STOP;
+            case RESTART:
+                waitStart = nowMs;
+                waitMs = nextWaitMs();
+                phase = WAIT;
+                return REINIT;
+            case WAIT:
+                if (nowMs - waitStart >= waitMs) phase = IDLE;
+                return NONE;
+        }
+        return NONE;
+    }
+
+    // True from the first failure until the post-cycle wait expires: the bus
+    // must not be probed or used by the caller in this window.
+    bool busy() const { return phase != IDLE; }
+    bool unrecoverable() const { return unrecoverableFlag; }
+    uint16_t attemptCount() const { return attempts; }
+    uint32_t lastRecoveryDurationMs() const { return lastDurationMs; }
+    uint32_t recoveryCount() const { return recoveries; }
+
+private:
+    enum Phase : uint8_t { IDLE, TAKE, PULSE, STOPPING, RESTART, WAIT };
+
+    uint8_t  maxAttempts;
+    Phase    phase;
+    uint8_t  pulsesLeft;
+    uint16_t attempts;       // consecutive failed cycles in this episode
+    uint32_t waitStart;
+    uint32_t waitMs;
+    uint32_t episodeStart;   // millis() of the episode's first failure
+    uint32_t lastDurationMs; // most recent completed episode
+    uint32_t recoveries;
+    bool     unrecoverableFlag;
+
+    uint32_t nextWaitMs() const {
+        if (attempts < maxAttempts) return RETRY_MS;
+        uint16_t over = attempts - maxAttempts; // 0 on the exhausting attempt
+        uint32_t wait = BACKOFF_BASE_MS;
+        while (over-- > 0 && wait < BACKOFF_MAX_MS) wait *= 2;
+        return wait < BACKOFF_MAX_MS ? wait : BACKOFF_MAX_MS;
+    }
+};
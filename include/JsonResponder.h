@@ -3,14 +3,21 @@
 /*
     JsonResponder.h
 
-    Small JSON response builder for ConfigServer handlers. Replaces the
-    repeated `String json = "{"; json += ...` blocks (30+ of them) and the
-    copy-pasted error/success send boilerplate in every handler.
+    JSON responses for ConfigServer handlers, streamed straight to the
+    WebServer client (JsonWriter.h). Replaces the repeated
+    `String json = "{"; json += ...` blocks and the copy-pasted
+    error/success send boilerplate in every handler.
 
     Design notes:
-    - Builds into a single Arduino String (one heap buffer, reserved up
-      front) — the WebServer hands responses to the TCP stack as a String
-      anyway, so this avoids double copies without changing behavior.
+    - No heap: fields are written into a 512-byte buffer on the handler's
+      stack. A response that fits is sent in one piece with a
+      Content-Length (send_P, so the body isn't copied into a String). A
+      bigger one switches to chunked transfer encoding at the first full
+      buffer, and each buffer becomes one chunk. Nested objects/arrays are
+      written in place (beginObject() / beginArray() ... end()) rather
+      than built as Strings and attached.
+    - The status code is fixed by the constructor, because the headers go
+      out with the first chunk.
     - Strings are JSON-escaped on the way in (quotes, backslash, control
       chars), which the old hand-concatenated code did NOT do — a SSID or
       webhook URL containing a `"` would previously emit invalid JSON.
@@ -22,93 +29,50 @@
 
 #include <Arduino.h>
 #include <WebServer.h>
+#include "JsonWriter.h"
 
-class JsonResponder {
+class JsonResponder : public JsonWriter<512> {
 public:
-    explicit JsonResponder(size_t reserveBytes = 256) {
-        json_.reserve(reserveBytes);
-        json_ = "{";
-    }
-
-    // --- Field adders (chainable) ---
-    JsonResponder& raw(const char* key, const char* rawJson) {
-        sep(); json_ += "\""; json_ += key; json_ += "\":"; json_ += rawJson; return *this;
-    }
-    JsonResponder& str(const char* key, const String& value) {
-        sep(); json_ += "\""; json_ += key; json_ += "\":\""; escape(value); json_ += "\""; return *this;
-    }
-    JsonResponder& boolean(const char* key, bool value) {
-        return raw(key, value ? "true" : "false");
-    }
-    JsonResponder& num(const char* key, int value) {
-        sep(); json_ += "\""; json_ += key; json_ += "\":"; json_ += String(value); return *this;
-    }
-    JsonResponder& num(const char* key, uint32_t value) {
-        sep(); json_ += "\""; json_ += key; json_ += "\":"; json_ += String(value); return *this;
-    }
-    JsonResponder& num(const char* key, float value, uint8_t decimals = 2) {
-        // Cast selects String(float, unsigned int decimalPlaces) — with a raw
-        // uint8_t the call is ambiguous against String(unsigned char, unsigned char).
-        sep(); json_ += "\""; json_ += key; json_ += "\":"; json_ += String(value, (unsigned int)decimals); return *this;
-    }
+    enum Root : uint8_t { OBJECT, ARRAY };
 
-    // --- Senders ---
-    // Close the object and return it as a String. Used both by send() and by
-    // handlers that embed this object as a nested value in an outer response.
-    const String& body() {
-        if (!closed_) { json_ += "}"; closed_ = true; }
-        return json_;
+    explicit JsonResponder(WebServer* server, int code = 200, Root root = OBJECT)
+        : JsonWriter<512>(&JsonResponder::sink, this), server_(server), code_(code) {
+        if (root == ARRAY) beginArray();
+        else               beginObject();
     }
 
-    void send(WebServer* server, int code = 200) {
-        server->send(code, "application/json", body());
+    // Standardized success fields: {"success":true,"message":"..."} plus any
+    // extra fields the caller chains on before send().
+    JsonResponder& success(const char* message) {
+        boolean("success", true).str("message", message);
+        return *this;
     }
 
     // Standardized error body: {"error":"..."}
-    static void sendError(WebServer* server, int code, const String& message) {
-        JsonResponder r(64 + message.length());
-        r.str("error", message);
-        r.send(server, code);
-    }
-
-    // Standardized success body: {"success":true,"message":"..."} plus any
-    // extra fields the caller chains on before send().
-    static JsonResponder success(const char* message) {
-        JsonResponder r;
-        r.boolean("success", true).str("message", message);
-        return r;
+    static void sendError(WebServer* server, int code, const char* message) {
+        JsonResponder(server, code).str("error", message).send();
     }
 
 private:
-    String json_;
-    bool first_  = true;
-    bool closed_ = false;
-
-    void sep() {
-        if (!first_) json_ += ",";
-        first_ = false;
-    }
-
-    void escape(const String& s) {
-        for (size_t i = 0; i < s.length(); i++) {
-            char c = s[i];
-            switch (c) {
-                case '"':  json_ += "\\\""; break;
-                case '\\': json_ += "\\\\"; break;
-                case '\n': json_ += "\\n";  break;
-                case '\r': json_ += "\\r";  break;
-                case '\t': json_ += "\\t";  break;
-                default:
-                    if ((uint8_t)c < 0x20) {
-                        char buf[7];
-                        snprintf(buf, sizeof(buf), "\\u%04x", c);
-                        json_ += buf;
-                    } else {
-                        json_ += c;
-                    }
+    static void sink(void* ctx, const char* data, size_t len, bool last) {
+        JsonResponder* self = static_cast<JsonResponder*>(ctx);
+        WebServer* server = self->server_;
+        if (!self->chunked_) {
+            if (last) {
+                server->send_P(self->code_, "application/json", data, len);
+                return;
             }
+            server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+            server->send(self->code_, "application/json", "");
+            self->chunked_ = true;
         }
+        if (len) server->sendContent(data, len);
+        if (last) server->sendContent("");      // terminating zero-length chunk
     }
+
+    WebServer* server_;
+    int        code_;
+    bool       chunked_ = false;
 };
 
 #endif // UNIT_TESTING
@@ -0,0 +1,220 @@
+#pragma once
+
+/*
+    JsonWriter.h
+
+    Streaming JSON writer behind JsonResponder. Output goes into a fixed
+    BUF-byte buffer, and each full buffer is handed to a sink callback, so a
+    response of any size costs BUF bytes of stack and no heap.
+
+    Objects and arrays nest (beginObject() / beginArray() ... end()), up
+    to MAX_DEPTH levels. Values take a key inside an object; pass nullptr
+    for array elements. send() closes whatever is still open and calls the
+    sink a last time with `last` set. A response that fits in one buffer
+    reaches the sink as a single last call, and the sink can send that with
+    a Content-Length instead of chunking it.
+
+    Strings are escaped (quotes, backslash, control chars). raw() inserts
+    pre-built JSON such as a histogram from formatLatencyJson(), unchecked.
+    Floats use "%.*f", which gives the same text as Arduino's
+    String(float, decimals).
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+template <size_t BUF>
+class JsonWriter {
+    static_assert(BUF >= 32, "JsonWriter buffer too small");
+
+public:
+    // `last` is set on the final call, with whatever is left (possibly 0 bytes)
+    typedef void (*Sink)(void* ctx, const char* data, size_t len, bool last);
+
+    static constexpr uint8_t MAX_DEPTH = 8;
+
+    JsonWriter(Sink sink, void* ctx) : sink_(sink), ctx_(ctx) {}
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    // --- Containers --------------------------------------------------------
+    JsonWriter& beginObject(const char* key = nullptr) { return open(key, '{', false); }
+    JsonWriter& beginArray(const char* key = nullptr)  { return open(key, '[', true); }
+
+    JsonWriter& end() {
+        if (skipped_) {
+            skipped_--;
+            return *this;
+        }
+        if (depth_ == 0) return *this;
+        depth_--;
+        putc_((isArray_ >> depth_) & 1 ? ']' : '}');
+        return *this;
+    }
+
+    // --- Values (key = nullptr inside an array) ----------------------------
+    JsonWriter& raw(const char* key, const char* json) {
+        if (skipped_) return *this;
+        field(key);
+        put(json ? json : "null");
+        return *this;
+    }
+    JsonWriter& str(const char* key, const char* value) {
+        return value ? str(key, value, strlen(value)) : raw(key, "null");
+    }
+    JsonWriter& str(const char* key, const char* value, size_t len) {
+        if (skipped_) return *this;
+        field(key);
+        putc_('"');
+        escape(value, len);
+        putc_('"');
+        return *this;
+    }
+    // char buffers would otherwise pick the template below
+    JsonWriter& str(const char* key, char* value) {
+        return str(key, static_cast<const char*>(value));
+    }
+    template <size_t N>
+    JsonWriter& str(const char* key, const char (&value)[N]) {
+        return str(key, static_cast<const char*>(value));
+    }
+    // Arduino String / std::string (anything with c_str() and length())
+    template <class S>
+    JsonWriter& str(const char* key, const S& value) {
+        return str(key, value.c_str(), value.length());
+    }
+    JsonWriter& boolean(const char* key, bool value) {
+        return raw(key, value ? "true" : "false");
+    }
+    JsonWriter& num(const char* key, int value) {
+        char b[12];
+        snprintf(b, sizeof(b), "%d", value);
+        return raw(key, b);
+    }
+    JsonWriter& num(const char* key, uint32_t value) {
+        char b[12];
+        snprintf(b, sizeof(b), "%lu", (unsigned long)value);
+        return raw(key, b);
+    }
+    JsonWriter& num(const char* key, float value, uint8_t decimals = 2) {
+        char b[48];
+        snprintf(b, sizeof(b), "%.*f", (int)decimals, (double)value);
+        return raw(key, b);
+    }
+
+    // --- Output --------------------------------------------------------------
+    // Close open containers and hand the rest to the sink. Further calls
+    // are ignored.
+    void send() {
+        if (sent_) return;
+        skipped_ = 0;
+        while (depth_ > 0) end();
+        sent_ = true;
+        sink_(ctx_, buf_, len_, true);
+        total_ += len_;
+        len_ = 0;
+    }
+
+    size_t  bytesWritten() const { return total_ + len_; }
+    uint8_t depth()        const { return depth_; }
+    bool    overflowed()   const { return overflow_; }   // nesting past MAX_DEPTH
+
+private:
+    JsonWriter& open(const char* key, char c, bool array) {
+        if (skipped_ || depth_ >= MAX_DEPTH) {
+            // Too deep: the container is written as null and everything up
+            // to its end() is dropped
+            if (!skipped_) raw(key, "null");
+            skipped_++;
+            overflow_ = true;
+            return *this;
+        }
+        field(key);
+        putc_(c);
+        if (array) isArray_ |= (1u << depth_);
+        else       isArray_ &= ~(1u << depth_);
+        notFirst_ &= ~(1u << depth_);
+        depth_++;
+        return *this;
+    }
+
+    // Separator and "key": for the next value at the current level
+    void field(const char* key) {
+        if (depth_ > 0) {
+            uint8_t bit = 1u << (depth_ - 1);
+            if (notFirst_ & bit) putc_(',');
+            notFirst_ |= bit;
+            if (key && !((isArray_ >> (depth_ - 1)) & 1)) {
+                putc_('"');
+                escape(key, strlen(key));
+                put("\":");
+            }
+        }
+    }
+
+    void escape(const char* s, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            char c = s[i];
+            switch (c) {
+                case '"':  put("\\\""); break;
+                case '\\': put("\\\\"); break;
+                case '\n': put("\\n");  break;
+                case '\r': put("\\r");  break;
+                case '\t': put("\\t");  break;
+                default:
+                    if ((uint8_t)c < 0x20) {
+                        char b[7];
+                        snprintf(b, sizeof(b), "\\u%04x", c);
+                        put(b);
+                    } else {
+                        putc_(c);
+                    }
+            }
+        }
+    }
+
+    void put(const char* s) { write(s, strlen(s)); }
+
+    void putc_(char c) {
+        if (sent_) return;
+        if (len_ == BUF) flush();
+        buf_[len_++] = c;
+    }
+
+    void write(const char* s, size_t n) {
+        if (sent_) return;
+        while (n > 0) {
+            if (len_ == BUF) flush();
+            size_t k = BUF - len_;
+            if (k > n) k = n;
+            memcpy(buf_ + len_, s, k);
+            len_ += k;
+            s += k;
+            n -= k;
+        }
+    }
+
+    void flush() {
+        if (len_ == 0) return;
+        sink_(ctx_, buf_, len_, false);
+        total_ += len_;
+        len_ = 0;
+    }
+
+    Sink     sink_;
+    void*    ctx_;
+    char     buf_[BUF];
+    size_t   len_      = 0;
+    size_t   total_    = 0;
+    uint8_t  depth_    = 0;
+    uint8_t  isArray_  = 0;     // bit per level
+    uint8_t  notFirst_ = 0;     // bit per level: a value was already written
+    uint8_t  skipped_  = 0;     // levels opened past MAX_DEPTH
+    bool     sent_     = false;
+    bool     overflow_ = false;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+/*
+    LatencyHistogram.h
+
+    Log-scale latency histogram for the notification pipeline, in
+    milliseconds (LogHistogram.h). Bucket 0 holds samples under 16 ms;
+    bucket i (1..BUCKETS-2) holds [2^(i+3), 2^(i+4)) ms; the last bucket is
+    open-ended (>= 2^18 ms, about 4.4 minutes — past the longest retry
+    schedule).
+
+    Bucket-edge percentiles are plenty to tell a 200 ms Discord webhook
+    from a 9 s Twilio timeout.
+
+    formatJson() writes a compact object for MQTT / the debug page:
+        {"n":12,"p50":256,"p95":1834,"max":1834,"b":[0,3,9]}
+    with trailing empty buckets trimmed.
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "LogHistogram.h"
+
+class LatencyHistogram : public LogHistogram<16, 4> {
+public:
+    // Returns the length written (excluding NUL), or 0 if out was too small.
+    size_t formatJson(char* out, size_t len) const {
+        if (!out || len == 0) return 0;
+        int n = snprintf(out, len, "{\"n\":%lu,\"p50\":%lu,\"p95\":%lu,\"max\":%lu,\"b\":",
+                         (unsigned long)count(), (unsigned long)percentile(50),
+                         (unsigned long)percentile(95), (unsigned long)maxValue());
+        if (n < 0 || (size_t)n >= len) return fail(out);
+        size_t pos = (size_t)n;
+        size_t w = formatBuckets(out + pos, len - pos);
+        if (w == 0) return fail(out);
+        pos += w;
+        if (pos + 2 > len) return fail(out);
+        out[pos++] = '}';
+        out[pos] = '\0';
+        return pos;
+    }
+
+private:
+    static size_t fail(char* out) {
+        out[0] = '\0';
+        return 0;
+    }
+};
@@ -0,0 +1,193 @@
+#pragma once
+
+/*
+    LevelWindow.h
+
+    Running aggregates of the level readings between two telemetry
+    publishes, so a surge shorter than the publish interval still shows up
+    in the one record sent per interval. add() is O(1) and the window is a
+    fixed ~100 bytes whatever the sample rate:
+
+      - min / max / mean, and the standard deviation by Welford's update
+        (no sum-of-squares cancellation at a steady level),
+      - p95 by the P² algorithm (Jain & Chlamtac, 1985): five markers whose
+        heights track the quantile with parabolic interpolation. Exact up to
+        five samples (it is then the max), an estimate after that,
+      - the number of invalid readings,
+      - the time spent at or above Tier 1, each reading holding until the
+        next one. An invalid reading doesn't count as above.
+
+    summary() reads the window without closing it, so a publish that fails
+    (or is suppressed) just lets the window run on; restart() starts the
+    next one after a successful send. A reading above Tier 1 still holding
+    at the restart keeps counting into the new window.
+
+    Times are the sensor path's 64-bit microsecond tick: add() takes the
+    tick the reading was sampled at (SensorReading::tickUs), not when it was
+    drained, so a batch drained after a loop stall still spreads over the
+    time it covered. A tick older than the newest one seen (a reading
+    sampled before a restart but drained after it) counts toward the
+    statistics but adds no time.
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+#include <math.h>
+
+class LevelWindow {
+public:
+    static constexpr float P95 = 0.95f;
+
+    struct Summary {
+        uint32_t samples;       // valid readings
+        uint32_t invalid;
+        float    min_cm;        // NAN when samples == 0
+        float    max_cm;
+        float    mean_cm;
+        float    stddev_cm;     // population; 0 for one sample
+        float    p95_cm;
+        uint32_t aboveTier1Ms;
+        uint32_t spanMs;        // since the window started
+    };
+
+    LevelWindow() { restart(0); }
+
+    void add(int64_t tickUs, bool valid, float level_cm, float tier1_cm) {
+        accrueAbove(tickUs);
+        holdAbove = valid && !isnan(level_cm) && level_cm >= tier1_cm;
+
+        if (!valid || isnan(level_cm)) {
+            if (invalid < UINT32_MAX) invalid++;
+            return;
+        }
+        if (count == 0 || level_cm < minCm) minCm = level_cm;
+        if (count == 0 || level_cm > maxCm) maxCm = level_cm;
+        count++;
+        float delta = level_cm - mean;
+        mean += delta / (float)count;
+        m2 += delta * (level_cm - mean);
+        addQuantile(level_cm);
+    }
+
+    Summary summary(int64_t nowUs) const {
+        Summary s;
+        s.samples = count;
+        s.invalid = invalid;
+        int64_t aboveUs = this->aboveUs + (holdAbove && nowUs > lastUs ? nowUs - lastUs : 0);
+        s.aboveTier1Ms = toMs(aboveUs);
+        s.spanMs = toMs(nowUs - startUs);
+        if (count == 0) {
+            s.min_cm = s.max_cm = s.mean_cm = s.stddev_cm = s.p95_cm = NAN;
+            return s;
+        }
+        s.min_cm = minCm;
+        s.max_cm = maxCm;
+        s.mean_cm = mean;
+        s.stddev_cm = sqrtf(m2 / (float)count);
+        s.p95_cm = count < MARKERS ? maxCm : q[2];
+        return s;
+    }
+
+    // Close the window at nowUs and start the next one
+    void restart(int64_t nowUs) {
+        accrueAbove(nowUs);
+        startUs = nowUs;
+        aboveUs = 0;
+        count = 0;
+        invalid = 0;
+        minCm = maxCm = 0.0f;
+        mean = m2 = 0.0f;
+    }
+
+private:
+    static constexpr int MARKERS = 5;
+
+    // The time since the last reading counts toward Tier 1 if that reading
+    // was above it
+    void accrueAbove(int64_t tickUs) {
+        if (tickUs <= lastUs) return;
+        if (holdAbove) aboveUs += tickUs - lastUs;
+        lastUs = tickUs;
+    }
+
+    static uint32_t toMs(int64_t us) {
+        if (us <= 0) return 0;
+        return us / 1000 > UINT32_MAX ? UINT32_MAX : (uint32_t)(us / 1000);
+    }
+
+    void addQuantile(float x) {
+        if (count <= (uint32_t)MARKERS) {
+            // Insertion-sort the first five samples into the markers
+            int i = (int)count - 1;
+            while (i > 0 && q[i - 1] > x) {
+                q[i] = q[i - 1];
+                i--;
+            }
+            q[i] = x;
+            if (count == (uint32_t)MARKERS) {
+                for (int m = 0; m < MARKERS; m++) pos[m] = m + 1;
+                desired[0] = 1.0f;
+                desired[1] = 1.0f + 2.0f * P95;
+                desired[2] = 1.0f + 4.0f * P95;
+                desired[3] = 3.0f + 2.0f * P95;
+                desired[4] = 5.0f;
+            }
+            return;
+        }
+
+        // Cell k holds x: q[k] <= x < q[k + 1], stretching the end markers
+        int k;
+        if (x < q[0]) {
+            q[0] = x;
+            k = 0;
+        } else if (x >= q[4]) {
+            q[4] = x;
+            k = 3;
+        } else {
+            k = 0;
+            while (x >= q[k + 1]) k++;
+        }
+        for (int m = k + 1; m < MARKERS; m++) pos[m]++;
+        static const float STEP[MARKERS] = { 0.0f, P95 / 2.0f, P95, (1.0f + P95) / 2.0f, 1.0f };
+        for (int m = 0; m < MARKERS; m++) desired[m] += STEP[m];
+
+        // Move the middle markers one position toward where they should be
+        for (int m = 1; m < MARKERS - 1; m++) {
+            float d = desired[m] - (float)pos[m];
+            if ((d >= 1.0f && pos[m + 1] - pos[m] > 1) || (d <= -1.0f && pos[m - 1] - pos[m] < -1)) {
+                int s = d >= 0.0f ? 1 : -1;
+                float h = parabolic(m, s);
+                if (!(q[m - 1] < h && h < q[m + 1])) {
+                    h = q[m] + s * (q[m + s] - q[m]) / (float)(pos[m + s] - pos[m]);
+                }
+                q[m] = h;
+                pos[m] += s;
+            }
+        }
+    }
+
+    float parabolic(int m, int s) const {
+        float nm = (float)pos[m], nl = (float)pos[m - 1], nr = (float)pos[m + 1];
+        return q[m] + (float)s / (nr - nl) *
+               ((nm - nl + s) * (q[m + 1] - q[m]) / (nr - nm) +
+                (nr - nm - s) * (q[m] - q[m - 1]) / (nm - nl));
+    }
+
+    int64_t  startUs;
+    int64_t  lastUs = 0;
+    int64_t  aboveUs = 0;
+    bool     holdAbove = false;
+
+    uint32_t count;
+    uint32_t invalid;
+    float    minCm;
+    float    maxCm;
+    float    mean;
+    float    m2;
+
+    // P² markers: heights, positions (1-based ranks) and desired positions
+    float    q[MARKERS] = {};
+    int32_t  pos[MARKERS] = {};
+    float    desired[MARKERS] = {};
+};
@@ -1,9 +1,12 @@
 #pragma once
 
 /*
-    Library to easily define and handle messaging through LEDs signaling
+    Library to easily define and handle messaging through LEDs signaling.
+    Blink codes are played by the RMT (PulseOutput.h) and keep time however
+    busy loop() is; the phase timings live in PulsePattern.h.
 */
 #include <Arduino.h>
+#include "PulseOutput.h"
 
 enum BlinkPattern {
     PATTERN_OFF,
@@ -15,18 +18,14 @@ enum BlinkPattern {
 
 class LightCode {
     private:
-        int ledPin;
         BlinkPattern pattern;
-        unsigned long lastToggleTime;
-        bool ledState; // True = ON
-        int doubleBinkPhase; // Tracks phase in double blink pattern (0-3)
+        PulseOutput output;
 
     public:
-        LightCode(int ledPin);
+        LightCode(int ledPin, rmt_channel_t channel);
         void setPattern(BlinkPattern pattern);
-        // Call this frequently to update the state of the light
-        // This is non-blocking
+        // Only needed by the software fallback (PULSE_OUTPUT_RMT=0 or no
+        // free RMT channel); returns at once otherwise. Non-blocking
         void update();
 
 };
-
@@ -0,0 +1,281 @@
+#pragma once
+
+/*
+    LogCodec.h
+
+    Binary encoding for deferred log formatting (Logger.cpp). encode() runs on
+    the logging task and stores only what printf would need later:
+
+        [fmt pointer][timestamp u32][flags u8][args...]
+
+    Arguments are walked with the format string itself: integers, doubles
+    and pointers are copied at their native size, '*' widths/precisions as
+    ints, and %s strings are copied in (NUL-terminated, cut to the
+    precision and to the record) because the caller's buffer is gone by the
+    time the sink runs. The format string is NOT copied — LOG_* macros only
+    accept string literals, which live for the whole program.
+
+    render() replays the format on the sink task, one conversion at a time
+    through snprintf, so the text is identical to a direct vsnprintf of the
+    same call. A record cut short by its buffer is rendered up to the first
+    missing argument, followed by "...".
+
+    Supported: flags "-+ #0", width/precision (digits or '*'), length
+    hh h l ll z j t L, conversions d i u o x X c s p f F e E g G a A %.
+    %n is skipped. Encoding and rendering must come from the same build
+    (argument sizes are not portable).
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+class LogCodec {
+public:
+    static constexpr size_t  HEADER          = sizeof(const char*) + 4 + 1;
+    static constexpr uint8_t FLAG_TRUNCATED  = 0x01;
+
+    // Encode one call into out[cap]. Returns the record length (0 only if
+    // cap can't hold the header).
+    static size_t encode(uint8_t* out, size_t cap, uint32_t timestamp,
+                         const char* fmt, va_list args) {
+        if (!out || cap < HEADER || !fmt) return 0;
+        memcpy(out, &fmt, sizeof(fmt));
+        memcpy(out + sizeof(fmt), &timestamp, 4);
+        size_t pos = HEADER;
+        uint8_t flags = 0;
+
+        // A local copy: encodeArg() takes it by reference, which an array-
+        // typed va_list parameter (x86-64) can't bind to
+        va_list ap;
+        va_copy(ap, args);
+        const char* p = fmt;
+        Spec s;
+        while ((p = nextSpec(p, s)) != nullptr) {
+            if (s.widthStar && !putInt(out, cap, pos, va_arg(ap, int))) { flags |= FLAG_TRUNCATED; break; }
+            if (s.precStar) {
+                int prec = va_arg(ap, int);
+                if (!putInt(out, cap, pos, prec)) { flags |= FLAG_TRUNCATED; break; }
+                s.prec = prec < 0 ? -1 : prec;      // bounds the %s copy below
+            }
+            if (!encodeArg(out, cap, pos, s, ap)) { flags |= FLAG_TRUNCATED; break; }
+        }
+        va_end(ap);
+        out[HEADER - 1] = flags;
+        return pos;
+    }
+
+    static const char* formatOf(const uint8_t* rec) {
+        const char* fmt;
+        memcpy(&fmt, rec, sizeof(fmt));
+        return fmt;
+    }
+
+    static uint32_t timestampOf(const uint8_t* rec) {
+        uint32_t ts;
+        memcpy(&ts, rec + sizeof(const char*), 4);
+        return ts;
+    }
+
+    // Format a record into out[outLen] (always NUL-terminated). Returns the
+    // text length.
+    static size_t render(char* out, size_t outLen, const uint8_t* rec, size_t recLen) {
+        if (!out || outLen == 0) return 0;
+        out[0] = '\0';
+        if (!rec || recLen < HEADER) return 0;
+        const char* fmt = formatOf(rec);
+        bool truncated = (rec[HEADER - 1] & FLAG_TRUNCATED) != 0;
+        size_t pos = HEADER;
+        size_t n = 0;
+
+        const char* lit = fmt;
+        const char* p = fmt;
+        Spec s;
+        while ((p = nextSpec(p, s)) != nullptr) {
+            n = append(out, outLen, n, lit, (size_t)(s.start - lit));
+            lit = p;
+            int width = s.width, prec = s.prec;
+            if (s.widthStar && !getInt(rec, recLen, pos, width)) return finish(out, outLen, n, truncated);
+            if (s.precStar  && !getInt(rec, recLen, pos, prec))  return finish(out, outLen, n, truncated);
+            if (!renderArg(out, outLen, n, rec, recLen, pos, s, width, prec)) {
+                return finish(out, outLen, n, truncated);
+            }
+        }
+        n = append(out, outLen, n, lit, strlen(lit));
+        return n;
+    }
+
+private:
+    enum Length : uint8_t { LEN_NONE, LEN_HH, LEN_H, LEN_L, LEN_LL, LEN_Z, LEN_J, LEN_T, LEN_BIG_L };
+
+    struct Spec {
+        const char* start;       // the '%'
+        char        flags[6];
+        int         width;       // -1 = none
+        int         prec;        // -1 = none
+        bool        widthStar;
+        bool        precStar;
+        Length      len;
+        char        conv;        // '%' for a literal percent
+    };
+
+    // Find the next conversion at or after p; returns the position after it
+    static const char* nextSpec(const char* p, Spec& s) {
+        while (*p) {
+            if (*p != '%') { p++; continue; }
+            s.start = p++;
+            size_t nf = 0;
+            while (*p && strchr("-+ #0", *p)) {
+                if (nf < sizeof(s.flags) - 1) s.flags[nf++] = *p;
+                p++;
+            }
+            s.flags[nf] = '\0';
+            s.width = -1;
+            s.widthStar = false;
+            if (*p == '*') { s.widthStar = true; p++; }
+            else if (*p >= '0' && *p <= '9') { s.width = 0; while (*p >= '0' && *p <= '9') s.width = s.width * 10 + (*p++ - '0'); }
+            s.prec = -1;
+            s.precStar = false;
+            if (*p == '.') {
+                p++;
+                if (*p == '*') { s.precStar = true; p++; }
+                else { s.prec = 0; while (*p >= '0' && *p <= '9') s.prec = s.prec * 10 + (*p++ - '0'); }
+            }
+            s.len = LEN_NONE;
+            if (p[0] == 'h' && p[1] == 'h')      { s.len = LEN_HH; p += 2; }
+            else if (p[0] == 'l' && p[1] == 'l') { s.len = LEN_LL; p += 2; }
+            else if (*p == 'h') { s.len = LEN_H; p++; }
+            else if (*p == 'l') { s.len = LEN_L; p++; }
+            else if (*p == 'z') { s.len = LEN_Z; p++; }
+            else if (*p == 'j') { s.len = LEN_J; p++; }
+            else if (*p == 't') { s.len = LEN_T; p++; }
+            else if (*p == 'L') { s.len = LEN_BIG_L; p++; }
+            if (!*p || !strchr("diuoxXcspfFeEgGaAn%", *p)) return nullptr;   // malformed: rest is literal
+            s.conv = *p++;
+            return p;
+        }
+        return nullptr;
+    }
+
+    static bool isFloat(char c)   { return strchr("fFeEgGaA", c) != nullptr; }
+
+    static bool put(uint8_t* out, size_t cap, size_t& pos, const void* v, size_t n) {
+        if (pos + n > cap) return false;
+        memcpy(out + pos, v, n);
+        pos += n;
+        return true;
+    }
+    static bool putInt(uint8_t* out, size_t cap, size_t& pos, int v) { return put(out, cap, pos, &v, sizeof(v)); }
+
+    static bool get(const uint8_t* rec, size_t recLen, size_t& pos, void* v, size_t n) {
+        if (pos + n > recLen) return false;
+        memcpy(v, rec + pos, n);
+        pos += n;
+        return true;
+    }
+    static bool getInt(const uint8_t* rec, size_t recLen, size_t& pos, int& v) { return get(rec, recLen, pos, &v, sizeof(v)); }
+
+    static bool encodeArg(uint8_t* out, size_t cap, size_t& pos, const Spec& s, va_list& args) {
+        if (s.conv == '%') return true;
+        if (s.conv == 'n') { (void)va_arg(args, void*); return true; }
+        if (s.conv == 'p') { void* v = va_arg(args, void*); return put(out, cap, pos, &v, sizeof(v)); }
+        if (s.conv == 's') {
+            const char* str = va_arg(args, const char*);
+            if (!str) str = "(null)";
+            // Like printf, read no further than the precision: "%.*s" may
+            // point at a buffer that isn't NUL-terminated
+            size_t n = 0;
+            if (s.prec >= 0) while (n < (size_t)s.prec && str[n]) n++;
+            else             n = strlen(str);
+            if (pos + 1 > cap) return false;
+            bool cut = false;
+            if (pos + n + 1 > cap) { n = cap - pos - 1; cut = true; }
+            memcpy(out + pos, str, n);
+            out[pos + n] = '\0';
+            pos += n + 1;
+            return !cut;
+        }
+        if (isFloat(s.conv)) {
+            if (s.len == LEN_BIG_L) { long double v = va_arg(args, long double); return put(out, cap, pos, &v, sizeof(v)); }
+            double v = va_arg(args, double);
+            return put(out, cap, pos, &v, sizeof(v));
+        }
+        switch (s.len) {
+            case LEN_L:  { long v      = va_arg(args, long);      return put(out, cap, pos, &v, sizeof(v)); }
+            case LEN_LL: { long long v = va_arg(args, long long); return put(out, cap, pos, &v, sizeof(v)); }
+            case LEN_Z:  { size_t v    = va_arg(args, size_t);    return put(out, cap, pos, &v, sizeof(v)); }
+            case LEN_J:  { intmax_t v  = va_arg(args, intmax_t);  return put(out, cap, pos, &v, sizeof(v)); }
+            case LEN_T:  { ptrdiff_t v = va_arg(args, ptrdiff_t); return put(out, cap, pos, &v, sizeof(v)); }
+            default:     { int v       = va_arg(args, int);       return put(out, cap, pos, &v, sizeof(v)); }
+        }
+    }
+
+    // Rebuild "%<flags><width>.<prec><len><conv>" with '*' resolved
+    static void buildSpec(char* spec, size_t size, const Spec& s, int width, int prec) {
+        static const char* const LEN_TEXT[] = { "", "hh", "h", "l", "ll", "z", "j", "t", "L" };
+        char w[12] = "";
+        char pr[13] = "";
+        if (width >= 0 || s.widthStar) snprintf(w, sizeof(w), "%d", width);
+        if (prec >= 0 || s.precStar)   snprintf(pr, sizeof(pr), ".%d", prec);
+        snprintf(spec, size, "%%%s%s%s%s%c", s.flags, w, pr, LEN_TEXT[s.len], s.conv);
+    }
+
+    static bool renderArg(char* out, size_t outLen, size_t& n, const uint8_t* rec, size_t recLen,
+                          size_t& pos, const Spec& s, int width, int prec) {
+        if (s.conv == '%') { n = append(out, outLen, n, "%", 1); return true; }
+        if (s.conv == 'n') return true;
+        char spec[32];
+        buildSpec(spec, sizeof(spec), s, width, prec);
+        char* at = out + n;
+        size_t room = outLen - n;
+        int w = 0;
+        if (s.conv == 's') {
+            if (pos >= recLen) return false;
+            const char* str = (const char*)rec + pos;
+            size_t sl = strnlen(str, recLen - pos);
+            if (pos + sl >= recLen) return false;
+            pos += sl + 1;
+            w = snprintf(at, room, spec, str);
+        } else if (s.conv == 'p') {
+            void* v; if (!get(rec, recLen, pos, &v, sizeof(v))) return false;
+            w = snprintf(at, room, spec, v);
+        } else if (isFloat(s.conv)) {
+            if (s.len == LEN_BIG_L) {
+                long double v; if (!get(rec, recLen, pos, &v, sizeof(v))) return false;
+                w = snprintf(at, room, spec, v);
+            } else {
+                double v; if (!get(rec, recLen, pos, &v, sizeof(v))) return false;
+                w = snprintf(at, room, spec, v);
+            }
+        } else {
+            switch (s.len) {
+                case LEN_L:  { long v;      if (!get(rec, recLen, pos, &v, sizeof(v))) return false; w = snprintf(at, room, spec, v); break; }
+                case LEN_LL: { long long v; if (!get(rec, recLen, pos, &v, sizeof(v))) return false; w = snprintf(at, room, spec, v); break; }
+                case LEN_Z:  { size_t v;    if (!get(rec, recLen, pos, &v, sizeof(v))) return false; w = snprintf(at, room, spec, v); break; }
+                case LEN_J:  { intmax_t v;  if (!get(rec, recLen, pos, &v, sizeof(v))) return false; w = snprintf(at, room, spec, v); break; }
+                case LEN_T:  { ptrdiff_t v; if (!get(rec, recLen, pos, &v, sizeof(v))) return false; w = snprintf(at, room, spec, v); break; }
+                default:     { int v;       if (!get(rec, recLen, pos, &v, sizeof(v))) return false; w = snprintf(at, room, spec, v); break; }
+            }
+        }
+        if (w > 0) n += ((size_t)w < room) ? (size_t)w : room - 1;
+        return true;
+    }
+
+    static size_t append(char* out, size_t outLen, size_t n, const char* s, size_t len) {
+        if (n + 1 >= outLen) return n;
+        if (len > outLen - 1 - n) len = outLen - 1 - n;
+        memcpy(out + n, s, len);
+        n += len;
+        out[n] = '\0';
+        return n;
+    }
+
+    static size_t finish(char* out, size_t outLen, size_t n, bool truncated) {
+        if (truncated) n = append(out, outLen, n, "...", 3);
+        return n;
+    }
+};
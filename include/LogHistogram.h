@@ -0,0 +1,120 @@
+#pragma once
+
+/*
+    LogHistogram.h
+
+    Fixed-size, log-scale histogram of uint32_t samples in whatever unit the
+    caller records (milliseconds for notification latency, microseconds for
+    loop() sections). FIRST_SHIFT sets the first edge: bucket 0 holds
+    samples under 2^FIRST_SHIFT, bucket i (1..BUCKETS-2) holds
+    [2^(i+FIRST_SHIFT-1), 2^(i+FIRST_SHIFT)), and the last bucket is
+    open-ended. Recording is a count-leading-zeros and a few adds with no
+    allocation, so it is cheap enough for every send or every loop() pass.
+
+    Besides the buckets it keeps count, min, max and the sum for the mean.
+    Percentiles are estimated from the bucket edges: the upper edge of the
+    bucket holding the p-th sample, capped at the observed maximum.
+
+    formatBuckets() writes the bucket counts as a JSON array, trailing empty
+    buckets trimmed; the owners wrap it in their own objects
+    (LatencyHistogram.h, LoopProfiler.h).
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+template <uint8_t BUCKET_COUNT, uint8_t FIRST_SHIFT>
+class LogHistogram {
+    static_assert(BUCKET_COUNT >= 2 && FIRST_SHIFT >= 1, "need a first and an open bucket");
+    static_assert(BUCKET_COUNT + FIRST_SHIFT <= 33, "bucket edges must fit in 32 bits");
+
+public:
+    static constexpr uint8_t BUCKETS = BUCKET_COUNT;
+
+    LogHistogram() { reset(); }
+
+    void reset() {
+        for (uint8_t i = 0; i < BUCKETS; i++) counts[i] = 0;
+        total = 0;
+        sum = 0;
+        minSeen = UINT32_MAX;
+        maxSeen = 0;
+    }
+
+    static uint8_t bucketFor(uint32_t v) {
+        if (v < ((uint32_t)1u << FIRST_SHIFT)) return 0;
+        uint8_t b = (uint8_t)(31 - __builtin_clz(v) - (FIRST_SHIFT - 1));
+        return b < BUCKETS ? b : (uint8_t)(BUCKETS - 1);
+    }
+
+    // Exclusive upper edge of bucket i; UINT32_MAX for the open last bucket.
+    static uint32_t upperBound(uint8_t i) {
+        return i >= BUCKETS - 1 ? UINT32_MAX : (uint32_t)1u << (i + FIRST_SHIFT);
+    }
+
+    void record(uint32_t v) {
+        counts[bucketFor(v)]++;
+        total++;
+        sum += v;
+        if (v < minSeen) minSeen = v;
+        if (v > maxSeen) maxSeen = v;
+    }
+
+    uint32_t count() const { return total; }
+    uint32_t bucket(uint8_t i) const { return counts[i]; }
+    // 0 when empty
+    uint32_t minValue() const { return total ? minSeen : 0; }
+    uint32_t maxValue() const { return maxSeen; }
+    uint32_t mean() const { return total ? (uint32_t)(sum / total) : 0; }
+
+    // Estimated p-th percentile (0..100), 0 when empty.
+    uint32_t percentile(uint8_t p) const {
+        if (total == 0) return 0;
+        uint64_t rank = ((uint64_t)total * p + 99) / 100;   // ceil, 1-based
+        if (rank == 0) rank = 1;
+        uint64_t seen = 0;
+        for (uint8_t i = 0; i < BUCKETS; i++) {
+            seen += counts[i];
+            if (seen >= rank) {
+                uint32_t edge = upperBound(i);
+                return edge < maxSeen ? edge : maxSeen;
+            }
+        }
+        return maxSeen;
+    }
+
+    // "[c0,c1,..]" up to the last non-empty bucket. Returns the length
+    // written (excluding NUL), or 0 with out emptied if it was too small.
+    size_t formatBuckets(char* out, size_t len) const {
+        if (!out || len == 0) return 0;
+        if (len < 3) return fail(out);
+        size_t pos = 0;
+        out[pos++] = '[';
+        uint8_t used = BUCKETS;
+        while (used > 0 && counts[used - 1] == 0) used--;
+        for (uint8_t i = 0; i < used; i++) {
+            int n = snprintf(out + pos, len - pos, i ? ",%lu" : "%lu", (unsigned long)counts[i]);
+            if (n < 0 || (size_t)n >= len - pos) return fail(out);
+            pos += (size_t)n;
+        }
+        if (pos + 2 > len) return fail(out);
+        out[pos++] = ']';
+        out[pos] = '\0';
+        return pos;
+    }
+
+private:
+    static size_t fail(char* out) {
+        out[0] = '\0';
+        return 0;
+    }
+
+    uint32_t counts[BUCKETS];
+    uint32_t total;
+    uint64_t sum;
+    uint32_t minSeen;
+    uint32_t maxSeen;
+};
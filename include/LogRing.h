@@ -0,0 +1,194 @@
+#pragma once
+
+/*
+    LogRing.h
+
+    Variable-length byte ring for MQTTService's outbound log queue (and the
+    Logger's buffered Serial output). Each
+    line is stored as its bytes followed by '\n', so a 60-byte "[DBG]" line
+    costs 61 bytes instead of a fixed 256-byte slot. In the same 4 KB a
+    typical mix of 40-100 byte lines queues 3-5x more messages.
+
+    The newline terminator is the record delimiter. Because of that, a run
+    of consecutive records is already a newline-delimited batch, and
+    peek() can hand the publisher a pointer straight into the ring, with no
+    copy. Records never straddle the end of the buffer. A line that doesn't
+    fit in the space left at the end starts again at offset 0, and the end
+    of the data (wrapAt) is remembered.
+
+    A full ring drops the oldest lines to make room (the log queue always
+    preferred fresh lines). Lines returned by peek() are reserved until
+    commit() or cancel(). While a reservation is open they can't be evicted, so a push
+    that would need them is dropped instead. Both cases count as drops.
+
+    Not thread-safe on its own: MQTTService calls every method under
+    logQueueMux. It only publishes the peeked span outside the lock, which
+    is why that span is reserved. The Logger's Serial ring is only touched
+    by its sink task.
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+template <size_t N>
+class LogRing {
+    static_assert(N >= 64 && N <= 65535, "LogRing size out of range");
+
+public:
+    LogRing() { clear(); }
+
+    void clear() {
+        head = tail = 0;
+        wrapAt = N;
+        wrapped = false;
+        usedBytes = 0;
+        lines = 0;
+        reservedBytes = 0;
+        reservedLines = 0;
+    }
+
+    // Append one line (at most maxLen chars of it). Embedded newlines are
+    // flattened to spaces so the line stays one record. Returns false if
+    // the line was dropped (only when a reservation blocks eviction).
+    bool push(const char* text, size_t maxLen) {
+        size_t n = 0;
+        while (n < maxLen && text[n]) n++;
+        size_t m = n + 1;
+        if (m > N / 2) {            // never evict the whole ring for one line
+            n = N / 2 - 1;
+            m = N / 2;
+        }
+
+        size_t at;
+        while (!place(m, at)) {
+            if (!evictOldest()) {
+                drops++;
+                return false;
+            }
+        }
+        for (size_t i = 0; i < n; i++) {
+            char c = text[i];
+            buf[at + i] = (c == '\n' || c == '\r') ? ' ' : c;
+        }
+        buf[at + n] = '\n';
+        head = at + m;
+        usedBytes += m;
+        lines++;
+        if (usedBytes > highWater) highWater = usedBytes;
+        return true;
+    }
+
+    // The oldest run of up to maxLines whole lines that fits in maxPayload
+    // bytes once joined with '\n' (the final terminator is excluded). At
+    // least one line is always returned. The span stays valid and reserved
+    // until commit(). Returns the number of lines (0 when empty).
+    uint16_t peek(size_t maxPayload, uint16_t maxLines, const char*& data, size_t& len) {
+        if (lines == 0 || reservedLines > 0) return 0;
+        size_t end = segmentEnd();
+        size_t pos = tail;
+        uint16_t k = 0;
+        while (pos < end && k < maxLines) {
+            size_t next = lineEnd(pos, end) + 1;
+            if (k > 0 && next - tail - 1 > maxPayload) break;
+            pos = next;
+            k++;
+        }
+        data = (const char*)buf + tail;
+        len = pos - tail - 1;
+        reservedBytes = pos - tail;
+        reservedLines = k;
+        return k;
+    }
+
+    // Release the span returned by peek().
+    void commit() {
+        if (reservedLines == 0) return;
+        consume(reservedBytes, reservedLines);
+        reservedBytes = 0;
+        reservedLines = 0;
+    }
+
+    // Give the span returned by peek() back unsent; it is peeked again next.
+    void cancel() {
+        reservedBytes = 0;
+        reservedLines = 0;
+    }
+
+    uint16_t size()          const { return lines; }
+    bool     empty()         const { return lines == 0; }
+    size_t   bytesUsed()     const { return usedBytes; }
+    size_t   highWaterBytes() const { return highWater; }
+    uint32_t dropped()       const { return drops; }
+    static constexpr size_t capacity() { return N; }
+
+private:
+    // Find room for m bytes without evicting; sets at.
+    bool place(size_t m, size_t& at) {
+        if (lines == 0) {
+            head = tail = 0;
+            wrapAt = N;
+            wrapped = false;
+        }
+        if (!wrapped) {
+            if (N - head >= m) {
+                at = head;
+                return true;
+            }
+            if (tail >= m) {
+                wrapAt = head;
+                wrapped = true;
+                at = 0;
+                return true;
+            }
+            return false;
+        }
+        if (tail - head >= m) {
+            at = head;
+            return true;
+        }
+        return false;
+    }
+
+    bool evictOldest() {
+        if (lines == 0 || reservedLines > 0) return false;
+        size_t end = segmentEnd();
+        size_t m = lineEnd(tail, end) + 1 - tail;
+        consume(m, 1);
+        drops++;
+        return true;
+    }
+
+    void consume(size_t bytes, uint16_t count) {
+        tail += bytes;
+        usedBytes -= bytes;
+        lines -= count;
+        if (wrapped && tail >= wrapAt) {
+            tail = 0;
+            wrapAt = N;
+            wrapped = false;
+        }
+    }
+
+    // End of the contiguous data run that starts at tail.
+    size_t segmentEnd() const { return wrapped ? wrapAt : head; }
+
+    size_t lineEnd(size_t from, size_t end) const {
+        const void* nl = memchr(buf + from, '\n', end - from);
+        return nl ? (size_t)((const uint8_t*)nl - buf) : end - 1;
+    }
+
+    uint8_t  buf[N];
+    size_t   head;          // next write offset
+    size_t   tail;          // oldest record
+    size_t   wrapAt;        // end of the data before the wrap (when wrapped)
+    bool     wrapped;       // head has wrapped to the front, behind tail
+    size_t   usedBytes;
+    uint16_t lines;
+    size_t   reservedBytes;
+    uint16_t reservedLines;
+    size_t   highWater = 0;
+    uint32_t drops = 0;
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+/*
+    LogTags.h
+
+    Compile-time tag IDs for the LOG_* category macros and the runtime mask
+    that gates them (Logger.h). A disabled category costs one load and one
+    branch at the call site; arguments are not evaluated.
+
+    CRITICAL lines (LOG_CRITICAL, LOG_EVENT) are not tagged and always print.
+
+    Mask text, as accepted by parseMask() (MQTT <baseTopic>/cmd/log and
+    POST /debug/log-mask) and produced by formatMask():
+
+        "network,status"   exactly these tags
+        "+network"         add to the current mask
+        "-status"          remove from the current mask
+        "all" / "none"     every tag / only CRITICAL
+        "default"          the build's default mask
+        "for=3600"         revert to the default after this many seconds
+
+    Tokens are separated by commas or spaces and applied left to right.
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+enum LogTag : uint8_t {
+    LOG_TAG_GENERAL = 0,    // plain LOG_DEBUG / LOG_INFO
+    LOG_TAG_SETUP,
+    LOG_TAG_STATE,
+    LOG_TAG_STATUS,
+    LOG_TAG_SENSOR,
+    LOG_TAG_NETWORK,
+    LOG_TAG_COUNT
+};
+
+#define LOG_TAG_BIT(tag) (1u << (tag))
+
+namespace LogTags {
+
+static constexpr uint32_t ALL = (1u << LOG_TAG_COUNT) - 1;
+
+inline const char* name(uint8_t tag) {
+    static const char* const NAMES[LOG_TAG_COUNT] = {
+        "general", "setup", "state", "status", "sensor", "network"
+    };
+    return tag < LOG_TAG_COUNT ? NAMES[tag] : "?";
+}
+
+// Parse mask text (see above) starting from `current`. Returns false, with
+// the outputs untouched, on an unknown tag. `forSec` is 0 without a "for=".
+inline bool parseMask(const char* text, size_t len, uint32_t current,
+                      uint32_t defaultMask, uint32_t& out, uint32_t& forSec) {
+    if (!text) return false;
+    uint32_t mask = current;
+    bool absolute = false;          // a bare name replaces the mask once
+    size_t i = 0;
+    bool any = false;
+    uint32_t seconds = 0;
+    while (i < len) {
+        while (i < len && (text[i] == ',' || text[i] == ' ')) i++;
+        if (i >= len) break;
+        char op = 0;
+        if (text[i] == '+' || text[i] == '-') op = text[i++];
+        size_t start = i;
+        while (i < len && text[i] != ',' && text[i] != ' ') i++;
+        size_t n = i - start;
+        const char* tok = text + start;
+
+        if (!op && n > 4 && memcmp(tok, "for=", 4) == 0) {
+            uint32_t v = 0;
+            for (size_t k = 4; k < n; k++) {
+                if (tok[k] < '0' || tok[k] > '9' || v >= 100000000u) return false;
+                v = v * 10 + (uint32_t)(tok[k] - '0');
+            }
+            seconds = v;
+            continue;
+        }
+
+        uint32_t bits;
+        bool reset = false;         // "all" / "none" / "default" set the whole mask
+        if      (n == 3 && memcmp(tok, "all", 3) == 0)     { bits = ALL;         reset = true; }
+        else if (n == 4 && memcmp(tok, "none", 4) == 0)    { bits = 0;           reset = true; }
+        else if (n == 7 && memcmp(tok, "default", 7) == 0) { bits = defaultMask; reset = true; }
+        else {
+            uint8_t t = 0;
+            while (t < LOG_TAG_COUNT && !(strlen(name(t)) == n && memcmp(tok, name(t), n) == 0)) t++;
+            if (t == LOG_TAG_COUNT) return false;
+            bits = LOG_TAG_BIT(t);
+        }
+
+        if (op == '+')      mask |= bits;
+        else if (op == '-') mask &= ~bits;
+        else if (reset)     { mask = bits; absolute = true; }
+        else {
+            if (!absolute) mask = 0;
+            absolute = true;
+            mask |= bits;
+        }
+        any = true;
+    }
+    if (!any) return false;
+    out = mask;
+    forSec = seconds;
+    return true;
+}
+
+// "network,status" / "all" / "none" into out[size] (always NUL-terminated).
+// Returns the text length.
+inline size_t formatMask(uint32_t mask, char* out, size_t size) {
+    if (!out || size == 0) return 0;
+    const char* fixed = (mask & ALL) == ALL ? "all" : (mask & ALL) == 0 ? "none" : nullptr;
+    size_t n = 0;
+    if (fixed) {
+        n = strlen(fixed);
+        if (n >= size) n = size - 1;
+        memcpy(out, fixed, n);
+    } else {
+        for (uint8_t t = 0; t < LOG_TAG_COUNT; t++) {
+            if (!(mask & LOG_TAG_BIT(t))) continue;
+            const char* s = name(t);
+            size_t len = strlen(s);
+            if (n + (n ? 1 : 0) + len >= size) break;
+            if (n) out[n++] = ',';
+            memcpy(out + n, s, len);
+            n += len;
+        }
+    }
+    out[n] = '\0';
+    return n;
+}
+
+} // namespace LogTags
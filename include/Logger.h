@@ -3,82 +3,121 @@
 
 #include <Arduino.h>
 #include <stdarg.h>
+#include "LogTags.h"
 
-// Logging system with configurable levels
-// Use PRODUCTION_BUILD flag to disable verbose logging
+// Logging system with configurable levels.
+// CRITICAL lines always print. Everything else carries a category tag
+// (LogTags.h) checked against a runtime mask, so one unit's LOG_NETWORK
+// can be switched on over MQTT or /debug without a reflash.
+// PRODUCTION_BUILD only changes the default mask (CRITICAL only).
+
+#ifndef LOG_DEFAULT_MASK
+  #ifdef PRODUCTION_BUILD
+    #define LOG_DEFAULT_MASK 0u
+  #else
+    #define LOG_DEFAULT_MASK LogTags::ALL
+  #endif
+#endif
 
 // Forward-declare to avoid pulling HTTPClient.h into every translation unit
 class MQTTService;
 extern MQTTService* g_mqtt;
 
-// Declared in MQTTService.cpp — enqueues the message; never blocks the main loop.
-// In UNIT_TESTING builds MQTTService.cpp is excluded, so provide a no-op stub.
-#ifdef UNIT_TESTING
-inline void sendMqttLog(const char*) {}
-#else
-void sendMqttLog(const char* message);
-#endif
-
 // Log level constants (included in MQTT log messages so consumers can filter)
 #define LOG_LEVEL_DEBUG    0
 #define LOG_LEVEL_INFO     1
 #define LOG_LEVEL_CRITICAL 2
 
-// Core logging function: formats once, writes to Serial and MQTT log queue.
-// Keeping this inline avoids a separate .cpp compile unit and keeps macro
-// call sites to a single function call + branch.
-inline void logMessage(uint8_t level, const char* fmt, ...) {
-    // Select level prefix for MQTT consumers
-    const char* prefix = (level == LOG_LEVEL_CRITICAL) ? "[CRIT] "
-                       : (level == LOG_LEVEL_INFO)     ? "[INFO] "
-                       :                                  "[DBG]  ";
+// "[CRIT] " / "[INFO] " / "[DBG]  " — prepended to MQTT log lines so
+// subscribers can filter by severity
+inline const char* logLevelPrefix(uint8_t level) {
+    return (level == LOG_LEVEL_CRITICAL) ? "[CRIT] "
+         : (level == LOG_LEVEL_INFO)     ? "[INFO] "
+         :                                  "[DBG]  ";
+}
+
+// Declared in MQTTService.cpp — enqueues the message; never blocks the main loop.
+// In UNIT_TESTING builds MQTTService.cpp is excluded, so provide a no-op stub.
+#ifdef UNIT_TESTING
+inline void sendMqttLog(const char*) {}
+static volatile uint32_t g_logMask = LOG_DEFAULT_MASK;
 
-    // Format into a single stack buffer — vsnprintf once, both sinks read it.
-    // Buffer size matches the old per-macro _buf size (256 B).
+// Native builds: format in place, Serial only (no sink task to defer to)
+inline void logMessage(uint8_t level, const char* fmt, ...) {
+    (void)level;
     char buf[256];
     va_list args;
     va_start(args, fmt);
-    int n = vsnprintf(buf, sizeof(buf) - 1, fmt, args);
+    vsnprintf(buf, sizeof(buf), fmt, args);
     va_end(args);
-    if (n < 0) n = 0;
-    buf[n < (int)(sizeof(buf) - 1) ? n : (int)(sizeof(buf) - 1)] = '\0';
-
-    // Serial: write formatted message + newline
     Serial.println(buf);
-
-    // MQTT: prepend level prefix so subscribers can filter by severity
-    // Reuse buf in place — shift content right to make room for prefix.
-    size_t prefixLen = strlen(prefix);
-    size_t msgLen    = strlen(buf);
-    // Build prefixed message in a second small buffer to avoid memmove complexity
-    char mqttBuf[256];
-    size_t copyLen = sizeof(mqttBuf) - prefixLen - 1;
-    if (copyLen > msgLen) copyLen = msgLen;
-    memcpy(mqttBuf, prefix, prefixLen);
-    memcpy(mqttBuf + prefixLen, buf, copyLen);
-    mqttBuf[prefixLen + copyLen] = '\0';
-
-    sendMqttLog(mqttBuf);
 }
-
-#ifdef PRODUCTION_BUILD
-    // Production mode - only critical logs
-    #define LOG_DEBUG(...)    ((void)0)
-    #define LOG_INFO(...)     ((void)0)
-    #define LOG_CRITICAL(...) logMessage(LOG_LEVEL_CRITICAL, __VA_ARGS__)
 #else
-    // Development mode - all logs enabled
-    #define LOG_DEBUG(...)    logMessage(LOG_LEVEL_DEBUG,    __VA_ARGS__)
-    #define LOG_INFO(...)     logMessage(LOG_LEVEL_INFO,     __VA_ARGS__)
-    #define LOG_CRITICAL(...) logMessage(LOG_LEVEL_CRITICAL, __VA_ARGS__)
+void sendMqttLog(const char* message);
+
+// Deferred logging (Logger.cpp). logMessage() encodes the format pointer, a
+// millis() timestamp and the raw arguments into a binary record
+// (LogCodec.h) and queues it — no vsnprintf and no Serial on the calling
+// task, and a 160-byte record buffer instead of two 256-byte text buffers.
+// The "log" sink task formats queued records and writes them to the MQTT log
+// queue and a drop-oldest Serial ring, which it feeds to the UART driver only
+// as fast as its interrupt-drained TX buffer has room (no task ever blocks on
+// the 115200-baud line). Until loggerBegin() has started the sink (or if it
+// could not be created) records are formatted and printed in place, as before.
+void logMessage(uint8_t level, const char* fmt, ...);
+
+// UART driver TX buffer; pass to Serial.setTxBufferSize() before Serial.begin()
+constexpr size_t LOG_SERIAL_TX_BUFFER = 1024;
+
+// Start the sink task. Call right after Serial.begin().
+void loggerBegin();
+
+// Print everything queued so far and wait (up to ~400 ms) for the UART to
+// send it. For exits that skip the restart hook, such as deep sleep.
+void loggerFlush();
+
+struct LoggerStats {
+    uint32_t dropped;         // records refused by a full queue
+    uint32_t queueHighWater;  // peak queue bytes
+    uint32_t maxLagMs;        // longest capture-to-output delay seen
+    uint32_t stackHighWater;  // sink task free stack (words)
+    uint32_t serialDropped;   // lines dropped (oldest first) waiting for the UART
+    uint32_t serialHighWater; // peak Serial ring bytes
+};
+LoggerStats loggerStats();
+
+// Runtime category mask (LOG_TAG_BIT per tag); read at every tagged call site
+extern volatile uint32_t g_logMask;
+
+// Set the mask; with forSec > 0 the sink task restores LOG_DEFAULT_MASK
+// after that many seconds. The change is logged at CRITICAL.
+void logSetMask(uint32_t mask, uint32_t forSec = 0);
+// Apply mask text (LogTags::parseMask syntax). False if it doesn't parse.
+bool logApplyMaskText(const char* text, size_t len);
+// Seconds until the mask reverts to the default (0 = not scheduled)
+uint32_t logMaskRemainingSec();
 #endif
 
+// `"" fmt` only compiles for a string literal: the deferred logger keeps
+// the format pointer, so it must outlive the call.
+#define LOG_CRITICAL(fmt, ...) logMessage(LOG_LEVEL_CRITICAL, "" fmt, ##__VA_ARGS__)
+
+// Tagged lines: one load + branch when the tag is off, and the arguments
+// aren't evaluated
+#define LOG_TAGGED(tag, level, fmt, ...) \
+    do { \
+        if (g_logMask & LOG_TAG_BIT(tag)) logMessage((level), "" fmt, ##__VA_ARGS__); \
+    } while (0)
+
+#define LOG_DEBUG(...)    LOG_TAGGED(LOG_TAG_GENERAL, LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...)     LOG_TAGGED(LOG_TAG_GENERAL, LOG_LEVEL_INFO,  __VA_ARGS__)
+
 // Convenience macros for common log categories
 #define LOG_EVENT(...)    LOG_CRITICAL(__VA_ARGS__)
-#define LOG_STATE(...)    LOG_INFO(__VA_ARGS__)
-#define LOG_SETUP(...)    LOG_INFO(__VA_ARGS__)
-#define LOG_STATUS(...)   LOG_DEBUG(__VA_ARGS__)
-#define LOG_SENSOR(...)   LOG_DEBUG(__VA_ARGS__)
-#define LOG_NETWORK(...)  LOG_DEBUG(__VA_ARGS__)
+#define LOG_STATE(...)    LOG_TAGGED(LOG_TAG_STATE,   LOG_LEVEL_INFO,  __VA_ARGS__)
+#define LOG_SETUP(...)    LOG_TAGGED(LOG_TAG_SETUP,   LOG_LEVEL_INFO,  __VA_ARGS__)
+#define LOG_STATUS(...)   LOG_TAGGED(LOG_TAG_STATUS,  LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_SENSOR(...)   LOG_TAGGED(LOG_TAG_SENSOR,  LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_NETWORK(...)  LOG_TAGGED(LOG_TAG_NETWORK, LOG_LEVEL_DEBUG, __VA_ARGS__)
 
 #endif // LOGGER_H
@@ -0,0 +1,264 @@
+#pragma once
+
+/*
+    LoopProfiler.h
+
+    Where the loop() task spends its time. Named sections are timed with a
+    cycle counter (ESP.getCycleCount() on the device: one register read, no
+    syscall) and each keeps min / max / mean and a log-scale histogram in
+    microseconds. One loop() pass is an "iteration": its total is profiled
+    the same way, and the per-section times of the slowest iteration so far
+    are kept as its breakdown, so a 900 ms spike can be pinned on the MQTT
+    reconnect rather than guessed at from averages.
+
+    Histogram buckets (LogHistogram.h): bucket 0 holds runs under 4 us,
+    bucket i (1..18) [2^(i+1), 2^(i+2)) us, and the last bucket is
+    open-ended (>= 2^20 us, about a second — a tenth of the task watchdog).
+
+    Section times are inclusive: a section nested in another ("state" inside
+    "control") is counted in both, and the breakdown doesn't add up to the
+    iteration total (jobs also run untimed code between sections).
+
+    Cycle deltas are wrap-safe up to 2^32 cycles (17.9 s at 240 MHz), longer
+    than the watchdog lets any iteration run.
+
+    Single task only — the loop task records; other tasks read a published
+    copy of formatJson() (see main.cpp).
+
+    The PROFILE_* macros compile to nothing unless LOOP_PROFILER is 1, so
+    the instrumented call sites cost nothing in a build without it. On by
+    default in dev builds, off under PRODUCTION_BUILD.
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "LogHistogram.h"
+
+#ifndef LOOP_PROFILER
+#ifdef PRODUCTION_BUILD
+#define LOOP_PROFILER 0
+#else
+#define LOOP_PROFILER 1
+#endif
+#endif
+
+class LoopProfiler {
+public:
+    typedef uint32_t (*CycleFn)();
+
+    static constexpr uint8_t MAX_SECTIONS = 16;
+    // Room for formatJson() without buckets with every section in use
+    static constexpr size_t  DEBUG_JSON_MAX = 2048;
+
+    // Microseconds: bucket 0 under 4 us, the last open from 2^20 us
+    typedef LogHistogram<20, 2> Stats;
+
+    // names[i] labels section i; the array must outlive the profiler.
+    // cyclesPerUs is the cycle counter's rate (the CPU clock in MHz).
+    LoopProfiler(const char* const* names, uint8_t sectionCount, CycleFn cycles, uint32_t cyclesPerUs)
+        : names(names), sectionCount(sectionCount < MAX_SECTIONS ? sectionCount : MAX_SECTIONS),
+          cycles(cycles), cyclesPerUs(cyclesPerUs ? cyclesPerUs : 1) {
+        reset();
+    }
+
+    void reset() {
+        for (uint8_t i = 0; i < MAX_SECTIONS; i++) {
+            sections[i].reset();
+            currentUs[i] = 0;
+            worstUs[i] = 0;
+        }
+        iterations.reset();
+        iterationStart = 0;
+        inIteration = false;
+        worstIterationUs = 0;
+        worstIterationIndex = 0;
+    }
+
+    // ---- Recording (loop task) ----
+
+    uint32_t now() const { return cycles(); }
+
+    void beginIteration() {
+        for (uint8_t i = 0; i < sectionCount; i++) currentUs[i] = 0;
+        iterationStart = cycles();
+        inIteration = true;
+    }
+
+    void endIteration() {
+        if (!inIteration) return;
+        inIteration = false;
+        uint32_t us = toUs(cycles() - iterationStart);
+        iterations.record(us);
+        if (us > worstIterationUs || iterations.count() == 1) {
+            worstIterationUs = us;
+            worstIterationIndex = iterations.count();
+            for (uint8_t i = 0; i < sectionCount; i++) worstUs[i] = currentUs[i];
+        }
+    }
+
+    // A section that started at cycle count startCycles has ended now.
+    void record(uint8_t section, uint32_t startCycles) {
+        if (section >= sectionCount) return;
+        uint32_t us = toUs(cycles() - startCycles);
+        sections[section].record(us);
+        if (inIteration) currentUs[section] += us;
+    }
+
+    // Times the enclosing scope into one section.
+    class Scope {
+    public:
+        Scope(LoopProfiler& p, uint8_t section) : p(p), section(section), start(p.now()) {}
+        ~Scope() { p.record(section, start); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        LoopProfiler& p;
+        uint8_t  section;
+        uint32_t start;
+    };
+
+    // ---- Queries ----
+
+    uint8_t count() const { return sectionCount; }
+    const char* name(uint8_t i) const { return i < sectionCount ? names[i] : ""; }
+    const Stats& section(uint8_t i) const { return sections[i]; }
+    const Stats& iteration() const { return iterations; }
+    uint32_t worstIteration() const { return worstIterationUs; }
+    // 1-based iteration number of the worst one (0 before the first)
+    uint32_t worstIterationAt() const { return worstIterationIndex; }
+    uint32_t worstBreakdownUs(uint8_t i) const { return i < sectionCount ? worstUs[i] : 0; }
+
+    // One section as {"n":..,"min":..,"mean":..,"p95":..,"max":..,"b":[..]}
+    // (microseconds, trailing empty buckets trimmed; no "b" without
+    // buckets). Returns the length written (excluding NUL), or 0 if out was
+    // too small.
+    static size_t formatStatsJson(const Stats& s, char* out, size_t len, bool buckets = true) {
+        if (!out || len == 0) return 0;
+        int n = snprintf(out, len, "{\"n\":%lu,\"min\":%lu,\"mean\":%lu,\"p95\":%lu,\"max\":%lu",
+                         (unsigned long)s.count(), (unsigned long)s.minValue(),
+                         (unsigned long)s.mean(), (unsigned long)s.percentile(95),
+                         (unsigned long)s.maxValue());
+        if (n < 0 || (size_t)n >= len) return fail(out);
+        size_t pos = (size_t)n;
+
+        if (buckets) {
+            n = snprintf(out + pos, len - pos, ",\"b\":");
+            if (n < 0 || (size_t)n >= len - pos) return fail(out);
+            pos += (size_t)n;
+            size_t w = s.formatBuckets(out + pos, len - pos);
+            if (w == 0) return fail(out);
+            pos += w;
+        }
+        if (pos + 2 > len) return fail(out);
+        out[pos++] = '}';
+        out[pos] = '\0';
+        return pos;
+    }
+
+    // The iteration and its worst-case breakdown:
+    //   {"iter":{<stats>},"budget_pct":1.9,"worst":{"us":190000,"at":5123,"s":{"mqtt":181000,..}}}
+    // budgetUs is what the iteration is measured against (the task watchdog);
+    // breakdown entries of 0 us are omitted.
+    size_t formatSummaryJson(char* out, size_t len, uint32_t budgetUs) const {
+        if (!out || len == 0) return 0;
+        int n = snprintf(out, len, "{\"iter\":");
+        if (n < 0 || (size_t)n >= len) return fail(out);
+        size_t pos = (size_t)n;
+        size_t w = formatStatsJson(iterations, out + pos, len - pos);
+        if (w == 0) return fail(out);
+        pos += w;
+
+        unsigned pctX10 = budgetUs ? (unsigned)(((uint64_t)worstIterationUs * 1000 + budgetUs / 2) / budgetUs) : 0;
+        n = snprintf(out + pos, len - pos, ",\"budget_pct\":%u.%u,\"worst\":{\"us\":%lu,\"at\":%lu,\"s\":{",
+                     pctX10 / 10, pctX10 % 10, (unsigned long)worstIterationUs,
+                     (unsigned long)worstIterationIndex);
+        if (n < 0 || (size_t)n >= len - pos) return fail(out);
+        pos += (size_t)n;
+
+        bool first = true;
+        for (uint8_t i = 0; i < sectionCount; i++) {
+            if (worstUs[i] == 0) continue;
+            n = snprintf(out + pos, len - pos, "%s\"%s\":%lu", first ? "" : ",", names[i],
+                         (unsigned long)worstUs[i]);
+            if (n < 0 || (size_t)n >= len - pos) return fail(out);
+            pos += (size_t)n;
+            first = false;
+        }
+        if (pos + 4 > len) return fail(out);
+        out[pos++] = '}';
+        out[pos++] = '}';
+        out[pos++] = '}';
+        out[pos] = '\0';
+        return pos;
+    }
+
+    // Everything: the summary plus every section that has run,
+    //   {"iter":..,"budget_pct":..,"worst":..,"s":{"mqtt":{<stats>},..}}
+    // Without buckets the section stats leave out their histograms (about a
+    // third of the size, for the /debug page).
+    size_t formatJson(char* out, size_t len, uint32_t budgetUs, bool buckets = true) const {
+        size_t pos = formatSummaryJson(out, len, budgetUs);
+        if (pos == 0) return 0;
+        pos--;   // reopen the summary object
+        int n = snprintf(out + pos, len - pos, ",\"s\":{");
+        if (n < 0 || (size_t)n >= len - pos) return fail(out);
+        pos += (size_t)n;
+
+        bool first = true;
+        for (uint8_t i = 0; i < sectionCount; i++) {
+            if (sections[i].count() == 0) continue;
+            n = snprintf(out + pos, len - pos, "%s\"%s\":", first ? "" : ",", names[i]);
+            if (n < 0 || (size_t)n >= len - pos) return fail(out);
+            pos += (size_t)n;
+            size_t w = formatStatsJson(sections[i], out + pos, len - pos, buckets);
+            if (w == 0) return fail(out);
+            pos += w;
+            first = false;
+        }
+        if (pos + 3 > len) return fail(out);
+        out[pos++] = '}';
+        out[pos++] = '}';
+        out[pos] = '\0';
+        return pos;
+    }
+
+private:
+    static size_t fail(char* out) {
+        out[0] = '\0';
+        return 0;
+    }
+
+    uint32_t toUs(uint32_t deltaCycles) const { return deltaCycles / cyclesPerUs; }
+
+    const char* const* names;
+    uint8_t  sectionCount;
+    CycleFn  cycles;
+    uint32_t cyclesPerUs;
+
+    Stats    sections[MAX_SECTIONS];
+    Stats    iterations;
+    uint32_t currentUs[MAX_SECTIONS];
+    uint32_t worstUs[MAX_SECTIONS];
+    uint32_t iterationStart;
+    bool     inIteration;
+    uint32_t worstIterationUs;
+    uint32_t worstIterationIndex;
+};
+
+// Call-site macros. `prof` is a LoopProfiler, `section` its section index;
+// with LOOP_PROFILER 0 neither is evaluated (or needs to exist).
+#if LOOP_PROFILER
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(prof, section) \
+    LoopProfiler::Scope PROFILE_CONCAT(_profScope, __LINE__)((prof), (section))
+#define PROFILE_ITERATION_BEGIN(prof) (prof).beginIteration()
+#define PROFILE_ITERATION_END(prof) (prof).endIteration()
+#else
+#define PROFILE_SCOPE(prof, section) ((void)0)
+#define PROFILE_ITERATION_BEGIN(prof) ((void)0)
+#define PROFILE_ITERATION_END(prof) ((void)0)
+#endif
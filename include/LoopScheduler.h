@@ -0,0 +1,126 @@
+#pragma once
+
+/*
+    LoopScheduler.h
+
+    Cooperative periodic scheduler for the loop() task. Each subsystem
+    registers a job with a period and a run-time budget; runDue() runs every
+    job whose period has elapsed, in registration order (register the
+    latency-sensitive jobs first), and returns how long the caller may idle
+    before the next one is due.
+
+    Scheduling keeps each job's phase: the next due time is the previous due
+    time plus the period, so a job that starts a few ms late doesn't drift.
+    A job that falls a whole period or more behind (a blocking OTA install, a
+    slow TLS handshake elsewhere in the loop) runs once and is re-phased to
+    "now + period" instead of bursting to catch up.
+
+    Per-job accounting: runs, overruns (a run longer than budgetUs), the
+    longest run, the worst start lateness and how many periods were skipped.
+
+    Run time is measured with the microsecond clock passed to the
+    constructor (micros() on the device, a fake in the unit tests); due
+    times use the millisecond timestamp passed to runDue(). All comparisons
+    are wrap-safe.
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+
+class LoopScheduler {
+public:
+    typedef void (*JobFn)(void* arg);
+    typedef uint32_t (*ClockUsFn)();
+
+    static constexpr uint8_t MAX_JOBS = 12;
+
+    struct Job {
+        const char* name;
+        JobFn    fn;
+        void*    arg;
+        uint32_t periodMs;
+        uint32_t budgetUs;   // a longer run counts as an overrun
+        uint32_t dueMs;
+        bool     started;    // first runDue() runs the job immediately
+
+        uint32_t runs;
+        uint32_t overruns;
+        uint32_t skipped;    // whole periods missed
+        uint32_t maxRunUs;
+        uint32_t maxLateMs;
+    };
+
+    explicit LoopScheduler(ClockUsFn clockUs) : clockUs(clockUs), count(0) {}
+
+    // Register a job. Returns its index, or -1 when the table is full.
+    int8_t add(const char* name, JobFn fn, void* arg, uint32_t periodMs, uint32_t budgetUs) {
+        if (count >= MAX_JOBS || fn == nullptr || periodMs == 0) return -1;
+        Job& j = jobs[count];
+        j.name = name;
+        j.fn = fn;
+        j.arg = arg;
+        j.periodMs = periodMs;
+        j.budgetUs = budgetUs;
+        j.dueMs = 0;
+        j.started = false;
+        j.runs = j.overruns = j.skipped = j.maxRunUs = j.maxLateMs = 0;
+        return (int8_t)count++;
+    }
+
+    // Run every due job. Returns ms until the earliest next due time (0 when
+    // a job is already due again).
+    uint32_t runDue(uint32_t nowMs) {
+        for (uint8_t i = 0; i < count; i++) {
+            Job& j = jobs[i];
+            if (!j.started) {
+                j.started = true;
+                j.dueMs = nowMs;
+            }
+            int32_t late = (int32_t)(nowMs - j.dueMs);
+            if (late < 0) continue;
+
+            uint32_t t0 = clockUs();
+            j.fn(j.arg);
+            uint32_t ran = clockUs() - t0;
+
+            j.runs++;
+            if (ran > j.budgetUs) j.overruns++;
+            if (ran > j.maxRunUs) j.maxRunUs = ran;
+            if ((uint32_t)late > j.maxLateMs) j.maxLateMs = (uint32_t)late;
+
+            if ((uint32_t)late >= j.periodMs) {
+                j.skipped += (uint32_t)late / j.periodMs;
+                j.dueMs = nowMs + j.periodMs;
+            } else {
+                j.dueMs += j.periodMs;
+            }
+        }
+        return msUntilNextDue(nowMs);
+    }
+
+    uint32_t msUntilNextDue(uint32_t nowMs) const {
+        uint32_t best = UINT32_MAX;
+        for (uint8_t i = 0; i < count; i++) {
+            if (!jobs[i].started) return 0;
+            int32_t wait = (int32_t)(jobs[i].dueMs - nowMs);
+            if (wait <= 0) return 0;
+            if ((uint32_t)wait < best) best = (uint32_t)wait;
+        }
+        return best;
+    }
+
+    uint8_t jobCount() const { return count; }
+    const Job& job(uint8_t i) const { return jobs[i]; }
+
+    uint32_t totalOverruns() const {
+        uint32_t n = 0;
+        for (uint8_t i = 0; i < count; i++) n += jobs[i].overruns;
+        return n;
+    }
+
+private:
+    ClockUsFn clockUs;
+    Job       jobs[MAX_JOBS];
+    uint8_t   count;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#ifndef UNIT_TESTING
+
+/*
+    LowPower.h
+
+    Deep sleep for the comparator-wake monitoring mode (LOW_POWER_MODE in
+    main.cpp; LowPowerPolicy.h decides when). While asleep only the RTC
+    domain and the ADS1115 are powered:
+
+      - ext0 wakes on ADS_ALERT_PIN low — the ADS1115 comparator armed by
+        WaterPressureSensor::armWakeComparator() at the wake level,
+      - ext1 wakes on BUTTON_PIN low, so the owner can still reach the
+        config UI,
+      - the timer wakes every heartbeat to re-check all compartments and
+        report telemetry.
+
+    A deep-sleep wake is a full reboot: setup() runs again and RAM is gone.
+    The few StateMachineContext fields that must outlive a sleep go to an
+    RTC_NOINIT checkpoint (magic + CRC, like WiFiManager's link hint) and
+    come back through restore(). The horn and LED pins are driven low and
+    held through the sleep — a floating horn driver could sound all night —
+    and releasePins() lets go of them on the next boot.
+
+    Deep sleep only: automatic light sleep between loop() iterations needs
+    CONFIG_PM_ENABLE, which the precompiled Arduino core is built without.
+*/
+
+#include <stdint.h>
+#include "LowPowerPolicy.h"
+
+struct StateMachineContext;
+
+class LowPower {
+public:
+    /// Why this boot happened, from the ESP32 wake cause.
+    static LowPowerPolicy::Wake wakeReason();
+
+    /// Release the sleep holds on the output pins and return the wake pins
+    /// to the digital GPIO matrix. Call first thing in setup(), before any
+    /// pinMode() on them.
+    static void releasePins();
+
+    /// Copy the checkpointed fields back into ctx after a sleep wake.
+    /// @return false on a power-on boot or a corrupt checkpoint (ctx untouched)
+    static bool restore(StateMachineContext& ctx);
+
+    /// Sleeps completed since the last power-on (0 before the first).
+    static uint32_t sleepCount();
+
+    /// Checkpoint ctx, flush NVS, hold the outputs low and deep sleep.
+    /// @param levelWakeArmed  the ADS1115 comparator is driving ADS_ALERT_PIN
+    /// @param heartbeatS      timer wake, seconds
+    /// Does not return.
+    static void sleep(const StateMachineContext& ctx, bool levelWakeArmed, uint32_t heartbeatS);
+};
+
+#endif // UNIT_TESTING
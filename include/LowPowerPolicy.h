@@ -0,0 +1,115 @@
+#pragma once
+
+/*
+    LowPowerPolicy.h
+
+    Decides when the monitor may deep sleep. Asleep, the ADS1115 comparator
+    watches one compartment against wakeLevel() and a heartbeat timer wakes
+    the board to report; check() is asked once a second while awake and
+    says SLEEP only when nothing needs the CPU:
+
+        - the state machine is NORMAL and every compartment reads valid,
+        - no compartment is at or above the wake level (the comparator would
+          fire straight away),
+        - nothing is in flight (notifications, OTA, setup mode, a button
+          press, an MQTT outbox not yet drained),
+        - the minimum awake time for this wake reason has passed — long
+          after power-on or a button press so the owner can reach the
+          config UI, short after a level wake so the reading is confirmed,
+        - and this wake's telemetry was handed to MQTT, or reportTimeoutMs
+          passed without a broker (the boat must not stay awake forever
+          because the marina WiFi is down).
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+
+class LowPowerPolicy {
+public:
+    enum Wake : uint8_t {
+        WAKE_POWER_ON,      // reset, brown-out, flash — anything but a sleep wake
+        WAKE_LEVEL,         // ADS1115 ALERT/RDY pulled low
+        WAKE_HEARTBEAT,     // sleep timer
+        WAKE_BUTTON,
+    };
+
+    enum Verdict : uint8_t {
+        STAY_STATE,         // EMERGENCY / ERROR / CONFIG
+        STAY_INVALID,       // a compartment has no valid reading
+        STAY_LEVEL,         // already at the wake level
+        STAY_BUSY,
+        STAY_MIN_AWAKE,
+        STAY_REPORT,        // telemetry not sent yet
+        SLEEP,
+    };
+
+    struct Inputs {
+        uint32_t awakeMs;       // since this boot / wake
+        bool     stateNormal;
+        bool     readingsValid;
+        float    maxLevel_cm;   // highest compartment
+        float    wakeLevel_cm;
+        bool     busy;
+        bool     reported;
+    };
+
+    LowPowerPolicy(uint32_t powerOnAwakeMs, uint32_t levelAwakeMs, uint32_t reportTimeoutMs)
+        : powerOnAwakeMs(powerOnAwakeMs), levelAwakeMs(levelAwakeMs),
+          reportTimeoutMs(reportTimeoutMs), wake(WAKE_POWER_ON) {}
+
+    void setWake(Wake w) { wake = w; }
+    Wake getWake() const { return wake; }
+
+    uint32_t minAwakeMs() const {
+        switch (wake) {
+            case WAKE_LEVEL:     return levelAwakeMs;
+            case WAKE_HEARTBEAT: return 0;
+            default:             return powerOnAwakeMs; // power-on, button
+        }
+    }
+
+    Verdict check(const Inputs& in) const {
+        if (!in.stateNormal) return STAY_STATE;
+        if (!in.readingsValid) return STAY_INVALID;
+        if (in.maxLevel_cm >= in.wakeLevel_cm) return STAY_LEVEL;
+        if (in.busy) return STAY_BUSY;
+        if (in.awakeMs < minAwakeMs()) return STAY_MIN_AWAKE;
+        if (!in.reported && in.awakeMs < reportTimeoutMs) return STAY_REPORT;
+        return SLEEP;
+    }
+
+    // Comparator threshold: marginCm below the Tier 1 emergency level, so
+    // the board is awake and sampling before the state machine would alarm.
+    static float wakeLevel(float emergencyLevel_cm, float marginCm) {
+        float level = emergencyLevel_cm - marginCm;
+        return level > 0.0f ? level : 0.0f;
+    }
+
+    static const char* wakeName(Wake w) {
+        switch (w) {
+            case WAKE_LEVEL:     return "level";
+            case WAKE_HEARTBEAT: return "heartbeat";
+            case WAKE_BUTTON:    return "button";
+            default:             return "power-on";
+        }
+    }
+
+    static const char* verdictName(Verdict v) {
+        switch (v) {
+            case STAY_STATE:     return "state";
+            case STAY_INVALID:   return "invalid";
+            case STAY_LEVEL:     return "level";
+            case STAY_BUSY:      return "busy";
+            case STAY_MIN_AWAKE: return "min-awake";
+            case STAY_REPORT:    return "report";
+            default:             return "sleep";
+        }
+    }
+
+private:
+    uint32_t powerOnAwakeMs;
+    uint32_t levelAwakeMs;
+    uint32_t reportTimeoutMs;
+    Wake     wake;
+};
@@ -12,11 +12,18 @@ class MQTTService;
     Features:
     - Persistent connection to a configurable Mosquitto broker (NVS-backed).
     - Non-blocking reconnect with exponential backoff.
+    - All PubSubClient I/O (TCP/TLS connect, keepalive, publishes) on a
+      dedicated "mqtt" task pinned to Core 0, so a slow broker or TLS
+      handshake never stalls the loop task driving the horn and state
+      machine. Callers enqueue into a fixed outbox (MessageQueue.h);
+      received messages come back through an inbox and are dispatched on
+      the loop task by loop().
     - Internal ring-buffer queue for log messages so LOG_* macros never block
       the main loop (critical during EMERGENCY alert-pulsing state).
     - LWT on <baseTopic>/availability ("online"/"offline") for HA availability.
     - Generic publish() and subscribe() for future HA sensor/command topics.
-    - Subscriber fan-out (PubSubClient supports only one global callback).
+    - Subscriber fan-out through a preallocated topic trie (PubSubClient
+      supports only one global callback); payloads are passed as views.
     - Optional username/password auth; empty strings = anonymous.
 */
 
@@ -26,10 +33,10 @@ class MQTTService;
 #include <WiFi.h>
 #include <WiFiClientSecure.h>
 #include <PubSubClient.h>
-#include <Preferences.h>
 #include <freertos/portmacro.h>
-#include <functional>
-#include <vector>
+#include "LogRing.h"
+#include "MessageQueue.h"
+#include "TopicTrie.h"
 
 class MQTTService {
 public:
@@ -39,26 +46,41 @@ public:
     // Lifecycle
     // -------------------------------------------------------------------------
 
-    // Load NVS config, configure PubSubClient. Does NOT connect — loop() does.
+    // Load NVS config, configure PubSubClient. Does NOT connect — the network
+    // task does.
     void begin();
 
-    // Must be called from main loop. Drains log queue, manages reconnect, polls client.
+    // Start the network task (call once, after begin() and the setup-time
+    // subscribe() calls). Returns false if the task could not be created;
+    // loop() then does the network work inline, as before.
+    bool startTask();
+
+    // Must be called from main loop. Dispatches received messages to their
+    // handlers (bounded per call); never touches the socket once the task runs.
     void loop();
 
-    bool isConnected();
+    // Broker session state as last seen by the network task.
+    bool isConnected() const { return m_initialized && online; }
 
     // Re-read NVS and trigger a fresh connect. Call after any update*() method.
+    // Applied by the network task on its next pass.
     void reloadConfig();
 
     // -------------------------------------------------------------------------
     // Publish API — general purpose (use for HA sensor/state/discovery topics)
     // -------------------------------------------------------------------------
 
-    // Publish to an arbitrary topic. Returns false if not connected.
+    // Queue a publish to an arbitrary topic. Returns false if not connected
+    // or the outbox is full (the message was not queued); true means handed
+    // to the network task, not yet on the wire.
     bool publish(const char* topic, const char* payload, bool retained = false);
+    // Binary payload (MessagePack etc.); same guards as above.
+    bool publish(const char* topic, const uint8_t* payload, size_t len, bool retained = false);
 
     // Enqueue a log message for async delivery to <baseTopic>/log.
     // Safe to call from LOG_* macros — never blocks or touches the wire.
+    // With MQTT_LOG_BATCH (the default) queued lines are packed into one
+    // newline-delimited payload per publish, up to MQTT_MAX_PACKET_SIZE.
     bool publishLog(const char* message);
 
     // Publish structured sensor telemetry (JSON) to <baseTopic>/telemetry.
@@ -66,14 +88,28 @@ public:
     // Home Assistant) immediately sees the last known reading.
     bool publishTelemetry(const char* json, bool retained = true);
 
+    // Same reading as MessagePack on <baseTopic>/telemetry/msgpack (built
+    // with TELEMETRY_MSGPACK=1). Retained by default, like the JSON topic.
+    bool publishTelemetryPacked(const uint8_t* data, size_t len, bool retained = true);
+
+    // Retained device-info JSON on <baseTopic>/info — the static fields
+    // (firmware version, thresholds) that telemetry no longer repeats.
+    bool publishDeviceInfo(const char* json);
+
     // -------------------------------------------------------------------------
     // Subscribe API — forward-looking (HA commands, config-over-MQTT, etc.)
     // -------------------------------------------------------------------------
 
-    typedef std::function<void(const char* topic, const char* payload)> MessageCallback;
+    // Called on the loop task (from loop()). payload is a view into the
+    // inbox: not NUL-terminated, valid only for the duration of the call
+    // (parse it with deserializeJson(doc, payload, len) or copy what you keep).
+    typedef void (*MessageHandler)(void* ctx, const char* topic,
+                                   const uint8_t* payload, size_t len);
 
-    // Subscribe to a topic filter. Callback is fanned out in loop().
-    bool subscribe(const char* topic, MessageCallback cb);
+    // Subscribe to a topic filter ('+' / '#' wildcards). Handlers are
+    // dispatched from loop() through a preallocated topic trie (TopicTrie.h);
+    // returns false for a malformed filter or when the fixed tables are full.
+    bool subscribe(const char* filter, MessageHandler handler, void* ctx = nullptr);
 
     // -------------------------------------------------------------------------
     // NVS-backed configuration (mirrors SendDiscord / SendSMS pattern)
@@ -103,10 +139,31 @@ public:
     // Status
     // -------------------------------------------------------------------------
 
-    uint32_t getLogsDropped() const { return logsDropped; }
+    uint32_t getLogsDropped() const { return logRing.dropped(); }
+    // Peak log-queue occupancy since boot, in bytes of LOG_RING_BYTES.
+    uint32_t getLogQueueHighWater() const { return (uint32_t)logRing.highWaterBytes(); }
+    // Lines waiting to be sent (unlocked read — a hint for lower-priority
+    // publishers, not an exact count).
+    uint16_t getLogQueueLines() const { return logRing.size(); }
+    // Log lines sent, and the publishes that carried them (equal when
+    // batching is off; the ratio is the mean batch size).
+    uint32_t getLogsSent() const { return logsSent; }
+    uint32_t getLogPublishes() const { return logPublishes; }
+    // Successful broker connects since boot; a change means a new session
+    // (retained messages may need refreshing).
+    uint32_t getConnectCount() const { return connectCount; }
+    // Publishes refused because the outbox was full, and received messages
+    // dropped because the inbox was (handlers not keeping up).
+    uint32_t getOutboxDropped() const { return outbox.dropped(); }
+    uint32_t getInboxDropped()  const { return inbox.dropped(); }
+    uint32_t getOutboxHighWater() const { return (uint32_t)outbox.highWaterBytes(); }
+    // Messages waiting in the outbox (unlocked read, a hint like
+    // getLogQueueLines()).
+    uint16_t getOutboxMessages() const { return outbox.size(); }
+    // Free stack of the network task in words (0 before startTask()).
+    uint32_t getStackHighWaterMark() const;
 
 private:
-    Preferences      preferences;
     WiFiClient       wifiClient;     // plaintext transport (port 1883)
     WiFiClientSecure secureClient;   // TLS transport (port 8883)
     PubSubClient     client;
@@ -121,46 +178,88 @@ private:
     char     logTopic[80];           // baseTopic + "/log"
     char     availabilityTopic[80];  // baseTopic + "/availability" (LWT)
     char     telemetryTopic[80];     // baseTopic + "/telemetry" (structured JSON)
+    char     telemetryPackedTopic[96]; // baseTopic + "/telemetry/msgpack"
+    char     infoTopic[80];          // baseTopic + "/info" (retained device info)
     bool     useTls;                 // true = TLS (8883), false = plaintext (1883)
 
+    // configMux guards the strings above (written by readNvs() on the
+    // network task, read by the get*() accessors from other tasks) and
+    // subscriptionCount (bumped by subscribe() once an entry is filled in)
+    portMUX_TYPE configMux;
+
     bool m_initialized;
     bool cachedBrokerConfigExists;   // Cached result to avoid NVS check every loop
-    bool recheckBrokerConfig;        // Flag to recheck after config changes
+    volatile bool recheckBrokerConfig; // Flag to recheck after config changes
+    volatile bool reloadRequested;   // set by reloadConfig(), applied on the task
+    volatile bool online;            // client.connected() as of the last task pass
 
     // Non-blocking reconnect state
     uint32_t lastReconnectAttempt;
     uint32_t reconnectBackoffMs;     // 5s → 10s → 20s → 30s cap
-
-    // Outbound log ring buffer (~4 KB RAM: 16 × 256)
-    // logQueueMux guards the ring buffer across cores (NotificationWorker on Core 0,
-    // main loop on Core 1 both call LOG_* → publishLog).
-    static constexpr size_t LOG_QUEUE_SIZE = 16;
-    static constexpr size_t LOG_MSG_MAX    = 256;
-    char         logQueue[LOG_QUEUE_SIZE][LOG_MSG_MAX];
-    uint8_t      logQueueHead;
-    uint8_t      logQueueTail;
-    uint8_t      logQueueCount;
-    uint32_t     logsDropped;
+    uint32_t connectCount;
+
+    // Outbound log ring buffer (4 KB RAM, variable-length lines — see LogRing.h)
+    // logQueueMux guards the ring buffer across cores (the Logger sink task on
+    // Core 0 calls publishLog; before loggerBegin() any logging task does).
+    static constexpr size_t LOG_RING_BYTES = 4096;
+    static constexpr size_t LOG_MSG_MAX    = 256;   // longest line kept, incl. NUL
+    LogRing<LOG_RING_BYTES> logRing;
+    uint32_t     logsSent;
+    uint32_t     logPublishes;
     portMUX_TYPE logQueueMux;
 
-    // Subscriber fan-out (PubSubClient only supports one global callback)
+    // Subscriber fan-out (PubSubClient only supports one global callback).
+    // Filters are kept for resubscribing after a reconnect; the trie maps a
+    // topic to subscription indices.
+    static constexpr uint8_t MAX_SUBSCRIPTIONS = TopicTrie::MAX_LINKS;
+    static constexpr size_t  FILTER_MAX        = 96;
     struct Subscription {
-        String          filter;
-        MessageCallback cb;
+        char           filter[FILTER_MAX];
+        MessageHandler handler;
+        void*          ctx;
     };
-    std::vector<Subscription> subscriptions;
-
-    // Reentrancy guard — prevents MQTTService internal code (e.g. reconnect
-    // log messages) from recursing back into publish() and corrupting client state.
-    bool inMqttCall;
+    Subscription subscriptions[MAX_SUBSCRIPTIONS];
+    uint8_t      subscriptionCount;
+    TopicTrie    topicTrie;
+
+    // Outbound publishes (loop task, backfill, ... → network task) and
+    // received messages (network task → loop()). A built-in topic is named
+    // by kind and resolved on the task, so callers don't copy it.
+    enum TopicKind : uint8_t {
+        TOPIC_EXPLICIT = 0,
+        TOPIC_TELEMETRY,
+        TOPIC_TELEMETRY_PACKED,
+        TOPIC_INFO,
+    };
+    static constexpr size_t OUTBOX_BYTES = 4096;
+    static constexpr size_t INBOX_BYTES  = 2048;
+    MessageQueue<OUTBOX_BYTES> outbox;
+    MessageQueue<INBOX_BYTES>  inbox;
+    portMUX_TYPE outboxMux;
+    portMUX_TYPE inboxMux;
+    uint8_t      subscribedCount;    // subscriptions sent to the broker this session
+
+    TaskHandle_t taskHandle;
+    static constexpr uint32_t    TASK_STACK    = 8192;  // mbedTLS handshake
+    static constexpr UBaseType_t TASK_PRIORITY = 1;
+    static constexpr BaseType_t  TASK_CORE     = 0;
+    static void taskEntry(void* arg);
+    // HostResolver source: the broker host
+    static bool brokerHostSource(void* ctx, uint8_t index, char* host, size_t len);
 
     // Static trampoline for PubSubClient's single callback slot
     static MQTTService* s_instance;
     static void onMessageTrampoline(char* topic, byte* payload, unsigned int length);
-    void        dispatchMessage(const char* topic, const char* payload);
+    void        dispatchMessage(const char* topic, const uint8_t* payload, size_t len);
 
+    bool enqueue(uint8_t kind, const char* topic, const uint8_t* payload, size_t len, bool retained);
+    void networkLoop();              // one pass of the network task
+    void applyReload();
     void tryReconnect();
+    void subscribePending();
+    void drainOutbox();
     void drainLogQueue();
+    void dispatchInbox();
     void buildClientIdAndDefaults();  // derive clientId + default baseTopic from MAC
     void readNvs();
     void applyServerConfig();
@@ -0,0 +1,159 @@
+#pragma once
+
+/*
+    MessageQueue.h
+
+    Fixed-size FIFO of MQTT messages (topic + binary payload) in one byte
+    buffer, for handing publishes to MQTTService's network task and received
+    messages back to the loop task. Each record is
+
+        [kind u8][flags u8][topic len u16][payload len u16][topic '\0'][payload]
+
+    stored contiguously: a record never straddles the end of the buffer (the
+    data end is remembered as wrapAt, as in LogRing.h), so peek() can hand
+    out pointers straight into the queue and the topic is already
+    NUL-terminated for PubSubClient. `kind` lets the producer name one of
+    the service's own topics without copying it (the topic is then empty).
+
+    Unlike the log ring a full queue rejects the new message: the producer
+    learns it wasn't queued and can retry or store it.
+
+    Not thread-safe on its own. One producer side and one consumer, both
+    under the owner's lock; the record returned by peek() stays valid
+    outside the lock until pop(), because push() only writes free space.
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+template <size_t N>
+class MessageQueue {
+    static_assert(N >= 64 && N <= 65535, "MessageQueue size out of range");
+
+public:
+    static constexpr size_t HEADER = 6;
+    static constexpr uint8_t FLAG_RETAINED = 0x01;
+
+    struct Message {
+        uint8_t        kind;
+        bool           retained;
+        const char*    topic;      // NUL-terminated, "" for a built-in kind
+        const uint8_t* payload;
+        size_t         len;
+    };
+
+    MessageQueue() { clear(); }
+
+    void clear() {
+        head = tail = 0;
+        wrapAt = N;
+        wrapped = false;
+        usedBytes = 0;
+        count = 0;
+    }
+
+    // Bytes a message occupies; anything over capacity() / 2 is refused.
+    static size_t recordSize(size_t topicLen, size_t len) { return HEADER + topicLen + 1 + len; }
+
+    bool push(uint8_t kind, bool retained, const char* topic, const void* payload, size_t len) {
+        size_t tlen = topic ? strlen(topic) : 0;
+        size_t m = recordSize(tlen, len);
+        size_t at;
+        if (tlen > 0xFFFF || len > 0xFFFF || m > N / 2 || !place(m, at)) {
+            drops++;
+            return false;
+        }
+        uint8_t* p = buf + at;
+        p[0] = kind;
+        p[1] = retained ? FLAG_RETAINED : 0;
+        uint16_t t16 = (uint16_t)tlen;
+        uint16_t l16 = (uint16_t)len;
+        memcpy(p + 2, &t16, 2);
+        memcpy(p + 4, &l16, 2);
+        if (tlen) memcpy(p + HEADER, topic, tlen);
+        p[HEADER + tlen] = '\0';
+        if (len) memcpy(p + HEADER + tlen + 1, payload, len);
+        head = at + m;
+        usedBytes += m;
+        count++;
+        if (usedBytes > highWater) highWater = usedBytes;
+        return true;
+    }
+
+    // Oldest message, left in place until pop().
+    bool peek(Message& out) const {
+        if (count == 0) return false;
+        const uint8_t* p = buf + tail;
+        uint16_t t16, l16;
+        memcpy(&t16, p + 2, 2);
+        memcpy(&l16, p + 4, 2);
+        out.kind = p[0];
+        out.retained = (p[1] & FLAG_RETAINED) != 0;
+        out.topic = (const char*)p + HEADER;
+        out.payload = p + HEADER + t16 + 1;
+        out.len = l16;
+        return true;
+    }
+
+    void pop() {
+        if (count == 0) return;
+        uint16_t t16, l16;
+        memcpy(&t16, buf + tail + 2, 2);
+        memcpy(&l16, buf + tail + 4, 2);
+        size_t m = recordSize(t16, l16);
+        tail += m;
+        usedBytes -= m;
+        count--;
+        if (count == 0) {
+            head = tail = 0;
+            wrapAt = N;
+            wrapped = false;
+        } else if (wrapped && tail >= wrapAt) {
+            tail = 0;
+            wrapAt = N;
+            wrapped = false;
+        }
+    }
+
+    uint16_t size()           const { return count; }
+    bool     empty()          const { return count == 0; }
+    size_t   bytesUsed()      const { return usedBytes; }
+    size_t   highWaterBytes() const { return highWater; }
+    uint32_t dropped()        const { return drops; }
+    static constexpr size_t capacity() { return N; }
+
+private:
+    bool place(size_t m, size_t& at) {
+        if (!wrapped) {
+            if (N - head >= m) {
+                at = head;
+                return true;
+            }
+            if (tail >= m) {
+                wrapAt = head;
+                wrapped = true;
+                at = 0;
+                return true;
+            }
+            return false;
+        }
+        if (tail - head >= m) {
+            at = head;
+            return true;
+        }
+        return false;
+    }
+
+    uint8_t  buf[N];
+    size_t   head;
+    size_t   tail;
+    size_t   wrapAt;
+    bool     wrapped;
+    size_t   usedBytes;
+    uint16_t count;
+    size_t   highWater = 0;
+    uint32_t drops = 0;
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+/*
+    NotificationBatch.h
+
+    Coalescing buffer for NotificationWorker's one-shot (non-emergency)
+    messages. Messages that arrive within the coalescing window are held
+    here and then sent as combined bodies, one line per message, so a burst
+    (sensor failure, recovery, silence confirm, bus error in quick
+    succession) costs one HTTPS round trip and one SMS instead of four.
+
+    The window opens with the first message and the batch is due once it
+    has elapsed or the batch is full. build() splits the batch into bodies
+    that fit a channel's size limit, keeping messages whole and in order; a
+    single message longer than the limit is truncated rather than dropped.
+    Each message keeps its own channel mask, so a channel only receives the
+    messages addressed to it.
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+class NotificationBatch {
+public:
+    static constexpr uint8_t MAX_ITEMS = 8;
+    static constexpr size_t  ITEM_MAX  = 160;   // NotifMsg.body
+
+    NotificationBatch() : count(0), openedMs(0) {}
+
+    uint8_t size()  const { return count; }
+    bool    empty() const { return count == 0; }
+    bool    full()  const { return count >= MAX_ITEMS; }
+
+    // Append a message. The first one opens the window. Returns false when
+    // the batch is full.
+    bool add(const char* body, uint8_t channels, uint32_t nowMs) {
+        if (full() || !body) return false;
+        if (count == 0) openedMs = nowMs;
+        strncpy(bodies[count], body, ITEM_MAX - 1);
+        bodies[count][ITEM_MAX - 1] = '\0';
+        masks[count] = channels;
+        count++;
+        return true;
+    }
+
+    bool due(uint32_t nowMs, uint32_t windowMs) const {
+        return count > 0 && (full() || nowMs - openedMs >= windowMs);
+    }
+
+    // ms until due (0 when due now), UINT32_MAX when empty.
+    uint32_t msUntilDue(uint32_t nowMs, uint32_t windowMs) const {
+        if (count == 0) return UINT32_MAX;
+        if (due(nowMs, windowMs)) return 0;
+        return windowMs - (nowMs - openedMs);
+    }
+
+    // Union of every message's channel mask.
+    uint8_t channels() const {
+        uint8_t m = 0;
+        for (uint8_t i = 0; i < count; i++) m |= masks[i];
+        return m;
+    }
+
+    // True when every message targets the same channels.
+    bool uniform() const {
+        for (uint8_t i = 1; i < count; i++) {
+            if (masks[i] != masks[0]) return false;
+        }
+        return true;
+    }
+
+    // Join the messages addressed to any channel in channelMask, starting at
+    // item `from`, into out (at most limit - 1 chars, newline-separated).
+    // Returns the index of the first message that didn't fit, or size() when
+    // the rest of the batch was consumed. out is empty if nothing from
+    // `from` onwards is addressed to channelMask.
+    uint8_t build(uint8_t channelMask, uint8_t from, char* out, size_t limit) const {
+        if (limit == 0) return count;
+        out[0] = '\0';
+        size_t len = 0;
+        uint8_t i = from;
+        for (; i < count; i++) {
+            if (!(masks[i] & channelMask)) continue;
+            size_t n = strlen(bodies[i]);
+            if (len == 0) {
+                if (n > limit - 1) n = limit - 1;   // lone oversized message: truncate
+                memcpy(out, bodies[i], n);
+                len = n;
+            } else {
+                if (len + 1 + n > limit - 1) break;
+                out[len++] = '\n';
+                memcpy(out + len, bodies[i], n);
+                len += n;
+            }
+            out[len] = '\0';
+        }
+        return i;
+    }
+
+    void clear() { count = 0; }
+
+private:
+    char     bodies[MAX_ITEMS][ITEM_MAX];
+    uint8_t  masks[MAX_ITEMS];
+    uint8_t  count;
+    uint32_t openedMs;
+};
@@ -12,11 +12,20 @@
     - isConfigured() must be fast (in-RAM, no NVS I/O).
     - loadCache() is called once at startup to prime the in-RAM state.
     - name() and channelFlag() return compile-time constants; no allocation.
+    - endpointHost() feeds DNS prefetch (HostResolver.h) from the same
+      in-RAM cache send() uses.
+    - maxMessageLength() bounds the bodies the worker builds when it
+      coalesces several messages into one send; never above NOTIFY_BODY_MAX.
 */
 
 #include <stdint.h>
 #include <stddef.h>
 
+// Longest body (excluding NUL) any channel's send() may be handed. Single
+// messages are at most 159 chars (NotifMsg.body); only coalesced bodies
+// get longer.
+constexpr size_t NOTIFY_BODY_MAX = 320;
+
 class NotificationChannel {
 public:
     virtual ~NotificationChannel() = default;
@@ -35,6 +44,15 @@ public:
     /// Single-bit flag identifying this channel in a NotifMsg.channels bitmask.
     virtual uint8_t channelFlag() const = 0;
 
+    /// Longest message body (chars, excluding NUL) this channel accepts in
+    /// one send. At most NOTIFY_BODY_MAX, at least 159.
+    virtual size_t maxMessageLength() const = 0;
+
+    /// Host send() connects to, copied into host (len bytes). Returns false
+    /// if the channel isn't configured or the host doesn't fit. Called from
+    /// the DNS refresh task.
+    virtual bool endpointHost(char* host, size_t len) const = 0;
+
     /// Load NVS config into the in-RAM cache.  Called once at startup and
     /// again after any config update so sends pick up new values immediately.
     virtual void loadCache() = 0;
@@ -4,35 +4,65 @@ class NotificationWorker;
 
 #include <Arduino.h>
 #include <freertos/FreeRTOS.h>
-#include <freertos/queue.h>
+#include <freertos/semphr.h>
 #include <freertos/task.h>
 #include "NotifyChannelFlags.h"
 #include "NotificationChannel.h"
+#include "StateMachine.h"   // StateMachineEventRecord
+#include "DeliveryScheduler.h"
+#include "NotificationBatch.h"
+#include "NotifyQueue.h"
+#include "LatencyHistogram.h"
 
 // SMS and Discord (and any future channel) are all coalesced into one item so
 // every channel is dropped together if the queue is full — prevents partial
 // delivery (e.g. SMS only, no Discord).
+//
+// State-machine events travel as their typed record and are formatted into
+// body by the worker task just before delivery (AlertFormatter.h).
 struct NotifMsg {
     char    body[160];
-    uint8_t channels; // bitmask of CHAN_* flags
+    uint8_t channels;      // bitmask of CHAN_* flags
+    bool    formatPending; // body is empty; build it from event/traceId
+    uint32_t traceId;
+    StateMachineEventRecord event;
+    uint32_t enqueuedMs;   // millis() when posted; start of the latency clock
 };
 
 // Runs outbound HTTP (SMS, Discord, Custom, …) on Core 0 so the main-loop
 // state machine is never blocked by a 10-second provider timeout.
 //
-// Two queues, drained with strict priority (H3):
-//   - emergencyMailbox: depth-1, written with xQueueOverwrite — a newer
-//                       emergency snapshot replaces an older unsent one. This
-//                       coalesces a backlog so that when WiFi returns after an
-//                       outage the owner gets ONE current alert, not N stale
-//                       ones. ALWAYS drained before the FIFO.
-//   - fifoQueue:        one-shot event messages (silence confirm, bus error).
-//                       Each is distinct, so each is delivered.
-// The task blocks on a direct task notification (not a queue set, which makes
-// no ordering guarantee between members). Producers signal via xTaskNotifyGive
-// after posting; on wake the task polls emergency first, then FIFO, so an
-// emergency snapshot present at wake time is always delivered ahead of FIFO
-// backlog accumulated during a WiFi outage.
+// One priority queue with per-class capacity (NotifyQueue.h), drained in
+// strict class order (H3): emergency, fault, info, OTA.
+//   - emergency: capacity 1, always deduplicated — a newer emergency snapshot
+//                replaces an older unsent one, so when WiFi returns after an
+//                outage the owner gets ONE current alert, not N stale ones.
+//   - fault/info/OTA: FIFO within the class. A message with a dedup key
+//                replaces the queued one with the same key (a second "sensor
+//                failure" doesn't take another slot); a full class drops the
+//                newest and counts it per class.
+// The queue is guarded by a mutex; producers signal via xTaskNotifyGive after
+// posting and the task blocks on that direct notification.
+//
+// Retries are scheduled per channel (DeliveryScheduler.h): each dequeued
+// message moves into an in-flight slot and onto the lane of every channel
+// it targets. A failed send re-arms only that channel's lane on the 5/15/30 s
+// backoff; the other channels and the messages behind them keep going. The
+// task sleeps until the earliest lane deadline or the next producer signal,
+// so an emergency posted mid-backoff is sent immediately.
+//
+// Optional coalescing (setCoalesceWindow): non-emergency messages arriving within the
+// window are merged into one newline-separated body per channel, split to
+// each channel's maxMessageLength(), so a burst costs one send per channel
+// instead of one per message. Emergencies are never held back.
+//
+// Test sends from the web UI (requestTest) go through the same task, one at
+// a time, after anything already due, so a provider timeout stalls neither
+// the caller nor an alert. The caller polls getTestStatus() for the result.
+//
+// Latency is tracked per channel in log-scale histograms (LatencyHistogram.h):
+// enqueue -> first attempt (queueing + coalescing delay), enqueue -> success
+// (including retries), and the duration of each send() call.
 class NotificationWorker {
 public:
     NotificationWorker() = default;
@@ -42,18 +72,61 @@ public:
     // The caller owns the channel objects; they must outlive this worker.
     void begin(NotificationChannel** channels, size_t count, bool dryRun = false);
 
-    // Enqueue a one-shot event notification. One FIFO slot = one alert;
-    // returns false and logs if the FIFO is full.
+    // Hold non-emergency messages for up to windowMs and send them combined. 0 (the
+    // default) sends each message on its own. Call before begin().
+    void setCoalesceWindow(uint32_t windowMs) { coalesceWindowMs = windowMs; }
+
+    // Enqueue a one-shot notification in class cls (never NOTIFY_EMERGENCY;
+    // use enqueueEmergency). key != NOTIFY_KEY_NONE replaces a queued message
+    // with the same key. Returns false and logs if the class is full.
     // channels: bitmask of CHAN_* flags (default: CHAN_ALL)
-    bool enqueue(const char* message, uint8_t channels = CHAN_ALL);
+    bool enqueue(const char* message, uint8_t channels = CHAN_ALL,
+                 NotifyClass cls = NOTIFY_INFO, uint8_t key = NOTIFY_KEY_NONE);
 
-    // Enqueue an emergency snapshot into the latest-wins mailbox. Always
-    // succeeds, replacing any older unsent snapshot. Use this for periodic
-    // EMERGENCY-state alerts so an outage backlog collapses to the latest.
+    // Enqueue an emergency snapshot. Always succeeds, replacing any older
+    // unsent snapshot. Use this for periodic EMERGENCY-state alerts so an
+    // outage backlog collapses to the latest.
     bool enqueueEmergency(const char* message, uint8_t channels = CHAN_ALL);
 
+    // Enqueue a state-machine event; the text is formatted on the worker
+    // task. SM_EVENT_EMERGENCY replaces the pending emergency snapshot,
+    // sensor failure/recovery go to the fault class and silence confirms to
+    // info, each deduplicated by event type. Events without an owner message
+    // are ignored.
+    bool enqueueEvent(const StateMachineEventRecord& event, uint32_t traceId,
+                      uint8_t channels = CHAN_ALL);
+
+    enum TestStatus : uint8_t { TEST_NONE, TEST_PENDING, TEST_OK, TEST_FAILED };
+
+    // Send `message` once on `channel` from the worker task, bypassing the
+    // queue and retries. Returns an id for getTestStatus(), or 0 when a test
+    // is already pending or the task isn't running.
+    uint32_t requestTest(NotificationChannel* channel, const char* message);
+    // TEST_NONE for an id that isn't the latest test.
+    TestStatus getTestStatus(uint32_t id) const;
+
+    // Messages queued (not yet in flight), all classes.
     uint32_t getPendingCount() const;
-    uint32_t getDropCount() const { return dropCount; }
+    // Messages shed because their class was full: in total, or per class.
+    uint32_t getDropCount() const;
+    uint32_t getDropCount(NotifyClass cls) const;
+    // Queued messages replaced by a newer one with the same key.
+    uint32_t getDedupCount(NotifyClass cls) const;
+
+    enum LatencyKind : uint8_t {
+        LATENCY_QUEUE,     // enqueue -> first send attempt
+        LATENCY_DELIVER,   // enqueue -> successful send
+        LATENCY_SEND,      // one send() call (HTTP round trip incl. connect)
+        LATENCY_KINDS
+    };
+
+    size_t      getChannelCount() const { return channelCount; }
+    const char* getChannelName(size_t i) const;
+    // Copy of a channel's histogram (taken under the queue mutex).
+    LatencyHistogram getLatency(size_t channel, LatencyKind kind) const;
+    // {"queue":{..},"deliver":{..},"send":{..}} for channel i; 0 if out is
+    // too small.
+    size_t formatLatencyJson(size_t channel, char* out, size_t len) const;
 
     // H5: stack high-water mark for the worker task (bytes of free stack ever
     // remaining). Returns 0 if the task isn't running.
@@ -61,28 +134,60 @@ public:
 
 private:
     static void taskEntry(void* arg);
+    // HostResolver source: the index'th channel's endpoint host
+    static bool endpointHostSource(void* ctx, uint8_t index, char* host, size_t len);
     void run();
-    void deliver(NotifMsg& msg); // per-channel send with bounded retry/backoff
+    bool post(NotifMsg& msg, NotifyClass cls, uint8_t key);  // stamps enqueuedMs
+    bool take(NotifMsg& msg, NotifyClass& cls, bool emergencyOnly);
+    void prepare(NotifMsg& msg);                // format a pending event body
+    void admit(NotifMsg& msg, bool emergency); // move into an in-flight slot
+    void flushBatch();                          // coalesced batch -> in-flight slots
+    uint8_t laneMask(uint8_t channels) const;  // requested AND configured lanes
+    size_t laneLimit(uint8_t mask) const;      // smallest maxMessageLength() in mask
+    void sendOne(const DeliveryScheduler::Attempt& a);
+    void recordLatency(uint8_t channel, LatencyKind kind, uint32_t ms);
+    bool runTest();                             // the pending test send, if any
 
     // Channel registry — populated by begin(), used by deliver()
     NotificationChannel** channelRegistry = nullptr;
     size_t                channelCount     = 0;
 
-    QueueHandle_t    fifoQueue        = nullptr;
-    QueueHandle_t    emergencyMailbox = nullptr;
-    TaskHandle_t     taskHandle       = nullptr;
-    uint32_t         dropCount        = 0;
-    bool             dryRun           = false;
+    NotifyQueue<NotifMsg> queue;
+    SemaphoreHandle_t     queueMux    = nullptr;
+    TaskHandle_t          taskHandle  = nullptr;
+    bool                  dryRun      = false;
+
+    uint32_t         coalesceWindowMs = 0;
+
+    // Test send slot, under queueMux
+    NotificationChannel* testChannel = nullptr;
+    char                 testBody[NOTIFY_BODY_MAX + 1];
+    uint32_t             testId      = 0;
+    TestStatus           testStatus  = TEST_NONE;
+
+    // Owned by the worker task only: in-flight message bodies by slot
+    char              inflight[DeliveryScheduler::MAX_SLOTS][NOTIFY_BODY_MAX + 1];
+    uint32_t          inflightEnqueuedMs[DeliveryScheduler::MAX_SLOTS] = {};
+    DeliveryScheduler sched{RETRY_BACKOFF_MS};
+
+    // Coalescing stage. While `flushing`, flushCursor[lane] is the next
+    // batch item that lane still has to be given a slot for.
+    NotificationBatch batch;
+    bool              flushing = false;
+    uint8_t           flushCursor[DeliveryScheduler::MAX_CHANNELS] = {};
+    uint32_t          batchEnqueuedMs = 0;  // oldest message in the batch
+
+    // Written by the worker task, read by telemetry/debug under queueMux
+    LatencyHistogram  latency[DeliveryScheduler::MAX_CHANNELS][LATENCY_KINDS];
 
-    static constexpr size_t      FIFO_DEPTH    = 8;
-    static constexpr uint32_t    TASK_STACK    = 8192;
+    static constexpr uint32_t    TASK_STACK    = 9216; // + escape buffers for coalesced bodies
     static constexpr UBaseType_t TASK_PRIORITY = 1;
     static constexpr BaseType_t  TASK_CORE     = 0;
 
     // Per-channel retry: a failed critical alert is retried with backoff instead
     // of waiting a full notification cycle. Backoff array length = ATTEMPTS - 1.
-    static constexpr uint8_t  SEND_ATTEMPTS        = 4;
-    static constexpr uint32_t RETRY_BACKOFF_MS[3]  = {5000, 15000, 30000};
+    static constexpr uint8_t  SEND_ATTEMPTS        = DeliveryScheduler::SEND_ATTEMPTS;
+    static constexpr uint32_t RETRY_BACKOFF_MS[SEND_ATTEMPTS - 1] = {5000, 15000, 30000};
 };
 
 #endif // UNIT_TESTING
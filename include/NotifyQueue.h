@@ -0,0 +1,155 @@
+#pragma once
+
+/*
+    NotifyQueue.h
+
+    Priority queue for outbound notifications, replacing the separate
+    emergency mailbox and one-shot FIFO. Messages belong to a class, drained
+    in strict priority order:
+
+        NOTIFY_EMERGENCY  periodic Tier 1/2 alerts (capacity 1)
+        NOTIFY_FAULT      sensor failure / recovery, I2C bus errors
+        NOTIFY_INFO       silence confirmations and other owner feedback
+        NOTIFY_OTA        firmware update status
+
+    Each class has its own capacity, so a burst of OTA chatter can never
+    take the room a sensor-failure alert needs. Within a class messages are
+    FIFO.
+
+    Key-based dedup: a message pushed with a non-zero key replaces a queued
+    message of the same class and key. The replacement goes to the tail —
+    it's the newest information — so a "sensor recovered" queued between
+    two "sensor failure" messages is still delivered in a sensible order.
+    The emergency class always uses one key, which keeps its latest-wins
+    behaviour: an outage backlog collapses to one current alert.
+
+    A message pushed into a full class (with no duplicate to replace) is
+    dropped and counted per class. The caller serialises access (the worker
+    holds a mutex around push/pop; producers run on other tasks).
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+
+enum NotifyClass : uint8_t {
+    NOTIFY_EMERGENCY,
+    NOTIFY_FAULT,
+    NOTIFY_INFO,
+    NOTIFY_OTA,
+    NOTIFY_CLASS_COUNT
+};
+
+// Dedup keys. NOTIFY_KEY_NONE never deduplicates.
+enum NotifyKey : uint8_t {
+    NOTIFY_KEY_NONE = 0,
+    NOTIFY_KEY_EMERGENCY,
+    NOTIFY_KEY_SENSOR_FAILURE,
+    NOTIFY_KEY_SENSOR_RECOVERED,
+    NOTIFY_KEY_BUS_ERROR,
+    NOTIFY_KEY_SILENCE,
+};
+
+inline const char* notifyClassName(NotifyClass c) {
+    switch (c) {
+        case NOTIFY_EMERGENCY: return "emergency";
+        case NOTIFY_FAULT:     return "fault";
+        case NOTIFY_INFO:      return "info";
+        case NOTIFY_OTA:       return "ota";
+        default:               return "?";
+    }
+}
+
+template <typename T>
+class NotifyQueue {
+public:
+    static constexpr uint8_t MAX_PER_CLASS = 4;
+
+    enum PushResult : uint8_t { QUEUED, REPLACED, DROPPED };
+
+    NotifyQueue() {
+        for (uint8_t c = 0; c < NOTIFY_CLASS_COUNT; c++) {
+            len[c] = 0;
+            drops[c] = 0;
+            dedups[c] = 0;
+        }
+    }
+
+    static uint8_t capacity(NotifyClass c) {
+        static const uint8_t CAP[NOTIFY_CLASS_COUNT] = { 1, 4, 3, 2 };
+        return CAP[c];
+    }
+
+    PushResult push(const T& item, NotifyClass c, uint8_t key) {
+        PushResult result = QUEUED;
+        if (key != NOTIFY_KEY_NONE) {
+            for (uint8_t i = 0; i < len[c]; i++) {
+                if (keys[c][i] == key) {
+                    removeAt(c, i);
+                    dedups[c]++;
+                    result = REPLACED;
+                    break;
+                }
+            }
+        }
+        if (len[c] >= capacity(c)) {
+            drops[c]++;
+            return DROPPED;
+        }
+        items[c][len[c]] = item;
+        keys[c][len[c]] = key;
+        len[c]++;
+        return result;
+    }
+
+    // Oldest message of the highest-priority non-empty class.
+    bool pop(T& out, NotifyClass& cls) {
+        for (uint8_t c = 0; c < NOTIFY_CLASS_COUNT; c++) {
+            if (pop((NotifyClass)c, out)) {
+                cls = (NotifyClass)c;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Oldest message of class c.
+    bool pop(NotifyClass c, T& out) {
+        if (len[c] == 0) return false;
+        out = items[c][0];
+        removeAt(c, 0);
+        return true;
+    }
+
+    uint8_t size(NotifyClass c) const { return len[c]; }
+
+    uint8_t size() const {
+        uint8_t n = 0;
+        for (uint8_t c = 0; c < NOTIFY_CLASS_COUNT; c++) n += len[c];
+        return n;
+    }
+
+    uint32_t dropped(NotifyClass c) const { return drops[c]; }
+    uint32_t deduplicated(NotifyClass c) const { return dedups[c]; }
+
+    uint32_t dropped() const {
+        uint32_t n = 0;
+        for (uint8_t c = 0; c < NOTIFY_CLASS_COUNT; c++) n += drops[c];
+        return n;
+    }
+
+private:
+    void removeAt(NotifyClass c, uint8_t i) {
+        for (uint8_t j = i + 1; j < len[c]; j++) {
+            items[c][j - 1] = items[c][j];
+            keys[c][j - 1] = keys[c][j];
+        }
+        len[c]--;
+    }
+
+    T        items[NOTIFY_CLASS_COUNT][MAX_PER_CLASS];
+    uint8_t  keys[NOTIFY_CLASS_COUNT][MAX_PER_CLASS];
+    uint8_t  len[NOTIFY_CLASS_COUNT];
+    uint32_t drops[NOTIFY_CLASS_COUNT];
+    uint32_t dedups[NOTIFY_CLASS_COUNT];
+};
@@ -12,6 +12,9 @@
     Derived classes call beginLoad()/loadStr()/finishLoad() to populate their
     caches from their keys, and openForWrite()/putStr()/endWrite() followed by
     loadCache() so the in-RAM cache always reflects the last successful save.
+    Saves are write-behind (NvsStore.h): putStr() queues the key and the
+    load path reads through pending values, so loadCache() right after a
+    save already sees it.
 
     Not unit-test-buildable (Preferences is Arduino-only) — same as the
     concrete channels, all of which are excluded from UNIT_TESTING builds.
@@ -19,8 +22,8 @@
 
 #ifndef UNIT_TESTING
 
-#include <Preferences.h>
 #include <Arduino.h>
+#include "NvsStore.h"
 #include "Logger.h"
 
 // Single NVS namespace for all notification channel config.
@@ -30,7 +33,7 @@ static constexpr const char* NOTIFY_NVS_NAMESPACE = "notify";
 
 class NvsChannelBase {
 protected:
-    Preferences prefs;
+    NvsReader prefs;
     bool cacheLoaded = false;
 
     // --- Load path -------------------------------------------------------
@@ -40,7 +43,7 @@ protected:
     // cacheLoaded is still set so a missing namespace isn't retried forever).
     bool beginLoad() {
         cacheLoaded = true;
-        return prefs.begin(NOTIFY_NVS_NAMESPACE, /*readOnly=*/true);
+        return prefs.begin(NOTIFY_NVS_NAMESPACE);
     }
 
     void finishLoad() { prefs.end(); }
@@ -57,21 +60,21 @@ protected:
 
     // --- Save path -------------------------------------------------------
 
+    // Kept as a bracket around putStr() calls; nothing is opened — the
+    // write-behind commit opens the namespace once for the whole batch.
     bool openForWrite(const char* logTag) {
-        if (!prefs.begin(NOTIFY_NVS_NAMESPACE, /*readOnly=*/false)) {
-            LOG_CRITICAL("[%s] Failed to open NVS for writing", logTag);
-            return false;
-        }
+        (void)logTag;
         return true;
     }
 
-    // Write one string key; returns bytes written (0 = failure, matching
+    // Queue one string key; returns its length (0 = failure, matching
     // Preferences::putString semantics).
     size_t putStr(const char* key, const char* value) {
-        return prefs.putString(key, value);
+        if (!value) return 0;
+        return NvsStore::getInstance().putString(NOTIFY_NVS_NAMESPACE, key, value) ? strlen(value) : 0;
     }
 
-    void endWrite() { prefs.end(); }
+    void endWrite() {}
 
     // Convenience: reload the in-RAM cache after a successful write.
     // loadCache() is the channel's own virtual, so this stays in the
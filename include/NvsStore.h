@@ -0,0 +1,141 @@
+#pragma once
+
+/*
+    NvsStore.h
+
+    Write-behind persistence for configuration saves. Writers (SettingsStore,
+    ConfigServer calibration, the notification channels, MQTTService,
+    OTAManager, TelemetryStore) hand typed key updates to put*() and return
+    at once; repeated writes to the same key are coalesced (WriteBehindCache.h)
+    and a low-priority task on Core 0 commits them in one batch per namespace
+    once the writes have been quiet for COMMIT_QUIET_MS (or COMMIT_MAX_DELAY_MS
+    after the first one). No flash erase stall lands on the web handler or
+    the loop task.
+
+    Reads of a namespace with pending writes must see them: NvsReader wraps
+    Preferences (same get*() names) and serves a pending value first, so
+    "save then reload the cache" keeps working before the commit.
+
+    flush() commits synchronously; it also runs from an esp_restart()
+    shutdown handler so a reboot (OTA, /restart) doesn't lose a save made
+    just before it. A crash or power cut inside the quiet window does.
+
+    Writes that must be durable before the next instruction (OTA boot
+    flags) keep using Preferences directly.
+*/
+
+#ifndef UNIT_TESTING
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "WriteBehindCache.h"
+
+class NvsStore {
+public:
+    static NvsStore& getInstance();
+
+    // Start the commit task and register the restart hook. Puts made
+    // before begin() are kept and committed once it runs.
+    void begin();
+
+    // Queue a write. Returns false only for an invalid key or if the value
+    // could not be stored at all (a full cache is committed synchronously
+    // and the put retried).
+    bool putString(const char* ns, const char* key, const char* value);
+    bool putBytes(const char* ns, const char* key, const void* data, size_t len);
+    bool putBool(const char* ns, const char* key, bool value);
+    bool putInt(const char* ns, const char* key, int32_t value);
+    bool putUInt(const char* ns, const char* key, uint32_t value);
+    bool putUShort(const char* ns, const char* key, uint16_t value);
+    bool putFloat(const char* ns, const char* key, float value);
+    bool remove(const char* ns, const char* key);
+
+    // Commit everything pending now, on the calling task.
+    void flush();
+
+    struct Stats {
+        uint32_t puts;
+        uint32_t coalesced;     // puts that replaced a pending value
+        uint32_t commits;       // batches written
+        uint32_t keysWritten;
+        uint32_t failures;      // keys NVS refused (logged)
+        uint8_t  pending;
+    };
+    Stats getStats();
+
+    // --- Used by NvsReader ------------------------------------------------
+
+    typedef WriteBehindCache<32, 2048> Cache;
+
+    // Copy out a pending value for ns/key. Returns false if none is queued
+    // (read NVS); otherwise `type` is the Cache::Type (T_REMOVE = deleted)
+    // and up to outSize bytes are copied, with the full length in lenOut.
+    bool lookup(const char* ns, const char* key, uint8_t& type,
+                void* out, size_t outSize, size_t& lenOut);
+    bool hasPending(const char* ns);
+
+private:
+    NvsStore();
+    NvsStore(const NvsStore&) = delete;
+    NvsStore& operator=(const NvsStore&) = delete;
+
+    bool put(const char* ns, const char* key, uint8_t type, const void* data, size_t len);
+    // take() and write, holding commitMux (gives up after `wait`)
+    void commit(bool force, TickType_t wait = portMAX_DELAY);
+    void writeBatch(const Cache& batch);
+    static void taskEntry(void* arg);
+    static void onShutdown();
+
+    static constexpr uint32_t COMMIT_QUIET_MS     = 2000;
+    static constexpr uint32_t COMMIT_MAX_DELAY_MS = 10000;
+    static constexpr uint32_t POLL_MS             = 250;
+
+    static constexpr uint32_t    TASK_STACK    = 4096;
+    static constexpr UBaseType_t TASK_PRIORITY = 1;
+    static constexpr BaseType_t  TASK_CORE     = 0;
+
+    Cache             pending;
+    Cache             committing;     // batch being written; still visible to lookup()
+    SemaphoreHandle_t cacheMux;       // guards pending + committing (short holds)
+    SemaphoreHandle_t commitMux;      // one batch writer at a time (task / flush())
+    TaskHandle_t      taskHandle;
+    Stats             stats;
+};
+
+// Preferences look-alike for the read side: same begin()/get*()/isKey()/end()
+// calls, with write-behind values taking precedence over flash.
+class NvsReader {
+public:
+    NvsReader() : store(NvsStore::getInstance()), ns(nullptr), opened(false) {}
+    ~NvsReader() { end(); }
+
+    // True if the namespace exists in flash or has pending writes
+    bool begin(const char* name);
+    void end();
+
+    String   getString(const char* key, const char* def = "");
+    size_t   getBytesLength(const char* key);
+    size_t   getBytes(const char* key, void* out, size_t len);
+    bool     getBool(const char* key, bool def = false);
+    int32_t  getInt(const char* key, int32_t def = 0);
+    uint32_t getUInt(const char* key, uint32_t def = 0);
+    uint32_t getULong(const char* key, uint32_t def = 0) { return getUInt(key, def); }
+    uint16_t getUShort(const char* key, uint16_t def = 0);
+    float    getFloat(const char* key, float def = NAN);
+    bool     isKey(const char* key);
+
+private:
+    // Pending scalar of `type` into out; false = not pending (read flash),
+    // `removed` set when the pending entry deletes the key
+    bool pendingScalar(const char* key, uint8_t type, void* out, size_t len, bool& removed);
+
+    NvsStore&   store;
+    Preferences prefs;
+    const char* ns;
+    bool        opened;
+};
+
+#endif // UNIT_TESTING
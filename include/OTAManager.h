@@ -2,12 +2,12 @@
 
 #include <Arduino.h>
 #include <HTTPClient.h>
-#include <Update.h>
 #include <Preferences.h>
 #include <ArduinoJson.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/semphr.h>
+#include <freertos/queue.h>
 #include <atomic>
 #include "NotificationWorker.h"
 #include "TimeManagement.h"
@@ -15,7 +15,16 @@
 constexpr const char OTA_PREFERENCES_NAMESPACE[] = "ota_config";
 constexpr unsigned long DEFAULT_CHECK_INTERVAL_MS = 86400000; // 24 hours
 constexpr unsigned long MIN_CHECK_INTERVAL_MS = 43200000; // 12 hours (NVS wear floor)
-constexpr int OTA_BUFFER_SIZE = 1024; // Download buffer size
+constexpr int OTA_BUFFER_SIZE = 1024; // Flash read / hash buffer size
+// Download pipeline: two blocks of one flash sector each, filled from the
+// socket on the check task while ota_write flashes the other (fetchStream)
+constexpr size_t   OTA_PIPE_BLOCK_SIZE   = 4096;
+constexpr uint32_t OTA_WRITER_TASK_STACK = 6144;
+// Resumable downloads: an interrupted full-image download continues with an
+// HTTP Range request from the last flashed sector (downloadAndInstall)
+constexpr int           OTA_RESUME_ATTEMPTS       = 3;      // fetches per install, the first included
+constexpr unsigned long OTA_RESUME_RETRY_DELAY_MS = 5000;
+constexpr size_t        OTA_RESUME_NVS_STRIDE     = 65536;  // NVS checkpoint every 64 KB (RTC every sector)
 constexpr int OTA_MIN_RSSI_DBM = -70; // Minimum signal strength required before starting a download
 
 // Time constants
@@ -31,7 +40,24 @@ constexpr unsigned long REBOOT_DELAY_MS = 3000; // 3 seconds
 constexpr size_t NOTIFICATION_MESSAGE_BUFFER_SIZE = 150;
 constexpr size_t SHORT_MESSAGE_BUFFER_SIZE = 120;
 
+// OTA state is kept in fixed buffers, not String: it lives for the whole
+// uptime and is rewritten by every check, so heap copies would fragment
+// the heap the TLS handshake needs. Sizes include the terminator; a value
+// that doesn't fit is refused rather than cut.
+constexpr size_t OTA_OWNER_MAX    = 40;    // GitHub user/org names: 39 chars
+constexpr size_t OTA_REPO_MAX     = 101;   // repository names: 100 chars
+constexpr size_t OTA_TOKEN_MAX    = 128;   // fine-grained PATs are 93 chars
+constexpr size_t OTA_PASSWORD_MAX = 64;
+constexpr size_t OTA_VERSION_MAX  = 24;
+constexpr size_t OTA_URL_MAX      = 256;   // release asset URLs run ~120 B
+constexpr size_t OTA_SHA256_HEX   = 65;
+constexpr size_t OTA_ETAG_MAX     = 80;    // W/"<64 hex>"
+constexpr size_t OTA_HTTP_DATE_MAX = 32;   // IMF-fixdate is 29 chars
+constexpr size_t OTA_ERROR_MAX    = 96;
+
 // HTTP status codes
+constexpr int HTTP_PARTIAL_CONTENT = 206;
+constexpr int HTTP_NOT_MODIFIED = 304;
 constexpr int HTTP_FORBIDDEN = 403;
 constexpr int HTTP_TOO_MANY_REQUESTS = 429;
 
@@ -55,10 +81,10 @@ enum class OTAState {
 };
 
 struct OTAConfig {
-    String githubOwner;
-    String githubRepo;
-    String githubToken;         // Optional, for private repos
-    String updatePassword;      // Optional password protection
+    char githubOwner[OTA_OWNER_MAX];
+    char githubRepo[OTA_REPO_MAX];
+    char githubToken[OTA_TOKEN_MAX];        // Optional, for private repos
+    char updatePassword[OTA_PASSWORD_MAX];  // Optional password protection
     bool autoCheckEnabled;
     bool autoInstallEnabled;    // Automatically install updates when found
     unsigned long checkIntervalMs;
@@ -66,11 +92,29 @@ struct OTAConfig {
 };
 
 struct VersionInfo {
-    String currentVersion;
-    String availableVersion;
-    String downloadUrl;
+    char   availableVersion[OTA_VERSION_MAX];
+    char   downloadUrl[OTA_URL_MAX];
     size_t firmwareSize;
-    String firmwareHash;        // Optional SHA256 hash for verification
+    char   firmwareHash[OTA_SHA256_HEX];  // Optional SHA256 hash for verification
+    // Delta patch against the running version (firmware-from-<current>.delta,
+    // scripts/make_delta.py). Empty if the release doesn't carry one.
+    char   deltaUrl[OTA_URL_MAX];
+    size_t deltaSize;
+};
+
+// The latest release as last parsed (checkForUpdates), persisted with its
+// HTTP validators. A check sends them as If-None-Match / If-Modified-Since;
+// a 304 reuses the rest without a body to read or parse.
+struct ReleaseInfo {
+    char   etag[OTA_ETAG_MAX];
+    char   lastModified[OTA_HTTP_DATE_MAX];
+    char   forVersion[OTA_VERSION_MAX];   // running version deltaUrl was matched against
+    char   version[OTA_VERSION_MAX];      // tag_name without the leading "v"
+    char   downloadUrl[OTA_URL_MAX];
+    size_t firmwareSize;
+    char   firmwareHash[OTA_SHA256_HEX];
+    char   deltaUrl[OTA_URL_MAX];
+    size_t deltaSize;
 };
 
 /**
@@ -80,6 +124,7 @@ struct VersionInfo {
  * - Check GitHub Releases for new firmware versions (on a dedicated Core 0 task)
  * - Download and install firmware updates via HTTPS (on the loop task — device
  *   is intentionally out-of-service during a download anyway)
+ * - Resume interrupted downloads (stall or reboot) with HTTP Range requests
  * - Automatic version checking on schedule without blocking loop()
  * - Manual update triggering via web interface
  * - Notification integration via NotificationWorker (no direct send() calls)
@@ -95,36 +140,66 @@ private:
     // Concurrency model (three tasks touch this state: the Core 0 check task,
     // the Core 1 loop task, and the web-server task via the getters):
     //   - currentState: std::atomic — read/written lock-free from any task.
-    //   - lastError / versionInfo / lastCheckTime: String/struct fields that are
-    //     NOT safe to copy while another task mutates them, so every access goes
+    //   - lastError / versionInfo / lastCheckTime / config strings: fixed
+    //     buffers a reader could see half-rewritten, so every access goes
     //     through stateMux. Write lastError via setError(); read via getLastError().
-    //   - versionInfo.currentVersion is set once in the constructor and then
-    //     treated as immutable, so it may be read lock-free.
+    //     The check task works from installInfo, its own copy, while it installs.
+    //   - currentVersion is FIRMWARE_VERSION, so it may be read lock-free.
     std::atomic<OTAState> currentState;
+    const char*   currentVersion;
     OTAConfig     config;
     VersionInfo   versionInfo;
+    VersionInfo   installInfo;      // check task only: executeUpdate()'s snapshot of versionInfo
     unsigned long lastCheckTime;
-    String        lastError;
+    char          lastError[OTA_ERROR_MAX];
+    ReleaseInfo   release;          // check task only (and loadConfig() before it starts)
+    ReleaseInfo   fresh;            // check task only: the release a 200 is parsed into
 
     // FreeRTOS primitives for the background check task
-    SemaphoreHandle_t stateMux;      // Mutex protecting lastError / versionInfo / lastCheckTime
+    SemaphoreHandle_t stateMux;      // Mutex protecting lastError / versionInfo / lastCheckTime / config
     TaskHandle_t      checkTaskHandle;
     volatile bool     checkRequested; // Set by loop task, consumed by check task
     volatile bool     installRequested; // Set by startUpdate(), consumed by check task
-    char              installPassword[64]; // Snapshot of the install password for the check task
+    char              installPassword[OTA_PASSWORD_MAX]; // Snapshot of the install password for the check task
 
     // Helper methods
     void loadConfig();
     void saveConfig();
+    void saveRelease();                 // write-behind, only when the release changes
     void sendNotification(const char* message);
-    void setError(const String& msg);   // Thread-safe write to lastError (takes stateMux)
+    // Thread-safe printf-style write to lastError (takes stateMux)
+    void setError(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
     bool checkForUpdates();
-    bool compareVersions(const String& v1, const String& v2);
-    bool downloadAndInstall(const String& url, size_t expectedSize, const String& expectedSha256);
+    bool compareVersions(const char* v1, const char* v2);
+    bool downloadAndInstall(const char* url, size_t expectedSize, const char* expectedSha256);
+    // Apply a delta patch from the running partition into the inactive one.
+    // On any failure the caller falls back to downloadAndInstall().
+    bool downloadAndInstallDelta(const char* url, size_t targetSize, const char* expectedSha256);
+
+    // Receives a download's body (fetchStream). begin() gets the offset the
+    // body starts at (0 unless a Range request was honoured) and the
+    // Content-Length; returning false from either aborts the download, after
+    // the sink has called setError().
+    struct DownloadSink {
+        virtual bool begin(size_t offset, int contentLength) = 0;
+        virtual bool write(const uint8_t* data, size_t len) = 0;
+    };
+    // GET url (following the GitHub redirect) and stream the body into sink,
+    // with the flood-watch abort and the DOWNLOAD/STALL timeouts. A non-zero
+    // offset asks for the rest of the file with a Range header.
+    bool fetchStream(const char* url, DownloadSink& sink, size_t offset = 0);
+    struct ImageWriter;                 // inactive-slot writer + running SHA-256 (.cpp)
+    struct PipeBlock { uint8_t* data; size_t len; };
+    struct WritePipe;                   // fetchStream()'s ota_write stage (.cpp)
+    bool commitImage(ImageWriter& image, const char* expectedSha256);
     void checkFirstBoot();
     void setFirstBootFlag();
     void clearFirstBootFlag();
-    int parseVersionComponent(const String& version, int component);
+    int parseVersionComponent(const char* version, int component);
+    // The settings handlers rewrite config on the web-server task while the
+    // check task reads it, so both sides go through stateMux
+    bool setConfigString(char* field, size_t size, const char* value);
+    bool authHeader(char* out, size_t len) const;   // "Bearer <token>"; false if no token
 
     // Pre-flight validation methods
     bool validateFirmwareSize(size_t size);
@@ -168,9 +243,10 @@ public:
     bool executeUpdate(const char* password);
 
     // Configuration
-    void setGitHubRepo(const char* owner, const char* repo);
-    void setGitHubToken(const char* token);
-    void setUpdatePassword(const char* password);
+    // false (nothing changed) if a value doesn't fit its OTA_*_MAX buffer
+    bool setGitHubRepo(const char* owner, const char* repo);
+    bool setGitHubToken(const char* token);
+    bool setUpdatePassword(const char* password);
     void setAutoCheck(bool enabled, unsigned long intervalMs = DEFAULT_CHECK_INTERVAL_MS);
     void setAutoInstall(bool enabled);
     void setNotificationsEnabled(bool enabled);
@@ -185,19 +261,20 @@ public:
     // Returns 0 if the task isn't running.
     uint32_t getCheckTaskStackHighWaterMark() const;
 
-    // Getters (currentState is atomic; String fields that the check task may
-    // mutate are copied under stateMux — see getAvailableVersion/getLastError).
+    // Getters (currentState is atomic; strings another task may rewrite are
+    // copied into the caller's buffer under stateMux and truncated to len —
+    // see getAvailableVersion/getLastError/getGitHubRepo).
     OTAState getState() const { return currentState.load(); }
-    String getCurrentVersion() const { return versionInfo.currentVersion; } // immutable after ctor
-    String getAvailableVersion() const;   // locks stateMux (defined in .cpp)
-    String getLastError() const;          // locks stateMux (defined in .cpp)
+    const char* getCurrentVersion() const { return currentVersion; } // immutable
+    void getAvailableVersion(char* out, size_t len) const;   // locks stateMux (defined in .cpp)
+    void getLastError(char* out, size_t len) const;          // locks stateMux (defined in .cpp)
     bool isUpdateAvailable() const { return currentState.load() == OTAState::UPDATE_AVAILABLE; }
     bool isAutoCheckEnabled() const { return config.autoCheckEnabled; }
     bool isAutoInstallEnabled() const { return config.autoInstallEnabled; }
     bool areNotificationsEnabled() const { return config.notificationsEnabled; }
-    String getGitHubRepo() const { return config.githubOwner + "/" + config.githubRepo; }
-    bool hasGitHubToken() const { return !config.githubToken.isEmpty(); }
-    bool hasUpdatePassword() const { return !config.updatePassword.isEmpty(); }
+    void getGitHubRepo(char* out, size_t len) const;         // "owner/repo"; locks stateMux
+    bool hasGitHubToken() const { return config.githubToken[0] != '\0'; }
+    bool hasUpdatePassword() const { return config.updatePassword[0] != '\0'; }
     unsigned long getCheckIntervalMs() const { return config.checkIntervalMs; }
     // Seconds since the last version check completed, based on a wall-clock
     // epoch persisted to NVS. Returns 0 if no check has completed yet or the
@@ -0,0 +1,74 @@
+#pragma once
+
+#ifndef UNIT_TESTING
+
+/*
+    PulseOutput.h
+
+    One GPIO that is held off, held on, or plays a PulsePattern on an RMT
+    TX channel in loop mode. The RMT repeats the items from its own memory,
+    so once play() returns the cadence runs with no CPU involvement and no
+    loop() stall can stretch a phase. The status LED (LightCode) and the
+    GPIO 26 alert/horn output each own one.
+
+    The channel counts the 1 MHz REF_TICK divided down to TICK_US, which
+    doesn't move with the APB clock. Each item half covers up to 3.2 s, so
+    the longest horn cycle (2 x MAX_HORN_DURATION_MS) is five of the 64
+    items in the channel's memory block.
+
+    off() and solid() hand the pin back to the GPIO matrix before stopping
+    the channel: the ESP32 RMT can't abort an item in flight, and an item
+    can last seconds. Every setter is a no-op when the output is already
+    doing that, so callers may assert the wanted state on every pass.
+
+    PULSE_OUTPUT_RMT=0, or a channel that won't configure, falls back to
+    digitalWrite() from update(), which then has to run every few tens of
+    milliseconds.
+*/
+
+#include <Arduino.h>
+#include <driver/rmt.h>
+#include "PulsePattern.h"
+
+#ifndef PULSE_OUTPUT_RMT
+#define PULSE_OUTPUT_RMT 1
+#endif
+
+class PulseOutput {
+public:
+    static constexpr uint32_t TICK_US = 100;
+
+    /// No hardware is touched until the first off() / solid() / play(),
+    /// so global instances are safe.
+    PulseOutput(int pin, rmt_channel_t channel);
+
+    void off()   { hold(false); }
+    void solid() { hold(true); }
+
+    /// Repeat phases, starting with the first, until the next call. The
+    /// same cadence again doesn't restart it.
+    /// @return false if the phases don't compile (output left as it was)
+    bool play(const PulsePhase* phases, uint8_t n);
+
+    /// Software fallback; returns at once while the RMT plays the pattern.
+    void update();
+
+    /// true once the RMT channel owns the pattern timing.
+    bool hardwareTimed() const { return rmt; }
+
+private:
+    enum Mode : uint8_t { MODE_OFF, MODE_SOLID, MODE_PATTERN };
+
+    void begin();
+    void hold(bool on);
+
+    int           pin;
+    rmt_channel_t channel;
+    bool          started;
+    bool          rmt;
+    Mode          mode;
+    PulsePattern  pattern;
+    uint32_t      startMs;
+};
+
+#endif // UNIT_TESTING
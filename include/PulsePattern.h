@@ -0,0 +1,152 @@
+#pragma once
+
+/*
+    PulsePattern.h
+
+    Compiles an on/off cadence — a status LED blink code, the Tier 2 horn
+    cycle — into the 32-bit items the ESP32 RMT peripheral plays back
+    (PulseOutput.h). In loop mode the RMT repeats them from its own memory,
+    so the cadence keeps time however long loop() stalls.
+
+    An item is two (level, duration) halves in rmt_item32_t's layout:
+    duration0 bits 0-14, level0 bit 15, duration1 bits 16-30, level1 bit 31.
+    A phase longer than MAX_TICKS is split into near-equal halves at the same
+    level. A zero duration is the end marker that sends a looping RMT back
+    to the first item: compile() ends every pattern with one, either as the
+    second half of the last item or as an item of its own.
+
+    levelAtMs() plays the compiled items back in time — the software
+    fallback when no RMT channel is available, and what the tests check the
+    compiler against.
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+
+struct PulsePhase {
+    bool     on;
+    uint32_t ms;
+};
+
+// Status LED blink codes (LightCode.h)
+static const PulsePhase SLOW_BLINK_PHASES[]   = { { true, 500 }, { false, 500 } };
+static const PulsePhase FAST_BLINK_PHASES[]   = { { true, 100 }, { false, 100 } };
+// Two short flashes and a pause: WiFi disconnected
+static const PulsePhase DOUBLE_BLINK_PHASES[] = { { true, 150 }, { false, 150 },
+                                                  { true, 150 }, { false, 800 } };
+
+class PulsePattern {
+public:
+    static constexpr uint32_t MAX_TICKS = 0x7FFF;   // 15-bit item duration
+    static constexpr uint8_t  MAX_ITEMS = 64;       // one RMT memory block
+
+    PulsePattern() { clear(); }
+
+    /// Compile phases at tickUs microseconds per RMT tick. Zero-length
+    /// phases are skipped.
+    /// @return false, leaving the pattern empty, if tickUs is 0, nothing is
+    ///         left to play, or it needs more than MAX_ITEMS items
+    bool compile(const PulsePhase* phases, uint8_t n, uint32_t tickUs) {
+        clear();
+        if (tickUs == 0 || (phases == nullptr && n > 0)) return false;
+        tick = tickUs;
+
+        uint64_t total = 0;
+        for (uint8_t i = 0; i < n; i++) {
+            uint64_t ticks = ((uint64_t)phases[i].ms * 1000u + tickUs / 2) / tickUs;
+            if (ticks == 0) continue;
+            uint64_t pieces = (ticks + MAX_TICKS - 1) / MAX_TICKS;
+            if (pieces > MAX_HALVES - halves) {
+                clear();
+                return false;
+            }
+            for (uint64_t p = 0; p < pieces; p++) {
+                appendHalf((uint32_t)(ticks / pieces + (p < ticks % pieces ? 1 : 0)), phases[i].on);
+            }
+            total += ticks;
+        }
+        if (halves == 0) {
+            clear();
+            return false;
+        }
+        // An odd half count leaves the last item's second half zero — the
+        // end marker. Otherwise the zeroed item after the last one is.
+        count = (uint8_t)(halves / 2 + 1);
+        period = (uint32_t)total;
+        return true;
+    }
+
+    bool empty() const { return count == 0; }
+
+    /// Items including the end marker, ready for the RMT channel's memory.
+    const uint32_t* items() const { return buf; }
+    uint8_t itemCount() const { return count; }
+
+    uint32_t tickUs() const { return tick; }
+    uint32_t periodTicks() const { return period; }
+    uint32_t periodMs() const { return (uint32_t)((uint64_t)period * tick / 1000u); }
+
+    /// Output level elapsedMs after the pattern started, repeating. false
+    /// for an empty pattern.
+    bool levelAtMs(uint32_t elapsedMs) const {
+        if (count == 0) return false;
+        uint32_t t = (uint32_t)(((uint64_t)elapsedMs * 1000u / tick) % period);
+        for (uint8_t i = 0; i < count; i++) {
+            uint32_t d0 = ticks0(buf[i]);
+            if (t < d0) return level0(buf[i]);
+            t -= d0;
+            uint32_t d1 = ticks1(buf[i]);
+            if (t < d1) return level1(buf[i]);
+            t -= d1;
+        }
+        return false;   // not reached: the halves add up to period
+    }
+
+    bool operator==(const PulsePattern& other) const {
+        if (count != other.count || tick != other.tick || period != other.period) return false;
+        for (uint8_t i = 0; i < count; i++) {
+            if (buf[i] != other.buf[i]) return false;
+        }
+        return true;
+    }
+    bool operator!=(const PulsePattern& other) const { return !(*this == other); }
+
+    static uint32_t item(uint32_t d0, bool l0, uint32_t d1, bool l1) {
+        return (d0 & MAX_TICKS) | ((uint32_t)l0 << 15) |
+               ((d1 & MAX_TICKS) << 16) | ((uint32_t)l1 << 31);
+    }
+    static uint32_t ticks0(uint32_t item) { return item & MAX_TICKS; }
+    static bool     level0(uint32_t item) { return (item >> 15) & 1u; }
+    static uint32_t ticks1(uint32_t item) { return (item >> 16) & MAX_TICKS; }
+    static bool     level1(uint32_t item) { return (item >> 31) & 1u; }
+
+private:
+    // Room for the end marker: 2 * MAX_ITEMS - 1 halves leave the last
+    // item's second half for it
+    static constexpr uint32_t MAX_HALVES = 2u * MAX_ITEMS - 1;
+
+    void clear() {
+        for (uint8_t i = 0; i < MAX_ITEMS; i++) buf[i] = 0;
+        count = 0;
+        halves = 0;
+        tick = 1;
+        period = 0;
+    }
+
+    void appendHalf(uint32_t ticks, bool on) {
+        uint32_t& it = buf[halves / 2];
+        if (halves % 2 == 0) {
+            it = item(ticks, on, 0, false);
+        } else {
+            it |= item(0, false, ticks, on);
+        }
+        halves++;
+    }
+
+    uint32_t buf[MAX_ITEMS];
+    uint8_t  count;
+    uint32_t halves;
+    uint32_t tick;
+    uint32_t period;
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+/*
+    RateEstimator.h
+
+    Streaming, exponentially time-decayed least-squares fit of level vs. time.
+    Every sample updates six running sums in O(1); slope() and its standard
+    error are read back in O(1) at any time, so the rate can be fed from every
+    valid reading instead of one snapshot per 5 minutes, and one noisy reading
+    no longer swings the figure by itself.
+
+    Precision: the time origin is moved to the newest sample and the level
+    origin to the newest value on every update (sums are re-expressed around
+    the new origin), so the sums stay small and the SSE subtraction doesn't
+    cancel away. Internally double — at ~1 Hz the soft-double cost is a few
+    microseconds and float left visible drift in the residual term.
+
+    A gap longer than RESET_GAP_TAUS time constants (sensor fault, reboot of
+    the feed) restarts the fit, so a stale pre-gap trend can't masquerade as
+    a confident current rate.
+
+    Samples are stamped with the sensor path's 64-bit microsecond tick
+    (SensorReading::tickUs, TimeManagement::monoUs()); only differences from
+    the previous sample are taken, so there is no wraparound to handle.
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <math.h>
+#include <stdint.h>
+
+class RateEstimator {
+public:
+    // tauMs       - decay time constant; samples older than ~3*tau barely count
+    // minSpanMs   - slope() is NAN until the fit covers at least this much time
+    RateEstimator(uint32_t tauMs, uint32_t minSpanMs)
+        : tauMin(tauMs / 60000.0), minSpanMs(minSpanMs) {
+        reset();
+    }
+
+    void reset() {
+        count = 0;
+        firstUs = 0;
+        lastUs = 0;
+        yRef = 0.0;
+        s0 = sw2 = st = sy = stt = sty = syy = 0.0;
+    }
+
+    void addSample(int64_t tickUs, float level) {
+        if (count > 0 && minutesSince(tickUs) > RESET_GAP_TAUS * tauMin) {
+            reset();
+        }
+
+        if (count == 0) {
+            firstUs = tickUs;
+            yRef = level;
+        } else {
+            double d = minutesSince(tickUs);
+            double w = exp(-d / tauMin);
+            s0 *= w; st *= w; sy *= w; stt *= w; sty *= w; syy *= w;
+            sw2 *= w * w;
+
+            // Move the time origin forward by d (old t becomes t - d).
+            stt = stt - 2.0 * d * st + d * d * s0;
+            sty = sty - d * sy;
+            st  = st - d * s0;
+
+            // Move the level origin to the new sample (old y becomes y - c).
+            double c = (double)level - yRef;
+            syy = syy - 2.0 * c * sy + c * c * s0;
+            sty = sty - c * st;
+            sy  = sy - c * s0;
+            yRef = level;
+        }
+
+        // The new sample sits at the origin: (t, y) = (0, 0).
+        s0  += 1.0;
+        sw2 += 1.0;
+        lastUs = tickUs;
+        if (count < UINT32_MAX) count++;
+    }
+
+    // Least-squares slope in level units per minute; NAN until ready().
+    float slopePerMinute() const {
+        double b;
+        if (!ready() || !fitSlope(b)) return NAN;
+        return (float)b;
+    }
+
+    // Approximate 1-sigma standard error of slopePerMinute(); NAN until ready()
+    // or when there are too few effective samples to estimate residual noise.
+    float slopeStdErrPerMinute() const {
+        double b;
+        if (!ready() || !fitSlope(b)) return NAN;
+        double nEff = (s0 * s0) / sw2;
+        if (nEff <= 2.0) return NAN;
+
+        double a = (sy - b * st) / s0;
+        double sse = syy - a * sy - b * sty;
+        if (sse < 0.0) sse = 0.0;
+        double sigma2 = (sse / s0) * nEff / (nEff - 2.0);
+        double sxx = stt - st * st / s0;
+        // Scale the weighted spread to effective-sample terms; exact for
+        // uniform weights, a close approximation under exponential decay.
+        double var = sigma2 / (sxx * nEff / s0);
+        return (float)sqrt(var);
+    }
+
+    bool ready() const {
+        return count >= 2 && lastUs - firstUs >= (int64_t)minSpanMs * 1000;
+    }
+
+    uint32_t sampleCount() const { return count; }
+
+private:
+    static constexpr double RESET_GAP_TAUS = 4.0;
+
+    double tauMin;
+    uint32_t minSpanMs;
+
+    uint32_t count;
+    int64_t firstUs;
+    int64_t lastUs;
+    double yRef;
+
+    // Decayed sums around the current (t, y) origin
+    double s0;  // sum w
+    double sw2; // sum w^2 (effective sample count)
+    double st;  // sum w*t
+    double sy;  // sum w*y
+    double stt; // sum w*t^2
+    double sty; // sum w*t*y
+    double syy; // sum w*y^2
+
+    // Minutes from the newest sample to tickUs; a tick that steps back
+    // counts as no time at all
+    double minutesSince(int64_t tickUs) const {
+        return tickUs > lastUs ? (double)(tickUs - lastUs) / 60000000.0 : 0.0;
+    }
+
+    bool fitSlope(double& b) const {
+        double den = s0 * stt - st * st;
+        if (den <= 1e-12) return false;
+        b = (s0 * sty - st * sy) / den;
+        return true;
+    }
+};
@@ -0,0 +1,171 @@
+#pragma once
+
+/*
+    RollingMedian.h
+
+    Incremental median over the last N samples, O(log N) per push.
+
+    Two indexed heaps share one value array: a max-heap holding the lower half
+    of the window and a min-heap holding the upper half, so the median is
+    always at one or both heap roots. Each sample lives in a fixed ring slot;
+    when the ring wraps, the evicted slot's value is removed from whichever
+    heap it is in by position (slotPos[]), then the heaps are rebalanced.
+
+    Invalid samples still occupy (and evict) a ring slot but are not inserted,
+    matching the old copy-and-sort filter: the median is over the valid
+    samples among the last N pushes, and 0 when there are none.
+
+    Stores only the float values plus 16-bit indices — ~8 bytes per slot —
+    instead of a full SensorReading per slot. Pure C++, no Arduino dependency —
+    safe in native unit-test builds.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+template <size_t N>
+class RollingMedian {
+    static_assert(N > 0 && N < 0xFFFF, "RollingMedian window must fit 16-bit slot indices");
+
+public:
+    RollingMedian() { clear(); }
+
+    void clear() {
+        head = 0;
+        loCount = 0;
+        hiCount = 0;
+        for (size_t i = 0; i < N; i++) {
+            slotHeap[i] = HEAP_NONE;
+            slotPos[i] = 0;
+            values[i] = 0.0f;
+        }
+    }
+
+    // Advance the window by one sample. Invalid samples evict the oldest slot
+    // without contributing a value.
+    void push(bool valid, float value) {
+        uint16_t slot = head;
+        head = (uint16_t)((head + 1) % N);
+
+        if (slotHeap[slot] != HEAP_NONE) {
+            removeSlot(slot);
+        }
+        if (valid) {
+            insertSlot(slot, value);
+        }
+    }
+
+    // Median of the valid samples in the window; 0 when there are none.
+    float median() const {
+        if (loCount == 0) return 0.0f;
+        if (loCount > hiCount) return values[lo[0]];
+        return (values[lo[0]] + values[hi[0]]) / 2.0f;
+    }
+
+    size_t count() const { return loCount + hiCount; }
+    static constexpr size_t capacity() { return N; }
+
+private:
+    static constexpr uint8_t HEAP_NONE = 0;
+    static constexpr uint8_t HEAP_LO = 1; // max-heap, lower half
+    static constexpr uint8_t HEAP_HI = 2; // min-heap, upper half
+
+    float values[N];     // value per ring slot
+    uint16_t lo[N];      // max-heap of slot ids
+    uint16_t hi[N];      // min-heap of slot ids
+    uint16_t slotPos[N]; // slot -> index within its heap
+    uint8_t slotHeap[N]; // slot -> HEAP_*
+    uint16_t head;       // next ring slot to overwrite
+    uint16_t loCount;
+    uint16_t hiCount;
+
+    // Heap-order predicate: true if a should sit above b in the given heap.
+    bool above(uint8_t which, uint16_t a, uint16_t b) const {
+        return which == HEAP_LO ? values[a] > values[b] : values[a] < values[b];
+    }
+
+    uint16_t* heapOf(uint8_t which) { return which == HEAP_LO ? lo : hi; }
+    uint16_t& countOf(uint8_t which) { return which == HEAP_LO ? loCount : hiCount; }
+
+    void place(uint8_t which, uint16_t pos, uint16_t slot) {
+        heapOf(which)[pos] = slot;
+        slotPos[slot] = pos;
+        slotHeap[slot] = which;
+    }
+
+    void siftUp(uint8_t which, uint16_t pos) {
+        uint16_t* h = heapOf(which);
+        uint16_t slot = h[pos];
+        while (pos > 0) {
+            uint16_t parent = (uint16_t)((pos - 1) / 2);
+            if (!above(which, slot, h[parent])) break;
+            place(which, pos, h[parent]);
+            pos = parent;
+        }
+        place(which, pos, slot);
+    }
+
+    void siftDown(uint8_t which, uint16_t pos) {
+        uint16_t* h = heapOf(which);
+        uint16_t n = countOf(which);
+        uint16_t slot = h[pos];
+        for (;;) {
+            uint16_t child = (uint16_t)(2 * pos + 1);
+            if (child >= n) break;
+            if (child + 1 < n && above(which, h[child + 1], h[child])) child++;
+            if (!above(which, h[child], slot)) break;
+            place(which, pos, h[child]);
+            pos = child;
+        }
+        place(which, pos, slot);
+    }
+
+    void heapPush(uint8_t which, uint16_t slot) {
+        uint16_t& n = countOf(which);
+        place(which, n, slot);
+        n++;
+        siftUp(which, (uint16_t)(n - 1));
+    }
+
+    // Remove the element at pos, returning its slot id.
+    uint16_t heapRemoveAt(uint8_t which, uint16_t pos) {
+        uint16_t* h = heapOf(which);
+        uint16_t& n = countOf(which);
+        uint16_t slot = h[pos];
+        n--;
+        if (pos != n) {
+            // Fill the hole with the last element; it may need to travel
+            // either way, but only one of the sifts will move it.
+            uint16_t moved = h[n];
+            place(which, pos, moved);
+            siftUp(which, pos);
+            if (slotPos[moved] == pos) siftDown(which, pos);
+        }
+        slotHeap[slot] = HEAP_NONE;
+        return slot;
+    }
+
+    void insertSlot(uint16_t slot, float value) {
+        values[slot] = value;
+        if (loCount == 0 || value <= values[lo[0]]) {
+            heapPush(HEAP_LO, slot);
+        } else {
+            heapPush(HEAP_HI, slot);
+        }
+        rebalance();
+    }
+
+    void removeSlot(uint16_t slot) {
+        heapRemoveAt(slotHeap[slot], slotPos[slot]);
+        rebalance();
+    }
+
+    // Keep loCount == hiCount or loCount == hiCount + 1.
+    void rebalance() {
+        if (loCount > hiCount + 1) {
+            heapPush(HEAP_HI, heapRemoveAt(HEAP_LO, 0));
+        } else if (hiCount > loCount) {
+            heapPush(HEAP_LO, heapRemoveAt(HEAP_HI, 0));
+        }
+    }
+};
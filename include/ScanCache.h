@@ -0,0 +1,105 @@
+#pragma once
+
+/*
+    ScanCache.h
+
+    Results of the last WiFi scan, kept by WiFiManager so the config portal
+    (GET /wifi/scan) and connectToBestNetwork() read a cached list instead
+    of each starting a blocking WiFi.scanNetworks().
+
+    - Fixed capacity (CAPACITY entries, no heap). Entries stay sorted by
+      RSSI, strongest first. When the cache is full, a result weaker than
+      every entry is dropped.
+    - De-duplicated by SSID. Several APs broadcasting one SSID (mesh,
+      repeaters) keep only the strongest one, with its channel.
+    - Hidden networks (empty SSID) are skipped.
+    - stamp() records when the scan finished, and ageMs() compares against
+      that stamp, wrap-safe. A cache that was never stamped has no age:
+      valid() is false.
+
+    Fill a local ScanCache from the scan results, then copy it into the
+    shared one under a lock. Copying it is a plain struct copy
+    (~CAPACITY * 36 bytes).
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+struct ScanEntry {
+    static constexpr size_t SSID_MAX = 33;   // 32 chars + NUL (802.11)
+    char    ssid[SSID_MAX];
+    int8_t  rssi;                            // dBm
+    uint8_t channel;
+    bool    open;                            // no encryption
+};
+
+class ScanCache {
+public:
+    static constexpr uint8_t CAPACITY = 16;
+
+    void clear() {
+        count_ = 0;
+        stamped_ = false;
+    }
+
+    // Returns false if the result was skipped (hidden, or weaker than a
+    // full cache), true if it was inserted or raised an existing entry.
+    bool add(const char* ssid, int rssi, uint8_t channel, bool open) {
+        if (!ssid || !ssid[0]) return false;
+        if (rssi < -128) rssi = -128;
+        if (rssi > 0) rssi = 0;
+
+        int at = find(ssid);
+        if (at >= 0) {
+            if (rssi <= entries_[at].rssi) return true;
+        } else {
+            if (count_ == CAPACITY) {
+                if (rssi <= entries_[count_ - 1].rssi) return false;
+                at = count_ - 1;                 // evict the weakest
+            } else {
+                at = count_++;
+            }
+            strncpy(entries_[at].ssid, ssid, ScanEntry::SSID_MAX - 1);
+            entries_[at].ssid[ScanEntry::SSID_MAX - 1] = '\0';
+        }
+        entries_[at].rssi = (int8_t)rssi;
+        entries_[at].channel = channel;
+        entries_[at].open = open;
+
+        // Only entries_[at] can be out of place, and only upwards
+        while (at > 0 && entries_[at].rssi > entries_[at - 1].rssi) {
+            ScanEntry t = entries_[at - 1];
+            entries_[at - 1] = entries_[at];
+            entries_[at] = t;
+            at--;
+        }
+        return true;
+    }
+
+    int find(const char* ssid) const {
+        if (!ssid) return -1;
+        for (uint8_t i = 0; i < count_; i++) {
+            if (strncmp(entries_[i].ssid, ssid, ScanEntry::SSID_MAX) == 0) return i;
+        }
+        return -1;
+    }
+
+    uint8_t size() const { return count_; }
+    const ScanEntry& operator[](uint8_t i) const { return entries_[i]; }
+
+    void stamp(uint32_t nowMs) {
+        stampMs_ = nowMs;
+        stamped_ = true;
+    }
+    bool     valid() const { return stamped_; }
+    uint32_t ageMs(uint32_t nowMs) const { return stamped_ ? nowMs - stampMs_ : UINT32_MAX; }
+
+private:
+    ScanEntry entries_[CAPACITY];
+    uint8_t   count_   = 0;
+    uint32_t  stampMs_ = 0;
+    bool      stamped_ = false;
+};
@@ -15,11 +15,19 @@
     ConfigServer is ONE writer of SettingsStore; the state machine context
     is populated from SettingsStore in main.cpp loop() instead of calling
     configServer->get*() directly.
+
+    The in-RAM values are published as versioned snapshots (SnapshotCell.h):
+    readers on any task or core get a torn-write-free copy without a lock,
+    and refresh() only copies when a save has bumped the version. Writers
+    (load()/save() — the web UI today, config-over-MQTT later) are
+    serialised by a mutex so the NVS write and the publish stay in order.
 */
 
 #include <Arduino.h>
-#include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include "StateMachine.h"   // AlarmSettings + ALARM_SETTINGS_DEFAULTS (shared value types)
+#include "SnapshotCell.h"
 
 // NVS namespace (same key names as the old ConfigServer emergency settings)
 constexpr const char SETTINGS_STORE_NAMESPACE[] = "emergency";
@@ -42,20 +50,29 @@ public:
     // Call once at startup. ConfigServer also calls this after any save.
     void load();
 
-    // Persist the provided values to NVS and refresh the in-RAM copy.
+    // Persist the provided values to NVS (write-behind, NvsStore.h) and
+    // refresh the in-RAM copy immediately.
     void save(const SettingsValues& v);
 
-    // Fast in-RAM getters — safe to call every loop iteration
-    float getEmergencyWaterLevel()       const { return vals.emergencyWaterLevel_cm; }
-    int   getEmergencyNotifFreq()        const { return vals.emergencyNotifFreq_ms; }
-    float getUrgentEmergencyWaterLevel() const { return vals.urgentEmergencyWaterLevel_cm; }
-    int   getHornOnDuration()            const { return vals.hornOnDuration_ms; }
-    int   getHornOffDuration()           const { return vals.hornOffDuration_ms; }
+    // Fast in-RAM getters — lock-free, safe from any task
+    float getEmergencyWaterLevel()       const { return get().emergencyWaterLevel_cm; }
+    int   getEmergencyNotifFreq()        const { return get().emergencyNotifFreq_ms; }
+    float getUrgentEmergencyWaterLevel() const { return get().urgentEmergencyWaterLevel_cm; }
+    int   getHornOnDuration()            const { return get().hornOnDuration_ms; }
+    int   getHornOffDuration()           const { return get().hornOffDuration_ms; }
+
+    // Consistent copy of the full struct (e.g. for ConfigServer to populate UI fields)
+    SettingsValues get() const { return snapshot.read(); }
+
+    // Copy into `out` only when settings changed since `seenVersion` (start
+    // it at 0). Returns true if `out` was updated — one atomic load otherwise.
+    bool refresh(SettingsValues& out, uint32_t& seenVersion) const {
+        return snapshot.refresh(out, seenVersion);
+    }
 
-    // Direct access to the full struct (e.g. for ConfigServer to populate UI fields)
-    const SettingsValues& get() const { return vals; }
+    uint32_t version() const { return snapshot.version(); }
 
 private:
-    Preferences prefs;
-    SettingsValues vals;
+    SnapshotCell<SettingsValues> snapshot;
+    SemaphoreHandle_t writeMux;   // serialises load()/save() across tasks
 };
@@ -31,11 +31,19 @@ class SmsChannel : public NotificationChannel, protected NvsChannelBase {
 public:
     SmsChannel();
 
+    // Coalesced bodies are capped at two concatenated GSM-7 segments (2 x 153)
+    // so a merged burst costs at most two messages.
+    static constexpr size_t MAX_BODY = 306;
+
+    static constexpr const char* SMS_API_HOST = "api.twilio.com";
+
     // --- NotificationChannel interface ---
     bool        send(const char* message) override;
     bool        isConfigured()            const override;
     const char* name()                    const override { return "SMS"; }
     uint8_t     channelFlag()             const override;
+    size_t      maxMessageLength()        const override { return MAX_BODY; }
+    bool        endpointHost(char* host, size_t len) const override;
     void        loadCache()                     override;
 
     // --- Config helpers (called from ConfigServer) ---
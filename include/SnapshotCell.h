@@ -0,0 +1,110 @@
+#pragma once
+
+/*
+    SnapshotCell.h
+
+    Double-buffered, versioned snapshot of a small value type, shared between
+    one writer at a time and any number of readers on either core.
+
+    The writer fills the inactive buffer and then swaps it in; readers copy
+    the active buffer without taking a lock and never see a torn value. A
+    sequence counter carries both the published version (seq >> 1) and a
+    write-in-progress bit (seq & 1), so a reader can tell whether the
+    buffer it copied could have been overwritten mid-copy:
+
+        active buffer for version v      = buf[v & 1]
+        publish v+1 writes               buf[(v+1) & 1]   (the other one)
+        publish v+2 writes buf[v & 1] and starts when seq reaches 2v+3
+
+    A copy that began at version v is therefore valid iff seq < 2v+3 after
+    the copy; otherwise the reader retries. With one publish per save the
+    retry practically never happens, and the writer never waits on readers.
+
+    refresh() lets a reader that keeps its own copy (the state machine
+    context, a task's local settings) skip the copy entirely until the
+    version changes: one atomic load per call in the common case.
+
+    Writers must be serialised by the caller (SettingsStore holds a mutex
+    across save()); two concurrent publish() calls would race on the
+    inactive buffer.
+
+    Pure C++11 (<atomic>), no Arduino dependency — safe in native unit-test
+    builds.
+*/
+
+#include <atomic>
+#include <stdint.h>
+
+template <typename T>
+class SnapshotCell {
+public:
+    // Version 1 holds `initial`; readers start with seenVersion 0 so their
+    // first refresh() always copies.
+    explicit SnapshotCell(const T& initial) : seq(2) {
+        buf[0] = initial;
+        buf[1] = initial;
+    }
+
+    // ---- Writer side (one at a time) ----
+
+    void publish(const T& value) {
+        writeBegin() = value;
+        writeCommit();
+    }
+
+    // Two-phase form of publish(): fill the returned buffer, then commit.
+    T& writeBegin() {
+        uint32_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        return buf[((s >> 1) + 1) & 1];
+    }
+
+    void writeCommit() {
+        uint32_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_release);
+    }
+
+    // ---- Reader side (any task, either core) ----
+
+    // Consistent copy of the latest published value.
+    T read() const {
+        T out;
+        uint32_t v;
+        do {
+            v = readBegin();
+            out = buf[v & 1];
+        } while (!readValid(v));
+        return out;
+    }
+
+    // Copy into `out` only if a newer version was published since
+    // `seenVersion`; updates seenVersion. Returns true when `out` changed.
+    bool refresh(T& out, uint32_t& seenVersion) const {
+        if (version() == seenVersion) return false;
+        uint32_t v;
+        do {
+            v = readBegin();
+            out = buf[v & 1];
+        } while (!readValid(v));
+        seenVersion = v;
+        return true;
+    }
+
+    // Published version (starts at 1, +1 per publish).
+    uint32_t version() const { return seq.load(std::memory_order_acquire) >> 1; }
+
+    // Two-phase form of read(), exposed for the interleaving unit tests:
+    // copy `peek(v)` after readBegin(), then accept it only if readValid(v).
+    uint32_t readBegin() const { return version(); }
+    const T& peek(uint32_t v) const { return buf[v & 1]; }
+    bool readValid(uint32_t v) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint32_t s = seq.load(std::memory_order_relaxed);
+        return (uint32_t)(s - 2 * v) < 3;
+    }
+
+private:
+    T buf[2];
+    std::atomic<uint32_t> seq; // (published version << 1) | write-in-progress
+};
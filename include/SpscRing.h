@@ -0,0 +1,68 @@
+#pragma once
+
+/*
+    SpscRing.h
+
+    Lock-free single-producer / single-consumer ring of fixed-size items.
+
+    The producer only writes `head`, the consumer only writes `tail`, so no
+    lock or critical section is needed — the release store on one index and
+    the acquire load on the other order the item copy. Exactly one task may
+    call push() and exactly one (other) task may call pop(); mixing producers
+    or consumers is a data race.
+
+    Indices are free-running 32-bit counters masked into the array, which is
+    why N must be a power of two; unsigned wraparound keeps head - tail
+    correct across the 2^32 boundary.
+
+    Full ring => push() refuses the item (drop-newest). The producer can't
+    discard the oldest item without writing `tail`, which belongs to the
+    consumer.
+
+    Pure C++11 (<atomic>), no Arduino dependency — safe in native unit-test
+    builds.
+*/
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing depth must be a power of two");
+
+public:
+    SpscRing() : head(0), tail(0) {}
+
+    // Producer side. Returns false (item not stored) when the ring is full.
+    bool push(const T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        uint32_t t = tail.load(std::memory_order_acquire);
+        if (h - t >= N) return false;
+        slots[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when the ring is empty.
+    bool pop(T& out) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t h = head.load(std::memory_order_acquire);
+        if (h == t) return false;
+        out = slots[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called concurrently with push()/pop().
+    size_t size() const {
+        return (size_t)(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+    }
+
+    static constexpr size_t capacity() { return N; }
+
+private:
+    T slots[N];
+    std::atomic<uint32_t> head; // next slot to write (producer-owned)
+    std::atomic<uint32_t> tail; // next slot to read (consumer-owned)
+};
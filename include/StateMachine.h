@@ -153,59 +153,113 @@ inline StateMachineContext& StateMachineContext::operator=(const StateMachineCon
     return *this;
 }
 
-// State machine output - actions to take
-struct StateMachineOutput {
-    bool stateChanged;
-    State newState;
-
-    // Horn control
-    bool setHornState;
-    bool hornOn;
+// Events one updateStateMachine() / handleSilenceToggle() call can report.
+// Each sets its bit in StateMachineOutput::events; the ones that lead to an
+// owner notification are also queued with their payload (below), in the
+// order they were raised.
+enum StateMachineEvent : uint8_t {
+    SM_EVENT_STATE_CHANGED,    // ctx.currentState moved to newState
+    SM_EVENT_HORN,             // horn output changed; drive it to hornOn
+    SM_EVENT_EMERGENCY,        // periodic Tier 1/2 alert is due      (queued: emergency)
+    SM_EVENT_SILENCED,         // button hold silenced alerts         (queued)
+    SM_EVENT_UNSILENCED,       // button hold re-enabled alerts       (queued)
+    SM_EVENT_SENSOR_RECOVERED, // valid readings after a notified failure (queued)
+    SM_EVENT_SENSOR_FAILURE,   // sustained failure alert is due      (queued: sensorFailure)
+    SM_EVENT_COUNT
+};
+static_assert(SM_EVENT_COUNT <= 8, "StateMachineOutput::events is a uint8_t bitmask");
+
+constexpr uint8_t smEventBit(StateMachineEvent e) { return (uint8_t)(1u << e); }
+
+// Typed payload for a queued event. Message text is built from this on the
+// notifier side (AlertFormatter.h), not in the state machine or loop().
+struct StateMachineEventRecord {
+    StateMachineEvent type;
+    uint8_t compartment;       // compartment that drove the update
+    uint8_t compartmentCount;  // >1 on multi-compartment boats (names it in text)
+
+    struct Emergency {
+        float level_cm;        // last trustworthy level (stale if sensorFault)
+        float rate_cm30min;    // NaN when unavailable
+        bool  sensorFault;     // level is stale: the sensor is currently failed
+        bool  urgent;          // Tier 2
+    };
+    struct SensorFailure {
+        uint32_t downSeconds;  // how long the sensor has been continuously failed
+    };
+    union {
+        Emergency     emergency;
+        SensorFailure sensorFailure;
+    };
+};
 
-    // Alert output (GPIO 26) — the dedicated emergency indicator, computed
-    // fresh every call. Unlike hornOn/setHornState this isn't edge-triggered;
-    // the caller writes it to the pin unconditionally each loop iteration.
-    bool alertPinOn;
+// At most two notification events per update (recovery/failure plus an
+// emergency alert); headroom for future events.
+constexpr uint8_t SM_EVENT_QUEUE_DEPTH = 4;
 
-    // Notification flags
-    bool sendEmergencyNotification;
-    bool sendSilenceConfirmation;
-    bool sendUnsilenceConfirmation;
-    bool sendSensorRecoveryNotification;
-    bool sendSustainedSensorFailureNotification;
+// How the alert output (GPIO 26) is driven
+enum AlertPinMode : uint8_t {
+    ALERT_PIN_OFF,
+    ALERT_PIN_SOLID,           // Tier 1
+    ALERT_PIN_PULSING          // Tier 2: the horn cadence
+};
 
-    // Latest reading info for message construction (to avoid re-reading sensor)
-    float displayLevel_cm;       // level_cm to use in emergency messages
-    bool  sensorFaultActive;     // true when emergency message should note stale data
-    float rateOfChange_cm30min;  // NaN when unavailable
+// State machine output - actions to take
+struct StateMachineOutput {
+    uint8_t events;            // smEventBit() mask of everything raised
+    State   newState;          // valid with SM_EVENT_STATE_CHANGED
+    bool    hornOn;            // valid with SM_EVENT_HORN
 
-    // Sensor-failure context for the sustained-failure notification
-    uint32_t sensorDownSeconds;  // how long the sensor has been continuously failed
+    // Alert output (GPIO 26) — the dedicated emergency indicator, computed
+    // fresh every call. Unlike the horn this isn't edge-triggered; the caller
+    // asserts alertPinMode on the pin each loop iteration and the pulsing
+    // itself is timed in hardware. alertPinOn is the level the software horn
+    // timer would give it right now.
+    AlertPinMode alertPinMode;
+    bool    alertPinOn;
 
-    // Message to send (if any notification flag is set)
-    char message[256];
+    // Multi-compartment boats: which compartment drove this update (the one
+    // selectCompartment() picked). Always 0 for the single-reading overload.
+    uint8_t compartment;
 
-    // LED pattern (for light code)
-    int ledPattern; // Can map to PATTERN_OFF, PATTERN_SOLID, etc.
+    uint8_t eventCount;
+    StateMachineEventRecord queue[SM_EVENT_QUEUE_DEPTH];
 
     StateMachineOutput() :
-        stateChanged(false),
+        events(0),
         newState(NORMAL),
-        setHornState(false),
         hornOn(false),
+        alertPinMode(ALERT_PIN_OFF),
         alertPinOn(false),
-        sendEmergencyNotification(false),
-        sendSilenceConfirmation(false),
-        sendUnsilenceConfirmation(false),
-        sendSensorRecoveryNotification(false),
-        sendSustainedSensorFailureNotification(false),
-        displayLevel_cm(0.0f),
-        sensorFaultActive(false),
-        rateOfChange_cm30min(0.0f),
-        sensorDownSeconds(0),
-        ledPattern(0)
-    {
-        message[0] = '\0';
+        compartment(0),
+        eventCount(0)
+    {}
+
+    bool has(StateMachineEvent e) const { return (events & smEventBit(e)) != 0; }
+
+    // Queued record for `e`, or nullptr if it wasn't raised / has no record.
+    const StateMachineEventRecord* find(StateMachineEvent e) const {
+        for (uint8_t i = 0; i < eventCount; i++) {
+            if (queue[i].type == e) return &queue[i];
+        }
+        return nullptr;
+    }
+
+    void raise(StateMachineEvent e) { events |= smEventBit(e); }
+
+    // Raise `e` and queue a record for it; the caller fills the payload.
+    StateMachineEventRecord& push(StateMachineEvent e) {
+        raise(e);
+        uint8_t i = eventCount < SM_EVENT_QUEUE_DEPTH ? eventCount++ : SM_EVENT_QUEUE_DEPTH - 1;
+        StateMachineEventRecord& r = queue[i];
+        r.type = e;
+        r.compartment = 0;
+        r.compartmentCount = 1;
+        r.emergency.level_cm = 0.0f;
+        r.emergency.rate_cm30min = NAN;
+        r.emergency.sensorFault = false;
+        r.emergency.urgent = false;
+        return r;
     }
 };
 
@@ -388,30 +442,39 @@ inline bool shouldHornBeOn(const StateMachineContext& ctx,
     return ctx.hornCurrentlyOn; // Maintain current state
 }
 
-// Pure function: alert output (GPIO 26) state — solid for Tier 1, pulsing
-// (mirrors the horn timer) for Tier 2. Fails safe to OFF on a sensor fault
-// (S3): a frozen reading must not drive a flood indication.
-inline bool computeAlertPinState(const StateMachineContext& ctx) {
+// Pure function: alert output (GPIO 26) mode — solid for Tier 1, pulsing at
+// hornOnDuration_ms / hornOffDuration_ms for Tier 2. Fails safe to OFF on a
+// sensor fault (S3): a frozen reading must not drive a flood indication.
+inline AlertPinMode computeAlertPinMode(const StateMachineContext& ctx) {
     if (ctx.currentState != EMERGENCY) {
-        return false;
+        return ALERT_PIN_OFF;
     }
 
     if (ctx.notificationsSilenced) {
-        return false;
+        return ALERT_PIN_OFF;
     }
 
     // S3: sensor fault — the level driving Tier selection is stale, so don't
     // assert a flood indication. The fault is surfaced via the ERROR state and
     // the sustained-failure notification instead.
     if (ctx.sensorError) {
-        return false;
+        return ALERT_PIN_OFF;
     }
 
     if (ctx.urgentEmergencyConditions) {
-        return ctx.hornCurrentlyOn; // Tier 2: pulsing, driven by the horn timer
+        return ALERT_PIN_PULSING; // Tier 2
     }
 
-    return true; // Tier 1: solid on
+    return ALERT_PIN_SOLID; // Tier 1
+}
+
+// Pure function: alert output level with Tier 2 following the horn timer
+inline bool computeAlertPinState(const StateMachineContext& ctx) {
+    switch (computeAlertPinMode(ctx)) {
+        case ALERT_PIN_SOLID:   return true;
+        case ALERT_PIN_PULSING: return ctx.hornCurrentlyOn;
+        default:                return false;
+    }
 }
 
 // Main state machine update function.
@@ -457,7 +520,7 @@ inline StateMachineOutput updateStateMachine(StateMachineContext& ctx,
         if (ctx.sensorErrorNotified) {
             // Only notify owner of recovery when they were previously told it failed
             ctx.sensorErrorNotified = false;
-            output.sendSensorRecoveryNotification = true;
+            output.push(SM_EVENT_SENSOR_RECOVERED);
         }
     }
 
@@ -471,8 +534,8 @@ inline StateMachineOutput updateStateMachine(StateMachineContext& ctx,
         if (dueFirst || dueRepeat) {
             ctx.sensorErrorNotified         = true;
             ctx.lastSensorErrorNotifyTime   = currentTime;
-            output.sendSustainedSensorFailureNotification = true;
-            output.sensorDownSeconds = (currentTime - ctx.sensorErrorTrueTime) / 1000;
+            output.push(SM_EVENT_SENSOR_FAILURE).sensorFailure.downSeconds =
+                (currentTime - ctx.sensorErrorTrueTime) / 1000;
         }
     }
 
@@ -487,7 +550,7 @@ inline StateMachineOutput updateStateMachine(StateMachineContext& ctx,
     State nextState = computeNextState(ctx, reading, currentTime, configServerActive);
 
     if (nextState != ctx.currentState) {
-        output.stateChanged = true;
+        output.raise(SM_EVENT_STATE_CHANGED);
         output.newState = nextState;
         ctx.currentState = nextState;
         ctx.lastStateChangeTime = currentTime;
@@ -502,7 +565,7 @@ inline StateMachineOutput updateStateMachine(StateMachineContext& ctx,
             ctx.configCommandReceived = false;
             // Ensure horn is driven off
             if (ctx.hornCurrentlyOn) {
-                output.setHornState = true;
+                output.raise(SM_EVENT_HORN);
                 output.hornOn = false;
                 ctx.hornCurrentlyOn = false;
             }
@@ -521,21 +584,22 @@ inline StateMachineOutput updateStateMachine(StateMachineContext& ctx,
     if (ctx.currentState == EMERGENCY) {
         // TIER 1: Periodic emergency message notifications
         if (shouldSendEmergencyNotification(ctx, currentTime)) {
-            output.sendEmergencyNotification = true;
             // Update timer even when we're about to populate the output, so
             // the caller doesn't need to touch ctx.
             ctx.lastEmergencyMessageTime = currentTime;
 
-            // Populate display context for caller's message construction
-            output.displayLevel_cm      = reading.valid ? reading.level_cm : ctx.lastValidLevel_cm;
-            output.sensorFaultActive    = ctx.sensorError;
-            output.rateOfChange_cm30min = rateOfChange;
+            // Payload for the notifier's message formatting
+            StateMachineEventRecord& ev = output.push(SM_EVENT_EMERGENCY);
+            ev.emergency.level_cm    = reading.valid ? reading.level_cm : ctx.lastValidLevel_cm;
+            ev.emergency.sensorFault = ctx.sensorError;
+            ev.emergency.rate_cm30min = rateOfChange;
+            ev.emergency.urgent      = ctx.urgentEmergencyConditions;
         }
 
         // TIER 2: Horn pulsing
         bool newHornState = shouldHornBeOn(ctx, currentTime);
         if (newHornState != ctx.hornCurrentlyOn) {
-            output.setHornState = true;
+            output.raise(SM_EVENT_HORN);
             output.hornOn = newHornState;
             ctx.hornCurrentlyOn = newHornState;
             ctx.lastHornToggleTime = currentTime;
@@ -543,19 +607,77 @@ inline StateMachineOutput updateStateMachine(StateMachineContext& ctx,
     } else {
         // Not in emergency state — ensure horn is off
         if (ctx.hornCurrentlyOn) {
-            output.setHornState = true;
+            output.raise(SM_EVENT_HORN);
             output.hornOn = false;
             ctx.hornCurrentlyOn = false;
         }
     }
 
     // Alert output (GPIO 26) reflects the current tier every iteration,
-    // independent of the horn's edge-triggered setHornState/hornOn pair.
+    // independent of the horn's edge-triggered SM_EVENT_HORN/hornOn pair.
+    output.alertPinMode = computeAlertPinMode(ctx);
     output.alertPinOn = computeAlertPinState(ctx);
 
     return output;
 }
 
+// Pure function: pick the compartment the state machine should act on and
+// return it in *combined. The highest valid level wins, so the wettest
+// compartment drives the alarm tiers. A failed compartment makes the combined
+// reading invalid (ERROR + sensor-failure alerts) — unless another compartment
+// is at or above the Tier 1 threshold: a dead sensor in one bilge must never
+// mask a flood measured in another. Returns the chosen compartment's index.
+inline uint8_t selectCompartment(const StateMachineContext& ctx,
+                                 const StateMachineSensorReading* compartments,
+                                 uint8_t count,
+                                 StateMachineSensorReading* combined) {
+    int wettest = -1;
+    int firstFailed = -1;
+    for (uint8_t i = 0; i < count; i++) {
+        if (!compartments[i].valid) {
+            if (firstFailed < 0) firstFailed = i;
+        } else if (wettest < 0 || compartments[i].level_cm > compartments[wettest].level_cm) {
+            wettest = i;
+        }
+    }
+
+    uint8_t chosen = 0;
+    if (wettest >= 0 &&
+        (firstFailed < 0 || compartments[wettest].level_cm >= ctx.emergencyWaterLevel_cm)) {
+        chosen = (uint8_t)wettest;
+    } else if (firstFailed >= 0) {
+        chosen = (uint8_t)firstFailed;
+    }
+    if (count > 0) {
+        *combined = compartments[chosen];
+    } else {
+        combined->valid = false;
+        combined->level_cm = 0.0f;
+    }
+    return chosen;
+}
+
+// Multi-compartment update: one reading and rate (cm/30min, NaN if
+// unavailable) per compartment. Thresholds, debounce and notification timing
+// stay shared — one boat, one alarm — driven by selectCompartment().
+inline StateMachineOutput updateStateMachine(StateMachineContext& ctx,
+                                             const StateMachineSensorReading* compartments,
+                                             const float* rates,
+                                             uint8_t count,
+                                             uint32_t currentTime,
+                                             bool configServerActive = false) {
+    StateMachineSensorReading combined;
+    uint8_t chosen = selectCompartment(ctx, compartments, count, &combined);
+    float rate = (count > 0) ? rates[chosen] : NAN;
+    StateMachineOutput output = updateStateMachine(ctx, combined, currentTime, rate, configServerActive);
+    output.compartment = chosen;
+    for (uint8_t i = 0; i < output.eventCount; i++) {
+        output.queue[i].compartment = chosen;
+        output.queue[i].compartmentCount = count;
+    }
+    return output;
+}
+
 // Handle button silence toggle in EMERGENCY state
 inline StateMachineOutput handleSilenceToggle(StateMachineContext& ctx) {
     StateMachineOutput output;
@@ -567,16 +689,16 @@ inline StateMachineOutput handleSilenceToggle(StateMachineContext& ctx) {
     ctx.notificationsSilenced = !ctx.notificationsSilenced;
 
     if (ctx.notificationsSilenced) {
-        output.sendSilenceConfirmation = true;
+        output.push(SM_EVENT_SILENCED);
 
         // Turn off horn immediately when silenced
         if (ctx.hornCurrentlyOn) {
-            output.setHornState = true;
+            output.raise(SM_EVENT_HORN);
             output.hornOn = false;
             ctx.hornCurrentlyOn = false;
         }
     } else {
-        output.sendUnsilenceConfirmation = true;
+        output.push(SM_EVENT_UNSILENCED);
     }
 
     return output;
@@ -0,0 +1,92 @@
+#pragma once
+
+/*
+    TelemetryGate.h
+
+    Report-by-exception filter for the telemetry publish. check() says whether
+    a sample differs enough from the last one actually sent to be worth a
+    message:
+
+        - the level moved by at least levelDeadband_cm, or
+        - the rate moved by at least rateDeadband_cm30, or
+        - the discrete key changed (state, sensor error, active compartment —
+          anything that must be reported the moment it flips), or
+        - the level or rate gained or lost a value (NaN <-> number), or
+        - heartbeatMs passed since the last send (keep-alive, so a quiet
+          boat still shows up and a stale retained message can be spotted).
+
+    Deadbands are measured from the last *sent* value, not the previous
+    sample, so a slow creep is still reported once it adds up. Call sent()
+    only after the publish succeeded; a failed publish is retried on the
+    next check. reset() forces the next check to report (used after an MQTT
+    reconnect).
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+#include <math.h>
+
+class TelemetryGate {
+public:
+    enum Reason : uint8_t {
+        REASON_NONE,        // suppressed
+        REASON_FIRST,       // nothing sent yet (or reset())
+        REASON_DISCRETE,
+        REASON_VALIDITY,
+        REASON_LEVEL,
+        REASON_RATE,
+        REASON_HEARTBEAT,
+    };
+
+    TelemetryGate(float levelDeadband_cm, float rateDeadband_cm30, uint32_t heartbeatMs)
+        : levelBand(levelDeadband_cm), rateBand(rateDeadband_cm30), heartbeatMs(heartbeatMs) {
+        reset();
+    }
+
+    void reset() { hasSent = false; }
+
+    Reason check(uint32_t nowMs, float level_cm, float rate_cm30, uint32_t discrete) const {
+        if (!hasSent) return REASON_FIRST;
+        if (discrete != lastDiscrete) return REASON_DISCRETE;
+        if (isnan(level_cm) != isnan(lastLevel) || isnan(rate_cm30) != isnan(lastRate)) {
+            return REASON_VALIDITY;
+        }
+        if (!isnan(level_cm) && fabsf(level_cm - lastLevel) >= levelBand) return REASON_LEVEL;
+        if (!isnan(rate_cm30) && fabsf(rate_cm30 - lastRate) >= rateBand) return REASON_RATE;
+        if (nowMs - lastSentMs >= heartbeatMs) return REASON_HEARTBEAT;
+        return REASON_NONE;
+    }
+
+    // Record a successful publish of this sample.
+    void sent(uint32_t nowMs, float level_cm, float rate_cm30, uint32_t discrete) {
+        hasSent = true;
+        lastSentMs = nowMs;
+        lastLevel = level_cm;
+        lastRate = rate_cm30;
+        lastDiscrete = discrete;
+    }
+
+    static const char* reasonName(Reason r) {
+        switch (r) {
+            case REASON_FIRST:     return "first";
+            case REASON_DISCRETE:  return "state";
+            case REASON_VALIDITY:  return "validity";
+            case REASON_LEVEL:     return "level";
+            case REASON_RATE:      return "rate";
+            case REASON_HEARTBEAT: return "heartbeat";
+            default:               return "none";
+        }
+    }
+
+private:
+    float    levelBand;
+    float    rateBand;
+    uint32_t heartbeatMs;
+
+    bool     hasSent;
+    uint32_t lastSentMs = 0;
+    float    lastLevel = NAN;
+    float    lastRate = NAN;
+    uint32_t lastDiscrete = 0;
+};
@@ -0,0 +1,160 @@
+#pragma once
+
+/*
+    TelemetryLog.h
+
+    Append-only log of fixed-size telemetry records in a raw flash region,
+    for store-and-forward across WiFi / broker outages. The region is split
+    into SECTOR-sized erase blocks used as a ring: record seq lives in slot
+    seq % slots(), and the first write into a sector erases it. Every sector
+    is erased once per trip round the ring, which is the wear leveling — a
+    64 KB region at one record a minute erases each sector about once every
+    2.8 days of accumulated outage.
+
+    Records carry their own seq and a CRC-8, so begin() can rebuild the head
+    after a reboot or power cut by scanning the flash: the newest valid
+    record wins, and a half-written or erased slot just reads as missing.
+    Records never need rewriting: "already sent" is the caller's cursor
+    (a seq), not a flag in flash.
+
+    Offset-based FlashRegion keeps this testable on the host; on the device
+    it wraps esp_partition_read/write/erase_range on the "telemlog"
+    partition (TelemetryStore.cpp).
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+// Raw flash access. Offsets are relative to the start of the region;
+// erase() is always called with a SECTOR-aligned offset and length.
+class FlashRegion {
+public:
+    virtual ~FlashRegion() {}
+    virtual size_t size() const = 0;
+    virtual bool read(size_t offset, void* out, size_t len) = 0;
+    virtual bool write(size_t offset, const void* data, size_t len) = 0;
+    virtual bool erase(size_t offset, size_t len) = 0;
+};
+
+// 16 bytes, so a 4 KB sector holds exactly 256.
+struct TelemetryRecord {
+    uint32_t seq;
+    uint32_t time;          // unix seconds, or uptime seconds with FLAG_UPTIME
+    int16_t  level_cc;      // level, 1/100 cm (LEVEL_NONE = no value)
+    int16_t  rate_cc;       // rate, 1/100 cm per 30 min (LEVEL_NONE = no value)
+    uint8_t  state;
+    uint8_t  flags;
+    uint8_t  compartment;
+    uint8_t  crc;
+
+    static constexpr int16_t LEVEL_NONE   = INT16_MIN;
+    static constexpr uint8_t FLAG_VALID        = 0x01;
+    static constexpr uint8_t FLAG_SENSOR_ERROR = 0x02;
+    static constexpr uint8_t FLAG_UPTIME       = 0x04;   // clock wasn't set
+
+    static int16_t toCenti(float v) {
+        if (isnan(v)) return LEVEL_NONE;
+        float c = v * 100.0f;
+        if (c >  32767.0f) c =  32767.0f;
+        if (c < -32767.0f) c = -32767.0f;
+        return (int16_t)(c < 0 ? c - 0.5f : c + 0.5f);
+    }
+    static float fromCenti(int16_t c) { return c == LEVEL_NONE ? NAN : c / 100.0f; }
+};
+static_assert(sizeof(TelemetryRecord) == 16, "TelemetryRecord must stay 16 bytes");
+
+class TelemetryLog {
+public:
+    static constexpr size_t SECTOR = 4096;
+    static constexpr size_t PER_SECTOR = SECTOR / sizeof(TelemetryRecord);
+
+    TelemetryLog() : flash(nullptr), slotCount(0), next(0) {}
+
+    // Attach to a region (at least two sectors) and find the head. Returns
+    // false if the region is missing or too small; the log is then inert.
+    bool begin(FlashRegion* region) {
+        flash = nullptr;
+        slotCount = 0;
+        next = 0;
+        if (!region || region->size() < 2 * SECTOR) return false;
+        flash = region;
+        slotCount = (uint32_t)(region->size() / SECTOR * PER_SECTOR);
+
+        // Newest sector by its first record, then the last valid record in it
+        bool found = false;
+        uint32_t newest = 0;
+        size_t sectors = region->size() / SECTOR;
+        TelemetryRecord r;
+        for (size_t s = 0; s < sectors; s++) {
+            if (readSlot((uint32_t)(s * PER_SECTOR), r) && (!found || r.seq > newest)) {
+                newest = r.seq;
+                found = true;
+            }
+        }
+        if (!found) return true;
+        next = newest + 1;
+        while (readSlot(next % slotCount, r) && r.seq == next) next++;
+        return true;
+    }
+
+    bool ready() const { return flash != nullptr; }
+
+    // Append one record; seq and crc are filled in. Returns false on a
+    // flash error (the seq is still consumed so the next append moves on).
+    bool append(TelemetryRecord rec) {
+        if (!flash) return false;
+        uint32_t slot = next % slotCount;
+        rec.seq = next++;
+        rec.crc = crc8(&rec, sizeof(rec) - 1);
+        if (slot % PER_SECTOR == 0 && !flash->erase(slot / PER_SECTOR * SECTOR, SECTOR)) {
+            return false;
+        }
+        return flash->write((size_t)slot * sizeof(rec), &rec, sizeof(rec));
+    }
+
+    // Record seq, if it is still in flash and intact.
+    bool read(uint32_t seq, TelemetryRecord& out) {
+        if (!flash || seq >= next || seq < oldestSeq()) return false;
+        return readSlot(seq % slotCount, out) && out.seq == seq;
+    }
+
+    // Seq the next append will get (one past the newest record).
+    uint32_t nextSeq() const { return next; }
+
+    // Oldest seq that can still be in flash. The sector being filled has
+    // already lost its previous contents, so the log keeps one sector less
+    // than the region plus whatever of the current sector is written.
+    uint32_t oldestSeq() const {
+        uint32_t keep = (uint32_t)(slotCount - PER_SECTOR + next % PER_SECTOR);
+        return next > keep ? next - keep : 0;
+    }
+
+    uint32_t slots() const { return slotCount; }
+
+    static uint8_t crc8(const void* data, size_t len) {
+        // CRC-8 (poly 0x07), seeded so neither an erased (all 0xFF) nor an
+        // all-zero slot passes
+        const uint8_t* p = (const uint8_t*)data;
+        uint8_t crc = 0x5A;
+        for (size_t i = 0; i < len; i++) {
+            crc ^= p[i];
+            for (int b = 0; b < 8; b++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+        return crc;
+    }
+
+private:
+    bool readSlot(uint32_t slot, TelemetryRecord& out) {
+        if (!flash->read((size_t)slot * sizeof(out), &out, sizeof(out))) return false;
+        if (out.seq == 0xFFFFFFFFu) return false;               // erased
+        return crc8(&out, sizeof(out) - 1) == out.crc;
+    }
+
+    FlashRegion* flash;
+    uint32_t     slotCount;
+    uint32_t     next;
+};
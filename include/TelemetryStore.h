@@ -0,0 +1,92 @@
+#pragma once
+
+/*
+    TelemetryStore.h
+
+    Store-and-forward for telemetry readings taken while MQTT is down. The
+    telemetry job calls record() once a minute during an outage; each
+    reading becomes a 16-byte TelemetryRecord in the "telemlog" flash
+    partition (64 KB ≈ 64 h of outage, see TelemetryLog.h). After the
+    connection is back, backfill() publishes the stored readings oldest
+    first on <baseTopic>/telemetry/backfill, as a JSON array with an
+    explicit "t" (unix seconds) per point so InfluxDB places them at the time
+    they were measured, not the time they arrived.
+
+    Rate limiting is the caller's: one backfill() call sends at most one
+    MQTT message (BACKFILL_PAYLOAD_MAX), and main.cpp runs it as its own
+    low-rate job that yields to a non-empty log queue.
+
+    Readings taken before the clock was set are stored with uptime seconds
+    and converted once SNTP has synced — possible only within the same boot,
+    so uptime records left over from an earlier boot are skipped (counted).
+
+    The backfill cursor (seq of the next record to send) is kept in NVS
+    namespace "telemlog", written when the backlog is drained and every
+    CURSOR_SAVE_EVERY records in between. After a crash a few points may be
+    re-sent; InfluxDB overwrites a point with the same series and timestamp,
+    so that is harmless.
+
+    Devices updated over the air keep their old partition table (OTA never
+    rewrites it). Without a "telemlog" partition begin() logs once and the
+    store stays inert; a serial flash with the current partitions.csv
+    enables it.
+*/
+
+#ifndef UNIT_TESTING
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "TelemetryLog.h"
+
+class MQTTService;
+
+class TelemetryStore {
+public:
+    static constexpr size_t   BACKFILL_PAYLOAD_MAX = 448;
+    static constexpr uint32_t CURSOR_SAVE_EVERY    = 64;
+
+    TelemetryStore();
+
+    // Find the partition, rebuild the log head and load the cursor.
+    bool begin();
+
+    bool isReady() const { return log.ready(); }
+
+    // Store one reading taken while the telemetry publish couldn't go out.
+    bool record(float level_cm, float rate_cm_30min, uint8_t state,
+                bool valid, bool sensorError, uint8_t compartment);
+
+    // Publish up to one message of stored readings, oldest first. Returns
+    // the number of readings sent (0 when caught up, offline, or waiting for
+    // the clock).
+    size_t backfill(MQTTService& mqtt);
+
+    uint32_t getPending() const;
+    uint32_t getRecorded() const { return recorded; }
+    uint32_t getBackfilled() const { return backfilled; }
+    uint32_t getSkipped() const { return skipped; }   // overwritten or unplaceable
+
+private:
+    class PartitionRegion : public FlashRegion {
+    public:
+        const esp_partition_t* part = nullptr;
+        size_t size() const override { return part ? part->size : 0; }
+        bool read(size_t offset, void* out, size_t len) override;
+        bool write(size_t offset, const void* data, size_t len) override;
+        bool erase(size_t offset, size_t len) override;
+    };
+
+    size_t formatRecord(char* out, size_t outLen, const TelemetryRecord& r, uint32_t t) const;
+    void   saveCursor(bool force = false);
+
+    PartitionRegion region;
+    TelemetryLog    log;
+    uint32_t cursor;
+    uint32_t savedCursor;
+    uint32_t bootFirstSeq;   // first seq written this boot (uptime records from here on are placeable)
+    uint32_t recorded;
+    uint32_t backfilled;
+    uint32_t skipped;
+};
+
+#endif // UNIT_TESTING
@@ -4,6 +4,12 @@
 // We leverage the ESP32's RTC (persistent across resets), high-resolution timer (80MHz),
 // and SNTP synchronization for accurate time keeping
 //
+// Time base: monoUs() is esp_timer's 64-bit microsecond count since boot — it
+// never wraps, so intervals and sample ticks need none of the millis() wrap
+// care. Wall-clock time is a tick plus an epoch offset that is recomputed
+// only when the clock is set (SNTP sync, setSystemTime()), so converting a
+// tick is an add, with no gettimeofday() or calendar work.
+//
 // Under UNIT_TESTING the whole header is inert: native builds use the mock in
 // test/mocks/MockTimeManagement.h instead, and this header pulls in ESP-IDF
 // (esp_sntp.h etc.) which does not exist on the native platform.
@@ -16,6 +22,8 @@
 #include <esp_netif.h>
 #include <esp_timer.h>
 #include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include "SnapshotCell.h"
 
 
 static constexpr uint32_t SNTP_MAX_WAIT = 10000;
@@ -44,6 +52,16 @@ class TimeManagement {
         // Get the singleton instance
         static TimeManagement& getInstance();
         
+        // Monotonic microseconds since boot. Store this (not a Timestamp) in
+        // anything sampled often; convert with toEpochUs() when it's reported.
+        static inline int64_t monoUs() { return esp_timer_get_time(); }
+
+        // Unix time in microseconds for a monoUs() tick. Before the first
+        // sync this is whatever the RTC held at boot (check isNTPSynced or a
+        // plausibility floor before trusting it). Lock-free, any task.
+        inline int64_t toEpochUs(int64_t tickUs) const { return tickUs + epochOffsetUs.read(); }
+        inline int64_t epochUs() const { return toEpochUs(monoUs()); }
+
         // Get current timestamp with full details
         Timestamp getCurrentTimestamp();
         
@@ -80,6 +98,12 @@ class TimeManagement {
         time_t lastSyncTime;       // Unix time of last SNTP sync
         time_t lastSyncInitTime;   // H4: unix time of last SNTP (re)init attempt
 
+        // Unix µs minus monoUs(), published on each clock set. offsetMux
+        // serialises the writers (SNTP callback on the lwIP task, setSystemTime()).
+        SnapshotCell<int64_t> epochOffsetUs;
+        portMUX_TYPE          offsetMux;
+        void updateEpochOffset(int64_t unixUs);
+
         bool isMocked;
         char timeStringBuffer[TIME_STR_BUFFER]; // Buffer for formatted time strings
         
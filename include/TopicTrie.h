@@ -0,0 +1,176 @@
+#pragma once
+
+/*
+    TopicTrie.h
+
+    Preallocated MQTT topic-filter trie for MQTTService's subscriber fan-out.
+    Each node is one topic level; "+" and "#" are ordinary labels, visited as
+    wildcards during match(). Matching a topic walks its levels once and only
+    branches on '+', so the cost depends on topic depth and on how many
+    filters actually share a prefix with it, not on the total number of
+    subscriptions. Shared prefixes ("boat/a1b2c3/cmd/...") are stored once.
+
+    Everything lives in fixed arrays: labels in a byte pool, nodes and
+    subscription links indexed by uint8_t. insert() fails (returns false)
+    when a pool is full or the filter is malformed; there is no removal —
+    subscriptions are registered once at setup.
+
+    Matching follows MQTT 3.1.1 §4.7: '+' matches exactly one level, a
+    trailing '#' matches the parent level and everything below it, and
+    wildcards in the first level don't match topics starting with '$'.
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+class TopicTrie {
+public:
+    static constexpr uint8_t MAX_NODES  = 64;
+    static constexpr uint8_t MAX_LINKS  = 32;     // (filter, id) pairs
+    static constexpr size_t  LABEL_POOL = 512;
+    static constexpr uint8_t MAX_DEPTH  = 16;     // topic levels walked
+    static constexpr uint8_t NONE       = 0xFF;
+
+    typedef void (*Visitor)(uint8_t id, void* arg);
+
+    TopicTrie() { clear(); }
+
+    void clear() {
+        nodeCount = 1;
+        linkCount = 0;
+        poolUsed = 0;
+        nodes[0] = Node{0, 0, NONE, NONE, NONE};
+    }
+
+    // MQTT filter syntax: '+' and '#' must fill a whole level, '#' only last.
+    static bool validFilter(const char* filter) {
+        if (!filter || !*filter) return false;
+        const char* level = filter;
+        for (const char* p = filter; ; p++) {
+            if (*p == '/' || *p == '\0') {
+                size_t len = (size_t)(p - level);
+                for (const char* q = level; q < p; q++) {
+                    if ((*q == '+' || *q == '#') && len != 1) return false;
+                }
+                if (len == 1 && *level == '#' && *p != '\0') return false;
+                if (*p == '\0') return true;
+                level = p + 1;
+            }
+        }
+    }
+
+    // Register filter for subscription id. The same id may be added under
+    // several filters; it is then visited once per matching filter.
+    bool insert(const char* filter, uint8_t id) {
+        if (!validFilter(filter) || linkCount >= MAX_LINKS) return false;
+        uint8_t node = 0;
+        const char* level = filter;
+        uint8_t depth = 0;
+        while (true) {
+            const char* end = level;
+            while (*end && *end != '/') end++;
+            if (++depth > MAX_DEPTH) return false;
+            node = child(node, level, (size_t)(end - level), /*create=*/true);
+            if (node == NONE) return false;
+            if (!*end) break;
+            level = end + 1;
+        }
+        links[linkCount] = Link{id, nodes[node].firstLink};
+        nodes[node].firstLink = linkCount++;
+        return true;
+    }
+
+    // Visit the id of every filter that matches topic. Returns the count.
+    size_t match(const char* topic, Visitor visit, void* arg) const {
+        if (!topic) return 0;
+        return walk(0, topic, topic[0] == '$', 0, visit, arg);
+    }
+
+    uint8_t nodesUsed() const { return nodeCount; }
+    uint8_t linksUsed() const { return linkCount; }
+    size_t  labelBytesUsed() const { return poolUsed; }
+
+private:
+    struct Node {
+        uint16_t label;       // offset into pool
+        uint8_t  len;
+        uint8_t  firstChild;
+        uint8_t  nextSibling;
+        uint8_t  firstLink;
+    };
+    struct Link {
+        uint8_t id;
+        uint8_t next;
+    };
+
+    bool labelIs(const Node& n, const char* s, size_t len) const {
+        return n.len == len && memcmp(pool + n.label, s, len) == 0;
+    }
+
+    uint8_t child(uint8_t parent, const char* s, size_t len, bool create) {
+        for (uint8_t c = nodes[parent].firstChild; c != NONE; c = nodes[c].nextSibling) {
+            if (labelIs(nodes[c], s, len)) return c;
+        }
+        if (!create || nodeCount >= MAX_NODES || len > 255 || poolUsed + len > LABEL_POOL) {
+            return NONE;
+        }
+        memcpy(pool + poolUsed, s, len);
+        uint8_t c = nodeCount++;
+        nodes[c] = Node{(uint16_t)poolUsed, (uint8_t)len, NONE, nodes[parent].firstChild, NONE};
+        nodes[parent].firstChild = c;
+        poolUsed += len;
+        return c;
+    }
+
+    size_t visitLinks(uint8_t node, Visitor visit, void* arg) const {
+        size_t n = 0;
+        for (uint8_t l = nodes[node].firstLink; l != NONE; l = links[l].next) {
+            visit(links[l].id, arg);
+            n++;
+        }
+        return n;
+    }
+
+    // Match the remaining topic levels from `level` below `node`.
+    size_t walk(uint8_t node, const char* level, bool dollar, uint8_t depth,
+                Visitor visit, void* arg) const {
+        if (depth >= MAX_DEPTH) return 0;
+        const char* end = level;
+        while (*end && *end != '/') end++;
+        size_t len = (size_t)(end - level);
+        bool last = (*end == '\0');
+        bool wildOk = !(dollar && depth == 0);
+
+        size_t n = 0;
+        for (uint8_t c = nodes[node].firstChild; c != NONE; c = nodes[c].nextSibling) {
+            const Node& ch = nodes[c];
+            bool hash = ch.len == 1 && pool[ch.label] == '#';
+            bool plus = ch.len == 1 && pool[ch.label] == '+';
+            if (hash) {
+                if (wildOk) n += visitLinks(c, visit, arg);
+                continue;
+            }
+            if (plus ? !wildOk : !labelIs(ch, level, len)) continue;
+            if (last) {
+                n += visitLinks(c, visit, arg);
+                // "a/#" also matches "a" itself
+                for (uint8_t g = ch.firstChild; g != NONE; g = nodes[g].nextSibling) {
+                    if (nodes[g].len == 1 && pool[nodes[g].label] == '#') n += visitLinks(g, visit, arg);
+                }
+            } else {
+                n += walk(c, end + 1, dollar, depth + 1, visit, arg);
+            }
+        }
+        return n;
+    }
+
+    Node    nodes[MAX_NODES];
+    Link    links[MAX_LINKS];
+    char    pool[LABEL_POOL];
+    uint8_t nodeCount;
+    uint8_t linkCount;
+    size_t  poolUsed;
+};
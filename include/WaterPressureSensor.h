@@ -2,16 +2,37 @@
 
 #include <cstdint>
 #include <cmath>
+// The driver half of this class (src/WaterPressureSensor.cpp, the sampling
+// task, the shared lock) builds on hardware, and on the host only against
+// the test/shim platform stand-ins (env:native-sensor). Plain native suites
+// see the calibration/filter surface with test/mocks/MockADS1115.h.
+#if !defined(UNIT_TESTING) || defined(NATIVE_SENSOR_SHIM)
+#define WATER_SENSOR_DRIVER 1
+#else
+#define WATER_SENSOR_DRIVER 0
+#endif
+#if defined(UNIT_TESTING) && defined(NATIVE_SENSOR_SHIM)
+#include <NativeShim.h>
+#endif
 #include "TimeManagement.h"
 #include "BoardPins.h"   // I2C_SDA_PIN / I2C_SCL_PIN (centralized pin map)
+#include "RollingMedian.h"
+#include "RateEstimator.h"
+#include "SpscRing.h"
+#include "CalibrationTable.h"
+#include "I2cBusRecovery.h"
 // Real ADS1115 driver only on hardware; native tests use test/mocks/MockADS1115.h
 // (included before this header) to provide the Adafruit_ADS1115 type.
 #ifndef UNIT_TESTING
 #include <Adafruit_ADS1X15.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #endif
 
 
 static constexpr uint8_t ADS1115_I2C_ADDRESS = 0x48;
+// Consecutive failed recovery cycles before the bus is reported unrecoverable
+// (recovery then continues on I2cBusRecovery's backoff schedule).
 static constexpr int BUS_RECOVERY_MAX_ATTEMPTS = 10;
 
 // The usable range of the water sensor in centimeters
@@ -25,30 +46,87 @@ static constexpr float READING_OVERRANGE_MARGIN_CM = 10.0f;
 
 // Flatline guard: a live ADS1115 jitters by >=1 LSB on any real analog input,
 // so this many byte-identical raw samples (sampled ~1 Hz) indicates a frozen
-// line or dead transducer rather than genuinely still water.
+// line or dead transducer rather than genuinely still water. In RDY mode a
+// decimated sample only counts as identical if every conversion in its window
+// was (averaging would otherwise hide the jitter this guard relies on).
 static constexpr int STUCK_SAMPLE_THRESHOLD = 180; // ~3 minutes at 1 Hz
 
-// Size of the circular buffer for smoothing readings
+// Conversion-ready sampling: the ADS1115 runs continuous at ADS_SAMPLE_RATE_SPS
+// and pulses ALERT/RDY (ADS_ALERT_PIN) after every conversion. Each conversion
+// is accumulated and SENSOR_OVERSAMPLE_FACTOR of them are averaged into one
+// decimated sample, so the median/flatline/rate stages below still see ~1 Hz
+// input — but each sample is a boxcar average over the whole second instead of
+// a single instantaneous conversion that aliases wave slosh.
+// Must be one of the ADS1115 rates: 8, 16, 32, 64, 128, 250, 475, 860. The
+// ISR wakes the sampling task on every RDY edge. Each wake is a pointer
+// write and a two-byte read, ~0.5 ms of the 100 kHz bus, so 250 SPS keeps
+// the bus ~12% busy and leaves a 4 ms period for a wake delayed behind WiFi
+// or a higher-priority task to still catch its conversion. 860 SPS would
+// hold the bus ~45% of the time and preempt loop() 860 times a second.
+// Conversions overwritten before they are read are counted
+// (getMissedConversionCount()).
+static constexpr uint16_t ADS_SAMPLE_RATE_SPS = 250;
+// Conversions per decimated sample: one second's worth at ADS_SAMPLE_RATE_SPS
+static constexpr uint16_t SENSOR_OVERSAMPLE_FACTOR = ADS_SAMPLE_RATE_SPS;
+// No RDY edge for this long => pin unwired or ADS stalled; fall back to 1 Hz polling.
+static constexpr uint32_t ADS_RDY_TIMEOUT_MS = 1000;
+// Single-shot wait in multi-channel polling: one period plus the ADS1115's
+// 10% oscillator tolerance, rounded up.
+static constexpr uint32_t ADS_CONVERSION_WAIT_MS = (1100u + ADS_SAMPLE_RATE_SPS - 1) / ADS_SAMPLE_RATE_SPS + 1;
+
+// Median window, in (decimated, ~1 Hz) samples. RollingMedian is O(log n) per
+// sample, so this can grow without per-read cost — but at 1 Hz every extra slot
+// is another second of lag before a real flood moves the filtered level.
 static constexpr int READINGS_BUFFER_SIZE = 10; 
 
-static constexpr uint8_t CHANNEL = 0;
+// Bilge compartments wired to the ADS1115, one per single-ended input
+// (AIN0..AIN3). One compartment keeps the original single-mux continuous
+// acquisition; boats with more set -DSENSOR_CHANNEL_COUNT=<n> in build_flags.
+#ifndef SENSOR_CHANNEL_COUNT
+#define SENSOR_CHANNEL_COUNT 1
+#endif
+static constexpr uint8_t SENSOR_CHANNELS = SENSOR_CHANNEL_COUNT;
+static_assert(SENSOR_CHANNELS >= 1 && SENSOR_CHANNELS <= 4,
+              "SENSOR_CHANNEL_COUNT must be 1..4 (ADS1115 single-ended inputs)");
+
+// Multi-channel scan: the mux dwells on one input for a block of conversions,
+// then moves to the next, so every compartment still gets one decimated sample
+// per scan. After a mux write the conversion in flight still carries the old
+// input, and the transducer's RC filter needs to recharge from the previous
+// compartment's level, so the first conversions after a switch are discarded.
+// The discard is sized in time (ADS_MUX_SETTLE_US) and converted to
+// conversions at the configured data rate; at 250 SPS that is one.
+static constexpr uint32_t ADS_MUX_SETTLE_US = 2000;
+static constexpr uint16_t ADS_MUX_SETTLE_CONVERSIONS = SENSOR_CHANNELS == 1 ? 0 :
+    (uint16_t)(1 + (ADS_MUX_SETTLE_US * ADS_SAMPLE_RATE_SPS) / 1000000u);
+static constexpr uint16_t ADS_CHANNEL_DWELL_CONVERSIONS =
+    SENSOR_OVERSAMPLE_FACTOR / SENSOR_CHANNELS - ADS_MUX_SETTLE_CONVERSIONS;
+static_assert(ADS_CHANNEL_DWELL_CONVERSIONS >= 4,
+              "oversample factor too small to split across SENSOR_CHANNEL_COUNT inputs");
+
+// Worst-case per-channel latency: one full scan of every compartment. Bounded
+// by the single-channel decimation window, so adding compartments never makes
+// any one of them slower to notice water than the ~1 Hz filter chain expects.
+static constexpr uint32_t SENSOR_SCAN_PERIOD_MS =
+    (uint32_t)SENSOR_CHANNELS * (ADS_CHANNEL_DWELL_CONVERSIONS + ADS_MUX_SETTLE_CONVERSIONS) *
+    1000u / ADS_SAMPLE_RATE_SPS;
+static_assert(SENSOR_SCAN_PERIOD_MS <= (uint32_t)SENSOR_OVERSAMPLE_FACTOR * 1000u / ADS_SAMPLE_RATE_SPS,
+              "per-channel scan period exceeds the decimation window");
+
 static constexpr int CM_MAX = 100; // Max centimeters the sensor can read
 
-// Rate-of-change tracking: one snapshot every 5 min, 7 slots = 30 min window
-static constexpr int RATE_BUFFER_SIZE = 7;
-static constexpr uint32_t RATE_SAMPLE_INTERVAL_MS = 300000; // 5 minutes
+// Rate-of-change tracking: streaming least-squares fit over every valid
+// filtered reading, exponentially weighted with a 15 min time constant (the
+// bulk of the weight spans the last ~30 min). No rate until 5 min of data.
+static constexpr uint32_t RATE_TAU_MS = 900000;      // 15 minutes
+static constexpr uint32_t RATE_MIN_SPAN_MS = 300000; // 5 minutes
 
 struct SensorReading {
     bool valid;   // Check if the reading is trustworthy
     float level_cm; // Water level in centimeters
     float millivolts; // Millivolts reading according to the ESP's ADC
-    Timestamp timestamp;
-};
-
-struct LevelSnapshot {
-    float level_cm;
-    uint32_t millis_ts;
-    bool valid;
+    int64_t tickUs;   // TimeManagement::monoUs() when sampled
+    uint8_t channel; // ADS1115 input / bilge compartment (0..SENSOR_CHANNELS-1)
 };
 
 class WaterPressureSensor {
@@ -56,32 +134,131 @@ public:
     WaterPressureSensor(bool mock = false);
     ~WaterPressureSensor();
     bool init(); // setup sensor
+
+    // Sample the sensor. Called directly only until startSamplingTask(); after
+    // that the sampling task is the sole caller and everyone else reads
+    // through popReading()/getLatestReading(). With several compartments each
+    // call returns the reading of whichever channel most recently completed
+    // (reading.channel says which).
     SensorReading readLevel();
-    void setZeroLevelMilliVolts(int millivolts); // Configure the voltage reading at 0cm water level
-    void setCalibrationPoint(int pointIndex, int millivolts, float level_cm); // Set calibration point (0=zero, 1=second point)
-    bool hasTwoPointCalibration(); // Check if 2-point calibration is configured
-    int getZeroPointMilliVolts(); // Get zero point voltage
-    int getSecondPointMilliVolts(); // Get second point voltage
-    float getSecondPointLevelCm(); // Get second point level
-    bool isBusUnrecoverable() const { return busUnrecoverable; }
-
-    // Returns cm change extrapolated to 30 min from oldest→newest snapshot.
-    // Returns NAN when fewer than 2 valid snapshots exist.
-    float getRateOfChange_cm30min() const;
+
+#if WATER_SENSOR_DRIVER
+    // Move sampling to a dedicated task woken by each ALERT/RDY edge (or every
+    // SAMPLER_WAIT_MS without one), independent of how long loop() spends in
+    // MQTT/TLS/HTTP.
+    bool startSamplingTask();
+#endif
+    // Consumer side of the sampler -> loop() SPSC ring. Single consumer only
+    // (loop()); returns false when no new reading is queued.
+    bool popReading(SensorReading& out) { return readingRing.pop(out); }
+    // Most recent reading, safe from any task (ConfigServer, OTA flood watch).
+    SensorReading getLatestReading(uint8_t channel = 0) const;
+    uint32_t getRingDropCount() const { return ringDrops; }
+    // Conversions lost since boot: overwritten before the sampler read them,
+    // or a failed register read. Stays ~0 while the sampler keeps up.
+    uint32_t getMissedConversionCount() const { return missedConversions; }
+    uint32_t getStackHighWaterMark() const;
+    static constexpr uint8_t channelCount() { return SENSOR_CHANNELS; }
+
+    // Calibration is per compartment; channel defaults to the first input so
+    // single-compartment callers are unchanged. The zero/second-point setters
+    // configure the legacy two-point line and drop any multi-point table.
+    void setZeroLevelMilliVolts(int millivolts, uint8_t channel = 0); // Configure the voltage reading at 0cm water level
+    void setCalibrationPoint(int pointIndex, int millivolts, float level_cm, uint8_t channel = 0); // Set calibration point (0=zero, 1=second point)
+    bool hasTwoPointCalibration(uint8_t channel = 0); // Check if 2-point calibration is configured
+    int getZeroPointMilliVolts(uint8_t channel = 0); // Get zero point voltage
+    int getSecondPointMilliVolts(uint8_t channel = 0); // Get second point voltage
+    float getSecondPointLevelCm(uint8_t channel = 0); // Get second point level
+    // N-point piecewise calibration (2..CalibrationTable::MAX_POINTS points,
+    // any order). n == 0 clears it and returns to the two-point line.
+    bool setCalibrationTable(const CalibrationPoint* points, uint8_t n, uint8_t channel = 0);
+    // Copies the multi-point table out; returns its size (0 = not configured).
+    uint8_t getCalibrationTable(CalibrationPoint* out, uint8_t maxPoints, uint8_t channel = 0);
+    // True once BUS_RECOVERY_MAX_ATTEMPTS cycles in a row have failed; clears
+    // on the first good probe (recovery keeps retrying with backoff).
+    bool isBusUnrecoverable() const { return busRecovery.unrecoverable(); }
+    // Duration of the last completed bus-fault episode (first failure -> first
+    // good probe), and how many episodes have recovered since boot.
+    uint32_t getLastBusRecoveryMs() const { return busRecovery.lastRecoveryDurationMs(); }
+    uint32_t getBusRecoveryCount() const { return busRecovery.recoveryCount(); }
+
+    // Least-squares level slope, in cm per 30 min. NAN until RATE_MIN_SPAN_MS
+    // of valid readings exist.
+    float getRateOfChange_cm30min(uint8_t channel = 0) const;
+    // 1-sigma standard error of the slope above (cm/30min) — small means the
+    // trend is well supported, large means noise. NAN when unavailable.
+    float getRateStdErr_cm30min(uint8_t channel = 0) const;
+
+#if WATER_SENSOR_DRIVER
+    // Low-power handoff: stop the sampling task and leave the ADS1115
+    // converting `channel` at 8 SPS in latching comparator mode, so ALERT/RDY
+    // goes (and stays) low once the level reaches level_cm. Sampling does not
+    // resume — the caller deep sleeps next. False (sampling untouched) when
+    // mocked, or when the channel's calibration can't express level_cm as a
+    // code.
+    bool armWakeComparator(float level_cm, uint8_t channel = 0);
+#endif
 
     // Made public for unit testing - convert voltage to water level
-    float voltageToCentimeters(int voltage_mv);
+    float voltageToCentimeters(int voltage_mv, uint8_t channel = 0);
 
 private:
+    // Everything that is per compartment: calibration, filter/rate state,
+    // flatline guard, the oversampling window, and the published snapshot.
+    struct ChannelState {
+        int zeroReadingVoltage_mv = 590; // Voltage (mV) at zero water level (0cm of water)
+        int secondPointVoltage_mv = 0;   // Voltage (mV) at second calibration point
+        float secondPointLevel_cm = 0.0f; // Water level (cm) at second calibration point
+        bool twoPointCalibrationActive = false; // Whether 2-point calibration is active
+        bool multiPointActive = false;   // table below came from setCalibrationTable()
+        // Readings below this (less READING_ERROR_MARGIN_MV) are invalid: the
+        // zero point, or a multi-point table's lowest-level point
+        int validFloor_mv = 590;
+        // What readLevel() converts with: the multi-point table, or the
+        // legacy zero/second-point line expressed as a two-point table.
+        CalibrationTable table;
+
+        RollingMedian<READINGS_BUFFER_SIZE> levelMedian; // level_cm of the last readings
+        RateEstimator rateEstimator{RATE_TAU_MS, RATE_MIN_SPAN_MS};
+
+        int16_t lastStuckRawADC = 0;    // last raw code, for flatline comparison
+        uint32_t stuckSampleCount = 0;  // consecutive identical raw codes
+
+        // Conversion-ready (ALERT/RDY) oversampling window for this input
+        int32_t oversampleSum = 0;      // running sum of raw codes in the current window
+        uint16_t oversampleCount = 0;   // conversions accumulated in the current window
+        uint32_t oversampleMissed = 0;  // conversions overwritten before we read them (window)
+        int16_t oversampleMin = INT16_MAX; // window spread — a frozen line has min == max
+        int16_t oversampleMax = INT16_MIN;
+        int16_t decimatedRaw = 0;       // completed window: rounded mean raw code
+        bool decimatedFlat = false;     // completed window: every conversion identical
+        uint16_t decimatedCount = 0;    // completed window: conversions actually read
+        uint32_t decimatedMissed = 0;   // completed window: conversions missed
+        uint16_t oversampleReadErrors = 0; // register reads that failed (window)
+        uint16_t decimatedReadErrors = 0;  // completed window: failed reads
+
+        SensorReading lastReading{};    // this channel's last published reading
+        uint32_t readingCount = 0;      // readings published (init waits for the first)
+
+        // Snapshot for other tasks, under sharedMux
+        SensorReading latestReading{};
+        float latestRate_cm30min = NAN;
+        float latestRateStdErr_cm30min = NAN;
+
+        void rebuildLegacyTable();
+
+        void resetWindow() {
+            oversampleSum = 0;
+            oversampleCount = 0;
+            oversampleMissed = 0;
+            oversampleReadErrors = 0;
+            oversampleMin = INT16_MAX;
+            oversampleMax = INT16_MIN;
+        }
+    };
+
     Adafruit_ADS1115 ads;
-    SensorReading readingsBuffer[READINGS_BUFFER_SIZE]; // Circular buffer for the last readings
-    int currentReadingIndex;
-    Timestamp lastReadTime;
-    int zeroReadingVoltage_mv; // Voltage (mV) at zero water level (0cm of water)
-    int secondPointVoltage_mv; // Voltage (mV) at second calibration point
-    float secondPointLevel_cm; // Water level (cm) at second calibration point
-    bool twoPointCalibrationActive; // Whether 2-point calibration is active
-    
+    ChannelState channels[SENSOR_CHANNELS];
 
     // For testing using mock data
     bool useMockData;
@@ -91,21 +268,59 @@ private:
     void* adcCalHandle;  // Opaque handle for ADC calibration (void* for Arduino compatibility)
     bool calibrationInitialized;
     
-    void bufferPush(SensorReading newReading);
-    float calculateMedianFromBuffer(); // Calculate rolling median of buffer
-    void recoverBus();
+    void runBusRecoveryStep(uint32_t now); // perform one I2cBusRecovery action
+    void publish(uint8_t channel, const SensorReading& reading); // lastReading + latest snapshot
+    void startContinuousConversions(); // gain/rate/mux + RDY comparator mode
+    int drainConversions(); // channel whose window just closed, or -1
+    bool readPolled(uint8_t channel, int16_t& raw); // polling-mode conversion for one input
+    bool readConversion(int16_t& raw); // conversion register; false on a failed transfer
+    bool adsResponds();     // address probe, run only after a failed read
 
     uint32_t lastLogTime;    // Throttle debug logging
-    uint32_t lastSampleTime; // millis() of last ADC read (1-second gate)
-    SensorReading lastReading; // cached result returned between samples
-    int busRecoveryAttempts;
-    bool busUnrecoverable;
+    uint32_t lastSampleTime; // millis() of last ADC read (polling gate)
+    SensorReading lastReading; // most recent reading of any channel, returned between samples
+    I2cBusRecovery busRecovery; // sampling-task only; getters read single words
 
-    LevelSnapshot rateBuffer[RATE_BUFFER_SIZE];
-    int rateBufferIndex;
-    uint32_t lastRateSampleTime;
+    // Conversion-ready (ALERT/RDY) scan state
+    bool rdyMode;               // false => legacy 1 Hz conversion-register polling
+    uint32_t rdySeenCount;      // ISR edge count consumed so far
+    uint32_t lastRdyTime;       // millis() of last observed RDY edge (stall detection)
+    uint8_t scanChannel;        // input the mux is dwelling on (RDY mode)
+    uint16_t settleRemaining;   // conversions still to discard after the last mux switch
+    uint8_t pollChannel;        // next input to read in polling mode
 
-    int16_t lastStuckRawADC;    // last raw code, for flatline comparison
-    uint32_t stuckSampleCount;  // consecutive identical raw codes
-};
+    // Sampling task handoff. readingRing is the lock-free path to loop(); the
+    // per-channel latest* snapshots (under sharedMux) serve the other,
+    // occasional readers.
+    static constexpr size_t READING_RING_DEPTH = 16;
+    SpscRing<SensorReading, READING_RING_DEPTH> readingRing;
+    uint32_t ringDrops;         // readings refused because loop() fell 16 behind
+    uint32_t sampleSeq;         // bumped per fresh reading (producer-only)
+    uint32_t missedConversions; // sum of every window's missed conversions
+
+#if WATER_SENSOR_DRIVER
+    // Guards latest* and the calibration fields, which the config server
+    // writes from its config_srv task while the sampling task converts with
+    // them.
+    mutable portMUX_TYPE sharedMux = portMUX_INITIALIZER_UNLOCKED;
+    TaskHandle_t samplerTask = nullptr;
+    // armWakeComparator() -> sampler: stop at the top of the next tick, off
+    // the bus, so the comparator setup can't interleave with a conversion
+    // read. Both under sharedMux; parked is set once the sampler commits.
+    bool parkRequested = false;
+    bool parked = false;
 
+    static void samplerTaskEntry(void* arg);
+    void samplerRun();
+
+    // Longest wait for an RDY notification: the polling-mode tick, and the
+    // fallback wake when an edge is lost or the RDY line goes silent.
+    static constexpr uint32_t    SAMPLER_WAIT_MS       = 10;
+    static constexpr uint32_t    SAMPLER_PARK_TIMEOUT_MS = 200;
+    static constexpr uint32_t    SAMPLER_TASK_STACK    = 4096;
+    // Core 1 above loop() (priority 1): sampling preempts a loop stuck in a
+    // TLS handshake, and stays off Core 0 with the WiFi stack and notifier.
+    static constexpr UBaseType_t SAMPLER_TASK_PRIORITY = 2;
+    static constexpr BaseType_t  SAMPLER_TASK_CORE     = 1;
+#endif
+};
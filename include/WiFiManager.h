@@ -3,11 +3,19 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/event_groups.h>
 #include <vector>
+#include "ScanCache.h"
 
 constexpr const char* WIFI_PREFERENCES_NAMESPACE = "wifi";
 static constexpr int MAX_NETWORKS = 10;
 static constexpr int CONNECT_TIMEOUT_MS = 15000; // 15 secs
+// Fast path after a reboot: re-join the last AP by BSSID on its channel, no
+// scan. Association plus DHCP normally takes well under a second; past this
+// the AP has probably moved and begin() falls back to connectToBestNetwork().
+static constexpr uint32_t FAST_CONNECT_TIMEOUT_MS = 4000;
 static constexpr uint32_t RECONNECT_INTERVAL_MS = 30000; // 30 secs between retry attempts
 
 // H1/H2: after this many consecutive failed WiFi.reconnect() attempts, fall
@@ -19,6 +27,15 @@ static constexpr uint32_t RECONNECT_FALLBACK_ATTEMPTS = 6; // 6 * 30s = 3 min
 // escalate after fewer attempts.
 static constexpr uint32_t RECONNECT_ESCALATION_ATTEMPTS_STICKY = 2; // 2 * 30s = 1 min
 
+// Background scans (ScanCache.h). While disconnected or while the config
+// portal's AP is up, an async scan runs every SCAN_INTERVAL_MS; while
+// connected in plain STA mode, only on requestScan(). connectToBestNetwork()
+// uses the cache if it is younger than SCAN_FRESH_MS and scans (blocking)
+// otherwise.
+static constexpr uint32_t SCAN_INTERVAL_MS = 60000;
+static constexpr uint32_t SCAN_FRESH_MS    = 30000;
+static constexpr uint32_t SCAN_TIMEOUT_MS  = 10000;  // give up on an async scan that never completes
+
 struct WiFiCredential {
     // Fixed-size storage — no heap, no manual delete[], no double-free risk.
     // SSID max 32 chars + NUL (802.11), PSK max 64 chars + NUL (WPA2).
@@ -35,9 +52,27 @@ struct WiFiCredential {
 class WiFiManager {
 private:
     Preferences preferences;
+    // Written by the config web server task (add/remove), read by the loop
+    // task (connectToBestNetwork); every access holds credMux.
     std::vector<WiFiCredential> storedNetworks;
+    SemaphoreHandle_t credMux = nullptr;
     bool isWiFiConnected = false;
 
+    // LINK_UP_BIT is set by the GOT_IP event and cleared on disconnect, so
+    // connect paths wake as soon as the link is usable instead of polling
+    EventGroupHandle_t linkEvents = nullptr;
+    static constexpr EventBits_t LINK_UP_BIT = BIT0;
+
+    // Last scan results. Filled on the loop task (pollScan /
+    // connectToBestNetwork), read by the config web server task; every
+    // access holds scanMux. The scan itself is only ever started from the
+    // loop task; other tasks set _scanRequested.
+    ScanCache scanCache;
+    SemaphoreHandle_t scanMux = nullptr;
+    volatile bool _scanRequested = false;
+    volatile bool _scanRunning = false;
+    uint32_t _scanStartedMs = 0;
+
     // Connection health tracking.
     // H6: session-start timestamps are captured in esp_timer_get_time()
     // microseconds (int64, monotonic, never wraps in practice) rather than
@@ -54,12 +89,19 @@ private:
 
     WiFiManager();
     void loadCredentials();
+    bool tryFastConnect();            // last AP by BSSID/channel (begin() only)
+    bool waitForLink(uint32_t timeoutMs);
+    void markConnected();
+    void rememberLink();              // save the current AP for tryFastConnect()
     static void onWiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info);
     static const char* reasonToString(uint8_t reason);
     // H2: true for disconnect reasons (4WAY_HANDSHAKE_TIMEOUT, BEACON_TIMEOUT,
     // HANDSHAKE_TIMEOUT, AUTH_FAIL) that are known to sometimes require a full
     // disconnect+rescan rather than a plain WiFi.reconnect().
     static bool isStickyDisconnectReason(uint8_t reason);
+    void pollScan();                  // start a due async scan / collect a finished one
+    int  waitForScan();               // block until the async scan in flight finishes
+    void storeScan(int numNetworks);  // WiFi.SSID(i)... -> scanCache, then scanDelete()
 
 public:
     static WiFiManager& getInstance();
@@ -79,6 +121,10 @@ public:
     // stopSetupMode() (and risking a watchdog reboot).
     void requestImmediateReconnect() { _lastReconnectAttempt = 0; }
     std::vector<String> getStoredSSIDs();
+    // Safe from any task: the scan starts on the next maintainConnection()
+    void requestScan() { _scanRequested = true; }
+    bool isScanning() const { return _scanRunning || _scanRequested; }
+    ScanCache getScanResults();       // copy of the last scan
     bool isConnected();
     int  getRSSI(); // Returns current RSSI in dBm, 0 if not connected
     void disconnect();
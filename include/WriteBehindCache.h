@@ -0,0 +1,180 @@
+#pragma once
+
+/*
+    WriteBehindCache.h
+
+    Pending NVS writes for NvsStore, coalesced by (namespace, key): a second
+    put() of the same key replaces the first, so a threshold slider dragged
+    through twenty values costs one flash write instead of twenty. Values are
+    typed (matching the Preferences put*() family) and kept in a byte pool;
+    remove() is a pending entry too, so it overrides an earlier put and the
+    reverse.
+
+    due() decides when to commit: after `quietMs` without a new put, or
+    `maxDelayMs` after the first pending put even if writes keep coming.
+    Both are millis()-wrap safe. The committer swaps the whole cache out
+    (take()) and writes the copy, so new puts never wait for flash.
+
+    Not thread-safe on its own; NvsStore serialises access with its mutex.
+
+    Pure C++, no Arduino dependency — safe in native unit-test builds.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+template <uint8_t ENTRIES, size_t POOL>
+class WriteBehindCache {
+    static_assert(POOL <= 65535, "WriteBehindCache pool too large");
+
+public:
+    enum Type : uint8_t {
+        T_NONE = 0,
+        T_BOOL,
+        T_INT,        // int32_t
+        T_UINT,       // uint32_t (putUInt / putULong)
+        T_USHORT,     // uint16_t
+        T_FLOAT,
+        T_STRING,     // stored with its NUL
+        T_BYTES,
+        T_REMOVE,
+    };
+
+    static constexpr size_t  NAME_MAX = 16;    // NVS limit: 15 chars + NUL
+    static constexpr uint8_t CAPACITY = ENTRIES;
+
+    struct Entry {
+        char     ns[NAME_MAX];
+        char     key[NAME_MAX];
+        uint8_t  type;
+        uint16_t off;
+        uint16_t len;
+    };
+
+    WriteBehindCache() { clear(); }
+
+    void clear() {
+        count = 0;
+        poolUsed = 0;
+        firstPutMs = lastPutMs = 0;
+    }
+
+    // Queue a write; replaces any pending value for the same key. Returns
+    // false for an over-long name or when the table / pool is full.
+    bool put(const char* ns, const char* key, uint8_t type,
+             const void* data, size_t len, uint32_t now) {
+        if (!ns || !key || strlen(ns) >= NAME_MAX || strlen(key) >= NAME_MAX) return false;
+        if (len > POOL) return false;
+        int i = indexOf(ns, key);
+        if (i < 0 && count >= ENTRIES) return false;
+        bool wasEmpty = (count == 0);
+
+        // Reuse the old slot when the new value fits, else append (compacting
+        // first if the old values left enough garbage)
+        uint16_t off;
+        if (i >= 0 && len <= entries[i].len) {
+            off = entries[i].off;
+        } else {
+            if (poolUsed + len > POOL) {
+                compact(i);
+                if (poolUsed + len > POOL) return false;
+            }
+            off = (uint16_t)poolUsed;
+            poolUsed += len;
+        }
+        if (i < 0) {
+            i = count++;
+            strcpy(entries[i].ns, ns);
+            strcpy(entries[i].key, key);
+        } else {
+            coalesced++;
+        }
+        if (len) memcpy(pool + off, data, len);
+        entries[i].type = type;
+        entries[i].off = off;
+        entries[i].len = (uint16_t)len;
+
+        if (wasEmpty) firstPutMs = now;
+        lastPutMs = now;
+        return true;
+    }
+
+    const Entry* find(const char* ns, const char* key) const {
+        int i = indexOf(ns, key);
+        return i < 0 ? nullptr : &entries[i];
+    }
+
+    const uint8_t* data(const Entry& e) const { return pool + e.off; }
+
+    bool hasNamespace(const char* ns) const {
+        for (uint8_t i = 0; i < count; i++) {
+            if (strcmp(entries[i].ns, ns) == 0) return true;
+        }
+        return false;
+    }
+
+    bool due(uint32_t now, uint32_t quietMs, uint32_t maxDelayMs) const {
+        if (count == 0) return false;
+        return (now - lastPutMs) >= quietMs || (now - firstPutMs) >= maxDelayMs;
+    }
+
+    // Move everything pending into `out` (replacing its contents) and empty
+    // this cache. Coalescing counts stay with the live cache.
+    void take(WriteBehindCache& out) {
+        out.count = count;
+        out.poolUsed = poolUsed;
+        out.firstPutMs = firstPutMs;
+        out.lastPutMs = lastPutMs;
+        memcpy(out.entries, entries, sizeof(Entry) * count);
+        memcpy(out.pool, pool, poolUsed);
+        clear();
+    }
+
+    uint8_t  size()          const { return count; }
+    bool     empty()         const { return count == 0; }
+    const Entry& entry(uint8_t i) const { return entries[i]; }
+    size_t   poolBytesUsed() const { return poolUsed; }
+    // Puts that replaced a pending value instead of adding a flash write
+    uint32_t coalescedCount() const { return coalesced; }
+
+private:
+    int indexOf(const char* ns, const char* key) const {
+        if (!ns || !key) return -1;
+        for (uint8_t i = 0; i < count; i++) {
+            if (strcmp(entries[i].key, key) == 0 && strcmp(entries[i].ns, ns) == 0) return i;
+        }
+        return -1;
+    }
+
+    // Pack live values to the front of the pool, in place (values are
+    // moved in offset order, so each move only goes down into free space);
+    // `skip` (the entry about to be rewritten) gives up its old value.
+    void compact(int skip) {
+        if (skip >= 0) entries[skip].len = 0;
+        size_t used = 0;
+        size_t from = 0;
+        while (true) {
+            int next = -1;
+            for (uint8_t i = 0; i < count; i++) {
+                if (entries[i].len == 0 || entries[i].off < from) continue;
+                if (next < 0 || entries[i].off < entries[next].off) next = i;
+            }
+            if (next < 0) break;
+            Entry& e = entries[next];
+            from = e.off + e.len;
+            memmove(pool + used, pool + e.off, e.len);
+            e.off = (uint16_t)used;
+            used += e.len;
+        }
+        poolUsed = used;
+    }
+
+    Entry    entries[ENTRIES];
+    uint8_t  pool[POOL];
+    uint8_t  count;
+    size_t   poolUsed;
+    uint32_t firstPutMs;
+    uint32_t lastPutMs;
+    uint32_t coalesced = 0;
+};
@@ -1,6 +1,23 @@
 Import("env")
 import gzip
+import hashlib
 import os
+import re
+
+# Build-time asset pipeline for the config portal pages:
+#   1. bundle  — <link rel="stylesheet" href="x.css"> and <script src="x.js">
+#                that point at local files are replaced by the file's contents,
+#                so pages can share CSS/JS (dev-ui/common.css) and still cost a
+#                single request on the AP link
+#   2. minify  — comments, indentation and blank lines removed; CSS spacing
+#                around braces and semicolons collapsed. Script line breaks are
+#                kept (no ASI surprises)
+#   3. compress — gzip (always) and Brotli (when the `brotli` module is
+#                installed: `pip install brotli` in the PlatformIO Python)
+#   4. ETag    — a hash of the minified page, so a firmware build that didn't
+#                change a page still gets 304s for it
+#
+# Output: src/compressed_pages.h, one StaticAsset per page.
 
 project_dir = env["PROJECT_DIR"]
 dev_ui_dir  = os.path.join(project_dir, "dev-ui")
@@ -18,19 +35,104 @@ pages = [
 
 out_path = os.path.join(project_dir, "src", "compressed_pages.h")
 
+try:
+    import brotli
+except ImportError:
+    brotli = None
+    print("  compress_html: no `brotli` module, serving gzip only")
+
+
+def read_local(src_dir, name):
+    # A page's own directory first, then dev-ui/ (src/html pages share it too)
+    for d in (src_dir, dev_ui_dir):
+        path = os.path.join(d, name)
+        if os.path.isfile(path):
+            with open(path, "r", encoding="utf-8") as f:
+                return f.read()
+    raise FileNotFoundError(f"compress_html: {name} not found for bundling")
+
+
+def bundle(html, src_dir):
+    def css(m):
+        return "<style>" + read_local(src_dir, m.group(1)) + "</style>"
+
+    def js(m):
+        return "<script>" + read_local(src_dir, m.group(1)) + "</script>"
+
+    html = re.sub(r'<link rel="stylesheet" href="([\w.-]+\.css)">', css, html)
+    html = re.sub(r'<script src="([\w.-]+\.js)"></script>', js, html)
+    return html
+
+
+def minify_css(text):
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    lines = [l.strip() for l in text.split("\n")]
+    text = " ".join(l for l in lines if l)
+    return re.sub(r"\s*([{};])\s*", r"\1", text)
+
+
+def minify_js(text):
+    lines = [l.strip() for l in text.split("\n")]
+    return "\n".join(l for l in lines if l and not l.startswith("//"))
+
+
+def minify_markup(text):
+    text = re.sub(r"<!--.*?-->", "", text, flags=re.S)
+    lines = [l.strip() for l in text.split("\n")]
+    return "\n".join(l for l in lines if l)
+
+
+def minify(html):
+    # Split out the blocks whose contents need their own rules; textarea
+    # contents are kept verbatim
+    parts = re.split(r"(<style>.*?</style>|<script>.*?</script>|<textarea.*?</textarea>)", html, flags=re.S)
+    out = []
+    for p in parts:
+        if p.startswith("<style>"):
+            out.append("<style>" + minify_css(p[7:-8]) + "</style>")
+        elif p.startswith("<script>"):
+            out.append("<script>" + minify_js(p[8:-9]) + "</script>")
+        elif p.startswith("<textarea"):
+            out.append(p)
+        else:
+            out.append(minify_markup(p))
+    return "".join(out)
+
+
+def emit_bytes(out, name, data):
+    hex_bytes = ", ".join(f"0x{b:02x}" for b in data)
+    out.write(f"const uint8_t {name}[] PROGMEM = {{{hex_bytes}}};\n")
+
+
 with open(out_path, "w") as out:
     out.write("// Auto-generated by scripts/compress_html.py — do not edit\n")
     out.write("#pragma once\n")
     out.write("#include <pgmspace.h>\n\n")
+    out.write("struct StaticAsset {\n")
+    out.write("    const uint8_t* gz;\n")
+    out.write("    size_t         gzLen;\n")
+    out.write("    const uint8_t* br;           // nullptr when built without Brotli\n")
+    out.write("    size_t         brLen;\n")
+    out.write("    const char*    etag;         // quoted hash of the minified page\n")
+    out.write("    const char*    contentType;\n")
+    out.write("};\n\n")
 
     for src_dir, filename, varname in pages:
-        src = os.path.join(src_dir, filename)
-        with open(src, "rb") as f:
-            raw = f.read()
-        compressed = gzip.compress(raw, compresslevel=9)
-        ratio = 100 * len(compressed) // len(raw)
-        print(f"  {filename}: {len(raw)}B -> {len(compressed)}B ({ratio}%)")
-
-        hex_bytes = ", ".join(f"0x{b:02x}" for b in compressed)
-        out.write(f"const uint8_t {varname}_GZ[] PROGMEM = {{{hex_bytes}}};\n")
-        out.write(f"const size_t {varname}_GZ_LEN = {len(compressed)};\n\n")
+        with open(os.path.join(src_dir, filename), "r", encoding="utf-8") as f:
+            source = f.read()
+        raw = minify(bundle(source, src_dir)).encode("utf-8")
+        # mtime=0 keeps the output identical between builds of the same page
+        gz = gzip.compress(raw, compresslevel=9, mtime=0)
+        br = brotli.compress(raw, quality=11) if brotli else None
+        etag = '"' + hashlib.sha256(raw).hexdigest()[:16] + '"'
+
+        sizes = f"gz {len(gz)}B" + (f", br {len(br)}B" if br else "")
+        print(f"  {filename}: {len(source.encode('utf-8'))}B -> {len(raw)}B minified -> {sizes}")
+
+        emit_bytes(out, f"{varname}_GZ", gz)
+        if br:
+            emit_bytes(out, f"{varname}_BR", br)
+        br_ref = f"{varname}_BR, sizeof({varname}_BR)" if br else "nullptr, 0"
+        etag_c = etag.replace('"', '\\"')
+        out.write(f"const StaticAsset {varname} = {{ {varname}_GZ, sizeof({varname}_GZ), {br_ref}, "
+                  f"\"{etag_c}\", \"text/html\" }};\n\n")
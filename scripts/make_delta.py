@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+# Build a delta OTA patch (include/DeltaPatch.h format) between two firmware
+# images, for publishing next to firmware.bin on a GitHub release:
+#
+#   python3 scripts/make_delta.py old/firmware.bin .pio/build/prod/firmware.bin \
+#       firmware-from-1.4.2.delta
+#
+# The asset must be named firmware-from-<old version>.delta. A device running
+# exactly that version's image applies it; anything else (different base
+# hash, or the asset is missing) falls back to the full firmware.bin.
+#
+# Matching works like bsdiff. An 8-byte index of the old image finds where
+# a stretch of the new image came from. That alignment is followed for as
+# long as at least half the bytes in a 32-byte window still agree, so
+# relocated code (same instructions, shifted addresses) becomes one ADD with
+# mostly-zero bytes instead of a run of tiny copies. The op stream is then
+# zlib-compressed at level 9.
+
+import hashlib
+import struct
+import sys
+import zlib
+
+KEY = 8          # index / minimum match length
+WINDOW = 32      # similarity window while following an alignment
+MAX_CANDIDATES = 8
+
+OP_END, OP_COPY, OP_ADD, OP_INSERT = 0, 1, 2, 3
+
+
+def varint(n):
+    out = bytearray()
+    while True:
+        b = n & 0x7F
+        n >>= 7
+        if n:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def zigzag(n):
+    return (n << 1) if n >= 0 else ((-n << 1) - 1)
+
+
+def build_index(old):
+    index = {}
+    for i in range(len(old) - KEY + 1):
+        slots = index.setdefault(old[i:i + KEY], [])
+        if len(slots) < MAX_CANDIDATES:
+            slots.append(i)
+    return index
+
+
+def exact_len(old, new, i, j):
+    n = 0
+    limit = min(len(old) - i, len(new) - j)
+    while n < limit and old[i + n] == new[j + n]:
+        n += 1
+    return n
+
+
+def follow(old, new, i, j):
+    # Extend an alignment (old i <-> new j) while it stays similar; returns
+    # the length, trimmed back to the last matching byte
+    n = 0
+    last_match = 0
+    misses = 0
+    window = []
+    limit = min(len(old) - i, len(new) - j)
+    while n < limit:
+        hit = old[i + n] == new[j + n]
+        window.append(hit)
+        if not hit:
+            misses += 1
+        if len(window) > WINDOW and not window.pop(0):
+            misses -= 1
+        if misses * 2 > WINDOW:
+            break
+        n += 1
+        if hit:
+            last_match = n
+    return last_match
+
+
+def diff(old, new):
+    index = build_index(old)
+    ops = []            # (op, src, length, payload)
+    literal = bytearray()
+    j = 0
+    while j < len(new):
+        best_i, best_len = -1, 0
+        for i in index.get(new[j:j + KEY], ()):
+            n = exact_len(old, new, i, j)
+            if n > best_len:
+                best_i, best_len = i, n
+        if best_len < KEY:
+            literal.append(new[j])
+            j += 1
+            continue
+        if literal:
+            ops.append((OP_INSERT, 0, len(literal), bytes(literal)))
+            literal = bytearray()
+        n = follow(old, new, best_i, j)
+        body = bytes((new[j + k] - old[best_i + k]) & 0xFF for k in range(n))
+        if body.count(0) == n:
+            ops.append((OP_COPY, best_i, n, b""))
+        else:
+            ops.append((OP_ADD, best_i, n, body))
+        j += n
+    if literal:
+        ops.append((OP_INSERT, 0, len(literal), bytes(literal)))
+    return ops
+
+
+def encode(old, new, ops):
+    out = bytearray(b"BRD1")
+    out += struct.pack("<I", len(old))
+    out += hashlib.sha256(old).digest()
+    out += struct.pack("<I", len(new))
+    cursor = 0
+    for op, src, length, payload in ops:
+        out.append(op)
+        out += varint(length)
+        if op != OP_INSERT:
+            out += varint(zigzag(src - cursor))
+            cursor = src + length
+        out += payload
+    out.append(OP_END)
+    return bytes(out)
+
+
+def apply(old, patch):
+    # Reference applier, used to check the patch before it is written
+    assert patch[:4] == b"BRD1"
+    target_size = struct.unpack_from("<I", patch, 40)[0]
+    p = 44
+    cursor = 0
+    out = bytearray()
+
+    def read_varint():
+        nonlocal p
+        n = shift = 0
+        while True:
+            b = patch[p]
+            p += 1
+            n |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                return n
+
+    while True:
+        op = patch[p]
+        p += 1
+        if op == OP_END:
+            break
+        length = read_varint()
+        if op == OP_INSERT:
+            out += patch[p:p + length]
+            p += length
+            continue
+        z = read_varint()
+        cursor += (z >> 1) ^ -(z & 1)
+        if op == OP_COPY:
+            out += old[cursor:cursor + length]
+        else:
+            out += bytes((old[cursor + k] + patch[p + k]) & 0xFF for k in range(length))
+            p += length
+        cursor += length
+    assert len(out) == target_size
+    return bytes(out)
+
+
+def main(argv):
+    if len(argv) != 4:
+        print(f"usage: {argv[0]} OLD.bin NEW.bin OUT.delta", file=sys.stderr)
+        return 2
+    with open(argv[1], "rb") as f:
+        old = f.read()
+    with open(argv[2], "rb") as f:
+        new = f.read()
+
+    raw = encode(old, new, diff(old, new))
+    if apply(old, raw) != new:
+        print("make_delta: patch does not reproduce the new image", file=sys.stderr)
+        return 1
+    packed = zlib.compress(raw, 9)
+    with open(argv[3], "wb") as f:
+        f.write(packed)
+    print(f"make_delta: {len(new)}B image -> {len(packed)}B patch "
+          f"({100.0 * len(packed) / len(new):.1f}%)")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -3,8 +3,11 @@
 #include "ConfigServer.h"
 #include "BoardPins.h"   // ALERT_PIN (handleTestEmergencyPin)
 #include "JsonResponder.h"
+#include "JsonWriter.h"
 #include "Logger.h"
-#include "Version.h"
+#include "LoopProfiler.h"
+#include "NotificationWorker.h"
+#include "NvsStore.h"
 #include "compressed_pages.h"
 
 // ============================================================================
@@ -73,8 +76,13 @@ ConfigServer::~ConfigServer() {
         dnsServer = nullptr;
     }
     stopSetupMode();
-    calibrationPrefs.end(); // Close calibration NVS namespace
-    // Emergency settings NVS is managed by SettingsStore
+    if (taskHandle) {
+        // Deferred stop: the task still points at this object
+        xSemaphoreTake(taskDone, portMAX_DELAY);
+        taskHandle = nullptr;
+        stopSetupMode();
+    }
+    // Calibration and emergency settings NVS go through NvsStore / SettingsStore
 }
 
 void ConfigServer::startSetupMode() {
@@ -119,6 +127,10 @@ void ConfigServer::startSetupMode() {
     // Route: GET /debug/init → merged JSON for debug page load (reading + calibration)
     server->on("/debug/init", HTTP_GET, [this]() { handleDebugInit(); });
 
+    // Route: GET / POST /debug/log-mask → runtime log category mask
+    server->on("/debug/log-mask", HTTP_GET, [this]() { handleGetLogMask(); });
+    server->on("/debug/log-mask", HTTP_POST, [this]() { handleSetLogMask(); });
+
     // Route: POST /config → save credentials
     server->on("/config", HTTP_POST, [this]() { handleSubmit(); });
     
@@ -137,6 +149,9 @@ void ConfigServer::startSetupMode() {
     // Route: GET /wifi/networks → return stored SSID list as JSON
     server->on("/wifi/networks", HTTP_GET, [this]() { handleWiFiNetworks(); });
 
+    // Route: GET /wifi/scan[?refresh=1] → cached nearby networks (WiFiManager scan cache)
+    server->on("/wifi/scan", HTTP_GET, [this]() { handleWiFiScan(); });
+
     // Route: POST /wifi/remove → remove a stored network by SSID
     server->on("/wifi/remove", HTTP_POST, [this]() { handleWiFiRemove(); });
     
@@ -155,6 +170,9 @@ void ConfigServer::startSetupMode() {
     // Route: POST /calibrate/point2 → set second calibration point
     server->on("/calibrate/point2", HTTP_POST, [this]() { handleCalibratePoint2(); });
 
+    // Route: POST /calibrate/table → set (or clear) the multi-point calibration table
+    server->on("/calibrate/table", HTTP_POST, [this]() { handleCalibrateTable(); });
+
     // Route: POST /calibration/emergency-level -> set emergency water level (Tier 1)
     server->on("/calibration/emergency-level", HTTP_POST, [this]() { handleSetEmergencyLevel(); });
     
@@ -169,10 +187,10 @@ void ConfigServer::startSetupMode() {
         float el  = settingsStore ? settingsStore->getEmergencyWaterLevel()       : SETTINGS_DEFAULTS().emergencyWaterLevel_cm;
         int   ef  = settingsStore ? settingsStore->getEmergencyNotifFreq()        : SETTINGS_DEFAULTS().emergencyNotifFreq_ms;
         float ul  = settingsStore ? settingsStore->getUrgentEmergencyWaterLevel() : SETTINGS_DEFAULTS().urgentEmergencyWaterLevel_cm;
-        JsonResponder().num("emergencyWaterLevel_cm", el, 2)
-                       .num("emergencyNotifFreq_ms", ef)
-                       .num("urgentEmergencyWaterLevel_cm", ul, 2)
-                       .send(server);
+        JsonResponder(server).num("emergencyWaterLevel_cm", el, 2)
+                             .num("emergencyNotifFreq_ms", ef)
+                             .num("urgentEmergencyWaterLevel_cm", ul, 2)
+                             .send();
         serverStartTime = millis();
     });
     
@@ -212,6 +230,12 @@ void ConfigServer::startSetupMode() {
     // Route: POST /notifications/test/mqtt → send test MQTT message
     server->on("/notifications/test/mqtt", HTTP_POST, [this]() { handleTestMqtt(); });
 
+    // Route: GET /notifications/test/status?id=N → result of a queued test send
+    server->on("/notifications/test/status", HTTP_GET, [this]() { handleTestStatus(); });
+
+    // Route: GET /events → live reading stream (Server-Sent Events)
+    server->on("/events", HTTP_GET, [this]() { handleEvents(); });
+
     // Route: GET /ota-settings → serve OTA settings page
     server->on("/ota-settings", HTTP_GET, [this]() { handleOTAPage(); });
     
@@ -234,20 +258,50 @@ void ConfigServer::startSetupMode() {
     // index page to every probe).
     server->onNotFound([this]() { handleCaptivePortalProbe(); });
     
-    // Enable reading If-None-Match for ETag-based caching
-    const char* headersToCollect[] = {"If-None-Match"};
-    server->collectHeaders(headersToCollect, 1);
+    // Enable reading If-None-Match for ETag-based caching, and
+    // Accept-Encoding to pick the Brotli or gzip copy of a page
+    const char* headersToCollect[] = {"If-None-Match", "Accept-Encoding"};
+    server->collectHeaders(headersToCollect, 2);
 
     // Start the server
     server->begin();
     setupModeActive = true;
     serverStartTime = millis();
+
+    // Step 6: Serve from a task of its own
+    if (!taskDone) taskDone = xSemaphoreCreateBinary();
+    stopRequested = false;
+    BaseType_t ok = pdFALSE;
+    if (taskDone) {
+        ok = xTaskCreatePinnedToCore(taskEntry, "config_srv", CONFIG_SERVER_TASK_STACK,
+                                     this, CONFIG_SERVER_TASK_PRIORITY, &taskHandle, CONFIG_SERVER_TASK_CORE);
+    }
+    if (ok != pdPASS) {
+        LOG_CRITICAL("[CONFIG] Server task creation FAILED — serving from loop()");
+        taskHandle = nullptr;
+    }
     
     LOG_INFO("Setup mode started. Open browser and navigate to 192.168.4.1");
     LOG_INFO("Or simply open any website - captive portal will redirect you!");
 }
 
 void ConfigServer::stopSetupMode() {
+    if (taskHandle) {
+        // A request in progress finishes first; the task exits at its next poll
+        stopRequested = true;
+        if (xSemaphoreTake(taskDone, pdMS_TO_TICKS(CONFIG_SERVER_STOP_WAIT_MS)) != pdTRUE) {
+            // Never delete it from here: a handler may hold the WiFiManager or
+            // notifier mutex. It still exits on its own; handleClient()
+            // finishes the teardown once it has.
+            LOG_CRITICAL("[CONFIG] Server task did not stop within %u ms — teardown deferred",
+                         (unsigned)CONFIG_SERVER_STOP_WAIT_MS);
+            return;
+        }
+        taskHandle = nullptr;
+    }
+    pinTestEndMs = 0;
+    closeEventClients();
+
     if (server) {
         server->stop();
         delete server;
@@ -291,6 +345,46 @@ void ConfigServer::handleClient() {
     // Guard clause: Only continue if server exists and setup mode is active
     if (!server || !setupModeActive) return;
 
+    // A stop that outlasted CONFIG_SERVER_STOP_WAIT_MS: wait for the task's
+    // own exit, then tear down
+    if (taskHandle && stopRequested) {
+        if (xSemaphoreTake(taskDone, 0) == pdTRUE) {
+            taskHandle = nullptr;
+            stopSetupMode();
+        }
+        return;
+    }
+
+    if (!taskHandle) serve();
+
+    // Handle server timeout. serverStartTime is stamped by the server task,
+    // so it can be a little ahead of this millis() — compare signed.
+    if ((int32_t)(millis() - serverStartTime) >= (int32_t)SERVER_TIMEOUT_MS) {
+        LOG_INFO("Setup mode timed out after %lu ms with no client activity", (unsigned long)SERVER_TIMEOUT_MS);
+        stopSetupMode();
+    }   
+}
+
+uint32_t ConfigServer::getStackHighWaterMark() const {
+    // Once stopping, the handle may already name a deleted task
+    if (!taskHandle || stopRequested) return 0;
+    return (uint32_t)uxTaskGetStackHighWaterMark(taskHandle);
+}
+
+void ConfigServer::taskEntry(void* arg) {
+    static_cast<ConfigServer*>(arg)->run();
+}
+
+void ConfigServer::run() {
+    while (!stopRequested) {
+        serve();
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_SERVER_POLL_MS));
+    }
+    xSemaphoreGive(taskDone);
+    vTaskDelete(nullptr);
+}
+
+void ConfigServer::serve() {
     // Process captive portal DNS requests
     if (dnsServer) {
         dnsServer->processNextRequest();
@@ -312,163 +406,238 @@ void ConfigServer::handleClient() {
     server->handleClient();
 #endif
 
-    // Handle server timeout
-    if ((millis() - serverStartTime) >= SERVER_TIMEOUT_MS) {
-        LOG_INFO("Setup mode timed out after %lu ms with no client activity", (unsigned long)SERVER_TIMEOUT_MS);
-        stopSetupMode();
-    }   
+    pushEvents();
 }
 
 // ============================================================================
 // WIFI CONFIGURATION HANDLERS
 // ============================================================================
 
-void ConfigServer::sendCachedPage(const char* data, size_t len, const char* contentType) {
+// True if an Accept-Encoding value lists `token` (a whole coding name, any
+// q-value other than q=0 ignored — browsers don't send those for br/gzip)
+static bool acceptsEncoding(const String& header, const char* token) {
+    size_t n = strlen(token);
+    const char* p = header.c_str();
+    while ((p = strstr(p, token)) != nullptr) {
+        bool startOk = p == header.c_str() || p[-1] == ' ' || p[-1] == ',';
+        char end = p[n];
+        if (startOk && (end == '\0' || end == ',' || end == ';' || end == ' ')) return true;
+        p += n;
+    }
+    return false;
+}
+
+void ConfigServer::sendCachedPage(const StaticAsset& page) {
     serverStartTime = millis();
-    // ETag includes the build timestamp so that flashing new firmware (even at
-    // the same FIRMWARE_VERSION) busts the browser cache. Without this, a reflash
-    // at the same version would get a 304 and the browser would serve stale HTML.
-    String etag = String(FIRMWARE_VERSION) + "-" + BUILD_TIMESTAMP;
-    if (server->hasHeader("If-None-Match") && server->header("If-None-Match") == etag) {
+    // The ETag is a hash of the page itself (scripts/compress_html.py), so a
+    // firmware update that didn't touch this page still revalidates to a 304.
+    if (server->hasHeader("If-None-Match") && server->header("If-None-Match") == page.etag) {
+        server->sendHeader("ETag", page.etag);
         server->send(304);
         return;
     }
+    // Browsers only offer br over HTTPS, so on the plain-HTTP portal this
+    // is mostly gzip; Brotli is there for clients that ask for it
+    bool br = page.br && server->hasHeader("Accept-Encoding") &&
+              acceptsEncoding(server->header("Accept-Encoding"), "br");
     server->sendHeader("Cache-Control", "max-age=86400, must-revalidate");
-    server->sendHeader("ETag", etag);
-    server->sendHeader("Content-Encoding", "gzip");
-    server->send_P(200, contentType, data, len);
+    server->sendHeader("ETag", page.etag);
+    server->sendHeader("Vary", "Accept-Encoding");
+    server->sendHeader("Content-Encoding", br ? "br" : "gzip");
+    if (br) server->send_P(200, page.contentType, (const char*)page.br, page.brLen);
+    else    server->send_P(200, page.contentType, (const char*)page.gz, page.gzLen);
 }
 
 void ConfigServer::handleRoot() {
     PROFILE_REQUEST("GET /");
-    sendCachedPage((const char*)INDEX_HTML_GZ, INDEX_HTML_GZ_LEN, "text/html");
+    sendCachedPage(INDEX_HTML);
 }
 
 void ConfigServer::handleWiFiConfig() {
     PROFILE_REQUEST("GET /wifi-config");
-    sendCachedPage((const char*)WIFI_CONFIG_HTML_GZ, WIFI_CONFIG_HTML_GZ_LEN, "text/html");
+    sendCachedPage(WIFI_CONFIG_HTML);
 }
 
 void ConfigServer::handleNotificationsPage() {
     PROFILE_REQUEST("GET /notifications");
-    sendCachedPage((const char*)NOTIFICATIONS_HTML_GZ, NOTIFICATIONS_HTML_GZ_LEN, "text/html");
+    sendCachedPage(NOTIFICATIONS_HTML);
 }
 
 void ConfigServer::handleSettings() {
     PROFILE_REQUEST("GET /settings");
-    sendCachedPage((const char*)SETTINGS_HTML_GZ, SETTINGS_HTML_GZ_LEN, "text/html");
+    sendCachedPage(SETTINGS_HTML);
 }
 
 void ConfigServer::handleInit() {
     PROFILE_REQUEST("GET /init");
-    JsonResponder r(512);
+    JsonResponder r(server);
 
-    // Nested objects are assembled as strings and attached raw (JsonResponder is flat-only).
     bool connected = WiFiManager::getInstance().isConnected();
-    JsonResponder wifiR;
-    wifiR.boolean("connected", connected)
+    r.beginObject("wifi")
+        .boolean("connected", connected)
         .str("ssid", WiFi.SSID())
         .str("ip", WiFi.localIP().toString())
-        .num("rssi", (int)WiFi.RSSI());
-    r.raw("wifi", wifiR.body().c_str());
+        .num("rssi", (int)WiFi.RSSI())
+     .end();
 
-    String sensorObj = "{";
+    r.beginObject("sensor");
     if (!waterSensor) {
-        sensorObj += "\"sensorAvailable\":false";
+        r.boolean("sensorAvailable", false);
     } else {
-        SensorReading reading = waterSensor->readLevel();
-        sensorObj += "\"sensorAvailable\":true,";
-        sensorObj += "\"valid\":" + String(reading.valid ? "true" : "false");
+        SensorReading reading = waterSensor->getLatestReading();
+        r.boolean("sensorAvailable", true);
+        r.boolean("valid", reading.valid);
         if (reading.valid) {
-            sensorObj += ",\"level_cm\":" + String(reading.level_cm, 2);
+            r.num("level_cm", reading.level_cm, 2);
         }
         float rate = waterSensor->getRateOfChange_cm30min();
         if (!isnan(rate)) {
-            sensorObj += ",\"rate_cm_30min\":" + String(rate, 2);
+            r.num("rate_cm_30min", rate, 2);
         }
     }
-    sensorObj += "}";
-    r.raw("sensor", sensorObj.c_str());
+    r.end();
 
-    String thresholdsObj = "{";
-    thresholdsObj += "\"emergencyWaterLevel_cm\":" + String(getEmergencyWaterLevel(), 2) + ",";
-    thresholdsObj += "\"urgentEmergencyWaterLevel_cm\":" + String(getUrgentEmergencyWaterLevel(), 2);
-    thresholdsObj += "}";
-    r.raw("thresholds", thresholdsObj.c_str());
+    r.beginObject("thresholds")
+        .num("emergencyWaterLevel_cm", getEmergencyWaterLevel(), 2)
+        .num("urgentEmergencyWaterLevel_cm", getUrgentEmergencyWaterLevel(), 2)
+     .end();
 
-    r.send(server);
+    r.send();
     serverStartTime = millis();
 }
 
 void ConfigServer::handleSettingsInit() {
     PROFILE_REQUEST("GET /settings/init");
-    JsonResponder r(384);
+    JsonResponder r(server);
 
     // notifications block (mirrors fields settings.html reads from /notifications)
     bool mqttCfg = mqttService && mqttService->hasBrokerConfig();
-    String notifObj = "{";
-    notifObj += "\"hasPhoneNumber\":";
-    notifObj += (smsService && smsService->hasPhoneNumber()) ? "true" : "false";
-    notifObj += ",\"hasDiscordWebhook\":";
-    notifObj += (discordService && discordService->hasWebhookUrl()) ? "true" : "false";
-    notifObj += ",\"mqttConfigured\":";
-    notifObj += mqttCfg ? "true" : "false";
-    notifObj += ",\"mqttConnected\":";
-    notifObj += (mqttCfg && mqttService->isConnected()) ? "true" : "false";
-    notifObj += "}";
-    r.raw("notifications", notifObj.c_str());
+    r.beginObject("notifications")
+        .boolean("hasPhoneNumber", smsService && smsService->hasPhoneNumber())
+        .boolean("hasDiscordWebhook", discordService && discordService->hasWebhookUrl())
+        .boolean("mqttConfigured", mqttCfg)
+        .boolean("mqttConnected", mqttCfg && mqttService->isConnected())
+     .end();
 
     // emergency freq (the only /emergency-settings field settings.html uses)
     r.num("emergencyNotifFreq_ms", getEmergencyNotifFreq());
 
     // wifi (mirrors fields settings.html reads from /status)
     bool connected = WiFiManager::getInstance().isConnected();
-    JsonResponder wifiR;
-    wifiR.boolean("connected", connected).str("ssid", WiFi.SSID());
-    r.raw("wifi", wifiR.body().c_str());
+    r.beginObject("wifi")
+        .boolean("connected", connected)
+        .str("ssid", WiFi.SSID())
+     .end();
 
     // calibration (only the hasTwoPointCalibration flag is used)
     r.boolean("hasTwoPointCalibration", waterSensor && waterSensor->hasTwoPointCalibration());
 
-    r.send(server);
+    r.send();
     serverStartTime = millis();
 }
 
+// Runtime log mask fields, shared by GET /debug/log-mask and /debug/init
+static void fillLogMask(JsonResponder& r) {
+    char mask[64], def[64];
+    LogTags::formatMask(g_logMask, mask, sizeof(mask));
+    LogTags::formatMask(LOG_DEFAULT_MASK, def, sizeof(def));
+    r.str("mask", mask)
+     .str("default", def)
+     .num("revert_s", logMaskRemainingSec());
+    r.beginArray("tags");
+    for (uint8_t t = 0; t < LOG_TAG_COUNT; t++) r.str(nullptr, LogTags::name(t));
+    r.end();
+}
+
 void ConfigServer::handleDebugInit() {
     PROFILE_REQUEST("GET /debug/init");
 
     if (!waterSensor) {
-        JsonResponder().raw("reading", "{\"sensorAvailable\":false}")
-                       .raw("calibration", "null")
-                       .send(server);
+        JsonResponder(server).raw("reading", "{\"sensorAvailable\":false}")
+                             .raw("calibration", "null")
+                             .send();
         serverStartTime = millis();
         return;
     }
 
-    SensorReading reading = waterSensor->readLevel();
-    String readingObj = "{";
-    readingObj += "\"sensorAvailable\":true,";
-    readingObj += "\"valid\":" + String(reading.valid ? "true" : "false") + ",";
-    readingObj += "\"millivolts\":" + String(reading.millivolts, 2);
+    JsonResponder r(server);
+
+    SensorReading reading = waterSensor->getLatestReading();
+    r.beginObject("reading")
+        .boolean("sensorAvailable", true)
+        .boolean("valid", reading.valid)
+        .num("millivolts", reading.millivolts, 2);
     if (reading.valid) {
-        readingObj += ",\"level_cm\":" + String(reading.level_cm, 2);
+        r.num("level_cm", reading.level_cm, 2);
     }
-    readingObj += "}";
+    r.end();
 
-    String calObj = "{";
-    calObj += "\"zeroPoint_mv\":" + String(waterSensor->getZeroPointMilliVolts()) + ",";
-    calObj += "\"hasTwoPointCalibration\":";
-    calObj += waterSensor->hasTwoPointCalibration() ? "true" : "false";
+    r.beginObject("calibration")
+        .num("zeroPoint_mv", (int)waterSensor->getZeroPointMilliVolts())
+        .boolean("hasTwoPointCalibration", waterSensor->hasTwoPointCalibration());
     if (waterSensor->hasTwoPointCalibration()) {
-        calObj += ",\"secondPoint_mv\":" + String(waterSensor->getSecondPointMilliVolts());
-        calObj += ",\"secondPoint_cm\":" + String(waterSensor->getSecondPointLevelCm(), 2);
+        r.num("secondPoint_mv", (int)waterSensor->getSecondPointMilliVolts());
+        r.num("secondPoint_cm", waterSensor->getSecondPointLevelCm(), 2);
+    }
+    r.end();
+
+    // Per-channel notification latency histograms (queue / deliver / send)
+    r.beginObject("notifyLatency");
+    if (notifier) {
+        char hist[448];
+        for (size_t i = 0; i < notifier->getChannelCount(); i++) {
+            if (notifier->formatLatencyJson(i, hist, sizeof(hist)) == 0) continue;
+            r.raw(notifier->getChannelName(i), hist);
+        }
     }
-    calObj += "}";
+    r.end();
+
+    r.beginObject("logMask");
+    fillLogMask(r);
+    r.end();
+
+    // loop() section timings. Static: requests are served one at a time,
+    // and the copy is too big for the server task's stack.
+    if (loopProfileSource) {
+        static char profile[LoopProfiler::DEBUG_JSON_MAX];
+        if (loopProfileSource(profile, sizeof(profile), loopProfileCtx) > 0) {
+            r.raw("loopProfile", profile);
+        }
+    }
+
+    r.send();
+    serverStartTime = millis();
+}
 
-    JsonResponder().raw("reading", readingObj.c_str())
-                   .raw("calibration", calObj.c_str())
-                   .send(server);
+void ConfigServer::handleGetLogMask() {
     serverStartTime = millis();
+    JsonResponder r(server);
+    fillLogMask(r);
+    r.send();
+}
+
+void ConfigServer::handleSetLogMask() {
+    serverStartTime = millis();
+    if (!server->hasArg("mask")) {
+        JsonResponder::sendError(server, 400, "Missing mask parameter");
+        return;
+    }
+    // "for" as a separate field is the same as a "for=" token in the text
+    String text = server->arg("mask");
+    if (server->hasArg("for") && server->arg("for").toInt() > 0) {
+        text += " for=";
+        text += server->arg("for");
+    }
+    if (!logApplyMaskText(text.c_str(), text.length())) {
+        JsonResponder::sendError(server, 400, "Unknown log category");
+        return;
+    }
+    char mask[64];
+    LogTags::formatMask(g_logMask, mask, sizeof(mask));
+    JsonResponder(server).success("Log mask updated")
+                         .str("mask", mask)
+                         .num("revert_s", logMaskRemainingSec())
+                         .send();
 }
 
 void ConfigServer::handleCaptivePortalProbe() {
@@ -511,11 +680,11 @@ void ConfigServer::handleSubmit() {
 void ConfigServer::handleStatus() {
     PROFILE_REQUEST("GET /status");
     // Return connection status as JSON
-    JsonResponder().boolean("connected", WiFiManager::getInstance().isConnected())
-                   .str("ssid", WiFi.SSID())
-                   .str("ip", WiFi.localIP().toString())
-                   .num("rssi", (int)WiFi.RSSI())
-                   .send(server);
+    JsonResponder(server).boolean("connected", WiFiManager::getInstance().isConnected())
+                         .str("ssid", WiFi.SSID())
+                         .str("ip", WiFi.localIP().toString())
+                         .num("rssi", (int)WiFi.RSSI())
+                         .send();
 }
 
 void ConfigServer::handleWiFiNetworks() {
@@ -523,24 +692,52 @@ void ConfigServer::handleWiFiNetworks() {
     // Response is a bare JSON array (["ssid1",...]) — the dev-ui mock server
     // (res.json(storedNetworks)) and any client expecting a list depend on
     // that shape, so it is intentionally NOT wrapped in an object.
-    String networksArr = "[";
-    for (int i = 0; i < (int)ssids.size(); i++) {
-        if (i > 0) networksArr += ",";
-        networksArr += "\"" + ssids[i] + "\"";
-    }
-    networksArr += "]";
-    server->send(200, "application/json", networksArr);
+    JsonResponder r(server, 200, JsonResponder::ARRAY);
+    for (const String& ssid : ssids) r.str(nullptr, ssid);
+    r.send();
+    serverStartTime = millis();
+}
+
+void ConfigServer::handleWiFiScan() {
     serverStartTime = millis();
+    WiFiManager& wifiMgr = WiFiManager::getInstance();
+    // Answers from the cache straight away. A stale (or explicitly
+    // refreshed) list starts a background scan; the page polls again while
+    // "scanning" is true.
+    ScanCache scan = wifiMgr.getScanResults();
+    uint32_t age = scan.ageMs(millis());
+    if (server->arg("refresh") == "1" || age > SCAN_FRESH_MS) wifiMgr.requestScan();
+    std::vector<String> stored = wifiMgr.getStoredSSIDs();
+
+    JsonResponder r(server);
+    r.boolean("scanning", wifiMgr.isScanning());
+    if (scan.valid()) r.num("ageMs", age);
+    else              r.raw("ageMs", "null");
+    r.beginArray("networks");
+    for (uint8_t i = 0; i < scan.size(); i++) {
+        bool isStored = false;
+        for (const String& s : stored) {
+            if (s == scan[i].ssid) { isStored = true; break; }
+        }
+        r.beginObject().str("ssid", scan[i].ssid)
+                       .num("rssi", (int)scan[i].rssi)
+                       .num("channel", (int)scan[i].channel)
+                       .boolean("open", scan[i].open)
+                       .boolean("stored", isStored)
+                       .end();
+    }
+    r.end();
+    r.send();
 }
 
 void ConfigServer::handleWiFiRemove() {
     if (!server->hasArg("ssid") || server->arg("ssid").isEmpty()) {
-        JsonResponder().boolean("success", false).str("message", "Missing ssid").send(server, 400);
+        JsonResponder(server, 400).boolean("success", false).str("message", "Missing ssid").send();
         return;
     }
     String ssid = server->arg("ssid");
     WiFiManager::getInstance().removeNetwork(ssid.c_str());
-    JsonResponder().boolean("success", true).send(server);
+    JsonResponder(server).boolean("success", true).send();
     serverStartTime = millis();
 }
 
@@ -556,18 +753,21 @@ void ConfigServer::handleCalibrateZero() {
         JsonResponder::sendError(server, 503, "Sensor not available");
         return;
     }
+    uint8_t channel;
+    if (!parseChannelArg(channel)) return;
     
     if (server->hasArg("millivolts")) {
         int millivolts = server->arg("millivolts").toInt();
         float level_cm = server->hasArg("level_cm") ? server->arg("level_cm").toFloat() : 0.0f;
         
-        waterSensor->setCalibrationPoint(0, millivolts, level_cm);
+        waterSensor->setCalibrationPoint(0, millivolts, level_cm, channel);
         saveCalibration();
         
-        JsonResponder::success("Zero point calibrated")
-            .num("millivolts", millivolts)
-            .num("level_cm", level_cm, 2)
-            .send(server);
+        JsonResponder(server).success("Zero point calibrated")
+                             .num("channel", channel)
+                             .num("millivolts", millivolts)
+                             .num("level_cm", level_cm, 2)
+                             .send();
     } else {
         JsonResponder::sendError(server, 400, "Missing millivolts parameter");
     }
@@ -580,18 +780,21 @@ void ConfigServer::handleCalibratePoint2() {
         JsonResponder::sendError(server, 503, "Sensor not available");
         return;
     }
+    uint8_t channel;
+    if (!parseChannelArg(channel)) return;
     
     if (server->hasArg("millivolts") && server->hasArg("level_cm")) {
         int millivolts = server->arg("millivolts").toInt();
         float level_cm = server->arg("level_cm").toFloat();
         
-        waterSensor->setCalibrationPoint(1, millivolts, level_cm);
+        waterSensor->setCalibrationPoint(1, millivolts, level_cm, channel);
         saveCalibration();
         
-        JsonResponder::success("Second calibration point set")
-            .num("millivolts", millivolts)
-            .num("level_cm", level_cm, 2)
-            .send(server);
+        JsonResponder(server).success("Second calibration point set")
+                             .num("channel", channel)
+                             .num("millivolts", millivolts)
+                             .num("level_cm", level_cm, 2)
+                             .send();
     } else {
         JsonResponder::sendError(server, 400, "Missing millivolts or level_cm parameter");
     }
@@ -605,42 +808,139 @@ void ConfigServer::handleGetCalibration() {
         return;
     }
     
-    JsonResponder r;
-    r.num("zeroPoint_mv", waterSensor->getZeroPointMilliVolts());
-    r.boolean("hasTwoPointCalibration", waterSensor->hasTwoPointCalibration());
+    uint8_t channel;
+    if (!parseChannelArg(channel)) return;
     
-    if (waterSensor->hasTwoPointCalibration()) {
-        r.num("secondPoint_mv", waterSensor->getSecondPointMilliVolts());
-        r.num("secondPoint_cm", waterSensor->getSecondPointLevelCm(), 2);
+    JsonResponder r(server);
+    r.num("channel", channel);
+    r.num("channels", waterSensor->channelCount());
+    r.num("zeroPoint_mv", waterSensor->getZeroPointMilliVolts(channel));
+    r.boolean("hasTwoPointCalibration", waterSensor->hasTwoPointCalibration(channel));
+    
+    if (waterSensor->hasTwoPointCalibration(channel)) {
+        r.num("secondPoint_mv", waterSensor->getSecondPointMilliVolts(channel));
+        r.num("secondPoint_cm", waterSensor->getSecondPointLevelCm(channel), 2);
+    }
+
+    CalibrationPoint table[CalibrationTable::MAX_POINTS];
+    uint8_t n = waterSensor->getCalibrationTable(table, CalibrationTable::MAX_POINTS, channel);
+    if (n > 0) {
+        r.beginArray("table");
+        for (uint8_t i = 0; i < n; i++) {
+            r.beginArray()
+                .num(nullptr, (int)table[i].millivolts)
+                .num(nullptr, table[i].level_cm, 2)
+             .end();
+        }
+        r.end();
     }
     
-    r.send(server);
+    r.send();
+}
+
+void ConfigServer::handleCalibrateTable() {
+    serverStartTime = millis();
+
+    if (!waterSensor) {
+        JsonResponder::sendError(server, 503, "Sensor not available");
+        return;
+    }
+    uint8_t channel;
+    if (!parseChannelArg(channel)) return;
+
+    if (!server->hasArg("points")) {
+        JsonResponder::sendError(server, 400, "Missing points parameter");
+        return;
+    }
+
+    // points = "mv:cm,mv:cm,..." — empty clears the table (back to two-point).
+    String arg = server->arg("points");
+    CalibrationPoint table[CalibrationTable::MAX_POINTS];
+    uint8_t n = 0;
+    const char* p = arg.c_str();
+    while (*p) {
+        char* end;
+        long mv = strtol(p, &end, 10);
+        if (end == p || *end != ':') break;
+        p = end + 1;
+        float cm = strtof(p, &end);
+        if (end == p || n >= CalibrationTable::MAX_POINTS) break;
+        table[n].millivolts = (int32_t)mv;
+        table[n].level_cm = cm;
+        n++;
+        p = end;
+        if (*p == ',') p++;
+        else if (*p) break;
+    }
+    if (*p) {
+        char errorMsg[64];
+        snprintf(errorMsg, sizeof(errorMsg), "Invalid points. Expected up to %u comma-separated mv:cm pairs",
+                 (unsigned)CalibrationTable::MAX_POINTS);
+        JsonResponder::sendError(server, 400, errorMsg);
+        return;
+    }
+    if (n == 1 || !waterSensor->setCalibrationTable(table, n, channel)) {
+        JsonResponder::sendError(server, 400, "Need at least 2 points with distinct millivolts");
+        return;
+    }
+    saveCalibration();
+
+    JsonResponder(server).success(n ? "Calibration table set" : "Calibration table cleared")
+                         .num("channel", channel)
+                         .num("points", n)
+                         .send();
+}
+
+// NVS key for one calibration field of one compartment. Channel 0 keeps the
+// original un-prefixed keys so existing single-compartment calibrations load
+// unchanged; channel n uses "c<n>_<field>" (still within the 15-char limit).
+static const char* calibrationKey(char* buf, size_t len, const char* field, uint8_t channel) {
+    if (channel == 0) return field;
+    snprintf(buf, len, "c%u_%s", channel, field);
+    return buf;
 }
 
 void ConfigServer::loadCalibration() {
     
     if (!waterSensor) return;
 
-    if (!calibrationPrefs.begin(SENSOR_CALIBRATION_NAMESPACE, true)) {
+    NvsReader calibrationPrefs;
+    if (!calibrationPrefs.begin(SENSOR_CALIBRATION_NAMESPACE)) {
         LOG_CRITICAL("Failed to load the calibration NVS storage in read mode");
     }
     
-    int zero_mv = calibrationPrefs.getInt("zero_mv", -1);
-    if (zero_mv >= 0) {
-        waterSensor->setCalibrationPoint(0, zero_mv, 0.0f);
-        LOG_INFO("[CALIBRATION] Loaded zero point from NVS: %d mV", zero_mv);
-    } else {
-        LOG_INFO("[CALIBRATION] No zero point calibration found in NVS, using default");
-    }
-    
-    int point2_mv = calibrationPrefs.getInt("point2_mv", -1);
-    float point2_cm = calibrationPrefs.getFloat("point2_cm", -1.0f);
-    if (point2_mv >= 0 && point2_cm >= 0) {
-        waterSensor->setCalibrationPoint(1, point2_mv, point2_cm);
-        LOG_INFO("[CALIBRATION] Loaded second point from NVS: %d mV = %.2f cm (2-point calibration active)", 
-                      point2_mv, point2_cm);
-    } else {
-        LOG_INFO("[CALIBRATION] No second calibration point found in NVS");
+    char key[16];
+    for (uint8_t ch = 0; ch < waterSensor->channelCount(); ch++) {
+        int zero_mv = calibrationPrefs.getInt(calibrationKey(key, sizeof(key), "zero_mv", ch), -1);
+        if (zero_mv >= 0) {
+            waterSensor->setCalibrationPoint(0, zero_mv, 0.0f, ch);
+            LOG_INFO("[CALIBRATION] ch%u: Loaded zero point from NVS: %d mV", ch, zero_mv);
+        } else {
+            LOG_INFO("[CALIBRATION] ch%u: No zero point calibration found in NVS, using default", ch);
+        }
+        
+        int point2_mv = calibrationPrefs.getInt(calibrationKey(key, sizeof(key), "point2_mv", ch), -1);
+        float point2_cm = calibrationPrefs.getFloat(calibrationKey(key, sizeof(key), "point2_cm", ch), -1.0f);
+        if (point2_mv >= 0 && point2_cm >= 0) {
+            waterSensor->setCalibrationPoint(1, point2_mv, point2_cm, ch);
+            LOG_INFO("[CALIBRATION] ch%u: Loaded second point from NVS: %d mV = %.2f cm (2-point calibration active)", 
+                          ch, point2_mv, point2_cm);
+        } else {
+            LOG_INFO("[CALIBRATION] ch%u: No second calibration point found in NVS", ch);
+        }
+
+        // Multi-point table (blob of CalibrationPoint) overrides the two-point line
+        const char* tableKey = calibrationKey(key, sizeof(key), "table", ch);
+        size_t len = calibrationPrefs.isKey(tableKey) ? calibrationPrefs.getBytesLength(tableKey) : 0;
+        if (len > 0 && len % sizeof(CalibrationPoint) == 0 &&
+            len <= sizeof(CalibrationPoint) * CalibrationTable::MAX_POINTS) {
+            CalibrationPoint table[CalibrationTable::MAX_POINTS];
+            calibrationPrefs.getBytes(tableKey, table, len);
+            uint8_t n = (uint8_t)(len / sizeof(CalibrationPoint));
+            if (waterSensor->setCalibrationTable(table, n, ch)) {
+                LOG_INFO("[CALIBRATION] ch%u: Loaded %u-point calibration table from NVS", ch, n);
+            }
+        }
     }
 
     calibrationPrefs.end();
@@ -649,33 +949,56 @@ void ConfigServer::loadCalibration() {
 void ConfigServer::saveCalibration() {
     if (!waterSensor) return;
 
-    if (!calibrationPrefs.begin(SENSOR_CALIBRATION_NAMESPACE, false)) {
-        LOG_CRITICAL("Failed to load the calibration NVS storage in write mode");
-    }
-    
-    int zero_mv = waterSensor->getZeroPointMilliVolts();
-    calibrationPrefs.putInt("zero_mv", zero_mv);
-    LOG_INFO("[CALIBRATION] Saved zero point to NVS: %d mV", zero_mv);
-    
-    if (waterSensor->hasTwoPointCalibration()) {
-        int point2_mv = waterSensor->getSecondPointMilliVolts();
-        float point2_cm = waterSensor->getSecondPointLevelCm();
-        calibrationPrefs.putInt("point2_mv", point2_mv);
-        calibrationPrefs.putFloat("point2_cm", point2_cm);
-        LOG_INFO("[CALIBRATION] Saved second point to NVS: %d mV = %.2f cm (2-point calibration)", 
-                      point2_mv, point2_cm);
-    } else {
-        calibrationPrefs.remove("point2_mv");
-        calibrationPrefs.remove("point2_cm");
-        LOG_INFO("[CALIBRATION] Removed second calibration point from NVS (single-point mode)");
-    }
+    // Write-behind (NvsStore.h): handlers return before the flash commit,
+    // and repeated saves while calibrating coalesce into one
+    NvsStore& nvs = NvsStore::getInstance();
+    const char* ns = SENSOR_CALIBRATION_NAMESPACE;
 
-    calibrationPrefs.end();
+    char key[16];
+    for (uint8_t ch = 0; ch < waterSensor->channelCount(); ch++) {
+        int zero_mv = waterSensor->getZeroPointMilliVolts(ch);
+        nvs.putInt(ns, calibrationKey(key, sizeof(key), "zero_mv", ch), zero_mv);
+        LOG_INFO("[CALIBRATION] ch%u: Saved zero point to NVS: %d mV", ch, zero_mv);
+        
+        if (waterSensor->hasTwoPointCalibration(ch)) {
+            int point2_mv = waterSensor->getSecondPointMilliVolts(ch);
+            float point2_cm = waterSensor->getSecondPointLevelCm(ch);
+            nvs.putInt(ns, calibrationKey(key, sizeof(key), "point2_mv", ch), point2_mv);
+            nvs.putFloat(ns, calibrationKey(key, sizeof(key), "point2_cm", ch), point2_cm);
+            LOG_INFO("[CALIBRATION] ch%u: Saved second point to NVS: %d mV = %.2f cm (2-point calibration)", 
+                          ch, point2_mv, point2_cm);
+        } else {
+            nvs.remove(ns, calibrationKey(key, sizeof(key), "point2_mv", ch));
+            nvs.remove(ns, calibrationKey(key, sizeof(key), "point2_cm", ch));
+            LOG_INFO("[CALIBRATION] ch%u: Removed second calibration point from NVS (single-point mode)", ch);
+        }
+
+        CalibrationPoint table[CalibrationTable::MAX_POINTS];
+        uint8_t n = waterSensor->getCalibrationTable(table, CalibrationTable::MAX_POINTS, ch);
+        const char* tableKey = calibrationKey(key, sizeof(key), "table", ch);
+        if (n > 0) {
+            nvs.putBytes(ns, tableKey, table, n * sizeof(CalibrationPoint));
+            LOG_INFO("[CALIBRATION] ch%u: Saved %u-point calibration table to NVS", ch, n);
+        } else {
+            nvs.remove(ns, tableKey);       // no-op at commit if absent
+        }
+    }
 }
 
-// ============================================================================
-// EMERGENCY SETTINGS HANDLERS
-// ============================================================================
+bool ConfigServer::parseChannelArg(uint8_t& channel) {
+    channel = 0;
+    if (!server->hasArg("channel")) return true;
+    long requested = server->arg("channel").toInt();
+    if (requested < 0 || requested >= waterSensor->channelCount()) {
+        char errorMsg[48];
+        snprintf(errorMsg, sizeof(errorMsg), "Invalid channel. Must be between 0 and %d",
+                 (int)waterSensor->channelCount() - 1);
+        JsonResponder::sendError(server, 400, errorMsg);
+        return false;
+    }
+    channel = (uint8_t)requested;
+    return true;
+}
 
 // Shared validation for the two water-level threshold handlers. On failure it
 // sends the 400 response itself (message text identical to the pre-consolidation
@@ -683,9 +1006,9 @@ void ConfigServer::saveCalibration() {
 bool ConfigServer::parseAndValidateLevel(float level_cm, bool isTier1) {
     // Validate the input against sensor usable range
     if (level_cm < MIN_EMERGENCY_WATER_LEVEL_CM || level_cm > MAX_EMERGENCY_WATER_LEVEL_CM) {
-        String errorMsg = "Invalid level. Must be between ";
-        errorMsg += String(MIN_EMERGENCY_WATER_LEVEL_CM, 1) + " and ";
-        errorMsg += String(MAX_EMERGENCY_WATER_LEVEL_CM, 1) + " cm";
+        char errorMsg[64];
+        snprintf(errorMsg, sizeof(errorMsg), "Invalid level. Must be between %.1f and %.1f cm",
+                 MIN_EMERGENCY_WATER_LEVEL_CM, MAX_EMERGENCY_WATER_LEVEL_CM);
         JsonResponder::sendError(server, 400, errorMsg);
         return false;
     }
@@ -694,16 +1017,18 @@ bool ConfigServer::parseAndValidateLevel(float level_cm, bool isTier1) {
     if (isTier1) {
         // Validate that Tier 1 threshold is less than Tier 2 threshold
         if (level_cm >= getUrgentEmergencyWaterLevel()) {
-            String errorMsg = "Tier 1 threshold must be less than Tier 2 threshold (";
-            errorMsg += String(getUrgentEmergencyWaterLevel(), 2) + " cm)";
+            char errorMsg[72];
+            snprintf(errorMsg, sizeof(errorMsg), "Tier 1 threshold must be less than Tier 2 threshold (%.2f cm)",
+                     getUrgentEmergencyWaterLevel());
             JsonResponder::sendError(server, 400, errorMsg);
             return false;
         }
     } else {
         // Validate that Tier 2 threshold is greater than Tier 1 threshold
         if (level_cm <= getEmergencyWaterLevel()) {
-            String errorMsg = "Tier 2 threshold must be greater than Tier 1 threshold (";
-            errorMsg += String(getEmergencyWaterLevel(), 2) + " cm)";
+            char errorMsg[72];
+            snprintf(errorMsg, sizeof(errorMsg), "Tier 2 threshold must be greater than Tier 1 threshold (%.2f cm)",
+                     getEmergencyWaterLevel());
             JsonResponder::sendError(server, 400, errorMsg);
             return false;
         }
@@ -724,9 +1049,9 @@ void ConfigServer::handleSetEmergencyLevel() {
             settingsStore->save(v);
         }
         
-        JsonResponder::success("Emergency water level (Tier 1) updated")
-            .num("level_cm", level_cm, 2)
-            .send(server);
+        JsonResponder(server).success("Emergency water level (Tier 1) updated")
+                             .num("level_cm", level_cm, 2)
+                             .send();
         LOG_INFO("[CONFIG] Emergency water level (Tier 1) updated: %.2f cm", level_cm);
     } else {
         JsonResponder::sendError(server, 400, "Missing level_cm parameter");
@@ -741,9 +1066,10 @@ void ConfigServer::handleSetEmergencyNotifFreq() {
         
         // Validate the input
         if (freq_ms < MIN_EMERGENCY_NOTIF_FREQ_MS || freq_ms > MAX_EMERGENCY_NOTIF_FREQ_MS) {
-            String errorMsg = "Invalid frequency. Must be between ";
-            errorMsg += String(MIN_EMERGENCY_NOTIF_FREQ_MS) + "ms (" + String(MIN_EMERGENCY_NOTIF_FREQ_MS / 1000) + "s) and ";
-            errorMsg += String(MAX_EMERGENCY_NOTIF_FREQ_MS) + "ms (" + String(MAX_EMERGENCY_NOTIF_FREQ_MS / 1000) + "s)";
+            char errorMsg[80];
+            snprintf(errorMsg, sizeof(errorMsg), "Invalid frequency. Must be between %dms (%ds) and %dms (%ds)",
+                     MIN_EMERGENCY_NOTIF_FREQ_MS, MIN_EMERGENCY_NOTIF_FREQ_MS / 1000,
+                     MAX_EMERGENCY_NOTIF_FREQ_MS, MAX_EMERGENCY_NOTIF_FREQ_MS / 1000);
             JsonResponder::sendError(server, 400, errorMsg);
             return;
         }
@@ -754,10 +1080,10 @@ void ConfigServer::handleSetEmergencyNotifFreq() {
             settingsStore->save(v);
         }
         
-        JsonResponder::success("Emergency notification frequency updated")
-            .num("freq_ms", freq_ms)
-            .num("freq_seconds", freq_ms / 1000)
-            .send(server);
+        JsonResponder(server).success("Emergency notification frequency updated")
+                             .num("freq_ms", freq_ms)
+                             .num("freq_seconds", freq_ms / 1000)
+                             .send();
         LOG_INFO("[CONFIG] Emergency notification frequency updated: %d ms (%d seconds)", freq_ms, freq_ms / 1000);
     } else {
         JsonResponder::sendError(server, 400, "Missing freq_ms parameter");
@@ -777,9 +1103,9 @@ void ConfigServer::handleSetUrgentEmergencyLevel() {
             settingsStore->save(v);
         }
         
-        JsonResponder::success("Urgent emergency water level (Tier 2) updated")
-            .num("level_cm", level_cm, 2)
-            .send(server);
+        JsonResponder(server).success("Urgent emergency water level (Tier 2) updated")
+                             .num("level_cm", level_cm, 2)
+                             .send();
         LOG_INFO("[CONFIG] Urgent emergency water level (Tier 2) updated: %.2f cm", level_cm);
     } else {
         JsonResponder::sendError(server, 400, "Missing level_cm parameter");
@@ -789,19 +1115,13 @@ void ConfigServer::handleSetUrgentEmergencyLevel() {
 void ConfigServer::handleTestEmergencyPin() {
     serverStartTime = millis();
     
-    LOG_INFO("[TEST] Testing emergency pin output...");
-    
-    // Set the pin HIGH for 2 seconds to test the connected device.
-    // ALERT_PIN comes from include/BoardPins.h (shared with main.cpp).
-    digitalWrite(ALERT_PIN, HIGH);
-    LOG_INFO("[TEST] Emergency pin set HIGH");
-    
-    delay(2000); // 2 second test pulse
-    
-    digitalWrite(ALERT_PIN, LOW);
-    LOG_INFO("[TEST] Emergency pin set LOW - test complete");
-    
-    JsonResponder::success("Emergency pin test completed (2 second pulse)").send(server);
+    // The loop drives ALERT_PIN (include/BoardPins.h) every tick, so it also
+    // holds the test pulse: isAlertPinTestActive() holds the pin solid.
+    uint32_t end = millis() + ALERT_PIN_TEST_MS;
+    pinTestEndMs = end ? end : 1;
+    LOG_INFO("[TEST] Emergency pin HIGH for %u ms", (unsigned)ALERT_PIN_TEST_MS);
+
+    JsonResponder(server).success("Emergency pin test started (2 second pulse)").send();
 }
 
 // loadEmergencySettings() and saveEmergencySettings() removed — emergency
@@ -815,7 +1135,7 @@ void ConfigServer::handleTestEmergencyPin() {
 void ConfigServer::handleGetNotifications() {
     serverStartTime = millis();
 
-    JsonResponder r(1024);
+    JsonResponder r(server);
 
     // SMS phone number
     if (smsService && smsService->hasPhoneNumber()) {
@@ -884,7 +1204,7 @@ void ConfigServer::handleGetNotifications() {
         r.boolean("mqttConnected", false);
     }
 
-    r.send(server);
+    r.send();
 }
 
 void ConfigServer::handleNotificationsStatus() {
@@ -898,12 +1218,12 @@ void ConfigServer::handleNotificationsStatus() {
     bool mqttCfg    = mqttService && mqttService->hasBrokerConfig();
     bool mqttConn   = mqttCfg && mqttService->isConnected();
 
-    JsonResponder().boolean("hasPhoneNumber", hasPhone)
-                   .boolean("hasDiscordWebhook", hasWebhook)
-                   .boolean("hasCustomChannel", hasCustom)
-                   .boolean("mqttConfigured", mqttCfg)
-                   .boolean("mqttConnected", mqttConn)
-                   .send(server);
+    JsonResponder(server).boolean("hasPhoneNumber", hasPhone)
+                         .boolean("hasDiscordWebhook", hasWebhook)
+                         .boolean("hasCustomChannel", hasCustom)
+                         .boolean("mqttConfigured", mqttCfg)
+                         .boolean("mqttConnected", mqttConn)
+                         .send();
 }
 
 void ConfigServer::handleSetPhoneNumber() {
@@ -918,7 +1238,7 @@ void ConfigServer::handleSetPhoneNumber() {
         String phone = server->arg("phone");
         smsService->updatePhoneNumber(phone.c_str());
         
-        JsonResponder::success("Phone number updated").str("phoneNumber", phone).send(server);
+        JsonResponder(server).success("Phone number updated").str("phoneNumber", phone).send();
         LOG_INFO("[CONFIG] Phone number updated: %s", phone.c_str());
     } else {
         JsonResponder::sendError(server, 400, "Missing phone parameter");
@@ -937,7 +1257,7 @@ void ConfigServer::handleSetDiscordWebhook() {
         String webhook = server->arg("webhook");
         discordService->updateWebhookUrl(webhook.c_str());
 
-        JsonResponder::success("Discord webhook updated").send(server);
+        JsonResponder(server).success("Discord webhook updated").send();
         LOG_INFO("[CONFIG] Discord webhook updated");
     } else {
         JsonResponder::sendError(server, 400, "Missing webhook parameter");
@@ -967,7 +1287,7 @@ void ConfigServer::handleSetTwilioCreds() {
         svcSid.isEmpty() ? nullptr : svcSid.c_str()
     );
 
-    JsonResponder::success("Twilio credentials updated").send(server);
+    JsonResponder(server).success("Twilio credentials updated").send();
     LOG_INFO("[CONFIG] Twilio credentials updated");
 }
 
@@ -1008,7 +1328,7 @@ void ConfigServer::handleSetCustomChannel() {
         tmpl.c_str()
     );
 
-    JsonResponder::success("Custom channel updated").send(server);
+    JsonResponder(server).success("Custom channel updated").send();
     LOG_INFO("[CONFIG] Custom HTTP channel updated: %s", endpoint.c_str());
 }
 
@@ -1030,18 +1350,7 @@ void ConfigServer::handleTestCustom() {
         return;
     }
 
-    LOG_INFO("[TEST] Sending test custom HTTP notification...");
-    bool success = customService->send("BilgeRise Test: This is a test message from your ESP32 boat monitor.");
-
-    if (success) {
-        LOG_INFO("[TEST] Test custom notification sent successfully!");
-        JsonResponder::success("Test custom notification sent!").send(server);
-    } else {
-        LOG_INFO("[TEST] Test custom notification failed");
-        JsonResponder().boolean("success", false)
-                       .str("error", "Failed to send test notification. Check serial log for details.")
-                       .send(server, 500);
-    }
+    dispatchTest(customService, "BilgeRise Test: This is a test message from your ESP32 boat monitor.");
 }
 
 void ConfigServer::handleTestSMS() {
@@ -1062,18 +1371,7 @@ void ConfigServer::handleTestSMS() {
         return;
     }
     
-    LOG_INFO("[TEST] Sending test SMS...");
-    bool success = smsService->send("BilgeRise Test: This is a test message from your ESP32 boat monitor.");
-    
-    if (success) {
-        LOG_INFO("[TEST] Test SMS sent successfully!");
-        JsonResponder::success("Test SMS sent successfully!").send(server);
-    } else {
-        LOG_INFO("[TEST] Test SMS failed to send");
-        JsonResponder().boolean("success", false)
-                       .str("error", "Failed to send test SMS. Check serial log for details.")
-                       .send(server, 500);
-    }
+    dispatchTest(smsService, "BilgeRise Test: This is a test message from your ESP32 boat monitor.");
 }
 
 void ConfigServer::handleTestDiscord() {
@@ -1094,17 +1392,49 @@ void ConfigServer::handleTestDiscord() {
         return;
     }
     
-    LOG_INFO("[TEST] Sending test Discord message...");
-    bool success = discordService->send("🚤 **BilgeRise Test** - This is a test message from your ESP32 boat monitor.");
-    
-    if (success) {
-        LOG_INFO("[TEST] Test Discord message sent successfully!");
-        JsonResponder::success("Test Discord message sent successfully!").send(server);
-    } else {
-        LOG_INFO("[TEST] Test Discord message failed to send");
-        JsonResponder().boolean("success", false)
-                       .str("error", "Failed to send test Discord message. Check serial log for details.")
-                       .send(server, 500);
+    dispatchTest(discordService, "🚤 **BilgeRise Test** - This is a test message from your ESP32 boat monitor.");
+}
+
+// The send runs on the NotificationWorker task; the page polls
+// /notifications/test/status?id= until it finishes.
+void ConfigServer::dispatchTest(NotificationChannel* channel, const char* message) {
+    if (!notifier) {
+        JsonResponder::sendError(server, 503, "Notification worker not available");
+        return;
+    }
+    uint32_t id = notifier->requestTest(channel, message);
+    if (id == 0) {
+        JsonResponder::sendError(server, 409, "Another test message is still being sent. Try again shortly.");
+        return;
+    }
+    LOG_INFO("[TEST] Test %s message queued (id %u)", channel->name(), (unsigned)id);
+    JsonResponder(server, 202).boolean("success", true)
+                              .boolean("pending", true)
+                              .num("id", id)
+                              .send();
+}
+
+void ConfigServer::handleTestStatus() {
+    serverStartTime = millis();
+
+    uint32_t id = server->hasArg("id") ? (uint32_t)server->arg("id").toInt() : 0;
+    NotificationWorker::TestStatus st = notifier ? notifier->getTestStatus(id) : NotificationWorker::TEST_NONE;
+    switch (st) {
+        case NotificationWorker::TEST_PENDING:
+            JsonResponder(server).boolean("success", true).boolean("pending", true).num("id", id).send();
+            break;
+        case NotificationWorker::TEST_OK:
+            JsonResponder(server).success("Test message sent!").boolean("pending", false).send();
+            break;
+        case NotificationWorker::TEST_FAILED:
+            JsonResponder(server).boolean("success", false)
+                                 .boolean("pending", false)
+                                 .str("error", "Failed to send test message. Check serial log for details.")
+                                 .send();
+            break;
+        default:
+            JsonResponder::sendError(server, 404, "Unknown test id");
+            break;
     }
 }
 
@@ -1154,7 +1484,7 @@ void ConfigServer::handleSetMqttConfig() {
 
     if (changed) {
         mqttService->reloadConfig();
-        JsonResponder::success("MQTT configuration updated").send(server);
+        JsonResponder(server).success("MQTT configuration updated").send();
     } else {
         JsonResponder::sendError(server, 400, "No valid parameters provided");
     }
@@ -1193,12 +1523,12 @@ void ConfigServer::handleTestMqtt() {
 
     if (success) {
         LOG_INFO("[TEST] Test MQTT message published successfully!");
-        JsonResponder::success("Test MQTT message published successfully!").send(server);
+        JsonResponder(server).success("Test MQTT message published successfully!").send();
     } else {
         LOG_INFO("[TEST] Test MQTT message failed to publish");
-        JsonResponder().boolean("success", false)
-                       .str("error", "Failed to publish test MQTT message.")
-                       .send(server, 500);
+        JsonResponder(server, 500).boolean("success", false)
+                                  .str("error", "Failed to publish test MQTT message.")
+                                  .send();
     }
 }
 
@@ -1213,31 +1543,199 @@ void ConfigServer::handleGetReading() {
     serverStartTime = millis();
 
     if (!waterSensor) {
-        JsonResponder().boolean("sensorAvailable", false)
-                       .str("error", "Water sensor not connected")
-                       .send(server, 503);
+        JsonResponder(server, 503).boolean("sensorAvailable", false)
+                                  .str("error", "Water sensor not connected")
+                                  .send();
         return;
     }
 
-    SensorReading reading = waterSensor->readLevel();
-    JsonResponder r;
+    uint8_t channel;
+    if (!parseChannelArg(channel)) return;
+
+    SensorReading reading = waterSensor->getLatestReading(channel);
+    JsonResponder r(server);
     r.boolean("sensorAvailable", true);
+    r.num("channel", channel);
     r.boolean("valid", reading.valid);
     r.num("millivolts", reading.millivolts, 2);
     if (reading.valid) {
         r.num("level_cm", reading.level_cm, 2);
     }
-    float rate = waterSensor->getRateOfChange_cm30min();
+    float rate = waterSensor->getRateOfChange_cm30min(channel);
     if (!isnan(rate)) {
         r.num("rate_cm_30min", rate, 2);
     }
+    float rateErr = waterSensor->getRateStdErr_cm30min(channel);
+    if (!isnan(rateErr)) {
+        r.num("rate_stderr_cm_30min", rateErr, 2);
+    }
 
-    r.send(server);
+    r.send();
+}
+
+// ============================================================================
+// LIVE EVENT STREAM
+//
+// GET /events[?interval_ms=N][&channel=C] answers with text/event-stream and
+// keeps the socket. pushEvents() then writes one "data: {json}" frame per
+// interval from the server task, and only when the sampler has produced a new
+// reading since the last frame. Replaces polling /read for the debug page.
+// ============================================================================
+
+void ConfigServer::handleEvents() {
+    serverStartTime = millis();
+
+    if (!waterSensor) {
+        JsonResponder::sendError(server, 503, "Sensor not available");
+        return;
+    }
+
+    uint8_t channel;
+    if (!parseChannelArg(channel)) return;
+
+    uint32_t intervalMs = SSE_DEFAULT_INTERVAL_MS;
+    if (server->hasArg("interval_ms")) {
+        long requested = server->arg("interval_ms").toInt();
+        if (requested < (long)SSE_MIN_INTERVAL_MS) requested = SSE_MIN_INTERVAL_MS;
+        if (requested > (long)SSE_MAX_INTERVAL_MS) requested = SSE_MAX_INTERVAL_MS;
+        intervalMs = (uint32_t)requested;
+    }
+
+    EventClient* slot = nullptr;
+    for (uint8_t i = 0; i < SSE_MAX_CLIENTS && !slot; i++) {
+        EventClient& c = eventClients[i];
+        if (c.active && !c.client.connected()) {
+            c.client.stop();
+            c.active = false;
+        }
+        if (!c.active) slot = &c;
+    }
+    if (!slot) {
+        JsonResponder::sendError(server, 503, "Too many live streams open");
+        return;
+    }
+
+    // Headers by hand: WebServer has no streaming response, and the socket
+    // outlives this handler in the slot's copy of the client
+    WiFiClient client = server->client();
+    client.print("HTTP/1.1 200 OK\r\n"
+                 "Content-Type: text/event-stream\r\n"
+                 "Cache-Control: no-cache\r\n"
+                 "Connection: keep-alive\r\n"
+                 "Access-Control-Allow-Origin: *\r\n"
+                 "\r\n"
+                 "retry: 2000\n\n");
+
+    uint32_t now = millis();
+    slot->client       = client;
+    slot->active       = true;
+    slot->channel      = channel;
+    slot->intervalMs   = intervalMs;
+    slot->nextMs       = now;
+    slot->lastSentMs   = now;
+    slot->lastSampleUs = 0;
+    LOG_INFO("[CONFIG] Live stream opened (channel %u, every %u ms)", channel, (unsigned)intervalMs);
+}
+
+// JsonWriter sink for one event frame. The frame is small and fixed-size, so
+// everything lands in one buffer and is written with a single write().
+struct EventFrame {
+    char   text[384];
+    size_t len;
+};
+
+static void eventFrameSink(void* ctx, const char* data, size_t len, bool) {
+    EventFrame* f = static_cast<EventFrame*>(ctx);
+    size_t room = sizeof(f->text) - f->len;
+    if (len > room) len = room;
+    memcpy(f->text + f->len, data, len);
+    f->len += len;
+}
+
+void ConfigServer::pushEvents() {
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < SSE_MAX_CLIENTS; i++) {
+        EventClient& c = eventClients[i];
+        if (!c.active) continue;
+        if (!c.client.connected()) {
+            c.client.stop();
+            c.active = false;
+            LOG_INFO("[CONFIG] Live stream closed");
+            continue;
+        }
+        if ((int32_t)(now - c.nextMs) < 0) continue;
+        c.nextMs = now + c.intervalMs;
+
+        SensorReading reading = waterSensor->getLatestReading(c.channel);
+        bool fresh = reading.tickUs != c.lastSampleUs;
+        if (!fresh) {
+            if (now - c.lastSentMs < SSE_KEEPALIVE_MS) continue;
+            if (c.client.write((const uint8_t*)": keepalive\n\n", 13) != 13) {
+                c.client.stop();
+                c.active = false;
+                continue;
+            }
+            c.lastSentMs = now;
+            continue;
+        }
+
+        EventFrame frame;
+        memcpy(frame.text, "data: ", 6);
+        frame.len = 6;
+        {
+            JsonWriter<128> w(eventFrameSink, &frame);
+            w.beginObject()
+             .boolean("sensorAvailable", true)
+             .num("channel", (int)c.channel)
+             .boolean("valid", reading.valid)
+             .num("millivolts", reading.millivolts, 2);
+            if (reading.valid) {
+                w.num("level_cm", reading.level_cm, 2);
+            }
+            float rate = waterSensor->getRateOfChange_cm30min(c.channel);
+            if (!isnan(rate)) {
+                w.num("rate_cm_30min", rate, 2);
+            }
+            w.num("sample_ms", (uint32_t)(reading.tickUs / 1000));
+            w.str("state", stateSource ? stateSource(stateSourceCtx) : nullptr);
+            if (notifier) {
+                w.beginObject("notifier")
+                 .num("pending", notifier->getPendingCount())
+                 .num("dropped", notifier->getDropCount())
+                 .end();
+            }
+            w.num("rssi", (int)WiFi.RSSI());
+            w.send();
+        }
+        if (frame.len + 2 > sizeof(frame.text)) continue;   // can't happen at these field counts
+        frame.text[frame.len++] = '\n';
+        frame.text[frame.len++] = '\n';
+
+        // A client that can't take a whole frame is dropped; the page's
+        // EventSource reconnects on its own
+        if (c.client.write((const uint8_t*)frame.text, frame.len) != frame.len) {
+            c.client.stop();
+            c.active = false;
+            LOG_INFO("[CONFIG] Live stream dropped (write failed)");
+            continue;
+        }
+        c.lastSampleUs = reading.tickUs;
+        c.lastSentMs   = now;
+        serverStartTime = now;   // an open stream counts as activity
+    }
+}
+
+void ConfigServer::closeEventClients() {
+    for (uint8_t i = 0; i < SSE_MAX_CLIENTS; i++) {
+        if (!eventClients[i].active) continue;
+        eventClients[i].client.stop();
+        eventClients[i].active = false;
+    }
 }
 
 void ConfigServer::handleDebug() {
     PROFILE_REQUEST("GET /debug");
-    sendCachedPage((const char*)DEBUG_HTML_GZ, DEBUG_HTML_GZ_LEN, "text/html");
+    sendCachedPage(DEBUG_HTML);
 }
 
 // ============================================================================
@@ -1245,7 +1743,7 @@ void ConfigServer::handleDebug() {
 // ============================================================================
 
 void ConfigServer::handleOTAPage() {
-    sendCachedPage((const char*)OTA_HTML_GZ, OTA_HTML_GZ_LEN, "text/html");
+    sendCachedPage(OTA_HTML);
 }
 
 void ConfigServer::handleOTAStatus() {
@@ -1271,21 +1769,28 @@ void ConfigServer::handleOTAStatus() {
     // Use float division so String(val, 1) selects the decimal-places overload
     // (String(unsigned long, 1) interprets 1 as a number base and returns "").
     float hoursSinceCheck = (float)otaManager->getTimeSinceLastCheckS() / 3600.0f;
-    
-    JsonResponder().str("currentVersion", otaManager->getCurrentVersion())
-                   .str("availableVersion", otaManager->getAvailableVersion())
-                   .boolean("updateAvailable", otaManager->isUpdateAvailable())
-                   .str("state", state)
-                   .str("lastError", otaManager->getLastError())
-                   .boolean("autoCheckEnabled", otaManager->isAutoCheckEnabled())
-                   .boolean("autoInstallEnabled", otaManager->isAutoInstallEnabled())
-                   .boolean("notificationsEnabled", otaManager->areNotificationsEnabled())
-                   .str("githubRepo", otaManager->getGitHubRepo())
-                   .boolean("hasGithubToken", otaManager->hasGitHubToken())
-                   .boolean("hasUpdatePassword", otaManager->hasUpdatePassword())
-                   .num("checkIntervalHours", (uint32_t)(otaManager->getCheckIntervalMs() / 3600000))
-                   .num("timeSinceLastCheckHours", hoursSinceCheck, 1)
-                   .send(server);
+
+    char availableVersion[OTA_VERSION_MAX];
+    char lastError[OTA_ERROR_MAX];
+    char githubRepo[OTA_OWNER_MAX + OTA_REPO_MAX];
+    otaManager->getAvailableVersion(availableVersion, sizeof(availableVersion));
+    otaManager->getLastError(lastError, sizeof(lastError));
+    otaManager->getGitHubRepo(githubRepo, sizeof(githubRepo));
+    
+    JsonResponder(server).str("currentVersion", otaManager->getCurrentVersion())
+                         .str("availableVersion", availableVersion)
+                         .boolean("updateAvailable", otaManager->isUpdateAvailable())
+                         .str("state", state)
+                         .str("lastError", lastError)
+                         .boolean("autoCheckEnabled", otaManager->isAutoCheckEnabled())
+                         .boolean("autoInstallEnabled", otaManager->isAutoInstallEnabled())
+                         .boolean("notificationsEnabled", otaManager->areNotificationsEnabled())
+                         .str("githubRepo", githubRepo)
+                         .boolean("hasGithubToken", otaManager->hasGitHubToken())
+                         .boolean("hasUpdatePassword", otaManager->hasUpdatePassword())
+                         .num("checkIntervalHours", (uint32_t)(otaManager->getCheckIntervalMs() / 3600000))
+                         .num("timeSinceLastCheckHours", hoursSinceCheck, 1)
+                         .send();
 }
 
 void ConfigServer::handleOTACheck() {
@@ -1296,16 +1801,11 @@ void ConfigServer::handleOTACheck() {
         return;
     }
     
-    bool updateFound = otaManager->manualCheckForUpdates();
-    
-    JsonResponder r;
-    r.boolean("success", true);
-    r.boolean("updateAvailable", updateFound);
-    if (updateFound) {
-        r.str("version", otaManager->getAvailableVersion());
-    }
-    
-    r.send(server);
+    // Queued for the OTA check task; the result shows up on /ota/status
+    otaManager->manualCheckForUpdates();
+    JsonResponder(server, 202).boolean("success", true)
+                              .boolean("pending", true)
+                              .send();
 }
 
 void ConfigServer::handleOTAUpdate() {
@@ -1325,12 +1825,14 @@ void ConfigServer::handleOTAUpdate() {
     bool success = otaManager->startUpdate(password);
     
     if (!success) {
-        JsonResponder().boolean("success", false)
-                       .str("error", otaManager->getLastError())
-                       .send(server, 400);
+        char lastError[OTA_ERROR_MAX];
+        otaManager->getLastError(lastError, sizeof(lastError));
+        JsonResponder(server, 400).boolean("success", false)
+                                  .str("error", lastError)
+                                  .send();
     } else {
         // This will likely not be received as ESP32 will reboot
-        JsonResponder::success("Update started, device will reboot").send(server);
+        JsonResponder(server).success("Update started, device will reboot").send();
     }
 }
 
@@ -1348,21 +1850,30 @@ void ConfigServer::handleOTASettings() {
     if (server->hasArg("github_owner") && server->hasArg("github_repo")) {
         String owner = server->arg("github_owner");
         String repo = server->arg("github_repo");
-        otaManager->setGitHubRepo(owner.c_str(), repo.c_str());
+        if (!otaManager->setGitHubRepo(owner.c_str(), repo.c_str())) {
+            JsonResponder::sendError(server, 400, "GitHub owner or repository name too long");
+            return;
+        }
         updated = true;
     }
     
     // GitHub token (for private repos)
     if (server->hasArg("github_token")) {
         String token = server->arg("github_token");
-        otaManager->setGitHubToken(token.c_str());
+        if (!otaManager->setGitHubToken(token.c_str())) {
+            JsonResponder::sendError(server, 400, "GitHub token too long");
+            return;
+        }
         updated = true;
     }
     
     // Update password
     if (server->hasArg("update_password")) {
         String password = server->arg("update_password");
-        otaManager->setUpdatePassword(password.c_str());
+        if (!otaManager->setUpdatePassword(password.c_str())) {
+            JsonResponder::sendError(server, 400, "Update password too long");
+            return;
+        }
         updated = true;
     }
     
@@ -1398,7 +1909,7 @@ void ConfigServer::handleOTASettings() {
     }
     
     if (updated) {
-        JsonResponder::success("OTA settings updated").send(server);
+        JsonResponder(server).success("OTA settings updated").send();
     } else {
         JsonResponder::sendError(server, 400, "No valid settings provided");
     }
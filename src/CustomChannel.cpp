@@ -2,13 +2,33 @@
 
 #include "CustomChannel.h"
 #include "NotifyChannelFlags.h"
-#include "TextEscape.h"
 #include "HttpPoster.h"
+#include "HostPool.h"
 #include "Logger.h"
+#include <WiFi.h>
 #include <string.h>
+#include <time.h>
 
-static constexpr const char* PLACEHOLDER    = "{{message}}";
-static constexpr size_t      PLACEHOLDER_LEN = 11; // strlen("{{message}}")
+namespace {
+
+// HttpBody view of a compiled template rendered against one send's context.
+class TemplateBody : public HttpBody {
+public:
+    TemplateBody(const BodyTemplate& t, const TemplateContext& ctx)
+        : t(t), ctx(ctx), reader(t, ctx), len(t.length(ctx)) {}
+
+    size_t length() const override { return len; }
+    size_t read(char* out, size_t n) override { return reader.read(out, n); }
+    void   rewind() override { reader.rewind(); }
+
+private:
+    const BodyTemplate&    t;
+    const TemplateContext& ctx;
+    BodyTemplate::Reader   reader;
+    size_t                 len;
+};
+
+} // namespace
 
 CustomChannel::CustomChannel() {
     endpointCache[0] = '\0';
@@ -17,6 +37,7 @@ CustomChannel::CustomChannel() {
     userCache[0]     = '\0';
     secretCache[0]   = '\0';
     tmplCache[0]     = '\0';
+    deviceId[0]      = '\0';
 }
 
 void CustomChannel::loadCache() {
@@ -26,6 +47,7 @@ void CustomChannel::loadCache() {
     userCache[0]     = '\0';
     secretCache[0]   = '\0';
     tmplCache[0]     = '\0';
+    compiled.compile(tmplCache, BodyTemplate::ESCAPE_RAW);
     if (!beginLoad()) return;
     loadStr("custom.endpoint", endpointCache, sizeof(endpointCache));
     loadStr("custom.ctype",    ctypeCache,    sizeof(ctypeCache));
@@ -34,6 +56,22 @@ void CustomChannel::loadCache() {
     loadStr("custom.secret",   secretCache,   sizeof(secretCache));
     loadStr("custom.tmpl",     tmplCache,     sizeof(tmplCache));
     finishLoad();
+
+    // Parse the template once here rather than on every send
+    compiled.compile(tmplCache, BodyTemplate::escapeFor(ctypeCache));
+    if (tmplCache[0] && !compiled.hasPlaceholder()) {
+        LOG_NETWORK("[Custom] Body template has no placeholders — using verbatim");
+    }
+
+    uint8_t mac[6];
+    WiFi.macAddress(mac);
+    snprintf(deviceId, sizeof(deviceId), "boat-%02x%02x%02x", mac[3], mac[4], mac[5]);
+}
+
+bool CustomChannel::endpointHost(char* host, size_t len) const {
+    uint16_t port;
+    bool secure;
+    return parseUrlHost(endpointCache, host, len, port, secure);
 }
 
 bool CustomChannel::isConfigured() const {
@@ -44,74 +82,22 @@ uint8_t CustomChannel::channelFlag() const {
     return CHAN_CUSTOM;
 }
 
-bool CustomChannel::substituteTemplate(const char* escapedMsg,
-                                       char* outBuf, size_t outSize) const {
-    // Find the placeholder in the template
-    const char* ph = strstr(tmplCache, PLACEHOLDER);
-    if (!ph) {
-        // No placeholder — use template verbatim.
-        // This is not an error; the user may have a static body.
-        LOG_NETWORK("[Custom] Body template has no {{message}} placeholder — using verbatim");
-        size_t tmplLen = strlen(tmplCache);
-        if (tmplLen >= outSize) {
-            LOG_CRITICAL("[Custom] Template too large for output buffer (%u >= %u)", tmplLen, outSize);
-            return false;
-        }
-        memcpy(outBuf, tmplCache, tmplLen + 1);
-        return true;
-    }
-
-    size_t preLen  = (size_t)(ph - tmplCache);
-    size_t msgLen  = strlen(escapedMsg);
-    size_t postLen = strlen(ph + PLACEHOLDER_LEN);
-    size_t total   = preLen + msgLen + postLen + 1;
-
-    if (total > outSize) {
-        LOG_CRITICAL("[Custom] Substituted body too large (%u > %u) — truncating not supported",
-                     total, outSize);
-        return false;
-    }
-
-    memcpy(outBuf,                  tmplCache,              preLen);
-    memcpy(outBuf + preLen,         escapedMsg,             msgLen);
-    memcpy(outBuf + preLen + msgLen, ph + PLACEHOLDER_LEN, postLen + 1);
-    return true;
-}
-
 bool CustomChannel::send(const char* message) {
     if (!message) return false;
     if (!cacheLoaded) loadCache();
     if (!isConfigured()) return false;
 
-    // Pick escaping strategy based on content-type
-    // message body is bounded to 160 chars (NotifMsg.body), so worst-case
-    // escaped is 3x that = 480 chars. Use a stack buffer to avoid heap churn.
-    char escaped[512];
-    const char* ct = ctypeCache;
-
-    if (strstr(ct, "json") || strstr(ct, "JSON")) {
-        TextEscape::jsonEscape(message, escaped, sizeof(escaped));
-    } else if (strstr(ct, "form") || strstr(ct, "urlencoded")) {
-        TextEscape::urlEncode(message, escaped, sizeof(escaped));
-    } else {
-        // Raw — copy with NUL-termination, no escaping
-        strncpy(escaped, message, sizeof(escaped) - 1);
-        escaped[sizeof(escaped) - 1] = '\0';
-    }
+    // Snapshot the placeholder values once so Content-Length and the
+    // streamed body agree.
+    TemplateContext ctx;
+    ctx.message  = message;
+    ctx.deviceId = deviceId;
+    if (contextProvider) contextProvider(ctx);
+    // Before SNTP the clock reads 1970; report "unknown" rather than that
+    time_t now = time(nullptr);
+    ctx.timestamp = now > 1600000000 ? (uint32_t)now : 0;
 
-    // Build body by substituting escaped message into the template.
-    // Template ≤ 512 chars, escaped ≤ 480 chars → body ≤ ~1000 chars; heap is safer.
-    size_t bodyBufSize = sizeof(tmplCache) + sizeof(escaped);
-    char* body = (char*)malloc(bodyBufSize);
-    if (!body) {
-        LOG_CRITICAL("[Custom] malloc failed building POST body");
-        return false;
-    }
-
-    if (!substituteTemplate(escaped, body, bodyBufSize)) {
-        free(body);
-        return false;
-    }
+    TemplateBody body(compiled, ctx);
 
     // Determine auth mode
     HttpAuthMode mode = HttpAuthMode::NONE;
@@ -127,10 +113,8 @@ bool CustomChannel::send(const char* message) {
         user = userCache[0] ? userCache : nullptr; // token stored in userCache
     }
 
-    bool ok = HttpPoster::post("[Custom]", endpointCache, ctypeCache, body,
-                               mode, user, secret);
-    free(body);
-    return ok;
+    return HttpPoster::post("[Custom]", endpointCache, ctypeCache, body,
+                            mode, user, secret);
 }
 
 void CustomChannel::updateConfig(const char* endpoint,
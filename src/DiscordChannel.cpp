@@ -4,6 +4,7 @@
 #include "NotifyChannelFlags.h"
 #include "TextEscape.h"
 #include "HttpPoster.h"
+#include "HostPool.h"
 #include "Logger.h"
 
 DiscordChannel::DiscordChannel() {
@@ -17,6 +18,12 @@ void DiscordChannel::loadCache() {
     finishLoad();
 }
 
+bool DiscordChannel::endpointHost(char* host, size_t len) const {
+    uint16_t port;
+    bool secure;
+    return parseUrlHost(webhookCache, host, len, port, secure);
+}
+
 bool DiscordChannel::isConfigured() const {
     return webhookCache[0] != '\0';
 }
@@ -31,9 +38,9 @@ bool DiscordChannel::send(const char* message) {
     if (!isConfigured()) return false;
 
     // jsonEscape can at most double the input size, and the input is bounded
-    // to 160 chars (NotifMsg.body) — so a fixed stack buffer covers the worst
-    // case without per-send heap churn or alloc-failure paths.
-    char escaped[160 * 2 + 1];
+    // to NOTIFY_BODY_MAX chars (a coalesced body) — so a fixed stack buffer
+    // covers the worst case without per-send heap churn or alloc-failure paths.
+    char escaped[NOTIFY_BODY_MAX * 2 + 1];
     TextEscape::jsonEscape(message, escaped, sizeof(escaped));
 
     // {"content":"%s"} wrapper around the escaped message.
@@ -0,0 +1,157 @@
+#ifndef UNIT_TESTING
+#include "HostResolver.h"
+#include "Logger.h"
+#include <WiFi.h>
+
+HostResolver& HostResolver::getInstance() {
+    static HostResolver instance;
+    return instance;
+}
+
+HostResolver::HostResolver()
+    : cacheMux(xSemaphoreCreateMutex())
+    , lookupMux(xSemaphoreCreateMutex())
+    , sources{}
+    , sourceCount(0)
+    , taskHandle(nullptr)
+{}
+
+void HostResolver::begin() {
+    if (taskHandle) return;
+    BaseType_t ok = xTaskCreatePinnedToCore(taskEntry, "dns", TASK_STACK,
+                                            this, TASK_PRIORITY, &taskHandle, TASK_CORE);
+    if (ok != pdPASS) {
+        // resolve() still caches what the senders look up themselves
+        LOG_CRITICAL("[DNS] Refresh task creation FAILED — hosts resolved on first use");
+        taskHandle = nullptr;
+        return;
+    }
+    // Prefetch as soon as the link has an address, before the first send
+    WiFi.onEvent([](WiFiEvent_t, WiFiEventInfo_t) { HostResolver::getInstance().kick(); },
+                 ARDUINO_EVENT_WIFI_STA_GOT_IP);
+}
+
+void HostResolver::addSource(HostSource fn, void* ctx) {
+    if (!fn) return;
+    xSemaphoreTake(cacheMux, portMAX_DELAY);
+    if (sourceCount < SOURCE_MAX) {
+        sources[sourceCount++] = { fn, ctx };
+    }
+    xSemaphoreGive(cacheMux);
+    kick();
+}
+
+void HostResolver::kick() {
+    if (taskHandle) xTaskNotifyGive(taskHandle);
+}
+
+
+// =============================================================================
+// Resolve
+// =============================================================================
+
+bool HostResolver::resolve(const char* host, IPAddress& out) {
+    if (!host || !host[0]) return false;
+    if (out.fromString(host)) return true;
+
+    uint32_t addr = 0;
+    xSemaphoreTake(cacheMux, portMAX_DELAY);
+    DnsCache::Result r = cache.lookup(host, millis(), addr);
+    xSemaphoreGive(cacheMux);
+    if (r == DnsCache::FRESH) {
+        out = IPAddress(addr);
+        return true;
+    }
+
+    uint32_t fresh = 0;
+    if (lookup(host, fresh)) {
+        xSemaphoreTake(cacheMux, portMAX_DELAY);
+        cache.store(host, fresh, millis(), TTL_MS);
+        xSemaphoreGive(cacheMux);
+        out = IPAddress(fresh);
+        return true;
+    }
+
+    if (r == DnsCache::STALE) {
+        LOG_NETWORK("[DNS] Lookup of %s failed, using cached %s", host,
+                    IPAddress(addr).toString().c_str());
+        out = IPAddress(addr);
+        return true;
+    }
+    return false;
+}
+
+bool HostResolver::lookup(const char* host, uint32_t& addr) {
+    if (!WiFi.isConnected()) return false;
+    IPAddress ip;
+    xSemaphoreTake(lookupMux, portMAX_DELAY);
+    int ok = WiFi.hostByName(host, ip);
+    xSemaphoreGive(lookupMux);
+    addr = (uint32_t)ip;
+    return ok == 1 && addr != 0;
+}
+
+
+// =============================================================================
+// Refresh task
+// =============================================================================
+
+void HostResolver::refresh() {
+    if (!WiFi.isConnected()) return;
+
+    Source snapshot[SOURCE_MAX];
+    xSemaphoreTake(cacheMux, portMAX_DELAY);
+    uint8_t n = sourceCount;
+    memcpy(snapshot, sources, sizeof(snapshot));
+    xSemaphoreGive(cacheMux);
+
+    // Collect the current host set first (sources may read NVS caches),
+    // then swap it in under the lock
+    char hosts[SOURCE_MAX * SOURCE_HOSTS][DnsCache::HOST_MAX];
+    uint8_t hostCount = 0;
+    for (uint8_t s = 0; s < n; s++) {
+        for (uint8_t k = 0; k < SOURCE_HOSTS; k++) {
+            char* h = hosts[hostCount];
+            if (!snapshot[s].fn(snapshot[s].ctx, k, h, DnsCache::HOST_MAX)) break;
+            IPAddress literal;
+            if (h[0] && !literal.fromString(h)) hostCount++;
+        }
+    }
+
+    xSemaphoreTake(cacheMux, portMAX_DELAY);
+    cache.unwatchAll();
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < hostCount; i++) cache.watch(hosts[i], now);
+    xSemaphoreGive(cacheMux);
+
+    for (;;) {
+        char host[DnsCache::HOST_MAX];
+        xSemaphoreTake(cacheMux, portMAX_DELAY);
+        int8_t i = cache.nextRefresh(millis());
+        if (i >= 0) strcpy(host, cache.entry(i).host);
+        xSemaphoreGive(cacheMux);
+        if (i < 0) break;
+
+        uint32_t addr = 0;
+        if (lookup(host, addr)) {
+            xSemaphoreTake(cacheMux, portMAX_DELAY);
+            cache.store(host, addr, millis(), TTL_MS);
+            xSemaphoreGive(cacheMux);
+            LOG_NETWORK("[DNS] %s -> %s", host, IPAddress(addr).toString().c_str());
+        } else {
+            LOG_NETWORK("[DNS] Lookup of %s failed, retry in %u s", host,
+                        (unsigned)(DnsCache::RETRY_MS / 1000));
+        }
+    }
+}
+
+void HostResolver::taskEntry(void* arg) {
+    HostResolver* self = static_cast<HostResolver*>(arg);
+    for (;;) {
+        // Woken on GOT_IP, by kick() or by the poll tick
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(POLL_MS));
+        self->refresh();
+    }
+}
+
+#endif // UNIT_TESTING
@@ -1,34 +1,106 @@
 #ifndef UNIT_TESTING
 
 #include "HttpPoster.h"
+#include "HostPool.h"
+#include "HostResolver.h"
 #include "Logger.h"
 #include <WiFi.h>
+#include <WiFiClientSecure.h>
 #include <HTTPClient.h>
 
-bool HttpPoster::post(const char* tag,
-                      const char* url,
-                      const char* contentType,
-                      const char* body,
-                      HttpAuthMode authMode,
-                      const char*  authUser,
-                      const char*  authSecret) {
-    if (!WiFi.isConnected()) {
-        LOG_NETWORK("%s WiFi not connected, cannot send", tag);
-        return false;
+namespace {
+
+// Below this free heap, closeIdle() closes every parked connection early:
+// enough for one TLS handshake on top of what the rest of the firmware uses.
+constexpr uint32_t POOL_MIN_FREE_HEAP = 60 * 1024;
+
+// One parked connection per pool slot. The HTTPClient must outlive the
+// request (its destructor stops the socket), so it lives here too.
+struct PooledConnection {
+    WiFiClientSecure tls;
+    WiFiClient       plain;
+    HTTPClient       http;
+};
+
+// Arduino Stream view of an HttpBody, for HTTPClient::sendRequest().
+class BodyStream : public Stream {
+public:
+    explicit BodyStream(HttpBody& body) : body(body), remaining(body.length()) {}
+
+    using Stream::readBytes;
+
+    int available() override { return (int)remaining; }
+    int read() override {
+        char c;
+        if (readBytes(&c, 1) != 1) return -1;
+        return (uint8_t)c;
     }
+    // Hides (or, where the core declares it virtual, overrides) the
+    // byte-at-a-time default so HTTPClient copies a TCP chunk per call.
+    size_t readBytes(char* buffer, size_t length) {
+        size_t n = body.read(buffer, length < remaining ? length : remaining);
+        remaining -= n;
+        return n;
+    }
+    int peek() override { return -1; }
+    size_t write(uint8_t) override { return 0; }
+    void flush() {}
 
-    LOG_NETWORK("%s HTTP POST — url: %s", tag, url);
+private:
+    HttpBody& body;
+    size_t    remaining;
+};
+
+PooledConnection connections[HostPool::SIZE];
+HostPool         pool;
+
+void closeSlot(uint8_t i) {
+    connections[i].tls.stop();
+    connections[i].plain.stop();
+    pool.markClosed(i);
+}
+
+// One request on slot i, with either a string body or a streamed one.
+// Returns the HTTP status or a negative HTTPC_ERROR_*.
+int sendOnce(uint8_t i, const char* tag, const char* url, const char* contentType,
+             const char* body, HttpBody* stream, HttpAuthMode authMode,
+             const char* authUser, const char* authSecret, uint32_t& elapsed) {
+    PooledConnection& c = connections[i];
+    bool secure = pool.slot(i).secure;
+    WiFiClient& transport = secure ? static_cast<WiFiClient&>(c.tls) : c.plain;
+
+    // Same trust model as HTTPClient::begin(url) without a CA, which the
+    // channels used before pooling.
+    if (secure) c.tls.setInsecure();
+
+    c.http.setReuse(true);
+    if (!c.http.begin(transport, url)) {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    c.http.setTimeout(10000);
 
-    HTTPClient http;
-    http.begin(url);
-    http.setTimeout(10000);
-    http.addHeader("Content-Type", contentType);
+    // Connect to the cached address (HostResolver.h) so the send doesn't
+    // wait on DNS; HTTPClient uses a transport that is already connected.
+    // TLS still gets the host name for SNI. If this fails, HTTPClient
+    // connects by name as before.
+    if (!transport.connected()) {
+        const HostPool::Slot& s = pool.slot(i);
+        IPAddress ip;
+        if (HostResolver::getInstance().resolve(s.host, ip)) {
+            if (secure) c.tls.connect(ip, s.port, s.host, nullptr, nullptr, nullptr);
+            else        c.plain.connect(ip, s.port);
+        }
+    }
+    c.http.addHeader("Content-Type", contentType);
 
-    // Apply auth — credentials are intentionally not logged
+    // Apply auth — credentials are intentionally not logged. The pooled
+    // HTTPClient keeps its Authorization between requests, so clear it
+    // when this request doesn't use Basic.
+    c.http.setAuthorization("");
     switch (authMode) {
         case HttpAuthMode::BASIC:
             if (authUser && authSecret) {
-                http.setAuthorization(authUser, authSecret);
+                c.http.setAuthorization(authUser, authSecret);
             }
             break;
         case HttpAuthMode::BEARER:
@@ -36,7 +108,7 @@ bool HttpPoster::post(const char* tag,
                 // authUser holds the token for BEARER
                 char hdr[320];
                 snprintf(hdr, sizeof(hdr), "Bearer %s", authUser);
-                http.addHeader("Authorization", hdr);
+                c.http.addHeader("Authorization", hdr);
             }
             break;
         case HttpAuthMode::NONE:
@@ -45,25 +117,136 @@ bool HttpPoster::post(const char* tag,
     }
 
     uint32_t startTime = millis();
-    int code = http.POST(body);
-    uint32_t elapsed = millis() - startTime;
+    int code;
+    if (stream) {
+        stream->rewind();
+        BodyStream s(*stream);
+        code = c.http.sendRequest("POST", &s, stream->length());
+    } else {
+        code = c.http.POST(body);
+    }
+    elapsed = millis() - startTime;
 
-    LOG_NETWORK("%s HTTP response %d (%u ms)", tag, code, elapsed);
+    if (code > 0) {
+        // Read the whole response even on success so no bytes are left on a
+        // connection that is about to be parked for the next request.
+        String response = c.http.getString();
+        if ((code < 200 || code >= 300) && response.length() > 0) {
+            LOG_NETWORK("%s Error response (first 200 chars): %.200s", tag, response.c_str());
+        }
+    }
 
-    if (code < 0) {
-        LOG_NETWORK("%s HTTP error: %s", tag, http.errorToString(code).c_str());
-    } else if (code < 200 || code >= 300) {
-        String snippet = http.getString();
-        if (snippet.length() > 0) {
-            LOG_NETWORK("%s Error response (first 200 chars): %.200s", tag, snippet.c_str());
+    // With reuse enabled end() keeps the socket open when the server agreed
+    // to keep-alive, and closes it otherwise.
+    c.http.end();
+    pool.markUsed(i, code > 0 && transport.connected(), millis());
+    return code;
+}
+
+} // namespace
+
+// Shared by both post() overloads; exactly one of body / stream is set.
+static bool postImpl(const char* tag, const char* url, const char* contentType,
+                     const char* body, HttpBody* stream, HttpAuthMode authMode,
+                     const char* authUser, const char* authSecret) {
+    if (!WiFi.isConnected()) {
+        LOG_NETWORK("%s WiFi not connected, cannot send", tag);
+        return false;
+    }
+
+    char host[HostPool::HOST_MAX];
+    uint16_t port;
+    bool secure;
+    if (!parseUrlHost(url, host, sizeof(host), port, secure)) {
+        LOG_NETWORK("%s Unsupported or malformed URL, cannot send", tag);
+        return false;
+    }
+
+    LOG_NETWORK("%s HTTP POST — url: %s", tag, url);
+
+    HttpPoster::closeIdle();
+
+    bool evict;
+    uint8_t i = pool.claim(host, port, secure, millis(), evict);
+    if (evict) {
+        LOG_NETWORK("%s Pool full — closing connection to %s", tag, host);
+        closeSlot(i);
+    }
+    bool reused = pool.slot(i).open;
+    if (secure && !reused) {
+        int8_t j;
+        while ((j = pool.tlsToClose(i, millis())) >= 0) {
+            LOG_NETWORK("%s Closing idle TLS connection to %s before handshake", tag,
+                        pool.slot((uint8_t)j).host);
+            closeSlot((uint8_t)j);
         }
     }
 
+    uint32_t elapsed = 0;
+    int code = sendOnce(i, tag, url, contentType, body, stream, authMode, authUser, authSecret, elapsed);
+    if (code < 0 && reused) {
+        // The server (or a NAT box) dropped the idle connection; a fresh
+        // handshake is cheaper than burning one of the notifier's retries.
+        LOG_NETWORK("%s Pooled connection to %s went stale (%s), reconnecting",
+                    tag, host, HTTPClient::errorToString(code).c_str());
+        closeSlot(i);
+        reused = false;
+        code = sendOnce(i, tag, url, contentType, body, stream, authMode, authUser, authSecret, elapsed);
+    }
+
+    LOG_NETWORK("%s HTTP response %d (%u ms, %s connection)", tag, code, elapsed,
+                reused ? "reused" : "new");
+
+    if (code < 0) {
+        LOG_NETWORK("%s HTTP error: %s", tag, HTTPClient::errorToString(code).c_str());
+        closeSlot(i);
+    }
+
     bool success = (code >= 200 && code < 300);
     LOG_NETWORK("%s Send %s (HTTP %d, %u ms)", tag, success ? "SUCCESS" : "FAILED", code, elapsed);
-
-    http.end();
     return success;
 }
 
+bool HttpPoster::post(const char* tag,
+                      const char* url,
+                      const char* contentType,
+                      const char* body,
+                      HttpAuthMode authMode,
+                      const char*  authUser,
+                      const char*  authSecret) {
+    return postImpl(tag, url, contentType, body, nullptr, authMode, authUser, authSecret);
+}
+
+bool HttpPoster::post(const char* tag,
+                      const char* url,
+                      const char* contentType,
+                      HttpBody&   body,
+                      HttpAuthMode authMode,
+                      const char*  authUser,
+                      const char*  authSecret) {
+    return postImpl(tag, url, contentType, nullptr, &body, authMode, authUser, authSecret);
+}
+
+uint32_t HttpPoster::closeIdle() {
+    if (pool.openCount() > 0 && ESP.getFreeHeap() < POOL_MIN_FREE_HEAP) {
+        LOG_NETWORK("[HTTP] Free heap %u B — closing pooled connections",
+                    (unsigned)ESP.getFreeHeap());
+        closeAll();
+        return UINT32_MAX;
+    }
+    uint32_t now = millis();
+    int8_t i;
+    while ((i = pool.nextExpired(now)) >= 0) {
+        LOG_NETWORK("[HTTP] Closing idle connection to %s", pool.slot((uint8_t)i).host);
+        closeSlot((uint8_t)i);
+    }
+    return pool.msUntilExpiry(now);
+}
+
+void HttpPoster::closeAll() {
+    for (uint8_t i = 0; i < HostPool::SIZE; i++) {
+        if (pool.slot(i).open) closeSlot(i);
+    }
+}
+
 #endif // UNIT_TESTING
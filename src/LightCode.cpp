@@ -4,13 +4,8 @@
 #include "Logger.h"
 
 
-LightCode::LightCode(int pin)
-    : ledPin(pin), pattern(PATTERN_OFF), lastToggleTime(0), ledState(false), doubleBinkPhase(0) {
-    
-    pinMode(ledPin, OUTPUT);
-    digitalWrite(ledPin, LOW);
-    lastToggleTime = millis();
-}
+LightCode::LightCode(int ledPin, rmt_channel_t channel)
+    : pattern(PATTERN_OFF), output(ledPin, channel) {}
 
 void LightCode::setPattern(BlinkPattern newPattern) {
     // Log pattern change for debugging
@@ -23,54 +18,28 @@ void LightCode::setPattern(BlinkPattern newPattern) {
     }
     
     this->pattern = newPattern;
-    lastToggleTime = millis();
-    ledState = false;
-    doubleBinkPhase = 0;
-    digitalWrite(ledPin, LOW);
-}
 
-void LightCode::update() {
-    // time since last toggle in ms
-    // switch statement for each pattern with different
-    unsigned long now = millis();
-    unsigned long msSinceToggle = now - lastToggleTime;
-    unsigned long interval = 0;
-
-    switch (pattern) {
+    // The same blink code again keeps running in phase rather than restarting
+    switch (newPattern) {
         case PATTERN_OFF:
-            digitalWrite(ledPin, LOW);
-            return;
+            output.off();
+            break;
         case PATTERN_SOLID:
-            digitalWrite(ledPin, HIGH);
-            return;
-        case PATTERN_FAST_BLINK:
-            interval = 100; // 100ms on, 100ms off
+            output.solid();
             break;
         case PATTERN_SLOW_BLINK:
-            interval = 500;
+            output.play(SLOW_BLINK_PHASES, sizeof(SLOW_BLINK_PHASES) / sizeof(SLOW_BLINK_PHASES[0]));
+            break;
+        case PATTERN_FAST_BLINK:
+            output.play(FAST_BLINK_PHASES, sizeof(FAST_BLINK_PHASES) / sizeof(FAST_BLINK_PHASES[0]));
             break;
         case PATTERN_DOUBLE_BLINK:
-            // Double blink pattern: ON-OFF-ON-OFF with pause
-            // Phase 0: ON (150ms), Phase 1: OFF (150ms), Phase 2: ON (150ms), Phase 3: OFF (800ms)
-            switch (doubleBinkPhase) {
-                case 0: interval = 150; ledState = true; break;  // First ON
-                case 1: interval = 150; ledState = false; break; // First OFF
-                case 2: interval = 150; ledState = true; break;  // Second ON
-                case 3: interval = 800; ledState = false; break; // Long OFF (pause)
-            }
-            
-            if (msSinceToggle >= interval) {
-                digitalWrite(ledPin, ledState ? HIGH : LOW);
-                lastToggleTime = now;
-                doubleBinkPhase = (doubleBinkPhase + 1) % 4; // Cycle through 0-3
-            }
-            return;
-    }
-    // Only toggle if interval has passed
-    if (msSinceToggle >= interval) {
-        ledState = !ledState;
-        lastToggleTime = now;
-        digitalWrite(ledPin, ledState ? HIGH : LOW);
+            output.play(DOUBLE_BLINK_PHASES, sizeof(DOUBLE_BLINK_PHASES) / sizeof(DOUBLE_BLINK_PHASES[0]));
+            break;
     }
 }
+
+void LightCode::update() {
+    output.update();
+}
 #endif // UNIT_TESTING
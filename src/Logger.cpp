@@ -0,0 +1,236 @@
+#ifndef UNIT_TESTING
+#include "Logger.h"
+#include "LogCodec.h"
+#include "LogRing.h"
+#include "MessageQueue.h"
+#include <esp_system.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Encoded record ceiling: a 60-char %s plus a handful of numbers fits; longer
+// arguments are cut and rendered with a trailing "..."
+static constexpr size_t LOG_RECORD_MAX = 160;
+// Rendered line, same as the old logMessage() buffer
+static constexpr size_t LOG_LINE_MAX   = 256;
+
+static constexpr uint32_t    SINK_STACK    = 4096;
+static constexpr UBaseType_t SINK_PRIORITY = 1;
+static constexpr BaseType_t  SINK_CORE     = 0;
+static constexpr uint32_t    SINK_POLL_MS  = 10;
+// Longest loggerFlush() wait for the sink to empty the queue and the Serial
+// ring (4 KB is ~360 ms at 115200 baud)
+static constexpr uint32_t    SHUTDOWN_FLUSH_MS = 400;
+// Rendered lines waiting for room in the UART driver's TX buffer
+static constexpr size_t      SERIAL_RING_BYTES = 4096;
+
+static MessageQueue<4096> logQueue;
+static portMUX_TYPE       logMux        = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t       sinkHandle    = nullptr;
+static uint32_t           logDropped    = 0;
+static uint32_t           logMaxLagMs   = 0;
+// Sink task only: rendered lines on their way to the UART
+static LogRing<SERIAL_RING_BYTES> serialRing;
+// loggerFlush() → sink: drain everything, blocking, then set flushDone
+static volatile bool      flushRequested = false;
+static volatile bool      flushDone      = false;
+
+volatile uint32_t         g_logMask     = LOG_DEFAULT_MASK;
+// millis() deadline for reverting g_logMask; 0 = none. Written by the
+// setter, checked and cleared by the sink task.
+static volatile uint32_t  maskRevertAt  = 0;
+
+// Serial gets the bare text, MQTT the level-prefixed copy. On the sink task
+// the Serial copy goes into serialRing; without a sink it is written in place.
+static void emit(uint8_t level, const char* text, bool buffered) {
+    if (buffered) serialRing.push(text, LOG_LINE_MAX - 1);
+    else          Serial.println(text);
+
+    char mqttBuf[LOG_LINE_MAX];
+    const char* prefix = logLevelPrefix(level);
+    size_t prefixLen = strlen(prefix);
+    size_t copyLen = strlen(text);
+    if (copyLen > sizeof(mqttBuf) - prefixLen - 1) copyLen = sizeof(mqttBuf) - prefixLen - 1;
+    memcpy(mqttBuf, prefix, prefixLen);
+    memcpy(mqttBuf + prefixLen, text, copyLen);
+    mqttBuf[prefixLen + copyLen] = '\0';
+    sendMqttLog(mqttBuf);
+}
+
+// Copy the oldest record out under the lock, then render and emit it
+// without holding it (Serial and the MQTT queue can take a while).
+static bool drainOne() {
+    uint8_t rec[LOG_RECORD_MAX];
+    size_t len;
+    uint8_t level;
+    portENTER_CRITICAL(&logMux);
+    MessageQueue<4096>::Message m;
+    bool any = logQueue.peek(m);
+    if (any) {
+        len = m.len < sizeof(rec) ? m.len : sizeof(rec);
+        memcpy(rec, m.payload, len);
+        level = m.kind;
+        logQueue.pop();
+    }
+    portEXIT_CRITICAL(&logMux);
+    if (!any) return false;
+
+    uint32_t lag = millis() - LogCodec::timestampOf(rec);
+    if (lag > logMaxLagMs) logMaxLagMs = lag;
+
+    char line[LOG_LINE_MAX];
+    LogCodec::render(line, sizeof(line), rec, len);
+    emit(level, line, /*buffered=*/sinkHandle != nullptr);
+    return true;
+}
+
+// Hand the UART driver whole lines, only as much as its TX buffer has room
+// for, so the sink never blocks in uart_write_bytes(). The driver's ISR
+// drains that buffer; when it can't keep up serialRing fills and drops its
+// oldest lines. With `block` (restart hook) everything is written.
+static void pumpSerial(bool block) {
+    for (;;) {
+        int avail = Serial.availableForWrite();
+        if (!block && avail < 2) return;
+        const char* data;
+        size_t len;
+        size_t room = block ? SERIAL_RING_BYTES : (size_t)avail - 1;
+        if (serialRing.peek(room, 32, data, len) == 0) return;
+        if (!block && len + 1 > (size_t)avail) {
+            serialRing.cancel();        // the oldest line alone doesn't fit yet
+            return;
+        }
+        Serial.write((const uint8_t*)data, len);
+        Serial.write('\n');
+        serialRing.commit();
+    }
+}
+
+static void checkMaskRevert() {
+    uint32_t at = maskRevertAt;
+    if (at == 0 || (int32_t)(millis() - at) < 0) return;
+    maskRevertAt = 0;
+    g_logMask = LOG_DEFAULT_MASK;
+    char text[64];
+    LogTags::formatMask(LOG_DEFAULT_MASK, text, sizeof(text));
+    LOG_CRITICAL("[LOG] Category mask back to default: %s", text);
+}
+
+static void sinkTask(void*) {
+    for (;;) {
+        checkMaskRevert();
+        while (drainOne()) pumpSerial(false);
+        pumpSerial(false);
+        if (flushRequested) {
+            // Records queued after the drain above are part of this flush
+            while (drainOne()) pumpSerial(true);
+            pumpSerial(true);
+            Serial.flush();
+            flushRequested = false;
+            flushDone = true;
+        }
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SINK_POLL_MS));
+    }
+}
+
+void loggerFlush() {
+    if (!sinkHandle) {
+        while (drainOne()) {}
+        return;
+    }
+    // The sink writes the Serial ring out, so this doesn't race its pump
+    flushDone = false;
+    flushRequested = true;
+    xTaskNotifyGive(sinkHandle);
+    uint32_t start = millis();
+    while (!flushDone && millis() - start < SHUTDOWN_FLUSH_MS) {
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+}
+
+static void onShutdown() {
+    // esp_restart() context: give the sink a moment to print what's queued
+    // (the reason for the restart is usually the last line)
+    loggerFlush();
+}
+
+void loggerBegin() {
+    if (sinkHandle) return;
+    BaseType_t ok = xTaskCreatePinnedToCore(sinkTask, "log", SINK_STACK, nullptr,
+                                            SINK_PRIORITY, &sinkHandle, SINK_CORE);
+    if (ok != pdPASS) {
+        sinkHandle = nullptr;
+        LOG_CRITICAL("[LOG] Sink task creation FAILED — logging in place");
+        return;
+    }
+    esp_register_shutdown_handler(&onShutdown);
+}
+
+void logMessage(uint8_t level, const char* fmt, ...) {
+    uint8_t rec[LOG_RECORD_MAX];
+    va_list args;
+    va_start(args, fmt);
+    size_t len = LogCodec::encode(rec, sizeof(rec), millis(), fmt, args);
+    va_end(args);
+    if (len == 0) return;
+
+    if (!sinkHandle) {
+        // Before loggerBegin() (or without a sink): format on this task
+        char line[LOG_LINE_MAX];
+        LogCodec::render(line, sizeof(line), rec, len);
+        emit(level, line, /*buffered=*/false);
+        return;
+    }
+
+    // A full queue drops the newest line — the sink is behind, and blocking
+    // the caller is what this logger exists to avoid
+    portENTER_CRITICAL(&logMux);
+    if (!logQueue.push(level, false, nullptr, rec, len)) logDropped++;
+    portEXIT_CRITICAL(&logMux);
+    // No notify: the sink's 10 ms poll picks it up, and the caller doesn't
+    // pay for a cross-core wake per line
+}
+
+void logSetMask(uint32_t mask, uint32_t forSec) {
+    mask &= LogTags::ALL;
+    if (forSec) {
+        uint32_t at = millis() + forSec * 1000u;
+        maskRevertAt = at ? at : 1;
+    } else {
+        maskRevertAt = 0;
+    }
+    g_logMask = mask;
+    char text[64];
+    LogTags::formatMask(mask, text, sizeof(text));
+    if (forSec) LOG_CRITICAL("[LOG] Category mask: %s for %u s", text, forSec);
+    else        LOG_CRITICAL("[LOG] Category mask: %s", text);
+}
+
+bool logApplyMaskText(const char* text, size_t len) {
+    uint32_t mask, forSec;
+    if (!LogTags::parseMask(text, len, g_logMask, LOG_DEFAULT_MASK, mask, forSec)) return false;
+    logSetMask(mask, forSec);
+    return true;
+}
+
+uint32_t logMaskRemainingSec() {
+    uint32_t at = maskRevertAt;
+    if (at == 0) return 0;
+    int32_t left = (int32_t)(at - millis());
+    return left > 0 ? ((uint32_t)left + 999) / 1000 : 0;
+}
+
+LoggerStats loggerStats() {
+    LoggerStats s;
+    portENTER_CRITICAL(&logMux);
+    s.dropped        = logDropped;
+    s.queueHighWater = logQueue.highWaterBytes();
+    portEXIT_CRITICAL(&logMux);
+    s.maxLagMs       = logMaxLagMs;
+    s.stackHighWater = sinkHandle ? uxTaskGetStackHighWaterMark(sinkHandle) : 0;
+    // Sink-owned counters; a stale read only skews one status line
+    s.serialDropped   = serialRing.dropped();
+    s.serialHighWater = serialRing.highWaterBytes();
+    return s;
+}
+
+#endif // UNIT_TESTING
@@ -0,0 +1,125 @@
+#ifndef UNIT_TESTING
+
+#include "LowPower.h"
+#include "StateMachine.h"
+#include "BoardPins.h"
+#include "NvsStore.h"
+#include "Logger.h"
+#include <Arduino.h>
+#include <esp_sleep.h>
+#include <esp_attr.h>
+#include <driver/gpio.h>
+#include <driver/rtc_io.h>
+#include "esp32/rom/crc.h"
+
+// StateMachineContext fields that must survive a deep sleep. Everything else
+// is either derived from the next readings or a millis() timestamp, which
+// restarts with the boot anyway.
+struct SleepCheckpoint {
+    uint32_t magic;
+    uint32_t sleepCount;
+    float    lastValidLevel_cm;
+    bool     hasValidLevel;
+    bool     notificationsSilenced;
+    bool     sensorErrorNotified;
+    uint32_t crc;
+};
+
+static constexpr uint32_t SLEEP_CHECKPOINT_MAGIC = 0x534c5050; // "SLPP"
+RTC_NOINIT_ATTR static SleepCheckpoint rtcCheckpoint;
+
+static uint32_t checkpointCrc(const SleepCheckpoint& c) {
+    return crc32_le(0, (const uint8_t*)&c, offsetof(SleepCheckpoint, crc));
+}
+
+// A power-on boot leaves RTC_NOINIT memory random; only trust it after a
+// sleep wake.
+static bool checkpointValid() {
+    return LowPower::wakeReason() != LowPowerPolicy::WAKE_POWER_ON &&
+           rtcCheckpoint.magic == SLEEP_CHECKPOINT_MAGIC &&
+           rtcCheckpoint.crc == checkpointCrc(rtcCheckpoint);
+}
+
+LowPowerPolicy::Wake LowPower::wakeReason() {
+    switch (esp_sleep_get_wakeup_cause()) {
+        case ESP_SLEEP_WAKEUP_EXT0:  return LowPowerPolicy::WAKE_LEVEL;
+        case ESP_SLEEP_WAKEUP_EXT1:  return LowPowerPolicy::WAKE_BUTTON;
+        case ESP_SLEEP_WAKEUP_TIMER: return LowPowerPolicy::WAKE_HEARTBEAT;
+        default:                     return LowPowerPolicy::WAKE_POWER_ON;
+    }
+}
+
+void LowPower::releasePins() {
+    gpio_hold_dis((gpio_num_t)ALERT_PIN);
+    gpio_hold_dis((gpio_num_t)LIGHT_PIN);
+    gpio_deep_sleep_hold_dis();
+    // ext0/ext1 left these on the RTC mux
+    rtc_gpio_deinit((gpio_num_t)ADS_ALERT_PIN);
+    rtc_gpio_deinit((gpio_num_t)BUTTON_PIN);
+}
+
+bool LowPower::restore(StateMachineContext& ctx) {
+    if (!checkpointValid()) return false;
+    ctx.lastValidLevel_cm = rtcCheckpoint.lastValidLevel_cm;
+    ctx.hasValidLevel = rtcCheckpoint.hasValidLevel;
+    ctx.notificationsSilenced = rtcCheckpoint.notificationsSilenced;
+    ctx.sensorErrorNotified = rtcCheckpoint.sensorErrorNotified;
+    return true;
+}
+
+uint32_t LowPower::sleepCount() {
+    return checkpointValid() ? rtcCheckpoint.sleepCount : 0;
+}
+
+void LowPower::sleep(const StateMachineContext& ctx, bool levelWakeArmed, uint32_t heartbeatS) {
+    SleepCheckpoint c = {};
+    c.magic = SLEEP_CHECKPOINT_MAGIC;
+    c.sleepCount = sleepCount() + 1;
+    c.lastValidLevel_cm = ctx.lastValidLevel_cm;
+    c.hasValidLevel = ctx.hasValidLevel;
+    c.notificationsSilenced = ctx.notificationsSilenced;
+    c.sensorErrorNotified = ctx.sensorErrorNotified;
+    c.crc = checkpointCrc(c);
+    rtcCheckpoint = c;
+
+    LOG_INFO("LowPower: sleeping %lu s (level wake %s, sleep #%lu)",
+             (unsigned long)heartbeatS, levelWakeArmed ? "armed" : "OFF",
+             (unsigned long)c.sleepCount);
+
+    // Shutdown handlers don't run on deep sleep; pending NVS writes would
+    // be lost with RAM.
+    NvsStore::getInstance().flush();
+
+    // pinMode() takes the pins back from their RMT channels (PulseOutput.h),
+    // which may be mid-pattern
+    digitalWrite(ALERT_PIN, LOW);
+    digitalWrite(LIGHT_PIN, LOW);
+    pinMode(ALERT_PIN, OUTPUT);
+    pinMode(LIGHT_PIN, OUTPUT);
+    gpio_hold_en((gpio_num_t)ALERT_PIN);
+    gpio_hold_en((gpio_num_t)LIGHT_PIN);
+    gpio_deep_sleep_hold_en();
+
+    // The RTC pull-ups (and the checkpoint) need these domains powered.
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_ON);
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_SLOW_MEM, ESP_PD_OPTION_ON);
+
+    if (levelWakeArmed) {
+        // ALERT is open-drain; the comparator latches it low
+        rtc_gpio_pullup_en((gpio_num_t)ADS_ALERT_PIN);
+        rtc_gpio_pulldown_dis((gpio_num_t)ADS_ALERT_PIN);
+        esp_sleep_enable_ext0_wakeup((gpio_num_t)ADS_ALERT_PIN, 0);
+    }
+    rtc_gpio_pullup_en((gpio_num_t)BUTTON_PIN);
+    rtc_gpio_pulldown_dis((gpio_num_t)BUTTON_PIN);
+    esp_sleep_enable_ext1_wakeup(1ULL << BUTTON_PIN, ESP_EXT1_WAKEUP_ALL_LOW);
+    esp_sleep_enable_timer_wakeup((uint64_t)heartbeatS * 1000000ULL);
+
+    // Nor does the log restart hook: the lines above are still queued for
+    // the log sink
+    loggerFlush();
+    Serial.flush();
+    esp_deep_sleep_start();
+}
+
+#endif // UNIT_TESTING
@@ -2,6 +2,8 @@
 
 #include "MQTTService.h"
 #include "MqttRootCA.h"
+#include "NvsStore.h"
+#include "HostResolver.h"
 #include <WiFi.h>
 
 static constexpr const char* MQTT_PREFS_NAMESPACE = "mqtt";
@@ -10,10 +12,24 @@ static constexpr uint16_t    DEFAULT_MQTT_PORT     = 8883;
 static constexpr bool        DEFAULT_MQTT_TLS      = true;  // domain default is a WAN TLS broker (Let's Encrypt CA)
 static constexpr uint32_t    RECONNECT_INITIAL_MS  = 5000;
 static constexpr uint32_t    RECONNECT_MAX_MS      = 30000;
-static constexpr uint32_t    DRAIN_BUDGET_MS        = 50;   // max time to spend publishing per loop()
-// Must stay strictly below WDT_TIMEOUT_S (10s, defined in main.cpp). A TLS
-// WiFiClientSecure defaults to a 30s TCP-connect timeout; exceeding the WDT
-// on the loop task when the broker is unreachable is the guaranteed result.
+static constexpr uint32_t    DRAIN_BUDGET_MS        = 50;   // max time to spend publishing per pass
+static constexpr uint8_t     OUTBOX_PER_PASS        = 8;    // queued publishes sent per task pass
+static constexpr uint8_t     INBOX_PER_LOOP         = 8;    // received messages dispatched per loop()
+static constexpr uint32_t    TASK_PERIOD_MS         = 10;   // network task poll interval
+// Pack queued log lines into one newline-delimited publish (fewer MQTT
+// packets and TLS records per line). Build with -D MQTT_LOG_BATCH=0 for one
+// publish per line.
+#ifndef MQTT_LOG_BATCH
+#define MQTT_LOG_BATCH 1
+#endif
+// PubSubClient rejects a publish whose header + topic + payload exceeds its
+// buffer (MQTT_MAX_PACKET_SIZE): 5-byte fixed header, 2-byte topic length.
+static constexpr size_t      MQTT_PUBLISH_OVERHEAD  = 5 + 2;
+// A TLS WiFiClientSecure defaults to a 30s TCP-connect timeout. The connect
+// runs on the network task now, but it must still stay strictly below
+// WDT_TIMEOUT_S (10s, defined in main.cpp): without a task (startTask()
+// failed) loop() connects inline on the watchdog-fed loop task, and a long
+// block would also hold up queued publishes and resubscribes.
 static constexpr uint32_t    MQTT_CONNECT_TIMEOUT_S = 3;
 
 MQTTService* MQTTService::s_instance = nullptr;
@@ -27,17 +43,23 @@ MQTTService::MQTTService()
     : client(wifiClient)
     , brokerPort(DEFAULT_MQTT_PORT)
     , useTls(DEFAULT_MQTT_TLS)
+    , configMux(portMUX_INITIALIZER_UNLOCKED)
     , m_initialized(false)
     , cachedBrokerConfigExists(false)
     , recheckBrokerConfig(true)
+    , reloadRequested(false)
+    , online(false)
     , lastReconnectAttempt(0)
     , reconnectBackoffMs(RECONNECT_INITIAL_MS)
-    , logQueueHead(0)
-    , logQueueTail(0)
-    , logQueueCount(0)
-    , logsDropped(0)
+    , connectCount(0)
+    , logsSent(0)
+    , logPublishes(0)
     , logQueueMux(portMUX_INITIALIZER_UNLOCKED)
-    , inMqttCall(false)
+    , subscriptionCount(0)
+    , outboxMux(portMUX_INITIALIZER_UNLOCKED)
+    , inboxMux(portMUX_INITIALIZER_UNLOCKED)
+    , subscribedCount(0)
+    , taskHandle(nullptr)
 {
     brokerHost[0]         = '\0';
     username[0]           = '\0';
@@ -47,6 +69,8 @@ MQTTService::MQTTService()
     logTopic[0]           = '\0';
     availabilityTopic[0]  = '\0';
     telemetryTopic[0]     = '\0';
+    telemetryPackedTopic[0] = '\0';
+    infoTopic[0]          = '\0';
 }
 
 
@@ -67,45 +91,97 @@ void MQTTService::begin() {
     m_initialized = true;
     cachedBrokerConfigExists = hasBrokerConfig();
     recheckBrokerConfig = false;
+    HostResolver::getInstance().addSource(&MQTTService::brokerHostSource, this);
+}
+
+bool MQTTService::brokerHostSource(void* ctx, uint8_t index, char* host, size_t len) {
+    if (index > 0) return false;
+    if (static_cast<MQTTService*>(ctx)->getBroker(host, len, nullptr) != 0) host[0] = '\0';
+    return true;
+}
+
+bool MQTTService::startTask() {
+    if (!m_initialized || taskHandle) return taskHandle != nullptr;
+    BaseType_t ok = xTaskCreatePinnedToCore(taskEntry, "mqtt", TASK_STACK,
+                                            this, TASK_PRIORITY, &taskHandle, TASK_CORE);
+    if (ok != pdPASS) {
+        taskHandle = nullptr;
+        return false;
+    }
+    return true;
+}
+
+uint32_t MQTTService::getStackHighWaterMark() const {
+    if (!taskHandle) return 0;
+    return (uint32_t)uxTaskGetStackHighWaterMark(taskHandle);
+}
+
+void MQTTService::taskEntry(void* arg) {
+    MQTTService* self = static_cast<MQTTService*>(arg);
+    for (;;) {
+        self->networkLoop();
+        vTaskDelay(pdMS_TO_TICKS(TASK_PERIOD_MS));
+    }
 }
 
 void MQTTService::loop() {
     if (!m_initialized) return;
-    if (!WiFi.isConnected()) return;
-    
+    if (!taskHandle) networkLoop();
+    dispatchInbox();
+}
+
+void MQTTService::networkLoop() {
+    if (reloadRequested) {
+        reloadRequested = false;
+        applyReload();
+    }
+    if (!WiFi.isConnected()) {
+        online = false;
+        return;
+    }
+
     // Recheck broker config if flag is set (after begin() or config update)
     if (recheckBrokerConfig) {
-        cachedBrokerConfigExists = hasBrokerConfig();
         recheckBrokerConfig = false;
+        cachedBrokerConfigExists = hasBrokerConfig();
+    }
+
+    if (!cachedBrokerConfigExists) {
+        online = false;
+        return;
     }
-    
-    if (!cachedBrokerConfigExists) return;
 
     if (!client.connected()) {
+        online = false;
         uint32_t now = millis();
         if (now - lastReconnectAttempt >= reconnectBackoffMs) {
             tryReconnect();
         }
     } else {
         client.loop();
+        subscribePending();
+        drainOutbox();
         drainLogQueue();
     }
+    online = client.connected();
 }
 
-bool MQTTService::isConnected() {
-    return m_initialized && client.connected();
+void MQTTService::reloadConfig() {
+    reloadRequested = true;
 }
 
-void MQTTService::reloadConfig() {
+void MQTTService::applyReload() {
     if (client.connected()) {
         client.disconnect();
     }
+    online = false;
     readNvs();
     applyServerConfig();
+    HostResolver::getInstance().kick();
     // Reset backoff so reconnect happens quickly after a config change
     lastReconnectAttempt = 0;
     reconnectBackoffMs   = RECONNECT_INITIAL_MS;
-    // Mark for recheck on next loop
+    // Mark for recheck on next pass
     recheckBrokerConfig = true;
 }
 
@@ -115,36 +191,51 @@ void MQTTService::reloadConfig() {
 // =============================================================================
 
 bool MQTTService::publish(const char* topic, const char* payload, bool retained) {
-    if (!m_initialized || inMqttCall) return false;
-    if (!client.connected()) return false;
-    inMqttCall = true;
-    bool ok = client.publish(topic, payload, retained);
-    inMqttCall = false;
+    if (!topic || !*topic || !payload) return false;
+    return enqueue(TOPIC_EXPLICIT, topic, (const uint8_t*)payload, strlen(payload), retained);
+}
+
+bool MQTTService::publish(const char* topic, const uint8_t* payload, size_t len, bool retained) {
+    if (!topic || !*topic || !payload) return false;
+    return enqueue(TOPIC_EXPLICIT, topic, payload, len, retained);
+}
+
+bool MQTTService::enqueue(uint8_t kind, const char* topic, const uint8_t* payload,
+                          size_t len, bool retained) {
+    // Refuse while offline rather than queue: callers (telemetry, backfill)
+    // treat false as "not sent" and keep the reading for later
+    if (!isConnected()) return false;
+    portENTER_CRITICAL(&outboxMux);
+    bool ok = outbox.push(kind, retained, topic, payload, len);
+    portEXIT_CRITICAL(&outboxMux);
     return ok;
 }
 
 bool MQTTService::publishLog(const char* message) {
     if (!m_initialized || !message) return false;
 
+    // Oldest lines are evicted when the ring is full (counted as dropped)
     portENTER_CRITICAL(&logQueueMux);
-    if (logQueueCount >= LOG_QUEUE_SIZE) {
-        logQueueTail = (logQueueTail + 1) % LOG_QUEUE_SIZE;
-        logQueueCount--;
-        logsDropped++;
-    }
-    strncpy(logQueue[logQueueHead], message, LOG_MSG_MAX - 1);
-    logQueue[logQueueHead][LOG_MSG_MAX - 1] = '\0';
-    logQueueHead = (logQueueHead + 1) % LOG_QUEUE_SIZE;
-    logQueueCount++;
+    logRing.push(message, LOG_MSG_MAX - 1);
     portEXIT_CRITICAL(&logQueueMux);
     return true;
 }
 
 bool MQTTService::publishTelemetry(const char* json, bool retained) {
     if (!json) return false;
-    // Synchronous publish (telemetry is low-rate, ~1/min) — unlike logs it does
-    // not use the ring buffer. publish() guards against disconnect/reentrancy.
-    return publish(telemetryTopic, json, retained);
+    // Queued whole (telemetry is low-rate, ~1/min) — unlike logs a full
+    // outbox refuses it instead of evicting older messages
+    return enqueue(TOPIC_TELEMETRY, nullptr, (const uint8_t*)json, strlen(json), retained);
+}
+
+bool MQTTService::publishTelemetryPacked(const uint8_t* data, size_t len, bool retained) {
+    if (!data || len == 0) return false;
+    return enqueue(TOPIC_TELEMETRY_PACKED, nullptr, data, len, retained);
+}
+
+bool MQTTService::publishDeviceInfo(const char* json) {
+    if (!json) return false;
+    return enqueue(TOPIC_INFO, nullptr, (const uint8_t*)json, strlen(json), true);
 }
 
 
@@ -152,12 +243,20 @@ bool MQTTService::publishTelemetry(const char* json, bool retained) {
 // Subscribe
 // =============================================================================
 
-bool MQTTService::subscribe(const char* topic, MessageCallback cb) {
-    if (!topic || !cb) return false;
-    subscriptions.push_back({String(topic), cb});
-    if (client.connected()) {
-        client.subscribe(topic);
-    }
+bool MQTTService::subscribe(const char* filter, MessageHandler handler, void* ctx) {
+    if (!filter || !handler || subscriptionCount >= MAX_SUBSCRIPTIONS) return false;
+    if (strlen(filter) >= FILTER_MAX) return false;
+    if (!topicTrie.insert(filter, subscriptionCount)) return false;
+
+    Subscription& sub = subscriptions[subscriptionCount];
+    strcpy(sub.filter, filter);
+    sub.handler = handler;
+    sub.ctx = ctx;
+    // Publish the entry only once it is complete: the network task
+    // subscribes everything below subscriptionCount on its next pass
+    portENTER_CRITICAL(&configMux);
+    subscriptionCount++;
+    portEXIT_CRITICAL(&configMux);
     return true;
 }
 
@@ -168,12 +267,9 @@ bool MQTTService::subscribe(const char* topic, MessageCallback cb) {
 
 void MQTTService::updateBroker(const char* host, uint16_t port) {
     if (!host) return;
-    if (!preferences.begin(MQTT_PREFS_NAMESPACE, false)) {
-        return;
-    }
-    preferences.putString("host", host);
-    preferences.putUShort("port", port);
-    preferences.end();
+    NvsStore& nvs = NvsStore::getInstance();
+    nvs.putString(MQTT_PREFS_NAMESPACE, "host", host);
+    nvs.putUShort(MQTT_PREFS_NAMESPACE, "port", port);
     // Mark for recheck on next loop
     recheckBrokerConfig = true;
 }
@@ -181,62 +277,69 @@ void MQTTService::updateBroker(const char* host, uint16_t port) {
 int MQTTService::getBroker(char* hostBuf, size_t hostSize, uint16_t* portOut) {
     if (!hostBuf || hostSize == 0) return -1;
     // Return the NVS-backed cached config (defaults applied in readNvs)
-    size_t hostLen = strlen(brokerHost);
-    if (hostLen + 1 > hostSize) return -1;
-    strcpy(hostBuf, brokerHost);
-    if (portOut) *portOut = brokerPort;
-    return 0;
+    int rc = -1;
+    portENTER_CRITICAL(&configMux);
+    if (strlen(brokerHost) + 1 <= hostSize) {
+        strcpy(hostBuf, brokerHost);
+        if (portOut) *portOut = brokerPort;
+        rc = 0;
+    }
+    portEXIT_CRITICAL(&configMux);
+    return rc;
 }
 
 void MQTTService::updateCredentials(const char* user, const char* pass) {
-    if (!preferences.begin(MQTT_PREFS_NAMESPACE, false)) return;
-    preferences.putString("user", user ? user : "");
+    NvsStore& nvs = NvsStore::getInstance();
+    nvs.putString(MQTT_PREFS_NAMESPACE, "user", user ? user : "");
     // Only overwrite the password when a non-empty value is supplied. An empty
     // or null pass means "keep the stored password unchanged" — the config UI
     // never re-populates the password field after load, so an unrelated save
     // (e.g. editing only the broker host) would otherwise wipe the credential.
     if (pass && pass[0] != '\0') {
-        preferences.putString("pass", pass);
+        nvs.putString(MQTT_PREFS_NAMESPACE, "pass", pass);
     }
-    preferences.end();
 }
 
 int MQTTService::getUsername(char* outBuf, size_t bufferSize) {
     if (!outBuf || bufferSize == 0) return -1;
     // Return the NVS-backed cached username (empty = anonymous)
-    size_t len = strlen(username);
-    if (len + 1 > bufferSize) return -1;
-    strcpy(outBuf, username);
-    return 0;
+    int rc = -1;
+    portENTER_CRITICAL(&configMux);
+    if (strlen(username) + 1 <= bufferSize) {
+        strcpy(outBuf, username);
+        rc = 0;
+    }
+    portEXIT_CRITICAL(&configMux);
+    return rc;
 }
 
 void MQTTService::updateBaseTopic(const char* topic) {
     if (!topic) return;
-    if (!preferences.begin(MQTT_PREFS_NAMESPACE, false)) return;
-    preferences.putString("topic", topic);
-    preferences.end();
+    NvsStore::getInstance().putString(MQTT_PREFS_NAMESPACE, "topic", topic);
 }
 
 void MQTTService::updateTls(bool enabled) {
-    if (!preferences.begin(MQTT_PREFS_NAMESPACE, false)) return;
-    preferences.putBool("tls", enabled);
-    preferences.end();
+    NvsStore::getInstance().putBool(MQTT_PREFS_NAMESPACE, "tls", enabled);
     // reloadConfig() (called by the config handler) re-reads NVS and reconnects.
 }
 
 int MQTTService::getBaseTopic(char* outBuf, size_t bufferSize) {
     if (!outBuf || bufferSize == 0) return -1;
     // Return the default base topic (built in buildClientIdAndDefaults)
-    size_t topicLen = strlen(baseTopic);
-    if (topicLen + 1 > bufferSize) return -1;
-    strcpy(outBuf, baseTopic);
-    return 0;
+    int rc = -1;
+    portENTER_CRITICAL(&configMux);
+    if (strlen(baseTopic) + 1 <= bufferSize) {
+        strcpy(outBuf, baseTopic);
+        rc = 0;
+    }
+    portEXIT_CRITICAL(&configMux);
+    return rc;
 }
 
 bool MQTTService::hasBrokerConfig() {
     // Configured when a broker host is set (default host applies on a fresh
     // device, so this is normally true unless the host was explicitly cleared)
-    return strlen(brokerHost) > 0;
+    return brokerHost[0] != '\0';
 }
 
 
@@ -252,28 +355,36 @@ void MQTTService::buildClientIdAndDefaults() {
     snprintf(logTopic,          sizeof(logTopic),          "%s/log",          baseTopic);
     snprintf(availabilityTopic, sizeof(availabilityTopic), "%s/availability", baseTopic);
     snprintf(telemetryTopic,    sizeof(telemetryTopic),    "%s/telemetry",    baseTopic);
+    snprintf(telemetryPackedTopic, sizeof(telemetryPackedTopic), "%s/telemetry/msgpack", baseTopic);
+    snprintf(infoTopic,         sizeof(infoTopic),         "%s/info",         baseTopic);
 }
 
 void MQTTService::readNvs() {
     // Defaults must apply even when the namespace has never been written (a
     // fresh device): opening Preferences read-only fails with NOT_FOUND in that
     // case, so seed the defaults first and only override from NVS if it opens.
+    // Runs on the network task after reloadConfig(), usually before the
+    // update*() writes have been committed: NvsReader returns them anyway.
+    NvsReader prefs;
     String h = DEFAULT_MQTT_HOST;
     String u = "";
     String p = "";
     String t = "";
-    brokerPort = DEFAULT_MQTT_PORT;
-    useTls = DEFAULT_MQTT_TLS;
-    if (preferences.begin(MQTT_PREFS_NAMESPACE, true)) {
-        h = preferences.getString("host", DEFAULT_MQTT_HOST);
-        brokerPort = preferences.getUShort("port", DEFAULT_MQTT_PORT);
-        u = preferences.getString("user", "");
-        p = preferences.getString("pass", "");
-        t = preferences.getString("topic", "");
-        useTls = preferences.getBool("tls", DEFAULT_MQTT_TLS);
-        preferences.end();
+    uint16_t port = DEFAULT_MQTT_PORT;
+    bool tls = DEFAULT_MQTT_TLS;
+    if (prefs.begin(MQTT_PREFS_NAMESPACE)) {
+        h = prefs.getString("host", DEFAULT_MQTT_HOST);
+        port = prefs.getUShort("port", DEFAULT_MQTT_PORT);
+        u = prefs.getString("user", "");
+        p = prefs.getString("pass", "");
+        t = prefs.getString("topic", "");
+        tls = prefs.getBool("tls", DEFAULT_MQTT_TLS);
+        prefs.end();
     }
 
+    portENTER_CRITICAL(&configMux);
+    brokerPort = port;
+    useTls = tls;
     strncpy(brokerHost, h.c_str(), sizeof(brokerHost) - 1); brokerHost[sizeof(brokerHost)-1] = '\0';
     strncpy(username,   u.c_str(), sizeof(username)   - 1); username[sizeof(username)-1]     = '\0';
     strncpy(password,   p.c_str(), sizeof(password)   - 1); password[sizeof(password)-1]     = '\0';
@@ -285,6 +396,9 @@ void MQTTService::readNvs() {
     snprintf(logTopic,          sizeof(logTopic),          "%s/log",          baseTopic);
     snprintf(availabilityTopic, sizeof(availabilityTopic), "%s/availability", baseTopic);
     snprintf(telemetryTopic,    sizeof(telemetryTopic),    "%s/telemetry",    baseTopic);
+    snprintf(telemetryPackedTopic, sizeof(telemetryPackedTopic), "%s/telemetry/msgpack", baseTopic);
+    snprintf(infoTopic,         sizeof(infoTopic),         "%s/info",         baseTopic);
+    portEXIT_CRITICAL(&configMux);
 }
 
 void MQTTService::applyServerConfig() {
@@ -320,19 +434,30 @@ void MQTTService::tryReconnect() {
     const char* user = (strlen(username) > 0) ? username : nullptr;
     const char* pass = (strlen(password) > 0) ? password : nullptr;
 
+    // Open the socket to the cached broker address (HostResolver.h), so a
+    // reconnect doesn't wait on DNS or fail while the router's resolver is
+    // down; PubSubClient uses a transport that is already connected. TLS
+    // still verifies the certificate against brokerHost. If this fails,
+    // connect() tries by name as before.
+    WiFiClient& transport = useTls ? static_cast<WiFiClient&>(secureClient) : wifiClient;
+    IPAddress ip;
+    if (!transport.connected() && HostResolver::getInstance().resolve(brokerHost, ip)) {
+        if (useTls) secureClient.connect(ip, brokerPort, brokerHost, MQTT_ROOT_CA_BUNDLE, nullptr, nullptr);
+        else        wifiClient.connect(ip, brokerPort);
+    }
+
     bool ok = client.connect(clientId, user, pass,
                              availabilityTopic, /*qos*/0, /*retain*/true, "offline");
 
     if (ok) {
+        connectCount++;
+        online = true;
         // Publish online status retained so HA picks it up immediately
-        inMqttCall = true;
         client.publish(availabilityTopic, "online", true);
-        inMqttCall = false;
 
-        // Resubscribe to all registered topic filters
-        for (auto& sub : subscriptions) {
-            client.subscribe(sub.filter.c_str());
-        }
+        // New session: resubscribe to all registered topic filters
+        subscribedCount = 0;
+        subscribePending();
 
         reconnectBackoffMs = RECONNECT_INITIAL_MS;
     } else {
@@ -341,88 +466,118 @@ void MQTTService::tryReconnect() {
     }
 }
 
+void MQTTService::subscribePending() {
+    portENTER_CRITICAL(&configMux);
+    uint8_t count = subscriptionCount;
+    portEXIT_CRITICAL(&configMux);
+    while (subscribedCount < count && client.connected()) {
+        client.subscribe(subscriptions[subscribedCount].filter);
+        subscribedCount++;
+    }
+}
+
+void MQTTService::drainOutbox() {
+    uint32_t start = millis();
+    for (uint8_t i = 0; i < OUTBOX_PER_PASS && (millis() - start) < DRAIN_BUDGET_MS; i++) {
+        if (!client.connected()) break;
+
+        // Same pattern as the log ring: the record stays in place (producers
+        // only write free space) while it is published outside the lock
+        MessageQueue<OUTBOX_BYTES>::Message m;
+        portENTER_CRITICAL(&outboxMux);
+        bool have = outbox.peek(m);
+        portEXIT_CRITICAL(&outboxMux);
+        if (!have) break;
+
+        const char* topic = m.topic;
+        switch (m.kind) {
+            case TOPIC_TELEMETRY:        topic = telemetryTopic;       break;
+            case TOPIC_TELEMETRY_PACKED: topic = telemetryPackedTopic; break;
+            case TOPIC_INFO:             topic = infoTopic;            break;
+            default: break;
+        }
+        // A publish PubSubClient rejects (too large) is dropped, not retried
+        client.publish(topic, m.payload, (unsigned int)m.len, m.retained);
+
+        portENTER_CRITICAL(&outboxMux);
+        outbox.pop();
+        portEXIT_CRITICAL(&outboxMux);
+    }
+}
+
 void MQTTService::drainLogQueue() {
+    static_assert(MQTT_MAX_PACKET_SIZE >= MQTT_PUBLISH_OVERHEAD + sizeof(logTopic) + LOG_MSG_MAX,
+                  "MQTT_MAX_PACKET_SIZE too small for one log line on the log topic");
     uint32_t start = millis();
-    char msgCopy[LOG_MSG_MAX];
+    // Largest payload PubSubClient accepts on the log topic. One line always
+    // fits (LOG_MSG_MAX is well under the packet size), so batching only
+    // decides how many go together.
+    size_t maxPayload = MQTT_MAX_PACKET_SIZE - MQTT_PUBLISH_OVERHEAD - strlen(logTopic);
+    uint16_t maxLines = MQTT_LOG_BATCH ? UINT16_MAX : 1;
     while ((millis() - start) < DRAIN_BUDGET_MS) {
         if (!client.connected()) break;
 
-        // Pull one item under the lock, then publish outside it so client.publish()
-        // is never called while the spinlock is held.
+        // Reserve a run of lines under the lock, then publish them straight
+        // out of the ring outside it, so client.publish() is never called
+        // while the spinlock is held. Producers can't evict a reserved span.
+        const char* data;
+        size_t len;
         portENTER_CRITICAL(&logQueueMux);
-        if (logQueueCount == 0) {
-            portEXIT_CRITICAL(&logQueueMux);
-            break;
-        }
-        memcpy(msgCopy, logQueue[logQueueTail], LOG_MSG_MAX);
-        logQueueTail = (logQueueTail + 1) % LOG_QUEUE_SIZE;
-        logQueueCount--;
+        uint16_t lines = logRing.peek(maxPayload, maxLines, data, len);
         portEXIT_CRITICAL(&logQueueMux);
+        if (lines == 0) break;
 
-        inMqttCall = true;
-        client.publish(logTopic, msgCopy, false);
-        inMqttCall = false;
+        client.publish(logTopic, (const uint8_t*)data, (unsigned int)len, false);
+
+        portENTER_CRITICAL(&logQueueMux);
+        logRing.commit();
+        portEXIT_CRITICAL(&logQueueMux);
+        logsSent += lines;
+        logPublishes++;
     }
 }
 
 void MQTTService::onMessageTrampoline(char* topic, byte* payload, unsigned int length) {
     if (!s_instance) return;
+    // Runs inside client.loop() on the network task: hand the message to the
+    // loop task rather than run handlers (state machine, OTA, config) here.
+    // A full inbox drops it (counted).
+    MQTTService* self = s_instance;
+    portENTER_CRITICAL(&self->inboxMux);
+    self->inbox.push(0, false, topic, payload, length);
+    portEXIT_CRITICAL(&self->inboxMux);
+}
 
-    // Null-terminate into a stack buffer (truncate if oversized)
-    static constexpr size_t MAX_PAYLOAD = 512;
-    char buf[MAX_PAYLOAD + 1];
-    size_t copyLen = (length < MAX_PAYLOAD) ? length : MAX_PAYLOAD;
-    memcpy(buf, payload, copyLen);
-    buf[copyLen] = '\0';
-
-    s_instance->dispatchMessage(topic, buf);
-}
-
-// MQTT 3.1.1 §4.7 topic filter matching.
-// Rules:
-//   '#' must appear only as the last segment; matches any remaining levels.
-//   '+' matches exactly one topic level (no slashes).
-//   All other characters must match exactly.
-static bool mqttTopicMatches(const char* filter, const char* topic) {
-    const char* f = filter;
-    const char* t = topic;
-
-    while (*f && *t) {
-        if (*f == '#') {
-            // '#' is valid only at end of filter (optionally preceded by '/')
-            return true;
-        }
+void MQTTService::dispatchInbox() {
+    for (uint8_t i = 0; i < INBOX_PER_LOOP; i++) {
+        // Handlers get a view straight into the inbox record, valid until pop()
+        MessageQueue<INBOX_BYTES>::Message m;
+        portENTER_CRITICAL(&inboxMux);
+        bool have = inbox.peek(m);
+        portEXIT_CRITICAL(&inboxMux);
+        if (!have) break;
 
-        if (*f == '+') {
-            // '+' matches exactly one level — advance topic past the next '/'
-            while (*t && *t != '/') {
-                t++;
-            }
-            f++; // consume '+'
-            // Both pointers should now point at '/' or '\0'
-        } else {
-            if (*f != *t) {
-                return false;
-            }
-            f++;
-            t++;
-        }
-    }
+        dispatchMessage(m.topic, m.payload, m.len);
 
-    // Handle trailing '#' (e.g. filter "a/#" matches topic "a/")
-    if (*f == '#' || (*f == '/' && *(f + 1) == '#')) {
-        return true;
+        portENTER_CRITICAL(&inboxMux);
+        inbox.pop();
+        portEXIT_CRITICAL(&inboxMux);
     }
-
-    return *f == '\0' && *t == '\0';
 }
 
-void MQTTService::dispatchMessage(const char* topic, const char* payload) {
-    for (auto& sub : subscriptions) {
-        if (mqttTopicMatches(sub.filter.c_str(), topic)) {
-            sub.cb(topic, payload);
-        }
-    }
+void MQTTService::dispatchMessage(const char* topic, const uint8_t* payload, size_t len) {
+    struct Args {
+        MQTTService*   self;
+        const char*    topic;
+        const uint8_t* payload;
+        size_t         len;
+    } args = { this, topic, payload, len };
+
+    topicTrie.match(topic, [](uint8_t id, void* arg) {
+        Args* a = (Args*)arg;
+        const Subscription& sub = a->self->subscriptions[id];
+        sub.handler(sub.ctx, a->topic, a->payload, a->len);
+    }, &args);
 }
 
 
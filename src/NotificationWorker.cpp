@@ -1,6 +1,9 @@
 #ifndef UNIT_TESTING
 
 #include "NotificationWorker.h"
+#include "AlertFormatter.h"
+#include "HttpPoster.h"
+#include "HostResolver.h"
 #include "Logger.h"
 #include <freertos/task.h>
 
@@ -9,25 +12,38 @@ constexpr uint32_t NotificationWorker::RETRY_BACKOFF_MS[3];
 void NotificationWorker::begin(NotificationChannel** channels, size_t count, bool dryRunMode) {
     channelRegistry = channels;
     channelCount    = count;
+    if (channelCount > DeliveryScheduler::MAX_CHANNELS) {
+        LOG_CRITICAL("[NOTIFIER] %u channels registered, only %u supported",
+                     (unsigned)count, (unsigned)DeliveryScheduler::MAX_CHANNELS);
+        channelCount = DeliveryScheduler::MAX_CHANNELS;
+    }
     dryRun          = dryRunMode;
 
-    fifoQueue        = xQueueCreate(FIFO_DEPTH, sizeof(NotifMsg));
-    emergencyMailbox = xQueueCreate(1, sizeof(NotifMsg));
-    if (!fifoQueue || !emergencyMailbox) {
+    queueMux = xSemaphoreCreateMutex();
+    if (!queueMux) {
         LOG_CRITICAL("[NOTIFIER] Queue allocation FAILED — notifications unavailable");
         return;
     }
 
-    // H3: a queue set makes no ordering guarantee between members, so an
-    // emergency snapshot could be deferred behind FIFO backlog accumulated
-    // during a WiFi outage. Block on a direct task notification instead and
-    // poll emergency-then-FIFO on wake for strict priority.
+    // H3: block on a direct task notification and pop the queue in class
+    // order on wake, so an emergency snapshot is never deferred behind
+    // backlog accumulated during a WiFi outage.
     BaseType_t ok = xTaskCreatePinnedToCore(taskEntry, "notifier", TASK_STACK,
                                             this, TASK_PRIORITY, &taskHandle, TASK_CORE);
     if (ok != pdPASS) {
         LOG_CRITICAL("[NOTIFIER] Task creation FAILED — notifications will not be delivered");
         taskHandle = nullptr;
+        return;
     }
+    // Keep the channels' endpoint addresses cached so a send skips DNS
+    if (!dryRun) HostResolver::getInstance().addSource(endpointHostSource, this);
+}
+
+bool NotificationWorker::endpointHostSource(void* ctx, uint8_t index, char* host, size_t len) {
+    NotificationWorker* self = static_cast<NotificationWorker*>(ctx);
+    if (index >= self->channelCount) return false;
+    if (!self->channelRegistry[index]->endpointHost(host, len)) host[0] = '\0';
+    return true;
 }
 
 uint32_t NotificationWorker::getStackHighWaterMark() const {
@@ -35,28 +51,22 @@ uint32_t NotificationWorker::getStackHighWaterMark() const {
     return (uint32_t)uxTaskGetStackHighWaterMark(taskHandle);
 }
 
-bool NotificationWorker::enqueue(const char* message, uint8_t channels) {
+bool NotificationWorker::enqueue(const char* message, uint8_t channels,
+                                 NotifyClass cls, uint8_t key) {
     if (!message) return false;
     if (dryRun) {
-        LOG_EVENT("[MOCK] Notification (dry-run, ch=0x%02x): %.120s", channels, message);
+        LOG_EVENT("[MOCK] Notification (dry-run, ch=0x%02x, %s): %.120s",
+                  channels, notifyClassName(cls), message);
         return true;
     }
-    if (!fifoQueue) return false;
+    // The emergency class is latest-wins by construction; keep it that way
+    if (cls == NOTIFY_EMERGENCY) return enqueueEmergency(message, channels);
     NotifMsg msg;
     strncpy(msg.body, message, sizeof(msg.body) - 1);
     msg.body[sizeof(msg.body) - 1] = '\0';
     msg.channels = channels;
-    if (xQueueSend(fifoQueue, &msg, 0) != pdTRUE) {
-        dropCount++;
-        LOG_EVENT("[NOTIFIER] FIFO full — message dropped (total dropped: %u): %.60s",
-                  dropCount, message);
-        return false;
-    }
-    // H3: wake the worker so it can drain the queue (emergency first).
-    if (taskHandle) {
-        xTaskNotifyGive(taskHandle);
-    }
-    return true;
+    msg.formatPending = false;
+    return post(msg, cls, key);
 }
 
 bool NotificationWorker::enqueueEmergency(const char* message, uint8_t channels) {
@@ -65,90 +75,367 @@ bool NotificationWorker::enqueueEmergency(const char* message, uint8_t channels)
         LOG_EVENT("[MOCK] Emergency notification (dry-run, ch=0x%02x): %.120s", channels, message);
         return true;
     }
-    if (!emergencyMailbox) return false;
     NotifMsg msg;
     strncpy(msg.body, message, sizeof(msg.body) - 1);
     msg.body[sizeof(msg.body) - 1] = '\0';
     msg.channels = channels;
-    // Depth-1 overwrite: always succeeds, replacing any older unsent snapshot.
-    xQueueOverwrite(emergencyMailbox, &msg);
-    // H3: wake the worker so the emergency snapshot is drained ahead of any
-    // pending FIFO backlog.
+    msg.formatPending = false;
+    return post(msg, NOTIFY_EMERGENCY, NOTIFY_KEY_EMERGENCY);
+}
+
+bool NotificationWorker::enqueueEvent(const StateMachineEventRecord& event, uint32_t traceId,
+                                      uint8_t channels) {
+    NotifMsg msg;
+    msg.body[0] = '\0';
+    msg.channels = channels;
+    msg.formatPending = true;
+    msg.traceId = traceId;
+    msg.event = event;
+    if (dryRun) {
+        formatAlert(msg.body, sizeof(msg.body), event, traceId);
+        LOG_EVENT("[MOCK] Notification (dry-run, ch=0x%02x): %.120s", channels, msg.body);
+        return true;
+    }
+    switch (event.type) {
+        case SM_EVENT_EMERGENCY:
+            return post(msg, NOTIFY_EMERGENCY, NOTIFY_KEY_EMERGENCY);
+        case SM_EVENT_SENSOR_FAILURE:
+            return post(msg, NOTIFY_FAULT, NOTIFY_KEY_SENSOR_FAILURE);
+        case SM_EVENT_SENSOR_RECOVERED:
+            return post(msg, NOTIFY_FAULT, NOTIFY_KEY_SENSOR_RECOVERED);
+        case SM_EVENT_SILENCED:
+            return post(msg, NOTIFY_INFO, NOTIFY_KEY_SILENCE);
+        default:
+            // A log-only event must never take a queue slot
+            return false;
+    }
+}
+
+bool NotificationWorker::post(NotifMsg& msg, NotifyClass cls, uint8_t key) {
+    if (!queueMux) return false;
+    msg.enqueuedMs = millis();
+    xSemaphoreTake(queueMux, portMAX_DELAY);
+    NotifyQueue<NotifMsg>::PushResult r = queue.push(msg, cls, key);
+    uint32_t drops = queue.dropped(cls);
+    xSemaphoreGive(queueMux);
+
+    if (r == NotifyQueue<NotifMsg>::DROPPED) {
+        LOG_EVENT("[NOTIFIER] %s queue full — message dropped (%s dropped: %u): %.60s",
+                  notifyClassName(cls), notifyClassName(cls), drops,
+                  msg.formatPending ? "(event)" : msg.body);
+        return false;
+    }
+    if (r == NotifyQueue<NotifMsg>::REPLACED && cls != NOTIFY_EMERGENCY) {
+        LOG_DEBUG("[NOTIFIER] Replaced queued %s message with a newer duplicate",
+                  notifyClassName(cls));
+    }
+    // H3: wake the worker so it can drain the queue (emergency first).
     if (taskHandle) {
         xTaskNotifyGive(taskHandle);
     }
     return true;
 }
 
+uint32_t NotificationWorker::requestTest(NotificationChannel* channel, const char* message) {
+    if (!channel || !message || !queueMux || !taskHandle) return 0;
+    xSemaphoreTake(queueMux, portMAX_DELAY);
+    if (testStatus == TEST_PENDING) {
+        xSemaphoreGive(queueMux);
+        return 0;
+    }
+    testChannel = channel;
+    strncpy(testBody, message, sizeof(testBody) - 1);
+    testBody[sizeof(testBody) - 1] = '\0';
+    if (++testId == 0) testId = 1;
+    testStatus = TEST_PENDING;
+    uint32_t id = testId;
+    xSemaphoreGive(queueMux);
+    xTaskNotifyGive(taskHandle);
+    return id;
+}
+
+NotificationWorker::TestStatus NotificationWorker::getTestStatus(uint32_t id) const {
+    if (!queueMux) return TEST_NONE;
+    xSemaphoreTake(queueMux, portMAX_DELAY);
+    TestStatus s = (id != 0 && id == testId) ? testStatus : TEST_NONE;
+    xSemaphoreGive(queueMux);
+    return s;
+}
+
+// Worker task only. The body is copied out so the mutex isn't held across
+// the HTTP call.
+bool NotificationWorker::runTest() {
+    NotificationChannel* channel;
+    char body[NOTIFY_BODY_MAX + 1];
+    xSemaphoreTake(queueMux, portMAX_DELAY);
+    channel = testStatus == TEST_PENDING ? testChannel : nullptr;
+    if (channel) memcpy(body, testBody, sizeof(body));
+    xSemaphoreGive(queueMux);
+    if (!channel) return false;
+
+    LOG_INFO("[NOTIFIER] Test send on %s", channel->name());
+    bool ok = channel->send(body);
+    LOG_INFO("[NOTIFIER] Test send on %s %s", channel->name(), ok ? "succeeded" : "FAILED");
+
+    xSemaphoreTake(queueMux, portMAX_DELAY);
+    testStatus = ok ? TEST_OK : TEST_FAILED;
+    xSemaphoreGive(queueMux);
+    return true;
+}
+
+bool NotificationWorker::take(NotifMsg& msg, NotifyClass& cls, bool emergencyOnly) {
+    xSemaphoreTake(queueMux, portMAX_DELAY);
+    bool ok;
+    if (emergencyOnly) {
+        cls = NOTIFY_EMERGENCY;
+        ok = queue.pop(NOTIFY_EMERGENCY, msg);
+    } else {
+        ok = queue.pop(msg, cls);
+    }
+    xSemaphoreGive(queueMux);
+    return ok;
+}
+
 uint32_t NotificationWorker::getPendingCount() const {
-    if (!fifoQueue) return 0;
-    return (uint32_t)uxQueueMessagesWaiting(fifoQueue);
+    if (!queueMux) return 0;
+    xSemaphoreTake(queueMux, portMAX_DELAY);
+    uint32_t n = queue.size();
+    xSemaphoreGive(queueMux);
+    return n;
+}
+
+// Counters are single aligned words, so they're read without the mutex.
+uint32_t NotificationWorker::getDropCount() const { return queue.dropped(); }
+uint32_t NotificationWorker::getDropCount(NotifyClass cls) const { return queue.dropped(cls); }
+uint32_t NotificationWorker::getDedupCount(NotifyClass cls) const { return queue.deduplicated(cls); }
+
+const char* NotificationWorker::getChannelName(size_t i) const {
+    return i < channelCount && channelRegistry[i] ? channelRegistry[i]->name() : "";
+}
+
+LatencyHistogram NotificationWorker::getLatency(size_t channel, LatencyKind kind) const {
+    if (!queueMux || channel >= channelCount) return LatencyHistogram();
+    xSemaphoreTake(queueMux, portMAX_DELAY);
+    LatencyHistogram h = latency[channel][kind];
+    xSemaphoreGive(queueMux);
+    return h;
+}
+
+size_t NotificationWorker::formatLatencyJson(size_t channel, char* out, size_t len) const {
+    static const char* const KEYS[LATENCY_KINDS] = { "queue", "deliver", "send" };
+    if (!out || len < 2) return 0;
+    size_t pos = 0;
+    out[pos++] = '{';
+    for (uint8_t k = 0; k < LATENCY_KINDS; k++) {
+        int n = snprintf(out + pos, len - pos, "%s\"%s\":", k ? "," : "", KEYS[k]);
+        if (n < 0 || (size_t)n >= len - pos) { out[0] = '\0'; return 0; }
+        pos += (size_t)n;
+        size_t w = getLatency(channel, (LatencyKind)k).formatJson(out + pos, len - pos);
+        if (w == 0) { out[0] = '\0'; return 0; }
+        pos += w;
+    }
+    if (pos + 2 > len) { out[0] = '\0'; return 0; }
+    out[pos++] = '}';
+    out[pos] = '\0';
+    return pos;
+}
+
+void NotificationWorker::recordLatency(uint8_t channel, LatencyKind kind, uint32_t ms) {
+    xSemaphoreTake(queueMux, portMAX_DELAY);
+    latency[channel][kind].record(ms);
+    xSemaphoreGive(queueMux);
 }
 
 void NotificationWorker::taskEntry(void* arg) {
     static_cast<NotificationWorker*>(arg)->run();
 }
 
-void NotificationWorker::deliver(NotifMsg& msg) {
-    // pending bitmask: only channels that are requested AND configured.
+uint8_t NotificationWorker::laneMask(uint8_t channels) const {
+    // Only channels that are requested AND configured get a lane entry.
     // Unconfigured channels are skipped silently — not an error, just not set up yet.
-    uint8_t pending = 0;
+    uint8_t mask = 0;
     for (size_t i = 0; i < channelCount; i++) {
         NotificationChannel* ch = channelRegistry[i];
-        if (ch && (msg.channels & ch->channelFlag()) && ch->isConfigured()) {
-            pending |= ch->channelFlag();
+        if (ch && (channels & ch->channelFlag()) && ch->isConfigured()) {
+            mask |= (uint8_t)(1u << i);
         }
     }
+    return mask;
+}
 
-    for (uint8_t attempt = 1; attempt <= SEND_ATTEMPTS && pending; attempt++) {
-        for (size_t i = 0; i < channelCount; i++) {
-            NotificationChannel* ch = channelRegistry[i];
-            if (!ch) continue;
-            if (pending & ch->channelFlag()) {
-                if (ch->send(msg.body)) {
-                    pending &= ~ch->channelFlag();
-                }
-            }
-        }
+size_t NotificationWorker::laneLimit(uint8_t mask) const {
+    size_t limit = NOTIFY_BODY_MAX;
+    for (size_t i = 0; i < channelCount; i++) {
+        if (!(mask & (1u << i))) continue;
+        size_t n = channelRegistry[i]->maxMessageLength();
+        if (n < limit) limit = n;
+    }
+    return limit + 1; // buffer size including NUL
+}
+
+void NotificationWorker::prepare(NotifMsg& msg) {
+    // Event messages are formatted here, on the worker task's stack
+    if (msg.formatPending) {
+        formatAlert(msg.body, sizeof(msg.body), msg.event, msg.traceId);
+        msg.formatPending = false;
+    }
+}
+
+void NotificationWorker::admit(NotifMsg& msg, bool emergency) {
+    prepare(msg);
+    uint8_t mask = laneMask(msg.channels);
+    if (!mask) return;
 
-        if (pending && attempt < SEND_ATTEMPTS) {
-            uint32_t backoff = RETRY_BACKOFF_MS[attempt - 1];
-            LOG_EVENT("[NOTIFIER] Send failed (attempt %u/%u), retrying in %ums: %.60s",
-                      attempt, SEND_ATTEMPTS, backoff, msg.body);
-            vTaskDelay(pdMS_TO_TICKS(backoff));
+    uint32_t now = millis();
+    if (emergency) {
+        // Latest wins: a lane still retrying the previous snapshot sends this
+        // one instead.
+        strncpy(inflight[DeliveryScheduler::EMERGENCY_SLOT], msg.body, NOTIFY_BODY_MAX);
+        inflight[DeliveryScheduler::EMERGENCY_SLOT][NOTIFY_BODY_MAX] = '\0';
+        inflightEnqueuedMs[DeliveryScheduler::EMERGENCY_SLOT] = msg.enqueuedMs;
+        sched.admitEmergency(mask, now);
+        return;
+    }
+    int8_t slot = sched.findFreeSlot();
+    if (slot < 0) return; // caller checks slotAvailable() before dequeuing
+    strncpy(inflight[slot], msg.body, NOTIFY_BODY_MAX);
+    inflight[slot][NOTIFY_BODY_MAX] = '\0';
+    inflightEnqueuedMs[slot] = msg.enqueuedMs;
+    sched.admit((uint8_t)slot, mask, now);
+}
+
+void NotificationWorker::flushBatch() {
+    uint32_t now = millis();
+    uint8_t mask = laneMask(batch.channels());
+    if (!mask) {
+        batch.clear();
+        flushing = false;
+        return;
+    }
+
+    if (!flushing) {
+        // Common case: every message targets the same channels and the joined
+        // text fits every channel's limit, so one slot serves all lanes.
+        int8_t slot = sched.findFreeSlot();
+        if (slot < 0) return;
+        if (batch.uniform() &&
+            batch.build(batch.channels(), 0, inflight[slot], laneLimit(mask)) == batch.size()) {
+            LOG_EVENT("[NOTIFIER] Coalesced %u messages into one send per channel", batch.size());
+            inflightEnqueuedMs[slot] = batchEnqueuedMs;
+            sched.admit((uint8_t)slot, mask, now);
+            batch.clear();
+            return;
         }
+        flushing = true;
+        for (uint8_t c = 0; c < DeliveryScheduler::MAX_CHANNELS; c++) flushCursor[c] = 0;
     }
 
-    // Log any channels that exhausted all retries
+    // Otherwise split per lane at that channel's own limit. If slots run out
+    // part-way, the cursors keep our place and the next pass resumes once a
+    // lane has finished with one.
     for (size_t i = 0; i < channelCount; i++) {
-        NotificationChannel* ch = channelRegistry[i];
-        if (ch && (pending & ch->channelFlag())) {
-            LOG_CRITICAL("[NOTIFIER] %s send GAVE UP after %u attempts: %.60s",
-                         ch->name(), SEND_ATTEMPTS, msg.body);
+        if (!(mask & (1u << i))) continue;
+        uint8_t flag = channelRegistry[i]->channelFlag();
+        size_t limit = laneLimit((uint8_t)(1u << i));
+        while (flushCursor[i] < batch.size()) {
+            int8_t slot = sched.findFreeSlot();
+            if (slot < 0) return;
+            flushCursor[i] = batch.build(flag, flushCursor[i], inflight[slot], limit);
+            if (!inflight[slot][0]) continue;
+            inflightEnqueuedMs[slot] = batchEnqueuedMs;
+            sched.admit((uint8_t)slot, (uint8_t)(1u << i), now);
         }
     }
+    LOG_EVENT("[NOTIFIER] Coalesced %u messages per channel size limit", batch.size());
+    batch.clear();
+    flushing = false;
+}
+
+void NotificationWorker::sendOne(const DeliveryScheduler::Attempt& a) {
+    NotificationChannel* ch = channelRegistry[a.channel];
+    const char* body = inflight[a.slot];
+    uint32_t start = millis();
+    // A coalesced body is timed from its oldest message
+    if (a.attempt == 1) recordLatency(a.channel, LATENCY_QUEUE, start - inflightEnqueuedMs[a.slot]);
+    bool ok = ch->send(body);
+    uint32_t end = millis();
+    recordLatency(a.channel, LATENCY_SEND, end - start);
+
+    switch (sched.complete(a, ok, end)) {
+        case DeliveryScheduler::SENT:
+            recordLatency(a.channel, LATENCY_DELIVER, end - inflightEnqueuedMs[a.slot]);
+            break;
+        case DeliveryScheduler::RETRY:
+            LOG_EVENT("[NOTIFIER] %s send failed (attempt %u/%u), retrying in %ums: %.60s",
+                      ch->name(), a.attempt, SEND_ATTEMPTS, sched.backoffFor(a.attempt), body);
+            break;
+        case DeliveryScheduler::GAVE_UP:
+            LOG_CRITICAL("[NOTIFIER] %s send GAVE UP after %u attempts: %.60s",
+                         ch->name(), SEND_ATTEMPTS, body);
+            break;
+    }
 }
 
 void NotificationWorker::run() {
     NotifMsg msg;
+    NotifyClass cls;
     for (;;) {
-        // H3: strict priority. Drain the emergency mailbox completely before
-        // touching the FIFO, so an emergency snapshot present at wake time is
-        // always delivered ahead of one-shot events accumulated during a WiFi
-        // outage. Both queues are polled non-blocking; if both are empty the
-        // task blocks on a direct notification from a producer.
-        if (xQueueReceive(emergencyMailbox, &msg, 0) == pdTRUE) {
-            deliver(msg);
-            continue;
+        // H3: strict priority. A new emergency snapshot is admitted ahead of
+        // everything (it has a reserved in-flight slot), including messages
+        // already waiting out a backoff.
+        if (take(msg, cls, true)) {
+            admit(msg, true);
+        }
+        // Pull the rest in class order only while they have somewhere to go
+        // (a free in-flight slot, or room in the coalescing batch); the others
+        // stay queued (which is what getPendingCount() reports).
+        for (;;) {
+            bool room = coalesceWindowMs == 0 ? sched.slotAvailable()
+                                              : !flushing && !batch.full();
+            if (!room || !take(msg, cls, false)) break;
+            if (cls == NOTIFY_EMERGENCY) {
+                admit(msg, true);
+            } else if (coalesceWindowMs == 0) {
+                admit(msg, false);
+            } else {
+                prepare(msg);
+                if (!laneMask(msg.channels)) continue;
+                // Classes drain in priority order, not arrival order
+                if (batch.empty() || (int32_t)(msg.enqueuedMs - batchEnqueuedMs) < 0) {
+                    batchEnqueuedMs = msg.enqueuedMs;
+                }
+                batch.add(msg.body, msg.channels, millis());
+            }
+        }
+        if (coalesceWindowMs != 0 && (flushing || batch.due(millis(), coalesceWindowMs))) {
+            flushBatch();
         }
-        if (xQueueReceive(fifoQueue, &msg, 0) == pdTRUE) {
-            deliver(msg);
+
+        // One send per pass, so an emergency posted during a slow HTTP call
+        // is picked up before the next lane is served.
+        DeliveryScheduler::Attempt a;
+        if (sched.nextDue(millis(), a)) {
+            sendOne(a);
             continue;
         }
-        // Nothing pending. Block until a producer (enqueue/enqueueEmergency)
-        // signals. pdTRUE clears the notification count on wake so a signal
-        // that arrived between the polls above and this take is not lost.
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (runTest()) continue;
+
+        // Nothing due. Sleep until the earliest lane retry, or until a
+        // producer signals — an emergency cuts a retry wait short. pdTRUE
+        // clears the notification count on wake so a signal that arrived
+        // between the polls above and this take is not lost.
+        uint32_t waitMs = sched.msUntilNextDue(millis());
+        // (A batch waiting on a free slot is resumed after the next send.)
+        if (!flushing && sched.slotAvailable()) {
+            uint32_t batchMs = batch.msUntilDue(millis(), coalesceWindowMs);
+            if (batchMs < waitMs) waitMs = batchMs;
+        }
+        // Also wake to drop keep-alive connections that have gone idle, so
+        // their TLS buffers are returned to the heap between incidents.
+        uint32_t idleMs = HttpPoster::closeIdle();
+        if (idleMs < waitMs) waitMs = idleMs;
+        TickType_t ticks = waitMs == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(waitMs);
+        ulTaskNotifyTake(pdTRUE, ticks > 0 ? ticks : 1);
     }
 }
 
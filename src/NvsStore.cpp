@@ -0,0 +1,340 @@
+#ifndef UNIT_TESTING
+#include "NvsStore.h"
+#include "Logger.h"
+#include <esp_system.h>
+
+// Longest restart-hook wait for a commit already in progress on the task
+static constexpr uint32_t SHUTDOWN_LOCK_WAIT_MS = 500;
+
+NvsStore& NvsStore::getInstance() {
+    static NvsStore instance;
+    return instance;
+}
+
+NvsStore::NvsStore()
+    : cacheMux(xSemaphoreCreateMutex())
+    , commitMux(xSemaphoreCreateMutex())
+    , taskHandle(nullptr)
+    , stats{}
+{}
+
+void NvsStore::begin() {
+    if (taskHandle) return;
+    BaseType_t ok = xTaskCreatePinnedToCore(taskEntry, "nvs", TASK_STACK,
+                                            this, TASK_PRIORITY, &taskHandle, TASK_CORE);
+    if (ok != pdPASS) {
+        // Puts still work: a full cache commits synchronously, and so does
+        // the restart hook
+        LOG_CRITICAL("[NVS] Commit task creation FAILED — saves commit on restart or when full");
+        taskHandle = nullptr;
+    }
+    esp_register_shutdown_handler(&NvsStore::onShutdown);
+}
+
+
+// =============================================================================
+// Put
+// =============================================================================
+
+bool NvsStore::putString(const char* ns, const char* key, const char* value) {
+    if (!value) return false;
+    return put(ns, key, Cache::T_STRING, value, strlen(value) + 1);
+}
+
+bool NvsStore::putBytes(const char* ns, const char* key, const void* data, size_t len) {
+    if (!data && len) return false;
+    return put(ns, key, Cache::T_BYTES, data, len);
+}
+
+bool NvsStore::putBool(const char* ns, const char* key, bool value) {
+    uint8_t v = value ? 1 : 0;
+    return put(ns, key, Cache::T_BOOL, &v, sizeof(v));
+}
+
+bool NvsStore::putInt(const char* ns, const char* key, int32_t value) {
+    return put(ns, key, Cache::T_INT, &value, sizeof(value));
+}
+
+bool NvsStore::putUInt(const char* ns, const char* key, uint32_t value) {
+    return put(ns, key, Cache::T_UINT, &value, sizeof(value));
+}
+
+bool NvsStore::putUShort(const char* ns, const char* key, uint16_t value) {
+    return put(ns, key, Cache::T_USHORT, &value, sizeof(value));
+}
+
+bool NvsStore::putFloat(const char* ns, const char* key, float value) {
+    return put(ns, key, Cache::T_FLOAT, &value, sizeof(value));
+}
+
+bool NvsStore::remove(const char* ns, const char* key) {
+    return put(ns, key, Cache::T_REMOVE, nullptr, 0);
+}
+
+bool NvsStore::put(const char* ns, const char* key, uint8_t type, const void* data, size_t len) {
+    for (int attempt = 0; attempt < 2; attempt++) {
+        xSemaphoreTake(cacheMux, portMAX_DELAY);
+        bool ok = pending.put(ns, key, type, data, len, millis());
+        if (ok) stats.puts++;
+        xSemaphoreGive(cacheMux);
+        if (ok) {
+            // Wake the task so the quiet period is measured from this put
+            if (taskHandle) xTaskNotifyGive(taskHandle);
+            return true;
+        }
+        if (attempt == 0) {
+            // Full (or the value can never fit): commit what's queued on this
+            // task rather than lose the write, then retry once
+            LOG_INFO("[NVS] Write-behind cache full — committing %s/%s synchronously", ns, key);
+            commit(/*force=*/true);
+        }
+    }
+    LOG_CRITICAL("[NVS] Could not queue %s/%s (%u bytes)", ns ? ns : "?", key ? key : "?", (unsigned)len);
+    return false;
+}
+
+
+// =============================================================================
+// Commit
+// =============================================================================
+
+void NvsStore::flush() {
+    commit(/*force=*/true);
+}
+
+void NvsStore::commit(bool force, TickType_t wait) {
+    if (xSemaphoreTake(commitMux, wait) != pdTRUE) return;
+
+    xSemaphoreTake(cacheMux, portMAX_DELAY);
+    bool go = force ? !pending.empty()
+                    : pending.due(millis(), COMMIT_QUIET_MS, COMMIT_MAX_DELAY_MS);
+    if (go) pending.take(committing);
+    xSemaphoreGive(cacheMux);
+
+    if (go) {
+        writeBatch(committing);
+        xSemaphoreTake(cacheMux, portMAX_DELAY);
+        committing.clear();
+        stats.commits++;
+        xSemaphoreGive(cacheMux);
+    }
+    xSemaphoreGive(commitMux);
+}
+
+void NvsStore::writeBatch(const Cache& batch) {
+    // One Preferences session (one nvs_commit) per namespace in the batch
+    bool done[Cache::CAPACITY] = {};
+    for (uint8_t i = 0; i < batch.size(); i++) {
+        if (done[i]) continue;
+        const char* ns = batch.entry(i).ns;
+        Preferences prefs;
+        bool open = prefs.begin(ns, /*readOnly=*/false);
+        if (!open) LOG_CRITICAL("[NVS] Failed to open \"%s\" for writing", ns);
+
+        for (uint8_t j = i; j < batch.size(); j++) {
+            const Cache::Entry& e = batch.entry(j);
+            if (done[j] || strcmp(e.ns, ns) != 0) continue;
+            done[j] = true;
+            if (!open) {
+                stats.failures++;
+                continue;
+            }
+            const uint8_t* d = batch.data(e);
+            size_t n = 0;
+            switch (e.type) {
+                case Cache::T_BOOL:   n = prefs.putBool(e.key, d[0] != 0); break;
+                case Cache::T_INT:    { int32_t v;  memcpy(&v, d, 4); n = prefs.putInt(e.key, v); break; }
+                case Cache::T_UINT:   { uint32_t v; memcpy(&v, d, 4); n = prefs.putUInt(e.key, v); break; }
+                case Cache::T_USHORT: { uint16_t v; memcpy(&v, d, 2); n = prefs.putUShort(e.key, v); break; }
+                case Cache::T_FLOAT:  { float v;    memcpy(&v, d, 4); n = prefs.putFloat(e.key, v); break; }
+                case Cache::T_STRING: n = prefs.putString(e.key, (const char*)d); break;
+                case Cache::T_BYTES:  n = e.len ? prefs.putBytes(e.key, d, e.len) : 1; break;
+                case Cache::T_REMOVE: n = 1; if (prefs.isKey(e.key)) n = prefs.remove(e.key) ? 1 : 0; break;
+                default: break;
+            }
+            if (n == 0) {
+                stats.failures++;
+                LOG_CRITICAL("[NVS] Write of %s/%s failed", ns, e.key);
+            } else {
+                stats.keysWritten++;
+            }
+        }
+        if (open) prefs.end();
+    }
+}
+
+void NvsStore::taskEntry(void* arg) {
+    NvsStore* self = static_cast<NvsStore*>(arg);
+    for (;;) {
+        // Woken by each put (or the poll tick) to re-check the quiet period
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(POLL_MS));
+        self->commit(/*force=*/false);
+    }
+}
+
+void NvsStore::onShutdown() {
+    // esp_restart() context: don't wait forever on a commit in progress
+    getInstance().commit(/*force=*/true, pdMS_TO_TICKS(SHUTDOWN_LOCK_WAIT_MS));
+}
+
+
+// =============================================================================
+// Read side
+// =============================================================================
+
+bool NvsStore::lookup(const char* ns, const char* key, uint8_t& type,
+                      void* out, size_t outSize, size_t& lenOut) {
+    xSemaphoreTake(cacheMux, portMAX_DELAY);
+    // Newest first: a put after the batch was taken overrides it
+    const Cache* src = &pending;
+    const Cache::Entry* e = pending.find(ns, key);
+    if (!e) {
+        src = &committing;
+        e = committing.find(ns, key);
+    }
+    if (e) {
+        type = e->type;
+        lenOut = e->len;
+        if (out && outSize) memcpy(out, src->data(*e), e->len < outSize ? e->len : outSize);
+    }
+    xSemaphoreGive(cacheMux);
+    return e != nullptr;
+}
+
+bool NvsStore::hasPending(const char* ns) {
+    xSemaphoreTake(cacheMux, portMAX_DELAY);
+    bool any = pending.hasNamespace(ns) || committing.hasNamespace(ns);
+    xSemaphoreGive(cacheMux);
+    return any;
+}
+
+NvsStore::Stats NvsStore::getStats() {
+    xSemaphoreTake(cacheMux, portMAX_DELAY);
+    Stats s = stats;
+    s.coalesced = pending.coalescedCount();
+    s.pending = pending.size();
+    xSemaphoreGive(cacheMux);
+    return s;
+}
+
+bool NvsReader::begin(const char* name) {
+    end();
+    ns = name;
+    opened = prefs.begin(name, /*readOnly=*/true);
+    return opened || store.hasPending(name);
+}
+
+void NvsReader::end() {
+    if (opened) prefs.end();
+    opened = false;
+}
+
+bool NvsReader::pendingScalar(const char* key, uint8_t type, void* out, size_t len, bool& removed) {
+    uint8_t t;
+    size_t n;
+    uint8_t buf[4];
+    removed = false;
+    if (!ns || !store.lookup(ns, key, t, buf, sizeof(buf), n)) return false;
+    if (t == NvsStore::Cache::T_REMOVE) {
+        removed = true;
+        return true;
+    }
+    // A different type under the same key reads as absent, like Preferences
+    if (t != type || n != len) {
+        removed = true;
+        return true;
+    }
+    memcpy(out, buf, len);
+    return true;
+}
+
+String NvsReader::getString(const char* key, const char* def) {
+    uint8_t t;
+    size_t n;
+    char small[64];
+    if (ns && store.lookup(ns, key, t, small, sizeof(small), n)) {
+        if (t != NvsStore::Cache::T_STRING) return String(def);
+        if (n <= sizeof(small)) return String(small);
+        // Long value: copy again into a buffer of the right size
+        char* big = (char*)malloc(n);
+        if (!big) return String(def);
+        store.lookup(ns, key, t, big, n, n);
+        String s(big);
+        free(big);
+        return s;
+    }
+    return opened ? prefs.getString(key, def) : String(def);
+}
+
+size_t NvsReader::getBytesLength(const char* key) {
+    uint8_t t;
+    size_t n;
+    if (ns && store.lookup(ns, key, t, nullptr, 0, n)) {
+        return t == NvsStore::Cache::T_BYTES ? n : 0;
+    }
+    return opened ? prefs.getBytesLength(key) : 0;
+}
+
+size_t NvsReader::getBytes(const char* key, void* out, size_t len) {
+    uint8_t t;
+    size_t n;
+    if (ns && store.lookup(ns, key, t, out, len, n)) {
+        if (t != NvsStore::Cache::T_BYTES || n > len) return 0;
+        return n;
+    }
+    return opened ? prefs.getBytes(key, out, len) : 0;
+}
+
+bool NvsReader::getBool(const char* key, bool def) {
+    uint8_t v;
+    bool removed;
+    if (pendingScalar(key, NvsStore::Cache::T_BOOL, &v, sizeof(v), removed)) {
+        return removed ? def : v != 0;
+    }
+    return opened ? prefs.getBool(key, def) : def;
+}
+
+int32_t NvsReader::getInt(const char* key, int32_t def) {
+    int32_t v;
+    bool removed;
+    if (pendingScalar(key, NvsStore::Cache::T_INT, &v, sizeof(v), removed)) {
+        return removed ? def : v;
+    }
+    return opened ? prefs.getInt(key, def) : def;
+}
+
+uint32_t NvsReader::getUInt(const char* key, uint32_t def) {
+    uint32_t v;
+    bool removed;
+    if (pendingScalar(key, NvsStore::Cache::T_UINT, &v, sizeof(v), removed)) {
+        return removed ? def : v;
+    }
+    return opened ? prefs.getUInt(key, def) : def;
+}
+
+uint16_t NvsReader::getUShort(const char* key, uint16_t def) {
+    uint16_t v;
+    bool removed;
+    if (pendingScalar(key, NvsStore::Cache::T_USHORT, &v, sizeof(v), removed)) {
+        return removed ? def : v;
+    }
+    return opened ? prefs.getUShort(key, def) : def;
+}
+
+float NvsReader::getFloat(const char* key, float def) {
+    float v;
+    bool removed;
+    if (pendingScalar(key, NvsStore::Cache::T_FLOAT, &v, sizeof(v), removed)) {
+        return removed ? def : v;
+    }
+    return opened ? prefs.getFloat(key, def) : def;
+}
+
+bool NvsReader::isKey(const char* key) {
+    uint8_t t;
+    size_t n;
+    if (ns && store.lookup(ns, key, t, nullptr, 0, n)) return t != NvsStore::Cache::T_REMOVE;
+    return opened && prefs.isKey(key);
+}
+
+#endif // UNIT_TESTING
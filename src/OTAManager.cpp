@@ -1,12 +1,19 @@
 #ifndef UNIT_TESTING
 
 #include "OTAManager.h"
+#include "NvsStore.h"
 #include "Logger.h"
 #include "Version.h"
 #include <WiFi.h>
 #include <WiFiClientSecure.h>
 #include <esp_ota_ops.h>
 #include "mbedtls/sha256.h"
+#include "esp32/rom/miniz.h"
+#include "esp32/rom/crc.h"
+#include <esp_attr.h>
+#include "DeltaPatch.h"
+#include "HostPool.h"
+#include "HostResolver.h"
 
 // Full Mozilla root CA bundle, embedded in the firmware by the ESP-IDF mbedTLS
 // component (CONFIG_MBEDTLS_CERTIFICATE_BUNDLE_DEFAULT_FULL=y in the precompiled
@@ -16,12 +23,82 @@
 // and it survives CA rotation on either host.
 extern const uint8_t rootca_crt_bundle_start[] asm("_binary_x509_crt_bundle_start");
 
+// Connect client to url's host at the address HostResolver has cached, so a
+// check or download started while the router's resolver is down still
+// reaches GitHub. HTTPClient sends on a transport that is already
+// connected; the chain is still verified against the bundle and the host
+// name. A redirect, or a failure here, connects by name as before.
+static void preconnect(WiFiClientSecure& client, const char* url) {
+    char host[HostPool::HOST_MAX];
+    uint16_t port;
+    bool secure;
+    IPAddress ip;
+    if (!parseUrlHost(url, host, sizeof(host), port, secure) || !secure) return;
+    if (!HostResolver::getInstance().resolve(host, ip)) return;
+    client.connect(ip, port, host, nullptr, nullptr, nullptr);
+}
+
+// Download progress saved at sector boundaries so an interrupted full-image
+// download can continue with a Range request instead of starting over. The
+// SHA-256 context is a software-mode clone (mbedtls_sha256_clone reads the
+// state out of the hardware engine), so it is plain data that survives a
+// reboot. Kept in RTC memory at every sector (soft resets, brownouts) and in
+// NVS every OTA_RESUME_NVS_STRIDE bytes (power loss).
+struct OtaResumePoint {
+    uint32_t magic;
+    uint32_t partAddr;          // inactive slot the prefix was written to
+    uint32_t size;              // full image size
+    uint32_t offset;            // bytes on flash, a whole number of sectors
+    char     sha256[65];        // release digest the download belongs to
+    uint8_t  header[16];        // held-back image header (see ImageWriter)
+    mbedtls_sha256_context sha; // over [0, offset)
+    uint32_t crc;
+};
+
+static constexpr uint32_t OTA_RESUME_MAGIC = 0x4f545252; // "OTRR"
+static constexpr const char OTA_RESUME_KEY[] = "resume";
+RTC_NOINIT_ATTR static OtaResumePoint rtcResume;
+
+static uint32_t resumeCrc(const OtaResumePoint& r) {
+    return crc32_le(0, (const uint8_t*)&r, offsetof(OtaResumePoint, crc));
+}
+
+static bool resumeValid(const OtaResumePoint& r) {
+    return r.magic == OTA_RESUME_MAGIC && r.crc == resumeCrc(r);
+}
+
+// RTC copy first (newest), then NVS
+static bool loadResumePoint(OtaResumePoint& out) {
+    if (resumeValid(rtcResume)) {
+        out = rtcResume;
+        return true;
+    }
+    NvsReader nvs;
+    if (!nvs.begin(OTA_PREFERENCES_NAMESPACE)) return false;
+    if (nvs.getBytesLength(OTA_RESUME_KEY) != sizeof(out)) return false;
+    nvs.getBytes(OTA_RESUME_KEY, &out, sizeof(out));
+    return resumeValid(out);
+}
+
+static void saveResumePoint(OtaResumePoint& r, bool durable) {
+    r.magic = OTA_RESUME_MAGIC;
+    r.crc = resumeCrc(r);
+    rtcResume = r;
+    if (durable) {
+        NvsStore::getInstance().putBytes(OTA_PREFERENCES_NAMESPACE, OTA_RESUME_KEY, &r, sizeof(r));
+    }
+}
+
+static void clearResumePoint() {
+    rtcResume.magic = 0;
+    NvsStore::getInstance().remove(OTA_PREFERENCES_NAMESPACE, OTA_RESUME_KEY);
+}
+
 OTAManager::OTAManager(NotificationWorker* notif)
-    : notifier(notif), currentState(OTAState::IDLE),
-      lastCheckTime(0),
+    : notifier(notif), currentState(OTAState::IDLE), currentVersion(FIRMWARE_VERSION),
+      config(), versionInfo(), installInfo(), lastCheckTime(0), lastError(), release(), fresh(),
       stateMux(nullptr), checkTaskHandle(nullptr), checkRequested(false) {
 
-    versionInfo.currentVersion = FIRMWARE_VERSION;
     stateMux = xSemaphoreCreateMutex();
 }
 
@@ -38,7 +115,7 @@ OTAManager::~OTAManager() {
 }
 
 void OTAManager::begin() {
-    LOG_INFO("[OTA] Initializing OTA Manager v%s", versionInfo.currentVersion.c_str());
+    LOG_INFO("[OTA] Initializing OTA Manager v%s", currentVersion);
 
     // Recover from any interrupted update state (device rebooted during update).
     // Runs single-threaded before the check task is spawned, so no lock needed.
@@ -48,7 +125,7 @@ void OTAManager::begin() {
         bootState == OTAState::CHECKING) {
         LOG_INFO("[OTA] Recovering from interrupted update state");
         currentState.store(OTAState::IDLE);
-        lastError = "Update interrupted by reboot";
+        strlcpy(lastError, "Update interrupted by reboot", sizeof(lastError));
     } else if (bootState == OTAState::FAILED) {
         LOG_INFO("[OTA] Clearing previous FAILED state on boot");
         currentState.store(OTAState::IDLE);
@@ -60,7 +137,7 @@ void OTAManager::begin() {
     // Check if this is first boot after update (may call sendNotification)
     checkFirstBoot();
 
-    LOG_INFO("[OTA] GitHub Repo: %s/%s", config.githubOwner.c_str(), config.githubRepo.c_str());
+    LOG_INFO("[OTA] GitHub Repo: %s/%s", config.githubOwner, config.githubRepo);
     LOG_INFO("[OTA] Auto-check: %s (interval: %lu hours)",
              config.autoCheckEnabled ? "enabled" : "disabled",
              config.checkIntervalMs / MS_PER_HOUR);
@@ -156,6 +233,14 @@ void OTAManager::runCheckTask() {
     }
 }
 
+// Preferences::getString(key, buf, len) reads straight into a fixed buffer;
+// it returns 0 for a missing key or a value that doesn't fit.
+static void getStringOr(Preferences& prefs, const char* key, char* out, size_t len, const char* fallback) {
+    if (prefs.getString(key, out, len) == 0) {
+        strlcpy(out, fallback, len);
+    }
+}
+
 void OTAManager::checkFirstBoot() {
     // Read update-pending state from NVS (read-only open).
     if (!preferences.begin(OTA_PREFERENCES_NAMESPACE, true)) {
@@ -163,9 +248,11 @@ void OTAManager::checkFirstBoot() {
         return;
     }
 
-    bool updatePending    = preferences.getBool("upd_pending", false);
-    String prevVersion    = preferences.getString("prev_version", "");
-    String targetVersion  = preferences.getString("target_version", "");
+    bool updatePending = preferences.getBool("upd_pending", false);
+    char prevVersion[OTA_VERSION_MAX];
+    char targetVersion[OTA_VERSION_MAX];
+    getStringOr(preferences, "prev_version", prevVersion, sizeof(prevVersion), "");
+    getStringOr(preferences, "target_version", targetVersion, sizeof(targetVersion), "");
 
     preferences.end();
 
@@ -196,18 +283,18 @@ void OTAManager::checkFirstBoot() {
 
     // Compare the running version against the target we recorded before
     // rebooting. Match = successful update; mismatch = real rollback.
-    if (versionInfo.currentVersion == targetVersion) {
+    if (strcmp(currentVersion, targetVersion) == 0) {
         char msg[NOTIFICATION_MESSAGE_BUFFER_SIZE];
         snprintf(msg, sizeof(msg),
                  "BilgeRise: Firmware updated successfully! v%s -> v%s. System online.",
-                 prevVersion.c_str(), versionInfo.currentVersion.c_str());
+                 prevVersion, currentVersion);
         sendNotification(msg);
         LOG_INFO("[OTA] %s", msg);
     } else {
         char msg[NOTIFICATION_MESSAGE_BUFFER_SIZE];
         snprintf(msg, sizeof(msg),
                  "BilgeRise: New firmware v%s failed to boot. Rolled back to v%s. System stable.",
-                 targetVersion.c_str(), versionInfo.currentVersion.c_str());
+                 targetVersion, currentVersion);
         sendNotification(msg);
         LOG_CRITICAL("[OTA] %s", msg);
     }
@@ -221,8 +308,8 @@ void OTAManager::setFirstBootFlag() {
     }
 
     preferences.putBool("upd_pending", true);
-    preferences.putString("prev_version", versionInfo.currentVersion);   // version running now (old)
-    preferences.putString("target_version", versionInfo.availableVersion); // version being installed
+    preferences.putString("prev_version", currentVersion);               // version running now (old)
+    preferences.putString("target_version", installInfo.availableVersion); // version being installed
     preferences.end();
 }
 
@@ -248,10 +335,10 @@ void OTAManager::loadConfig() {
         return;
     }
 
-    config.githubOwner = preferences.getString("gh_owner", "Robert336");
-    config.githubRepo = preferences.getString("gh_repo", "BoatReporterESP");
-    config.githubToken = preferences.getString("gh_token", "");
-    config.updatePassword = preferences.getString("password", "");
+    getStringOr(preferences, "gh_owner", config.githubOwner, sizeof(config.githubOwner), "Robert336");
+    getStringOr(preferences, "gh_repo", config.githubRepo, sizeof(config.githubRepo), "BoatReporterESP");
+    getStringOr(preferences, "gh_token", config.githubToken, sizeof(config.githubToken), "");
+    getStringOr(preferences, "password", config.updatePassword, sizeof(config.updatePassword), "");
     config.autoCheckEnabled = preferences.getBool("auto_check", true);
     config.autoInstallEnabled = preferences.getBool("auto_install", true);
     config.checkIntervalMs = preferences.getULong("check_interval", DEFAULT_CHECK_INTERVAL_MS);
@@ -261,6 +348,16 @@ void OTAManager::loadConfig() {
     // millis()) makes the timestamp survive reboots and 49-day millis() wraps.
     lastCheckTime = preferences.getULong("last_check_epoch", 0);
 
+    getStringOr(preferences, "rel_etag", release.etag, sizeof(release.etag), "");
+    getStringOr(preferences, "rel_lmod", release.lastModified, sizeof(release.lastModified), "");
+    getStringOr(preferences, "rel_for", release.forVersion, sizeof(release.forVersion), "");
+    getStringOr(preferences, "rel_ver", release.version, sizeof(release.version), "");
+    getStringOr(preferences, "rel_url", release.downloadUrl, sizeof(release.downloadUrl), "");
+    release.firmwareSize = preferences.getULong("rel_size", 0);
+    getStringOr(preferences, "rel_sha", release.firmwareHash, sizeof(release.firmwareHash), "");
+    getStringOr(preferences, "rel_durl", release.deltaUrl, sizeof(release.deltaUrl), "");
+    release.deltaSize    = preferences.getULong("rel_dsize", 0);
+
     preferences.end();
 
     // Migration: clamp any pre-existing interval below the NVS-wear floor (12h)
@@ -274,29 +371,46 @@ void OTAManager::loadConfig() {
 }
 
 void OTAManager::saveConfig() {
-    if (!preferences.begin(OTA_PREFERENCES_NAMESPACE, false)) {
-        LOG_CRITICAL("[OTA] Failed to open preferences for writing");
-        return;
+    // Write-behind (NvsStore.h): the settings handlers call this once per
+    // setter, and the batch commits once. The boot/rollback flags below stay
+    // on direct Preferences — they must be in flash before the reboot.
+    NvsStore& nvs = NvsStore::getInstance();
+    const char* ns = OTA_PREFERENCES_NAMESPACE;
+    if (xSemaphoreTake(stateMux, pdMS_TO_TICKS(100)) == pdTRUE) {
+        nvs.putString(ns, "gh_owner", config.githubOwner);
+        nvs.putString(ns, "gh_repo", config.githubRepo);
+        nvs.putString(ns, "gh_token", config.githubToken);
+        nvs.putString(ns, "password", config.updatePassword);
+        xSemaphoreGive(stateMux);
     }
-
-    preferences.putString("gh_owner", config.githubOwner);
-    preferences.putString("gh_repo", config.githubRepo);
-    preferences.putString("gh_token", config.githubToken);
-    preferences.putString("password", config.updatePassword);
-    preferences.putBool("auto_check", config.autoCheckEnabled);
-    preferences.putBool("auto_install", config.autoInstallEnabled);
-    preferences.putULong("check_interval", config.checkIntervalMs);
-    preferences.putBool("notify", config.notificationsEnabled);
+    nvs.putBool(ns, "auto_check", config.autoCheckEnabled);
+    nvs.putBool(ns, "auto_install", config.autoInstallEnabled);
+    nvs.putUInt(ns, "check_interval", config.checkIntervalMs);
+    nvs.putBool(ns, "notify", config.notificationsEnabled);
     // Only write the epoch when a check has actually completed (non-zero).
     // saveConfig() is called from setters that don't run a check; writing 0
     // here would erase a valid timestamp from a prior session.
     if (lastCheckTime > 0) {
-        preferences.putULong("last_check_epoch", lastCheckTime);
+        nvs.putUInt(ns, "last_check_epoch", lastCheckTime);
     }
 
-    preferences.end();
+    LOG_INFO("[OTA] Configuration saved (NVS commit queued)");
+}
 
-    LOG_INFO("[OTA] Configuration saved to NVS");
+// Called only when a 200 brought a different release (or validators), so a
+// check that ends in 304 writes nothing but last_check_epoch
+void OTAManager::saveRelease() {
+    NvsStore& nvs = NvsStore::getInstance();
+    const char* ns = OTA_PREFERENCES_NAMESPACE;
+    nvs.putString(ns, "rel_etag", release.etag);
+    nvs.putString(ns, "rel_lmod", release.lastModified);
+    nvs.putString(ns, "rel_for", release.forVersion);
+    nvs.putString(ns, "rel_ver", release.version);
+    nvs.putString(ns, "rel_url", release.downloadUrl);
+    nvs.putUInt(ns, "rel_size", release.firmwareSize);
+    nvs.putString(ns, "rel_sha", release.firmwareHash);
+    nvs.putString(ns, "rel_durl", release.deltaUrl);
+    nvs.putUInt(ns, "rel_dsize", release.deltaSize);
 }
 
 // Route all OTA notifications through NotificationWorker so they run on the
@@ -305,35 +419,60 @@ void OTAManager::sendNotification(const char* message) {
     if (!config.notificationsEnabled || !notifier) {
         return;
     }
-    notifier->enqueue(message);
+    notifier->enqueue(message, CHAN_ALL, NOTIFY_OTA);
 }
 
-// lastError is a heap-backed String written by the check task (Core 0) and the
-// loop task (Core 1) and read by the web-server task. Every access goes through
-// stateMux so a reader never copies the String while a writer reallocates it.
-void OTAManager::setError(const String& msg) {
+// lastError is written by the check task (Core 0) and the loop task (Core 1)
+// and read by the web-server task. Every access goes through stateMux so a
+// reader never copies a message that is half rewritten.
+void OTAManager::setError(const char* fmt, ...) {
     if (xSemaphoreTake(stateMux, pdMS_TO_TICKS(100)) == pdTRUE) {
-        lastError = msg;
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(lastError, sizeof(lastError), fmt, args);
+        va_end(args);
         xSemaphoreGive(stateMux);
     }
 }
 
-String OTAManager::getLastError() const {
-    String copy;
+// The getters copy under stateMux into the caller's buffer; "" if the mutex
+// can't be had within 100 ms
+void OTAManager::getLastError(char* out, size_t len) const {
+    if (!out || len == 0) return;
+    out[0] = '\0';
     if (xSemaphoreTake(stateMux, pdMS_TO_TICKS(100)) == pdTRUE) {
-        copy = lastError;
+        strlcpy(out, lastError, len);
         xSemaphoreGive(stateMux);
     }
-    return copy;
 }
 
-String OTAManager::getAvailableVersion() const {
-    String copy;
+void OTAManager::getAvailableVersion(char* out, size_t len) const {
+    if (!out || len == 0) return;
+    out[0] = '\0';
     if (xSemaphoreTake(stateMux, pdMS_TO_TICKS(100)) == pdTRUE) {
-        copy = versionInfo.availableVersion;
+        strlcpy(out, versionInfo.availableVersion, len);
         xSemaphoreGive(stateMux);
     }
-    return copy;
+}
+
+void OTAManager::getGitHubRepo(char* out, size_t len) const {
+    if (!out || len == 0) return;
+    out[0] = '\0';
+    if (xSemaphoreTake(stateMux, pdMS_TO_TICKS(100)) == pdTRUE) {
+        snprintf(out, len, "%s/%s", config.githubOwner, config.githubRepo);
+        xSemaphoreGive(stateMux);
+    }
+}
+
+bool OTAManager::authHeader(char* out, size_t len) const {
+    out[0] = '\0';
+    if (xSemaphoreTake(stateMux, pdMS_TO_TICKS(100)) == pdTRUE) {
+        if (config.githubToken[0]) {
+            snprintf(out, len, "Bearer %s", config.githubToken);
+        }
+        xSemaphoreGive(stateMux);
+    }
+    return out[0] != '\0';
 }
 
 unsigned long OTAManager::getTimeSinceLastCheckS() {
@@ -351,6 +490,82 @@ bool OTAManager::manualCheckForUpdates() {
     return true;
 }
 
+// Read tag_name and the assets we use out of a releases/latest response
+// without reading the rest of it. GitHub sends tag_name before "assets" and
+// the release notes (often most of the body) after it, so each asset is
+// parsed on its own and the parse stops at the end of the array, or sooner
+// once firmware.bin and this version's delta are both in hand. The caller
+// then drops the connection. A value too long for its ReleaseInfo buffer
+// is left empty rather than cut.
+static bool copyField(char* out, size_t len, const char* value) {
+    if (value && strlcpy(out, value, len) < len) return true;
+    out[0] = '\0';
+    return false;
+}
+
+static bool parseRelease(Stream& stream, const char* deltaName, ReleaseInfo& out, const char*& err) {
+    StaticJsonDocument<96> tag;
+    if (!stream.find("\"tag_name\"") || !stream.find(':') ||
+        deserializeJson(tag, stream) || !tag.is<const char*>()) {
+        err = "No tag_name in release";
+        return false;
+    }
+    const char* version = tag.as<const char*>();
+    if (version[0] == 'v') version++;
+    if (!copyField(out.version, sizeof(out.version), version)) {
+        err = "Release tag_name too long";
+        return false;
+    }
+
+    err = "No firmware.bin found in release";
+    if (!stream.find("\"assets\"") || !stream.find('[')) {
+        return false;
+    }
+
+    StaticJsonDocument<96> filter;
+    filter["name"]                 = true;
+    filter["browser_download_url"] = true;
+    filter["size"]                 = true;
+    filter["digest"]               = true;
+
+    // One asset: URL ~120B + name ~30B + size + "sha256:"+64 hex
+    StaticJsonDocument<512> asset;
+    for (;;) {
+        // An empty array fails here too
+        if (deserializeJson(asset, stream, DeserializationOption::Filter(filter))) break;
+
+        const char* name = asset["name"];
+        const char* url  = asset["browser_download_url"];
+        if (name && strcmp(name, deltaName) == 0) {
+            // An unusable delta only costs the full download
+            if (copyField(out.deltaUrl, sizeof(out.deltaUrl), url)) {
+                out.deltaSize = asset["size"];
+            }
+        } else if (name && strcmp(name, "firmware.bin") == 0) {
+            if (!copyField(out.downloadUrl, sizeof(out.downloadUrl), url)) {
+                err = "firmware.bin URL too long";
+                return false;
+            }
+            out.firmwareSize = asset["size"];
+            // GitHub returns "digest":"sha256:<hex>" on release assets. Strip the
+            // algorithm prefix so we keep the bare 64-char hex digest.
+            const char* digest = asset["digest"];
+            if (digest) {
+                const char* colon = strchr(digest, ':');
+                copyField(out.firmwareHash, sizeof(out.firmwareHash), colon ? colon + 1 : digest);
+            }
+        }
+        if (out.downloadUrl[0] && out.deltaUrl[0]) break;
+        if (!stream.findUntil(",", "]")) break;
+    }
+    return out.downloadUrl[0] != '\0';
+}
+
+static bool sameRelease(const ReleaseInfo& a, const ReleaseInfo& b) {
+    return strcmp(a.etag, b.etag) == 0 && strcmp(a.lastModified, b.lastModified) == 0 &&
+           strcmp(a.version, b.version) == 0 && strcmp(a.forVersion, b.forVersion) == 0;
+}
+
 bool OTAManager::checkForUpdates() {
     // Check WiFi connectivity first
     if (!WiFi.isConnected()) {
@@ -359,7 +574,17 @@ bool OTAManager::checkForUpdates() {
         return false;
     }
 
-    if (config.githubOwner.isEmpty() || config.githubRepo.isEmpty()) {
+    // Build GitHub API URL
+    char url[OTA_URL_MAX];
+    url[0] = '\0';
+    if (xSemaphoreTake(stateMux, pdMS_TO_TICKS(100)) == pdTRUE) {
+        if (config.githubOwner[0] && config.githubRepo[0]) {
+            snprintf(url, sizeof(url), "https://api.github.com/repos/%s/%s/releases/latest",
+                     config.githubOwner, config.githubRepo);
+        }
+        xSemaphoreGive(stateMux);
+    }
+    if (!url[0]) {
         setError("GitHub repository not configured");
         currentState.store(OTAState::IDLE);
         return false;
@@ -384,10 +609,6 @@ bool OTAManager::checkForUpdates() {
 
     LOG_INFO("[OTA] Checking for updates from GitHub...");
 
-    // Build GitHub API URL
-    String url = "https://api.github.com/repos/" + config.githubOwner + "/" +
-                 config.githubRepo + "/releases/latest";
-
     // Verify the TLS chain against the embedded Mozilla root bundle. No insecure
     // fallback — a failed handshake fails the check rather than trusting the peer.
     WiFiClientSecure client;
@@ -399,12 +620,30 @@ bool OTAManager::checkForUpdates() {
         currentState.store(OTAState::FAILED);
         return false;
     }
+    preconnect(client, url);
     http.setTimeout(API_TIMEOUT_MS);
     http.addHeader("User-Agent", "ESP32-BilgeRise");
 
-    if (!config.githubToken.isEmpty()) {
-        http.addHeader("Authorization", "Bearer " + config.githubToken);
+    // HTTPClient keeps its headers in Strings of its own; those go with it
+    // when the check returns
+    char auth[OTA_TOKEN_MAX + 8];
+    if (authHeader(auth, sizeof(auth))) {
+        http.addHeader("Authorization", auth);
+    }
+
+    // Conditional request: GitHub answers 304 with no body when the release
+    // is unchanged, and 304s don't count against the rate limit. The cached
+    // delta match is only valid for the version that's running now.
+    bool haveCached = release.version[0] && release.downloadUrl[0] &&
+                      strcmp(release.forVersion, currentVersion) == 0;
+    if (haveCached && release.etag[0]) {
+        http.addHeader("If-None-Match", release.etag);
+    }
+    if (haveCached && release.lastModified[0]) {
+        http.addHeader("If-Modified-Since", release.lastModified);
     }
+    static const char* validatorHeaders[] = { "ETag", "Last-Modified" };
+    http.collectHeaders(validatorHeaders, 2);
 
     int httpCode = http.GET();
 
@@ -412,96 +651,63 @@ bool OTAManager::checkForUpdates() {
         const char* e = "GitHub API rate limited - try again later";
         LOG_INFO("[OTA] %s", e);
         http.end();
-        setError(e);
+        setError("%s", e);
         currentState.store(OTAState::FAILED);
         return false;
     }
 
-    if (httpCode != HTTP_CODE_OK) {
+    if (httpCode == HTTP_NOT_MODIFIED && haveCached) {
+        http.end();
+        LOG_INFO("[OTA] Release unchanged since the last check (HTTP 304)");
+    } else if (httpCode == HTTP_CODE_OK) {
+        // --- P4: only tag_name and the assets are read (parseRelease) ---
+        // A validator too long to keep is dropped: the next check is then
+        // unconditional, which is only slower
+        memset(&fresh, 0, sizeof(fresh));
+        copyField(fresh.etag, sizeof(fresh.etag), http.header("ETag").c_str());
+        copyField(fresh.lastModified, sizeof(fresh.lastModified), http.header("Last-Modified").c_str());
+        strlcpy(fresh.forVersion, currentVersion, sizeof(fresh.forVersion));
+        char deltaName[OTA_VERSION_MAX + 24];
+        snprintf(deltaName, sizeof(deltaName), "firmware-from-%s.delta", currentVersion);
+        const char* err = nullptr;
+        bool parsed = parseRelease(*http.getStreamPtr(), deltaName, fresh, err);
+        http.end();             // drops the unread rest of the body
+
+        if (!parsed) {
+            LOG_INFO("[OTA] %s", err);
+            setError("%s", err);
+            currentState.store(OTAState::FAILED);
+            return false;
+        }
+        if (!sameRelease(fresh, release)) {
+            release = fresh;
+            saveRelease();
+        }
+    } else {
         LOG_INFO("[OTA] GitHub API request failed: %d", httpCode);
         http.end();
-        setError("GitHub API request failed: " + String(httpCode));
-        currentState.store(OTAState::FAILED);
-        return false;
-    }
-
-    // --- P4: Filtered ArduinoJson parse — only fields we need are buffered ---
-    // Filter: keep tag_name and assets[].{name,browser_download_url,size,digest}
-    StaticJsonDocument<160> filter;
-    filter["tag_name"] = true;
-    JsonObject assetFilter = filter["assets"].createNestedObject();
-    assetFilter["name"]                 = true;
-    assetFilter["browser_download_url"] = true;
-    assetFilter["size"]                 = true;
-    assetFilter["digest"]               = true;
-
-    // Payload document: tag_name + a few asset entries (each ~URL 120B + name 20B +
-    // size 8B + digest "sha256:"+64hex ~72B). 1 KB leaves headroom for releases
-    // that carry several assets alongside firmware.bin.
-    StaticJsonDocument<1024> doc;
-    DeserializationError error = deserializeJson(doc, *http.getStreamPtr(),
-                                                 DeserializationOption::Filter(filter));
-    http.end();
-
-    if (error) {
-        LOG_INFO("[OTA] Failed to parse GitHub API response: %s", error.c_str());
-        setError("Failed to parse GitHub API response");
-        currentState.store(OTAState::FAILED);
-        return false;
-    }
-
-    // Extract version and download URL
-    const char* tag_name = doc["tag_name"];
-    if (!tag_name) {
-        LOG_INFO("[OTA] No tag_name in release");
-        setError("No tag_name in release");
+        setError("GitHub API request failed: %d", httpCode);
         currentState.store(OTAState::FAILED);
         return false;
     }
 
-    String latestVersion = String(tag_name);
-    if (latestVersion.startsWith("v")) {
-        latestVersion = latestVersion.substring(1);
-    }
-
-    // Find firmware.bin asset (and capture its SHA256 digest for verification)
-    JsonArray assets = doc["assets"];
-    String downloadUrl = "";
-    String firmwareSha256 = "";
-    size_t firmwareSize = 0;
-
-    for (JsonObject asset : assets) {
-        const char* name = asset["name"];
-        if (name && String(name) == "firmware.bin") {
-            downloadUrl = String(asset["browser_download_url"].as<const char*>());
-            firmwareSize = asset["size"];
-            // GitHub returns "digest":"sha256:<hex>" on release assets. Strip the
-            // algorithm prefix so we keep the bare 64-char hex digest.
-            const char* digest = asset["digest"];
-            if (digest) {
-                String d = String(digest);
-                int colon = d.indexOf(':');
-                firmwareSha256 = (colon >= 0) ? d.substring(colon + 1) : d;
-            }
-            break;
-        }
-    }
-
-    if (downloadUrl.isEmpty()) {
-        LOG_INFO("[OTA] No firmware.bin found in release");
-        setError("No firmware.bin found in release");
-        currentState.store(OTAState::FAILED);
-        return false;
-    }
+    const char* latestVersion  = release.version;
+    const char* downloadUrl    = release.downloadUrl;
+    const char* firmwareSha256 = release.firmwareHash;
+    const char* deltaUrl       = release.deltaUrl;
+    size_t firmwareSize        = release.firmwareSize;
+    size_t deltaSize           = release.deltaSize;
 
     // Compare versions and update state
-    bool updateAvailable = compareVersions(latestVersion, versionInfo.currentVersion);
+    bool updateAvailable = compareVersions(latestVersion, currentVersion);
 
     if (xSemaphoreTake(stateMux, pdMS_TO_TICKS(100)) == pdTRUE) {
-        versionInfo.availableVersion = latestVersion;
-        versionInfo.downloadUrl      = downloadUrl;
-        versionInfo.firmwareSize     = firmwareSize;
-        versionInfo.firmwareHash     = firmwareSha256;
+        strlcpy(versionInfo.availableVersion, latestVersion, sizeof(versionInfo.availableVersion));
+        strlcpy(versionInfo.downloadUrl, downloadUrl, sizeof(versionInfo.downloadUrl));
+        versionInfo.firmwareSize = firmwareSize;
+        strlcpy(versionInfo.firmwareHash, firmwareSha256, sizeof(versionInfo.firmwareHash));
+        strlcpy(versionInfo.deltaUrl, deltaUrl, sizeof(versionInfo.deltaUrl));
+        versionInfo.deltaSize    = deltaSize;
         xSemaphoreGive(stateMux);
     }
     currentState.store(updateAvailable ? OTAState::UPDATE_AVAILABLE : OTAState::IDLE);
@@ -510,22 +716,25 @@ bool OTAManager::checkForUpdates() {
         char msg[SHORT_MESSAGE_BUFFER_SIZE];
         snprintf(msg, sizeof(msg),
                  "BilgeRise: Firmware update available v%s -> v%s",
-                 versionInfo.currentVersion.c_str(), latestVersion.c_str());
+                 currentVersion, latestVersion);
         sendNotification(msg);
         LOG_INFO("[OTA] %s", msg);
-        LOG_INFO("[OTA] Download URL: %s", downloadUrl.c_str());
+        LOG_INFO("[OTA] Download URL: %s", downloadUrl);
         LOG_INFO("[OTA] Size: %u bytes", firmwareSize);
-        if (firmwareSha256.isEmpty()) {
+        if (deltaUrl[0]) {
+            LOG_INFO("[OTA] Delta patch available: %u bytes", deltaSize);
+        }
+        if (!firmwareSha256[0]) {
             LOG_CRITICAL("[OTA] WARNING: release has no SHA256 digest — install will be refused");
         }
     } else {
-        LOG_INFO("[OTA] Already on latest version v%s", versionInfo.currentVersion.c_str());
+        LOG_INFO("[OTA] Already on latest version v%s", currentVersion);
     }
 
     return updateAvailable;
 }
 
-bool OTAManager::compareVersions(const String& newVer, const String& currentVer) {
+bool OTAManager::compareVersions(const char* newVer, const char* currentVer) {
     int newMajor = parseVersionComponent(newVer, 0);
     int newMinor = parseVersionComponent(newVer, 1);
     int newPatch = parseVersionComponent(newVer, 2);
@@ -543,21 +752,15 @@ bool OTAManager::compareVersions(const String& newVer, const String& currentVer)
     return newPatch > curPatch;
 }
 
-int OTAManager::parseVersionComponent(const String& version, int component) {
-    int start = 0;
-    int componentIndex = 0;
-
-    for (int i = 0; i <= version.length(); i++) {
-        if (i == version.length() || version[i] == '.') {
-            if (componentIndex == component) {
-                return version.substring(start, i).toInt();
-            }
-            componentIndex++;
-            start = i + 1;
-        }
+int OTAManager::parseVersionComponent(const char* version, int component) {
+    const char* p = version;
+    for (int i = 0; i < component; i++) {
+        p = strchr(p, '.');
+        if (!p) return 0;
+        p++;
     }
-
-    return 0;
+    // atoi() stops at the next '.', like String::toInt() on the component
+    return atoi(p);
 }
 
 bool OTAManager::startUpdate(const char* password) {
@@ -569,12 +772,16 @@ bool OTAManager::startUpdate(const char* password) {
 
     // Check password if configured (validated here so the caller gets an
     // immediate failure response instead of an async one).
-    if (!config.updatePassword.isEmpty()) {
-        if (!password || config.updatePassword != String(password)) {
-            setError("Invalid password");
-            LOG_INFO("[OTA] Update blocked: Invalid password");
-            return false;
-        }
+    bool passwordOk = false;
+    if (xSemaphoreTake(stateMux, pdMS_TO_TICKS(100)) == pdTRUE) {
+        passwordOk = !config.updatePassword[0] ||
+                     (password && strcmp(config.updatePassword, password) == 0);
+        xSemaphoreGive(stateMux);
+    }
+    if (!passwordOk) {
+        setError("Invalid password");
+        LOG_INFO("[OTA] Update blocked: Invalid password");
+        return false;
     }
 
     // Hand the install to the check task — see runCheckTask() for why the
@@ -601,20 +808,21 @@ bool OTAManager::executeUpdate(const char* password) {
     }
 
     // Snapshot the version info under the mutex so a subsequent check can't
-    // mutate these Strings out from under us mid-update.
-    String url, expectedHash, availVer, curVer;
-    size_t fwSize = 0;
+    // rewrite it mid-update. installInfo is a member, not a local: it keeps
+    // ~600 B of strings off the stack the TLS handshake runs on.
+    memset(&installInfo, 0, sizeof(installInfo));
     if (xSemaphoreTake(stateMux, pdMS_TO_TICKS(100)) == pdTRUE) {
-        url          = versionInfo.downloadUrl;
-        expectedHash = versionInfo.firmwareHash;
-        availVer     = versionInfo.availableVersion;
-        curVer       = versionInfo.currentVersion;
-        fwSize       = versionInfo.firmwareSize;
+        installInfo = versionInfo;
         xSemaphoreGive(stateMux);
     }
+    const char* url          = installInfo.downloadUrl;
+    const char* expectedHash = installInfo.firmwareHash;
+    const char* availVer     = installInfo.availableVersion;
+    const char* deltaUrl     = installInfo.deltaUrl;
+    size_t fwSize            = installInfo.firmwareSize;
 
     // Fail closed: never flash firmware we can't verify against a known digest.
-    if (expectedHash.isEmpty()) {
+    if (!expectedHash[0]) {
         setError("No SHA256 digest in release - refusing to flash unverified firmware");
         LOG_CRITICAL("[OTA] No SHA256 digest in release - refusing to flash unverified firmware");
         currentState.store(OTAState::FAILED);
@@ -655,11 +863,36 @@ bool OTAManager::executeUpdate(const char* password) {
     char msg[NOTIFICATION_MESSAGE_BUFFER_SIZE];
     snprintf(msg, sizeof(msg),
              "BilgeRise: Starting firmware update from v%s to v%s. Device may be offline for 1-2 minutes.",
-             curVer.c_str(), availVer.c_str());
+             currentVersion, availVer);
     sendNotification(msg);
     LOG_INFO("[OTA] %s", msg);
 
-    bool success = downloadAndInstall(url, fwSize, expectedHash);
+    // A delta is tried first; if it can't be applied (different base image,
+    // no heap for the inflate window, a bad patch) the full image still can.
+    // Both are checked against the same firmware.bin digest.
+    // An interrupted full download of this release is resumed instead: the
+    // delta would overwrite the sectors it already put in the slot.
+    bool success = false;
+    bool fullImage = true;
+    OtaResumePoint saved;
+    if (deltaUrl[0] && loadResumePoint(saved) && strcasecmp(expectedHash, saved.sha256) == 0) {
+        LOG_INFO("[OTA] Resuming the interrupted full download (%u/%u bytes) instead of the delta",
+                 (unsigned)saved.offset, (unsigned)saved.size);
+    } else if (deltaUrl[0]) {
+        success = downloadAndInstallDelta(deltaUrl, fwSize, expectedHash);
+        if (!success) {
+            // Not after a flood abort: that one has to stand
+            fullImage = !(floodCheckCb && floodCheckCb(floodCheckCtx));
+            if (fullImage) {
+                char why[OTA_ERROR_MAX];
+                getLastError(why, sizeof(why));
+                LOG_INFO("[OTA] Delta update failed (%s) - downloading the full image", why);
+            }
+        }
+    }
+    if (!success && fullImage) {
+        success = downloadAndInstall(url, fwSize, expectedHash);
+    }
 
     if (success) {
         setFirstBootFlag();
@@ -669,9 +902,11 @@ bool OTAManager::executeUpdate(const char* password) {
     } else {
         currentState.store(OTAState::FAILED);
 
+        char why[OTA_ERROR_MAX];
+        getLastError(why, sizeof(why));
         snprintf(msg, sizeof(msg),
                  "BilgeRise: Firmware update FAILED - %s. Still running v%s.",
-                 getLastError().c_str(), curVer.c_str());
+                 why, currentVersion);
         sendNotification(msg);
         LOG_CRITICAL("[OTA] %s", msg);
     }
@@ -679,15 +914,242 @@ bool OTAManager::executeUpdate(const char* password) {
     return success;
 }
 
-bool OTAManager::downloadAndInstall(const String& url, size_t expectedSize, const String& expectedSha256) {
+// Everything written to the inactive slot goes through an ImageWriter, with a
+// running SHA-256 of the image so it can be checked against the release digest
+// BEFORE the slot is committed. Shared by the full and the delta path.
+//
+// It writes the partition directly rather than through Update, which loses its
+// place on abort(). Bytes are staged one flash sector at a time; a full sector
+// is erased, written and hashed in one step, so `flushed` and `sha` always
+// cover the same prefix and can be checkpointed. Like Update, the first 16
+// bytes (image magic) stay erased until finish(), so a half-written slot never
+// looks bootable.
+struct OTAManager::ImageWriter {
+    static constexpr size_t HEADER_HOLD = 16;
+
+    const esp_partition_t* part = nullptr;
+    mbedtls_sha256_context sha;
+    uint8_t* sector = nullptr;  // staging, one flash sector
+    size_t   fill = 0;
+    size_t   size = 0;
+    size_t   written = 0;       // accepted (staged or on flash)
+    size_t   flushed = 0;       // on flash and in `sha`
+    size_t   lastDurable = 0;
+    uint8_t  header[HEADER_HOLD];
+    bool     open = false;
+    // Full-image downloads set the release digest: each sector is then
+    // checkpointed as an OtaResumePoint for that digest
+    const char* resumeSha = nullptr;
+
+    ~ImageWriter() { close(); }
+
+    bool prepare(size_t imageSize) {
+        part = esp_ota_get_next_update_partition(nullptr);
+        if (!part || imageSize > part->size) return false;
+        if (!sector) sector = (uint8_t*)malloc(SPI_FLASH_SEC_SIZE);
+        size = imageSize;
+        return sector != nullptr;
+    }
+
+    bool begin(size_t imageSize) {
+        clearResumePoint();     // the slot is about to be rewritten
+        if (!prepare(imageSize)) return false;
+        mbedtls_sha256_init(&sha);
+        mbedtls_sha256_starts_ret(&sha, 0); // 0 = SHA-256 (not SHA-224)
+        written = flushed = fill = lastDurable = 0;
+        open = true;
+        return true;
+    }
+
+    // Continue from a checkpoint. The flashed prefix is hashed again first,
+    // so a slot rewritten since (a delta attempt, a USB flash) is caught
+    // before anything is appended to it.
+    bool resume(const OtaResumePoint& r) {
+        if (!prepare(r.size) || part->address != r.partAddr ||
+            r.offset > r.size || r.offset % SPI_FLASH_SEC_SIZE) {
+            return false;
+        }
+        mbedtls_sha256_context check;
+        mbedtls_sha256_init(&check);
+        mbedtls_sha256_starts_ret(&check, 0);
+        uint8_t buf[OTA_BUFFER_SIZE];
+        for (uint32_t off = 0; off < r.offset; off += sizeof(buf)) {
+            if (esp_partition_read(part, off, buf, sizeof(buf)) != ESP_OK) {
+                mbedtls_sha256_free(&check);
+                return false;
+            }
+            if (off == 0) memcpy(buf, r.header, HEADER_HOLD);
+            mbedtls_sha256_update_ret(&check, buf, sizeof(buf));
+        }
+        uint8_t onFlash[32], expected[32];
+        mbedtls_sha256_finish_ret(&check, onFlash);
+        mbedtls_sha256_free(&check);
+
+        mbedtls_sha256_init(&check);
+        mbedtls_sha256_clone(&check, &r.sha);
+        mbedtls_sha256_finish_ret(&check, expected);
+        mbedtls_sha256_free(&check);
+        if (memcmp(onFlash, expected, sizeof(onFlash)) != 0) return false;
+
+        mbedtls_sha256_init(&sha);
+        mbedtls_sha256_clone(&sha, &r.sha);
+        memcpy(header, r.header, HEADER_HOLD);
+        written = flushed = lastDurable = r.offset;
+        fill = 0;
+        open = true;
+        return true;
+    }
+
+    bool write(const uint8_t* data, size_t len) {
+        while (len) {
+            size_t n = SPI_FLASH_SEC_SIZE - fill;
+            if (n > len) n = len;
+            memcpy(sector + fill, data, n);
+            fill += n;
+            data += n;
+            len -= n;
+            written += n;
+            if (fill == SPI_FLASH_SEC_SIZE && !flush()) return false;
+        }
+        return true;
+    }
+
+    // Erase, write and hash the staged sector (or the image's short tail)
+    bool flush() {
+        if (!fill) return true;
+        if (esp_partition_erase_range(part, flushed, SPI_FLASH_SEC_SIZE) != ESP_OK) return false;
+        size_t skip = 0;
+        if (flushed == 0) {
+            skip = fill < HEADER_HOLD ? fill : HEADER_HOLD;
+            memcpy(header, sector, skip);
+        }
+        if (fill > skip && esp_partition_write(part, flushed + skip, sector + skip, fill - skip) != ESP_OK) {
+            return false;
+        }
+        mbedtls_sha256_update_ret(&sha, sector, fill);
+        flushed += fill;
+        fill = 0;
+        if (resumeSha && flushed % SPI_FLASH_SEC_SIZE == 0 && flushed < size) checkpoint();
+        return true;
+    }
+
+    void checkpoint() {
+        OtaResumePoint r;
+        memset(&r, 0, sizeof(r));
+        r.partAddr = part->address;
+        r.size = size;
+        r.offset = flushed;
+        strncpy(r.sha256, resumeSha, sizeof(r.sha256) - 1);
+        memcpy(r.header, header, HEADER_HOLD);
+        mbedtls_sha256_init(&r.sha);
+        mbedtls_sha256_clone(&r.sha, &sha);
+        bool durable = flushed - lastDurable >= OTA_RESUME_NVS_STRIDE;
+        if (durable) lastDurable = flushed;
+        saveResumePoint(r, durable);
+    }
+
+    // Drop the staged partial sector; a retried download starts at `flushed`
+    void rewind() {
+        written = flushed;
+        fill = 0;
+    }
+
+    // Write the held-back header and point the bootloader at the slot.
+    // esp_ota_set_boot_partition() verifies the whole image first.
+    esp_err_t finish() {
+        esp_err_t err = esp_partition_write(part, 0, header, size < HEADER_HOLD ? size : HEADER_HOLD);
+        if (err == ESP_OK) err = esp_ota_set_boot_partition(part);
+        return err;
+    }
+
+    // Stop writing; a checkpoint stays for the next attempt
+    void close() {
+        if (open) mbedtls_sha256_free(&sha);
+        open = false;
+        free(sector);
+        sector = nullptr;
+    }
+
+    // Stop writing and forget the checkpoint: what's in the slot is bad
+    void abort() {
+        if (resumeSha) clearResumePoint();
+        close();
+    }
+};
+
+// fetchStream()'s writer stage. Owns the two OTA_PIPE_BLOCK_SIZE blocks and
+// the ota_write task that hands filled ones to the sink. When the sink fails,
+// the writer sets `failed` and keeps returning blocks unwritten until stop().
+struct OTAManager::WritePipe {
+    DownloadSink*     sink = nullptr;
+    uint8_t*          blocks = nullptr;
+    QueueHandle_t     freeQ = nullptr;
+    QueueHandle_t     fullQ = nullptr;
+    SemaphoreHandle_t done = nullptr;
+    volatile bool     failed = false;
+    uint32_t          stackHw = 0;
+
+    bool start() {
+        blocks = (uint8_t*)malloc(2 * OTA_PIPE_BLOCK_SIZE);
+        freeQ = xQueueCreate(2, sizeof(PipeBlock));
+        fullQ = xQueueCreate(2, sizeof(PipeBlock));
+        done = xSemaphoreCreateBinary();
+        if (!blocks || !freeQ || !fullQ || !done) {
+            release();
+            return false;
+        }
+        for (int i = 0; i < 2; i++) {
+            PipeBlock b = { blocks + i * OTA_PIPE_BLOCK_SIZE, 0 };
+            xQueueSend(freeQ, &b, 0);
+        }
+        if (xTaskCreatePinnedToCore(writerEntry, "ota_write", OTA_WRITER_TASK_STACK, this,
+                                    OTA_TASK_PRIORITY, nullptr, OTA_TASK_CORE) != pdPASS) {
+            release();
+            return false;
+        }
+        return true;
+    }
+
+    // Queue the end marker and wait for the writer to drain and exit
+    void stop() {
+        PipeBlock end = { nullptr, 0 };
+        xQueueSend(fullQ, &end, portMAX_DELAY);
+        xSemaphoreTake(done, portMAX_DELAY);
+        release();
+    }
+
+    void release() {
+        if (freeQ) vQueueDelete(freeQ);
+        if (fullQ) vQueueDelete(fullQ);
+        if (done) vSemaphoreDelete(done);
+        free(blocks);
+        freeQ = fullQ = nullptr;
+        done = nullptr;
+        blocks = nullptr;
+    }
+
+    static void writerEntry(void* arg) {
+        WritePipe* self = static_cast<WritePipe*>(arg);
+        PipeBlock b;
+        for (;;) {
+            xQueueReceive(self->fullQ, &b, portMAX_DELAY);
+            if (!b.data) break;
+            if (!self->failed && !self->sink->write(b.data, b.len)) self->failed = true;
+            xQueueSend(self->freeQ, &b, portMAX_DELAY);
+        }
+        self->stackHw = uxTaskGetStackHighWaterMark(nullptr);
+        xSemaphoreGive(self->done);
+        vTaskDelete(nullptr);
+    }
+};
+
+bool OTAManager::fetchStream(const char* url, DownloadSink& sink, size_t offset) {
     if (!WiFi.isConnected()) {
         setError("No WiFi connection");
         LOG_CRITICAL("[OTA] No WiFi connection");
         return false;
     }
 
-    currentState.store(OTAState::DOWNLOADING);
-
     // Verify the TLS chain against the embedded Mozilla root bundle. The same
     // client is reused across the GitHub 302 redirect to objects.githubusercontent.com,
     // so a CA bundle (not a pinned cert) is what makes both hops verifiable.
@@ -700,6 +1162,7 @@ bool OTAManager::downloadAndInstall(const String& url, size_t expectedSize, cons
         LOG_CRITICAL("[OTA] Failed to start HTTPS download");
         return false;
     }
+    preconnect(client, url);
 
     // GitHub release asset URLs (browser_download_url) return an HTTP 302 to
     // objects.githubusercontent.com. Without this, GET() fails with HTTP 302.
@@ -713,14 +1176,34 @@ bool OTAManager::downloadAndInstall(const String& url, size_t expectedSize, cons
     // DOWNLOAD_TIMEOUT_MS watchdog in the read loop.
     http.setTimeout((uint16_t)60000);
 
-    if (!config.githubToken.isEmpty()) {
-        http.addHeader("Authorization", "Bearer " + config.githubToken);
+    char header[OTA_TOKEN_MAX + 8];
+    if (authHeader(header, sizeof(header))) {
+        http.addHeader("Authorization", header);
+    }
+    // Added headers are kept across the redirect, and the asset host
+    // honours ranges
+    if (offset) {
+        snprintf(header, sizeof(header), "bytes=%lu-", (unsigned long)offset);
+        http.addHeader("Range", header);
+        static const char* rangeHeaders[] = { "Content-Range" };
+        http.collectHeaders(rangeHeaders, 1);
     }
 
     int httpCode = http.GET();
 
-    if (httpCode != HTTP_CODE_OK) {
-        setError("Download failed: HTTP " + String(httpCode));
+    if (offset && httpCode == HTTP_PARTIAL_CONTENT) {
+        unsigned long start = 0;
+        if (sscanf(http.header("Content-Range").c_str(), "bytes %lu-", &start) != 1 || start != offset) {
+            setError("Download failed: unexpected Content-Range");
+            LOG_CRITICAL("[OTA] Asked for bytes %u-, got Content-Range \"%s\"",
+                         (unsigned)offset, http.header("Content-Range").c_str());
+            http.end();
+            return false;
+        }
+    } else if (httpCode == HTTP_CODE_OK) {
+        offset = 0;             // Range ignored: this is the whole file
+    } else {
+        setError("Download failed: HTTP %d", httpCode);
         LOG_CRITICAL("[OTA] Download failed: HTTP %d", httpCode);
         http.end();
         return false;
@@ -735,40 +1218,31 @@ bool OTAManager::downloadAndInstall(const String& url, size_t expectedSize, cons
         return false;
     }
 
-    // Allow ±2% tolerance for Content-Encoding overhead
-    if (expectedSize > 0) {
-        size_t tolerance = (expectedSize * 2) / 100;
-        size_t minSize = expectedSize > tolerance ? expectedSize - tolerance : expectedSize;
-        size_t maxSize = expectedSize + tolerance;
-
-        if ((size_t)contentLength < minSize || (size_t)contentLength > maxSize) {
-            LOG_INFO("[OTA] Content length mismatch (tolerance +-2%%): expected %u, got %d bytes",
-                     expectedSize, contentLength);
-        }
+    if (!sink.begin(offset, contentLength)) {
+        http.end();
+        return false;
     }
 
-    LOG_INFO("[OTA] Downloading firmware: %d bytes", contentLength);
-
-    if (!Update.begin(contentLength)) {
-        setError("Not enough space for update");
-        LOG_CRITICAL("[OTA] Not enough space for update");
+    // Two-stage pipeline: this task keeps reading the socket into one block
+    // while the ota_write task hashes and flashes the other, so a sector
+    // erase no longer stalls TCP receive. Blocks go freeQ -> filled here ->
+    // fullQ -> sink.write() -> back to freeQ; a zero-length block stops
+    // the writer.
+    WritePipe pipe;
+    pipe.sink = &sink;
+    if (!pipe.start()) {
+        setError("Not enough heap for download buffers");
+        LOG_CRITICAL("[OTA] Could not start the download pipeline");
         http.end();
         return false;
     }
 
-    currentState.store(OTAState::INSTALLING);
-
-    // Hash the payload as it streams so we can verify the firmware against the
-    // release's published SHA256 BEFORE committing the image to the boot partition.
-    mbedtls_sha256_context shaCtx;
-    mbedtls_sha256_init(&shaCtx);
-    mbedtls_sha256_starts_ret(&shaCtx, 0); // 0 = SHA-256 (not SHA-224)
-
     WiFiClient* stream = http.getStreamPtr();
 
-    uint8_t buffer[OTA_BUFFER_SIZE];
-    size_t written = 0;
+    PipeBlock block = { nullptr, 0 };
+    size_t received = 0;
     size_t lastProgress = 0;
+    bool ok = true;
 
     unsigned long downloadStart = millis();
     unsigned long lastDataTime = millis();
@@ -778,7 +1252,7 @@ bool OTAManager::downloadAndInstall(const String& url, size_t expectedSize, cons
     // (a 5-minute download would exceed the 10s WDT). The loop task on Core 1
     // keeps running and feeding the WDT throughout, so a genuine hang is still
     // caught by the download's own STALL_TIMEOUT_MS / DOWNLOAD_TIMEOUT_MS.
-    while (http.connected() && written < contentLength) {
+    while (http.connected() && received < (size_t)contentLength) {
         // C2: don't let a firmware download blind the flood sensor. The
         // download blocks this task for up to 5 minutes; waterSensor.readLevel()
         // and the state machine keep running on the loop task, so a real flood
@@ -787,41 +1261,44 @@ bool OTAManager::downloadAndInstall(const String& url, size_t expectedSize, cons
         if (floodCheckCb && floodCheckCb(floodCheckCtx)) {
             setError("OTA aborted - flood condition detected mid-download");
             LOG_CRITICAL("[OTA] Flood condition detected mid-download - aborting to preserve flood monitoring");
-            Update.abort();
-            mbedtls_sha256_free(&shaCtx);
-            http.end();
-            return false;
+            ok = false;
+            break;
         }
         if (millis() - downloadStart > DOWNLOAD_TIMEOUT_MS) {
             setError("Download timeout - exceeded 5 minutes");
             LOG_CRITICAL("[OTA] Download timeout - exceeded 5 minutes");
-            Update.abort();
-            mbedtls_sha256_free(&shaCtx);
-            http.end();
-            return false;
+            ok = false;
+            break;
+        }
+        // The sink already set the error
+        if (pipe.failed) {
+            ok = false;
+            break;
+        }
+
+        if (!block.data) {
+            // Both blocks are with the writer: wait for one, but keep
+            // checking the limits above while flash is busy
+            if (xQueueReceive(pipe.freeQ, &block, pdMS_TO_TICKS(100)) != pdTRUE) continue;
+            block.len = 0;
         }
 
         size_t available = stream->available();
 
         if (available) {
             lastDataTime = millis();
-            size_t bytesToRead = (available > sizeof(buffer)) ? sizeof(buffer) : available;
-            size_t bytesRead = stream->readBytes(buffer, bytesToRead);
-
-            size_t bytesWritten = Update.write(buffer, bytesRead);
-            if (bytesWritten != bytesRead) {
-                setError("Write error");
-                LOG_CRITICAL("[OTA] Write error");
-                Update.abort();
-                mbedtls_sha256_free(&shaCtx);
-                http.end();
-                return false;
+            size_t space = OTA_PIPE_BLOCK_SIZE - block.len;
+            size_t bytesToRead = (available > space) ? space : available;
+            size_t bytesRead = stream->readBytes(block.data + block.len, bytesToRead);
+            block.len += bytesRead;
+            received += bytesRead;
+
+            if (block.len == OTA_PIPE_BLOCK_SIZE || received >= (size_t)contentLength) {
+                xQueueSend(pipe.fullQ, &block, portMAX_DELAY);
+                block.data = nullptr;
             }
 
-            mbedtls_sha256_update_ret(&shaCtx, buffer, bytesRead);
-            written += bytesWritten;
-
-            size_t progress = (written * 100) / contentLength;
+            size_t progress = (received * 100) / contentLength;
             if (progress >= lastProgress + PROGRESS_LOG_INTERVAL_PERCENT) {
                 LOG_INFO("[OTA] Progress: %u%%", progress);
                 lastProgress = progress;
@@ -830,62 +1307,324 @@ bool OTAManager::downloadAndInstall(const String& url, size_t expectedSize, cons
             if (millis() - lastDataTime > STALL_TIMEOUT_MS) {
                 setError("Download stalled - no data for 30 seconds");
                 LOG_CRITICAL("[OTA] Download stalled - no data for 30 seconds");
-                Update.abort();
-                mbedtls_sha256_free(&shaCtx);
-                http.end();
-                return false;
+                ok = false;
+                break;
             }
+            // Only idle when the socket is empty; a full receive path is
+            // drained back to back
+            delay(DOWNLOAD_LOOP_DELAY_MS);
         }
-
-        delay(DOWNLOAD_LOOP_DELAY_MS);
     }
 
     http.end();
 
-    if (written != contentLength) {
+    // Flush a partial block (connection closed early) and let the writer
+    // finish before the sink goes out of scope
+    if (block.data && block.len && ok) {
+        xQueueSend(pipe.fullQ, &block, portMAX_DELAY);
+    }
+    pipe.stop();
+    if (pipe.failed) ok = false;
+    LOG_DEBUG("[OTA] Download writer stack high-water mark: %u bytes", (unsigned)pipe.stackHw);
+
+    if (ok && received != (size_t)contentLength) {
         setError("Download incomplete");
-        LOG_CRITICAL("[OTA] Download incomplete: %u/%d bytes", written, contentLength);
-        Update.abort();
-        mbedtls_sha256_free(&shaCtx);
+        LOG_CRITICAL("[OTA] Download incomplete: %u/%d bytes", received, contentLength);
+        ok = false;
+    }
+    return ok;
+}
+
+bool OTAManager::commitImage(ImageWriter& image, const char* expectedSha256) {
+    if (!image.flush()) {
+        setError("Write error");
+        LOG_CRITICAL("[OTA] Write error on the last sector");
+        image.abort();
         return false;
     }
 
     // Finalize the hash and verify it BEFORE committing the image. A mismatch
     // means corruption or tampering — abort without activating the partition.
     uint8_t hash[32];
-    mbedtls_sha256_finish_ret(&shaCtx, hash);
-    mbedtls_sha256_free(&shaCtx);
+    mbedtls_sha256_finish_ret(&image.sha, hash);
 
     char hashHex[65];
     for (int i = 0; i < 32; i++) {
         snprintf(hashHex + (i * 2), 3, "%02x", hash[i]);
     }
 
-    if (!expectedSha256.equalsIgnoreCase(hashHex)) {
+    if (strcasecmp(expectedSha256, hashHex) != 0) {
         setError("Firmware SHA256 mismatch - aborting install");
         LOG_CRITICAL("[OTA] Firmware SHA256 mismatch - expected %s, got %s",
-                     expectedSha256.c_str(), hashHex);
-        Update.abort();
+                     expectedSha256, hashHex);
+        image.abort();
         return false;
     }
-
     LOG_INFO("[OTA] Firmware SHA256 verified: %s", hashHex);
-    LOG_INFO("[OTA] Download complete: %u bytes", written);
+    LOG_INFO("[OTA] Image complete: %u bytes", image.written);
 
-    if (!Update.end(true)) {
-        setError(String("Update.end() failed: ") + Update.errorString());
-        LOG_CRITICAL("[OTA] Update.end() failed: %s", Update.errorString());
+    esp_err_t err = image.finish();
+    if (err != ESP_OK) {
+        setError("Activating the new image failed: %s", esp_err_to_name(err));
+        LOG_CRITICAL("[OTA] Activating the new image failed: %s", esp_err_to_name(err));
+        image.abort();
         return false;
     }
+    image.abort();              // done with the checkpoint too
+
+    LOG_INFO("[OTA] Update successfully written to flash");
+    return true;
+}
+
+bool OTAManager::downloadAndInstall(const char* url, size_t expectedSize, const char* expectedSha256) {
+    currentState.store(OTAState::DOWNLOADING);
+
+    // The body is the image itself: straight into the inactive slot
+    struct FullImageSink : DownloadSink {
+        OTAManager*  ota;
+        ImageWriter* image;
+        size_t       expectedSize;
+        bool         failed = false;    // the slot is bad; don't resume
+
+        bool begin(size_t offset, int contentLength) override {
+            if (offset) {
+                if (!image->open || offset != image->flushed ||
+                    offset + (size_t)contentLength != image->size) {
+                    ota->setError("Resumed download doesn't match the saved image");
+                    LOG_CRITICAL("[OTA] Resume mismatch: at %u of %u, server sent %d bytes",
+                                 (unsigned)image->flushed, (unsigned)image->size, contentLength);
+                    failed = true;
+                    return false;
+                }
+                LOG_INFO("[OTA] Resuming firmware download at %u/%u bytes",
+                         (unsigned)offset, (unsigned)image->size);
+                ota->currentState.store(OTAState::INSTALLING);
+                return true;
+            }
+            if (image->open) {
+                LOG_INFO("[OTA] Server ignored the Range request - downloading from the start");
+                image->close();
+            }
+
+            // Allow ±2% tolerance for Content-Encoding overhead
+            if (expectedSize > 0) {
+                size_t tolerance = (expectedSize * 2) / 100;
+                size_t minSize = expectedSize > tolerance ? expectedSize - tolerance : expectedSize;
+                size_t maxSize = expectedSize + tolerance;
+
+                if ((size_t)contentLength < minSize || (size_t)contentLength > maxSize) {
+                    LOG_INFO("[OTA] Content length mismatch (tolerance +-2%%): expected %u, got %d bytes",
+                             expectedSize, contentLength);
+                }
+            }
+
+            LOG_INFO("[OTA] Downloading firmware: %d bytes", contentLength);
+
+            if (!image->begin(contentLength)) {
+                ota->setError("Not enough space for update");
+                LOG_CRITICAL("[OTA] Not enough space for update");
+                failed = true;
+                return false;
+            }
+            ota->currentState.store(OTAState::INSTALLING);
+            return true;
+        }
+        bool write(const uint8_t* data, size_t len) override {
+            if (!image->write(data, len)) {
+                ota->setError("Write error");
+                LOG_CRITICAL("[OTA] Write error");
+                failed = true;
+                return false;
+            }
+            return true;
+        }
+    };
+
+    ImageWriter image;
+    image.resumeSha = expectedSha256;
+    FullImageSink sink;
+    sink.ota = this;
+    sink.image = &image;
+    sink.expectedSize = expectedSize;
+
+    // Pick up a download of this same release that a stall, a flood abort or
+    // a reboot cut short
+    size_t from = 0;
+    OtaResumePoint saved;
+    if (loadResumePoint(saved) && strcasecmp(expectedSha256, saved.sha256) == 0) {
+        if (image.resume(saved)) {
+            from = image.flushed;
+        } else {
+            LOG_INFO("[OTA] Saved download progress doesn't match the inactive slot - starting over");
+            image.close();
+        }
+    }
+
+    // A dropped connection costs the partial sector, not the download: retry
+    // from the last flashed sector while attempts remain and it's still safe
+    for (int attempt = 1; !fetchStream(url, sink, from); attempt++) {
+        bool flood = floodCheckCb && floodCheckCb(floodCheckCtx);
+        if (sink.failed || !image.open || image.flushed == 0 || flood ||
+            attempt >= OTA_RESUME_ATTEMPTS || !WiFi.isConnected()) {
+            if (sink.failed) {
+                image.abort();
+            } else {
+                image.close();  // keep the checkpoint for the next install attempt
+            }
+            return false;
+        }
+        image.rewind();
+        from = image.flushed;
+        char why[OTA_ERROR_MAX];
+        getLastError(why, sizeof(why));
+        LOG_INFO("[OTA] Download interrupted (%s) - retrying from byte %u (attempt %d/%d)",
+                 why, (unsigned)from, attempt + 1, OTA_RESUME_ATTEMPTS);
+        vTaskDelay(pdMS_TO_TICKS(OTA_RESUME_RETRY_DELAY_MS));
+    }
+    return commitImage(image, expectedSha256);
+}
+
+bool OTAManager::downloadAndInstallDelta(const char* url, size_t targetSize, const char* expectedSha256) {
+    currentState.store(OTAState::DOWNLOADING);
+
+    // The body is a zlib stream. tinfl (in the ESP32 ROM, so the image
+    // carries no inflate code) unpacks it into a 32 KB window, which is
+    // what deflate back-references need, and DeltaApplier turns that
+    // into the new image, reading the base from the running partition.
+    struct DeltaSink : DownloadSink {
+        OTAManager*            ota;
+        ImageWriter*           image;
+        size_t                 targetSize;
+        const esp_partition_t* running;
+        tinfl_decompressor*    inflator = nullptr;
+        uint8_t*               window = nullptr;
+        size_t                 windowPos = 0;
+        tinfl_status           inflateStatus = TINFL_STATUS_NEEDS_MORE_INPUT;
+        DeltaApplier*          applier;
+
+        ~DeltaSink() {
+            free(inflator);
+            free(window);
+        }
+
+        bool begin(size_t /*offset*/, int contentLength) override {
+            LOG_INFO("[OTA] Downloading delta patch: %d bytes (image %u bytes)", contentLength, targetSize);
+            inflator = (tinfl_decompressor*)malloc(sizeof(tinfl_decompressor));
+            window = (uint8_t*)malloc(TINFL_LZ_DICT_SIZE);
+            if (!inflator || !window) {
+                ota->setError("Not enough heap for delta update");
+                LOG_CRITICAL("[OTA] Not enough heap for delta update (need %u bytes)",
+                             (unsigned)(sizeof(tinfl_decompressor) + TINFL_LZ_DICT_SIZE));
+                return false;
+            }
+            tinfl_init(inflator);
+            if (!image->begin(targetSize)) {
+                ota->setError("Not enough space for update");
+                LOG_CRITICAL("[OTA] Not enough space for update");
+                return false;
+            }
+            ota->currentState.store(OTAState::INSTALLING);
+            return true;
+        }
 
-    if (!Update.isFinished()) {
-        setError("Update not finished");
-        LOG_CRITICAL("[OTA] Update not finished");
+        bool write(const uint8_t* data, size_t len) override {
+            for (;;) {
+                if (inflateStatus == TINFL_STATUS_DONE) {
+                    // Trailing bytes after the zlib stream
+                    if (len == 0) return true;
+                    ota->setError("Delta patch has trailing data");
+                    return false;
+                }
+                size_t in = len;
+                size_t out = TINFL_LZ_DICT_SIZE - windowPos;
+                inflateStatus = tinfl_decompress(inflator, data, &in, window, window + windowPos, &out,
+                                                 TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_HAS_MORE_INPUT);
+                data += in;
+                len -= in;
+                if (out && applier->feed(window + windowPos, out) > DeltaApplier::DONE) {
+                    ota->setError("Delta patch rejected (%d)", (int)applier->status());
+                    LOG_CRITICAL("[OTA] Delta patch rejected: applier status %d", (int)applier->status());
+                    return false;
+                }
+                windowPos = (windowPos + out) & (TINFL_LZ_DICT_SIZE - 1);
+                if (inflateStatus < 0) {
+                    ota->setError("Delta patch is corrupt (inflate failed)");
+                    LOG_CRITICAL("[OTA] Delta inflate failed: %d", (int)inflateStatus);
+                    return false;
+                }
+                if (inflateStatus == TINFL_STATUS_NEEDS_MORE_INPUT && len == 0) return true;
+            }
+        }
+
+        // DeltaIo callbacks
+        static bool checkBase(void* ctx, uint32_t baseSize, const uint8_t sha256[32], uint32_t patchTarget) {
+            DeltaSink* self = static_cast<DeltaSink*>(ctx);
+            if (patchTarget != self->targetSize || baseSize > self->running->size) {
+                LOG_INFO("[OTA] Delta patch sizes don't match this release (base %u, target %u)",
+                         baseSize, patchTarget);
+                return false;
+            }
+            // The patch is only valid against the exact image it was made
+            // from. Hash that much of the running partition and compare.
+            mbedtls_sha256_context sha;
+            mbedtls_sha256_init(&sha);
+            mbedtls_sha256_starts_ret(&sha, 0);
+            uint8_t buf[OTA_BUFFER_SIZE];
+            for (uint32_t off = 0; off < baseSize; off += sizeof(buf)) {
+                size_t n = baseSize - off < sizeof(buf) ? baseSize - off : sizeof(buf);
+                if (esp_partition_read(self->running, off, buf, n) != ESP_OK) {
+                    mbedtls_sha256_free(&sha);
+                    return false;
+                }
+                mbedtls_sha256_update_ret(&sha, buf, n);
+            }
+            uint8_t hash[32];
+            mbedtls_sha256_finish_ret(&sha, hash);
+            mbedtls_sha256_free(&sha);
+            if (memcmp(hash, sha256, sizeof(hash)) != 0) {
+                LOG_INFO("[OTA] Running image is not this delta's base");
+                return false;
+            }
+            return true;
+        }
+        static bool readBase(void* ctx, uint32_t offset, uint8_t* buf, size_t len) {
+            DeltaSink* self = static_cast<DeltaSink*>(ctx);
+            return esp_partition_read(self->running, offset, buf, len) == ESP_OK;
+        }
+        static bool writeTarget(void* ctx, const uint8_t* data, size_t len) {
+            return static_cast<DeltaSink*>(ctx)->image->write(data, len);
+        }
+    };
+
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    if (!running) {
+        setError("Running partition not found");
         return false;
     }
 
-    LOG_INFO("[OTA] Update successfully written to flash");
-    return true;
+    ImageWriter image;
+    DeltaSink sink;
+    DeltaIo io = { &sink, &DeltaSink::checkBase, &DeltaSink::readBase, &DeltaSink::writeTarget };
+    DeltaApplier applier(io);
+    sink.ota = this;
+    sink.image = &image;
+    sink.targetSize = targetSize;
+    sink.running = running;
+    sink.applier = &applier;
+
+    if (!fetchStream(url, sink)) {
+        image.abort();
+        return false;
+    }
+    if (sink.inflateStatus != TINFL_STATUS_DONE || applier.finish() != DeltaApplier::DONE ||
+        image.written != targetSize) {
+        setError("Delta patch incomplete");
+        LOG_CRITICAL("[OTA] Delta patch incomplete: %u/%u bytes (applier status %d)",
+                     image.written, targetSize, (int)applier.status());
+        image.abort();
+        return false;
+    }
+    return commitImage(image, expectedSha256);
 }
 
 bool OTAManager::validateFirmwareSize(size_t size) {
@@ -960,23 +1699,50 @@ bool OTAManager::checkSignalStrength() {
 
 // Configuration setters
 
-void OTAManager::setGitHubRepo(const char* owner, const char* repo) {
-    config.githubOwner = String(owner);
-    config.githubRepo = String(repo);
+// Writes one config string under stateMux. A value that doesn't fit is
+// refused whole — a cut token or repo name would only fail later, less clearly.
+bool OTAManager::setConfigString(char* field, size_t size, const char* value) {
+    if (!value) value = "";
+    if (strlen(value) >= size) return false;
+    if (xSemaphoreTake(stateMux, pdMS_TO_TICKS(100)) != pdTRUE) return false;
+    strlcpy(field, value, size);
+    xSemaphoreGive(stateMux);
+    return true;
+}
+
+bool OTAManager::setGitHubRepo(const char* owner, const char* repo) {
+    if (!owner || !repo || strlen(owner) >= sizeof(config.githubOwner) ||
+        strlen(repo) >= sizeof(config.githubRepo)) {
+        LOG_INFO("[OTA] GitHub repo rejected: name too long");
+        return false;
+    }
+    if (xSemaphoreTake(stateMux, pdMS_TO_TICKS(100)) != pdTRUE) return false;
+    strlcpy(config.githubOwner, owner, sizeof(config.githubOwner));
+    strlcpy(config.githubRepo, repo, sizeof(config.githubRepo));
+    xSemaphoreGive(stateMux);
     saveConfig();
     LOG_INFO("[OTA] GitHub repo set to: %s/%s", owner, repo);
+    return true;
 }
 
-void OTAManager::setGitHubToken(const char* token) {
-    config.githubToken = String(token);
+bool OTAManager::setGitHubToken(const char* token) {
+    if (!setConfigString(config.githubToken, sizeof(config.githubToken), token)) {
+        LOG_INFO("[OTA] GitHub token rejected: longer than %u chars", (unsigned)(OTA_TOKEN_MAX - 1));
+        return false;
+    }
     saveConfig();
     LOG_INFO("[OTA] GitHub token %s", token && strlen(token) > 0 ? "set" : "cleared");
+    return true;
 }
 
-void OTAManager::setUpdatePassword(const char* password) {
-    config.updatePassword = String(password);
+bool OTAManager::setUpdatePassword(const char* password) {
+    if (!setConfigString(config.updatePassword, sizeof(config.updatePassword), password)) {
+        LOG_INFO("[OTA] Update password rejected: longer than %u chars", (unsigned)(OTA_PASSWORD_MAX - 1));
+        return false;
+    }
     saveConfig();
     LOG_INFO("[OTA] Update password %s", password && strlen(password) > 0 ? "set" : "cleared");
+    return true;
 }
 
 void OTAManager::setAutoCheck(bool enabled, unsigned long intervalMs) {
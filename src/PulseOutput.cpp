@@ -0,0 +1,90 @@
+#ifndef UNIT_TESTING
+#include "PulseOutput.h"
+#include "Logger.h"
+
+// REF_TICK runs at 1 MHz, so the divider is the tick in microseconds
+static_assert(PulseOutput::TICK_US >= 1 && PulseOutput::TICK_US <= 255,
+              "RMT clock divider is 8 bits");
+static_assert(sizeof(rmt_item32_t) == sizeof(uint32_t),
+              "PulsePattern items are rmt_item32_t values");
+
+PulseOutput::PulseOutput(int pin, rmt_channel_t channel)
+    : pin(pin), channel(channel), started(false), rmt(false), mode(MODE_OFF), startMs(0) {}
+
+void PulseOutput::begin() {
+    if (started) return;
+    started = true;
+
+#if PULSE_OUTPUT_RMT
+    rmt_config_t cfg = {};
+    cfg.rmt_mode = RMT_MODE_TX;
+    cfg.channel = channel;
+    cfg.gpio_num = (gpio_num_t)pin;
+    cfg.clk_div = TICK_US;
+    cfg.mem_block_num = 1;
+    cfg.flags = RMT_CHANNEL_FLAGS_AWARE_DFS;   // REF_TICK source
+    cfg.tx_config.loop_en = true;
+    cfg.tx_config.carrier_en = false;
+    cfg.tx_config.idle_output_en = true;
+    cfg.tx_config.idle_level = RMT_IDLE_LEVEL_LOW;
+    esp_err_t err = rmt_config(&cfg);
+    if (err == ESP_OK) {
+        rmt = true;
+    } else {
+        LOG_CRITICAL("[PULSE] RMT channel %d for GPIO %d unavailable (%s) - timing in software",
+                     (int)channel, pin, esp_err_to_name(err));
+    }
+#endif
+
+    // rmt_config() routed the pin to the channel; start on the GPIO matrix, low
+    digitalWrite(pin, LOW);
+    pinMode(pin, OUTPUT);
+}
+
+void PulseOutput::hold(bool on) {
+    Mode want = on ? MODE_SOLID : MODE_OFF;
+    if (started && mode == want) return;
+    begin();
+
+    digitalWrite(pin, on ? HIGH : LOW);
+    if (rmt && mode == MODE_PATTERN) {
+        pinMatrixOutDetach(pin, false, false);
+        rmt_set_tx_loop_mode(channel, false);
+        rmt_tx_stop(channel);
+    }
+    mode = want;
+}
+
+bool PulseOutput::play(const PulsePhase* phases, uint8_t n) {
+    PulsePattern next;
+    if (!next.compile(phases, n, TICK_US)) return false;
+    if (started && mode == MODE_PATTERN && next == pattern) return true;
+    begin();
+
+    pattern = next;
+    mode = MODE_PATTERN;
+    startMs = millis();
+    if (!rmt) {
+        update();
+        return true;
+    }
+
+    // Off the channel while its memory is rewritten, then restart it from
+    // the first item and give it the pin back
+    digitalWrite(pin, LOW);
+    pinMatrixOutDetach(pin, false, false);
+    rmt_set_tx_loop_mode(channel, false);
+    rmt_tx_stop(channel);
+    rmt_fill_tx_items(channel, reinterpret_cast<const rmt_item32_t*>(pattern.items()),
+                      pattern.itemCount(), 0);
+    rmt_set_tx_loop_mode(channel, true);
+    rmt_tx_start(channel, true);
+    rmt_set_gpio(channel, RMT_MODE_TX, (gpio_num_t)pin, false);
+    return true;
+}
+
+void PulseOutput::update() {
+    if (rmt || mode != MODE_PATTERN) return;
+    digitalWrite(pin, pattern.levelAtMs(millis() - startMs) ? HIGH : LOW);
+}
+#endif // UNIT_TESTING
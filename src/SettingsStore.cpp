@@ -1,15 +1,25 @@
 #ifndef UNIT_TESTING
 #include "SettingsStore.h"
+#include "NvsStore.h"
 #include "Logger.h"
 
-SettingsStore::SettingsStore() : vals(SETTINGS_DEFAULTS()) {}
+SettingsStore::SettingsStore() : snapshot(SETTINGS_DEFAULTS()), writeMux(nullptr) {
+    writeMux = xSemaphoreCreateMutex();
+}
 
 void SettingsStore::load() {
+    if (writeMux) xSemaphoreTake(writeMux, portMAX_DELAY);
+
     // Seed defaults first so we always have valid values even if NVS open fails
-    vals = SETTINGS_DEFAULTS();
+    SettingsValues vals = SETTINGS_DEFAULTS();
 
-    if (!prefs.begin(SETTINGS_STORE_NAMESPACE, /*readOnly=*/true)) {
+    // NvsReader: a save() still waiting for its write-behind commit is
+    // what load() must return
+    NvsReader prefs;
+    if (!prefs.begin(SETTINGS_STORE_NAMESPACE)) {
         LOG_INFO("[SETTINGS] NVS namespace not found — using defaults");
+        snapshot.publish(vals);
+        if (writeMux) xSemaphoreGive(writeMux);
         return;
     }
 
@@ -32,28 +42,32 @@ void SettingsStore::load() {
 
     prefs.end();
 
+    snapshot.publish(vals);
+    if (writeMux) xSemaphoreGive(writeMux);
+
     LOG_INFO("[SETTINGS] Loaded from NVS: emerg=%.1f cm, freq=%d ms, urgent=%.1f cm",
              vals.emergencyWaterLevel_cm, vals.emergencyNotifFreq_ms,
              vals.urgentEmergencyWaterLevel_cm);
 }
 
 void SettingsStore::save(const SettingsValues& v) {
-    if (!prefs.begin(SETTINGS_STORE_NAMESPACE, /*readOnly=*/false)) {
-        LOG_CRITICAL("[SETTINGS] Failed to open NVS for writing");
-        return;
-    }
-
-    // Key names match legacy ConfigServer keys (NVS backward-compatible)
-    prefs.putFloat("level_cm",       v.emergencyWaterLevel_cm);
-    prefs.putInt("notif_freq_ms",    v.emergencyNotifFreq_ms);
-    prefs.putFloat("urgent_level_cm",v.urgentEmergencyWaterLevel_cm);
-    prefs.putInt("horn_on_ms",       v.hornOnDuration_ms);
-    prefs.putInt("horn_off_ms",      v.hornOffDuration_ms);
+    if (writeMux) xSemaphoreTake(writeMux, portMAX_DELAY);
 
-    prefs.end();
+    // Key names match legacy ConfigServer keys (NVS backward-compatible).
+    // Write-behind: a slider drag's run of saves commits once, off this task.
+    NvsStore& nvs = NvsStore::getInstance();
+    const char* ns = SETTINGS_STORE_NAMESPACE;
+    nvs.putFloat(ns, "level_cm",        v.emergencyWaterLevel_cm);
+    nvs.putInt(ns,   "notif_freq_ms",   v.emergencyNotifFreq_ms);
+    nvs.putFloat(ns, "urgent_level_cm", v.urgentEmergencyWaterLevel_cm);
+    nvs.putInt(ns,   "horn_on_ms",      v.hornOnDuration_ms);
+    nvs.putInt(ns,   "horn_off_ms",     v.hornOffDuration_ms);
 
-    vals = v; // Update in-RAM copy atomically
-    LOG_INFO("[SETTINGS] Saved to NVS");
+    // Publish the new snapshot; readers pick it up on their next refresh()
+    snapshot.publish(v);
+    uint32_t ver = snapshot.version();
+    if (writeMux) xSemaphoreGive(writeMux);
+    LOG_INFO("[SETTINGS] Saved (version %u), NVS commit queued", ver);
 }
 
 #endif // UNIT_TESTING
@@ -26,6 +26,11 @@ void SmsChannel::loadCache() {
     finishLoad();
 }
 
+bool SmsChannel::endpointHost(char* host, size_t len) const {
+    if (!isConfigured()) return false;
+    return snprintf(host, len, "%s", SMS_API_HOST) < (int)len;
+}
+
 bool SmsChannel::isConfigured() const {
     return phoneCache[0] != '\0' && sidCache[0] != '\0' && tokenCache[0] != '\0';
 }
@@ -40,12 +45,12 @@ bool SmsChannel::send(const char* message) {
     if (!isConfigured()) return false;
 
     // Build URL-encoded POST body for Twilio Messages API. All inputs are
-    // bounded (message <= 160 chars from NotifMsg.body; phone/svcSid are the
+    // bounded (message <= maxMessageLength(); phone/svcSid are the
     // fixed cache arrays below), so worst-case sizes are compile-time known
     // and stack buffers avoid per-send heap churn + alloc-failure paths.
     static constexpr size_t ENCODED_TO_MAX  = sizeof(phoneCache)  * 3;
     static constexpr size_t ENCODED_SVC_MAX = sizeof(svcSidCache) * 3;
-    static constexpr size_t ENCODED_MSG_MAX = 160 * 3 + 1;
+    static constexpr size_t ENCODED_MSG_MAX = MAX_BODY * 3 + 1;
     char encodedTo[ENCODED_TO_MAX];
     char encodedSvc[ENCODED_SVC_MAX];
     char encodedBody[ENCODED_MSG_MAX];
@@ -62,8 +67,8 @@ bool SmsChannel::send(const char* message) {
 
     char endpoint[128];
     snprintf(endpoint, sizeof(endpoint),
-             "https://api.twilio.com/2010-04-01/Accounts/%s/Messages.json",
-             sidCache);
+             "https://%s/2010-04-01/Accounts/%s/Messages.json",
+             SMS_API_HOST, sidCache);
 
     return HttpPoster::post("[SMS]", endpoint,
                             "application/x-www-form-urlencoded", postData,
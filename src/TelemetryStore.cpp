@@ -0,0 +1,190 @@
+#ifndef UNIT_TESTING
+#include "TelemetryStore.h"
+#include "MQTTService.h"
+#include "NvsStore.h"
+#include "TimeManagement.h"
+#include "StateMachine.h"
+#include "Logger.h"
+
+static constexpr char     TELEMLOG_PARTITION[] = "telemlog";
+static constexpr char     TELEMLOG_NAMESPACE[] = "telemlog";
+// Before SNTP the clock reads 1970 (same cut-off as CustomChannel)
+static constexpr uint32_t CLOCK_VALID_AFTER    = 1600000000UL;
+
+TelemetryStore::TelemetryStore()
+    : cursor(0)
+    , savedCursor(0)
+    , bootFirstSeq(0)
+    , recorded(0)
+    , backfilled(0)
+    , skipped(0)
+{}
+
+bool TelemetryStore::PartitionRegion::read(size_t offset, void* out, size_t len) {
+    return part && esp_partition_read(part, offset, out, len) == ESP_OK;
+}
+
+bool TelemetryStore::PartitionRegion::write(size_t offset, const void* data, size_t len) {
+    return part && esp_partition_write(part, offset, data, len) == ESP_OK;
+}
+
+bool TelemetryStore::PartitionRegion::erase(size_t offset, size_t len) {
+    return part && esp_partition_erase_range(part, offset, len) == ESP_OK;
+}
+
+bool TelemetryStore::begin() {
+    region.part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                           ESP_PARTITION_SUBTYPE_ANY, TELEMLOG_PARTITION);
+    if (!region.part || !log.begin(&region)) {
+        LOG_INFO("[TLOG] No \"%s\" partition — store-and-forward disabled", TELEMLOG_PARTITION);
+        return false;
+    }
+    bootFirstSeq = log.nextSeq();
+
+    // No saved cursor (first boot with this partition): whatever is in flash
+    // has an unknown sent state, so start from the head rather than replay it
+    // (and persist that at once, or readings stored before the first
+    // backfill would be written off the same way on the next boot)
+    cursor = bootFirstSeq;
+    bool haveCursor = false;
+    NvsReader prefs;
+    if (prefs.begin(TELEMLOG_NAMESPACE)) {
+        haveCursor = prefs.isKey("cursor");
+        if (haveCursor) cursor = prefs.getULong("cursor", bootFirstSeq);
+        prefs.end();
+    }
+    if (cursor > bootFirstSeq) cursor = bootFirstSeq;     // partition was erased
+    savedCursor = cursor;
+    if (!haveCursor) saveCursor(/*force=*/true);
+
+    LOG_INFO("[TLOG] %u slots, next seq %u, %u readings waiting",
+             log.slots(), log.nextSeq(), getPending());
+    return true;
+}
+
+bool TelemetryStore::record(float level_cm, float rate_cm_30min, uint8_t state,
+                            bool valid, bool sensorError, uint8_t compartment) {
+    if (!log.ready()) return false;
+    int64_t tick = TimeManagement::monoUs();
+    uint32_t unixNow = (uint32_t)(TimeManagement::getInstance().toEpochUs(tick) / 1000000);
+
+    TelemetryRecord r;
+    r.flags = 0;
+    if (unixNow > CLOCK_VALID_AFTER) {
+        r.time = unixNow;
+    } else {
+        r.time = (uint32_t)(tick / 1000000);
+        r.flags |= TelemetryRecord::FLAG_UPTIME;
+    }
+    r.level_cc    = TelemetryRecord::toCenti(level_cm);
+    r.rate_cc     = TelemetryRecord::toCenti(rate_cm_30min);
+    r.state       = state;
+    r.compartment = compartment;
+    if (valid)       r.flags |= TelemetryRecord::FLAG_VALID;
+    if (sensorError) r.flags |= TelemetryRecord::FLAG_SENSOR_ERROR;
+
+    if (!log.append(r)) {
+        LOG_INFO("[TLOG] Flash write failed");
+        return false;
+    }
+    recorded++;
+    return true;
+}
+
+uint32_t TelemetryStore::getPending() const {
+    if (!log.ready()) return 0;
+    uint32_t from = cursor > log.oldestSeq() ? cursor : log.oldestSeq();
+    return log.nextSeq() > from ? log.nextSeq() - from : 0;
+}
+
+size_t TelemetryStore::formatRecord(char* out, size_t outLen, const TelemetryRecord& r, uint32_t t) const {
+    char level[12] = "null";
+    char rate[12]  = "null";
+    if (r.level_cc != TelemetryRecord::LEVEL_NONE) {
+        snprintf(level, sizeof(level), "%.2f", (double)TelemetryRecord::fromCenti(r.level_cc));
+    }
+    if (r.rate_cc != TelemetryRecord::LEVEL_NONE) {
+        snprintf(rate, sizeof(rate), "%.2f", (double)TelemetryRecord::fromCenti(r.rate_cc));
+    }
+    int n = snprintf(out, outLen,
+                     "{\"t\":%lu,\"level_cm\":%s,\"rate_cm_30min\":%s,\"state\":\"%s\","
+                     "\"valid\":%s,\"sensor_error\":%s,\"compartment\":%u}",
+                     (unsigned long)t, level, rate, stateToString((State)r.state),
+                     (r.flags & TelemetryRecord::FLAG_VALID) ? "true" : "false",
+                     (r.flags & TelemetryRecord::FLAG_SENSOR_ERROR) ? "true" : "false",
+                     r.compartment);
+    return (n > 0 && (size_t)n < outLen) ? (size_t)n : 0;
+}
+
+size_t TelemetryStore::backfill(MQTTService& mqtt) {
+    if (!log.ready() || !mqtt.isConnected()) return 0;
+    if (cursor < log.oldestSeq()) {
+        // Outage outlasted the partition: the oldest readings were overwritten
+        skipped += log.oldestSeq() - cursor;
+        cursor = log.oldestSeq();
+    }
+    if (cursor >= log.nextSeq()) return 0;
+
+    int64_t tick = TimeManagement::monoUs();
+    uint32_t unixNow = (uint32_t)(TimeManagement::getInstance().toEpochUs(tick) / 1000000);
+    bool clockSet = unixNow > CLOCK_VALID_AFTER;
+    uint32_t nowUptimeS = (uint32_t)(tick / 1000000);
+
+    char payload[BACKFILL_PAYLOAD_MAX];
+    size_t len = 0;
+    payload[len++] = '[';
+    size_t count = 0;
+    uint32_t lost = 0;
+    uint32_t seq = cursor;
+    while (seq < log.nextSeq()) {
+        TelemetryRecord r;
+        if (!log.read(seq, r)) {               // torn or failed write
+            lost++;
+            seq++;
+            continue;
+        }
+        uint32_t t = r.time;
+        if (r.flags & TelemetryRecord::FLAG_UPTIME) {
+            if (seq < bootFirstSeq) {          // earlier boot: no way to place it
+                lost++;
+                seq++;
+                continue;
+            }
+            if (!clockSet) break;              // keep order: wait for SNTP
+            t = unixNow - (nowUptimeS - r.time);
+        }
+        char item[192];
+        size_t n = formatRecord(item, sizeof(item), r, t);
+        // Separator and closing bracket must still fit
+        if (n == 0 || len + n + 2 > sizeof(payload)) break;
+        if (count > 0) payload[len++] = ',';
+        memcpy(payload + len, item, n);
+        len += n;
+        count++;
+        seq++;
+    }
+
+    if (count > 0) {
+        payload[len++] = ']';
+        payload[len] = '\0';
+        char base[64];
+        char topic[96];
+        if (mqtt.getBaseTopic(base, sizeof(base)) != 0) return 0;
+        snprintf(topic, sizeof(topic), "%s/telemetry/backfill", base);
+        if (!mqtt.publish(topic, payload, false)) return 0;     // retry next call
+        backfilled += count;
+    }
+    skipped += lost;
+    cursor = seq;
+    if (cursor >= log.nextSeq() || cursor - savedCursor >= CURSOR_SAVE_EVERY) saveCursor();
+    return count;
+}
+
+void TelemetryStore::saveCursor(bool force) {
+    if (cursor == savedCursor && !force) return;
+    // Write-behind: backfill runs on the loop task
+    if (!NvsStore::getInstance().putUInt(TELEMLOG_NAMESPACE, "cursor", cursor)) return;
+    savedCursor = cursor;
+}
+
+#endif // UNIT_TESTING
@@ -15,9 +15,15 @@ TimeManagement& TimeManagement::getInstance() {
 
 
 TimeManagement::TimeManagement(bool mock) 
-    : isMocked(mock), syncStatus(SNTP_NOT_STARTED), lastSyncTime(0), lastSyncInitTime(0) {
+    : isMocked(mock), syncStatus(SNTP_NOT_STARTED), lastSyncTime(0), lastSyncInitTime(0),
+      epochOffsetUs(0), offsetMux(portMUX_INITIALIZER_UNLOCKED) {
     
     if (!isMocked) {
+        // The RTC keeps the system time across soft resets; start from it
+        struct timeval tv;
+        gettimeofday(&tv, NULL);
+        updateEpochOffset((int64_t)tv.tv_sec * 1000000 + tv.tv_usec);
+
         // Get current SNTP sync status
         sntp_sync_status_t status = esp_sntp_get_sync_status();
         if (status == SNTP_SYNC_STATUS_COMPLETED) {
@@ -27,6 +33,8 @@ TimeManagement::TimeManagement(bool mock)
         }
     } else {
         syncStatus = SNTP_SYNCED; // Mock assumes synced time
+        // For testing: mock epoch + elapsed time since boot
+        updateEpochOffset((int64_t)MOCK_EPOCH_TIME * 1000000);
     }
     
     ESP_LOGI(TAG, "TimeManagement initialized (mock=%d, syncStatus=%d)", isMocked, syncStatus);
@@ -39,25 +47,21 @@ TimeManagement::~TimeManagement() {
 
 Timestamp TimeManagement::getCurrentTimestamp() {
     Timestamp ts;
+    int64_t now = monoUs();
 
-    ts.timeSinceBoot = (uint32_t)(esp_timer_get_time() / 1000);  // Convert microseconds to milliseconds
-    ts.isNTPSynced = (syncStatus == SNTP_SYNCED) && (time(NULL) - lastSyncTime < SYNC_EXPIRY); // Check sync and interval if sync is expired
-    
-    if (isMocked) {
-        // For testing: use mock time + elapsed seconds
-        ts.unixTime = MOCK_EPOCH_TIME + (uint32_t)(esp_timer_get_time() / 1000 / 1000);
-        return ts;
-    }
-
-    // This uses the high-resolution timer (80 MHz APB clock)
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    
-    ts.unixTime = tv.tv_sec;
+    ts.timeSinceBoot = (uint32_t)(now / 1000);  // Convert microseconds to milliseconds
+    ts.unixTime = (time_t)(toEpochUs(now) / 1000000);
+    ts.isNTPSynced = (syncStatus == SNTP_SYNCED) && (ts.unixTime - lastSyncTime < SYNC_EXPIRY); // Check sync and interval if sync is expired
 
     return ts;
 }
 
+void TimeManagement::updateEpochOffset(int64_t unixUs) {
+    portENTER_CRITICAL(&offsetMux);
+    epochOffsetUs.publish(unixUs - monoUs());
+    portEXIT_CRITICAL(&offsetMux);
+}
+
 void TimeManagement::sync() {
     // H4: the original initSNTPSync() only did anything the very first time
     // (syncStatus == SNTP_NOT_STARTED) — every subsequent call, including the
@@ -168,6 +172,7 @@ void TimeManagement::setSystemTime(time_t unixTimestamp) {
     };
     
     settimeofday(&tv, NULL);
+    updateEpochOffset((int64_t)unixTimestamp * 1000000);
     lastSyncTime = unixTimestamp;
     
     if (syncStatus == SNTP_NOT_STARTED) {
@@ -190,6 +195,7 @@ const char* TimeManagement::getTimeString(const char* format) {
 // Static callback for SNTP sync events
 void TimeManagement::onSNTPSync(struct timeval *tv) {
     TimeManagement& instance = TimeManagement::getInstance();
+    instance.updateEpochOffset((int64_t)tv->tv_sec * 1000000 + tv->tv_usec);
     instance.syncStatus = SNTP_SYNCED;
     instance.lastSyncTime = tv->tv_sec;
     ESP_LOGI(TAG, "SNTP sync completed via callback");
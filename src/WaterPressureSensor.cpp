@@ -1,35 +1,64 @@
-// LOAD-BEARING GUARD: this whole TU is excluded from native builds because it
-// hard-includes <Arduino.h>/<Wire.h>, which have no native shim. With
-// test_build_src=yes, native compiles all of src/ for EVERY test suite, so
-// removing this guard breaks the native build for ALL suites (test_notifications,
-// test_state_machine, ...) with a misleading "<Arduino.h> not found", not just
-// test_sensor. The trade-off: test_sensor cannot link the real implementation
-// natively (see the mock note in WaterPressureSensor.h). To re-enable native
-// test_sensor, add an Arduino.h/Wire.h native shim instead of dropping this guard.
-#ifndef UNIT_TESTING
+// LOAD-BEARING GUARD: this TU hard-includes <Arduino.h>/<Wire.h>. With
+// test_build_src=yes, native compiles all of src/ for EVERY test suite, and
+// plain env:native has no Arduino headers — removing this guard breaks the
+// native build for ALL suites (test_notifications, test_state_machine, ...)
+// with a misleading "<Arduino.h> not found". env:native-sensor defines
+// NATIVE_SENSOR_SHIM and puts the test/shim stand-ins (Arduino, Wire, a
+// scripted ADS1115, FreeRTOS) on the include path, so there the real
+// implementation builds and test_sensor_pipeline drives it.
+#if !defined(UNIT_TESTING) || defined(NATIVE_SENSOR_SHIM)
 #include "WaterPressureSensor.h"
 #include "Logger.h"
 #include <Arduino.h>
 #include <Wire.h>
-#include <algorithm>
+#include <esp_task_wdt.h>
+
+// ALERT/RDY edge counter. There is one ADS1115 on the board, so a file-scope
+// counter is enough. The ISR counts and wakes the sampling task (once it has
+// registered); the I2C read of the conversion register happens in
+// drainConversions() on that task.
+static volatile uint32_t s_rdyEdgeCount = 0;
+static TaskHandle_t volatile s_rdyNotifyTask = nullptr;
+
+static void IRAM_ATTR onAdsConversionReady() {
+    s_rdyEdgeCount++;
+    TaskHandle_t task = s_rdyNotifyTask;
+    if (task) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(task, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+static constexpr uint16_t adsDataRateFor(uint16_t sps) {
+    return sps == 8   ? RATE_ADS1115_8SPS   :
+           sps == 16  ? RATE_ADS1115_16SPS  :
+           sps == 32  ? RATE_ADS1115_32SPS  :
+           sps == 64  ? RATE_ADS1115_64SPS  :
+           sps == 128 ? RATE_ADS1115_128SPS :
+           sps == 250 ? RATE_ADS1115_250SPS :
+           sps == 475 ? RATE_ADS1115_475SPS :
+           sps == 860 ? RATE_ADS1115_860SPS : 0xFFFF;
+}
+static_assert(adsDataRateFor(ADS_SAMPLE_RATE_SPS) != 0xFFFF,
+              "ADS_SAMPLE_RATE_SPS must be a supported ADS1115 data rate");
+
+// Polling fallback: one input per tick, spaced so each channel is still read
+// about once a second.
+static constexpr uint32_t POLL_INTERVAL_MS = 1000u / SENSOR_CHANNELS;
 
 WaterPressureSensor::WaterPressureSensor(bool mock)
-    : currentReadingIndex(0), useMockData(mock), mockWaterLevel(0),
-      adcCalHandle(nullptr), calibrationInitialized(false), zeroReadingVoltage_mv(590),
-      secondPointVoltage_mv(0), secondPointLevel_cm(0.0f), twoPointCalibrationActive(false),
+    : useMockData(mock), mockWaterLevel(0),
+      adcCalHandle(nullptr), calibrationInitialized(false),
       lastLogTime(0), lastSampleTime(0), lastReading{},
-      busRecoveryAttempts(0), busUnrecoverable(false),
-      rateBufferIndex(0), lastRateSampleTime(0),
-      lastStuckRawADC(0), stuckSampleCount(0) {
-    for (int i = 0; i < READINGS_BUFFER_SIZE; i++) {
-        readingsBuffer[i].valid = false;
-        readingsBuffer[i].level_cm = 0;
-        readingsBuffer[i].timestamp = Timestamp{false,0,0};
-    }
-    for (int i = 0; i < RATE_BUFFER_SIZE; i++) {
-        rateBuffer[i].valid = false;
-        rateBuffer[i].level_cm = 0.0f;
-        rateBuffer[i].millis_ts = 0;
+      busRecovery(BUS_RECOVERY_MAX_ATTEMPTS),
+      rdyMode(false), rdySeenCount(0), lastRdyTime(0),
+      scanChannel(0), settleRemaining(0), pollChannel(0),
+      ringDrops(0), sampleSeq(0), missedConversions(0) {
+    for (uint8_t ch = 0; ch < SENSOR_CHANNELS; ch++) {
+        channels[ch].lastReading.channel = ch;
+        channels[ch].latestReading.channel = ch;
+        channels[ch].rebuildLegacyTable();
     }
 }
 
@@ -44,19 +73,59 @@ bool WaterPressureSensor::init() {
             LOG_CRITICAL("WaterPressureSensor: ADS1115 not found on I2C bus (SDA=%d SCL=%d)", I2C_SDA_PIN, I2C_SCL_PIN);
             return false;
         }
-        ads.setGain(GAIN_ONE);
-        ads.setDataRate(RATE_ADS1115_32SPS);
-        ads.startADCReading(MUX_BY_CHANNEL[CHANNEL], /*continuous=*/true);
+        startContinuousConversions();
+
+        // Give ALERT/RDY one timeout to prove it is wired before trusting it;
+        // boards without the RDY wire keep the 1 Hz polling path.
+        pinMode(ADS_ALERT_PIN, INPUT_PULLUP);
+        uint32_t edgesBefore = s_rdyEdgeCount;
+        attachInterrupt(digitalPinToInterrupt(ADS_ALERT_PIN), onAdsConversionReady, FALLING);
+        uint32_t waitStart = millis();
+        while (s_rdyEdgeCount == edgesBefore && millis() - waitStart < ADS_RDY_TIMEOUT_MS) {
+            delay(1);
+        }
+        rdyMode = (s_rdyEdgeCount != edgesBefore);
+        if (rdyMode) {
+            rdySeenCount = s_rdyEdgeCount;
+            lastRdyTime = millis();
+            LOG_INFO("WaterPressureSensor: ALERT/RDY on GPIO %d, %u SPS x%u oversampling, %u channel(s)",
+                     ADS_ALERT_PIN, ADS_SAMPLE_RATE_SPS, ADS_CHANNEL_DWELL_CONVERSIONS, SENSOR_CHANNELS);
+        } else {
+            detachInterrupt(digitalPinToInterrupt(ADS_ALERT_PIN));
+            LOG_CRITICAL("WaterPressureSensor: no ALERT/RDY edge on GPIO %d, using 1 Hz polling", ADS_ALERT_PIN);
+        }
         // Ensure first readLevel() call samples immediately
-        lastSampleTime = millis() - 1001;
+        lastSampleTime = millis() - POLL_INTERVAL_MS - 1;
     }
 
-    SensorReading firstReading = readLevel();
-    
-    if (!firstReading.valid) {
-        return false; 
+    // Nothing is published until every compartment has completed one scan
+    // slot (~1 s in RDY mode); wait for all of them so init() reports real
+    // readings rather than the empty cached ones.
+    uint32_t firstStart = millis();
+    bool allReported = false;
+    while (!allReported) {
+        if (!rdyMode) {
+            lastSampleTime = millis() - POLL_INTERVAL_MS - 1;
+        }
+        readLevel();
+        allReported = true;
+        for (uint8_t ch = 0; ch < SENSOR_CHANNELS; ch++) {
+            if (channels[ch].readingCount == 0) allReported = false;
+        }
+        if (allReported || millis() - firstStart >= SENSOR_SCAN_PERIOD_MS + ADS_RDY_TIMEOUT_MS) {
+            break;
+        }
+        delay(2);
     }
-    return true;
+
+    bool allValid = true;
+    for (uint8_t ch = 0; ch < SENSOR_CHANNELS; ch++) {
+        if (!channels[ch].lastReading.valid) {
+            LOG_CRITICAL("WaterPressureSensor: channel %u has no valid first reading", ch);
+            allValid = false;
+        }
+    }
+    return allValid;
 }
 
 
@@ -68,133 +137,236 @@ WaterPressureSensor::~WaterPressureSensor() {
 }
 
 
-void WaterPressureSensor::setZeroLevelMilliVolts(int millivolts) {
-    zeroReadingVoltage_mv = millivolts;
+void WaterPressureSensor::ChannelState::rebuildLegacyTable() {
+    // Two-point: the line through (zero, 0 cm) and the second point. Zero
+    // point only: the nominal span, zero..4096 mV over CM_MAX cm.
+    const int MAX_VOLTAGE_MV = 4096;
+    CalibrationPoint pts[2] = { { zeroReadingVoltage_mv, 0.0f },
+                                { MAX_VOLTAGE_MV, (float)CM_MAX } };
+    if (twoPointCalibrationActive && secondPointVoltage_mv != zeroReadingVoltage_mv) {
+        pts[1].millivolts = secondPointVoltage_mv;
+        pts[1].level_cm = secondPointLevel_cm;
+    }
+    table.build(pts, 2);
+    multiPointActive = false;
+    validFloor_mv = zeroReadingVoltage_mv;
 }
 
-void WaterPressureSensor::setCalibrationPoint(int pointIndex, int millivolts, float level_cm) {
+
+void WaterPressureSensor::setZeroLevelMilliVolts(int millivolts, uint8_t channel) {
+    if (channel >= SENSOR_CHANNELS) return;
+    portENTER_CRITICAL(&sharedMux);
+    channels[channel].zeroReadingVoltage_mv = millivolts;
+    channels[channel].rebuildLegacyTable();
+    portEXIT_CRITICAL(&sharedMux);
+}
+
+void WaterPressureSensor::setCalibrationPoint(int pointIndex, int millivolts, float level_cm, uint8_t channel) {
+    if (channel >= SENSOR_CHANNELS) return;
+    ChannelState& c = channels[channel];
+    // Called from the config server's HTTP handlers (config_srv task) while the
+    // sampling task may be mid-conversion; the lock keeps a two-point update
+    // from being seen half-done.
+    portENTER_CRITICAL(&sharedMux);
     if (pointIndex == 0) {
-        zeroReadingVoltage_mv = millivolts;
+        c.zeroReadingVoltage_mv = millivolts;
     } else if (pointIndex == 1) {
-        secondPointVoltage_mv = millivolts;
-        secondPointLevel_cm = level_cm;
-        twoPointCalibrationActive = true;
+        c.secondPointVoltage_mv = millivolts;
+        c.secondPointLevel_cm = level_cm;
+        c.twoPointCalibrationActive = true;
+    }
+    c.rebuildLegacyTable();
+    portEXIT_CRITICAL(&sharedMux);
+}
+
+bool WaterPressureSensor::setCalibrationTable(const CalibrationPoint* points, uint8_t n, uint8_t channel) {
+    if (channel >= SENSOR_CHANNELS) return false;
+    ChannelState& c = channels[channel];
+    if (n == 0) {
+        portENTER_CRITICAL(&sharedMux);
+        c.rebuildLegacyTable();
+        portEXIT_CRITICAL(&sharedMux);
+        return true;
+    }
+
+    // Build (sort + slopes) outside the lock; only the copy is shared.
+    CalibrationTable built;
+    if (!built.build(points, n)) return false;
+
+    // The lowest-level point is the floor for the below-zero validity check
+    // in readLevel(). The two-point zero is left alone, so clearing the
+    // table (or the next saveCalibration()) gets the user's zero back.
+    int floor_mv = built.point(0).millivolts;
+    float floor_cm = built.point(0).level_cm;
+    for (uint8_t i = 1; i < built.size(); i++) {
+        if (built.point(i).level_cm < floor_cm) {
+            floor_cm = built.point(i).level_cm;
+            floor_mv = built.point(i).millivolts;
+        }
     }
+
+    portENTER_CRITICAL(&sharedMux);
+    c.table = built;
+    c.multiPointActive = true;
+    c.validFloor_mv = floor_mv;
+    portEXIT_CRITICAL(&sharedMux);
+    return true;
 }
 
-bool WaterPressureSensor::hasTwoPointCalibration() {
-    return twoPointCalibrationActive;
+uint8_t WaterPressureSensor::getCalibrationTable(CalibrationPoint* out, uint8_t maxPoints, uint8_t channel) {
+    if (channel >= SENSOR_CHANNELS) return 0;
+    const ChannelState& c = channels[channel];
+    if (!c.multiPointActive) return 0;
+    uint8_t n = c.table.size() < maxPoints ? c.table.size() : maxPoints;
+    for (uint8_t i = 0; i < n; i++) {
+        out[i] = c.table.point(i);
+    }
+    return n;
 }
 
-int WaterPressureSensor::getZeroPointMilliVolts() {
-    return zeroReadingVoltage_mv;
+bool WaterPressureSensor::hasTwoPointCalibration(uint8_t channel) {
+    return channel < SENSOR_CHANNELS && channels[channel].twoPointCalibrationActive;
 }
 
-int WaterPressureSensor::getSecondPointMilliVolts() {
-    return secondPointVoltage_mv;
+int WaterPressureSensor::getZeroPointMilliVolts(uint8_t channel) {
+    return channel < SENSOR_CHANNELS ? channels[channel].zeroReadingVoltage_mv : 0;
 }
 
-float WaterPressureSensor::getSecondPointLevelCm() {
-    return secondPointLevel_cm;
+int WaterPressureSensor::getSecondPointMilliVolts(uint8_t channel) {
+    return channel < SENSOR_CHANNELS ? channels[channel].secondPointVoltage_mv : 0;
 }
 
+float WaterPressureSensor::getSecondPointLevelCm(uint8_t channel) {
+    return channel < SENSOR_CHANNELS ? channels[channel].secondPointLevel_cm : 0.0f;
+}
 
-float WaterPressureSensor::voltageToCentimeters(int voltage_mv) {
-    // Convert calibrated voltage (mV) to centimeters
-    // This provides more accurate readings than raw ADC conversion
-    
-    // Use 2-point calibration if available
-    if (twoPointCalibrationActive && secondPointVoltage_mv != zeroReadingVoltage_mv) {
-        // Linear interpolation: y = y0 + (y1 - y0) * (x - x0) / (x1 - x0)
-        // Where: x0 = zeroReadingVoltage_mv, y0 = 0.0
-        //        x1 = secondPointVoltage_mv, y1 = secondPointLevel_cm
-        //        x = voltage_mv, y = level_cm
-        
-        float voltage_diff = secondPointVoltage_mv - zeroReadingVoltage_mv;
-        if (voltage_diff != 0) {
-            float level_cm = (voltage_mv - zeroReadingVoltage_mv) * (secondPointLevel_cm / voltage_diff);
-            return level_cm;
-        }
-    }
-    
-    // Fallback to single-point calibration
-    const int MAX_VOLTAGE_MV = 4096;
-    
-    // Calculate voltage range
-    float voltage_range = MAX_VOLTAGE_MV - zeroReadingVoltage_mv;
-    
-    // Calculate voltage per centimeter
-    // Using the same conversion factor approach as rawToCentimeters
-    // For a 100cm range: voltage_per_cm = voltage_range / CM_MAX
-    // Or use a fixed value if you know the sensor's characteristics
-    float voltage_per_cm = voltage_range / (float)CM_MAX;
-    
-    // Convert voltage to centimeters
-    return (voltage_mv - zeroReadingVoltage_mv) / voltage_per_cm;
+
+float WaterPressureSensor::voltageToCentimeters(int voltage_mv, uint8_t channel) {
+    // Same table readLevel() uses; kept in mV for the calibration UI and tests.
+    const ChannelState& c = channels[channel < SENSOR_CHANNELS ? channel : 0];
+    return c.table.levelFromMillivolts(voltage_mv);
 }
 
 
 SensorReading WaterPressureSensor::readLevel() {
-    SensorReading reading;    
+    SensorReading reading{};
     reading.valid = true; // Assume valid until proven otherwise
+    uint8_t ch = 0;
     
     if (useMockData) {
         // Slow sine wave: 1-hour period, range 0-60cm
-        // Crosses Tier 1 (30cm) and Tier 2 (50cm) thresholds each cycle
-        uint32_t t = millis();
-        float base = 30.0f + 30.0f * sin(2.0f * 3.14159f * t / 3600000.0f);
+        // Crosses Tier 1 (30cm) and Tier 2 (50cm) thresholds each cycle.
+        // Extra compartments lag and sit lower so they read distinctly.
+        ch = pollChannel;
+        pollChannel = (uint8_t)((pollChannel + 1) % SENSOR_CHANNELS);
+        uint32_t t = millis() + ch * 600000u;
+        float base = 30.0f + 30.0f * sin(2.0f * 3.14159f * t / 3600000.0f) - 5.0f * ch;
         mockWaterLevel = base + (float)(random(-200, 200)) / 100.0f;
         if (mockWaterLevel < 0.0f) mockWaterLevel = 0.0f;
         reading.level_cm = mockWaterLevel;
         reading.millivolts = 590.0f + (mockWaterLevel / 100.0f) * (4096.0f - 590.0f);
     } else {
-        if (millis() - lastSampleTime < 1000) {
+        // Bus recovery in progress (or backing off): advance it one short step
+        // per tick and keep the bus otherwise untouched. Invalid readings keep
+        // flowing at the normal cadence so the state machine sees the fault.
+        if (busRecovery.busy()) {
+            uint32_t nowMs = millis();
+            runBusRecoveryStep(nowMs);
+            if (nowMs - lastSampleTime < POLL_INTERVAL_MS) {
+                return lastReading;
+            }
+            lastSampleTime = nowMs;
+            ch = pollChannel;
+            pollChannel = (uint8_t)((pollChannel + 1) % SENSOR_CHANNELS);
+            reading.valid = false;
+            reading.tickUs = TimeManagement::monoUs();
+            publish(ch, reading);
+            return reading;
+        }
+
+        // RDY mode: read every conversion the ISR flagged and only proceed once
+        // the scanned channel's dwell has been averaged. If drainConversions()
+        // detected a stalled RDY line it clears rdyMode and we poll below.
+        int windowChannel = -1;
+        if (rdyMode) {
+            windowChannel = drainConversions();
+            if (windowChannel < 0 && rdyMode) {
+                return lastReading;
+            }
+        }
+        bool windowReady = windowChannel >= 0;
+        if (!windowReady && millis() - lastSampleTime < POLL_INTERVAL_MS) {
             return lastReading;
         }
         lastSampleTime = millis();
-
-        if (busUnrecoverable) {
+        if (windowReady) {
+            ch = (uint8_t)windowChannel;
+        } else {
+            ch = pollChannel;
+            pollChannel = (uint8_t)((pollChannel + 1) % SENSOR_CHANNELS);
+        }
+        ChannelState& c = channels[ch];
+
+        // Reads report their own failures, so the address probe only runs
+        // after one: a NACK there is a bus fault, an ACK a one-off glitch
+        // (a window keeps the conversions it did read).
+        int16_t rawADC = c.decimatedRaw;
+        bool readOk = windowReady ? c.decimatedCount > 0 : readPolled(ch, rawADC);
+        bool readFailed = !readOk || (windowReady && c.decimatedReadErrors > 0);
+        if (readFailed && !adsResponds()) {
+            bool wasUnrecoverable = busRecovery.unrecoverable();
+            busRecovery.onBusError(millis());
+            if (!wasUnrecoverable) {
+                LOG_CRITICAL("WaterPressureSensor: I2C bus error, recovery attempt %u/%d",
+                             busRecovery.attemptCount(), BUS_RECOVERY_MAX_ATTEMPTS);
+            }
+            if (busRecovery.unrecoverable() && !wasUnrecoverable) {
+                LOG_CRITICAL("WaterPressureSensor: I2C bus unrecoverable after %d attempts, retrying with backoff",
+                             BUS_RECOVERY_MAX_ATTEMPTS);
+            }
             reading.valid = false;
-            reading.timestamp = TimeManagement::getInstance().getCurrentTimestamp();
-            lastReading = reading;
+            reading.tickUs = TimeManagement::monoUs();
+            publish(ch, reading);
             return reading;
         }
-
-        Wire.beginTransmission(ADS1115_I2C_ADDRESS);
-        if (Wire.endTransmission() != 0) {
-            busRecoveryAttempts++;
-            LOG_CRITICAL("WaterPressureSensor: I2C bus error, recovery attempt %d/%d", busRecoveryAttempts, BUS_RECOVERY_MAX_ATTEMPTS);
-            if (busRecoveryAttempts >= BUS_RECOVERY_MAX_ATTEMPTS) {
-                busUnrecoverable = true;
-                LOG_CRITICAL("WaterPressureSensor: I2C bus unrecoverable after %d attempts", BUS_RECOVERY_MAX_ATTEMPTS);
-            } else {
-                recoverBus();
-            }
+        if (!readOk) {
             reading.valid = false;
-            reading.timestamp = TimeManagement::getInstance().getCurrentTimestamp();
-            lastReading = reading;
+            reading.tickUs = TimeManagement::monoUs();
+            publish(ch, reading);
             return reading;
         }
 
-        int16_t rawADC = ads.getLastConversionResults();
-        // Compute voltage once and reuse — avoids calling ads.computeVolts() twice
-        // on the same raw value (P6 fix).
-        float computedVolts = ads.computeVolts(rawADC);
-        reading.millivolts = computedVolts * 1000.0f;
+        // Level comes straight from the raw code via the calibration table;
+        // millivolts is only for display and is a constant multiply at
+        // GAIN_ONE, so ads.computeVolts() is off this path entirely.
+        reading.millivolts = rawADC * ADS_GAIN_ONE_MV_PER_CODE;
         // C3: a successful I2C transaction means the bus is healthy right now,
-        // so reset the lifetime recovery-attempt counter. Without this, 10
-        // transient glitches spread across the device's entire service life
-        // would permanently disable flood detection (busUnrecoverable, only
-        // cleared by reboot) even though every glitch recovered cleanly.
-        busRecoveryAttempts = 0;
+        // so end any fault episode and reset the attempt counter. Without
+        // this, 10 transient glitches spread across the device's entire
+        // service life would exhaust the attempt budget even though every
+        // glitch recovered cleanly.
         uint32_t now = millis();
+        uint32_t recoveredBefore = busRecovery.recoveryCount();
+        busRecovery.onBusOk(now);
+        if (busRecovery.recoveryCount() != recoveredBefore) {
+            LOG_INFO("WaterPressureSensor: I2C bus recovered after %u ms",
+                     (unsigned)busRecovery.lastRecoveryDurationMs());
+        }
         if (now - lastLogTime >= 1000) {
-            LOG_DEBUG("WaterPressureSensor: millivolts reading = %.2f mV", reading.millivolts);
-            LOG_DEBUG("WaterPressureSensor: raw ADC = %d, computedVolts = %.5f V", rawADC, computedVolts);
+            LOG_DEBUG("WaterPressureSensor: ch%u millivolts reading = %.2f mV", ch, reading.millivolts);
+            LOG_DEBUG("WaterPressureSensor: ch%u raw ADC = %d", ch, rawADC);
+            if (windowReady) {
+                LOG_DEBUG("WaterPressureSensor: ch%u oversampled n=%u missed=%u",
+                          ch, c.decimatedCount, (unsigned)c.decimatedMissed);
+            }
             lastLogTime = now;
         }
-        reading.level_cm = voltageToCentimeters(reading.millivolts);
-        if (reading.millivolts < (zeroReadingVoltage_mv - READING_ERROR_MARGIN_MV)) reading.valid = false;
+        portENTER_CRITICAL(&sharedMux);
+        reading.level_cm = c.table.levelFromCode(rawADC);
+        if (rawADC < (c.validFloor_mv - READING_ERROR_MARGIN_MV) * ADS_GAIN_ONE_CODES_PER_MV) {
+            reading.valid = false;
+        }
+        portEXIT_CRITICAL(&sharedMux);
 
         // Over-range guard: the sensor can't physically read past its span, so a
         // higher computed level means an electrical fault, not rising water.
@@ -203,127 +375,348 @@ SensorReading WaterPressureSensor::readLevel() {
         }
 
         // Flatline guard: identical raw codes for minutes => frozen/dead sensor.
-        if (rawADC == lastStuckRawADC) {
-            stuckSampleCount++;
-            if (stuckSampleCount == (uint32_t)STUCK_SAMPLE_THRESHOLD) {
-                LOG_CRITICAL("WaterPressureSensor: flatline detected — raw ADC %d unchanged for %d samples",
-                             rawADC, STUCK_SAMPLE_THRESHOLD);
+        // A decimated sample only matches if its whole window was one code.
+        bool sameAsLast = (rawADC == c.lastStuckRawADC) && (!windowReady || c.decimatedFlat);
+        if (sameAsLast) {
+            c.stuckSampleCount++;
+            if (c.stuckSampleCount == (uint32_t)STUCK_SAMPLE_THRESHOLD) {
+                LOG_CRITICAL("WaterPressureSensor: ch%u flatline detected — raw ADC %d unchanged for %d samples",
+                             ch, rawADC, STUCK_SAMPLE_THRESHOLD);
             }
         } else {
-            stuckSampleCount = 0;
-            lastStuckRawADC = rawADC;
+            c.stuckSampleCount = 0;
+            c.lastStuckRawADC = rawADC;
         }
-        if (stuckSampleCount >= (uint32_t)STUCK_SAMPLE_THRESHOLD) {
+        if (c.stuckSampleCount >= (uint32_t)STUCK_SAMPLE_THRESHOLD) {
             reading.valid = false;
         }
     }
 
-    reading.timestamp = TimeManagement::getInstance().getCurrentTimestamp();
-    bufferPush(reading);
-    reading.level_cm = calculateMedianFromBuffer();
-    lastReading = reading;
+    ChannelState& c = channels[ch];
+    reading.tickUs = TimeManagement::monoUs();
+    c.levelMedian.push(reading.valid, reading.level_cm);
+    reading.level_cm = c.levelMedian.median();
 
-    if (reading.valid && (lastRateSampleTime == 0 || millis() - lastRateSampleTime >= RATE_SAMPLE_INTERVAL_MS)) {
-        lastRateSampleTime = millis();
-        rateBufferIndex = (rateBufferIndex + 1) % RATE_BUFFER_SIZE;
-        rateBuffer[rateBufferIndex] = { reading.level_cm, lastRateSampleTime, true };
+    if (reading.valid) {
+        c.rateEstimator.addSample(reading.tickUs, reading.level_cm);
     }
+    publish(ch, reading);
 
     return reading;
 }
 
 
-float WaterPressureSensor::getRateOfChange_cm30min() const {
-    const LevelSnapshot* oldest = nullptr;
-    const LevelSnapshot* newest = nullptr;
+void WaterPressureSensor::publish(uint8_t channel, const SensorReading& reading) {
+    ChannelState& c = channels[channel];
+    SensorReading tagged = reading;
+    tagged.channel = channel;
+
+    // Rate is evaluated here, on the producer, so readers on other tasks never
+    // touch the estimator's running sums.
+    float rate = c.rateEstimator.slopePerMinute() * 30.0f; // NAN propagates
+    float rateErr = c.rateEstimator.slopeStdErrPerMinute() * 30.0f;
+
+    lastReading = tagged;
+    c.lastReading = tagged;
+    c.readingCount++;
+    sampleSeq++;
+    portENTER_CRITICAL(&sharedMux);
+    c.latestReading = tagged;
+    c.latestRate_cm30min = rate;
+    c.latestRateStdErr_cm30min = rateErr;
+    portEXIT_CRITICAL(&sharedMux);
+}
+
+SensorReading WaterPressureSensor::getLatestReading(uint8_t channel) const {
+    if (channel >= SENSOR_CHANNELS) return SensorReading{};
+    portENTER_CRITICAL(&sharedMux);
+    SensorReading r = channels[channel].latestReading;
+    portEXIT_CRITICAL(&sharedMux);
+    return r;
+}
+
+float WaterPressureSensor::getRateOfChange_cm30min(uint8_t channel) const {
+    if (channel >= SENSOR_CHANNELS) return NAN;
+    portENTER_CRITICAL(&sharedMux);
+    float rate = channels[channel].latestRate_cm30min;
+    portEXIT_CRITICAL(&sharedMux);
+    return rate;
+}
+
+float WaterPressureSensor::getRateStdErr_cm30min(uint8_t channel) const {
+    if (channel >= SENSOR_CHANNELS) return NAN;
+    portENTER_CRITICAL(&sharedMux);
+    float rateErr = channels[channel].latestRateStdErr_cm30min;
+    portEXIT_CRITICAL(&sharedMux);
+    return rateErr;
+}
 
-    for (int i = 0; i < RATE_BUFFER_SIZE; i++) {
-        if (!rateBuffer[i].valid) continue;
-        if (!oldest || rateBuffer[i].millis_ts < oldest->millis_ts) oldest = &rateBuffer[i];
-        if (!newest || rateBuffer[i].millis_ts > newest->millis_ts) newest = &rateBuffer[i];
+
+bool WaterPressureSensor::startSamplingTask() {
+    BaseType_t ok = xTaskCreatePinnedToCore(samplerTaskEntry, "sensor", SAMPLER_TASK_STACK,
+                                            this, SAMPLER_TASK_PRIORITY, &samplerTask,
+                                            SAMPLER_TASK_CORE);
+    if (ok != pdPASS) {
+        LOG_CRITICAL("WaterPressureSensor: sampling task creation FAILED");
+        samplerTask = nullptr;
+        return false;
     }
+    return true;
+}
 
-    if (!oldest || !newest || oldest == newest) return NAN;
+uint32_t WaterPressureSensor::getStackHighWaterMark() const {
+    if (!samplerTask) return 0;
+    return (uint32_t)uxTaskGetStackHighWaterMark(samplerTask);
+}
 
-    uint32_t delta_ms = newest->millis_ts - oldest->millis_ts;
-    if (delta_ms < 1000) return NAN;
+void WaterPressureSensor::samplerTaskEntry(void* arg) {
+    static_cast<WaterPressureSensor*>(arg)->samplerRun();
+}
 
-    float delta_cm = newest->level_cm - oldest->level_cm;
-    float delta_min = delta_ms / 60000.0f;
-    return delta_cm / delta_min * 30.0f;
+void WaterPressureSensor::samplerRun() {
+    // Flood detection depends on this task, so it is watched like loop(): a
+    // hung I2C transaction reboots the device instead of freezing the level.
+    esp_task_wdt_add(NULL);
+
+    s_rdyNotifyTask = xTaskGetCurrentTaskHandle();
+    uint32_t handedOffSeq = sampleSeq;
+    for (;;) {
+        portENTER_CRITICAL(&sharedMux);
+        bool park = parkRequested;
+        if (park) parked = true;
+        portEXIT_CRITICAL(&sharedMux);
+        if (park) {
+            // Handed over to armWakeComparator(); deep sleep follows.
+            s_rdyNotifyTask = nullptr;
+            esp_task_wdt_delete(NULL);
+            vTaskSuspend(NULL);
+        }
+        esp_task_wdt_reset();
+        SensorReading reading = readLevel();
+        if (sampleSeq != handedOffSeq) {
+            handedOffSeq = sampleSeq;
+            if (!readingRing.push(reading)) {
+                ringDrops++;
+            }
+        }
+        // Sleep until the next conversion is ready. Edges that landed while
+        // readLevel() ran leave a notification pending, so this returns at
+        // once; drainConversions() counts any it was too slow for. The
+        // timeout paces polling mode and covers a lost or silent RDY line.
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SAMPLER_WAIT_MS));
+    }
 }
 
+bool WaterPressureSensor::armWakeComparator(float level_cm, uint8_t channel) {
+    if (useMockData || channel >= SENSOR_CHANNELS) return false;
 
-void WaterPressureSensor::bufferPush(SensorReading newReading) {
-    int bufferArraySize = sizeof(this->readingsBuffer) / sizeof(SensorReading);
-    if (this->currentReadingIndex == bufferArraySize - 1) {
-        this->currentReadingIndex = 0;
-    } else {
-        this->currentReadingIndex += 1;
+    int32_t code = 0;
+    portENTER_CRITICAL(&sharedMux);
+    bool ok = channels[channel].table.codeForLevel(level_cm, code);
+    portEXIT_CRITICAL(&sharedMux);
+    if (!ok) {
+        LOG_CRITICAL("WaterPressureSensor: no comparator code for %.1f cm on channel %u", level_cm, channel);
+        return false;
+    }
+
+    if (samplerTask && xTaskGetCurrentTaskHandle() != samplerTask) {
+        parkRequested = true;
+        uint32_t waitStart = millis();
+        while (eTaskGetState(samplerTask) != eSuspended &&
+               millis() - waitStart < SAMPLER_PARK_TIMEOUT_MS) {
+            delay(1);
+        }
+        // Withdraw the request unless the sampler already took it; once it
+        // has, it is past its last bus access and will suspend.
+        portENTER_CRITICAL(&sharedMux);
+        bool taken = parked;
+        if (!taken) parkRequested = false;
+        portEXIT_CRITICAL(&sharedMux);
+        if (!taken) {
+            LOG_CRITICAL("WaterPressureSensor: sampling task did not park");
+            return false;
+        }
+    }
+
+    if (rdyMode) {
+        detachInterrupt(digitalPinToInterrupt(ADS_ALERT_PIN));
+        rdyMode = false;
     }
-    this->readingsBuffer[currentReadingIndex] = newReading;
+    // 8 SPS is the ADS1115's lowest-power continuous rate; CQUE_1CONV and
+    // the latch (set by the library) keep ALERT low from the first
+    // conversion at or above the threshold until the ESP reads it.
+    ads.setGain(GAIN_ONE);
+    ads.setDataRate(RATE_ADS1115_8SPS);
+    ads.startComparator_SingleEnded(channel, (int16_t)code);
+    LOG_INFO("WaterPressureSensor: wake comparator armed on channel %u at %.1f cm (code %ld)",
+             channel, level_cm, (long)code);
+    return true;
 }
 
-void WaterPressureSensor::recoverBus() {
-    // Clock SCL 9 times to release a slave holding SDA low mid-transaction
-    pinMode(I2C_SCL_PIN, OUTPUT);
-    pinMode(I2C_SDA_PIN, OUTPUT);
-    digitalWrite(I2C_SDA_PIN, HIGH);
-    for (int i = 0; i < 9; i++) {
-        digitalWrite(I2C_SCL_PIN, HIGH);
-        delayMicroseconds(5);
-        digitalWrite(I2C_SCL_PIN, LOW);
-        delayMicroseconds(5);
+
+void WaterPressureSensor::runBusRecoveryStep(uint32_t now) {
+    // Each case is a few microseconds of pin toggling; the 1-10 ms between
+    // ticks is just a long clock-low phase, which I2C slaves tolerate.
+    switch (busRecovery.step(now)) {
+        case I2cBusRecovery::NONE:
+            break;
+        case I2cBusRecovery::TAKE_PINS:
+            // Detach the I2C driver so the pins can be driven as GPIO
+            Wire.end();
+            pinMode(I2C_SCL_PIN, OUTPUT);
+            pinMode(I2C_SDA_PIN, OUTPUT);
+            digitalWrite(I2C_SDA_PIN, HIGH);
+            digitalWrite(I2C_SCL_PIN, LOW);
+            break;
+        case I2cBusRecovery::CLOCK_PULSE:
+            // One SCL clock, to release a slave holding SDA low mid-transaction
+            digitalWrite(I2C_SCL_PIN, HIGH);
+            delayMicroseconds(5);
+            digitalWrite(I2C_SCL_PIN, LOW);
+            delayMicroseconds(5);
+            break;
+        case I2cBusRecovery::STOP:
+            // Issue STOP condition: SDA low -> SCL high -> SDA high
+            digitalWrite(I2C_SDA_PIN, LOW);
+            delayMicroseconds(5);
+            digitalWrite(I2C_SCL_PIN, HIGH);
+            delayMicroseconds(5);
+            digitalWrite(I2C_SDA_PIN, HIGH);
+            delayMicroseconds(5);
+            break;
+        case I2cBusRecovery::REINIT:
+            Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
+            Wire.setClock(100000);
+            if (ads.begin()) {
+                startContinuousConversions();
+                LOG_INFO("WaterPressureSensor: I2C bus re-initialised (attempt %u)", busRecovery.attemptCount());
+            }
+            break;
     }
-    // Issue STOP condition: SDA low -> SCL high -> SDA high
-    digitalWrite(I2C_SDA_PIN, LOW);
-    delayMicroseconds(5);
-    digitalWrite(I2C_SCL_PIN, HIGH);
-    delayMicroseconds(5);
-    digitalWrite(I2C_SDA_PIN, HIGH);
-    delayMicroseconds(5);
-
-    Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
-    Wire.setClock(100000);
-    if (ads.begin()) {
-        ads.setGain(GAIN_ONE);
-        ads.setDataRate(RATE_ADS1115_32SPS);
-        ads.startADCReading(MUX_BY_CHANNEL[CHANNEL], /*continuous=*/true);
-        LOG_INFO("WaterPressureSensor: I2C bus recovered");
+}
+
+void WaterPressureSensor::startContinuousConversions() {
+    ads.setGain(GAIN_ONE);
+    ads.setDataRate(adsDataRateFor(ADS_SAMPLE_RATE_SPS));
+    // Restart the scan on the first input: the window being built under the
+    // old configuration is no longer trustworthy.
+    for (uint8_t ch = 0; ch < SENSOR_CHANNELS; ch++) {
+        channels[ch].resetWindow();
     }
+    scanChannel = 0;
+    settleRemaining = ADS_MUX_SETTLE_CONVERSIONS;
+    // Edges raised while the ADS was being reconfigured (or during a bus
+    // recovery) belong to no window.
+    rdySeenCount = s_rdyEdgeCount;
+    lastRdyTime = millis();
+    // startADCReading() also programs Hi_thresh=0x8000/Lo_thresh=0x0000, which
+    // puts ALERT/RDY in conversion-ready mode (8 us low pulse per conversion).
+    ads.startADCReading(MUX_BY_CHANNEL[scanChannel], /*continuous=*/true);
 }
 
+bool WaterPressureSensor::readConversion(int16_t& raw) {
+    // The driver's getLastConversionResults() can't report a failed
+    // transfer, so the register is read here: pointer, then two bytes.
+    Wire.beginTransmission(ADS1115_I2C_ADDRESS);
+    Wire.write(ADS1X15_REG_POINTER_CONVERT);
+    if (Wire.endTransmission() != 0) return false;
+    if (Wire.requestFrom(ADS1115_I2C_ADDRESS, (uint8_t)2) != 2) return false;
+    uint8_t hi = (uint8_t)Wire.read();
+    uint8_t lo = (uint8_t)Wire.read();
+    raw = (int16_t)((hi << 8) | lo);
+    return true;
+}
 
-float WaterPressureSensor::calculateMedianFromBuffer() {
-    // Create a temporary array of valid readings from the buffer
-    float validReadings[READINGS_BUFFER_SIZE];
-    int validCount = 0;
-    
-    // Collect all valid readings
-    for (int i = 0; i < READINGS_BUFFER_SIZE; i++) {
-        if (readingsBuffer[i].valid) {
-            validReadings[validCount] = readingsBuffer[i].level_cm;
-            validCount++;
+bool WaterPressureSensor::adsResponds() {
+    Wire.beginTransmission(ADS1115_I2C_ADDRESS);
+    return Wire.endTransmission() == 0;
+}
+
+bool WaterPressureSensor::readPolled(uint8_t channel, int16_t& raw) {
+    // One input: the ADS is still converting continuously on it. Several:
+    // a single-shot per input, waited out (~1/SPS each, on the sampling task).
+    if (SENSOR_CHANNELS > 1) {
+        ads.startADCReading(MUX_BY_CHANNEL[channel], /*continuous=*/false);
+        delay(ADS_CONVERSION_WAIT_MS);
+    }
+    return readConversion(raw);
+}
+
+int WaterPressureSensor::drainConversions() {
+    uint32_t edges = s_rdyEdgeCount; // aligned 32-bit read is atomic on Xtensa
+    uint32_t now = millis();
+
+    if (edges == rdySeenCount) {
+        if (now - lastRdyTime >= ADS_RDY_TIMEOUT_MS) {
+            // ADS stopped pulsing RDY (brown-out reset to single-shot, or the
+            // pull-up lost). Re-arm continuous mode and fall back to polling so
+            // flood detection never waits on an interrupt that isn't coming.
+            detachInterrupt(digitalPinToInterrupt(ADS_ALERT_PIN));
+            rdyMode = false;
+            startContinuousConversions();
+            LOG_CRITICAL("WaterPressureSensor: ALERT/RDY silent for %u ms, falling back to 1 Hz polling",
+                         (unsigned)(now - lastRdyTime));
         }
+        return -1;
     }
-    
-    // If no valid readings, return 0
-    if (validCount == 0) {
-        return 0;
+
+    // Only the newest conversion is readable (single conversion register);
+    // extra edges since the last drain are conversions we were too slow for.
+    uint32_t elapsed = edges - rdySeenCount;
+    rdySeenCount = edges;
+    lastRdyTime = now;
+
+    int16_t raw = 0;
+    bool readOk = readConversion(raw);
+
+    // Still settling after a mux switch: conversions (read or missed) inside
+    // the settle span belong to no channel.
+    if (elapsed <= settleRemaining) {
+        settleRemaining -= elapsed;
+        return -1;
     }
-    
-    // Sort the valid readings
-    std::sort(validReadings, validReadings + validCount);
-    
-    // Calculate median
-    if (validCount % 2 == 1) {
-        // Odd number of readings: return the middle one
-        return validReadings[validCount / 2];
+    elapsed -= settleRemaining;
+    settleRemaining = 0;
+
+    ChannelState& c = channels[scanChannel];
+    if (readOk) {
+        c.oversampleMissed += elapsed - 1;
+        c.oversampleSum += raw;
+        c.oversampleCount++;
+        if (raw < c.oversampleMin) c.oversampleMin = raw;
+        if (raw > c.oversampleMax) c.oversampleMax = raw;
     } else {
-        // Even number of readings: return average of two middle values
-        return (validReadings[validCount / 2 - 1] + validReadings[validCount / 2]) / 2.0;
+        // Lost like a missed one; readLevel() checks the bus when the window closes
+        c.oversampleMissed += elapsed;
+        c.oversampleReadErrors++;
+    }
+
+    // Close the window on elapsed conversions (read + missed) so a slow caller
+    // still produces ~1 sample/s per channel, just averaged over fewer
+    // conversions — and the scan never lingers on one input.
+    if (c.oversampleCount + c.oversampleMissed < ADS_CHANNEL_DWELL_CONVERSIONS) {
+        return -1;
+    }
+
+    c.decimatedRaw = c.oversampleCount ?
+        (int16_t)lroundf((float)c.oversampleSum / c.oversampleCount) : 0;
+    c.decimatedFlat = (c.oversampleMin == c.oversampleMax);
+    c.decimatedCount = c.oversampleCount;
+    c.decimatedMissed = c.oversampleMissed;
+    c.decimatedReadErrors = c.oversampleReadErrors;
+    missedConversions += c.oversampleMissed;
+    c.resetWindow();
+
+    int done = scanChannel;
+    if (SENSOR_CHANNELS > 1) {
+        scanChannel = (uint8_t)((scanChannel + 1) % SENSOR_CHANNELS);
+        settleRemaining = ADS_MUX_SETTLE_CONVERSIONS;
+        // Re-writing the config in continuous mode just swaps the mux; the
+        // comparator (RDY) thresholds written alongside are unchanged.
+        ads.startADCReading(MUX_BY_CHANNEL[scanChannel], /*continuous=*/true);
     }
+    return done;
 }
 
 
-#endif // UNIT_TESTING
+#endif // !UNIT_TESTING || NATIVE_SENSOR_SHIM
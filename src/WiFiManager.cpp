@@ -3,7 +3,42 @@
 #include "Logger.h"
 #include <esp_task_wdt.h>
 #include <esp_timer.h>
+#include <esp_attr.h>
+#include "esp32/rom/crc.h"
+
+// Where the last connection landed. After a reboot, tryFastConnect() joins
+// that AP directly and skips the scan. The RTC copy survives soft resets and
+// brownouts; the NVS copy, rewritten only when the AP changes, survives a
+// power cut.
+struct LinkHint {
+    uint32_t magic;
+    char     ssid[WiFiCredential::SSID_MAX];
+    uint8_t  bssid[6];
+    uint8_t  channel;
+    uint32_t crc;
+};
+
+static constexpr uint32_t LINK_HINT_MAGIC = 0x574c4e4b; // "WLNK"
+static constexpr const char LINK_HINT_KEY[] = "link";
+RTC_NOINIT_ATTR static LinkHint rtcHint;
+
+static uint32_t hintCrc(const LinkHint& h) {
+    return crc32_le(0, (const uint8_t*)&h, offsetof(LinkHint, crc));
+}
+
+static bool hintValid(const LinkHint& h) {
+    return h.magic == LINK_HINT_MAGIC && h.crc == hintCrc(h) &&
+           h.channel >= 1 && h.channel <= 14;
+}
 
+static bool readNvsHint(LinkHint& out) {
+    Preferences prefs;
+    if (!prefs.begin(WIFI_PREFERENCES_NAMESPACE, true)) return false;
+    bool ok = prefs.getBytesLength(LINK_HINT_KEY) == sizeof(out) &&
+              prefs.getBytes(LINK_HINT_KEY, &out, sizeof(out)) == sizeof(out);
+    prefs.end();
+    return ok && hintValid(out);
+}
 
 // Singleton instance getter
 WiFiManager& WiFiManager::getInstance() {
@@ -13,6 +48,9 @@ WiFiManager& WiFiManager::getInstance() {
 
 WiFiManager::WiFiManager() {
     // Constructor is called by getInstance() during first access
+    credMux = xSemaphoreCreateMutex();
+    scanMux = xSemaphoreCreateMutex();
+    linkEvents = xEventGroupCreate();
 }
 
 WiFiManager::~WiFiManager() {
@@ -25,7 +63,95 @@ void WiFiManager::begin() {
     loadCredentials();
     WiFi.mode(WIFI_STA);
     WiFi.onEvent(onWiFiEvent, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
-    connectToBestNetwork();
+    WiFi.onEvent(onWiFiEvent, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+    if (!tryFastConnect()) {
+        connectToBestNetwork();
+    }
+}
+
+bool WiFiManager::tryFastConnect() {
+    LinkHint hint;
+    if (hintValid(rtcHint)) {
+        memcpy(&hint, &rtcHint, sizeof(hint));
+    } else if (!readNvsHint(hint)) {
+        return false;
+    }
+
+    // Only while the network is still stored
+    WiFiCredential cred;
+    bool found = false;
+    xSemaphoreTake(credMux, portMAX_DELAY);
+    for (auto& n : storedNetworks) {
+        if (strcmp(n.ssid, hint.ssid) == 0) { cred = n; found = true; break; }
+    }
+    xSemaphoreGive(credMux);
+    if (!found) return false;
+
+    LOG_NETWORK("[WIFI] Fast connect: %s via %02x:%02x:%02x:%02x:%02x:%02x ch%u",
+                hint.ssid, hint.bssid[0], hint.bssid[1], hint.bssid[2],
+                hint.bssid[3], hint.bssid[4], hint.bssid[5], hint.channel);
+    int64_t startUs = esp_timer_get_time();
+    WiFi.begin(cred.ssid, cred.password, hint.channel, hint.bssid);
+    if (waitForLink(FAST_CONNECT_TIMEOUT_MS)) {
+        markConnected();
+        LOG_NETWORK("[WIFI] Connected in %lums! IP: %s",
+                    (unsigned long)((esp_timer_get_time() - startUs) / 1000),
+                    WiFi.localIP().toString().c_str());
+        return true;
+    }
+    LOG_NETWORK("[WIFI] Fast connect failed - scanning");
+    WiFi.disconnect();
+    return false;
+}
+
+// Block until GOT_IP or the timeout, feeding the task watchdog at least
+// every 500 ms (this runs on the loop task, see connectToBestNetwork())
+bool WiFiManager::waitForLink(uint32_t timeoutMs) {
+    uint32_t start = millis();
+    for (;;) {
+        if (WiFi.status() == WL_CONNECTED) return true;
+        uint32_t elapsed = millis() - start;
+        if (elapsed >= timeoutMs) return false;
+        uint32_t slice = timeoutMs - elapsed < 500 ? timeoutMs - elapsed : 500;
+        esp_task_wdt_reset();
+        if (xEventGroupWaitBits(linkEvents, LINK_UP_BIT, pdFALSE, pdTRUE,
+                                pdMS_TO_TICKS(slice)) & LINK_UP_BIT) {
+            return true;
+        }
+    }
+}
+
+void WiFiManager::markConnected() {
+    isWiFiConnected = true;
+    _connectedSinceUs = esp_timer_get_time();
+    _disconnectedSinceUs = 0;
+    _reconnectAttemptCount = 0;
+    rememberLink();
+}
+
+void WiFiManager::rememberLink() {
+    LinkHint h;
+    memset(&h, 0, sizeof(h));
+    strncpy(h.ssid, WiFi.SSID().c_str(), sizeof(h.ssid) - 1);
+    const uint8_t* bssid = WiFi.BSSID();
+    if (!bssid) return;
+    memcpy(h.bssid, bssid, sizeof(h.bssid));
+    h.channel = (uint8_t)WiFi.channel();
+    h.magic = LINK_HINT_MAGIC;
+    h.crc = hintCrc(h);
+    if (!hintValid(h)) return;
+
+    if (hintValid(rtcHint) && memcmp(&rtcHint, &h, sizeof(h)) == 0) return;
+    memcpy(&rtcHint, &h, sizeof(h));
+
+    // NVS only when the AP really changed (RTC is lost on power-up)
+    LinkHint stored;
+    if (readNvsHint(stored) && memcmp(&stored, &h, sizeof(h)) == 0) return;
+    Preferences prefs;
+    if (prefs.begin(WIFI_PREFERENCES_NAMESPACE, false)) {
+        prefs.putBytes(LINK_HINT_KEY, &h, sizeof(h));
+        prefs.end();
+    }
 }
 
 void WiFiManager::loadCredentials() {
@@ -63,6 +189,7 @@ void WiFiManager::loadCredentials() {
 }
 
 void WiFiManager::addNetwork(const char* ssid, const char* password) {
+    xSemaphoreTake(credMux, portMAX_DELAY);
     // Update password if network already exists — write only that one key
     for (int i = 0; i < (int)storedNetworks.size(); i++) {
         if (strcmp(storedNetworks[i].ssid, ssid) == 0) {
@@ -79,11 +206,13 @@ void WiFiManager::addNetwork(const char* ssid, const char* password) {
                 LOG_CRITICAL("WiFiManager: Failed to open preferences, reloading from NVS");
                 loadCredentials();
             }
+            xSemaphoreGive(credMux);
             return;
         }
     }
 
     if ((int)storedNetworks.size() >= MAX_NETWORKS) {
+        xSemaphoreGive(credMux);
         LOG_NETWORK("Max networks reached!");
         return;
     }
@@ -110,6 +239,7 @@ void WiFiManager::addNetwork(const char* ssid, const char* password) {
         LOG_CRITICAL("WiFiManager: Failed to open preferences, reloading from NVS");
         loadCredentials();
     }
+    xSemaphoreGive(credMux);
 
     // Attempt an immediate connection when in STA mode and not yet connected.
     // Skip in AP/AP_STA mode (CONFIG state) — connectToBestNetwork() will be
@@ -120,6 +250,7 @@ void WiFiManager::addNetwork(const char* ssid, const char* password) {
 }
 
 void WiFiManager::removeNetwork(const char* ssid) {
+    xSemaphoreTake(credMux, portMAX_DELAY);
     for (auto it = storedNetworks.begin(); it != storedNetworks.end(); ++it) {
         if (strcmp(it->ssid, ssid) == 0) {
             String removed = it->ssid;
@@ -147,76 +278,84 @@ void WiFiManager::removeNetwork(const char* ssid) {
                 LOG_CRITICAL("WiFiManager: Failed to open preferences, reloading from NVS");
                 loadCredentials();
             }
+            xSemaphoreGive(credMux);
             return;
         }
     }
+    xSemaphoreGive(credMux);
     LOG_NETWORK("Network not found: %s", ssid);
 }
 
 void WiFiManager::connectToBestNetwork() {
-    if (storedNetworks.empty()) {
+    // Work on a copy so the scan and connect below (seconds) don't hold
+    // credMux against the config web server
+    xSemaphoreTake(credMux, portMAX_DELAY);
+    std::vector<WiFiCredential> networks(storedNetworks);
+    xSemaphoreGive(credMux);
+
+    if (networks.empty()) {
         LOG_NETWORK("No stored networks available!");
         return;
     }
     
-    LOG_NETWORK("[WIFI] Scanning for available networks...");
-    // The scan is a single blocking call (~2-5s on 2.4GHz) and runs on the
-    // loop task, which is subscribed to the 10s task watchdog. Feed the dog
-    // before the scan so a slow/crowded-band scan can't trip it (C1). The
-    // call is a no-op if the WDT isn't armed yet (e.g. during boot, before
-    // esp_task_wdt_add() runs in setup()).
-    esp_task_wdt_reset();
-    int numNetworks = WiFi.scanNetworks();
-    LOG_NETWORK("[WIFI] Scan found %d network(s):", numNetworks);
-    for (int i = 0; i < numNetworks; i++) {
-        bool isStored = false;
-        for (int j = 0; j < (int)storedNetworks.size(); j++) {
-            if (WiFi.SSID(i) == storedNetworks[j].ssid) { isStored = true; break; }
+    ScanCache scan = getScanResults();
+    if (!scan.valid() || scan.ageMs(millis()) > SCAN_FRESH_MS) {
+        // No recent background scan to go on. Finish the one in flight if
+        // there is one (starting another would just fail), else scan now.
+        int numNetworks;
+        if (_scanRunning) {
+            LOG_NETWORK("[WIFI] Waiting for background scan...");
+            numNetworks = waitForScan();
+        } else {
+            LOG_NETWORK("[WIFI] Scanning for available networks...");
+            // The scan is a single blocking call (~2-5s on 2.4GHz) and runs on the
+            // loop task, which is subscribed to the 10s task watchdog. Feed the dog
+            // before the scan so a slow/crowded-band scan can't trip it (C1). The
+            // call is a no-op if the WDT isn't armed yet (e.g. during boot, before
+            // esp_task_wdt_add() runs in setup()).
+            esp_task_wdt_reset();
+            _scanStartedMs = millis();
+            numNetworks = WiFi.scanNetworks();
         }
-        LOG_NETWORK("  [%d] %-32s  %4d dBm  ch%-2d%s",
-                    i, WiFi.SSID(i).c_str(), WiFi.RSSI(i), WiFi.channel(i),
-                    isStored ? "  *" : "");
+        storeScan(numNetworks);
+        scan = getScanResults();
+    } else {
+        LOG_NETWORK("[WIFI] Using scan from %lus ago", (unsigned long)(scan.ageMs(millis()) / 1000));
     }
 
+    LOG_NETWORK("[WIFI] Scan found %u network(s):", scan.size());
     int bestNetwork = -1;
     int bestRSSI = -120;
-
-    for (int i = 0; i < numNetworks; i++) {
-        String scannedSSID = WiFi.SSID(i);
-        int scannedRSSI = WiFi.RSSI(i);
-
-        for (int j = 0; j < (int)storedNetworks.size(); j++) {
-            if (scannedSSID == storedNetworks[j].ssid) {
-                if (scannedRSSI > bestRSSI) {
-                    bestRSSI = scannedRSSI;
-                    bestNetwork = j;
-                }
-                break;
-            }
+    uint8_t bestChannel = 0;
+    // The cache is sorted strongest first, so the first stored SSID in it
+    // is the best candidate
+    for (uint8_t i = 0; i < scan.size(); i++) {
+        int stored = -1;
+        for (int j = 0; j < (int)networks.size(); j++) {
+            if (strcmp(scan[i].ssid, networks[j].ssid) == 0) { stored = j; break; }
+        }
+        LOG_NETWORK("  [%u] %-32s  %4d dBm  ch%-2u%s",
+                    i, scan[i].ssid, scan[i].rssi, scan[i].channel,
+                    stored >= 0 ? "  *" : "");
+        if (stored >= 0 && bestNetwork == -1) {
+            bestNetwork = stored;
+            bestRSSI = scan[i].rssi;
+            bestChannel = scan[i].channel;
         }
     }
 
     if (bestNetwork != -1) {
-        LOG_NETWORK("[WIFI] Connecting to: %s (%d dBm)", storedNetworks[bestNetwork].ssid, bestRSSI);
-
-        WiFi.begin(storedNetworks[bestNetwork].ssid, storedNetworks[bestNetwork].password);
+        LOG_NETWORK("[WIFI] Connecting to: %s (%d dBm)", networks[bestNetwork].ssid, bestRSSI);
 
-        unsigned long startTime = millis();
-        while (WiFi.status() != WL_CONNECTED && (millis() - startTime) < CONNECT_TIMEOUT_MS) {
-            // Feed the task watchdog on every iteration. This connect loop
-            // can block for up to CONNECT_TIMEOUT_MS (15s) — longer than the
-            // 10s WDT — and is reachable from loop() via stopSetupMode()
-            // after the config-portal idle timeout (C1). delay() does NOT
-            // feed the ESP-IDF task watchdog, so an explicit reset is required.
-            esp_task_wdt_reset();
-            delay(500);
-        }
+        // Passing the scanned channel lets the driver probe just that one
+        WiFi.begin(networks[bestNetwork].ssid, networks[bestNetwork].password, bestChannel);
 
-        if (WiFi.status() == WL_CONNECTED) {
-            isWiFiConnected = true;
-            _connectedSinceUs = esp_timer_get_time();
-            _disconnectedSinceUs = 0;
-            _reconnectAttemptCount = 0;
+        // waitForLink() feeds the task watchdog while it waits. This connect
+        // can block for up to CONNECT_TIMEOUT_MS (15s) — longer than the
+        // 10s WDT — and is reachable from loop() via stopSetupMode()
+        // after the config-portal idle timeout (C1).
+        if (waitForLink(CONNECT_TIMEOUT_MS)) {
+            markConnected();
             LOG_NETWORK("[WIFI] Connected! IP: %s", WiFi.localIP().toString().c_str());
         } else {
             isWiFiConnected = false;
@@ -225,15 +364,82 @@ void WiFiManager::connectToBestNetwork() {
     } else {
         LOG_NETWORK("[WIFI] No stored networks found in scan results!");
     }
-    
+}
+
+ScanCache WiFiManager::getScanResults() {
+    ScanCache copy;
+    xSemaphoreTake(scanMux, portMAX_DELAY);
+    copy = scanCache;
+    xSemaphoreGive(scanMux);
+    return copy;
+}
+
+void WiFiManager::storeScan(int numNetworks) {
+    _scanRunning = false;
+    if (numNetworks < 0) {
+        // WIFI_SCAN_FAILED (or still running after waitForScan() gave up);
+        // keep the previous results, they still carry their age
+        LOG_NETWORK("[WIFI] Scan failed (%d)", numNetworks);
+        WiFi.scanDelete();
+        return;
+    }
+    ScanCache fresh;
+    for (int i = 0; i < numNetworks; i++) {
+        fresh.add(WiFi.SSID(i).c_str(), WiFi.RSSI(i), (uint8_t)WiFi.channel(i),
+                  WiFi.encryptionType(i) == WIFI_AUTH_OPEN);
+    }
+    fresh.stamp(millis());
     WiFi.scanDelete();
+
+    xSemaphoreTake(scanMux, portMAX_DELAY);
+    scanCache = fresh;
+    xSemaphoreGive(scanMux);
+}
+
+int WiFiManager::waitForScan() {
+    int n;
+    while ((n = WiFi.scanComplete()) == WIFI_SCAN_RUNNING &&
+           millis() - _scanStartedMs < SCAN_TIMEOUT_MS) {
+        esp_task_wdt_reset();
+        delay(100);
+    }
+    return n;
+}
+
+void WiFiManager::pollScan() {
+    uint32_t now = millis();
+    if (_scanRunning) {
+        int n = WiFi.scanComplete();
+        if (n == WIFI_SCAN_RUNNING && now - _scanStartedMs < SCAN_TIMEOUT_MS) return;
+        storeScan(n);
+        return;
+    }
+
+    // Scheduled scans only when the list is likely to be looked at: while
+    // disconnected (the next fallback connectToBestNetwork() reads it) or
+    // while the portal is up. A connected STA keeps its link undisturbed.
+    bool scheduled = (WiFi.status() != WL_CONNECTED || (WiFi.getMode() & WIFI_MODE_AP)) &&
+                     now - _scanStartedMs >= SCAN_INTERVAL_MS;
+    if (!_scanRequested && !scheduled) return;
+    _scanRequested = false;
+    _scanStartedMs = now;
+
+    // Async: returns at once, results are collected by a later pollScan()
+    if (WiFi.scanNetworks(true) == WIFI_SCAN_FAILED) {
+        // Typically the driver is mid-connect; try again next interval
+        LOG_NETWORK("[WIFI] Background scan could not start");
+        return;
+    }
+    _scanRunning = true;
 }
 
 std::vector<String> WiFiManager::getStoredSSIDs() {
     std::vector<String> ssids;
+    xSemaphoreTake(credMux, portMAX_DELAY);
     for (auto& cred : storedNetworks) {
         ssids.push_back(String(cred.ssid));
     }
+    xSemaphoreGive(credMux);
     return ssids;
 }
 
@@ -248,6 +454,8 @@ void WiFiManager::disconnect() {
 }
 
 void WiFiManager::maintainConnection() {
+    pollScan();
+
     if (WiFi.status() == WL_CONNECTED) {
         if (_disconnectedSinceUs != 0) {
             // Just came back up. Duration is computed from the 64-bit monotonic
@@ -268,6 +476,7 @@ void WiFiManager::maintainConnection() {
             _disconnectedSinceUs = 0;
             _reconnectAttemptCount = 0;
             _lastDisconnectReason = 0;
+            rememberLink();     // the driver may have come back on another AP
         }
         return;
     }
@@ -325,7 +534,13 @@ int WiFiManager::getRSSI() {
 }
 
 void WiFiManager::onWiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info) {
-    getInstance()._lastDisconnectReason = info.wifi_sta_disconnected.reason;
+    WiFiManager& self = getInstance();
+    if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+        xEventGroupSetBits(self.linkEvents, LINK_UP_BIT);
+        return;
+    }
+    xEventGroupClearBits(self.linkEvents, LINK_UP_BIT);
+    self._lastDisconnectReason = info.wifi_sta_disconnected.reason;
 }
 
 const char* WiFiManager::reasonToString(uint8_t reason) {
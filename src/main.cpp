@@ -12,6 +12,7 @@
 #include "WiFiManager.h"
 #include "ConfigServer.h"
 #include "LightCode.h"
+#include "PulseOutput.h"
 #include "WaterPressureSensor.h"
 #include "SmsChannel.h"
 #include "DiscordChannel.h"
@@ -23,10 +24,35 @@
 #include "SettingsStore.h"
 #include "BoardPins.h"
 #include "Version.h"
+#include "LoopScheduler.h"
+#include "LoopProfiler.h"
+#include "SnapshotCell.h"
+#include "TelemetryGate.h"
+#include "LevelWindow.h"
+#include "TelemetryStore.h"
+#include "NvsStore.h"
+#include "HostResolver.h"
+#include "LowPower.h"
 #include <ArduinoJson.h>
 
 // Forward declarations
 void handleButtonPress();
+static void controlJob(void*);
+static void mqttJob(void*);
+static void lightJob(void*);
+static void wifiJob(void*);
+static void rtcJob(void*);
+static void otaJob(void*);
+static void statusJob(void*);
+static void telemetryJob(void*);
+static void backfillJob(void*);
+static void lowPowerJob(void*);
+#if LOOP_PROFILER
+static void publishLoopProfile(const char* base);
+static size_t copyLoopProfile(char* out, size_t len, void*);
+#endif
+static void fillTemplateContext(TemplateContext& ctx);
+static void onLogMaskCommand(void*, const char* topic, const uint8_t* payload, size_t len);
 
 // The canonical state machine context. All state lives here; loop() is a thin
 // dispatcher that calls updateStateMachine(), reads the output, and executes
@@ -35,11 +61,137 @@ StateMachineContext smCtx;
 
 // Status logging
 static constexpr uint32_t STATUS_LOG_INTERVAL_MS = 10000; // Log status every 10 seconds
-uint32_t lastStatusLogTime = 0;
 
 // Structured telemetry publishing (MQTT <baseTopic>/telemetry, for Grafana/HA)
 static constexpr uint32_t TELEMETRY_INTERVAL_MS = 60000; // Publish telemetry every 60 seconds
-uint32_t lastTelemetryTime = 0;
+// Telemetry JSON sizing. The window aggregates (level_min_cm ... above_tier1_s)
+// add ~160 bytes, and multi-compartment builds a "compartments" array
+// (~56 bytes of JSON per compartment). The payload plus topic/header overhead
+// must fit PubSubClient's buffer, so those builds need a larger
+// MQTT_MAX_PACKET_SIZE in platformio.ini.
+static constexpr size_t TELEMETRY_DOC_SIZE =
+    640 + (SENSOR_CHANNELS > 1 ? 32 + 80 * SENSOR_CHANNELS : 0);
+static constexpr size_t TELEMETRY_PAYLOAD_MAX =
+    608 + (SENSOR_CHANNELS > 1 ? 32 + 56 * SENSOR_CHANNELS : 0);
+static_assert(TELEMETRY_PAYLOAD_MAX + 64 <= MQTT_MAX_PACKET_SIZE,
+              "telemetry payload exceeds MQTT_MAX_PACKET_SIZE — raise it in platformio.ini build_flags");
+// Notification latency histograms, one retained message per channel on
+// <baseTopic>/telemetry/notify/<channel> (three histograms don't fit the
+// main telemetry payload).
+static constexpr size_t NOTIFY_LATENCY_PAYLOAD_MAX = 448;
+static_assert(NOTIFY_LATENCY_PAYLOAD_MAX + 64 <= MQTT_MAX_PACKET_SIZE,
+              "notify latency payload exceeds MQTT_MAX_PACKET_SIZE");
+
+// Telemetry encoding. TELEMETRY_MSGPACK=1 publishes the same fields as
+// MessagePack on <baseTopic>/telemetry/msgpack instead of JSON (roughly 30%
+// smaller on the wire; Telegraf decodes it, Home Assistant doesn't).
+#ifndef TELEMETRY_MSGPACK
+#define TELEMETRY_MSGPACK 0
+#endif
+// Report-by-exception: TELEMETRY_REPORT_BY_EXCEPTION=1 checks every 10 s but
+// publishes only when the level, rate or state moves past its deadband (see
+// TelemetryGate.h), plus a keep-alive every TELEMETRY_HEARTBEAT_MS. A quiet
+// boat then costs ~4 messages an hour instead of 60.
+#ifndef TELEMETRY_REPORT_BY_EXCEPTION
+#define TELEMETRY_REPORT_BY_EXCEPTION 0
+#endif
+static constexpr uint32_t TELEMETRY_CHECK_MS            = 10000;
+static constexpr float    TELEMETRY_LEVEL_DEADBAND_CM   = 1.0f;
+static constexpr float    TELEMETRY_RATE_DEADBAND_CM30  = 0.5f;
+static constexpr uint32_t TELEMETRY_HEARTBEAT_MS        = 15UL * 60000UL;
+static TelemetryGate telemetryGate(TELEMETRY_LEVEL_DEADBAND_CM,
+                                   TELEMETRY_RATE_DEADBAND_CM30,
+                                   TELEMETRY_HEARTBEAT_MS);
+static uint32_t telemetrySent = 0;
+static uint32_t telemetrySuppressed = 0;
+static TelemetryGate::Reason telemetryLastReason = TelemetryGate::REASON_NONE;
+// Static fields go to the retained <baseTopic>/info message instead of every
+// telemetry publish. Re-sent on change, on every new broker session, and
+// hourly so dashboards that look back a day always find a recent copy.
+static constexpr uint32_t DEVICE_INFO_REFRESH_MS    = 60UL * 60000UL;
+static constexpr size_t   DEVICE_INFO_PAYLOAD_MAX   = 256;
+// Store-and-forward (TelemetryStore.h): one reading a minute is kept in flash
+// while MQTT is down and backfilled after reconnect, one message per
+// BACKFILL_PERIOD_MS and only while the log queue is empty, so it never
+// competes with live telemetry or log drain.
+static constexpr uint32_t TELEMETRY_STORE_INTERVAL_MS = 60000;
+static constexpr uint32_t BACKFILL_PERIOD_MS          = 1000;
+TelemetryStore telemetryStore;
+
+// Low-power monitoring: LOW_POWER_MODE=1 deep sleeps whenever the boat is
+// quiet (LowPowerPolicy.h). The ADS1115 comparator wakes the board
+// LOW_POWER_WAKE_MARGIN_CM below the Tier 1 level, the timer every
+// LOW_POWER_HEARTBEAT_S to report; the button wakes it for the config UI.
+// Off by default: MQTT shows the device offline between wakes, and with
+// several compartments only the highest one is watched by the comparator
+// (the others are checked on the heartbeat).
+#ifndef LOW_POWER_MODE
+#define LOW_POWER_MODE 0
+#endif
+static constexpr uint32_t LOW_POWER_HEARTBEAT_S        = 900;
+static constexpr float    LOW_POWER_WAKE_MARGIN_CM     = 2.0f;
+static constexpr uint32_t LOW_POWER_POWER_ON_AWAKE_MS  = 10UL * 60000UL;
+static constexpr uint32_t LOW_POWER_LEVEL_AWAKE_MS     = 60000;
+static constexpr uint32_t LOW_POWER_REPORT_TIMEOUT_MS  = 45000;
+static constexpr uint32_t LOW_POWER_CHECK_MS           = 1000;
+static LowPowerPolicy lowPowerPolicy(LOW_POWER_POWER_ON_AWAKE_MS,
+                                     LOW_POWER_LEVEL_AWAKE_MS,
+                                     LOW_POWER_REPORT_TIMEOUT_MS);
+
+// loop() job periods and run-time budgets (see LoopScheduler.h). The control
+// job — sensor drain, state machine, alert outputs — runs every tick; the
+// rest run at the rate they actually need instead of on every 10 ms pass.
+static constexpr uint32_t CONTROL_PERIOD_MS  = 10;
+static constexpr uint32_t MQTT_PERIOD_MS     = 20;
+static constexpr uint32_t LIGHT_PERIOD_MS    = 20;   // software fallback only; shortest LED phase is 100 ms
+static constexpr uint32_t WIFI_PERIOD_MS     = 500;
+static constexpr uint32_t RTC_PERIOD_MS      = 1000;
+static constexpr uint32_t OTA_PERIOD_MS      = 1000;
+// Longest single idle between jobs, so the watchdog is still fed promptly
+static constexpr uint32_t LOOP_MAX_IDLE_MS   = 100;
+
+LoopScheduler scheduler([]() -> uint32_t { return (uint32_t)micros(); });
+
+// loop() profiler (LoopProfiler.h): cycle-counter timing of the sections
+// below, each loop() pass against the task watchdog, and the slowest pass's
+// breakdown. Published with telemetry and on /debug. LOOP_PROFILER=0 (the
+// PRODUCTION_BUILD default) compiles every PROFILE_* site to nothing.
+enum LoopSection : uint8_t {
+    PROF_CONTROL, PROF_SENSOR, PROF_STATE, PROF_CONFIG, PROF_MQTT, PROF_LIGHT,
+    PROF_WIFI, PROF_RTC, PROF_OTA, PROF_STATUS, PROF_TELEMETRY, PROF_SERIALIZE,
+    PROF_BACKFILL, PROF_LOWPOWER, PROF_SECTION_COUNT
+};
+#if LOOP_PROFILER
+static const char* const LOOP_SECTION_NAMES[PROF_SECTION_COUNT] = {
+    "control", "sensor", "state", "config", "mqtt", "light",
+    "wifi", "rtc", "ota", "status", "telemetry", "serialize",
+    "backfill", "lowpower"
+};
+static LoopProfiler loopProfiler(LOOP_SECTION_NAMES, PROF_SECTION_COUNT,
+                                 []() -> uint32_t { return ESP.getCycleCount(); },
+                                 F_CPU / 1000000);
+// <baseTopic>/telemetry/loop carries the summary on every telemetry
+// interval; the per-section histograms (<baseTopic>/telemetry/loop/<section>)
+// rotate a few at a time so they never crowd the MQTT outbox.
+static constexpr size_t  LOOP_PROFILE_PAYLOAD_MAX = 448;
+static constexpr uint8_t LOOP_PROFILE_SECTIONS_PER_PUBLISH = 4;
+static_assert(LOOP_PROFILE_PAYLOAD_MAX + 64 <= MQTT_MAX_PACKET_SIZE,
+              "loop profile payload exceeds MQTT_MAX_PACKET_SIZE");
+// /debug/init copy (without histograms), refreshed by the status job: the
+// config server reads it from its own task.
+struct LoopProfileText { char json[LoopProfiler::DEBUG_JSON_MAX]; };
+static SnapshotCell<LoopProfileText> loopProfileText(LoopProfileText{});
+#endif
+
+// Newest reading per compartment, kept by the control job; the one that drove
+// the last state-machine update stands in for "the" reading in status logs
+// and top-level telemetry.
+static SensorReading compartmentReadings[SENSOR_CHANNELS];
+static uint8_t activeCompartment = 0;
+// Every reading between two telemetry publishes, aggregated per compartment
+// (LevelWindow.h); the active compartment's window rides along with the
+// top-level fields.
+static LevelWindow levelWindows[SENSOR_CHANNELS];
 
 // BUTTON_PIN / ALERT_PIN / LIGHT_PIN (and the sensor's I2C pins) are defined
 // in include/BoardPins.h — the single pin map for the whole firmware.
@@ -59,14 +211,15 @@ static constexpr bool USE_MOCK = false;
 //   - 34/35/36/39 input-only, no output driver — pinMode(OUTPUT) is illegal
 //   - 1/3         UART0 TX/RX — serial console
 //   - 0/2/5/15    strapping pins — driving at/after boot is risky and pointless
-//   - 12,21,22,26,27  already used by LED/I2C/alert/button (see BoardPins.h)
+//   - 4,12,21,22,26,27  already used by ADS RDY/LED/I2C/alert/button (see BoardPins.h)
 //   - 32          previously used by an analog water sensor; reserved to avoid
 //                 repurposing it while boards with that wiring are in the field
-static constexpr int UNUSED_GPIOS[] = {4, 13, 14, 16, 17, 18, 19, 23, 25, 33};
+static constexpr int UNUSED_GPIOS[] = {13, 14, 16, 17, 18, 19, 23, 25, 33};
 
 // Task watchdog: tightened now that checkForUpdates() runs off-loop on an OTA task.
 // The longest blocking call remaining in loop() is <1 s, so 10 s gives ample margin.
 static constexpr uint32_t WDT_TIMEOUT_S = 10;
+static constexpr uint32_t WDT_TIMEOUT_US = WDT_TIMEOUT_S * 1000000UL;
 
 volatile bool buttonPressed = false;
 volatile unsigned long lastButtonPress = 0;
@@ -77,11 +230,20 @@ volatile bool emergencyLongHoldDetected = false; // Flag for 5-second hold in em
 // Message tracing - unique ID for each notification
 static uint32_t messageTraceId = 0;
 
+// One-shot notifications (sensor failure/recovery, silence confirm, bus
+// error) arriving within this window are sent as one combined message per
+// channel. Emergency alerts are never delayed by it.
+static constexpr uint32_t NOTIFY_COALESCE_WINDOW_MS = 5000;
+
 // Create easier references to the singleton objects
 SettingsStore settingsStore;
 ConfigServer* configServer = nullptr;
 OTAManager* otaManager = nullptr;
-LightCode light(LIGHT_PIN);
+// Status LED and alert/horn output, each on its own RMT channel
+// (PulseOutput.h). Channels from the top, clear of the Arduino RMT HAL's
+// first-free allocation.
+LightCode light(LIGHT_PIN, RMT_CHANNEL_6);
+static PulseOutput alertOutput(ALERT_PIN, RMT_CHANNEL_7);
 TimeManagement& rtc = TimeManagement::getInstance();
 WiFiManager& wifiMgr = WiFiManager::getInstance();
 WaterPressureSensor waterSensor(USE_MOCK); // false = use real sensor, not mock data
@@ -93,19 +255,22 @@ CustomChannel  customChannel;
 // C2: flood-watch callback for OTAManager. Consulted inside the OTA download
 // loop so a firmware download (which owns the loop task for up to 5 minutes)
 // aborts if a Tier-1+ flood condition appears mid-download, instead of
-// blinding the flood sensor for the whole download. readLevel() is internally
-// gated to a 1-second sample rate, so calling it from the tight download loop
-// is cheap and returns a fresh-enough reading.
+// blinding the flood sensor for the whole download. Sampling runs on its own
+// task, so this only reads the latest published reading — cheap enough for
+// the tight download loop, and safe from the OTA task. Any compartment at
+// Tier 1+ aborts.
 bool otaFloodCheckCallback(void* ctx) {
     WaterPressureSensor* sensor = static_cast<WaterPressureSensor*>(ctx);
-    SensorReading r = sensor->readLevel();
-    if (!r.valid) {
+    const SettingsValues& sv = settingsStore.get();
+    for (uint8_t ch = 0; ch < sensor->channelCount(); ch++) {
+        SensorReading r = sensor->getLatestReading(ch);
         // Sensor fault is handled by the state-machine error path separately;
         // it is not a flood condition and shouldn't gate OTA on its own.
-        return false;
+        if (r.valid && r.level_cm >= sv.emergencyWaterLevel_cm) {
+            return true; // Tier 1+
+        }
     }
-    const SettingsValues& sv = settingsStore.get();
-    return r.level_cm >= sv.emergencyWaterLevel_cm; // Tier 1+
+    return false;
 }
 
 
@@ -115,7 +280,22 @@ bool otaFloodCheckCallback(void* ctx) {
 NotificationWorker notifier;
 MQTTService mqtt;
 void setup() {
+    // A driver-side TX buffer, drained by the UART interrupt: the log sink
+    // writes into it without waiting on the wire
+    Serial.setTxBufferSize(LOG_SERIAL_TX_BUFFER);
     Serial.begin(115200);
+    // Deferred log formatting: LOG_* from here on queue binary records that
+    // the "log" task (Core 0) renders to Serial and MQTT
+    loggerBegin();
+
+    // Let go of the horn / LED pins held low through a deep sleep (a no-op
+    // on a power-on boot)
+    LowPower::releasePins();
+    lowPowerPolicy.setWake(LowPower::wakeReason());
+    if (LOW_POWER_MODE) {
+        LOG_SETUP("[SETUP] Wake: %s (sleep #%u)",
+                  LowPowerPolicy::wakeName(lowPowerPolicy.getWake()), LowPower::sleepCount());
+    }
 
     // Drive unused GPIOs to a defined LOW state before any peripheral init.
     // See UNUSED_GPIOS above — curated allowlist, never a loop over all pins.
@@ -134,6 +314,11 @@ void setup() {
         ret = nvs_flash_init();
     }
     ESP_ERROR_CHECK(ret);
+    // Write-behind commits for config saves (NvsStore.h) — none land on this task
+    NvsStore::getInstance().begin();
+    // Cached DNS for the notification / broker / OTA hosts; prefetches on
+    // each GOT_IP, so it starts before WiFi
+    HostResolver::getInstance().begin();
 
     waterSensor.init();
 
@@ -152,15 +337,33 @@ void setup() {
     // Initialize MQTT early so all subsequent LOG_* calls can be queued for delivery
     g_mqtt = &mqtt;
     mqtt.begin();
-    LOG_SETUP("[SETUP] MQTTService initialized");
+    // Connect, TLS handshake and publishes run on their own task from here
+    // on; mqttJob only dispatches received messages
+    if (mqtt.startTask()) {
+        LOG_SETUP("[SETUP] MQTTService initialized, network task on Core 0");
+    } else {
+        LOG_CRITICAL("[SETUP] MQTT task creation FAILED — running MQTT inline on the loop task");
+    }
+    // <baseTopic>/cmd/log: runtime log category mask (LogTags.h syntax, e.g.
+    // "+network for=3600"). Uses the base topic at boot.
+    {
+        char filter[96];
+        if (mqtt.getBaseTopic(filter, sizeof(filter) - strlen("/cmd/log")) == 0) {
+            strcat(filter, "/cmd/log");
+            mqtt.subscribe(filter, onLogMaskCommand);
+        }
+    }
+    telemetryStore.begin();
 
     // Load NVS caches for all channels before the notifier task starts
     smsChannel.loadCache();
     discordChannel.loadCache();
     customChannel.loadCache();
+    customChannel.setContextProvider(fillTemplateContext);
 
     // Start notification worker on Core 0 — all HTTP sends happen there, not on Core 1
     static NotificationChannel* channels[] = { &smsChannel, &discordChannel, &customChannel };
+    notifier.setCoalesceWindow(NOTIFY_COALESCE_WINDOW_MS);
     notifier.begin(channels, 3, USE_MOCK);
     LOG_SETUP("[SETUP] NotificationWorker started on Core 0%s", USE_MOCK ? " (dry-run mode)" : "");
 
@@ -180,6 +383,11 @@ void setup() {
     // Initialize ConfigServer early to load calibration from NVS
     // This ensures saved calibration is applied before first sensor reading
     configServer = new ConfigServer(&waterSensor, &smsChannel, &discordChannel, &customChannel, otaManager, &mqtt, &settingsStore);
+    configServer->setNotifier(&notifier);
+    configServer->setStateSource([](void*) { return stateToString(smCtx.currentState); }, nullptr);
+#if LOOP_PROFILER
+    configServer->setLoopProfileSource(copyLoopProfile, nullptr);
+#endif
     LOG_SETUP("[SETUP] ConfigServer initialized - calibration loaded from NVS");
 
     // Print unique device AP password for easy access
@@ -190,11 +398,13 @@ void setup() {
     LOG_SETUP("  Firmware: v%s", FIRMWARE_VERSION);
     LOG_SETUP("========================================");
 
-    pinMode(ALERT_PIN, OUTPUT);
+    alertOutput.off();
     pinMode(BUTTON_PIN, INPUT_PULLUP);
     attachInterrupt(BUTTON_PIN, handleButtonPress, CHANGE);
 
-    // Initialize WiFiManager
+    // Initialize WiFiManager. Returns once the link has an IP (GOT_IP event)
+    // or every connect path has timed out; after a reboot the cached AP is
+    // tried first, without a scan.
     wifiMgr.begin();
 
     // Check if we have stored credentials
@@ -209,11 +419,16 @@ void setup() {
         smCtx.currentState = NORMAL;
         LOG_STATE("[STATE] Initial state: %s", stateToString(smCtx.currentState));
         light.setPattern(PATTERN_OFF); // NORMAL state pattern
-        LOG_SETUP("WiFi credentials found, connecting...");
-        delay(2000);
-
+        // Woken from a low-power sleep: carry over silencing and the last
+        // trustworthy level instead of starting from scratch
+        if (LOW_POWER_MODE && LowPower::restore(smCtx)) {
+            LOG_STATE("[STATE] Restored from sleep checkpoint (silenced=%d, last level=%.1f cm)",
+                      smCtx.notificationsSilenced, smCtx.lastValidLevel_cm);
+        }
         if (wifiMgr.isConnected()) {
             LOG_SETUP("IP address: %s", WiFi.localIP().toString().c_str());
+        } else {
+            LOG_SETUP("WiFi credentials found, not connected yet - retrying in the background");
         }
     }
 
@@ -222,56 +437,89 @@ void setup() {
     esp_task_wdt_init(WDT_TIMEOUT_S, true);
     esp_task_wdt_add(NULL); // Register the loop task (setup/loop share one task)
     LOG_SETUP("[SETUP] Task watchdog armed (%us timeout)", WDT_TIMEOUT_S);
-}
-
-void loop() {
-
-    esp_task_wdt_reset(); // Feed the watchdog; a stalled loop will trigger reboot
 
-    mqtt.loop();
-    rtc.sync();
-    light.update();
-    wifiMgr.maintainConnection();
+    // Hand sampling to its own task only now: it registers itself with the
+    // watchdog configured above, and from here on loop() consumes readings
+    // through the sensor's SPSC ring instead of calling readLevel() inline.
+    if (waterSensor.startSamplingTask()) {
+        LOG_SETUP("[SETUP] Sensor sampling task started on Core 1");
+    }
 
-    // OTA version checks now run on their own Core 0 task (see OTAManager::begin()),
-    // so loop() only needs to handle auto-install when a check has already found an update.
-    if (otaManager && smCtx.currentState != CONFIG && smCtx.currentState != EMERGENCY) {
-        otaManager->loopInstallOnly();
+    // loop() is driven by the scheduler from here on. Registration order is
+    // run order within a tick: control first for bounded alarm latency.
+    // Budgets are generous upper bounds — an overrun is logged in [SCHED]
+    // status lines, it doesn't preempt anything.
+    scheduler.add("control",   controlJob,   nullptr, CONTROL_PERIOD_MS,      30000);
+    scheduler.add("mqtt",      mqttJob,      nullptr, MQTT_PERIOD_MS,         50000);
+    scheduler.add("light",     lightJob,     nullptr, LIGHT_PERIOD_MS,         1000);
+    scheduler.add("wifi",      wifiJob,      nullptr, WIFI_PERIOD_MS,         20000);
+    scheduler.add("rtc",       rtcJob,       nullptr, RTC_PERIOD_MS,           5000);
+    scheduler.add("ota",       otaJob,       nullptr, OTA_PERIOD_MS,         100000);
+    scheduler.add("status",    statusJob,    nullptr, STATUS_LOG_INTERVAL_MS, 20000);
+    scheduler.add("telemetry", telemetryJob, nullptr,
+                  TELEMETRY_REPORT_BY_EXCEPTION ? TELEMETRY_CHECK_MS : TELEMETRY_INTERVAL_MS, 50000);
+    scheduler.add("backfill",  backfillJob,  nullptr, BACKFILL_PERIOD_MS,     50000);
+    if (LOW_POWER_MODE) {
+        scheduler.add("lowpower", lowPowerJob, nullptr, LOW_POWER_CHECK_MS,       5000);
     }
+}
 
-    // Monitor WiFi connection status for critical events
-    static bool wasWiFiConnected = false;
-    bool isWiFiConnected = wifiMgr.isConnected();
+// Custom-channel template placeholders. Runs on the notifier task (Core 0):
+// the sensor getters are cross-core safe, and the state and compartment are
+// single aligned words written only by the control job.
+static void fillTemplateContext(TemplateContext& ctx) {
+    uint8_t ch = activeCompartment;
+    SensorReading r = waterSensor.getLatestReading(ch);
+    ctx.level_cm      = r.valid ? r.level_cm : NAN;
+    ctx.rate_cm_30min = waterSensor.getRateOfChange_cm30min(ch);
+    ctx.state         = stateToString(smCtx.currentState);
+}
 
-    if (wasWiFiConnected && !isWiFiConnected) {
-        LOG_EVENT("[WIFI] Connection lost - internet disconnected");
-        if (smCtx.currentState == EMERGENCY) {
-            LOG_EVENT("[WIFI_EMERGENCY] WiFi lost during EMERGENCY state - emergency notifications may be delayed!");
-        }
-        // Update LED if in NORMAL state to show WiFi disconnection
-        if (smCtx.currentState == NORMAL) {
-            light.setPattern(PATTERN_DOUBLE_BLINK);
-            LOG_DEBUG("[LIGHT] WiFi disconnected - switching to double blink pattern");
-        }
-    } else if (!wasWiFiConnected && isWiFiConnected) {
-        LOG_EVENT("[WIFI] Connection restored - internet connected");
-        // Update LED if in NORMAL state to show WiFi reconnection
-        if (smCtx.currentState == NORMAL) {
-            light.setPattern(PATTERN_OFF);
-            LOG_DEBUG("[LIGHT] WiFi reconnected - switching to off pattern");
-        }
-    }
-    wasWiFiConnected = isWiFiConnected;
+// ============================================================================
+// loop() jobs — registered with the scheduler at the end of setup()
+// ============================================================================
 
+// Sensor drain, state machine and its side effects (alert pin, horn,
+// notifications, LED pattern), plus the inputs that feed it: the silence
+// button and the CONFIG-mode web server. Registered first so it runs first
+// on every tick.
+static void controlJob(void*) {
+    PROFILE_SCOPE(loopProfiler, PROF_CONTROL);
     // Track state before processing to detect changes
     State previousState = smCtx.currentState;
 
-    // Refresh threshold config from SettingsStore on every loop iteration so
-    // settings changed via the web UI take effect without a reboot.
-    // SettingsStore::get() returns the in-RAM copy — no NVS I/O on this path.
-    smCtx.setSettings(settingsStore.get());
+    // Pick up threshold changes saved via the web UI without a reboot. The
+    // snapshot is only copied when its version moved — one atomic load on
+    // every other tick, and never a half-written struct.
+    static uint32_t settingsVersion = 0;
+    SettingsValues freshSettings;
+    if (settingsStore.refresh(freshSettings, settingsVersion)) {
+        smCtx.setSettings(freshSettings);
+    }
 
-    SensorReading currentReading = waterSensor.readLevel();
+    // Drain every reading the sampling task queued since the last run and
+    // keep the newest per compartment; between samples the previous one stands.
+    static bool compartmentReadingsPrimed = false;
+    if (!compartmentReadingsPrimed) {
+        for (uint8_t ch = 0; ch < SENSOR_CHANNELS; ch++) {
+            compartmentReadings[ch] = waterSensor.getLatestReading(ch);
+        }
+        compartmentReadingsPrimed = true;
+    }
+    {
+        PROFILE_SCOPE(loopProfiler, PROF_SENSOR);
+        SensorReading queuedReading;
+        while (waterSensor.popReading(queuedReading)) {
+            if (queuedReading.channel < SENSOR_CHANNELS) {
+                compartmentReadings[queuedReading.channel] = queuedReading;
+                // Stamped with the sample tick, so a batch drained after a
+                // stall still covers the time it was sampled over
+                levelWindows[queuedReading.channel].add(queuedReading.tickUs, queuedReading.valid,
+                                                        queuedReading.level_cm,
+                                                        smCtx.emergencyWaterLevel_cm);
+            }
+        }
+    }
 
     // Check for 5-second button hold to toggle silence in EMERGENCY state
     static bool silenceToggleHandled = false;
@@ -281,17 +529,14 @@ void loop() {
         silenceToggleHandled = true;
         emergencyLongHoldDetected = false;
         StateMachineOutput silenceOut = handleSilenceToggle(smCtx);
-        if (silenceOut.sendSilenceConfirmation) {
+        if (const StateMachineEventRecord* ev = silenceOut.find(SM_EVENT_SILENCED)) {
             LOG_EVENT("[EVENT] Emergency notifications SILENCED by button hold");
-            messageTraceId++;
-            char buf[100];
-            snprintf(buf, sizeof(buf), "[MSG:%u] BilgeRise: Emergency alerts silenced", messageTraceId);
-            notifier.enqueue(buf);
-        } else if (silenceOut.sendUnsilenceConfirmation) {
+            notifier.enqueueEvent(*ev, ++messageTraceId);
+        } else if (silenceOut.has(SM_EVENT_UNSILENCED)) {
             LOG_EVENT("[EVENT] Emergency notifications RE-ENABLED by button hold - WiFi: %d", wifiMgr.isConnected());
         }
         // ALERT_PIN isn't written here — updateStateMachine() runs later this
-        // same iteration and its output.alertPinOn already reflects the
+        // same iteration and its output.alertPinMode already reflects the
         // silence flag just toggled above.
     }
 
@@ -304,103 +549,134 @@ void loop() {
     // Handle CONFIG state server calls (must happen before updateStateMachine so
     // configCommandReceived is consumed correctly)
     if (smCtx.currentState == CONFIG) {
+        PROFILE_SCOPE(loopProfiler, PROF_CONFIG);
         if (!configServer->isSetupModeActive()) {
             LOG_STATE("[STATE] Starting configuration server mode");
             configServer->startSetupMode();
         } else {
             configServer->handleClient();
         }
+    } else if (configServer->isSetupModeActive()) {
+        // Left CONFIG while the server task was still inside a handler; this
+        // completes the stop once the task has exited
+        configServer->handleClient();
     }
 
-    // Check for I2C bus unrecoverable — one-shot alert
+    // Check for I2C bus unrecoverable — one alert per episode. The sensor
+    // keeps retrying with backoff; when the bus comes back the flag clears and
+    // the next episode alerts again (the state machine sends the recovery
+    // message once readings are valid).
     static bool busUnrecoverableNotified = false;
     if (!busUnrecoverableNotified && waterSensor.isBusUnrecoverable()) {
         busUnrecoverableNotified = true;
-        LOG_CRITICAL("[SENSOR] I2C bus permanently unrecoverable after %d attempts", BUS_RECOVERY_MAX_ATTEMPTS);
+        LOG_CRITICAL("[SENSOR] I2C bus unrecoverable after %d attempts, retrying with backoff", BUS_RECOVERY_MAX_ATTEMPTS);
         messageTraceId++;
         char busMsg[120];
         snprintf(busMsg, sizeof(busMsg), "[MSG:%u] BilgeRise: I2C sensor bus unrecoverable. Device requires inspection.", messageTraceId);
-        notifier.enqueue(busMsg);
+        notifier.enqueue(busMsg, CHAN_ALL, NOTIFY_FAULT, NOTIFY_KEY_BUS_ERROR);
+    } else if (busUnrecoverableNotified && !waterSensor.isBusUnrecoverable()) {
+        busUnrecoverableNotified = false;
+        LOG_EVENT("[SENSOR] I2C bus recovered after %u ms", waterSensor.getLastBusRecoveryMs());
     }
 
-    // Build the sensor reading adapter for the state machine
-    StateMachineSensorReading smReading;
-    smReading.valid    = currentReading.valid;
-    smReading.level_cm = currentReading.level_cm;
-
-    // Get rate-of-change for emergency messages (NaN if not enough history)
-    float rateOfChange = waterSensor.getRateOfChange_cm30min();
+    // Build the per-compartment sensor reading adapters for the state machine,
+    // with each compartment's rate-of-change for emergency messages (NaN if
+    // not enough history)
+    StateMachineSensorReading smReadings[SENSOR_CHANNELS];
+    float rates[SENSOR_CHANNELS];
+    for (uint8_t ch = 0; ch < SENSOR_CHANNELS; ch++) {
+        smReadings[ch].valid    = compartmentReadings[ch].valid;
+        smReadings[ch].level_cm = compartmentReadings[ch].level_cm;
+        rates[ch] = waterSensor.getRateOfChange_cm30min(ch);
+    }
 
     // Config server active flag for state machine
     bool configActive = configServer->isSetupModeActive();
 
     // Run the unified state machine
-    StateMachineOutput out = updateStateMachine(smCtx, smReading, millis(), rateOfChange, configActive);
+    StateMachineOutput out;
+    {
+        PROFILE_SCOPE(loopProfiler, PROF_STATE);
+        out = updateStateMachine(smCtx, smReadings, rates, SENSOR_CHANNELS, millis(), configActive);
+    }
+    // The compartment that drove this update stands in for "the" reading in
+    // logs and top-level telemetry.
+    const SensorReading& currentReading = compartmentReadings[out.compartment];
+    activeCompartment = out.compartment;
 
     // ------------------------------------------------------------------
     // Execute side effects from state machine output
     // ------------------------------------------------------------------
 
-    // Alert transition logging (Tier 2 pulse edges only)
-    if (out.setHornState) {
+    // Alert transition logging (Tier 2 pulse edges only). These come from
+    // the state machine's software horn timer; the pin itself is timed by
+    // the RMT below, so the logged edges are approximate.
+    if (out.has(SM_EVENT_HORN)) {
         LOG_DEBUG("[ALERT] Tier 2 pulse %s", out.hornOn ? "ON" : "OFF");
     }
 
-    // Alert pin (GPIO 26) — dedicated emergency indicator, driven every
-    // iteration: solid for Tier 1, pulsing for Tier 2. GPIO 12's status LED
-    // no longer reacts to EMERGENCY at all (see the state-change switch below).
-    digitalWrite(ALERT_PIN, out.alertPinOn ? HIGH : LOW);
-
-    // Sensor recovery notification
-    if (out.sendSensorRecoveryNotification) {
-        LOG_EVENT("[EVENT] Sensor error cleared");
-        messageTraceId++;
-        char recoverMsg[120];
-        snprintf(recoverMsg, sizeof(recoverMsg),
-                 "[MSG:%u] BilgeRise: Sensor recovered — water-level monitoring restored.", messageTraceId);
-        notifier.enqueue(recoverMsg);
-    }
-
-    // Sustained sensor failure notification (skip if I2C bus is unrecoverable — separate alert)
-    if (out.sendSustainedSensorFailureNotification && !waterSensor.isBusUnrecoverable()) {
-        LOG_CRITICAL("[SENSOR] Sustained sensor failure (%us) — notifying owner", out.sensorDownSeconds);
-        messageTraceId++;
-        char failMsg[150];
-        snprintf(failMsg, sizeof(failMsg),
-                 "[MSG:%u] BilgeRise: Sensor failure — no valid reading for %us. Flood detection is OFFLINE; device needs inspection.",
-                 messageTraceId, out.sensorDownSeconds);
-        notifier.enqueue(failMsg);
+    // Alert pin (GPIO 26) — dedicated emergency indicator, asserted every
+    // iteration: solid for Tier 1, the horn cadence for Tier 2, played by the
+    // RMT so a slow pass can't stretch a pulse. alertOutput only touches the
+    // hardware when the mode or the horn durations change. GPIO 12's status
+    // LED no longer reacts to EMERGENCY at all (see the state-change switch
+    // below). A /emergency/test-pin pulse from the web UI holds the pin too
+    AlertPinMode alertMode = configServer->isAlertPinTestActive() ? ALERT_PIN_SOLID : out.alertPinMode;
+    switch (alertMode) {
+        case ALERT_PIN_OFF:
+            alertOutput.off();
+            break;
+        case ALERT_PIN_SOLID:
+            alertOutput.solid();
+            break;
+        case ALERT_PIN_PULSING: {
+            const PulsePhase horn[] = {
+                { true,  (uint32_t)smCtx.hornOnDuration_ms },
+                { false, (uint32_t)smCtx.hornOffDuration_ms }
+            };
+            // Durations that can't be played fail safe to a solid alarm
+            if (!alertOutput.play(horn, 2)) alertOutput.solid();
+            break;
+        }
     }
-
-    // Emergency notification (latest-wins mailbox for coalescing during WiFi outages)
-    if (out.sendEmergencyNotification) {
-        messageTraceId++;
-        char ratePart[28] = "";
-        if (!out.sensorFaultActive && !isnan(out.rateOfChange_cm30min)) {
-            snprintf(ratePart, sizeof(ratePart), " (%+.1f cm/30min)", out.rateOfChange_cm30min);
-        }
-        const char* sensorNote = out.sensorFaultActive ? " — SENSOR FAULT (level stale)" : "";
-        char emergMessageBuf[180];
-        if (smCtx.urgentEmergencyConditions) {
-            snprintf(emergMessageBuf, sizeof(emergMessageBuf),
-                     "[MSG:%u] BilgeRise URGENT Alert: Tier 2 Emergency Level %.2f cm%s%s",
-                     messageTraceId, out.displayLevel_cm, ratePart, sensorNote);
-        } else {
-            snprintf(emergMessageBuf, sizeof(emergMessageBuf),
-                     "[MSG:%u] BilgeRise Alert: Emergency Level %.2f cm%s%s",
-                     messageTraceId, out.displayLevel_cm, ratePart, sensorNote);
+    alertOutput.update();
+
+    // Owner notifications, in the order the state machine raised them. Only
+    // the typed event travels to the notifier; it formats the text on its own
+    // task (AlertFormatter.h).
+    for (uint8_t i = 0; i < out.eventCount; i++) {
+        const StateMachineEventRecord& ev = out.queue[i];
+        switch (ev.type) {
+            case SM_EVENT_SENSOR_RECOVERED:
+                LOG_EVENT("[EVENT] Sensor error cleared");
+                notifier.enqueueEvent(ev, ++messageTraceId);
+                break;
+            case SM_EVENT_SENSOR_FAILURE:
+                // Skip if I2C bus is unrecoverable — it has its own alert
+                if (waterSensor.isBusUnrecoverable()) break;
+                LOG_CRITICAL("[SENSOR] Sustained sensor failure (%us) — notifying owner",
+                             ev.sensorFailure.downSeconds);
+                notifier.enqueueEvent(ev, ++messageTraceId);
+                break;
+            case SM_EVENT_EMERGENCY:
+                // Latest-wins mailbox: replaces any older unsent snapshot during WiFi outage
+                ++messageTraceId;
+                LOG_EVENT("[STATE] EMERGENCY: Sending alert [MSG:%u]: %s level %.2f cm%s",
+                          messageTraceId, ev.emergency.urgent ? "Tier 2" : "Tier 1",
+                          ev.emergency.level_cm, ev.emergency.sensorFault ? " (stale)" : "");
+                notifier.enqueueEvent(ev, messageTraceId);
+                break;
+            default:
+                break;
         }
-        LOG_EVENT("[STATE] EMERGENCY: Sending alert message: %s", emergMessageBuf);
-        // Latest-wins mailbox: replaces any older unsent snapshot during WiFi outage
-        notifier.enqueueEmergency(emergMessageBuf);
     }
 
     // State change side effects
-    if (out.stateChanged) {
+    if (out.has(SM_EVENT_STATE_CHANGED)) {
         LOG_STATE("[STATE] Transitioning to %s", stateToString(smCtx.currentState));
 
         if (smCtx.currentState == EMERGENCY && previousState != EMERGENCY) {
-            // Log transition details on entry into EMERGENCY (out.stateChanged
+            // Log transition details on entry into EMERGENCY (SM_EVENT_STATE_CHANGED
             // already guarantees previousState != currentState here).
             LOG_EVENT("[STATE] Transitioning to EMERGENCY state - WiFi connected: %d, IP: %s, water level: %.2f cm",
                       wifiMgr.isConnected(), WiFi.localIP().toString().c_str(), currentReading.level_cm);
@@ -449,54 +725,299 @@ void loop() {
             }
         }
     }
+}
+
+static void mqttJob(void*) {
+    PROFILE_SCOPE(loopProfiler, PROF_MQTT);
+    mqtt.loop();
+}
 
-    // Periodic status logging
-    if (millis() - lastStatusLogTime >= STATUS_LOG_INTERVAL_MS) {
-        LOG_STATUS("[STATUS] State=%s, WaterLevel=%.2f cm, SensorError=%d, EmergencyConditions=%d",
-                      stateToString(smCtx.currentState),
-                      currentReading.level_cm,
-                      smCtx.sensorError,
-                      smCtx.emergencyConditions);
-        LOG_STATUS("[WIFI] Connected=%d, RSSI=%d dBm",
-                      wifiMgr.isConnected(), wifiMgr.getRSSI());
-        LOG_STATUS("[HEAP] Free=%u, MinFree=%u, MaxBlock=%u",
-                      ESP.getFreeHeap(), ESP.getMinFreeHeap(), ESP.getMaxAllocHeap());
-        LOG_STATUS("[NOTIFIER] Pending=%u, Dropped=%u",
-                      notifier.getPendingCount(), notifier.getDropCount());
-        // H5: monitor TLS-task stack headroom empirically. The notifier and
-        // OTA-check tasks both perform mbedTLS handshakes (WiFiClientSecure);
-        // log free-stack high-water marks so a future soak test can confirm
-        // the bumped stack sizes (8KB / 10KB) leave real margin.
-        LOG_STATUS("[STACK] notifier HW=%u, ota_check HW=%u",
-                      notifier.getStackHighWaterMark(),
-                      otaManager ? otaManager->getCheckTaskStackHighWaterMark() : 0);
-        lastStatusLogTime = millis();
-    }
-
-    // Periodic structured telemetry — numeric JSON for time-series consumers
-    // (Grafana via Telegraf/InfluxDB, Home Assistant). Retained so a freshly
-    // connected consumer immediately sees the last reading. publishTelemetry()
-    // is a no-op when MQTT is disconnected, so this never blocks the loop.
-    if (millis() - lastTelemetryTime >= TELEMETRY_INTERVAL_MS) {
+static void lightJob(void*) {
+    PROFILE_SCOPE(loopProfiler, PROF_LIGHT);
+    light.update();
+}
+
+static void wifiJob(void*) {
+    PROFILE_SCOPE(loopProfiler, PROF_WIFI);
+    wifiMgr.maintainConnection();
+
+    // Monitor WiFi connection status for critical events
+    static bool wasWiFiConnected = false;
+    bool isWiFiConnected = wifiMgr.isConnected();
+
+    if (wasWiFiConnected && !isWiFiConnected) {
+        LOG_EVENT("[WIFI] Connection lost - internet disconnected");
+        if (smCtx.currentState == EMERGENCY) {
+            LOG_EVENT("[WIFI_EMERGENCY] WiFi lost during EMERGENCY state - emergency notifications may be delayed!");
+        }
+        // Update LED if in NORMAL state to show WiFi disconnection
+        if (smCtx.currentState == NORMAL) {
+            light.setPattern(PATTERN_DOUBLE_BLINK);
+            LOG_DEBUG("[LIGHT] WiFi disconnected - switching to double blink pattern");
+        }
+    } else if (!wasWiFiConnected && isWiFiConnected) {
+        LOG_EVENT("[WIFI] Connection restored - internet connected");
+        // Update LED if in NORMAL state to show WiFi reconnection
+        if (smCtx.currentState == NORMAL) {
+            light.setPattern(PATTERN_OFF);
+            LOG_DEBUG("[LIGHT] WiFi reconnected - switching to off pattern");
+        }
+    }
+    wasWiFiConnected = isWiFiConnected;
+}
+
+static void rtcJob(void*) {
+    PROFILE_SCOPE(loopProfiler, PROF_RTC);
+    rtc.sync();
+}
+
+static void otaJob(void*) {
+    PROFILE_SCOPE(loopProfiler, PROF_OTA);
+    // OTA version checks now run on their own Core 0 task (see OTAManager::begin()),
+    // so loop() only needs to handle auto-install when a check has already found an update.
+    if (otaManager && smCtx.currentState != CONFIG && smCtx.currentState != EMERGENCY) {
+        otaManager->loopInstallOnly();
+    }
+}
+
+// Periodic status logging
+static void statusJob(void*) {
+    PROFILE_SCOPE(loopProfiler, PROF_STATUS);
+    const SensorReading& currentReading = compartmentReadings[activeCompartment];
+    LOG_STATUS("[STATUS] State=%s, WaterLevel=%.2f cm, SensorError=%d, EmergencyConditions=%d",
+                  stateToString(smCtx.currentState),
+                  currentReading.level_cm,
+                  smCtx.sensorError,
+                  smCtx.emergencyConditions);
+    LOG_STATUS("[WIFI] Connected=%d, RSSI=%d dBm",
+                  wifiMgr.isConnected(), wifiMgr.getRSSI());
+    LOG_STATUS("[HEAP] Free=%u, MinFree=%u, MaxBlock=%u",
+                  ESP.getFreeHeap(), ESP.getMinFreeHeap(), ESP.getMaxAllocHeap());
+    LOG_STATUS("[NOTIFIER] Pending=%u, Dropped=%u (fault=%u info=%u ota=%u), Deduped=%u",
+                  notifier.getPendingCount(), notifier.getDropCount(),
+                  notifier.getDropCount(NOTIFY_FAULT), notifier.getDropCount(NOTIFY_INFO),
+                  notifier.getDropCount(NOTIFY_OTA),
+                  notifier.getDedupCount(NOTIFY_FAULT) + notifier.getDedupCount(NOTIFY_INFO) +
+                  notifier.getDedupCount(NOTIFY_OTA));
+    LOG_STATUS("[MQTT] Logs sent=%u in %u publishes, dropped=%u, queue HW=%u B, "
+               "outbox HW=%u B dropped=%u, inbox dropped=%u",
+                  mqtt.getLogsSent(), mqtt.getLogPublishes(), mqtt.getLogsDropped(),
+                  mqtt.getLogQueueHighWater(), mqtt.getOutboxHighWater(),
+                  mqtt.getOutboxDropped(), mqtt.getInboxDropped());
+    if (TELEMETRY_REPORT_BY_EXCEPTION) {
+        LOG_STATUS("[TELEM] sent=%u suppressed=%u last=%s",
+                      telemetrySent, telemetrySuppressed,
+                      TelemetryGate::reasonName(telemetryLastReason));
+    }
+    LoggerStats logs = loggerStats();
+    LOG_STATUS("[LOG] dropped=%u queue HW=%u B max lag=%ums, serial dropped=%u HW=%u B",
+                  logs.dropped, logs.queueHighWater, logs.maxLagMs,
+                  logs.serialDropped, logs.serialHighWater);
+    NvsStore::Stats nvs = NvsStore::getInstance().getStats();
+    LOG_STATUS("[NVS] puts=%u coalesced=%u commits=%u keys=%u failed=%u pending=%u",
+                  nvs.puts, nvs.coalesced, nvs.commits, nvs.keysWritten, nvs.failures,
+                  nvs.pending);
+    if (telemetryStore.isReady()) {
+        LOG_STATUS("[TLOG] pending=%u recorded=%u backfilled=%u skipped=%u",
+                      telemetryStore.getPending(), telemetryStore.getRecorded(),
+                      telemetryStore.getBackfilled(), telemetryStore.getSkipped());
+    }
+    LOG_STATUS("[SENSOR] RingDropped=%u, MissedConv=%u, sampler HW=%u",
+                  waterSensor.getRingDropCount(), waterSensor.getMissedConversionCount(),
+                  waterSensor.getStackHighWaterMark());
+    // H5: monitor TLS-task stack headroom empirically. The notifier, mqtt
+    // and OTA-check tasks all perform mbedTLS handshakes (WiFiClientSecure);
+    // log free-stack high-water marks so a future soak test can confirm
+    // the bumped stack sizes (8KB / 10KB) leave real margin.
+    LOG_STATUS("[STACK] notifier HW=%u, mqtt HW=%u, log HW=%u, ota_check HW=%u, config_srv HW=%u",
+                  notifier.getStackHighWaterMark(), mqtt.getStackHighWaterMark(),
+                  logs.stackHighWater,
+                  otaManager ? otaManager->getCheckTaskStackHighWaterMark() : 0,
+                  configServer->getStackHighWaterMark());
+#if LOOP_PROFILER
+    // Slowest loop() pass so far and where it went; the full profile is
+    // refreshed for /debug here too
+    {
+        const LoopProfiler::Stats& it = loopProfiler.iteration();
+        char worst[160];
+        size_t pos = 0;
+        worst[0] = '\0';
+        for (uint8_t i = 0; i < loopProfiler.count() && pos < sizeof(worst); i++) {
+            uint32_t us = loopProfiler.worstBreakdownUs(i);
+            if (us == 0) continue;
+            int n = snprintf(worst + pos, sizeof(worst) - pos, " %s=%u", loopProfiler.name(i), us);
+            if (n < 0) break;
+            pos += (size_t)n;
+        }
+        LOG_STATUS("[LOOP] iters=%u p95=%uus max=%uus (%u.%02u%% of WDT), worst:%s",
+                      it.count(), it.percentile(95), it.maxValue(),
+                      (unsigned)((uint64_t)it.maxValue() * 100 / WDT_TIMEOUT_US),
+                      (unsigned)((uint64_t)it.maxValue() * 10000 / WDT_TIMEOUT_US % 100), worst);
+        LoopProfileText& text = loopProfileText.writeBegin();
+        loopProfiler.formatJson(text.json, sizeof(text.json), WDT_TIMEOUT_US, false);
+        loopProfileText.writeCommit();
+    }
+#endif
+    // Jobs that blew their budget since boot (none on a healthy device)
+    for (uint8_t i = 0; i < scheduler.jobCount(); i++) {
+        const LoopScheduler::Job& j = scheduler.job(i);
+        if (j.overruns > 0 || j.skipped > 0) {
+            LOG_STATUS("[SCHED] %s runs=%u over=%u max=%uus late=%ums skipped=%u",
+                          j.name, j.runs, j.overruns, j.maxRunUs, j.maxLateMs, j.skipped);
+        }
+    }
+}
+
+// <baseTopic>/cmd/log handler (loop task). The outcome is logged at CRITICAL
+// so it shows up whatever the mask now is.
+static void onLogMaskCommand(void*, const char* topic, const uint8_t* payload, size_t len) {
+    (void)topic;
+    if (!logApplyMaskText((const char*)payload, len)) {
+        LOG_CRITICAL("[LOG] Ignored mask command \"%.*s\"", (int)(len < 60 ? len : 60),
+                     (const char*)payload);
+    }
+}
+
+// Retained <baseTopic>/info: published when its content changes, on a new
+// broker session, and every DEVICE_INFO_REFRESH_MS.
+static void publishDeviceInfo(uint32_t now) {
+    static char     lastInfo[DEVICE_INFO_PAYLOAD_MAX] = "";
+    static uint32_t lastInfoMs = 0;
+    static uint32_t lastInfoConnect = 0;
+
+    const SettingsValues& sv = settingsStore.get();
+    StaticJsonDocument<256> doc;
+    doc["fw_version"]                = FIRMWARE_VERSION;
+    doc["emergency_level_cm"]        = sv.emergencyWaterLevel_cm;
+    doc["urgent_emergency_level_cm"] = sv.urgentEmergencyWaterLevel_cm;
+    doc["compartments"]              = SENSOR_CHANNELS;
+    doc["telemetry_format"]          = TELEMETRY_MSGPACK ? "msgpack" : "json";
+    doc["report_by_exception"]       = (bool)TELEMETRY_REPORT_BY_EXCEPTION;
+    char info[DEVICE_INFO_PAYLOAD_MAX];
+    serializeJson(doc, info, sizeof(info));
+
+    if (strcmp(info, lastInfo) == 0 && lastInfoConnect == mqtt.getConnectCount() &&
+        now - lastInfoMs < DEVICE_INFO_REFRESH_MS) {
+        return;
+    }
+    if (mqtt.publishDeviceInfo(info)) {
+        strcpy(lastInfo, info);
+        lastInfoMs = now;
+        lastInfoConnect = mqtt.getConnectCount();
+    }
+}
+
+// Periodic structured telemetry — numeric JSON (or MessagePack) for
+// time-series consumers (Grafana via Telegraf/InfluxDB, Home Assistant).
+// Retained so a freshly connected consumer immediately sees the last
+// reading. The publish calls are no-ops when MQTT is disconnected, so
+// this never blocks the loop.
+static void telemetryJob(void*) {
+    PROFILE_SCOPE(loopProfiler, PROF_TELEMETRY);
+    const SensorReading& currentReading = compartmentReadings[activeCompartment];
+    uint32_t now = millis();
+    float rate = waterSensor.getRateOfChange_cm30min(activeCompartment);
+    publishDeviceInfo(now);
+
+    // Latency histograms change slowly; they follow the regular interval,
+    // or the heartbeat under report-by-exception (less half a check period,
+    // so scheduling jitter can't push them a whole extra period out).
+    static uint32_t lastLatencyMs = 0;
+    static bool latencySent = false;
+    uint32_t latencyPeriod = TELEMETRY_REPORT_BY_EXCEPTION ? TELEMETRY_HEARTBEAT_MS
+                                                           : TELEMETRY_INTERVAL_MS;
+    bool latencyDue = !latencySent || now - lastLatencyMs >= latencyPeriod - TELEMETRY_CHECK_MS / 2;
+
+    // Everything discrete that must be reported the moment it changes
+    uint32_t discrete = (uint32_t)smCtx.currentState |
+                        (smCtx.sensorError ? 0x100u : 0u) |
+                        ((uint32_t)activeCompartment << 16);
+    TelemetryGate::Reason reason = TelemetryGate::REASON_HEARTBEAT;
+    if (TELEMETRY_REPORT_BY_EXCEPTION) {
+        // A new broker session gets a fresh reading, not just the retained one
+        static uint32_t gateConnect = 0;
+        if (gateConnect != mqtt.getConnectCount()) {
+            gateConnect = mqtt.getConnectCount();
+            telemetryGate.reset();
+        }
+        reason = telemetryGate.check(now, currentReading.level_cm, rate, discrete);
+        if (reason == TelemetryGate::REASON_NONE) {
+            telemetrySuppressed++;
+        }
+    }
+
+    if (reason != TelemetryGate::REASON_NONE) {
         // ArduinoJson builder — NaN-proof by construction (item A3).
         // ArduinoJson v6 serializes float NaN as "null" when assigned nullptr;
         // assigning a float directly serializes the numeric value.
-        StaticJsonDocument<512> doc;
+        StaticJsonDocument<TELEMETRY_DOC_SIZE> doc;
         if (isnan(currentReading.level_cm)) {
             doc["level_cm"] = nullptr;
         } else {
             doc["level_cm"] = (float)((int)(currentReading.level_cm * 100 + 0.5f)) / 100.0f;
         }
-        float rate = waterSensor.getRateOfChange_cm30min();
         if (isnan(rate)) {
             doc["rate_cm_30min"] = nullptr;
         } else {
             doc["rate_cm_30min"] = (float)((int)(rate * 100 + 0.5f)) / 100.0f;
         }
+        float rateErr = waterSensor.getRateStdErr_cm30min(activeCompartment);
+        if (isnan(rateErr)) {
+            doc["rate_stderr_cm_30min"] = nullptr;
+        } else {
+            doc["rate_stderr_cm_30min"] = (float)((int)(rateErr * 100 + 0.5f)) / 100.0f;
+        }
+        // Multi-compartment boats: the top-level fields above follow the
+        // compartment driving the alarm; every compartment is listed here.
+        if (SENSOR_CHANNELS > 1) {
+            doc["compartment"] = activeCompartment;
+            JsonArray comps = doc.createNestedArray("compartments");
+            for (uint8_t ch = 0; ch < SENSOR_CHANNELS; ch++) {
+                JsonObject c = comps.createNestedObject();
+                const SensorReading& cr = compartmentReadings[ch];
+                if (isnan(cr.level_cm)) {
+                    c["level_cm"] = nullptr;
+                } else {
+                    c["level_cm"] = (float)((int)(cr.level_cm * 100 + 0.5f)) / 100.0f;
+                }
+                float chRate = waterSensor.getRateOfChange_cm30min(ch);
+                if (isnan(chRate)) {
+                    c["rate_cm_30min"] = nullptr;
+                } else {
+                    c["rate_cm_30min"] = (float)((int)(chRate * 100 + 0.5f)) / 100.0f;
+                }
+                c["valid"] = cr.valid;
+            }
+        }
+        // Every reading since the last publish, so a surge between two
+        // publishes still shows. Same compartment as level_cm.
+        int64_t windowUs = TimeManagement::monoUs();
+        LevelWindow::Summary win = levelWindows[activeCompartment].summary(windowUs);
+        const struct { const char* key; float value; } winLevels[] = {
+            { "level_min_cm",    win.min_cm },
+            { "level_max_cm",    win.max_cm },
+            { "level_mean_cm",   win.mean_cm },
+            { "level_stddev_cm", win.stddev_cm },
+            { "level_p95_cm",    win.p95_cm },
+        };
+        for (const auto& w : winLevels) {
+            if (isnan(w.value)) {
+                doc[w.key] = nullptr;
+            } else {
+                doc[w.key] = (float)((int)(w.value * 100 + 0.5f)) / 100.0f;
+            }
+        }
+        doc["level_samples"] = win.samples;
+        doc["level_invalid"] = win.invalid;
+        doc["above_tier1_s"] = (win.aboveTier1Ms + 500) / 1000;
         doc["state"]        = stateToString(smCtx.currentState);
         doc["sensor_error"] = smCtx.sensorError;
         doc["valid"]        = currentReading.valid;
         doc["rssi"]         = wifiMgr.getRSSI();
+        // I2C bus-fault history: duration of the last recovered episode and
+        // how many episodes have recovered since boot
+        doc["i2c_recovery_ms"] = waterSensor.getLastBusRecoveryMs();
+        doc["i2c_recoveries"]  = waterSensor.getBusRecoveryCount();
         // ESP32-WROOM-32 internal die temperature. UNCALIBRATED and inaccurate
         // for absolute temperature (self-heats with CPU/WiFi load, varies part to
         // part) — useful only as a RELATIVE diagnostic trend of the chip itself,
@@ -504,25 +1025,170 @@ void loop() {
         // Arduino-ESP32 core (via Arduino.h).
         doc["chip_temp_c"]  = (float)((int)(temperatureRead() * 100 + 0.5f)) / 100.0f;
 
-        // Operational metadata for remote diagnostics
-        const SettingsValues& telemSv = settingsStore.get();
-        doc["emergency_level_cm"]        = telemSv.emergencyWaterLevel_cm;
-        doc["urgent_emergency_level_cm"] = telemSv.urgentEmergencyWaterLevel_cm;
-        doc["fw_version"]               = FIRMWARE_VERSION;
+        // Operational metadata for remote diagnostics (the static fields —
+        // firmware version, thresholds — are in the device-info message)
         doc["last_fw_check_s"]          = otaManager ? otaManager->getTimeSinceLastCheckS() : 0;
         doc["heap_free"]                = ESP.getFreeHeap();
         doc["uptime_s"]                 = millis() / 1000UL;
 
-        char payload[384];
-        serializeJson(doc, payload, sizeof(payload));
-        mqtt.publishTelemetry(payload);
-        lastTelemetryTime = millis();
+        bool ok;
+        PROFILE_SCOPE(loopProfiler, PROF_SERIALIZE);
+        if (TELEMETRY_MSGPACK) {
+            uint8_t packed[TELEMETRY_PAYLOAD_MAX];
+            size_t n = serializeMsgPack(doc, packed, sizeof(packed));
+            ok = mqtt.publishTelemetryPacked(packed, n);
+        } else {
+            char payload[TELEMETRY_PAYLOAD_MAX];
+            serializeJson(doc, payload, sizeof(payload));
+            ok = mqtt.publishTelemetry(payload);
+        }
+        if (ok) {
+            telemetryGate.sent(now, currentReading.level_cm, rate, discrete);
+            telemetrySent++;
+            telemetryLastReason = reason;
+            for (uint8_t ch = 0; ch < SENSOR_CHANNELS; ch++) {
+                levelWindows[ch].restart(windowUs);
+            }
+        }
+    }
+
+    // Offline: keep the reading for backfill (at most one a minute, whatever
+    // the check rate)
+    static uint32_t lastStoredMs = 0;
+    static bool stored = false;
+    bool storeDue = !stored || now - lastStoredMs >= TELEMETRY_STORE_INTERVAL_MS - TELEMETRY_CHECK_MS / 2;
+    if (!mqtt.isConnected() && storeDue) {
+        if (telemetryStore.record(currentReading.level_cm, rate, (uint8_t)smCtx.currentState,
+                                  currentReading.valid, smCtx.sensorError, activeCompartment)) {
+            lastStoredMs = now;
+            stored = true;
+        }
+    }
+
+    if (!latencyDue) return;
+    // Per-channel end-to-end notification latency (queue / deliver / send)
+    char base[64];
+    if (mqtt.getBaseTopic(base, sizeof(base)) == 0 && mqtt.isConnected()) {
+        char topic[112];
+        char latency[NOTIFY_LATENCY_PAYLOAD_MAX];
+        for (size_t i = 0; i < notifier.getChannelCount(); i++) {
+            if (notifier.formatLatencyJson(i, latency, sizeof(latency)) == 0) continue;
+            snprintf(topic, sizeof(topic), "%s/telemetry/notify/%s", base, notifier.getChannelName(i));
+            mqtt.publish(topic, latency, true);
+        }
+#if LOOP_PROFILER
+        publishLoopProfile(base);
+#endif
+        lastLatencyMs = now;
+        latencySent = true;
     }
+}
+
+#if LOOP_PROFILER
+// <baseTopic>/telemetry/loop, plus the next few per-section histograms
+static void publishLoopProfile(const char* base) {
+    static uint8_t nextSection = 0;
+    char topic[112];
+    char payload[LOOP_PROFILE_PAYLOAD_MAX];
+    if (loopProfiler.formatSummaryJson(payload, sizeof(payload), WDT_TIMEOUT_US) > 0) {
+        snprintf(topic, sizeof(topic), "%s/telemetry/loop", base);
+        mqtt.publish(topic, payload, true);
+    }
+    for (uint8_t n = 0; n < LOOP_PROFILE_SECTIONS_PER_PUBLISH; n++) {
+        uint8_t i = nextSection;
+        nextSection = (uint8_t)((nextSection + 1) % loopProfiler.count());
+        if (loopProfiler.section(i).count() == 0) continue;
+        if (LoopProfiler::formatStatsJson(loopProfiler.section(i), payload, sizeof(payload)) == 0) continue;
+        snprintf(topic, sizeof(topic), "%s/telemetry/loop/%s", base, loopProfiler.name(i));
+        mqtt.publish(topic, payload, true);
+    }
+}
+
+// ConfigServer loop-profile source (server task): copies the status job's
+// latest snapshot
+static size_t copyLoopProfile(char* out, size_t len, void*) {
+    uint32_t v;
+    do {
+        v = loopProfileText.readBegin();
+        strlcpy(out, loopProfileText.peek(v).json, len);
+    } while (!loopProfileText.readValid(v));
+    return strlen(out);
+}
+#endif
+
+static void backfillJob(void*) {
+    PROFILE_SCOPE(loopProfiler, PROF_BACKFILL);
+    // Log lines first: a backlog of readings can wait another second
+    if (mqtt.getLogQueueLines() > 0) return;
+    telemetryStore.backfill(mqtt);
+}
+
+// Deep sleep once LowPowerPolicy allows it. Only registered with
+// LOW_POWER_MODE=1.
+static void lowPowerJob(void*) {
+    PROFILE_SCOPE(loopProfiler, PROF_LOWPOWER);
+    const SettingsValues& sv = settingsStore.get();
+    LowPowerPolicy::Inputs in;
+    in.awakeMs = millis();
+    in.stateNormal = smCtx.currentState == NORMAL;
+    in.readingsValid = true;
+    in.maxLevel_cm = 0.0f;
+    uint8_t highest = 0;
+    for (uint8_t ch = 0; ch < SENSOR_CHANNELS; ch++) {
+        const SensorReading& r = compartmentReadings[ch];
+        if (!r.valid) {
+            in.readingsValid = false;
+        } else if (ch == 0 || r.level_cm > in.maxLevel_cm) {
+            in.maxLevel_cm = r.level_cm;
+            highest = ch;
+        }
+    }
+    in.wakeLevel_cm = LowPowerPolicy::wakeLevel(sv.emergencyWaterLevel_cm, LOW_POWER_WAKE_MARGIN_CM);
+
+    OTAState ota = otaManager ? otaManager->getState() : OTAState::IDLE;
+    in.busy = notifier.getPendingCount() > 0 || mqtt.getOutboxMessages() > 0 ||
+              ota == OTAState::CHECKING || ota == OTAState::DOWNLOADING ||
+              ota == OTAState::INSTALLING ||
+              configServer->isSetupModeActive() || buttonCurrentlyPressed;
+
+    // Report as soon as the broker is up rather than waiting a whole
+    // telemetry interval — a heartbeat wake lasts only a few seconds
+    if (telemetrySent == 0 && mqtt.isConnected()) {
+        telemetryJob(nullptr);
+    }
+    in.reported = telemetrySent > 0;
+
+    LowPowerPolicy::Verdict verdict = lowPowerPolicy.check(in);
+    if (verdict != LowPowerPolicy::SLEEP) return;
+
+    // Sleeping blind to a rising level is not an option: without the
+    // comparator (uncalibrated or falling table) stay awake and retry
+    static bool armFailLogged = false;
+    if (!waterSensor.armWakeComparator(in.wakeLevel_cm, highest)) {
+        if (!armFailLogged) {
+            LOG_CRITICAL("[POWER] Wake comparator not armed - staying awake");
+            armFailLogged = true;
+        }
+        return;
+    }
+    LOG_EVENT("[POWER] Deep sleep: level %.1f cm, wake at %.1f cm on channel %u, heartbeat %u s",
+              in.maxLevel_cm, in.wakeLevel_cm, highest, LOW_POWER_HEARTBEAT_S);
+    LowPower::sleep(smCtx, true, LOW_POWER_HEARTBEAT_S);
+}
+
+void loop() {
+
+    esp_task_wdt_reset(); // Feed the watchdog; a stalled loop will trigger reboot
+
+    PROFILE_ITERATION_BEGIN(loopProfiler);
+    uint32_t idleMs = scheduler.runDue(millis());
+    PROFILE_ITERATION_END(loopProfiler);
 
-    // Yield 10 ms at end of loop so the FreeRTOS idle task (light-sleep) can run.
-    // All inputs are interrupt-driven (button) or time-based (>=100 ms granularity),
-    // so this delay is safe and does not affect responsiveness.
-    vTaskDelay(pdMS_TO_TICKS(10));
+    // Sleep until the next job is due so the FreeRTOS idle task (light-sleep)
+    // gets the rest of the time. Capped so the watchdog is still fed promptly
+    // and always at least one tick so lower-priority tasks can run.
+    if (idleMs > LOOP_MAX_IDLE_MS) idleMs = LOOP_MAX_IDLE_MS;
+    vTaskDelay(idleMs > 0 ? pdMS_TO_TICKS(idleMs) : 1);
 }
 
 
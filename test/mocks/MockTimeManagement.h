@@ -23,6 +23,19 @@ public:
     void sync() {
         // No-op in testing
     }
+
+    // Monotonic tick: the mock's time since boot, in microseconds
+    static int64_t monoUs() {
+        return (int64_t)getInstance().mockTimeSinceBoot * 1000;
+    }
+
+    int64_t toEpochUs(int64_t tickUs) const {
+        return tickUs + ((int64_t)mockUnixTime * 1000000 - (int64_t)mockTimeSinceBoot * 1000);
+    }
+
+    int64_t epochUs() const {
+        return (int64_t)mockUnixTime * 1000000;
+    }
     
     Timestamp getCurrentTimestamp() {
         Timestamp ts;
@@ -0,0 +1,283 @@
+#pragma once
+
+/*
+    Adafruit_ADS1X15.h — scriptable ADS1115 model (env:native-sensor)
+
+    Same API as the Adafruit driver calls WaterPressureSensor makes. Behind
+    it is a device that converts on virtual time (Arduino.h's nativeClock())
+    at the configured data rate:
+
+      - continuous mode produces one conversion per 1/SPS; single-shot one,
+        after which readADC_SingleEnded() returns it (blocking for 1/SPS,
+        as the real driver does),
+      - only the newest conversion is readable, so a slow reader misses
+        conversions exactly as on the bench; the conversion register also
+        answers Wire register reads (Wire.h),
+      - with Hi_thresh MSB set / Lo_thresh MSB clear (startADCReading())
+        ALERT/RDY pulses low after every conversion; after
+        startComparator_SingleEnded() it latches low at the first conversion
+        at or above the threshold and releases when the result is read.
+
+    What each input measures is scripted per channel: setSource() for a
+    function of time, setTrace() to replay recorded raw codes. setRdyWired()
+    and nativeI2cFault() inject the two wiring faults the firmware handles.
+
+    The driver instance is owned by WaterPressureSensor; nativeAds() returns
+    the last one constructed.
+*/
+
+#include "Arduino.h"
+#include "Wire.h"
+
+#define ADS1X15_ADDRESS (0x48)
+#define ADS1X15_REG_POINTER_CONVERT (0x00)
+
+#define ADS1X15_REG_CONFIG_MUX_SINGLE_0 (0x4000)
+#define ADS1X15_REG_CONFIG_MUX_SINGLE_1 (0x5000)
+#define ADS1X15_REG_CONFIG_MUX_SINGLE_2 (0x6000)
+#define ADS1X15_REG_CONFIG_MUX_SINGLE_3 (0x7000)
+
+constexpr uint16_t MUX_BY_CHANNEL[] = {
+    ADS1X15_REG_CONFIG_MUX_SINGLE_0,
+    ADS1X15_REG_CONFIG_MUX_SINGLE_1,
+    ADS1X15_REG_CONFIG_MUX_SINGLE_2,
+    ADS1X15_REG_CONFIG_MUX_SINGLE_3,
+};
+
+typedef enum {
+    GAIN_TWOTHIRDS = 0x0000,
+    GAIN_ONE       = 0x0200,
+    GAIN_TWO       = 0x0400,
+    GAIN_FOUR      = 0x0600,
+    GAIN_EIGHT     = 0x0800,
+    GAIN_SIXTEEN   = 0x0A00
+} adsGain_t;
+
+#define RATE_ADS1115_8SPS    (0x0000)
+#define RATE_ADS1115_16SPS   (0x0020)
+#define RATE_ADS1115_32SPS   (0x0040)
+#define RATE_ADS1115_64SPS   (0x0060)
+#define RATE_ADS1115_128SPS  (0x0080)
+#define RATE_ADS1115_250SPS  (0x00A0)
+#define RATE_ADS1115_475SPS  (0x00C0)
+#define RATE_ADS1115_860SPS  (0x00E0)
+
+class Adafruit_ADS1115;
+
+inline Adafruit_ADS1115*& nativeAdsSlot() {
+    static Adafruit_ADS1115* ads = nullptr;
+    return ads;
+}
+inline Adafruit_ADS1115& nativeAds() { return *nativeAdsSlot(); }
+
+class Adafruit_ADS1115 {
+public:
+    // Code the input reads at time us (virtual microseconds since start)
+    typedef int16_t (*Source)(void* ctx, uint8_t channel, uint64_t us);
+
+    static constexpr uint8_t CHANNELS = 4;
+
+    Adafruit_ADS1115()
+        : gain(GAIN_TWOTHIRDS), dataRate(RATE_ADS1115_128SPS), channel(0),
+          continuous(false), running(false), nextConversionUs(0),
+          hiThresh(0x7FFF), loThresh((int16_t)0x8000), comparator(false), latched(false),
+          conversion(0), alertPin(-1), rdyWired(true),
+          conversionCount(0), readCount(0), address(ADS1X15_ADDRESS) {
+        for (uint8_t ch = 0; ch < CHANNELS; ch++) {
+            sources[ch] = nullptr;
+            sourceCtx[ch] = nullptr;
+            traces[ch].codes = nullptr;
+        }
+        nativeAdsSlot() = this;
+    }
+
+    ~Adafruit_ADS1115() {
+        if (nativeAdsSlot() == this) nativeAdsSlot() = nullptr;
+        NativeClock& c = nativeClock();
+        if (c.tickCtx == this) {
+            c.tick = nullptr;
+            c.tickCtx = nullptr;
+        }
+    }
+
+    // ---- Driver API -------------------------------------------------------
+
+    bool begin(uint8_t addr = ADS1X15_ADDRESS, TwoWire* wire = &Wire) {
+        if (nativeI2cFault()) return false;
+        address = addr;
+        wire->setRegisterReader(onRegisterRead, this);
+        NativeClock& c = nativeClock();
+        c.tick = onTick;
+        c.tickCtx = this;
+        return true;
+    }
+
+    void setGain(adsGain_t g) { gain = g; }
+    adsGain_t getGain() { return gain; }
+    void setDataRate(uint16_t rate) { dataRate = rate; }
+    uint16_t getDataRate() { return dataRate; }
+
+    void startADCReading(uint16_t mux, bool continuousMode) {
+        if (nativeI2cFault()) return;
+        configure(mux, continuousMode);
+        // Conversion-ready mode
+        hiThresh = (int16_t)0x8000;
+        loThresh = 0x0000;
+        comparator = false;
+    }
+
+    void startComparator_SingleEnded(uint8_t ch, int16_t threshold) {
+        if (nativeI2cFault()) return;
+        configure(MUX_BY_CHANNEL[ch & 3], true);
+        hiThresh = threshold;
+        comparator = true;
+    }
+
+    int16_t getLastConversionResults() {
+        if (nativeI2cFault()) return 0;
+        readCount++;
+        if (latched) {
+            latched = false;
+            nativeSetPin(alertPin, HIGH);
+        }
+        return conversion;
+    }
+
+    int16_t readADC_SingleEnded(uint8_t ch) {
+        if (nativeI2cFault()) return 0;
+        startADCReading(MUX_BY_CHANNEL[ch & 3], false);
+        nativeAdvanceUs(periodUs());
+        return getLastConversionResults();
+    }
+
+    bool conversionComplete() { return !running; }
+
+    float computeVolts(int16_t counts) {
+        // GAIN_ONE is the only gain the firmware uses
+        return counts * (4.096f / 32768.0f);
+    }
+
+    // ---- Scripting --------------------------------------------------------
+
+    void setSource(uint8_t ch, Source fn, void* ctx = nullptr) {
+        if (ch >= CHANNELS) return;
+        sources[ch] = fn;
+        sourceCtx[ch] = ctx;
+        traces[ch].codes = nullptr;
+    }
+
+    // Replay n recorded codes, one per stepUs from startUs; the last code
+    // holds after the trace ends. codes must outlive the replay.
+    void setTrace(uint8_t ch, const int16_t* codes, size_t n, uint32_t stepUs, uint64_t startUs = 0) {
+        if (ch >= CHANNELS || !codes || n == 0 || stepUs == 0) return;
+        traces[ch].codes = codes;
+        traces[ch].n = n;
+        traces[ch].stepUs = stepUs;
+        traces[ch].startUs = startUs;
+        sources[ch] = traceSource;
+        sourceCtx[ch] = &traces[ch];
+    }
+
+    // false: the ALERT/RDY wire is not connected (no edges reach the ESP)
+    void setRdyWired(bool wired) { rdyWired = wired; }
+    void setAlertPin(int pin) {
+        alertPin = pin;
+        nativeSetPin(alertPin, HIGH);
+    }
+
+    uint32_t conversions() const { return conversionCount; }
+    uint32_t reads() const { return readCount; }
+    bool alertLatched() const { return latched; }
+    bool comparatorMode() const { return comparator; }
+    int16_t threshold() const { return hiThresh; }
+    uint16_t samplesPerSecond() const { return spsFor(dataRate); }
+
+private:
+    struct Trace {
+        const int16_t* codes;
+        size_t   n;
+        uint32_t stepUs;
+        uint64_t startUs;
+    };
+
+    static uint16_t spsFor(uint16_t rate) {
+        static const uint16_t SPS[] = { 8, 16, 32, 64, 128, 250, 475, 860 };
+        return SPS[(rate >> 5) & 7];
+    }
+
+    uint32_t periodUs() const { return 1000000u / spsFor(dataRate); }
+
+    void configure(uint16_t mux, bool continuousMode) {
+        channel = (uint8_t)((mux >> 12) & 3);
+        continuous = continuousMode;
+        running = true;
+        nextConversionUs = nativeClock().us + periodUs();
+    }
+
+    static int16_t traceSource(void* ctx, uint8_t, uint64_t us) {
+        const Trace* t = static_cast<const Trace*>(ctx);
+        uint64_t i = us < t->startUs ? 0 : (us - t->startUs) / t->stepUs;
+        return t->codes[i < t->n ? i : t->n - 1];
+    }
+
+    // Conversion register over Wire: same as getLastConversionResults()
+    static bool onRegisterRead(void* ctx, uint8_t addr, uint8_t reg, uint8_t* buf, uint8_t n) {
+        Adafruit_ADS1115* self = static_cast<Adafruit_ADS1115*>(ctx);
+        if (addr != self->address || reg != ADS1X15_REG_POINTER_CONVERT || n != 2) return false;
+        uint16_t code = (uint16_t)self->getLastConversionResults();
+        buf[0] = (uint8_t)(code >> 8);
+        buf[1] = (uint8_t)code;
+        return true;
+    }
+
+    static void onTick(void* ctx, uint64_t nowUs) {
+        static_cast<Adafruit_ADS1115*>(ctx)->catchUp(nowUs);
+    }
+
+    void catchUp(uint64_t nowUs) {
+        while (running && nextConversionUs <= nowUs) {
+            convert(nextConversionUs);
+            if (continuous) {
+                nextConversionUs += periodUs();
+            } else {
+                running = false;
+            }
+        }
+    }
+
+    void convert(uint64_t atUs) {
+        Source fn = sources[channel];
+        conversion = fn ? fn(sourceCtx[channel], channel, atUs) : 0;
+        conversionCount++;
+        if (!rdyWired) return;
+        if (comparator) {
+            if (conversion >= hiThresh && !latched) {
+                latched = true;
+                nativeSetPin(alertPin, LOW);
+            }
+        } else if ((hiThresh & 0x8000) && !(loThresh & 0x8000)) {
+            nativePulsePin(alertPin);
+        }
+    }
+
+    adsGain_t gain;
+    uint16_t  dataRate;
+    uint8_t   channel;
+    bool      continuous;
+    bool      running;
+    uint64_t  nextConversionUs;
+    int16_t   hiThresh;
+    int16_t   loThresh;
+    bool      comparator;
+    bool      latched;
+    int16_t   conversion;
+    int       alertPin;
+    bool      rdyWired;
+    uint32_t  conversionCount;
+    uint32_t  readCount;
+    uint8_t   address;
+
+    Source sources[CHANNELS];
+    void*  sourceCtx[CHANNELS];
+    Trace  traces[CHANNELS];
+};
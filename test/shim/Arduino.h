@@ -0,0 +1,165 @@
+#pragma once
+
+/*
+    Arduino.h — host stand-in for the arduino-esp32 core (env:native-sensor)
+
+    Just enough of the core for src/WaterPressureSensor.cpp to build and run
+    on the host. Time is virtual: millis()/micros() read nativeClock(), and
+    only delay(), delayMicroseconds() or nativeAdvanceUs() move it. Each
+    advance lets the registered peripheral model (the ADS1115 in
+    Adafruit_ADS1X15.h) catch up to the new time, firing the interrupts it
+    would have raised on the way.
+
+    Globals (Serial, the clock, the interrupt table) live in function-local
+    statics so every translation unit shares one copy without a .cpp.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define IRAM_ATTR
+
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+
+#define LOW  0x0
+#define HIGH 0x1
+
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+
+static constexpr int NATIVE_GPIO_COUNT = 40;
+
+// ----------------------------------------------------------------------------
+// Virtual time
+// ----------------------------------------------------------------------------
+
+struct NativeClock {
+    uint64_t us;
+    // Peripheral model catching up to nowUs (one model: the ADS1115)
+    void (*tick)(void* ctx, uint64_t nowUs);
+    void* tickCtx;
+};
+
+inline NativeClock& nativeClock() {
+    static NativeClock clock = { 0, nullptr, nullptr };
+    return clock;
+}
+
+inline void nativeAdvanceUs(uint64_t us) {
+    NativeClock& c = nativeClock();
+    c.us += us;
+    if (c.tick) c.tick(c.tickCtx, c.us);
+}
+
+inline uint32_t millis() { return (uint32_t)(nativeClock().us / 1000); }
+inline uint32_t micros() { return (uint32_t)nativeClock().us; }
+inline void delay(uint32_t ms) { nativeAdvanceUs((uint64_t)ms * 1000); }
+inline void delayMicroseconds(uint32_t us) { nativeAdvanceUs(us); }
+inline void yield() {}
+
+// ----------------------------------------------------------------------------
+// GPIO and interrupts
+// ----------------------------------------------------------------------------
+
+struct NativeGpio {
+    uint8_t level[NATIVE_GPIO_COUNT];
+    void (*isr[NATIVE_GPIO_COUNT])();
+    int isrMode[NATIVE_GPIO_COUNT];
+    uint32_t isrRuns[NATIVE_GPIO_COUNT];
+};
+
+inline NativeGpio& nativeGpio() {
+    static NativeGpio gpio;
+    static bool init = false;
+    if (!init) {
+        memset(&gpio, 0, sizeof(gpio));
+        memset(gpio.level, HIGH, sizeof(gpio.level));
+        init = true;
+    }
+    return gpio;
+}
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t pin, uint8_t val) {
+    if (pin < NATIVE_GPIO_COUNT) nativeGpio().level[pin] = val ? HIGH : LOW;
+}
+inline int digitalRead(uint8_t pin) {
+    return pin < NATIVE_GPIO_COUNT ? nativeGpio().level[pin] : LOW;
+}
+
+inline int digitalPinToInterrupt(int pin) { return pin; }
+inline void attachInterrupt(uint8_t pin, void (*fn)(), int mode) {
+    if (pin >= NATIVE_GPIO_COUNT) return;
+    nativeGpio().isr[pin] = fn;
+    nativeGpio().isrMode[pin] = mode;
+}
+inline void detachInterrupt(uint8_t pin) {
+    if (pin < NATIVE_GPIO_COUNT) nativeGpio().isr[pin] = nullptr;
+}
+
+// Drive an input from a peripheral model, running an attached ISR on the
+// matching edge.
+inline void nativeSetPin(int pin, uint8_t level) {
+    if (pin < 0 || pin >= NATIVE_GPIO_COUNT) return;
+    NativeGpio& g = nativeGpio();
+    uint8_t was = g.level[pin];
+    g.level[pin] = level;
+    if (!g.isr[pin] || was == level) return;
+    int edge = level == LOW ? FALLING : RISING;
+    if (g.isrMode[pin] == edge || g.isrMode[pin] == CHANGE) {
+        g.isrRuns[pin]++;
+        g.isr[pin]();
+    }
+}
+
+// Times an attached ISR has run on pin — what a task woken from it would
+// have been notified.
+inline uint32_t nativeIsrRuns(int pin) {
+    return pin >= 0 && pin < NATIVE_GPIO_COUNT ? nativeGpio().isrRuns[pin] : 0;
+}
+
+// A pulse too short to read back (the ADS1115's 8 us RDY low): edge-triggered
+// ISRs see it, digitalRead() doesn't.
+inline void nativePulsePin(int pin) {
+    nativeSetPin(pin, LOW);
+    nativeSetPin(pin, HIGH);
+}
+
+inline long random(long lo, long hi) { return hi > lo ? lo + rand() % (hi - lo) : lo; }
+
+// ----------------------------------------------------------------------------
+// Serial — captured, echoed to stdout only when asked
+// ----------------------------------------------------------------------------
+
+class NativeSerial {
+public:
+    NativeSerial() : echo(false), lines(0) { last[0] = '\0'; }
+
+    void begin(unsigned long) {}
+    void flush() {}
+    void print(const char* s) { if (echo) fputs(s, stdout); }
+    void println(const char* s) {
+        lines++;
+        strncpy(last, s, sizeof(last) - 1);
+        last[sizeof(last) - 1] = '\0';
+        if (echo) puts(s);
+    }
+    void println() { println(""); }
+
+    bool echo;
+    uint32_t lines;
+    char last[256];
+};
+
+inline NativeSerial& nativeSerial() {
+    static NativeSerial serial;
+    return serial;
+}
+static NativeSerial& Serial = nativeSerial();
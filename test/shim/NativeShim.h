@@ -0,0 +1,22 @@
+#pragma once
+
+/*
+    NativeShim.h — everything src/WaterPressureSensor.cpp needs from the
+    ESP32 platform, for the host build of the real sensor pipeline
+    (env:native-sensor, -D NATIVE_SENSOR_SHIM -I test/shim).
+
+    include/TimeManagement.h is inert under UNIT_TESTING, so the one piece of
+    it the sensor uses, monoUs(), is provided here on the virtual clock.
+*/
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "Adafruit_ADS1X15.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_task_wdt.h"
+
+class TimeManagement {
+public:
+    static int64_t monoUs() { return (int64_t)nativeClock().us; }
+};
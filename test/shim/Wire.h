@@ -0,0 +1,100 @@
+#pragma once
+
+/*
+    Wire.h — host stand-in for the arduino-esp32 TwoWire (env:native-sensor)
+
+    No bus: transactions succeed unless nativeI2cFault() is set, which makes
+    every device NACK its address (Adafruit_ADS1X15.h reads the same flag).
+    Register reads (pointer write, then requestFrom()) are answered by the
+    device registered with setRegisterReader() — the ADS1115 model. Each
+    transfer advances the virtual clock by its time on the wire at clockHz,
+    so a reader that keeps the bus busy loses conversions as it would on
+    the boat.
+*/
+
+#include "Arduino.h"
+
+inline bool& nativeI2cFault() {
+    static bool fault = false;
+    return fault;
+}
+
+class TwoWire {
+public:
+    // Register reg of device addr into buf (n bytes); false = no such device
+    typedef bool (*RegisterReader)(void* ctx, uint8_t addr, uint8_t reg, uint8_t* buf, uint8_t n);
+
+    TwoWire()
+        : started(false), clockHz(100000), transactions(0),
+          reader(nullptr), readerCtx(nullptr), txAddr(0), txLen(0), pointer(0),
+          rxLen(0), rxPos(0) {}
+
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) {
+        (void)sda; (void)scl;
+        if (frequency) clockHz = frequency;
+        started = true;
+        return true;
+    }
+    bool end() { started = false; return true; }
+    bool setClock(uint32_t hz) { clockHz = hz; return true; }
+
+    void beginTransmission(uint8_t addr) {
+        transactions++;
+        txAddr = addr;
+        txLen = 0;
+    }
+    size_t write(uint8_t b) {
+        if (txLen == 0) pointer = b;
+        txLen++;
+        return 1;
+    }
+    // 0 = ACK, 2 = address NACK (as the esp32 core reports it)
+    uint8_t endTransmission(bool = true) {
+        wireTime(txLen);
+        return acked() ? 0 : 2;
+    }
+
+    uint8_t requestFrom(uint8_t addr, uint8_t n) {
+        transactions++;
+        rxLen = rxPos = 0;
+        wireTime(n);
+        if (!acked() || n > sizeof(rx)) return 0;
+        if (!reader || !reader(readerCtx, addr, pointer, rx, n)) return 0;
+        rxLen = n;
+        return n;
+    }
+    int available() { return rxLen - rxPos; }
+    int read() { return rxPos < rxLen ? rx[rxPos++] : -1; }
+
+    void setRegisterReader(RegisterReader fn, void* ctx) {
+        reader = fn;
+        readerCtx = ctx;
+    }
+
+    bool     started;
+    uint32_t clockHz;
+    uint32_t transactions;
+
+private:
+    bool acked() const { return started && !nativeI2cFault(); }
+
+    // Start, address byte, n data bytes (9 clocks each with the ACK), stop
+    void wireTime(uint8_t n) {
+        nativeAdvanceUs(((uint64_t)(n + 1) * 9 + 2) * 1000000u / clockHz);
+    }
+
+    RegisterReader reader;
+    void*    readerCtx;
+    uint8_t  txAddr;
+    uint8_t  txLen;
+    uint8_t  pointer;
+    uint8_t  rx[4];
+    uint8_t  rxLen;
+    uint8_t  rxPos;
+};
+
+inline TwoWire& nativeWire() {
+    static TwoWire wire;
+    return wire;
+}
+static TwoWire& Wire = nativeWire();
@@ -0,0 +1,29 @@
+#pragma once
+
+/*
+    freertos/FreeRTOS.h — host stand-in (env:native-sensor)
+
+    The host build is single-threaded: critical sections are no-ops and a
+    tick is a millisecond of Arduino.h's virtual clock.
+*/
+
+#include "../Arduino.h"
+
+typedef int32_t  BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdPASS  1
+#define pdFAIL  0
+#define pdTRUE  1
+#define pdFALSE 0
+#define portMAX_DELAY 0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+typedef struct { uint32_t owner; uint32_t count; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED { 0, 0 }
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux)  ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux) ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux)  ((void)(mux))
+#define portYIELD_FROM_ISR(woken)   ((void)(woken))
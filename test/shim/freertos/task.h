@@ -0,0 +1,43 @@
+#pragma once
+
+/*
+    freertos/task.h — host stand-in (env:native-sensor)
+
+    There is no scheduler: task creation fails, so code under test falls
+    back to being driven directly (WaterPressureSensor::readLevel() from the
+    test loop instead of the sampling task). With no task to wake, a
+    notification from an ISR goes nowhere and a notification wait is its
+    timeout.
+*/
+
+#include "FreeRTOS.h"
+
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+typedef enum { eRunning, eReady, eBlocked, eSuspended, eDeleted, eInvalid } eTaskState;
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char*, uint32_t, void*,
+                                          UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+    if (handle) *handle = nullptr;
+    return pdFAIL;
+}
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return nullptr; }
+inline eTaskState eTaskGetState(TaskHandle_t) { return eInvalid; }
+inline void vTaskSuspend(TaskHandle_t) {}
+inline void vTaskResume(TaskHandle_t) {}
+inline UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) { return 0; }
+inline TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+inline void vTaskDelay(TickType_t ticks) { delay(ticks); }
+inline void vTaskDelayUntil(TickType_t* last, TickType_t period) {
+    TickType_t now = xTaskGetTickCount();
+    *last += period;
+    if ((int32_t)(*last - now) > 0) delay(*last - now);
+}
+inline void vTaskNotifyGiveFromISR(TaskHandle_t, BaseType_t* woken) {
+    if (woken) *woken = pdFALSE;
+}
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t ticks) {
+    vTaskDelay(ticks);
+    return 0;
+}
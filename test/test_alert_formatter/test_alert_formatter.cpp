@@ -0,0 +1,107 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+#include <string.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/AlertFormatter.h"
+
+static StateMachineEventRecord emergencyEvent(float level, float rate, bool fault, bool urgent) {
+    StateMachineOutput out;
+    StateMachineEventRecord& ev = out.push(SM_EVENT_EMERGENCY);
+    ev.emergency.level_cm = level;
+    ev.emergency.rate_cm30min = rate;
+    ev.emergency.sensorFault = fault;
+    ev.emergency.urgent = urgent;
+    return ev;
+}
+
+// ============================================================================
+// Emergency alerts
+// ============================================================================
+
+void test_format_tier1_alert_with_rate() {
+    char buf[160];
+    StateMachineEventRecord ev = emergencyEvent(31.25f, 2.5f, false, false);
+    formatAlert(buf, sizeof(buf), ev, 7);
+    TEST_ASSERT_EQUAL_STRING("[MSG:7] BilgeRise Alert: Emergency Level 31.25 cm (+2.5 cm/30min)", buf);
+}
+
+void test_format_tier2_alert_without_rate() {
+    char buf[160];
+    StateMachineEventRecord ev = emergencyEvent(40.0f, NAN, false, true);
+    formatAlert(buf, sizeof(buf), ev, 12);
+    TEST_ASSERT_EQUAL_STRING("[MSG:12] BilgeRise URGENT Alert: Tier 2 Emergency Level 40.00 cm", buf);
+}
+
+void test_format_sensor_fault_drops_rate() {
+    char buf[160];
+    StateMachineEventRecord ev = emergencyEvent(30.0f, 5.0f, true, false);
+    formatAlert(buf, sizeof(buf), ev, 3);
+    TEST_ASSERT_EQUAL_STRING("[MSG:3] BilgeRise Alert: Emergency Level 30.00 cm — SENSOR FAULT (level stale)", buf);
+}
+
+void test_format_names_compartment_on_multi_compartment_boats() {
+    char buf[160];
+    StateMachineEventRecord ev = emergencyEvent(30.0f, NAN, false, false);
+    ev.compartment = 1;
+    ev.compartmentCount = 3;
+    formatAlert(buf, sizeof(buf), ev, 4);
+    TEST_ASSERT_EQUAL_STRING("[MSG:4] BilgeRise Alert: Emergency Level 30.00 cm in compartment 2", buf);
+}
+
+// ============================================================================
+// Other events
+// ============================================================================
+
+void test_format_sensor_failure_and_recovery() {
+    char buf[160];
+    StateMachineOutput out;
+    out.push(SM_EVENT_SENSOR_FAILURE).sensorFailure.downSeconds = 60;
+    out.push(SM_EVENT_SENSOR_RECOVERED);
+
+    formatAlert(buf, sizeof(buf), out.queue[0], 1);
+    TEST_ASSERT_EQUAL_STRING("[MSG:1] BilgeRise: Sensor failure — no valid reading for 60s. "
+                             "Flood detection is OFFLINE; device needs inspection.", buf);
+    formatAlert(buf, sizeof(buf), out.queue[1], 2);
+    TEST_ASSERT_EQUAL_STRING("[MSG:2] BilgeRise: Sensor recovered — water-level monitoring restored.", buf);
+}
+
+void test_format_unsilenced_has_no_message() {
+    char buf[32] = "untouched";
+    StateMachineOutput out;
+    out.push(SM_EVENT_UNSILENCED);
+    TEST_ASSERT_FALSE(alertHasMessage(SM_EVENT_UNSILENCED));
+    TEST_ASSERT_TRUE(alertHasMessage(SM_EVENT_SILENCED));
+    TEST_ASSERT_EQUAL(0, formatAlert(buf, sizeof(buf), out.queue[0], 1));
+    TEST_ASSERT_EQUAL_STRING("", buf);
+}
+
+void test_format_truncates_to_buffer() {
+    char buf[16];
+    StateMachineEventRecord ev = emergencyEvent(31.25f, 2.5f, false, true);
+    int n = formatAlert(buf, sizeof(buf), ev, 7);
+    TEST_ASSERT_TRUE(n >= (int)sizeof(buf));
+    TEST_ASSERT_EQUAL(sizeof(buf) - 1, strlen(buf));
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_format_tier1_alert_with_rate);
+    RUN_TEST(test_format_tier2_alert_without_rate);
+    RUN_TEST(test_format_sensor_fault_drops_rate);
+    RUN_TEST(test_format_names_compartment_on_multi_compartment_boats);
+
+    RUN_TEST(test_format_sensor_failure_and_recovery);
+    RUN_TEST(test_format_unsilenced_has_no_message);
+    RUN_TEST(test_format_truncates_to_buffer);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
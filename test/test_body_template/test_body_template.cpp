@@ -0,0 +1,179 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+#include <string.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/BodyTemplate.h"
+
+// Render through a Reader in pieces of `chunk` bytes.
+static size_t render(const BodyTemplate& t, const TemplateContext& ctx,
+                     char* out, size_t size, size_t chunk) {
+    BodyTemplate::Reader r(t, ctx);
+    size_t len = 0;
+    size_t n;
+    while (len + chunk < size && (n = r.read(out + len, chunk)) > 0) len += n;
+    out[len] = '\0';
+    return len;
+}
+
+static TemplateContext context(const char* message) {
+    TemplateContext ctx;
+    ctx.message = message;
+    ctx.level_cm = 42.1f;
+    ctx.rate_cm_30min = -0.5f;
+    ctx.state = "EMERGENCY";
+    ctx.deviceId = "boat-a1b2c3";
+    ctx.timestamp = 1760000000;
+    return ctx;
+}
+
+// ============================================================================
+// Compilation
+// ============================================================================
+
+void test_template_compiles_literals_and_placeholders() {
+    BodyTemplate t;
+    t.compile("{\"text\":\"{{message}}\",\"cm\":{{level}}}", BodyTemplate::ESCAPE_JSON);
+    TEST_ASSERT_EQUAL_UINT8(5, t.segmentCount());
+    TEST_ASSERT_EQUAL(BodyTemplate::FIELD_LITERAL, t.segment(0).field);
+    TEST_ASSERT_EQUAL(BodyTemplate::FIELD_MESSAGE, t.segment(1).field);
+    TEST_ASSERT_EQUAL(BodyTemplate::FIELD_LITERAL, t.segment(2).field);
+    TEST_ASSERT_EQUAL(BodyTemplate::FIELD_LEVEL,   t.segment(3).field);
+    TEST_ASSERT_EQUAL(BodyTemplate::FIELD_LITERAL, t.segment(4).field);
+    TEST_ASSERT_TRUE(t.hasPlaceholder());
+}
+
+void test_template_without_placeholder_is_verbatim() {
+    BodyTemplate t;
+    t.compile("static body {{unknown}} {{", BodyTemplate::ESCAPE_RAW);
+    TEST_ASSERT_EQUAL_UINT8(1, t.segmentCount());
+    TEST_ASSERT_FALSE(t.hasPlaceholder());
+
+    char out[64];
+    render(t, context("ignored"), out, sizeof(out), 16);
+    TEST_ASSERT_EQUAL_STRING("static body {{unknown}} {{", out);
+}
+
+void test_template_segment_overflow_keeps_rest_literal() {
+    char tmpl[400] = "";
+    for (int i = 0; i < 30; i++) strcat(tmpl, "x{{state}}");
+    BodyTemplate t;
+    t.compile(tmpl, BodyTemplate::ESCAPE_RAW);
+    TEST_ASSERT_TRUE(t.segmentCount() <= BodyTemplate::MAX_SEGMENTS);
+
+    TemplateContext ctx = context("m");
+    ctx.state = "S";
+    char out[400];
+    render(t, ctx, out, sizeof(out), 64);
+    // The first placeholders are substituted, the tail is left as written
+    TEST_ASSERT_EQUAL(0, strncmp(out, "xSxS", 4));
+    TEST_ASSERT_NOT_NULL(strstr(out, "x{{state}}"));
+}
+
+// ============================================================================
+// Escaping and values
+// ============================================================================
+
+void test_template_json_escapes_values_not_literals() {
+    BodyTemplate t;
+    t.compile("{\"content\":\"{{message}}\"}", BodyTemplate::ESCAPE_JSON);
+    char out[128];
+    render(t, context("say \"hi\"\n\x01\\"), out, sizeof(out), 64);
+    TEST_ASSERT_EQUAL_STRING("{\"content\":\"say \\\"hi\\\"\\n\\u0001\\\\\"}", out);
+}
+
+void test_template_form_encodes_values() {
+    BodyTemplate t;
+    t.compile("msg={{message}}&id={{device_id}}",
+              BodyTemplate::escapeFor("application/x-www-form-urlencoded"));
+    char out[128];
+    render(t, context("Water 42cm & rising!"), out, sizeof(out), 64);
+    TEST_ASSERT_EQUAL_STRING("msg=Water+42cm+%26+rising%21&id=boat-a1b2c3", out);
+}
+
+void test_template_numeric_fields_and_missing_values() {
+    BodyTemplate t;
+    t.compile("{\"level\":{{level}},\"rate\":{{rate}},\"t\":{{timestamp}},\"s\":\"{{state}}\"}",
+              BodyTemplate::escapeFor("application/json"));
+    TemplateContext ctx = context("m");
+    char out[128];
+    render(t, ctx, out, sizeof(out), 64);
+    TEST_ASSERT_EQUAL_STRING("{\"level\":42.10,\"rate\":-0.50,\"t\":1760000000,\"s\":\"EMERGENCY\"}", out);
+
+    ctx.level_cm = NAN;
+    render(t, ctx, out, sizeof(out), 64);
+    TEST_ASSERT_NOT_NULL(strstr(out, "\"level\":null,"));
+
+    BodyTemplate raw;
+    raw.compile("[{{level}}]", BodyTemplate::ESCAPE_RAW);
+    render(raw, ctx, out, sizeof(out), 64);
+    TEST_ASSERT_EQUAL_STRING("[]", out);
+}
+
+// ============================================================================
+// Streaming
+// ============================================================================
+
+void test_template_chunked_reads_match_length() {
+    BodyTemplate t;
+    t.compile("{\"content\":\"{{message}}\",\"state\":\"{{state}}\",\"id\":\"{{device_id}}\"}",
+              BodyTemplate::ESCAPE_JSON);
+    // A message well past the old 159-char escape buffer
+    char msg[321];
+    for (int i = 0; i < 320; i++) msg[i] = (i % 40 == 39) ? '"' : 'a' + (i % 26);
+    msg[320] = '\0';
+    TemplateContext ctx = context(msg);
+
+    char whole[1024];
+    size_t len = render(t, ctx, whole, sizeof(whole), 512);
+    TEST_ASSERT_EQUAL_size_t(t.length(ctx), len);
+
+    const size_t chunks[] = { 1, 3, 7, 64 };
+    for (size_t c : chunks) {
+        char piece[1024];
+        TEST_ASSERT_EQUAL_size_t(len, render(t, ctx, piece, sizeof(piece), c));
+        TEST_ASSERT_EQUAL_STRING(whole, piece);
+    }
+}
+
+void test_template_reader_rewinds() {
+    BodyTemplate t;
+    t.compile("a{{message}}b", BodyTemplate::ESCAPE_FORM);
+    TemplateContext ctx = context("x y");
+    BodyTemplate::Reader r(t, ctx);
+    char out[16];
+    size_t n = r.read(out, sizeof(out));
+    out[n] = '\0';
+    TEST_ASSERT_EQUAL_STRING("ax+yb", out);
+    TEST_ASSERT_TRUE(r.done());
+    TEST_ASSERT_EQUAL_size_t(0, r.read(out, sizeof(out)));
+
+    r.rewind();
+    n = r.read(out, 2);
+    TEST_ASSERT_EQUAL_size_t(2, n);
+    TEST_ASSERT_EQUAL(0, strncmp(out, "ax", 2));
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_template_compiles_literals_and_placeholders);
+    RUN_TEST(test_template_without_placeholder_is_verbatim);
+    RUN_TEST(test_template_segment_overflow_keeps_rest_literal);
+
+    RUN_TEST(test_template_json_escapes_values_not_literals);
+    RUN_TEST(test_template_form_encodes_values);
+    RUN_TEST(test_template_numeric_fields_and_missing_values);
+
+    RUN_TEST(test_template_chunked_reads_match_length);
+    RUN_TEST(test_template_reader_rewinds);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
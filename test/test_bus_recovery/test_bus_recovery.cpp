@@ -0,0 +1,127 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/I2cBusRecovery.h"
+
+namespace TestConstants {
+    constexpr uint8_t  MAX_ATTEMPTS = 10; // BUS_RECOVERY_MAX_ATTEMPTS
+    constexpr uint32_t TICK_MS      = 10; // sampling task period
+}
+
+// Run one full cycle from a fresh onBusError() through the post-cycle wait.
+// Returns the time at which the sequencer went idle again.
+static uint32_t runCycle(I2cBusRecovery& r, uint32_t now) {
+    r.onBusError(now);
+    while (r.busy()) {
+        r.step(now);
+        now += TestConstants::TICK_MS;
+    }
+    return now;
+}
+
+// ============================================================================
+// Sequencing
+// ============================================================================
+
+void test_recovery_idle_until_error() {
+    I2cBusRecovery r(TestConstants::MAX_ATTEMPTS);
+    TEST_ASSERT_FALSE(r.busy());
+    TEST_ASSERT_EQUAL(I2cBusRecovery::NONE, r.step(0));
+}
+
+void test_recovery_one_action_per_step_in_order() {
+    I2cBusRecovery r(TestConstants::MAX_ATTEMPTS);
+    r.onBusError(0);
+    TEST_ASSERT_EQUAL(I2cBusRecovery::TAKE_PINS, r.step(0));
+    for (int i = 0; i < I2cBusRecovery::RECOVERY_CLOCK_PULSES; i++) {
+        TEST_ASSERT_EQUAL(I2cBusRecovery::CLOCK_PULSE, r.step(10 + i * 10));
+    }
+    TEST_ASSERT_EQUAL(I2cBusRecovery::STOP, r.step(100));
+    TEST_ASSERT_EQUAL(I2cBusRecovery::REINIT, r.step(110));
+    // Retry wait: busy (no probing) but nothing to do
+    TEST_ASSERT_TRUE(r.busy());
+    TEST_ASSERT_EQUAL(I2cBusRecovery::NONE, r.step(120));
+    r.step(110 + I2cBusRecovery::RETRY_MS);
+    TEST_ASSERT_FALSE(r.busy());
+}
+
+void test_recovery_error_during_cycle_is_ignored() {
+    I2cBusRecovery r(TestConstants::MAX_ATTEMPTS);
+    r.onBusError(0);
+    r.step(0);
+    r.onBusError(10); // e.g. a second caller probing mid-cycle
+    TEST_ASSERT_EQUAL(1, r.attemptCount());
+    TEST_ASSERT_EQUAL(I2cBusRecovery::CLOCK_PULSE, r.step(10));
+}
+
+// ============================================================================
+// Attempts, backoff and recovery reporting
+// ============================================================================
+
+void test_recovery_unrecoverable_after_max_attempts_then_backs_off() {
+    I2cBusRecovery r(TestConstants::MAX_ATTEMPTS);
+    uint32_t now = 0;
+    for (int i = 0; i < TestConstants::MAX_ATTEMPTS - 1; i++) {
+        now = runCycle(r, now);
+        TEST_ASSERT_FALSE(r.unrecoverable());
+    }
+    uint32_t start = now;
+    now = runCycle(r, now);
+    TEST_ASSERT_TRUE(r.unrecoverable());
+    // The exhausting cycle waits BACKOFF_BASE_MS, not RETRY_MS...
+    TEST_ASSERT_TRUE(now - start >= I2cBusRecovery::BACKOFF_BASE_MS);
+
+    // ...and each later cycle doubles it, up to BACKOFF_MAX_MS.
+    start = now;
+    now = runCycle(r, now);
+    TEST_ASSERT_TRUE(now - start >= 2 * I2cBusRecovery::BACKOFF_BASE_MS);
+    for (int i = 0; i < 10; i++) {
+        start = now;
+        now = runCycle(r, now);
+    }
+    TEST_ASSERT_TRUE(now - start <= I2cBusRecovery::BACKOFF_MAX_MS + 200);
+}
+
+void test_recovery_good_probe_clears_latch_and_reports_duration() {
+    I2cBusRecovery r(TestConstants::MAX_ATTEMPTS);
+    uint32_t now = 5000;
+    for (int i = 0; i < TestConstants::MAX_ATTEMPTS; i++) {
+        now = runCycle(r, now);
+    }
+    TEST_ASSERT_TRUE(r.unrecoverable());
+
+    r.onBusOk(now);
+    TEST_ASSERT_FALSE(r.unrecoverable());
+    TEST_ASSERT_EQUAL(0, r.attemptCount());
+    TEST_ASSERT_EQUAL(1, r.recoveryCount());
+    TEST_ASSERT_EQUAL(now - 5000, r.lastRecoveryDurationMs());
+}
+
+void test_recovery_ok_without_episode_is_noop() {
+    I2cBusRecovery r(TestConstants::MAX_ATTEMPTS);
+    r.onBusOk(1234);
+    TEST_ASSERT_EQUAL(0, r.recoveryCount());
+    TEST_ASSERT_EQUAL(0, r.lastRecoveryDurationMs());
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_recovery_idle_until_error);
+    RUN_TEST(test_recovery_one_action_per_step_in_order);
+    RUN_TEST(test_recovery_error_during_cycle_is_ignored);
+
+    RUN_TEST(test_recovery_unrecoverable_after_max_attempts_then_backs_off);
+    RUN_TEST(test_recovery_good_probe_clears_latch_and_reports_duration);
+    RUN_TEST(test_recovery_ok_without_episode_is_noop);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
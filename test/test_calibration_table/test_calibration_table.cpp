@@ -0,0 +1,152 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/CalibrationTable.h"
+
+// ============================================================================
+// Building the table
+// ============================================================================
+
+void test_table_needs_two_distinct_points() {
+    CalibrationTable t;
+    CalibrationPoint one[1] = { { 590, 0.0f } };
+    TEST_ASSERT_FALSE(t.build(one, 1));
+    TEST_ASSERT_FALSE(t.active());
+
+    CalibrationPoint dup[2] = { { 590, 0.0f }, { 590, 10.0f } };
+    TEST_ASSERT_FALSE(t.build(dup, 2));
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 0.0f, t.levelFromMillivolts(1000));
+}
+
+void test_table_sorts_points_by_millivolts() {
+    CalibrationTable t;
+    CalibrationPoint pts[3] = { { 2000, 40.0f }, { 600, 0.0f }, { 1300, 20.0f } };
+    TEST_ASSERT_TRUE(t.build(pts, 3));
+    TEST_ASSERT_EQUAL(3, t.size());
+    TEST_ASSERT_EQUAL(600, t.point(0).millivolts);
+    TEST_ASSERT_EQUAL(1300, t.point(1).millivolts);
+    TEST_ASSERT_EQUAL(2000, t.point(2).millivolts);
+}
+
+// ============================================================================
+// Lookup
+// ============================================================================
+
+void test_table_two_points_match_legacy_line() {
+    // Same line the old two-point formula used:
+    // level = (mv - zero) * (cm2 / (mv2 - zero))
+    CalibrationTable t;
+    CalibrationPoint pts[2] = { { 590, 0.0f }, { 2345, 50.0f } };
+    TEST_ASSERT_TRUE(t.build(pts, 2));
+    for (int mv = 400; mv <= 4000; mv += 37) {
+        float expected = (mv - 590) * (50.0f / (2345 - 590));
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, expected, t.levelFromMillivolts(mv));
+    }
+}
+
+void test_table_hits_every_calibration_point_exactly() {
+    CalibrationTable t;
+    CalibrationPoint pts[5] = {
+        { 590, 0.0f }, { 1100, 12.5f }, { 1800, 31.0f }, { 2700, 58.0f }, { 3900, 97.5f }
+    };
+    TEST_ASSERT_TRUE(t.build(pts, 5));
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(0.001f, pts[i].level_cm, t.levelFromMillivolts(pts[i].millivolts));
+    }
+}
+
+void test_table_interpolates_within_segment() {
+    CalibrationTable t;
+    CalibrationPoint pts[3] = { { 600, 0.0f }, { 1600, 20.0f }, { 2100, 40.0f } };
+    TEST_ASSERT_TRUE(t.build(pts, 3));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 10.0f, t.levelFromMillivolts(1100)); // shallow segment
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 30.0f, t.levelFromMillivolts(1850)); // steep segment
+}
+
+void test_table_extrapolates_past_ends() {
+    CalibrationTable t;
+    CalibrationPoint pts[3] = { { 600, 0.0f }, { 1600, 20.0f }, { 2100, 40.0f } };
+    TEST_ASSERT_TRUE(t.build(pts, 3));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, -2.0f, t.levelFromMillivolts(500));  // first segment slope
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 60.0f, t.levelFromMillivolts(2600)); // last segment slope
+}
+
+void test_table_code_and_millivolt_lookups_agree() {
+    CalibrationTable t;
+    CalibrationPoint pts[2] = { { 590, 0.0f }, { 4096, 100.0f } };
+    TEST_ASSERT_TRUE(t.build(pts, 2));
+    // 8 codes per mV at GAIN_ONE
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, t.levelFromMillivolts(2000),
+                             t.levelFromCode(2000 * ADS_GAIN_ONE_CODES_PER_MV));
+    // Sub-millivolt resolution from the raw code
+    float lo = t.levelFromCode(2000 * ADS_GAIN_ONE_CODES_PER_MV);
+    float hi = t.levelFromCode(2000 * ADS_GAIN_ONE_CODES_PER_MV + 4);
+    TEST_ASSERT_TRUE(hi > lo);
+}
+
+// ============================================================================
+// Inverse lookup (comparator threshold)
+// ============================================================================
+
+void test_table_code_for_level_is_lowest_code_at_or_above() {
+    CalibrationTable t;
+    CalibrationPoint pts[3] = { { 600, 0.0f }, { 1600, 20.0f }, { 2100, 40.0f } };
+    TEST_ASSERT_TRUE(t.build(pts, 3));
+    const float levels[] = { 0.0f, 7.3f, 20.0f, 33.3f, 55.0f };
+    for (float level : levels) {
+        int32_t code = -1;
+        TEST_ASSERT_TRUE(t.codeForLevel(level, code));
+        TEST_ASSERT_TRUE(t.levelFromCode(code) >= level);
+        TEST_ASSERT_TRUE(code == 0 || t.levelFromCode(code - 1) < level);
+    }
+}
+
+void test_table_code_for_level_clamps_below_zero_code() {
+    CalibrationTable t;
+    CalibrationPoint pts[2] = { { 600, 0.0f }, { 1600, 20.0f } };
+    TEST_ASSERT_TRUE(t.build(pts, 2));
+    int32_t code = -1;
+    TEST_ASSERT_TRUE(t.codeForLevel(-50.0f, code));
+    TEST_ASSERT_EQUAL(0, code);
+}
+
+void test_table_code_for_level_rejects_unusable_tables() {
+    CalibrationTable t;
+    int32_t code = 0;
+    TEST_ASSERT_FALSE(t.codeForLevel(10.0f, code)); // empty
+
+    CalibrationPoint falling[3] = { { 600, 0.0f }, { 1600, 20.0f }, { 2100, 15.0f } };
+    TEST_ASSERT_TRUE(t.build(falling, 3));
+    TEST_ASSERT_FALSE(t.codeForLevel(10.0f, code));
+
+    CalibrationPoint pts[2] = { { 600, 0.0f }, { 1600, 20.0f } };
+    TEST_ASSERT_TRUE(t.build(pts, 2));
+    TEST_ASSERT_FALSE(t.codeForLevel(1000.0f, code)); // past full scale
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_table_needs_two_distinct_points);
+    RUN_TEST(test_table_sorts_points_by_millivolts);
+
+    RUN_TEST(test_table_two_points_match_legacy_line);
+    RUN_TEST(test_table_hits_every_calibration_point_exactly);
+    RUN_TEST(test_table_interpolates_within_segment);
+    RUN_TEST(test_table_extrapolates_past_ends);
+    RUN_TEST(test_table_code_and_millivolt_lookups_agree);
+
+    RUN_TEST(test_table_code_for_level_is_lowest_code_at_or_above);
+    RUN_TEST(test_table_code_for_level_clamps_below_zero_code);
+    RUN_TEST(test_table_code_for_level_rejects_unusable_tables);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
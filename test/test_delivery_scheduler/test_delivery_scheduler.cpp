@@ -0,0 +1,175 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/DeliveryScheduler.h"
+
+static const uint32_t BACKOFF_MS[DeliveryScheduler::SEND_ATTEMPTS - 1] = {5000, 15000, 30000};
+
+static const uint8_t SMS = 0, DISCORD = 1, CUSTOM = 2;
+static const uint8_t ALL_LANES = (1u << SMS) | (1u << DISCORD) | (1u << CUSTOM);
+
+// ============================================================================
+// Per-channel independence
+// ============================================================================
+
+void test_delivery_healthy_lanes_drain_while_one_backs_off() {
+    DeliveryScheduler s(BACKOFF_MS);
+    s.admit(1, ALL_LANES, 0);
+    s.admit(2, ALL_LANES, 0);
+
+    DeliveryScheduler::Attempt a;
+    int sent = 0;
+    // SMS fails every time; Discord and Custom succeed
+    while (s.nextDue(0, a)) {
+        bool ok = a.channel != SMS;
+        DeliveryScheduler::Result r = s.complete(a, ok, 0);
+        if (r == DeliveryScheduler::SENT) sent++;
+    }
+    TEST_ASSERT_EQUAL(4, sent);                       // both messages on both healthy lanes
+    TEST_ASSERT_EQUAL(0, s.laneDepth(DISCORD));
+    TEST_ASSERT_EQUAL(2, s.laneDepth(SMS));           // still retrying message 1
+    TEST_ASSERT_EQUAL_UINT32(5000, s.msUntilNextDue(0));
+    TEST_ASSERT_TRUE(s.slotInUse(1));
+    TEST_ASSERT_TRUE(s.slotInUse(2));
+}
+
+void test_delivery_backoff_then_give_up() {
+    DeliveryScheduler s(BACKOFF_MS);
+    s.admit(1, 1u << SMS, 0);
+
+    DeliveryScheduler::Attempt a;
+    uint32_t now = 0;
+    const uint32_t expectDue[] = {0, 5000, 20000, 50000};
+    for (uint8_t i = 0; i < DeliveryScheduler::SEND_ATTEMPTS; i++) {
+        now = expectDue[i];
+        if (i > 0) TEST_ASSERT_FALSE(s.nextDue(now - 1, a));
+        TEST_ASSERT_TRUE(s.nextDue(now, a));
+        TEST_ASSERT_EQUAL(i + 1, a.attempt);
+        DeliveryScheduler::Result r = s.complete(a, false, now);
+        TEST_ASSERT_EQUAL(i + 1 < DeliveryScheduler::SEND_ATTEMPTS ? DeliveryScheduler::RETRY
+                                                                   : DeliveryScheduler::GAVE_UP, r);
+    }
+    TEST_ASSERT_FALSE(s.slotInUse(1));
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, s.msUntilNextDue(now));
+}
+
+void test_delivery_lane_keeps_message_order() {
+    DeliveryScheduler s(BACKOFF_MS);
+    s.admit(1, 1u << DISCORD, 0);
+    s.admit(2, 1u << DISCORD, 0);
+
+    DeliveryScheduler::Attempt a;
+    TEST_ASSERT_TRUE(s.nextDue(0, a));
+    TEST_ASSERT_EQUAL(1, a.slot);
+    s.complete(a, false, 0);
+    TEST_ASSERT_FALSE(s.nextDue(100, a));             // message 2 waits behind 1 on this lane
+    TEST_ASSERT_TRUE(s.nextDue(5000, a));
+    TEST_ASSERT_EQUAL(1, a.slot);
+    s.complete(a, true, 5000);
+    TEST_ASSERT_TRUE(s.nextDue(5000, a));
+    TEST_ASSERT_EQUAL(2, a.slot);
+}
+
+// ============================================================================
+// Emergency snapshots
+// ============================================================================
+
+void test_delivery_emergency_jumps_a_backing_off_lane() {
+    DeliveryScheduler s(BACKOFF_MS);
+    s.admit(1, 1u << SMS, 0);
+    DeliveryScheduler::Attempt a;
+    s.nextDue(0, a);
+    s.complete(a, false, 0);                          // message 1 sleeping until 5000
+
+    s.admitEmergency(1u << SMS, 100);
+    TEST_ASSERT_EQUAL_UINT32(0, s.msUntilNextDue(100));
+    TEST_ASSERT_TRUE(s.nextDue(100, a));
+    TEST_ASSERT_EQUAL(DeliveryScheduler::EMERGENCY_SLOT, a.slot);
+    s.complete(a, true, 100);
+
+    TEST_ASSERT_FALSE(s.nextDue(100, a));             // message 1 keeps its own backoff
+    TEST_ASSERT_TRUE(s.nextDue(5000, a));
+    TEST_ASSERT_EQUAL(1, a.slot);
+    TEST_ASSERT_EQUAL(2, a.attempt);
+}
+
+void test_delivery_emergency_served_first_across_lanes() {
+    DeliveryScheduler s(BACKOFF_MS);
+    s.admit(1, 1u << DISCORD, 0);                     // overdue by 50 ms at t=50
+    s.admitEmergency(1u << SMS, 50);
+
+    DeliveryScheduler::Attempt a;
+    TEST_ASSERT_TRUE(s.nextDue(50, a));
+    TEST_ASSERT_EQUAL(SMS, a.channel);
+    TEST_ASSERT_EQUAL(DeliveryScheduler::EMERGENCY_SLOT, a.slot);
+}
+
+void test_delivery_newer_emergency_replaces_pending_retry() {
+    DeliveryScheduler s(BACKOFF_MS);
+    s.admitEmergency(1u << SMS, 0);
+    DeliveryScheduler::Attempt a;
+    s.nextDue(0, a);
+    s.complete(a, false, 0);                          // snapshot 1 backing off
+
+    s.admitEmergency(1u << SMS, 1000);                // snapshot 2: same slot, fresh budget
+    TEST_ASSERT_EQUAL(1, s.laneDepth(SMS));
+    TEST_ASSERT_TRUE(s.nextDue(1000, a));
+    TEST_ASSERT_EQUAL(1, a.attempt);
+}
+
+// ============================================================================
+// Slots
+// ============================================================================
+
+void test_delivery_slots_exhaust_and_free() {
+    DeliveryScheduler s(BACKOFF_MS);
+    for (uint8_t i = 1; i < DeliveryScheduler::MAX_SLOTS; i++) {
+        int8_t slot = s.findFreeSlot();
+        TEST_ASSERT_EQUAL(i, slot);
+        s.admit((uint8_t)slot, 1u << CUSTOM, 0);
+    }
+    TEST_ASSERT_EQUAL(-1, s.findFreeSlot());          // emergency slot is never handed out
+    TEST_ASSERT_FALSE(s.slotAvailable());
+
+    DeliveryScheduler::Attempt a;
+    s.nextDue(0, a);
+    s.complete(a, true, 0);
+    TEST_ASSERT_EQUAL(1, s.findFreeSlot());
+}
+
+void test_delivery_deadlines_survive_millis_wraparound() {
+    DeliveryScheduler s(BACKOFF_MS);
+    uint32_t t = 0xFFFFFFFFu - 1000;
+    s.admit(1, 1u << SMS, t);
+    DeliveryScheduler::Attempt a;
+    s.nextDue(t, a);
+    s.complete(a, false, t);
+    TEST_ASSERT_EQUAL_UINT32(5000, s.msUntilNextDue(t));
+    TEST_ASSERT_FALSE(s.nextDue(t + 4999, a));
+    TEST_ASSERT_TRUE(s.nextDue(t + 5000, a));
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_delivery_healthy_lanes_drain_while_one_backs_off);
+    RUN_TEST(test_delivery_backoff_then_give_up);
+    RUN_TEST(test_delivery_lane_keeps_message_order);
+
+    RUN_TEST(test_delivery_emergency_jumps_a_backing_off_lane);
+    RUN_TEST(test_delivery_emergency_served_first_across_lanes);
+    RUN_TEST(test_delivery_newer_emergency_replaces_pending_retry);
+
+    RUN_TEST(test_delivery_slots_exhaust_and_free);
+    RUN_TEST(test_delivery_deadlines_survive_millis_wraparound);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
@@ -0,0 +1,254 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+#include <string.h>
+#include <vector>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/DeltaPatch.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+// Fake flash: the base image, the written target, and what checkBase saw
+struct Harness {
+    Bytes    base;
+    Bytes    target;
+    uint32_t seenBaseSize = 0;
+    bool     acceptBase = true;
+    bool     failWrite = false;
+    int      writes = 0;
+};
+
+static bool checkBase(void* ctx, uint32_t baseSize, const uint8_t*, uint32_t) {
+    Harness* h = static_cast<Harness*>(ctx);
+    h->seenBaseSize = baseSize;
+    return h->acceptBase;
+}
+static bool readBase(void* ctx, uint32_t offset, uint8_t* buf, size_t len) {
+    Harness* h = static_cast<Harness*>(ctx);
+    if (offset + len > h->base.size()) return false;
+    memcpy(buf, h->base.data() + offset, len);
+    return true;
+}
+static bool writeTarget(void* ctx, const uint8_t* data, size_t len) {
+    Harness* h = static_cast<Harness*>(ctx);
+    if (h->failWrite) return false;
+    h->target.insert(h->target.end(), data, data + len);
+    h->writes++;
+    return true;
+}
+
+// Minimal encoder, the same format scripts/make_delta.py writes
+struct Patch {
+    Bytes    bytes;
+    uint32_t cursor = 0;
+
+    Patch(uint32_t baseSize, uint32_t targetSize) {
+        const char magic[] = "BRD1";
+        bytes.insert(bytes.end(), magic, magic + 4);
+        u32(baseSize);
+        bytes.insert(bytes.end(), 32, 0xAB);
+        u32(targetSize);
+    }
+    void u32(uint32_t v) { for (int i = 0; i < 4; i++) bytes.push_back((uint8_t)(v >> (8 * i))); }
+    void varint(uint32_t v) {
+        do {
+            uint8_t b = v & 0x7f;
+            v >>= 7;
+            bytes.push_back(v ? (b | 0x80) : b);
+        } while (v);
+    }
+    void src(uint32_t at, uint32_t len) {
+        int64_t d = (int64_t)at - cursor;
+        varint(d >= 0 ? (uint32_t)(d << 1) : (uint32_t)((-d << 1) - 1));
+        cursor = at + len;
+    }
+    Patch& copy(uint32_t at, uint32_t len) {
+        bytes.push_back(DeltaApplier::OP_COPY);
+        varint(len);
+        src(at, len);
+        return *this;
+    }
+    Patch& add(uint32_t at, const Bytes& diff) {
+        bytes.push_back(DeltaApplier::OP_ADD);
+        varint(diff.size());
+        src(at, diff.size());
+        bytes.insert(bytes.end(), diff.begin(), diff.end());
+        return *this;
+    }
+    Patch& insert(const Bytes& lit) {
+        bytes.push_back(DeltaApplier::OP_INSERT);
+        varint(lit.size());
+        bytes.insert(bytes.end(), lit.begin(), lit.end());
+        return *this;
+    }
+    Patch& end() {
+        bytes.push_back(DeltaApplier::OP_END);
+        return *this;
+    }
+};
+
+static DeltaIo ioFor(Harness& h) {
+    DeltaIo io = { &h, checkBase, readBase, writeTarget };
+    return io;
+}
+
+static Bytes makeBase(size_t n) {
+    Bytes b(n);
+    for (size_t i = 0; i < n; i++) b[i] = (uint8_t)(i * 31 + (i >> 8));
+    return b;
+}
+
+// ============================================================================
+// Applying
+// ============================================================================
+
+void test_delta_copy_add_insert_rebuild_target() {
+    Harness h;
+    h.base = makeBase(2000);
+
+    // Expected target: base[1000..1300) relocated (+1 on every 16th byte),
+    // three literal bytes, then base[0..700) unchanged
+    Bytes expected;
+    Bytes diff(300, 0);
+    for (size_t i = 0; i < 300; i++) {
+        if (i % 16 == 0) diff[i] = 1;
+        expected.push_back((uint8_t)(h.base[1000 + i] + diff[i]));
+    }
+    Bytes lit = { 0xDE, 0xAD, 0x01 };
+    expected.insert(expected.end(), lit.begin(), lit.end());
+    expected.insert(expected.end(), h.base.begin(), h.base.begin() + 700);
+
+    Patch p(h.base.size(), expected.size());
+    p.add(1000, diff).insert(lit).copy(0, 700).end();
+
+    DeltaApplier a(ioFor(h));
+    TEST_ASSERT_EQUAL_INT(DeltaApplier::DONE, a.feed(p.bytes.data(), p.bytes.size()));
+    TEST_ASSERT_EQUAL_INT(DeltaApplier::DONE, a.finish());
+    TEST_ASSERT_EQUAL_UINT32(2000, h.seenBaseSize);
+    TEST_ASSERT_EQUAL_size_t(expected.size(), h.target.size());
+    TEST_ASSERT_EQUAL_MEMORY(expected.data(), h.target.data(), expected.size());
+    TEST_ASSERT_EQUAL_UINT32(expected.size(), a.written());
+}
+
+void test_delta_byte_at_a_time_matches_one_shot() {
+    Harness one, bytewise;
+    one.base = bytewise.base = makeBase(4096);
+    Bytes diff(1000, 0);
+    diff[10] = 7;
+    diff[999] = 0xFF;
+    Patch p(4096, 3000 + 1000 + 2);
+    p.copy(1096, 3000).add(0, diff).insert(Bytes{ 1, 2 }).end();
+
+    DeltaApplier a(ioFor(one));
+    a.feed(p.bytes.data(), p.bytes.size());
+    DeltaApplier b(ioFor(bytewise));
+    for (size_t i = 0; i < p.bytes.size(); i++) b.feed(&p.bytes[i], 1);
+
+    TEST_ASSERT_EQUAL_INT(DeltaApplier::DONE, a.finish());
+    TEST_ASSERT_EQUAL_INT(DeltaApplier::DONE, b.finish());
+    TEST_ASSERT_EQUAL_size_t(4002, bytewise.target.size());
+    TEST_ASSERT_EQUAL_MEMORY(one.target.data(), bytewise.target.data(), 4002);
+    // Output is batched into CHUNK-sized writes, not one per op byte
+    TEST_ASSERT_TRUE(bytewise.writes <= (int)(4002 / DeltaApplier::CHUNK) + 2);
+}
+
+// ============================================================================
+// Rejects
+// ============================================================================
+
+void test_delta_rejects_wrong_magic_and_base() {
+    Harness h;
+    h.base = makeBase(100);
+    Patch p(100, 10);
+    p.copy(0, 10).end();
+
+    Bytes bad = p.bytes;
+    bad[0] = 'X';
+    DeltaApplier a(ioFor(h));
+    TEST_ASSERT_EQUAL_INT(DeltaApplier::ERR_MAGIC, a.feed(bad.data(), bad.size()));
+
+    // checkBase() says no: nothing is written
+    h.acceptBase = false;
+    DeltaApplier b(ioFor(h));
+    TEST_ASSERT_EQUAL_INT(DeltaApplier::ERR_BASE, b.feed(p.bytes.data(), p.bytes.size()));
+    TEST_ASSERT_EQUAL_size_t(0, h.target.size());
+
+    // And once failed it stays failed
+    TEST_ASSERT_EQUAL_INT(DeltaApplier::ERR_BASE, b.feed(p.bytes.data(), 1));
+}
+
+void test_delta_rejects_out_of_range_ops() {
+    Harness h;
+    h.base = makeBase(100);
+
+    // Reads past the base
+    Patch past(100, 50);
+    past.copy(80, 50).end();
+    DeltaApplier a(ioFor(h));
+    TEST_ASSERT_EQUAL_INT(DeltaApplier::ERR_RANGE, a.feed(past.bytes.data(), past.bytes.size()));
+
+    // Writes past targetSize
+    Patch over(100, 4);
+    over.insert(Bytes{ 1, 2, 3, 4, 5 }).end();
+    DeltaApplier b(ioFor(h));
+    TEST_ASSERT_EQUAL_INT(DeltaApplier::ERR_RANGE, b.feed(over.bytes.data(), over.bytes.size()));
+
+    // Unknown opcode
+    Patch op(100, 4);
+    op.bytes.push_back(9);
+    DeltaApplier c(ioFor(h));
+    TEST_ASSERT_EQUAL_INT(DeltaApplier::ERR_OP, c.feed(op.bytes.data(), op.bytes.size()));
+}
+
+void test_delta_rejects_truncated_short_and_trailing() {
+    Harness h;
+    h.base = makeBase(100);
+
+    // Stream ends before END
+    Patch cut(100, 10);
+    cut.copy(0, 10);
+    DeltaApplier a(ioFor(h));
+    TEST_ASSERT_EQUAL_INT(DeltaApplier::OK, a.feed(cut.bytes.data(), cut.bytes.size()));
+    TEST_ASSERT_EQUAL_INT(DeltaApplier::ERR_TRAILING, a.finish());
+
+    // END before targetSize bytes were produced
+    Patch shortp(100, 20);
+    shortp.copy(0, 10).end();
+    DeltaApplier b(ioFor(h));
+    TEST_ASSERT_EQUAL_INT(DeltaApplier::ERR_TRAILING, b.feed(shortp.bytes.data(), shortp.bytes.size()));
+
+    // Bytes after END
+    Patch extra(100, 10);
+    extra.copy(0, 10).end().bytes.push_back(0);
+    DeltaApplier c(ioFor(h));
+    TEST_ASSERT_EQUAL_INT(DeltaApplier::ERR_TRAILING, c.feed(extra.bytes.data(), extra.bytes.size()));
+
+    // A failing flash write surfaces as ERR_WRITE
+    Harness w;
+    w.base = makeBase(100);
+    w.failWrite = true;
+    Patch ok(100, 10);
+    ok.copy(0, 10).end();
+    DeltaApplier d(ioFor(w));
+    TEST_ASSERT_EQUAL_INT(DeltaApplier::ERR_WRITE, d.feed(ok.bytes.data(), ok.bytes.size()));
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_delta_copy_add_insert_rebuild_target);
+    RUN_TEST(test_delta_byte_at_a_time_matches_one_shot);
+
+    RUN_TEST(test_delta_rejects_wrong_magic_and_base);
+    RUN_TEST(test_delta_rejects_out_of_range_ops);
+    RUN_TEST(test_delta_rejects_truncated_short_and_trailing);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
@@ -0,0 +1,152 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+#include <stdio.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/DnsCache.h"
+
+static const uint32_t TTL = 300000;
+
+// ============================================================================
+// Lookup freshness
+// ============================================================================
+
+void test_miss_until_stored() {
+    DnsCache cache;
+    uint32_t addr = 0;
+    TEST_ASSERT_EQUAL(DnsCache::MISS, cache.lookup("discord.com", 0, addr));
+    TEST_ASSERT_TRUE(cache.store("discord.com", 0x0A0B0C0D, 0, TTL));
+    TEST_ASSERT_EQUAL(DnsCache::FRESH, cache.lookup("discord.com", 1000, addr));
+    TEST_ASSERT_EQUAL_HEX32(0x0A0B0C0D, addr);
+}
+
+void test_fresh_then_stale_then_miss() {
+    DnsCache cache;
+    uint32_t addr = 0;
+    cache.store("api.twilio.com", 0x01020304, 5000, TTL);
+    TEST_ASSERT_EQUAL(DnsCache::FRESH, cache.lookup("api.twilio.com", 5000 + TTL - 1, addr));
+    TEST_ASSERT_EQUAL(DnsCache::STALE, cache.lookup("api.twilio.com", 5000 + TTL, addr));
+    TEST_ASSERT_EQUAL_HEX32(0x01020304, addr);
+    TEST_ASSERT_EQUAL(DnsCache::STALE,
+                      cache.lookup("api.twilio.com", 5000 + DnsCache::STALE_MAX_MS - 1, addr));
+    TEST_ASSERT_EQUAL(DnsCache::MISS,
+                      cache.lookup("api.twilio.com", 5000 + DnsCache::STALE_MAX_MS, addr));
+}
+
+void test_freshness_across_millis_wraparound() {
+    DnsCache cache;
+    uint32_t addr = 0;
+    uint32_t t = 0xFFFFFFFFu - 1000;
+    cache.store("a.io", 0x11111111, t, TTL);
+    TEST_ASSERT_EQUAL(DnsCache::FRESH, cache.lookup("a.io", t + 60000, addr));
+    TEST_ASSERT_EQUAL(DnsCache::STALE, cache.lookup("a.io", t + TTL, addr));
+}
+
+void test_store_rejects_overlong_host() {
+    DnsCache cache;
+    char host[DnsCache::HOST_MAX + 1];
+    memset(host, 'a', DnsCache::HOST_MAX);
+    host[DnsCache::HOST_MAX] = '\0';
+    TEST_ASSERT_FALSE(cache.store(host, 1, 0, TTL));
+    TEST_ASSERT_FALSE(cache.store("", 1, 0, TTL));
+    TEST_ASSERT_EQUAL(0, cache.resolvedCount());
+}
+
+// ============================================================================
+// Watched-host refresh
+// ============================================================================
+
+void test_watched_host_refreshes_before_expiry() {
+    DnsCache cache;
+    TEST_ASSERT_TRUE(cache.watch("broker.example.com", 0));
+    int8_t i = cache.nextRefresh(0);
+    TEST_ASSERT_TRUE(i >= 0);
+    TEST_ASSERT_EQUAL_STRING("broker.example.com", cache.entry(i).host);
+    cache.store("broker.example.com", 0x0A000001, 0, TTL);
+
+    TEST_ASSERT_EQUAL(-1, cache.nextRefresh(TTL - DnsCache::REFRESH_LEAD_MS - 1));
+    TEST_ASSERT_EQUAL(i, cache.nextRefresh(TTL - DnsCache::REFRESH_LEAD_MS));
+}
+
+void test_failing_host_retried_after_retry_interval() {
+    DnsCache cache;
+    cache.watch("down.example.com", 0);
+    TEST_ASSERT_TRUE(cache.nextRefresh(0) >= 0);
+    // Lookup failed: nothing stored
+    TEST_ASSERT_EQUAL(-1, cache.nextRefresh(DnsCache::RETRY_MS - 1));
+    TEST_ASSERT_TRUE(cache.nextRefresh(DnsCache::RETRY_MS) >= 0);
+}
+
+void test_unwatched_hosts_never_refreshed() {
+    DnsCache cache;
+    uint32_t addr;
+    cache.store("once.example.com", 1, 0, TTL);
+    TEST_ASSERT_EQUAL(-1, cache.nextRefresh(TTL * 2));
+
+    // A host dropped from the config stops being refreshed but stays cached
+    cache.watch("old.example.com", 0);
+    cache.store("old.example.com", 2, 0, TTL);
+    cache.unwatchAll();
+    TEST_ASSERT_EQUAL(-1, cache.nextRefresh(TTL));
+    TEST_ASSERT_EQUAL(DnsCache::STALE, cache.lookup("old.example.com", TTL, addr));
+}
+
+// ============================================================================
+// Eviction
+// ============================================================================
+
+void test_eviction_prefers_unwatched_lru() {
+    DnsCache cache;
+    char host[16];
+    uint32_t addr;
+    cache.watch("watched.io", 0);
+    cache.store("watched.io", 1, 0, TTL);
+    for (uint8_t i = 1; i < DnsCache::SIZE; i++) {
+        snprintf(host, sizeof(host), "h%u.io", i);
+        cache.store(host, 100 + i, 1000 * i, TTL);
+    }
+    // Touch h1 so h2 becomes the least recently used unwatched entry
+    cache.lookup("h1.io", 20000, addr);
+    cache.store("new.io", 7, 21000, TTL);
+
+    TEST_ASSERT_EQUAL(DnsCache::FRESH, cache.lookup("watched.io", 21000, addr));
+    TEST_ASSERT_EQUAL(DnsCache::FRESH, cache.lookup("h1.io", 21000, addr));
+    TEST_ASSERT_EQUAL(DnsCache::MISS, cache.lookup("h2.io", 21000, addr));
+    TEST_ASSERT_EQUAL(DnsCache::FRESH, cache.lookup("new.io", 21000, addr));
+    TEST_ASSERT_EQUAL_UINT32(7, addr);
+}
+
+void test_store_updates_existing_entry() {
+    DnsCache cache;
+    uint32_t addr;
+    cache.store("a.io", 1, 0, TTL);
+    cache.store("a.io", 2, TTL + 5, TTL);
+    TEST_ASSERT_EQUAL(1, cache.resolvedCount());
+    TEST_ASSERT_EQUAL(DnsCache::FRESH, cache.lookup("a.io", TTL + 10, addr));
+    TEST_ASSERT_EQUAL_UINT32(2, addr);
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_miss_until_stored);
+    RUN_TEST(test_fresh_then_stale_then_miss);
+    RUN_TEST(test_freshness_across_millis_wraparound);
+    RUN_TEST(test_store_rejects_overlong_host);
+
+    RUN_TEST(test_watched_host_refreshes_before_expiry);
+    RUN_TEST(test_failing_host_retried_after_retry_interval);
+    RUN_TEST(test_unwatched_hosts_never_refreshed);
+
+    RUN_TEST(test_eviction_prefers_unwatched_lru);
+    RUN_TEST(test_store_updates_existing_entry);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
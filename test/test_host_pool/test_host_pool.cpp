@@ -0,0 +1,179 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/HostPool.h"
+
+// ============================================================================
+// URL parsing
+// ============================================================================
+
+void test_parse_https_default_port() {
+    char host[HostPool::HOST_MAX];
+    uint16_t port = 0;
+    bool secure = false;
+    TEST_ASSERT_TRUE(parseUrlHost("https://api.twilio.com/2010-04-01/Accounts/AC1/Messages.json",
+                                  host, sizeof(host), port, secure));
+    TEST_ASSERT_EQUAL_STRING("api.twilio.com", host);
+    TEST_ASSERT_EQUAL_UINT16(443, port);
+    TEST_ASSERT_TRUE(secure);
+}
+
+void test_parse_http_explicit_port_and_query() {
+    char host[HostPool::HOST_MAX];
+    uint16_t port = 0;
+    bool secure = true;
+    TEST_ASSERT_TRUE(parseUrlHost("http://192.168.1.20:8080?x=1", host, sizeof(host), port, secure));
+    TEST_ASSERT_EQUAL_STRING("192.168.1.20", host);
+    TEST_ASSERT_EQUAL_UINT16(8080, port);
+    TEST_ASSERT_FALSE(secure);
+}
+
+void test_parse_rejects_bad_urls() {
+    char host[8];
+    uint16_t port;
+    bool secure;
+    TEST_ASSERT_FALSE(parseUrlHost("ftp://example.com/", host, sizeof(host), port, secure));
+    TEST_ASSERT_FALSE(parseUrlHost("https:///path", host, sizeof(host), port, secure));
+    TEST_ASSERT_FALSE(parseUrlHost("https://example.com/", host, sizeof(host), port, secure)); // too long
+    TEST_ASSERT_FALSE(parseUrlHost("https://a.io:99999/", host, sizeof(host), port, secure));
+    TEST_ASSERT_FALSE(parseUrlHost("https://a.io:/", host, sizeof(host), port, secure));
+}
+
+// ============================================================================
+// Slot claiming
+// ============================================================================
+
+void test_pool_reuses_slot_for_same_host() {
+    HostPool pool;
+    bool evict;
+    uint8_t a = pool.claim("discord.com", 443, true, 0, evict);
+    pool.markUsed(a, true, 0);
+    uint8_t b = pool.claim("discord.com", 443, true, 1000, evict);
+    TEST_ASSERT_EQUAL(a, b);
+    TEST_ASSERT_FALSE(evict);
+    TEST_ASSERT_TRUE(pool.slot(b).open);
+}
+
+void test_pool_keys_on_port_and_scheme() {
+    HostPool pool;
+    bool evict;
+    uint8_t a = pool.claim("example.com", 443, true, 0, evict);
+    uint8_t b = pool.claim("example.com", 80, false, 0, evict);
+    TEST_ASSERT_NOT_EQUAL(a, b);
+}
+
+void test_pool_evicts_least_recently_used() {
+    HostPool pool;
+    bool evict;
+    const char* hosts[HostPool::SIZE] = { "a.io", "b.io", "c.io" };
+    for (uint8_t i = 0; i < HostPool::SIZE; i++) {
+        uint8_t s = pool.claim(hosts[i], 443, true, i * 1000, evict);
+        pool.markUsed(s, true, i * 1000);
+    }
+    uint8_t again = pool.claim("a.io", 443, true, 5000, evict);
+    pool.markUsed(again, true, 5000);             // b.io is now the oldest
+
+    uint8_t d = pool.claim("d.io", 443, true, 6000, evict);
+    TEST_ASSERT_TRUE(evict);
+    TEST_ASSERT_EQUAL_STRING("d.io", pool.slot(d).host);
+    bool found = false;
+    for (uint8_t i = 0; i < HostPool::SIZE; i++) {
+        if (strcmp(pool.slot(i).host, "b.io") == 0) found = true;
+    }
+    TEST_ASSERT_FALSE(found);
+}
+
+void test_pool_prefers_closed_slot_over_eviction() {
+    HostPool pool;
+    bool evict;
+    uint8_t a = pool.claim("a.io", 443, true, 0, evict);
+    pool.markUsed(a, true, 0);
+    uint8_t b = pool.claim("b.io", 443, true, 0, evict);
+    pool.markUsed(b, false, 0);                   // server refused keep-alive
+    uint8_t c = pool.claim("c.io", 443, true, 0, evict);
+    pool.markUsed(c, true, 0);
+    uint8_t d = pool.claim("d.io", 443, true, 100, evict);
+    TEST_ASSERT_EQUAL(b, d);
+    TEST_ASSERT_FALSE(evict);
+}
+
+// ============================================================================
+// Idle expiry
+// ============================================================================
+
+void test_pool_idle_expiry() {
+    HostPool pool;
+    bool evict;
+    uint8_t a = pool.claim("a.io", 443, true, 0, evict);
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, pool.msUntilExpiry(0));
+    pool.markUsed(a, true, 1000);
+    TEST_ASSERT_EQUAL_UINT32(HostPool::IDLE_MS - 500, pool.msUntilExpiry(1500));
+    TEST_ASSERT_EQUAL(-1, pool.nextExpired(1000 + HostPool::IDLE_MS - 1));
+    TEST_ASSERT_EQUAL(a, pool.nextExpired(1000 + HostPool::IDLE_MS));
+    pool.markClosed(a);
+    TEST_ASSERT_EQUAL(0, pool.openCount());
+}
+
+void test_pool_idle_expiry_across_millis_wraparound() {
+    HostPool pool;
+    bool evict;
+    uint32_t t = 0xFFFFFFFFu - 10000;
+    uint8_t a = pool.claim("a.io", 443, true, t, evict);
+    pool.markUsed(a, true, t);
+    TEST_ASSERT_EQUAL(-1, pool.nextExpired(t + 30000));
+    TEST_ASSERT_EQUAL(a, pool.nextExpired(t + HostPool::IDLE_MS));
+}
+
+// ============================================================================
+// TLS cap
+// ============================================================================
+
+void test_pool_caps_parked_tls_connections() {
+    HostPool pool;
+    bool evict;
+    uint8_t a = pool.claim("a.io", 443, true, 0, evict);
+    TEST_ASSERT_EQUAL(-1, pool.tlsToClose(a, 0));
+    pool.markUsed(a, true, 0);
+    uint8_t p = pool.claim("plain.io", 80, false, 0, evict);
+    pool.markUsed(p, true, 50);
+
+    // A new TLS host must close the parked TLS connection, not the plain one
+    uint8_t b = pool.claim("b.io", 443, true, 100, evict);
+    TEST_ASSERT_FALSE(evict);
+    TEST_ASSERT_EQUAL(a, pool.tlsToClose(b, 100));
+    pool.markClosed(a);
+    TEST_ASSERT_EQUAL(-1, pool.tlsToClose(b, 100));
+    pool.markUsed(b, true, 100);
+    TEST_ASSERT_EQUAL(2, pool.openCount());
+
+    // Reusing the parked TLS connection closes nothing
+    TEST_ASSERT_EQUAL(-1, pool.tlsToClose(b, 200));
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_parse_https_default_port);
+    RUN_TEST(test_parse_http_explicit_port_and_query);
+    RUN_TEST(test_parse_rejects_bad_urls);
+
+    RUN_TEST(test_pool_reuses_slot_for_same_host);
+    RUN_TEST(test_pool_keys_on_port_and_scheme);
+    RUN_TEST(test_pool_evicts_least_recently_used);
+    RUN_TEST(test_pool_prefers_closed_slot_over_eviction);
+
+    RUN_TEST(test_pool_idle_expiry);
+    RUN_TEST(test_pool_idle_expiry_across_millis_wraparound);
+
+    RUN_TEST(test_pool_caps_parked_tls_connections);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
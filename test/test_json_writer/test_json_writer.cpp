@@ -0,0 +1,155 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+#include <string.h>
+#include <string>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/JsonWriter.h"
+
+// Capture sink: concatenates every chunk and counts the calls
+struct Capture {
+    std::string out;
+    int calls = 0;
+    int lastCalls = 0;
+    size_t largestChunk = 0;
+};
+
+static void captureSink(void* ctx, const char* data, size_t len, bool last) {
+    Capture* c = static_cast<Capture*>(ctx);
+    c->out.append(data, len);
+    c->calls++;
+    if (last) c->lastCalls++;
+    if (len > c->largestChunk) c->largestChunk = len;
+}
+
+// ============================================================================
+// Output shape
+// ============================================================================
+
+void test_writer_flat_object_and_escaping() {
+    Capture c;
+    JsonWriter<128> w(captureSink, &c);
+    w.beginObject()
+     .boolean("connected", true)
+     .str("ssid", "Dock \"B\"\\net")
+     .str("note", "line1\nline2\x01")
+     .str("missing", (const char*)nullptr)
+     .num("rssi", -67)
+     .num("uptime", (uint32_t)4000000000u);
+    w.send();
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"connected\":true,\"ssid\":\"Dock \\\"B\\\"\\\\net\","
+        "\"note\":\"line1\\nline2\\u0001\",\"missing\":null,"
+        "\"rssi\":-67,\"uptime\":4000000000}", c.out.c_str());
+}
+
+void test_writer_nested_objects_and_arrays() {
+    Capture c;
+    JsonWriter<128> w(captureSink, &c);
+    w.beginObject();
+    w.beginObject("wifi").boolean("connected", false).end();
+    w.beginArray("table");
+    w.beginArray().num(nullptr, 120).num(nullptr, 0.0f, 2).end();
+    w.beginArray().num(nullptr, 2400).num(nullptr, 55.5f, 2).end();
+    w.end();
+    w.beginArray("tags").str(nullptr, "setup").str(nullptr, "state").end();
+    w.raw("hist", "{\"n\":3}");
+    w.beginObject("empty").end();
+    // Left open on purpose: send() closes it
+    w.beginObject("logMask").str("mask", "all");
+    TEST_ASSERT_EQUAL_UINT8(2, w.depth());
+    w.send();
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"wifi\":{\"connected\":false},\"table\":[[120,0.00],[2400,55.50]],"
+        "\"tags\":[\"setup\",\"state\"],\"hist\":{\"n\":3},\"empty\":{},"
+        "\"logMask\":{\"mask\":\"all\"}}", c.out.c_str());
+    TEST_ASSERT_EQUAL_UINT8(0, w.depth());
+}
+
+void test_writer_float_matches_fixed_decimals() {
+    Capture c;
+    JsonWriter<64> w(captureSink, &c);
+    w.beginArray()
+     .num(nullptr, 12.345f, 1)
+     .num(nullptr, -0.5f, 2)
+     .num(nullptr, 100.0f, 0);
+    w.send();
+    TEST_ASSERT_EQUAL_STRING("[12.3,-0.50,100]", c.out.c_str());
+}
+
+// ============================================================================
+// Buffering
+// ============================================================================
+
+void test_writer_small_response_is_one_last_call() {
+    Capture c;
+    JsonWriter<64> w(captureSink, &c);
+    w.beginObject().str("error", "Sensor not available");
+    TEST_ASSERT_EQUAL_INT(0, c.calls);
+    w.send();
+    TEST_ASSERT_EQUAL_INT(1, c.calls);
+    TEST_ASSERT_EQUAL_INT(1, c.lastCalls);
+    TEST_ASSERT_EQUAL_size_t(c.out.size(), w.bytesWritten());
+
+    // Anything after send() is ignored, and send() only fires once
+    w.str("late", "x");
+    w.send();
+    TEST_ASSERT_EQUAL_INT(1, c.calls);
+    TEST_ASSERT_EQUAL_STRING("{\"error\":\"Sensor not available\"}", c.out.c_str());
+}
+
+void test_writer_large_response_streams_in_buffer_sized_chunks() {
+    Capture c;
+    JsonWriter<32> w(captureSink, &c);
+    std::string expected = "[";
+    w.beginArray();
+    for (int i = 0; i < 40; i++) {
+        char ssid[16];
+        snprintf(ssid, sizeof(ssid), "net-%02d", i);
+        w.str(nullptr, ssid);
+        if (i) expected += ",";
+        expected += "\"";
+        expected += ssid;
+        expected += "\"";
+    }
+    w.send();
+    expected += "]";
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), c.out.c_str());
+    TEST_ASSERT_TRUE(c.calls > 1);
+    TEST_ASSERT_EQUAL_INT(1, c.lastCalls);
+    TEST_ASSERT_EQUAL_size_t(32, c.largestChunk);
+    TEST_ASSERT_EQUAL_size_t(expected.size(), w.bytesWritten());
+}
+
+void test_writer_nesting_past_max_depth_writes_null() {
+    Capture c;
+    JsonWriter<128> w(captureSink, &c);
+    for (uint8_t i = 0; i < JsonWriter<128>::MAX_DEPTH; i++) w.beginArray();
+    TEST_ASSERT_FALSE(w.overflowed());
+    w.beginObject().num("dropped", 1).beginArray().end().end();
+    TEST_ASSERT_TRUE(w.overflowed());
+    w.num(nullptr, 7);
+    w.send();
+    TEST_ASSERT_EQUAL_STRING("[[[[[[[[null,7]]]]]]]]", c.out.c_str());
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_writer_flat_object_and_escaping);
+    RUN_TEST(test_writer_nested_objects_and_arrays);
+    RUN_TEST(test_writer_float_matches_fixed_decimals);
+
+    RUN_TEST(test_writer_small_response_is_one_last_call);
+    RUN_TEST(test_writer_large_response_streams_in_buffer_sized_chunks);
+    RUN_TEST(test_writer_nesting_past_max_depth_writes_null);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
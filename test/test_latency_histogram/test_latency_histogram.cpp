@@ -0,0 +1,49 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+#include <string.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/LatencyHistogram.h"
+
+// ============================================================================
+// Serialisation
+// ============================================================================
+
+void test_histogram_json_trims_empty_tail() {
+    LatencyHistogram h;
+    h.record(5);
+    h.record(40);
+    h.record(40);
+    char buf[96];
+    size_t n = h.formatJson(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING("{\"n\":3,\"p50\":40,\"p95\":40,\"max\":40,\"b\":[1,0,2]}", buf);
+    TEST_ASSERT_EQUAL_size_t(strlen(buf), n);
+
+    LatencyHistogram empty;
+    empty.formatJson(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING("{\"n\":0,\"p50\":0,\"p95\":0,\"max\":0,\"b\":[]}", buf);
+}
+
+void test_histogram_json_too_small_writes_empty() {
+    LatencyHistogram h;
+    h.record(5);
+    char buf[20];
+    TEST_ASSERT_EQUAL_size_t(0, h.formatJson(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("", buf);
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_histogram_json_trims_empty_tail);
+    RUN_TEST(test_histogram_json_too_small_writes_empty);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
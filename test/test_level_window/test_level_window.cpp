@@ -0,0 +1,277 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+#include <math.h>
+#include <stdlib.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/LevelWindow.h"
+
+namespace TestConstants {
+    constexpr float    TIER1_CM  = 30.0f;
+    constexpr uint32_t SAMPLE_MS = 1000;    // ~1 Hz filtered readings per compartment
+}
+
+// Test times are written in ms; LevelWindow takes the 64-bit µs tick
+static int64_t ms(int64_t t) { return t * 1000; }
+
+void setUp() {}
+void tearDown() {}
+
+// Exact p-quantile (nearest rank) of a copy, for checking the P² estimate
+static int compareFloat(const void* a, const void* b) {
+    float x = *(const float*)a, y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+static float exactQuantile(const float* values, size_t n, float p) {
+    float* sorted = (float*)malloc(n * sizeof(float));
+    for (size_t i = 0; i < n; i++) sorted[i] = values[i];
+    qsort(sorted, n, sizeof(float), compareFloat);
+    size_t rank = (size_t)ceilf(p * n);
+    float q = sorted[rank > 0 ? rank - 1 : 0];
+    free(sorted);
+    return q;
+}
+
+// ============================================================================
+// Moments
+// ============================================================================
+
+void test_window_empty_is_nan() {
+    LevelWindow w;
+    LevelWindow::Summary s = w.summary(ms(60000));
+    TEST_ASSERT_EQUAL_UINT32(0, s.samples);
+    TEST_ASSERT_EQUAL_UINT32(0, s.invalid);
+    TEST_ASSERT_TRUE(isnan(s.min_cm));
+    TEST_ASSERT_TRUE(isnan(s.max_cm));
+    TEST_ASSERT_TRUE(isnan(s.mean_cm));
+    TEST_ASSERT_TRUE(isnan(s.stddev_cm));
+    TEST_ASSERT_TRUE(isnan(s.p95_cm));
+    TEST_ASSERT_EQUAL_UINT32(0, s.aboveTier1Ms);
+    TEST_ASSERT_EQUAL_UINT32(60000, s.spanMs);
+}
+
+void test_window_min_max_mean_stddev() {
+    LevelWindow w;
+    const float levels[] = { 2, 4, 4, 4, 5, 5, 7, 9 };
+    for (uint32_t i = 0; i < 8; i++) {
+        w.add(ms(i * TestConstants::SAMPLE_MS), true, levels[i], TestConstants::TIER1_CM);
+    }
+    LevelWindow::Summary s = w.summary(ms(8000));
+    TEST_ASSERT_EQUAL_UINT32(8, s.samples);
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, s.min_cm);
+    TEST_ASSERT_EQUAL_FLOAT(9.0f, s.max_cm);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 5.0f, s.mean_cm);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 2.0f, s.stddev_cm);
+}
+
+void test_window_steady_level_has_zero_stddev() {
+    // A large level repeated many times: Welford doesn't cancel to a
+    // negative variance the way sum-of-squares does
+    LevelWindow w;
+    for (uint32_t i = 0; i < 3600; i++) {
+        w.add(ms(i * TestConstants::SAMPLE_MS), true, 123.45f, 200.0f);
+    }
+    LevelWindow::Summary s = w.summary(ms(3600000));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 123.45f, s.mean_cm);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.0f, s.stddev_cm);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 123.45f, s.p95_cm);
+}
+
+void test_window_invalid_readings_counted_not_aggregated() {
+    LevelWindow w;
+    w.add(ms(0), true, 10.0f, TestConstants::TIER1_CM);
+    w.add(ms(1000), false, 99.0f, TestConstants::TIER1_CM);
+    w.add(ms(2000), true, NAN, TestConstants::TIER1_CM);
+    w.add(ms(3000), true, 12.0f, TestConstants::TIER1_CM);
+    LevelWindow::Summary s = w.summary(ms(4000));
+    TEST_ASSERT_EQUAL_UINT32(2, s.samples);
+    TEST_ASSERT_EQUAL_UINT32(2, s.invalid);
+    TEST_ASSERT_EQUAL_FLOAT(12.0f, s.max_cm);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 11.0f, s.mean_cm);
+}
+
+// ============================================================================
+// p95
+// ============================================================================
+
+void test_window_p95_is_max_for_few_samples() {
+    LevelWindow w;
+    const float levels[] = { 5, 1, 4, 2 };
+    for (uint32_t i = 0; i < 4; i++) {
+        w.add(ms(i), true, levels[i], TestConstants::TIER1_CM);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, w.summary(ms(4)).p95_cm);
+}
+
+void test_window_p95_tracks_shuffled_uniform() {
+    // 1..1000 in a fixed pseudo-random order
+    static float levels[1000];
+    for (int i = 0; i < 1000; i++) levels[i] = (float)(i + 1);
+    uint32_t lcg = 7;
+    for (int i = 999; i > 0; i--) {
+        lcg = lcg * 1103515245u + 12345u;
+        int j = (int)((lcg >> 16) % (uint32_t)(i + 1));
+        float t = levels[i]; levels[i] = levels[j]; levels[j] = t;
+    }
+    LevelWindow w;
+    for (uint32_t i = 0; i < 1000; i++) w.add(ms(i), true, levels[i], 2000.0f);
+    float exact = exactQuantile(levels, 1000, LevelWindow::P95);
+    TEST_ASSERT_FLOAT_WITHIN(10.0f, exact, w.summary(ms(1000)).p95_cm);
+}
+
+void test_window_surge_shows_in_max_and_p95() {
+    // A minute at 10 cm with noise, and a 6-second surge to 25 cm that is
+    // over before the publish samples the level
+    float levels[60];
+    uint32_t lcg = 42;
+    LevelWindow w;
+    for (uint32_t i = 0; i < 60; i++) {
+        lcg = lcg * 1103515245u + 12345u;
+        float noise = ((float)((lcg >> 16) % 201) / 1000.0f) - 0.1f;
+        levels[i] = (i >= 40 && i < 46 ? 25.0f : 10.0f) + noise;
+        w.add(ms(i * TestConstants::SAMPLE_MS), true, levels[i], TestConstants::TIER1_CM);
+    }
+    LevelWindow::Summary s = w.summary(ms(60000));
+    TEST_ASSERT_FLOAT_WITHIN(0.11f, 25.0f, s.max_cm);
+    TEST_ASSERT_FLOAT_WITHIN(0.11f, 10.0f, s.min_cm);
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, 11.5f, s.mean_cm);
+    // 10% of the minute was in the surge. With two separate levels P²
+    // interpolates between them, but p95 still sits well above the baseline
+    TEST_ASSERT_TRUE(s.p95_cm > 15.0f);
+    TEST_ASSERT_TRUE(s.p95_cm <= s.max_cm);
+}
+
+// ============================================================================
+// Time above Tier 1
+// ============================================================================
+
+void test_window_time_above_tier1_holds_until_next_reading() {
+    LevelWindow w;
+    w.add(ms(0), true, 20.0f, TestConstants::TIER1_CM);
+    w.add(ms(1000), true, 30.0f, TestConstants::TIER1_CM);     // at Tier 1 counts
+    w.add(ms(3000), true, 35.0f, TestConstants::TIER1_CM);
+    w.add(ms(4000), true, 25.0f, TestConstants::TIER1_CM);
+    TEST_ASSERT_EQUAL_UINT32(3000, w.summary(ms(10000)).aboveTier1Ms);
+}
+
+void test_window_time_above_tier1_counts_the_open_reading() {
+    LevelWindow w;
+    w.add(ms(0), true, 40.0f, TestConstants::TIER1_CM);
+    TEST_ASSERT_EQUAL_UINT32(2500, w.summary(ms(2500)).aboveTier1Ms);
+}
+
+void test_window_invalid_reading_stops_time_above() {
+    LevelWindow w;
+    w.add(ms(0), true, 40.0f, TestConstants::TIER1_CM);
+    w.add(ms(1000), false, 0.0f, TestConstants::TIER1_CM);
+    TEST_ASSERT_EQUAL_UINT32(1000, w.summary(ms(5000)).aboveTier1Ms);
+}
+
+void test_window_time_above_tier1_past_32bit_millis() {
+    // Uptime beyond where a 32-bit millis() wraps
+    const int64_t t0 = ms(0xFFFFFFFFLL - 1000);
+    LevelWindow w;
+    w.restart(t0);
+    w.add(t0, true, 40.0f, TestConstants::TIER1_CM);
+    w.add(t0 + ms(3000), true, 10.0f, TestConstants::TIER1_CM);
+    LevelWindow::Summary s = w.summary(t0 + ms(5000));
+    TEST_ASSERT_EQUAL_UINT32(3000, s.aboveTier1Ms);
+    TEST_ASSERT_EQUAL_UINT32(5000, s.spanMs);
+}
+
+void test_window_late_drained_batch_keeps_sample_ticks() {
+    // A loop stall: three readings sampled a second apart, drained together
+    LevelWindow w;
+    w.add(ms(0), true, 10.0f, TestConstants::TIER1_CM);
+    w.add(ms(1000), true, 35.0f, TestConstants::TIER1_CM);
+    w.add(ms(2000), true, 36.0f, TestConstants::TIER1_CM);
+    w.add(ms(3000), true, 12.0f, TestConstants::TIER1_CM);
+    TEST_ASSERT_EQUAL_UINT32(2000, w.summary(ms(5000)).aboveTier1Ms);
+}
+
+void test_window_reading_older_than_restart_adds_no_time() {
+    LevelWindow w;
+    w.add(ms(0), true, 40.0f, TestConstants::TIER1_CM);
+    w.restart(ms(10000));
+    // Sampled before the publish, drained after it
+    w.add(ms(9500), true, 41.0f, TestConstants::TIER1_CM);
+    LevelWindow::Summary s = w.summary(ms(12000));
+    TEST_ASSERT_EQUAL_UINT32(1, s.samples);
+    TEST_ASSERT_EQUAL_UINT32(2000, s.aboveTier1Ms);
+    TEST_ASSERT_EQUAL_UINT32(2000, s.spanMs);
+}
+
+// ============================================================================
+// Windows
+// ============================================================================
+
+void test_window_restart_clears_stats_and_carries_tier1_hold() {
+    LevelWindow w;
+    w.add(ms(0), true, 10.0f, TestConstants::TIER1_CM);
+    w.add(ms(50000), true, 40.0f, TestConstants::TIER1_CM);
+    w.add(ms(50500), false, 0.0f, TestConstants::TIER1_CM);
+    w.add(ms(51000), true, 45.0f, TestConstants::TIER1_CM);
+    LevelWindow::Summary first = w.summary(ms(60000));
+    TEST_ASSERT_EQUAL_UINT32(3, first.samples);
+    TEST_ASSERT_EQUAL_UINT32(1, first.invalid);
+    TEST_ASSERT_EQUAL_UINT32(500 + 9000, first.aboveTier1Ms);
+
+    w.restart(ms(60000));
+    LevelWindow::Summary empty = w.summary(ms(60000));
+    TEST_ASSERT_EQUAL_UINT32(0, empty.samples);
+    TEST_ASSERT_EQUAL_UINT32(0, empty.invalid);
+    TEST_ASSERT_EQUAL_UINT32(0, empty.aboveTier1Ms);
+    TEST_ASSERT_EQUAL_UINT32(0, empty.spanMs);
+
+    // Still above from the last reading of the previous window
+    w.add(ms(70000), true, 12.0f, TestConstants::TIER1_CM);
+    LevelWindow::Summary second = w.summary(ms(120000));
+    TEST_ASSERT_EQUAL_UINT32(10000, second.aboveTier1Ms);
+    TEST_ASSERT_EQUAL_UINT32(1, second.samples);
+    TEST_ASSERT_EQUAL_FLOAT(12.0f, second.max_cm);
+    TEST_ASSERT_EQUAL_FLOAT(12.0f, second.p95_cm);
+    TEST_ASSERT_EQUAL_UINT32(60000, second.spanMs);
+}
+
+void test_window_p95_restarts_with_the_window() {
+    LevelWindow w;
+    for (uint32_t i = 0; i < 100; i++) w.add(ms(i), true, 50.0f + (float)(i % 10), 200.0f);
+    w.restart(ms(100));
+    for (uint32_t i = 0; i < 100; i++) w.add(ms(100 + i), true, 5.0f, 200.0f);
+    LevelWindow::Summary s = w.summary(ms(200));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 5.0f, s.p95_cm);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 5.0f, s.max_cm);
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_window_empty_is_nan);
+    RUN_TEST(test_window_min_max_mean_stddev);
+    RUN_TEST(test_window_steady_level_has_zero_stddev);
+    RUN_TEST(test_window_invalid_readings_counted_not_aggregated);
+
+    RUN_TEST(test_window_p95_is_max_for_few_samples);
+    RUN_TEST(test_window_p95_tracks_shuffled_uniform);
+    RUN_TEST(test_window_surge_shows_in_max_and_p95);
+
+    RUN_TEST(test_window_time_above_tier1_holds_until_next_reading);
+    RUN_TEST(test_window_time_above_tier1_counts_the_open_reading);
+    RUN_TEST(test_window_invalid_reading_stops_time_above);
+    RUN_TEST(test_window_time_above_tier1_past_32bit_millis);
+    RUN_TEST(test_window_late_drained_batch_keeps_sample_ticks);
+    RUN_TEST(test_window_reading_older_than_restart_adds_no_time);
+
+    RUN_TEST(test_window_restart_clears_stats_and_carries_tier1_hold);
+    RUN_TEST(test_window_p95_restarts_with_the_window);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
@@ -0,0 +1,134 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/LogCodec.h"
+
+static uint8_t rec[160];
+static size_t  recLen;
+
+// Encode one call the way logMessage() does
+static void encodeCall(size_t cap, uint32_t ts, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    recLen = LogCodec::encode(rec, cap, ts, fmt, args);
+    va_end(args);
+}
+
+static const char* renderRec() {
+    static char line[256];
+    LogCodec::render(line, sizeof(line), rec, recLen);
+    return line;
+}
+
+// Encode + render must match vsnprintf of the same call
+static void checkSame(const char* fmt, ...) {
+    char expected[256];
+    va_list args;
+    va_start(args, fmt);
+    va_list copy;
+    va_copy(copy, args);
+    vsnprintf(expected, sizeof(expected), fmt, copy);
+    va_end(copy);
+    recLen = LogCodec::encode(rec, sizeof(rec), 0, fmt, args);
+    va_end(args);
+    TEST_ASSERT_EQUAL_STRING(expected, renderRec());
+}
+
+// ============================================================================
+// Rendering matches printf
+// ============================================================================
+
+void test_codec_matches_vsnprintf_for_formats_in_use() {
+    checkSame("[STATE] %s -> %s", "NORMAL", "ALERT");
+    checkSame("[MQTT] Logs sent=%u in %u publishes, dropped=%u", 12u, 3u, 0u);
+    checkSame("[SENSOR] level=%.2f cm, raw=%d mV", 42.125f, -17);
+    checkSame("[TIME] epoch=%lu uptime=%llu", 1760000000ul, 123456789012ull);
+    checkSame("[OTA] sha %02x%02x%02x", 0x0a, 0xff, 0x01);
+    checkSame("%-18s|%4d|%6lu|%.1f%%", "horn", 7, 99ul, 99.5);
+    checkSame("%.60s", "a body longer than sixty characters is cut by the precision here, not later");
+    checkSame("plain text, no conversions");
+    checkSame("%c %x %X %o %ld %p", 'A', 255u, 255u, 8u, -5l, (void*)0x1234);
+}
+
+void test_codec_star_width_and_precision() {
+    checkSame("[%*d] [%-*s] [%.*s]", 5, 42, 8, "ab", 3, "abcdef");
+
+    // "%.*s" over a payload that isn't NUL-terminated reads only len bytes
+    const char payload[4] = { 'n', 'e', 't', 'w' };
+    encodeCall(sizeof(rec), 0, "cmd \"%.*s\"", 3, payload);
+    TEST_ASSERT_EQUAL_STRING("cmd \"net\"", renderRec());
+}
+
+void test_codec_malformed_spec_rendered_literally() {
+    // A dangling '%' at the end, and an unknown conversion
+    encodeCall(sizeof(rec), 0, "50%");
+    TEST_ASSERT_EQUAL_STRING("50%", renderRec());
+    encodeCall(sizeof(rec), 0, "x=%d %y", 3);
+    TEST_ASSERT_EQUAL_STRING("x=3 %y", renderRec());
+}
+
+// ============================================================================
+// Capture semantics
+// ============================================================================
+
+void test_codec_copies_strings_at_call_time() {
+    char name[16];
+    strcpy(name, "Pump1");
+    encodeCall(sizeof(rec), 0, "[SENSOR] %s ok", name);
+    strcpy(name, "XXXXX");      // caller's buffer reused before the sink runs
+    TEST_ASSERT_EQUAL_STRING("[SENSOR] Pump1 ok", renderRec());
+
+    encodeCall(sizeof(rec), 0, "%s|%s", (const char*)nullptr, "");
+    char expected[32];
+    snprintf(expected, sizeof(expected), "%s|%s", "(null)", "");
+    TEST_ASSERT_EQUAL_STRING(expected, renderRec());
+}
+
+void test_codec_truncated_record_appends_ellipsis() {
+    char big[200];
+    memset(big, 'z', sizeof(big) - 1);
+    big[sizeof(big) - 1] = '\0';
+    encodeCall(64, 0, "n=%d s=%s after=%d", 1, big, 2);
+    TEST_ASSERT_TRUE(recLen <= 64);
+    const char* out = renderRec();
+    TEST_ASSERT_EQUAL_STRING_LEN("n=1 s=zzz", out, 9);
+    // The string is cut to what fits; text up to the first argument that
+    // didn't make it is kept, then "..."
+    TEST_ASSERT_EQUAL_STRING(" after=...", out + strlen(out) - 10);
+
+    // A header that doesn't fit encodes nothing
+    encodeCall(LogCodec::HEADER - 1, 0, "x");
+    TEST_ASSERT_EQUAL_size_t(0, recLen);
+}
+
+void test_codec_header_round_trip() {
+    static const char* const FMT = "[LOG] %u";
+    encodeCall(sizeof(rec), 0xFFFFFFF0u, FMT, 9u);
+    TEST_ASSERT_EQUAL_PTR(FMT, LogCodec::formatOf(rec));
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFF0u, LogCodec::timestampOf(rec));
+    TEST_ASSERT_EQUAL_size_t(LogCodec::HEADER + sizeof(unsigned), recLen);
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_codec_matches_vsnprintf_for_formats_in_use);
+    RUN_TEST(test_codec_star_width_and_precision);
+    RUN_TEST(test_codec_malformed_spec_rendered_literally);
+
+    RUN_TEST(test_codec_copies_strings_at_call_time);
+    RUN_TEST(test_codec_truncated_record_appends_ellipsis);
+    RUN_TEST(test_codec_header_round_trip);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
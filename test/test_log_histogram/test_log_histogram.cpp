@@ -0,0 +1,162 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+#include <string.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/LogHistogram.h"
+
+// The two instances in use: notification latency (ms) and loop() sections (us)
+typedef LogHistogram<16, 4> MsHistogram;
+typedef LogHistogram<20, 2> UsHistogram;
+
+void setUp() {}
+void tearDown() {}
+
+// ============================================================================
+// Bucketing
+// ============================================================================
+
+void test_log_histogram_ms_bucket_edges() {
+    TEST_ASSERT_EQUAL_UINT8(0, MsHistogram::bucketFor(0));
+    TEST_ASSERT_EQUAL_UINT8(0, MsHistogram::bucketFor(15));
+    TEST_ASSERT_EQUAL_UINT8(1, MsHistogram::bucketFor(16));
+    TEST_ASSERT_EQUAL_UINT8(1, MsHistogram::bucketFor(31));
+    TEST_ASSERT_EQUAL_UINT8(2, MsHistogram::bucketFor(32));
+    TEST_ASSERT_EQUAL_UINT8(9, MsHistogram::bucketFor(8191));
+    TEST_ASSERT_EQUAL_UINT8(14, MsHistogram::bucketFor((1u << 18) - 1));
+    TEST_ASSERT_EQUAL_UINT8(15, MsHistogram::bucketFor(1u << 18));
+    TEST_ASSERT_EQUAL_UINT8(15, MsHistogram::bucketFor(UINT32_MAX));
+}
+
+void test_log_histogram_us_bucket_edges() {
+    TEST_ASSERT_EQUAL_UINT8(0, UsHistogram::bucketFor(0));
+    TEST_ASSERT_EQUAL_UINT8(0, UsHistogram::bucketFor(3));
+    TEST_ASSERT_EQUAL_UINT8(1, UsHistogram::bucketFor(4));
+    TEST_ASSERT_EQUAL_UINT8(1, UsHistogram::bucketFor(7));
+    TEST_ASSERT_EQUAL_UINT8(2, UsHistogram::bucketFor(8));
+    TEST_ASSERT_EQUAL_UINT8(18, UsHistogram::bucketFor((1u << 20) - 1));
+    TEST_ASSERT_EQUAL_UINT8(19, UsHistogram::bucketFor(1u << 20));
+    TEST_ASSERT_EQUAL_UINT8(19, UsHistogram::bucketFor(UINT32_MAX));
+}
+
+template <typename H>
+static void checkUpperBounds() {
+    for (uint8_t i = 0; i < H::BUCKETS - 1; i++) {
+        uint32_t edge = H::upperBound(i);
+        TEST_ASSERT_EQUAL_UINT8(i, H::bucketFor(edge - 1));
+        TEST_ASSERT_EQUAL_UINT8(i + 1, H::bucketFor(edge));
+    }
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, H::upperBound(H::BUCKETS - 1));
+}
+
+void test_log_histogram_upper_bounds_match_buckets() {
+    checkUpperBounds<MsHistogram>();
+    checkUpperBounds<UsHistogram>();
+    // Widest the template allows: the last closed edge is 2^31
+    checkUpperBounds<LogHistogram<30, 3> >();
+}
+
+// ============================================================================
+// Statistics
+// ============================================================================
+
+void test_log_histogram_counts_min_mean_max() {
+    MsHistogram h;
+    TEST_ASSERT_EQUAL_UINT32(0, h.count());
+    TEST_ASSERT_EQUAL_UINT32(0, h.minValue());
+    TEST_ASSERT_EQUAL_UINT32(0, h.mean());
+    TEST_ASSERT_EQUAL_UINT32(0, h.percentile(50));
+
+    h.record(200);
+    h.record(100);
+    h.record(900);
+    TEST_ASSERT_EQUAL_UINT32(3, h.count());
+    TEST_ASSERT_EQUAL_UINT32(100, h.minValue());
+    TEST_ASSERT_EQUAL_UINT32(400, h.mean());
+    TEST_ASSERT_EQUAL_UINT32(900, h.maxValue());
+    TEST_ASSERT_EQUAL_UINT32(1, h.bucket(MsHistogram::bucketFor(100)));
+
+    h.reset();
+    TEST_ASSERT_EQUAL_UINT32(0, h.count());
+    TEST_ASSERT_EQUAL_UINT32(0, h.minValue());
+    TEST_ASSERT_EQUAL_UINT32(0, h.maxValue());
+}
+
+void test_log_histogram_ms_percentiles_use_bucket_edges() {
+    MsHistogram h;
+    // 90 fast sends (~200 ms) and 10 timeouts (~9 s)
+    for (int i = 0; i < 90; i++) h.record(200);
+    for (int i = 0; i < 10; i++) h.record(9000);
+
+    TEST_ASSERT_EQUAL_UINT32(256, h.percentile(50));
+    TEST_ASSERT_EQUAL_UINT32(256, h.percentile(90));
+    // The p95 sample is a timeout: its bucket edge (16384) is capped at max
+    TEST_ASSERT_EQUAL_UINT32(9000, h.percentile(95));
+    TEST_ASSERT_EQUAL_UINT32(9000, h.percentile(100));
+}
+
+void test_log_histogram_us_percentiles_use_bucket_edges() {
+    UsHistogram h;
+    // 19 fast runs and one slow one
+    for (int i = 0; i < 19; i++) h.record(10);
+    h.record(5000);
+
+    TEST_ASSERT_EQUAL_UINT32(16, h.percentile(0));     // rank clamps to the first sample
+    TEST_ASSERT_EQUAL_UINT32(16, h.percentile(50));    // [8, 16) bucket edge
+    TEST_ASSERT_EQUAL_UINT32(16, h.percentile(95));
+    TEST_ASSERT_EQUAL_UINT32(5000, h.percentile(100)); // capped at max
+}
+
+// ============================================================================
+// Serialisation
+// ============================================================================
+
+void test_log_histogram_buckets_trim_empty_tail() {
+    UsHistogram h;
+    char buf[32];
+    TEST_ASSERT_EQUAL_size_t(2, h.formatBuckets(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("[]", buf);
+
+    h.record(1);
+    h.record(9);
+    h.record(12);
+    size_t n = h.formatBuckets(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING("[1,0,2]", buf);
+    TEST_ASSERT_EQUAL_size_t(strlen(buf), n);
+}
+
+void test_log_histogram_buckets_too_small_writes_empty() {
+    UsHistogram h;
+    h.record(1);
+    h.record(9);
+    char buf[8];   // exactly "[1,0,1]" and the NUL
+    TEST_ASSERT_EQUAL_size_t(7, h.formatBuckets(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_size_t(0, h.formatBuckets(buf, sizeof(buf) - 1));
+    TEST_ASSERT_EQUAL_STRING("", buf);
+    TEST_ASSERT_EQUAL_size_t(0, h.formatBuckets(buf, 2));
+    TEST_ASSERT_EQUAL_STRING("", buf);
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_log_histogram_ms_bucket_edges);
+    RUN_TEST(test_log_histogram_us_bucket_edges);
+    RUN_TEST(test_log_histogram_upper_bounds_match_buckets);
+
+    RUN_TEST(test_log_histogram_counts_min_mean_max);
+    RUN_TEST(test_log_histogram_ms_percentiles_use_bucket_edges);
+    RUN_TEST(test_log_histogram_us_percentiles_use_bucket_edges);
+
+    RUN_TEST(test_log_histogram_buckets_trim_empty_tail);
+    RUN_TEST(test_log_histogram_buckets_too_small_writes_empty);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
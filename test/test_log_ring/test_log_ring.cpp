@@ -0,0 +1,184 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/LogRing.h"
+
+// Peek one span into a NUL-terminated string and commit it.
+template <size_t N>
+static uint16_t take(LogRing<N>& r, size_t maxPayload, uint16_t maxLines, char* out) {
+    const char* data;
+    size_t len;
+    uint16_t n = r.peek(maxPayload, maxLines, data, len);
+    memcpy(out, data, n ? len : 0);
+    out[n ? len : 0] = '\0';
+    r.commit();
+    return n;
+}
+
+// ============================================================================
+// Basic queueing
+// ============================================================================
+
+void test_ring_fifo_one_line_at_a_time() {
+    LogRing<256> r;
+    TEST_ASSERT_TRUE(r.empty());
+    r.push("first", 255);
+    r.push("second", 255);
+    TEST_ASSERT_EQUAL_UINT16(2, r.size());
+    TEST_ASSERT_EQUAL_size_t(13, r.bytesUsed());
+
+    char out[256];
+    TEST_ASSERT_EQUAL_UINT16(1, take(r, 200, 1, out));
+    TEST_ASSERT_EQUAL_STRING("first", out);
+    TEST_ASSERT_EQUAL_UINT16(1, take(r, 200, 1, out));
+    TEST_ASSERT_EQUAL_STRING("second", out);
+    TEST_ASSERT_EQUAL_UINT16(0, take(r, 200, 1, out));
+}
+
+void test_ring_holds_many_short_lines() {
+    // 16 fixed 256-byte slots held 16 lines; the same 4 KB of 60-byte
+    // lines holds four times that
+    LogRing<4096> r;
+    char line[61];
+    memset(line, 'x', 60);
+    line[60] = '\0';
+    for (int i = 0; i < 64; i++) TEST_ASSERT_TRUE(r.push(line, 255));
+    TEST_ASSERT_EQUAL_UINT16(64, r.size());
+    TEST_ASSERT_EQUAL_UINT32(0, r.dropped());
+}
+
+void test_ring_truncates_and_flattens_newlines() {
+    LogRing<256> r;
+    r.push("two\nlines\r", 255);
+    r.push("abcdefgh", 4);
+    char out[256];
+    take(r, 200, 1, out);
+    TEST_ASSERT_EQUAL_STRING("two lines ", out);
+    take(r, 200, 1, out);
+    TEST_ASSERT_EQUAL_STRING("abcd", out);
+}
+
+// ============================================================================
+// Batching (zero-copy peek)
+// ============================================================================
+
+void test_ring_peek_batches_lines_to_payload_limit() {
+    LogRing<256> r;
+    r.push("aaaa", 255);
+    r.push("bbbb", 255);
+    r.push("cccc", 255);
+    char out[256];
+    // "aaaa\nbbbb" is 9 bytes; adding "\ncccc" would make 14
+    TEST_ASSERT_EQUAL_UINT16(2, take(r, 12, 100, out));
+    TEST_ASSERT_EQUAL_STRING("aaaa\nbbbb", out);
+    TEST_ASSERT_EQUAL_UINT16(1, take(r, 12, 100, out));
+    TEST_ASSERT_EQUAL_STRING("cccc", out);
+}
+
+void test_ring_peek_points_into_buffer_until_commit() {
+    LogRing<256> r;
+    r.push("hello", 255);
+    const char* a;
+    const char* b;
+    size_t len;
+    TEST_ASSERT_EQUAL_UINT16(1, r.peek(100, 10, a, len));
+    // A second peek before commit gets nothing (the span is reserved)
+    TEST_ASSERT_EQUAL_UINT16(0, r.peek(100, 10, b, len));
+    r.commit();
+    TEST_ASSERT_TRUE(r.empty());
+}
+
+void test_ring_cancel_returns_span_unsent() {
+    LogRing<256> r;
+    char out[64];
+    r.push("first", 255);
+    r.push("second", 255);
+    const char* data;
+    size_t len;
+    TEST_ASSERT_EQUAL_UINT16(2, r.peek(100, 10, data, len));
+    r.cancel();                    // e.g. the UART had no room for it
+    TEST_ASSERT_EQUAL_UINT16(2, r.size());
+    TEST_ASSERT_EQUAL_UINT16(1, take(r, 100, 1, out));
+    TEST_ASSERT_EQUAL_STRING("first", out);
+    // Cancelled lines are evictable again
+    for (int i = 0; i < 40; i++) r.push("0123456789", 255);
+    TEST_ASSERT_TRUE(r.dropped() > 0);
+}
+
+// ============================================================================
+// Full ring
+// ============================================================================
+
+void test_ring_full_evicts_oldest() {
+    LogRing<64> r;                      // 64 bytes: five 11-byte lines fit
+    char out[64];
+    for (int i = 0; i < 7; i++) {
+        char line[16];
+        snprintf(line, sizeof(line), "line-%04d!", i);
+        TEST_ASSERT_TRUE(r.push(line, 255));
+    }
+    TEST_ASSERT_EQUAL_UINT32(2, r.dropped());
+    TEST_ASSERT_EQUAL_UINT16(5, r.size());
+    TEST_ASSERT_EQUAL_size_t(55, r.highWaterBytes());
+    take(r, 10, 1, out);
+    TEST_ASSERT_EQUAL_STRING("line-0002!", out);
+}
+
+void test_ring_reserved_span_is_never_evicted() {
+    LogRing<64> r;
+    for (int i = 0; i < 5; i++) r.push("0123456789", 255);
+    const char* data;
+    size_t len;
+    TEST_ASSERT_EQUAL_UINT16(5, r.peek(100, 10, data, len));
+    // No free space and nothing evictable: the new line is dropped
+    TEST_ASSERT_FALSE(r.push("newest line", 255));
+    TEST_ASSERT_EQUAL_UINT32(1, r.dropped());
+    TEST_ASSERT_EQUAL(0, memcmp(data, "0123456789\n0123456789", 21));
+    r.commit();
+    TEST_ASSERT_TRUE(r.push("newest line", 255));
+}
+
+void test_ring_wraps_without_splitting_lines() {
+    LogRing<64> r;
+    char out[64];
+    for (int round = 0; round < 20; round++) {
+        char line[24];
+        snprintf(line, sizeof(line), "round %d of the test", round);
+        r.push(line, 255);
+        r.push("x", 255);
+        TEST_ASSERT_EQUAL_UINT16(1, take(r, 60, 1, out));
+        TEST_ASSERT_EQUAL_STRING(line, out);
+        TEST_ASSERT_EQUAL_UINT16(1, take(r, 60, 1, out));
+        TEST_ASSERT_EQUAL_STRING("x", out);
+    }
+    TEST_ASSERT_TRUE(r.empty());
+    TEST_ASSERT_EQUAL_UINT32(0, r.dropped());
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_ring_fifo_one_line_at_a_time);
+    RUN_TEST(test_ring_holds_many_short_lines);
+    RUN_TEST(test_ring_truncates_and_flattens_newlines);
+
+    RUN_TEST(test_ring_peek_batches_lines_to_payload_limit);
+    RUN_TEST(test_ring_peek_points_into_buffer_until_commit);
+    RUN_TEST(test_ring_cancel_returns_span_unsent);
+
+    RUN_TEST(test_ring_full_evicts_oldest);
+    RUN_TEST(test_ring_reserved_span_is_never_evicted);
+    RUN_TEST(test_ring_wraps_without_splitting_lines);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
@@ -0,0 +1,105 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+#include <string.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/LogTags.h"
+
+static const uint32_t DEFAULT_MASK = LOG_TAG_BIT(LOG_TAG_SETUP) | LOG_TAG_BIT(LOG_TAG_STATE);
+
+static bool parse(const char* text, uint32_t current, uint32_t& out, uint32_t& forSec) {
+    return LogTags::parseMask(text, strlen(text), current, DEFAULT_MASK, out, forSec);
+}
+
+// ============================================================================
+// Parsing
+// ============================================================================
+
+void test_tags_absolute_list_replaces_mask() {
+    uint32_t m, s;
+    TEST_ASSERT_TRUE(parse("network,status", LogTags::ALL, m, s));
+    TEST_ASSERT_EQUAL_HEX32(LOG_TAG_BIT(LOG_TAG_NETWORK) | LOG_TAG_BIT(LOG_TAG_STATUS), m);
+    TEST_ASSERT_EQUAL_UINT32(0, s);
+
+    TEST_ASSERT_TRUE(parse("none", LogTags::ALL, m, s));
+    TEST_ASSERT_EQUAL_HEX32(0, m);
+    TEST_ASSERT_TRUE(parse("all", 0, m, s));
+    TEST_ASSERT_EQUAL_HEX32(LogTags::ALL, m);
+    TEST_ASSERT_TRUE(parse("default", 0, m, s));
+    TEST_ASSERT_EQUAL_HEX32(DEFAULT_MASK, m);
+}
+
+void test_tags_relative_tokens_adjust_current() {
+    uint32_t m, s;
+    TEST_ASSERT_TRUE(parse("+network", DEFAULT_MASK, m, s));
+    TEST_ASSERT_EQUAL_HEX32(DEFAULT_MASK | LOG_TAG_BIT(LOG_TAG_NETWORK), m);
+    TEST_ASSERT_TRUE(parse("-state  +sensor", DEFAULT_MASK, m, s));
+    TEST_ASSERT_EQUAL_HEX32(LOG_TAG_BIT(LOG_TAG_SETUP) | LOG_TAG_BIT(LOG_TAG_SENSOR), m);
+    // Left to right: all, then drop status
+    TEST_ASSERT_TRUE(parse("all,-status", 0, m, s));
+    TEST_ASSERT_EQUAL_HEX32(LogTags::ALL & ~LOG_TAG_BIT(LOG_TAG_STATUS), m);
+}
+
+void test_tags_duration_and_rejects() {
+    uint32_t m = 0x55, s = 7;
+    TEST_ASSERT_TRUE(parse("+network for=3600", 0, m, s));
+    TEST_ASSERT_EQUAL_HEX32(LOG_TAG_BIT(LOG_TAG_NETWORK), m);
+    TEST_ASSERT_EQUAL_UINT32(3600, s);
+
+    // Unknown tag, bad number, empty text: outputs untouched
+    m = 0x55; s = 7;
+    TEST_ASSERT_FALSE(parse("network,wifi", 0, m, s));
+    TEST_ASSERT_FALSE(parse("network for=12x", 0, m, s));
+    TEST_ASSERT_FALSE(parse(" , ", 0, m, s));
+    TEST_ASSERT_FALSE(LogTags::parseMask(nullptr, 0, 0, DEFAULT_MASK, m, s));
+    TEST_ASSERT_EQUAL_HEX32(0x55, m);
+    TEST_ASSERT_EQUAL_UINT32(7, s);
+
+    // Not NUL-terminated (an MQTT payload): only len bytes are read
+    const char payload[] = { 'n', 'e', 't', 'w', 'o', 'r', 'k', 'X' };
+    TEST_ASSERT_TRUE(LogTags::parseMask(payload, 7, 0, DEFAULT_MASK, m, s));
+    TEST_ASSERT_EQUAL_HEX32(LOG_TAG_BIT(LOG_TAG_NETWORK), m);
+}
+
+// ============================================================================
+// Formatting
+// ============================================================================
+
+void test_tags_format_round_trips() {
+    char text[64];
+    LogTags::formatMask(LogTags::ALL, text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("all", text);
+    LogTags::formatMask(0, text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("none", text);
+
+    uint32_t mask = LOG_TAG_BIT(LOG_TAG_GENERAL) | LOG_TAG_BIT(LOG_TAG_NETWORK);
+    LogTags::formatMask(mask, text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("general,network", text);
+    uint32_t m, s;
+    TEST_ASSERT_TRUE(parse(text, 0, m, s));
+    TEST_ASSERT_EQUAL_HEX32(mask, m);
+
+    // A short buffer keeps whole names only
+    char small[10];
+    LogTags::formatMask(mask, small, sizeof(small));
+    TEST_ASSERT_EQUAL_STRING("general", small);
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_tags_absolute_list_replaces_mask);
+    RUN_TEST(test_tags_relative_tokens_adjust_current);
+    RUN_TEST(test_tags_duration_and_rejects);
+
+    RUN_TEST(test_tags_format_round_trips);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
@@ -0,0 +1,195 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+#include <string.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/LoopProfiler.h"
+
+// Fake cycle counter at 240 cycles per microsecond; work advances it
+static uint32_t fakeCycles = 0;
+static uint32_t fakeCycleCount() { return fakeCycles; }
+static void work(uint32_t us) { fakeCycles += us * 240; }
+
+enum { SEC_MQTT, SEC_WIFI, SEC_STATE, SEC_COUNT };
+static const char* const SECTION_NAMES[SEC_COUNT] = { "mqtt", "wifi", "state" };
+
+void setUp() { fakeCycles = 0; }
+void tearDown() {}
+
+// ============================================================================
+// Sections
+// ============================================================================
+
+void test_profiler_scope_records_min_max_mean() {
+    LoopProfiler p(SECTION_NAMES, SEC_COUNT, fakeCycleCount, 240);
+    const uint32_t runs[] = { 100, 300, 200 };
+    for (uint32_t us : runs) {
+        PROFILE_SCOPE(p, SEC_MQTT);
+        work(us);
+    }
+    const LoopProfiler::Stats& s = p.section(SEC_MQTT);
+    TEST_ASSERT_EQUAL_UINT32(3, s.count());
+    TEST_ASSERT_EQUAL_UINT32(100, s.minValue());
+    TEST_ASSERT_EQUAL_UINT32(300, s.maxValue());
+    TEST_ASSERT_EQUAL_UINT32(200, s.mean());
+    TEST_ASSERT_EQUAL_UINT32(0, p.section(SEC_WIFI).count());
+}
+
+void test_profiler_cycle_counter_wrap() {
+    LoopProfiler p(SECTION_NAMES, SEC_COUNT, fakeCycleCount, 240);
+    fakeCycles = UINT32_MAX - 1000;
+    {
+        PROFILE_SCOPE(p, SEC_WIFI);
+        work(50);
+    }
+    TEST_ASSERT_EQUAL_UINT32(50, p.section(SEC_WIFI).maxValue());
+}
+
+// ============================================================================
+// Iterations
+// ============================================================================
+
+static void iteration(LoopProfiler& p, uint32_t mqttUs, uint32_t wifiUs, uint32_t untimedUs) {
+    PROFILE_ITERATION_BEGIN(p);
+    {
+        PROFILE_SCOPE(p, SEC_MQTT);
+        work(mqttUs);
+    }
+    if (wifiUs) {
+        PROFILE_SCOPE(p, SEC_WIFI);
+        work(wifiUs);
+    }
+    work(untimedUs);
+    PROFILE_ITERATION_END(p);
+}
+
+void test_profiler_keeps_worst_iteration_breakdown() {
+    LoopProfiler p(SECTION_NAMES, SEC_COUNT, fakeCycleCount, 240);
+    iteration(p, 100, 0, 10);
+    iteration(p, 200, 5000, 10);   // the worst
+    iteration(p, 3000, 0, 10);
+
+    TEST_ASSERT_EQUAL_UINT32(3, p.iteration().count());
+    TEST_ASSERT_EQUAL_UINT32(5210, p.worstIteration());
+    TEST_ASSERT_EQUAL_UINT32(2, p.worstIterationAt());
+    TEST_ASSERT_EQUAL_UINT32(200, p.worstBreakdownUs(SEC_MQTT));
+    TEST_ASSERT_EQUAL_UINT32(5000, p.worstBreakdownUs(SEC_WIFI));
+    TEST_ASSERT_EQUAL_UINT32(0, p.worstBreakdownUs(SEC_STATE));
+    // Section stats keep accumulating across iterations
+    TEST_ASSERT_EQUAL_UINT32(3000, p.section(SEC_MQTT).maxValue());
+}
+
+void test_profiler_section_runs_twice_in_one_iteration() {
+    LoopProfiler p(SECTION_NAMES, SEC_COUNT, fakeCycleCount, 240);
+    PROFILE_ITERATION_BEGIN(p);
+    for (int i = 0; i < 2; i++) {
+        PROFILE_SCOPE(p, SEC_MQTT);
+        work(400);
+    }
+    PROFILE_ITERATION_END(p);
+    TEST_ASSERT_EQUAL_UINT32(2, p.section(SEC_MQTT).count());
+    TEST_ASSERT_EQUAL_UINT32(800, p.worstBreakdownUs(SEC_MQTT));
+}
+
+void test_profiler_end_without_begin_is_ignored() {
+    LoopProfiler p(SECTION_NAMES, SEC_COUNT, fakeCycleCount, 240);
+    p.endIteration();
+    TEST_ASSERT_EQUAL_UINT32(0, p.iteration().count());
+    {
+        PROFILE_SCOPE(p, SEC_MQTT);   // outside an iteration: stats only
+        work(100);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, p.section(SEC_MQTT).count());
+    TEST_ASSERT_EQUAL_UINT32(0, p.worstBreakdownUs(SEC_MQTT));
+}
+
+void test_profiler_out_of_range_section_is_ignored() {
+    LoopProfiler p(SECTION_NAMES, SEC_COUNT, fakeCycleCount, 240);
+    p.record(SEC_COUNT, p.now());
+    p.record(LoopProfiler::MAX_SECTIONS + 1, p.now());
+    TEST_ASSERT_EQUAL_STRING("", p.name(SEC_COUNT));
+    for (uint8_t i = 0; i < SEC_COUNT; i++) TEST_ASSERT_EQUAL_UINT32(0, p.section(i).count());
+}
+
+// ============================================================================
+// JSON
+// ============================================================================
+
+void test_profiler_summary_json() {
+    LoopProfiler p(SECTION_NAMES, SEC_COUNT, fakeCycleCount, 240);
+    iteration(p, 100, 0, 0);
+    iteration(p, 200, 4800, 0);
+    char buf[256];
+    size_t n = p.formatSummaryJson(buf, sizeof(buf), 10000000);
+    TEST_ASSERT_EQUAL_size_t(strlen(buf), n);
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"iter\":{\"n\":2,\"min\":100,\"mean\":2550,\"p95\":5000,\"max\":5000,\"b\":[0,0,0,0,0,1,0,0,0,0,0,1]},"
+        "\"budget_pct\":0.1,\"worst\":{\"us\":5000,\"at\":2,\"s\":{\"mqtt\":200,\"wifi\":4800}}}", buf);
+}
+
+void test_profiler_full_json_lists_sections_that_ran() {
+    LoopProfiler p(SECTION_NAMES, SEC_COUNT, fakeCycleCount, 240);
+    iteration(p, 10, 0, 0);
+    char buf[512];
+    TEST_ASSERT_TRUE(p.formatJson(buf, sizeof(buf), 1000) > 0);
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"budget_pct\":1.0,"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, ",\"s\":{\"mqtt\":{\"n\":1,\"min\":10,\"mean\":10,\"p95\":10,\"max\":10,\"b\":[0,0,1]}}}"));
+    TEST_ASSERT_NULL(strstr(buf, "\"wifi\""));
+}
+
+void test_profiler_json_without_buckets() {
+    LoopProfiler p(SECTION_NAMES, SEC_COUNT, fakeCycleCount, 240);
+    iteration(p, 10, 0, 0);
+    char buf[512];
+    TEST_ASSERT_TRUE(p.formatJson(buf, sizeof(buf), 1000, false) > 0);
+    TEST_ASSERT_NOT_NULL(strstr(buf, ",\"s\":{\"mqtt\":{\"n\":1,\"min\":10,\"mean\":10,\"p95\":10,\"max\":10}}}"));
+    // The iteration summary keeps its histogram
+    TEST_ASSERT_NOT_NULL(strstr(buf, "{\"iter\":{\"n\":1,\"min\":10,\"mean\":10,\"p95\":10,\"max\":10,\"b\":[0,0,1]},"));
+}
+
+void test_profiler_json_too_small_writes_empty() {
+    LoopProfiler p(SECTION_NAMES, SEC_COUNT, fakeCycleCount, 240);
+    iteration(p, 10, 20, 0);
+    char full[512];
+    size_t n = p.formatJson(full, sizeof(full), 1000);
+    TEST_ASSERT_TRUE(n > 0);
+    // Every length short of the full document fails cleanly
+    for (size_t len = 1; len <= n; len++) {
+        char buf[512];
+        memset(buf, 'x', sizeof(buf));
+        TEST_ASSERT_EQUAL_size_t(0, p.formatJson(buf, len, 1000));
+        TEST_ASSERT_EQUAL_STRING("", buf);
+        memset(buf, 'x', sizeof(buf));
+        size_t w = p.formatJson(buf, len, 1000, false);
+        TEST_ASSERT_TRUE(w == 0 ? buf[0] == '\0' : w < len && buf[w] == '\0');
+    }
+    char buf[512];
+    TEST_ASSERT_EQUAL_size_t(n, p.formatJson(buf, n + 1, 1000));
+    TEST_ASSERT_EQUAL_STRING(full, buf);
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_profiler_scope_records_min_max_mean);
+    RUN_TEST(test_profiler_cycle_counter_wrap);
+
+    RUN_TEST(test_profiler_keeps_worst_iteration_breakdown);
+    RUN_TEST(test_profiler_section_runs_twice_in_one_iteration);
+    RUN_TEST(test_profiler_end_without_begin_is_ignored);
+    RUN_TEST(test_profiler_out_of_range_section_is_ignored);
+
+    RUN_TEST(test_profiler_summary_json);
+    RUN_TEST(test_profiler_full_json_lists_sections_that_ran);
+    RUN_TEST(test_profiler_json_without_buckets);
+    RUN_TEST(test_profiler_json_too_small_writes_empty);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
@@ -0,0 +1,154 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/LoopScheduler.h"
+
+// Fake microsecond clock; jobs advance it to simulate their run time
+static uint32_t fakeUs = 0;
+static uint32_t fakeClockUs() { return fakeUs; }
+
+struct Probe {
+    int runs;
+    uint32_t costUs;
+    int* order;     // shared run-order log
+    int* orderLen;
+    int id;
+};
+
+static void probeJob(void* arg) {
+    Probe* p = static_cast<Probe*>(arg);
+    p->runs++;
+    fakeUs += p->costUs;
+    if (p->order) p->order[(*p->orderLen)++] = p->id;
+}
+
+void setUp() { fakeUs = 0; }
+void tearDown() {}
+
+// ============================================================================
+// Scheduling
+// ============================================================================
+
+void test_scheduler_runs_everything_on_first_pass() {
+    LoopScheduler s(fakeClockUs);
+    Probe a = { 0, 0, nullptr, nullptr, 0 };
+    Probe b = { 0, 0, nullptr, nullptr, 1 };
+    s.add("a", probeJob, &a, 10, 1000);
+    s.add("b", probeJob, &b, 60000, 1000);
+    TEST_ASSERT_EQUAL_UINT32(10, s.runDue(5000));
+    TEST_ASSERT_EQUAL(1, a.runs);
+    TEST_ASSERT_EQUAL(1, b.runs);
+}
+
+void test_scheduler_respects_periods() {
+    LoopScheduler s(fakeClockUs);
+    Probe fast = { 0, 0, nullptr, nullptr, 0 };
+    Probe slow = { 0, 0, nullptr, nullptr, 1 };
+    s.add("fast", probeJob, &fast, 10, 1000);
+    s.add("slow", probeJob, &slow, 1000, 1000);
+    for (uint32_t t = 0; t < 5000; t++) s.runDue(t); // 1 ms ticks
+    TEST_ASSERT_EQUAL(500, fast.runs);
+    TEST_ASSERT_EQUAL(5, slow.runs);
+}
+
+void test_scheduler_runs_in_registration_order() {
+    LoopScheduler s(fakeClockUs);
+    int order[8];
+    int len = 0;
+    Probe first  = { 0, 0, order, &len, 1 };
+    Probe second = { 0, 0, order, &len, 2 };
+    s.add("first", probeJob, &first, 10, 1000);
+    s.add("second", probeJob, &second, 10, 1000);
+    s.runDue(0);
+    s.runDue(10);
+    TEST_ASSERT_EQUAL(4, len);
+    TEST_ASSERT_EQUAL(1, order[0]);
+    TEST_ASSERT_EQUAL(2, order[1]);
+    TEST_ASSERT_EQUAL(1, order[2]);
+    TEST_ASSERT_EQUAL(2, order[3]);
+}
+
+void test_scheduler_keeps_phase_when_slightly_late() {
+    LoopScheduler s(fakeClockUs);
+    Probe p = { 0, 0, nullptr, nullptr, 0 };
+    s.add("p", probeJob, &p, 100, 1000);
+    s.runDue(0);
+    s.runDue(103);                               // 3 ms late
+    TEST_ASSERT_EQUAL_UINT32(97, s.msUntilNextDue(103)); // next at 200, not 203
+    TEST_ASSERT_EQUAL_UINT32(3, s.job(0).maxLateMs);
+}
+
+void test_scheduler_rephases_instead_of_bursting() {
+    LoopScheduler s(fakeClockUs);
+    Probe p = { 0, 0, nullptr, nullptr, 0 };
+    s.add("p", probeJob, &p, 10, 1000);
+    s.runDue(0);
+    s.runDue(505);                               // loop was blocked ~half a second
+    TEST_ASSERT_EQUAL(2, p.runs);
+    TEST_ASSERT_EQUAL_UINT32(10, s.msUntilNextDue(505));
+    s.runDue(506);
+    TEST_ASSERT_EQUAL(2, p.runs);                // no catch-up burst
+    TEST_ASSERT_EQUAL_UINT32(49, s.job(0).skipped);
+}
+
+void test_scheduler_survives_millis_wraparound() {
+    LoopScheduler s(fakeClockUs);
+    Probe p = { 0, 0, nullptr, nullptr, 0 };
+    s.add("p", probeJob, &p, 100, 1000);
+    uint32_t t = 0xFFFFFFFFu - 250;
+    for (int i = 0; i < 1000; i++, t++) s.runDue(t);
+    TEST_ASSERT_EQUAL(10, p.runs);
+    TEST_ASSERT_EQUAL_UINT32(0, s.job(0).skipped);
+}
+
+// ============================================================================
+// Accounting
+// ============================================================================
+
+void test_scheduler_counts_overruns() {
+    LoopScheduler s(fakeClockUs);
+    Probe cheap = { 0, 200, nullptr, nullptr, 0 };
+    Probe heavy = { 0, 5000, nullptr, nullptr, 1 };
+    s.add("cheap", probeJob, &cheap, 10, 1000);
+    s.add("heavy", probeJob, &heavy, 10, 1000);
+    s.runDue(0);
+    s.runDue(10);
+    TEST_ASSERT_EQUAL_UINT32(0, s.job(0).overruns);
+    TEST_ASSERT_EQUAL_UINT32(2, s.job(1).overruns);
+    TEST_ASSERT_EQUAL_UINT32(5000, s.job(1).maxRunUs);
+    TEST_ASSERT_EQUAL_UINT32(2, s.totalOverruns());
+}
+
+void test_scheduler_rejects_when_full() {
+    LoopScheduler s(fakeClockUs);
+    Probe p = { 0, 0, nullptr, nullptr, 0 };
+    for (int i = 0; i < LoopScheduler::MAX_JOBS; i++) {
+        TEST_ASSERT_EQUAL(i, s.add("p", probeJob, &p, 10, 1000));
+    }
+    TEST_ASSERT_EQUAL(-1, s.add("extra", probeJob, &p, 10, 1000));
+    TEST_ASSERT_EQUAL(-1, LoopScheduler(fakeClockUs).add("zero", probeJob, &p, 0, 1000));
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_scheduler_runs_everything_on_first_pass);
+    RUN_TEST(test_scheduler_respects_periods);
+    RUN_TEST(test_scheduler_runs_in_registration_order);
+    RUN_TEST(test_scheduler_keeps_phase_when_slightly_late);
+    RUN_TEST(test_scheduler_rephases_instead_of_bursting);
+    RUN_TEST(test_scheduler_survives_millis_wraparound);
+
+    RUN_TEST(test_scheduler_counts_overruns);
+    RUN_TEST(test_scheduler_rejects_when_full);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
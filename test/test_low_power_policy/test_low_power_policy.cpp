@@ -0,0 +1,132 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/LowPowerPolicy.h"
+
+static const uint32_t POWER_ON_AWAKE_MS = 10UL * 60000UL;
+static const uint32_t LEVEL_AWAKE_MS    = 60000UL;
+static const uint32_t REPORT_TIMEOUT_MS = 45000UL;
+
+static LowPowerPolicy makePolicy(LowPowerPolicy::Wake wake) {
+    LowPowerPolicy p(POWER_ON_AWAKE_MS, LEVEL_AWAKE_MS, REPORT_TIMEOUT_MS);
+    p.setWake(wake);
+    return p;
+}
+
+// Everything quiet: dry boat, telemetry sent, well past any minimum.
+static LowPowerPolicy::Inputs quiet() {
+    LowPowerPolicy::Inputs in;
+    in.awakeMs = 20UL * 60000UL;
+    in.stateNormal = true;
+    in.readingsValid = true;
+    in.maxLevel_cm = 3.0f;
+    in.wakeLevel_cm = 13.0f;
+    in.busy = false;
+    in.reported = true;
+    return in;
+}
+
+// ============================================================================
+// Reasons to stay awake
+// ============================================================================
+
+void test_policy_quiet_boat_sleeps() {
+    LowPowerPolicy p = makePolicy(LowPowerPolicy::WAKE_HEARTBEAT);
+    TEST_ASSERT_EQUAL(LowPowerPolicy::SLEEP, p.check(quiet()));
+}
+
+void test_policy_alarm_state_and_invalid_readings_stay_awake() {
+    LowPowerPolicy p = makePolicy(LowPowerPolicy::WAKE_HEARTBEAT);
+    LowPowerPolicy::Inputs in = quiet();
+    in.stateNormal = false;
+    TEST_ASSERT_EQUAL(LowPowerPolicy::STAY_STATE, p.check(in));
+
+    in = quiet();
+    in.readingsValid = false;
+    TEST_ASSERT_EQUAL(LowPowerPolicy::STAY_INVALID, p.check(in));
+}
+
+void test_policy_level_at_wake_threshold_stays_awake() {
+    // Sleeping here would re-trigger the comparator at once.
+    LowPowerPolicy p = makePolicy(LowPowerPolicy::WAKE_HEARTBEAT);
+    LowPowerPolicy::Inputs in = quiet();
+    in.maxLevel_cm = in.wakeLevel_cm;
+    TEST_ASSERT_EQUAL(LowPowerPolicy::STAY_LEVEL, p.check(in));
+    in.maxLevel_cm = in.wakeLevel_cm - 0.1f;
+    TEST_ASSERT_EQUAL(LowPowerPolicy::SLEEP, p.check(in));
+}
+
+void test_policy_busy_stays_awake() {
+    LowPowerPolicy p = makePolicy(LowPowerPolicy::WAKE_HEARTBEAT);
+    LowPowerPolicy::Inputs in = quiet();
+    in.busy = true;
+    TEST_ASSERT_EQUAL(LowPowerPolicy::STAY_BUSY, p.check(in));
+}
+
+// ============================================================================
+// Minimum awake time per wake reason
+// ============================================================================
+
+void test_policy_min_awake_depends_on_wake_reason() {
+    TEST_ASSERT_EQUAL_UINT32(POWER_ON_AWAKE_MS, makePolicy(LowPowerPolicy::WAKE_POWER_ON).minAwakeMs());
+    TEST_ASSERT_EQUAL_UINT32(POWER_ON_AWAKE_MS, makePolicy(LowPowerPolicy::WAKE_BUTTON).minAwakeMs());
+    TEST_ASSERT_EQUAL_UINT32(LEVEL_AWAKE_MS, makePolicy(LowPowerPolicy::WAKE_LEVEL).minAwakeMs());
+    TEST_ASSERT_EQUAL_UINT32(0, makePolicy(LowPowerPolicy::WAKE_HEARTBEAT).minAwakeMs());
+
+    LowPowerPolicy p = makePolicy(LowPowerPolicy::WAKE_LEVEL);
+    LowPowerPolicy::Inputs in = quiet();
+    in.awakeMs = LEVEL_AWAKE_MS - 1;
+    TEST_ASSERT_EQUAL(LowPowerPolicy::STAY_MIN_AWAKE, p.check(in));
+    in.awakeMs = LEVEL_AWAKE_MS;
+    TEST_ASSERT_EQUAL(LowPowerPolicy::SLEEP, p.check(in));
+}
+
+// ============================================================================
+// Report before sleeping, bounded by the timeout
+// ============================================================================
+
+void test_policy_waits_for_report_until_timeout() {
+    LowPowerPolicy p = makePolicy(LowPowerPolicy::WAKE_HEARTBEAT);
+    LowPowerPolicy::Inputs in = quiet();
+    in.reported = false;
+    in.awakeMs = 5000;
+    TEST_ASSERT_EQUAL(LowPowerPolicy::STAY_REPORT, p.check(in));
+    in.reported = true;
+    TEST_ASSERT_EQUAL(LowPowerPolicy::SLEEP, p.check(in));
+
+    in.reported = false;
+    in.awakeMs = REPORT_TIMEOUT_MS;
+    TEST_ASSERT_EQUAL(LowPowerPolicy::SLEEP, p.check(in));
+}
+
+void test_policy_wake_level_and_names() {
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 13.0f, LowPowerPolicy::wakeLevel(15.0f, 2.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 0.0f, LowPowerPolicy::wakeLevel(1.0f, 2.0f));
+    TEST_ASSERT_EQUAL_STRING("level", LowPowerPolicy::wakeName(LowPowerPolicy::WAKE_LEVEL));
+    TEST_ASSERT_EQUAL_STRING("min-awake", LowPowerPolicy::verdictName(LowPowerPolicy::STAY_MIN_AWAKE));
+    TEST_ASSERT_EQUAL_STRING("sleep", LowPowerPolicy::verdictName(LowPowerPolicy::SLEEP));
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_policy_quiet_boat_sleeps);
+    RUN_TEST(test_policy_alarm_state_and_invalid_readings_stay_awake);
+    RUN_TEST(test_policy_level_at_wake_threshold_stays_awake);
+    RUN_TEST(test_policy_busy_stays_awake);
+
+    RUN_TEST(test_policy_min_awake_depends_on_wake_reason);
+
+    RUN_TEST(test_policy_waits_for_report_until_timeout);
+    RUN_TEST(test_policy_wake_level_and_names);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
@@ -0,0 +1,150 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+#include <string.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/MessageQueue.h"
+
+typedef MessageQueue<256> Queue;
+
+static bool pushText(Queue& q, const char* topic, const char* payload, bool retained = false) {
+    return q.push(0, retained, topic, payload, strlen(payload));
+}
+
+static void assertPayload(const Queue::Message& m, const char* expected) {
+    TEST_ASSERT_EQUAL_size_t(strlen(expected), m.len);
+    TEST_ASSERT_EQUAL_MEMORY(expected, m.payload, m.len);
+}
+
+// ============================================================================
+// FIFO
+// ============================================================================
+
+void test_queue_fifo_order_and_fields() {
+    Queue q;
+    Queue::Message m;
+    TEST_ASSERT_FALSE(q.peek(m));
+
+    TEST_ASSERT_TRUE(pushText(q, "boat/a1/x", "one", true));
+    TEST_ASSERT_TRUE(pushText(q, "boat/a1/y", "two"));
+    TEST_ASSERT_EQUAL_UINT16(2, q.size());
+
+    TEST_ASSERT_TRUE(q.peek(m));
+    TEST_ASSERT_EQUAL_STRING("boat/a1/x", m.topic);
+    TEST_ASSERT_TRUE(m.retained);
+    assertPayload(m, "one");
+    q.pop();
+
+    TEST_ASSERT_TRUE(q.peek(m));
+    TEST_ASSERT_EQUAL_STRING("boat/a1/y", m.topic);
+    TEST_ASSERT_FALSE(m.retained);
+    assertPayload(m, "two");
+    q.pop();
+
+    TEST_ASSERT_TRUE(q.empty());
+    TEST_ASSERT_EQUAL_size_t(0, q.bytesUsed());
+}
+
+void test_queue_builtin_kind_and_binary_payload() {
+    Queue q;
+    const uint8_t packed[] = { 0x82, 0x00, 0xA1, 0x61, 0xFF };
+    TEST_ASSERT_TRUE(q.push(3, true, nullptr, packed, sizeof(packed)));
+
+    Queue::Message m;
+    TEST_ASSERT_TRUE(q.peek(m));
+    TEST_ASSERT_EQUAL_UINT8(3, m.kind);
+    TEST_ASSERT_EQUAL_STRING("", m.topic);
+    TEST_ASSERT_EQUAL_size_t(sizeof(packed), m.len);
+    TEST_ASSERT_EQUAL_MEMORY(packed, m.payload, sizeof(packed));
+}
+
+// ============================================================================
+// Capacity
+// ============================================================================
+
+void test_queue_full_rejects_newest() {
+    Queue q;
+    char payload[80];
+    memset(payload, 'p', sizeof(payload) - 1);
+    payload[sizeof(payload) - 1] = '\0';
+
+    // 6 + 2 + 1 + 79 = 88 bytes each: two fit in 256, a third doesn't
+    TEST_ASSERT_TRUE(pushText(q, "t1", payload));
+    TEST_ASSERT_TRUE(pushText(q, "t2", payload));
+    TEST_ASSERT_FALSE(pushText(q, "t3", payload));
+    TEST_ASSERT_EQUAL_UINT32(1, q.dropped());
+    TEST_ASSERT_EQUAL_UINT16(2, q.size());
+
+    // The queued messages are untouched
+    Queue::Message m;
+    q.peek(m);
+    TEST_ASSERT_EQUAL_STRING("t1", m.topic);
+
+    // Anything over half the buffer is refused outright
+    char big[130];
+    memset(big, 'b', sizeof(big) - 1);
+    big[sizeof(big) - 1] = '\0';
+    Queue empty;
+    TEST_ASSERT_FALSE(pushText(empty, "t", big));
+    TEST_ASSERT_EQUAL_UINT32(1, empty.dropped());
+}
+
+void test_queue_wraps_without_splitting_records() {
+    Queue q;
+    char payload[70];
+    memset(payload, 'w', sizeof(payload) - 1);
+    payload[sizeof(payload) - 1] = '\0';
+
+    // 78-byte records: three fill 234 of 256, leaving a 22-byte tail gap
+    for (int i = 0; i < 3; i++) TEST_ASSERT_TRUE(pushText(q, "ab", payload));
+    q.pop();
+    // The fourth goes to the front instead of straddling the end
+    TEST_ASSERT_TRUE(pushText(q, "cd", payload));
+
+    Queue::Message m;
+    for (int i = 0; i < 2; i++) {
+        TEST_ASSERT_TRUE(q.peek(m));
+        TEST_ASSERT_EQUAL_STRING("ab", m.topic);
+        q.pop();
+    }
+    TEST_ASSERT_TRUE(q.peek(m));
+    TEST_ASSERT_EQUAL_STRING("cd", m.topic);
+    assertPayload(m, payload);
+    q.pop();
+    TEST_ASSERT_TRUE(q.empty());
+    TEST_ASSERT_EQUAL_size_t(3 * 78, q.highWaterBytes());
+}
+
+void test_queue_peeked_record_survives_pushes() {
+    Queue q;
+    TEST_ASSERT_TRUE(pushText(q, "first", "keep me"));
+    Queue::Message m;
+    q.peek(m);
+
+    // The producer keeps writing while the consumer publishes the peeked record
+    pushText(q, "second", "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa");
+    pushText(q, "third", "bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb");
+    pushText(q, "fourth", "cccccccccccccccccccccccccccccccccccccccc");
+    TEST_ASSERT_EQUAL_STRING("first", m.topic);
+    assertPayload(m, "keep me");
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_queue_fifo_order_and_fields);
+    RUN_TEST(test_queue_builtin_kind_and_binary_payload);
+
+    RUN_TEST(test_queue_full_rejects_newest);
+    RUN_TEST(test_queue_wraps_without_splitting_records);
+    RUN_TEST(test_queue_peeked_record_survives_pushes);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
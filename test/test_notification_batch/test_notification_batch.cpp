@@ -0,0 +1,117 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+#include <string.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/NotificationBatch.h"
+#include "../../include/NotifyChannelFlags.h"
+
+static const uint32_t WINDOW_MS = 5000;
+
+// ============================================================================
+// Window
+// ============================================================================
+
+void test_batch_due_after_window_from_first_message() {
+    NotificationBatch b;
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, b.msUntilDue(0, WINDOW_MS));
+    b.add("one", CHAN_ALL, 1000);
+    b.add("two", CHAN_ALL, 4000);                  // does not extend the window
+    TEST_ASSERT_FALSE(b.due(5999, WINDOW_MS));
+    TEST_ASSERT_EQUAL_UINT32(1, b.msUntilDue(5999, WINDOW_MS));
+    TEST_ASSERT_TRUE(b.due(6000, WINDOW_MS));
+}
+
+void test_batch_due_immediately_when_full() {
+    NotificationBatch b;
+    for (uint8_t i = 0; i < NotificationBatch::MAX_ITEMS; i++) {
+        TEST_ASSERT_TRUE(b.add("x", CHAN_ALL, 0));
+    }
+    TEST_ASSERT_FALSE(b.add("overflow", CHAN_ALL, 0));
+    TEST_ASSERT_TRUE(b.due(0, WINDOW_MS));
+}
+
+// ============================================================================
+// Building bodies
+// ============================================================================
+
+void test_batch_joins_messages_in_order() {
+    NotificationBatch b;
+    b.add("[MSG:1] failure", CHAN_ALL, 0);
+    b.add("[MSG:2] recovered", CHAN_ALL, 0);
+    char out[64];
+    TEST_ASSERT_EQUAL(2, b.build(CHAN_SMS, 0, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_STRING("[MSG:1] failure\n[MSG:2] recovered", out);
+    TEST_ASSERT_TRUE(b.uniform());
+}
+
+void test_batch_splits_at_channel_limit() {
+    NotificationBatch b;
+    b.add("aaaaaaaaaa", CHAN_ALL, 0);   // 10
+    b.add("bbbbbbbbbb", CHAN_ALL, 0);   // 10
+    b.add("cccccccccc", CHAN_ALL, 0);   // 10
+    char out[22];                       // fits two plus the separator
+    uint8_t next = b.build(CHAN_SMS, 0, out, sizeof(out));
+    TEST_ASSERT_EQUAL(2, next);
+    TEST_ASSERT_EQUAL_STRING("aaaaaaaaaa\nbbbbbbbbbb", out);
+    next = b.build(CHAN_SMS, next, out, sizeof(out));
+    TEST_ASSERT_EQUAL(3, next);
+    TEST_ASSERT_EQUAL_STRING("cccccccccc", out);
+}
+
+void test_batch_truncates_lone_oversized_message() {
+    NotificationBatch b;
+    b.add("0123456789abcdef", CHAN_ALL, 0);
+    b.add("next", CHAN_ALL, 0);
+    char out[9];
+    TEST_ASSERT_EQUAL(1, b.build(CHAN_ALL, 0, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_STRING("01234567", out);
+}
+
+void test_batch_respects_per_message_channels() {
+    NotificationBatch b;
+    b.add("both", CHAN_SMS | CHAN_DISCORD, 0);
+    b.add("discord only", CHAN_DISCORD, 0);
+    b.add("sms only", CHAN_SMS, 0);
+    TEST_ASSERT_FALSE(b.uniform());
+    TEST_ASSERT_EQUAL(CHAN_SMS | CHAN_DISCORD, b.channels());
+
+    char out[64];
+    TEST_ASSERT_EQUAL(3, b.build(CHAN_SMS, 0, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_STRING("both\nsms only", out);
+    TEST_ASSERT_EQUAL(3, b.build(CHAN_DISCORD, 0, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_STRING("both\ndiscord only", out);
+    TEST_ASSERT_EQUAL(3, b.build(CHAN_CUSTOM, 0, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_STRING("", out);
+}
+
+void test_batch_clear_reopens_window() {
+    NotificationBatch b;
+    b.add("old", CHAN_ALL, 0);
+    b.clear();
+    TEST_ASSERT_TRUE(b.empty());
+    b.add("new", CHAN_ALL, 10000);
+    TEST_ASSERT_FALSE(b.due(10000 + WINDOW_MS - 1, WINDOW_MS));
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_batch_due_after_window_from_first_message);
+    RUN_TEST(test_batch_due_immediately_when_full);
+
+    RUN_TEST(test_batch_joins_messages_in_order);
+    RUN_TEST(test_batch_splits_at_channel_limit);
+    RUN_TEST(test_batch_truncates_lone_oversized_message);
+    RUN_TEST(test_batch_respects_per_message_channels);
+    RUN_TEST(test_batch_clear_reopens_window);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
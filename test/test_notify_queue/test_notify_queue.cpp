@@ -0,0 +1,138 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/NotifyQueue.h"
+
+struct Item { int id; };
+
+static Item item(int id) { Item i = { id }; return i; }
+
+// ============================================================================
+// Priority
+// ============================================================================
+
+void test_queue_pops_in_class_order() {
+    NotifyQueue<Item> q;
+    q.push(item(1), NOTIFY_OTA, NOTIFY_KEY_NONE);
+    q.push(item(2), NOTIFY_INFO, NOTIFY_KEY_NONE);
+    q.push(item(3), NOTIFY_FAULT, NOTIFY_KEY_NONE);
+    q.push(item(4), NOTIFY_EMERGENCY, NOTIFY_KEY_EMERGENCY);
+
+    Item out;
+    NotifyClass cls;
+    const int expectId[] = { 4, 3, 2, 1 };
+    const NotifyClass expectCls[] = { NOTIFY_EMERGENCY, NOTIFY_FAULT, NOTIFY_INFO, NOTIFY_OTA };
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(q.pop(out, cls));
+        TEST_ASSERT_EQUAL(expectId[i], out.id);
+        TEST_ASSERT_EQUAL(expectCls[i], cls);
+    }
+    TEST_ASSERT_FALSE(q.pop(out, cls));
+}
+
+void test_queue_fifo_within_class() {
+    NotifyQueue<Item> q;
+    q.push(item(1), NOTIFY_FAULT, NOTIFY_KEY_NONE);
+    q.push(item(2), NOTIFY_FAULT, NOTIFY_KEY_NONE);
+    Item out;
+    TEST_ASSERT_TRUE(q.pop(NOTIFY_FAULT, out));
+    TEST_ASSERT_EQUAL(1, out.id);
+    TEST_ASSERT_TRUE(q.pop(NOTIFY_FAULT, out));
+    TEST_ASSERT_EQUAL(2, out.id);
+}
+
+// ============================================================================
+// Dedup
+// ============================================================================
+
+void test_queue_emergency_is_latest_wins() {
+    NotifyQueue<Item> q;
+    for (int i = 1; i <= 5; i++) {
+        q.push(item(i), NOTIFY_EMERGENCY, NOTIFY_KEY_EMERGENCY);
+    }
+    TEST_ASSERT_EQUAL(1, q.size(NOTIFY_EMERGENCY));
+    TEST_ASSERT_EQUAL_UINT32(0, q.dropped(NOTIFY_EMERGENCY));
+    TEST_ASSERT_EQUAL_UINT32(4, q.deduplicated(NOTIFY_EMERGENCY));
+    Item out;
+    q.pop(NOTIFY_EMERGENCY, out);
+    TEST_ASSERT_EQUAL(5, out.id);
+}
+
+void test_queue_duplicate_replaces_and_moves_to_tail() {
+    NotifyQueue<Item> q;
+    q.push(item(1), NOTIFY_FAULT, NOTIFY_KEY_SENSOR_FAILURE);
+    q.push(item(2), NOTIFY_FAULT, NOTIFY_KEY_SENSOR_RECOVERED);
+    TEST_ASSERT_EQUAL(NotifyQueue<Item>::REPLACED,
+                      q.push(item(3), NOTIFY_FAULT, NOTIFY_KEY_SENSOR_FAILURE));
+    TEST_ASSERT_EQUAL(2, q.size(NOTIFY_FAULT));
+
+    Item out;
+    q.pop(NOTIFY_FAULT, out);
+    TEST_ASSERT_EQUAL(2, out.id);        // recovered, then the newest failure
+    q.pop(NOTIFY_FAULT, out);
+    TEST_ASSERT_EQUAL(3, out.id);
+}
+
+void test_queue_dedup_is_per_class() {
+    NotifyQueue<Item> q;
+    q.push(item(1), NOTIFY_FAULT, NOTIFY_KEY_SILENCE);
+    TEST_ASSERT_EQUAL(NotifyQueue<Item>::QUEUED, q.push(item(2), NOTIFY_INFO, NOTIFY_KEY_SILENCE));
+    TEST_ASSERT_EQUAL(2, q.size());
+}
+
+// ============================================================================
+// Capacity and drops
+// ============================================================================
+
+void test_queue_full_class_drops_newest_and_counts() {
+    NotifyQueue<Item> q;
+    uint8_t cap = NotifyQueue<Item>::capacity(NOTIFY_OTA);
+    for (uint8_t i = 0; i < cap; i++) {
+        TEST_ASSERT_EQUAL(NotifyQueue<Item>::QUEUED, q.push(item(i), NOTIFY_OTA, NOTIFY_KEY_NONE));
+    }
+    TEST_ASSERT_EQUAL(NotifyQueue<Item>::DROPPED, q.push(item(99), NOTIFY_OTA, NOTIFY_KEY_NONE));
+    TEST_ASSERT_EQUAL_UINT32(1, q.dropped(NOTIFY_OTA));
+    TEST_ASSERT_EQUAL_UINT32(1, q.dropped());
+
+    // A full low-priority class never costs a fault alert its slot
+    TEST_ASSERT_EQUAL(NotifyQueue<Item>::QUEUED, q.push(item(7), NOTIFY_FAULT, NOTIFY_KEY_NONE));
+    Item out;
+    NotifyClass cls;
+    q.pop(out, cls);
+    TEST_ASSERT_EQUAL(7, out.id);
+}
+
+void test_queue_duplicate_never_dropped_when_full() {
+    NotifyQueue<Item> q;
+    uint8_t cap = NotifyQueue<Item>::capacity(NOTIFY_FAULT);
+    q.push(item(0), NOTIFY_FAULT, NOTIFY_KEY_BUS_ERROR);
+    for (uint8_t i = 1; i < cap; i++) q.push(item(i), NOTIFY_FAULT, NOTIFY_KEY_NONE);
+    TEST_ASSERT_EQUAL(NotifyQueue<Item>::REPLACED,
+                      q.push(item(50), NOTIFY_FAULT, NOTIFY_KEY_BUS_ERROR));
+    TEST_ASSERT_EQUAL_UINT32(0, q.dropped(NOTIFY_FAULT));
+    TEST_ASSERT_EQUAL(cap, q.size(NOTIFY_FAULT));
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_queue_pops_in_class_order);
+    RUN_TEST(test_queue_fifo_within_class);
+
+    RUN_TEST(test_queue_emergency_is_latest_wins);
+    RUN_TEST(test_queue_duplicate_replaces_and_moves_to_tail);
+    RUN_TEST(test_queue_dedup_is_per_class);
+
+    RUN_TEST(test_queue_full_class_drops_newest_and_counts);
+    RUN_TEST(test_queue_duplicate_never_dropped_when_full);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
@@ -0,0 +1,227 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/PulsePattern.h"
+
+namespace TestConstants {
+    constexpr uint32_t TICK_US = 100;     // PulseOutput's RMT tick
+}
+
+void setUp() {}
+void tearDown() {}
+
+// Level at t by walking the phase table directly — what LightCode::update()
+// used to do with millis() in software
+static bool referenceLevel(const PulsePhase* phases, uint8_t n, uint32_t ms) {
+    uint32_t period = 0;
+    for (uint8_t i = 0; i < n; i++) period += phases[i].ms;
+    uint32_t t = ms % period;
+    for (uint8_t i = 0; i < n; i++) {
+        if (t < phases[i].ms) return phases[i].on;
+        t -= phases[i].ms;
+    }
+    return false;
+}
+
+// ============================================================================
+// Items
+// ============================================================================
+
+void test_pulse_item_layout_matches_rmt() {
+    // rmt_item32_t: duration0 [14:0], level0 [15], duration1 [30:16], level1 [31]
+    TEST_ASSERT_EQUAL_HEX32(0x00008001u, PulsePattern::item(1, true, 0, false));
+    TEST_ASSERT_EQUAL_HEX32(0x80010000u, PulsePattern::item(0, false, 1, true));
+    TEST_ASSERT_EQUAL_HEX32(0x7FFF7FFFu, PulsePattern::item(0x7FFF, false, 0x7FFF, false));
+
+    uint32_t it = PulsePattern::item(1234, true, 5678, false);
+    TEST_ASSERT_EQUAL_UINT32(1234, PulsePattern::ticks0(it));
+    TEST_ASSERT_TRUE(PulsePattern::level0(it));
+    TEST_ASSERT_EQUAL_UINT32(5678, PulsePattern::ticks1(it));
+    TEST_ASSERT_FALSE(PulsePattern::level1(it));
+}
+
+// ============================================================================
+// Blink codes
+// ============================================================================
+
+void test_pulse_fast_blink_is_one_item_and_end_marker() {
+    PulsePattern p;
+    TEST_ASSERT_TRUE(p.compile(FAST_BLINK_PHASES, 2, TestConstants::TICK_US));
+    TEST_ASSERT_EQUAL_UINT8(2, p.itemCount());
+    TEST_ASSERT_EQUAL_HEX32(PulsePattern::item(1000, true, 1000, false), p.items()[0]);
+    TEST_ASSERT_EQUAL_HEX32(0, p.items()[1]);
+    TEST_ASSERT_EQUAL_UINT32(200, p.periodMs());
+}
+
+void test_pulse_double_blink_timing() {
+    PulsePattern p;
+    TEST_ASSERT_TRUE(p.compile(DOUBLE_BLINK_PHASES, 4, TestConstants::TICK_US));
+    TEST_ASSERT_EQUAL_UINT8(3, p.itemCount());
+    TEST_ASSERT_EQUAL_HEX32(PulsePattern::item(1500, true, 1500, false), p.items()[0]);
+    TEST_ASSERT_EQUAL_HEX32(PulsePattern::item(1500, true, 8000, false), p.items()[1]);
+    TEST_ASSERT_EQUAL_HEX32(0, p.items()[2]);
+    TEST_ASSERT_EQUAL_UINT32(1250, p.periodMs());
+}
+
+void test_pulse_blink_codes_match_software_timing() {
+    const PulsePhase* codes[] = { SLOW_BLINK_PHASES, FAST_BLINK_PHASES, DOUBLE_BLINK_PHASES };
+    const uint8_t lengths[] = { 2, 2, 4 };
+    for (int c = 0; c < 3; c++) {
+        PulsePattern p;
+        TEST_ASSERT_TRUE(p.compile(codes[c], lengths[c], TestConstants::TICK_US));
+        // Two full periods, so the wrap is covered
+        for (uint32_t ms = 0; ms < 2 * p.periodMs(); ms++) {
+            TEST_ASSERT_EQUAL(referenceLevel(codes[c], lengths[c], ms), p.levelAtMs(ms));
+        }
+    }
+}
+
+// ============================================================================
+// Horn cycle
+// ============================================================================
+
+void test_pulse_default_horn_cycle() {
+    const PulsePhase horn[] = { { true, 1000 }, { false, 1000 } };
+    PulsePattern p;
+    TEST_ASSERT_TRUE(p.compile(horn, 2, TestConstants::TICK_US));
+    TEST_ASSERT_EQUAL_UINT8(2, p.itemCount());
+    TEST_ASSERT_EQUAL_UINT32(2000, p.periodMs());
+    TEST_ASSERT_TRUE(p.levelAtMs(0));
+    TEST_ASSERT_TRUE(p.levelAtMs(999));
+    TEST_ASSERT_FALSE(p.levelAtMs(1000));
+    TEST_ASSERT_TRUE(p.levelAtMs(2000));
+}
+
+void test_pulse_long_phases_split_into_items() {
+    // MAX_HORN_DURATION_MS each way: 100000 ticks per phase, four halves each
+    const PulsePhase horn[] = { { true, 10000 }, { false, 10000 } };
+    PulsePattern p;
+    TEST_ASSERT_TRUE(p.compile(horn, 2, TestConstants::TICK_US));
+    TEST_ASSERT_EQUAL_UINT8(5, p.itemCount());
+    TEST_ASSERT_EQUAL_UINT32(200000, p.periodTicks());
+    for (uint8_t i = 0; i < 4; i++) {
+        bool on = i < 2;
+        TEST_ASSERT_EQUAL_HEX32(PulsePattern::item(25000, on, 25000, on), p.items()[i]);
+    }
+    TEST_ASSERT_EQUAL_HEX32(0, p.items()[4]);
+    TEST_ASSERT_TRUE(p.levelAtMs(9999));
+    TEST_ASSERT_FALSE(p.levelAtMs(10000));
+    TEST_ASSERT_FALSE(p.levelAtMs(19999));
+    TEST_ASSERT_TRUE(p.levelAtMs(20000));
+}
+
+void test_pulse_uneven_split_keeps_total() {
+    // 3.5 s = 35000 ticks: two halves of 17500
+    const PulsePhase horn[] = { { true, 3500 }, { false, 100 } };
+    PulsePattern p;
+    TEST_ASSERT_TRUE(p.compile(horn, 2, TestConstants::TICK_US));
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < p.itemCount(); i++) {
+        uint32_t it = p.items()[i];
+        TEST_ASSERT_TRUE(PulsePattern::ticks0(it) <= PulsePattern::MAX_TICKS);
+        TEST_ASSERT_TRUE(PulsePattern::ticks1(it) <= PulsePattern::MAX_TICKS);
+        sum += PulsePattern::ticks0(it) + PulsePattern::ticks1(it);
+    }
+    TEST_ASSERT_EQUAL_UINT32(36000, sum);
+    TEST_ASSERT_EQUAL_UINT32(36000, p.periodTicks());
+}
+
+void test_pulse_odd_halves_end_in_the_last_item() {
+    const PulsePhase phases[] = { { true, 1 }, { false, 2 }, { true, 3 } };
+    PulsePattern p;
+    TEST_ASSERT_TRUE(p.compile(phases, 3, TestConstants::TICK_US));
+    TEST_ASSERT_EQUAL_UINT8(2, p.itemCount());
+    TEST_ASSERT_EQUAL_HEX32(PulsePattern::item(30, true, 0, false), p.items()[1]);
+    TEST_ASSERT_TRUE(p.levelAtMs(5));
+    TEST_ASSERT_TRUE(p.levelAtMs(6));      // wrapped to the first phase
+    TEST_ASSERT_FALSE(p.levelAtMs(7));
+}
+
+// ============================================================================
+// Limits
+// ============================================================================
+
+void test_pulse_zero_phases_skipped_or_rejected() {
+    const PulsePhase phases[] = { { true, 0 }, { false, 200 }, { true, 0 }, { true, 100 } };
+    PulsePattern p;
+    TEST_ASSERT_TRUE(p.compile(phases, 4, TestConstants::TICK_US));
+    TEST_ASSERT_EQUAL_UINT8(2, p.itemCount());
+    TEST_ASSERT_FALSE(p.levelAtMs(0));
+    TEST_ASSERT_TRUE(p.levelAtMs(250));
+
+    const PulsePhase nothing[] = { { true, 0 }, { false, 0 } };
+    TEST_ASSERT_FALSE(p.compile(nothing, 2, TestConstants::TICK_US));
+    TEST_ASSERT_TRUE(p.empty());
+    TEST_ASSERT_FALSE(p.levelAtMs(123));
+    TEST_ASSERT_FALSE(p.compile(nullptr, 0, TestConstants::TICK_US));
+    TEST_ASSERT_FALSE(p.compile(FAST_BLINK_PHASES, 2, 0));
+}
+
+void test_pulse_tick_rounding() {
+    // 1 ms at a 300 us tick rounds to 3 ticks
+    const PulsePhase phases[] = { { true, 1 }, { false, 1 } };
+    PulsePattern p;
+    TEST_ASSERT_TRUE(p.compile(phases, 2, 300));
+    TEST_ASSERT_EQUAL_HEX32(PulsePattern::item(3, true, 3, false), p.items()[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, p.periodMs());    // 1.8 ms, truncated
+}
+
+void test_pulse_too_long_for_one_memory_block() {
+    // Exactly fills the block: 127 halves and the end marker in the last item
+    const PulsePhase fits[] = { { true, 127u * PulsePattern::MAX_TICKS / 10 } };
+    PulsePattern p;
+    TEST_ASSERT_TRUE(p.compile(fits, 1, TestConstants::TICK_US));
+    TEST_ASSERT_EQUAL_UINT8(PulsePattern::MAX_ITEMS, p.itemCount());
+    TEST_ASSERT_EQUAL_UINT32(0, PulsePattern::ticks1(p.items()[PulsePattern::MAX_ITEMS - 1]));
+
+    const PulsePhase tooLong[] = { { true, 128u * PulsePattern::MAX_TICKS / 10 } };
+    TEST_ASSERT_FALSE(p.compile(tooLong, 1, TestConstants::TICK_US));
+    TEST_ASSERT_TRUE(p.empty());
+
+    // A negative duration cast from the settings' int
+    const PulsePhase negative[] = { { true, (uint32_t)-1 }, { false, 1000 } };
+    TEST_ASSERT_FALSE(p.compile(negative, 2, TestConstants::TICK_US));
+}
+
+void test_pulse_equality_tracks_the_cadence() {
+    const PulsePhase a[] = { { true, 1000 }, { false, 1000 } };
+    const PulsePhase b[] = { { true, 1000 }, { false, 2000 } };
+    PulsePattern p1, p2;
+    p1.compile(a, 2, TestConstants::TICK_US);
+    p2.compile(a, 2, TestConstants::TICK_US);
+    TEST_ASSERT_TRUE(p1 == p2);
+    p2.compile(b, 2, TestConstants::TICK_US);
+    TEST_ASSERT_TRUE(p1 != p2);
+    p2.compile(a, 2, 200);
+    TEST_ASSERT_TRUE(p1 != p2);
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_pulse_item_layout_matches_rmt);
+
+    RUN_TEST(test_pulse_fast_blink_is_one_item_and_end_marker);
+    RUN_TEST(test_pulse_double_blink_timing);
+    RUN_TEST(test_pulse_blink_codes_match_software_timing);
+
+    RUN_TEST(test_pulse_default_horn_cycle);
+    RUN_TEST(test_pulse_long_phases_split_into_items);
+    RUN_TEST(test_pulse_uneven_split_keeps_total);
+    RUN_TEST(test_pulse_odd_halves_end_in_the_last_item);
+
+    RUN_TEST(test_pulse_zero_phases_skipped_or_rejected);
+    RUN_TEST(test_pulse_tick_rounding);
+    RUN_TEST(test_pulse_too_long_for_one_memory_block);
+    RUN_TEST(test_pulse_equality_tracks_the_cadence);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
@@ -0,0 +1,132 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+#include <math.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/RateEstimator.h"
+
+namespace TestConstants {
+    constexpr uint32_t TAU_MS       = 900000; // 15 min, as in WaterPressureSensor.h
+    constexpr uint32_t MIN_SPAN_MS  = 300000; // 5 min
+    constexpr int64_t  SAMPLE_US    = 1000000; // ~1 Hz decimated readings
+    constexpr int64_t  MIN_SPAN_US  = 300000000;
+}
+
+// Deterministic +/- amplitude noise so runs are reproducible
+static float noise(uint32_t& lcg, float amplitude) {
+    lcg = lcg * 1103515245u + 12345u;
+    return ((float)((lcg >> 16) % 2001) / 1000.0f - 1.0f) * amplitude;
+}
+
+// ============================================================================
+// Readiness
+// ============================================================================
+
+void test_rate_nan_before_min_span() {
+    RateEstimator r(TestConstants::TAU_MS, TestConstants::MIN_SPAN_MS);
+    for (int64_t t = 0; t < TestConstants::MIN_SPAN_US; t += TestConstants::SAMPLE_US) {
+        r.addSample(t, 10.0f);
+    }
+    TEST_ASSERT_FALSE(r.ready());
+    TEST_ASSERT_TRUE(isnan(r.slopePerMinute()));
+    TEST_ASSERT_TRUE(isnan(r.slopeStdErrPerMinute()));
+}
+
+void test_rate_ready_after_min_span() {
+    RateEstimator r(TestConstants::TAU_MS, TestConstants::MIN_SPAN_MS);
+    for (int64_t t = 0; t <= TestConstants::MIN_SPAN_US; t += TestConstants::SAMPLE_US) {
+        r.addSample(t, 10.0f);
+    }
+    TEST_ASSERT_TRUE(r.ready());
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 0.0f, r.slopePerMinute());
+}
+
+// ============================================================================
+// Slope accuracy
+// ============================================================================
+
+void test_rate_linear_ramp_exact() {
+    // 0.1 cm/min == 3 cm / 30 min
+    RateEstimator r(TestConstants::TAU_MS, TestConstants::MIN_SPAN_MS);
+    for (uint32_t i = 0; i < 1800; i++) {
+        r.addSample(i * TestConstants::SAMPLE_US, 20.0f + 0.1f * (i / 60.0f));
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 3.0f, r.slopePerMinute() * 30.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, r.slopeStdErrPerMinute() * 30.0f);
+}
+
+void test_rate_noisy_ramp_stable_with_small_stderr() {
+    RateEstimator r(TestConstants::TAU_MS, TestConstants::MIN_SPAN_MS);
+    uint32_t lcg = 42;
+    for (uint32_t i = 0; i < 3600; i++) {
+        r.addSample(i * TestConstants::SAMPLE_US, 20.0f + 0.1f * (i / 60.0f) + noise(lcg, 1.0f));
+    }
+    float rate = r.slopePerMinute() * 30.0f;
+    float err = r.slopeStdErrPerMinute() * 30.0f;
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, 3.0f, rate);
+    TEST_ASSERT_TRUE(err > 0.0f);
+    TEST_ASSERT_TRUE(err < 0.1f);
+}
+
+void test_rate_single_outlier_barely_moves_slope() {
+    // The old two-point estimate swung by the full outlier; the fit should not.
+    RateEstimator r(TestConstants::TAU_MS, TestConstants::MIN_SPAN_MS);
+    for (uint32_t i = 0; i < 1800; i++) {
+        float y = (i == 1799) ? 30.0f : 10.0f; // last sample spikes +20 cm
+        r.addSample(i * TestConstants::SAMPLE_US, y);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 0.0f, r.slopePerMinute() * 30.0f);
+}
+
+void test_rate_past_32bit_millis_range() {
+    // 49.7 days of uptime is where a 32-bit millis() would wrap; the 64-bit
+    // tick runs straight through it
+    RateEstimator r(TestConstants::TAU_MS, TestConstants::MIN_SPAN_MS);
+    int64_t t = (int64_t)0xFFFFFFFFu * 1000 - 600000000; // ~10 min before
+    for (uint32_t i = 0; i < 1800; i++) {
+        r.addSample(t, 5.0f - 0.05f * (i / 60.0f));
+        t += TestConstants::SAMPLE_US;
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, -1.5f, r.slopePerMinute() * 30.0f);
+}
+
+// ============================================================================
+// Gaps
+// ============================================================================
+
+void test_rate_long_gap_restarts_fit() {
+    RateEstimator r(TestConstants::TAU_MS, TestConstants::MIN_SPAN_MS);
+    for (uint32_t i = 0; i < 1800; i++) {
+        r.addSample(i * TestConstants::SAMPLE_US, 0.1f * (i / 60.0f));
+    }
+    TEST_ASSERT_TRUE(r.ready());
+
+    // Sensor fault: 2 hours with no valid readings, then one fresh sample
+    r.addSample(1800 * TestConstants::SAMPLE_US + 7200000000LL, 50.0f);
+    TEST_ASSERT_EQUAL(1, r.sampleCount());
+    TEST_ASSERT_FALSE(r.ready());
+    TEST_ASSERT_TRUE(isnan(r.slopePerMinute()));
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_rate_nan_before_min_span);
+    RUN_TEST(test_rate_ready_after_min_span);
+
+    RUN_TEST(test_rate_linear_ramp_exact);
+    RUN_TEST(test_rate_noisy_ramp_stable_with_small_stderr);
+    RUN_TEST(test_rate_single_outlier_barely_moves_slope);
+    RUN_TEST(test_rate_past_32bit_millis_range);
+
+    RUN_TEST(test_rate_long_gap_restarts_fit);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
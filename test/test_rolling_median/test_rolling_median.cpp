@@ -0,0 +1,151 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/RollingMedian.h"
+
+// ============================================================================
+// Basic window behaviour
+// ============================================================================
+
+void test_median_empty_window_is_zero() {
+    RollingMedian<5> m;
+    TEST_ASSERT_EQUAL(0, m.count());
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 0.0f, m.median());
+}
+
+void test_median_odd_count_returns_middle() {
+    RollingMedian<5> m;
+    m.push(true, 3.0f);
+    m.push(true, 1.0f);
+    m.push(true, 2.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 2.0f, m.median());
+}
+
+void test_median_even_count_averages_middle_pair() {
+    RollingMedian<5> m;
+    m.push(true, 4.0f);
+    m.push(true, 1.0f);
+    m.push(true, 3.0f);
+    m.push(true, 2.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 2.5f, m.median());
+}
+
+void test_median_rejects_single_spike() {
+    RollingMedian<5> m;
+    m.push(true, 10.0f);
+    m.push(true, 10.5f);
+    m.push(true, 95.0f); // slosh spike
+    m.push(true, 10.2f);
+    m.push(true, 10.1f);
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 10.2f, m.median());
+}
+
+// ============================================================================
+// Eviction and invalid samples
+// ============================================================================
+
+void test_median_evicts_oldest_when_full() {
+    RollingMedian<3> m;
+    m.push(true, 100.0f);
+    m.push(true, 100.0f);
+    m.push(true, 100.0f);
+    m.push(true, 1.0f);
+    m.push(true, 2.0f);
+    m.push(true, 3.0f); // all 100s evicted
+    TEST_ASSERT_EQUAL(3, m.count());
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 2.0f, m.median());
+}
+
+void test_median_invalid_samples_excluded() {
+    RollingMedian<5> m;
+    m.push(true, 5.0f);
+    m.push(false, 999.0f);
+    m.push(true, 7.0f);
+    TEST_ASSERT_EQUAL(2, m.count());
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 6.0f, m.median());
+}
+
+void test_median_invalid_samples_still_evict() {
+    // Matches the old filter: a window of all-invalid pushes has no median.
+    RollingMedian<3> m;
+    m.push(true, 5.0f);
+    m.push(true, 6.0f);
+    m.push(false, 0.0f);
+    m.push(false, 0.0f);
+    m.push(false, 0.0f);
+    TEST_ASSERT_EQUAL(0, m.count());
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 0.0f, m.median());
+}
+
+void test_median_matches_sorted_reference_over_long_run() {
+    // Deterministic pseudo-random stream; compare against a brute-force
+    // median of the same window at every step.
+    static const int N = 16;
+    RollingMedian<N> m;
+    float window[N];
+    bool valid[N];
+    int filled = 0;
+    uint32_t lcg = 12345;
+
+    for (int i = 0; i < 2000; i++) {
+        lcg = lcg * 1103515245u + 12345u;
+        float v = (float)((lcg >> 16) % 1000) / 10.0f;
+        bool ok = ((lcg >> 8) % 7) != 0;
+        m.push(ok, v);
+
+        window[i % N] = v;
+        valid[i % N] = ok;
+        if (filled < N) filled++;
+
+        float sorted[N];
+        int n = 0;
+        for (int k = 0; k < filled; k++) {
+            if (!valid[k]) continue;
+            // insertion sort
+            int j = n++;
+            while (j > 0 && sorted[j - 1] > window[k]) { sorted[j] = sorted[j - 1]; j--; }
+            sorted[j] = window[k];
+        }
+        float expected = 0.0f;
+        if (n > 0) {
+            expected = (n % 2) ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0f;
+        }
+        TEST_ASSERT_EQUAL(n, m.count());
+        TEST_ASSERT_FLOAT_WITHIN(0.0001f, expected, m.median());
+    }
+}
+
+void test_median_clear_resets_window() {
+    RollingMedian<4> m;
+    m.push(true, 1.0f);
+    m.push(true, 2.0f);
+    m.clear();
+    TEST_ASSERT_EQUAL(0, m.count());
+    m.push(true, 9.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 9.0f, m.median());
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_median_empty_window_is_zero);
+    RUN_TEST(test_median_odd_count_returns_middle);
+    RUN_TEST(test_median_even_count_averages_middle_pair);
+    RUN_TEST(test_median_rejects_single_spike);
+
+    RUN_TEST(test_median_evicts_oldest_when_full);
+    RUN_TEST(test_median_invalid_samples_excluded);
+    RUN_TEST(test_median_invalid_samples_still_evict);
+    RUN_TEST(test_median_matches_sorted_reference_over_long_run);
+    RUN_TEST(test_median_clear_resets_window);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
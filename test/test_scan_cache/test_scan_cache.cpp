@@ -0,0 +1,118 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+#include <string.h>
+#include <stdio.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/ScanCache.h"
+
+// ============================================================================
+// Ordering and de-duplication
+// ============================================================================
+
+void test_scan_sorted_strongest_first() {
+    ScanCache c;
+    TEST_ASSERT_TRUE(c.add("Slip42", -79, 1, false));
+    TEST_ASSERT_TRUE(c.add("MarinaGuest", -58, 6, true));
+    TEST_ASSERT_TRUE(c.add("DockWiFi", -64, 11, false));
+    TEST_ASSERT_EQUAL_UINT8(3, c.size());
+    TEST_ASSERT_EQUAL_STRING("MarinaGuest", c[0].ssid);
+    TEST_ASSERT_EQUAL_STRING("DockWiFi", c[1].ssid);
+    TEST_ASSERT_EQUAL_STRING("Slip42", c[2].ssid);
+    TEST_ASSERT_TRUE(c[0].open);
+    TEST_ASSERT_EQUAL_UINT8(11, c[1].channel);
+}
+
+void test_scan_duplicate_ssid_keeps_strongest_ap() {
+    ScanCache c;
+    c.add("DockWiFi", -80, 1, false);
+    c.add("Other", -70, 6, false);
+    // A second AP of the same mesh, stronger: raises the entry and its channel
+    TEST_ASSERT_TRUE(c.add("DockWiFi", -55, 11, false));
+    // A weaker one changes nothing
+    TEST_ASSERT_TRUE(c.add("DockWiFi", -90, 3, false));
+    TEST_ASSERT_EQUAL_UINT8(2, c.size());
+    TEST_ASSERT_EQUAL_STRING("DockWiFi", c[0].ssid);
+    TEST_ASSERT_EQUAL_INT(-55, c[0].rssi);
+    TEST_ASSERT_EQUAL_UINT8(11, c[0].channel);
+    TEST_ASSERT_EQUAL_INT(1, c.find("Other"));
+    TEST_ASSERT_EQUAL_INT(-1, c.find("Missing"));
+}
+
+void test_scan_skips_hidden_and_clamps_rssi() {
+    ScanCache c;
+    TEST_ASSERT_FALSE(c.add("", -40, 1, false));
+    TEST_ASSERT_FALSE(c.add(nullptr, -40, 1, false));
+    c.add("Loud", 5, 1, false);
+    c.add("Faint", -200, 1, false);
+    TEST_ASSERT_EQUAL_UINT8(2, c.size());
+    TEST_ASSERT_EQUAL_INT(0, c[0].rssi);
+    TEST_ASSERT_EQUAL_INT(-128, c[1].rssi);
+
+    // A 32-char SSID (the 802.11 max) is kept whole
+    const char* longest = "0123456789abcdef0123456789ABCDEF";
+    c.add(longest, -60, 1, false);
+    TEST_ASSERT_EQUAL_INT(1, c.find(longest));
+}
+
+// ============================================================================
+// Capacity and age
+// ============================================================================
+
+void test_scan_full_cache_evicts_weakest() {
+    ScanCache c;
+    char ssid[16];
+    for (int i = 0; i < ScanCache::CAPACITY; i++) {
+        snprintf(ssid, sizeof(ssid), "net-%02d", i);
+        c.add(ssid, -60 - i, 1, false);
+    }
+    TEST_ASSERT_EQUAL_UINT8(ScanCache::CAPACITY, c.size());
+    // Weaker than everything: dropped
+    TEST_ASSERT_FALSE(c.add("weak", -99, 1, false));
+    TEST_ASSERT_EQUAL_INT(-1, c.find("weak"));
+    // Stronger than the weakest: takes its slot, lands in order
+    TEST_ASSERT_TRUE(c.add("strong", -61, 1, false));
+    TEST_ASSERT_EQUAL_UINT8(ScanCache::CAPACITY, c.size());
+    TEST_ASSERT_EQUAL_INT(-1, c.find("net-15"));
+    TEST_ASSERT_TRUE(c.find("strong") >= 1 && c.find("strong") <= 2);
+    for (uint8_t i = 1; i < c.size(); i++) TEST_ASSERT_TRUE(c[i - 1].rssi >= c[i].rssi);
+}
+
+void test_scan_age_is_wrap_safe() {
+    ScanCache c;
+    TEST_ASSERT_FALSE(c.valid());
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, c.ageMs(1000));
+    c.stamp(0xFFFFF000u);
+    TEST_ASSERT_TRUE(c.valid());
+    TEST_ASSERT_EQUAL_UINT32(0x2000, c.ageMs(0x1000));
+
+    // A copy carries its results and stamp; clear() forgets both
+    ScanCache copy;
+    c.add("DockWiFi", -60, 6, false);
+    copy = c;
+    TEST_ASSERT_EQUAL_UINT8(1, copy.size());
+    TEST_ASSERT_TRUE(copy.valid());
+    c.clear();
+    TEST_ASSERT_EQUAL_UINT8(0, c.size());
+    TEST_ASSERT_FALSE(c.valid());
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_scan_sorted_strongest_first);
+    RUN_TEST(test_scan_duplicate_ssid_keeps_strongest_ap);
+    RUN_TEST(test_scan_skips_hidden_and_clamps_rssi);
+
+    RUN_TEST(test_scan_full_cache_evicts_weakest);
+    RUN_TEST(test_scan_age_is_wrap_safe);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
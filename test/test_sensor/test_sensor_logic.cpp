@@ -161,11 +161,8 @@ void test_two_point_calibration_extrapolation_above() {
 // TEST: Median Filtering (requires access to internal buffer)
 // ============================================================================
 
-// Note: Testing median filtering requires either:
-// 1. Making calculateMedianFromBuffer public or protected
-// 2. Testing it indirectly through readLevel()
-// 3. Creating a friend test class
-// For now, we'll test it indirectly through multiple reads
+// The median filter itself (RollingMedian) is covered directly in
+// test/test_rolling_median; here it is only exercised through readLevel().
 
 void test_median_filter_basic_reading() {
     WaterPressureSensor sensor(true);
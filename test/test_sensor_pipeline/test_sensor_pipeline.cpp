@@ -0,0 +1,507 @@
+#if defined(UNIT_TESTING) && defined(NATIVE_SENSOR_SHIM)
+
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+// The unit under test — the real src/WaterPressureSensor.cpp, built against
+// the test/shim platform stand-ins (Arduino, Wire, scripted ADS1115, FreeRTOS)
+#include "../../include/WaterPressureSensor.h"
+
+/*
+    Host harness for the real sensor pipeline: ALERT/RDY oversampling,
+    rolling median, flatline / range guards, rate fit, bus recovery and the
+    wake comparator, fed by the scripted ADS1115 in test/shim.
+
+    Each test builds a fresh sensor, scripts what the transducer sees, runs
+    init() and then drives readLevel() on every ALERT/RDY interrupt, or after
+    SAMPLER_WAIT_MS of virtual time without one — what the sampling task
+    does on the device.
+
+    The benchmark runs SENSOR_BENCH_SECONDS of a filling / pumping boat with
+    wave slosh and ADC noise and reports wall-clock ns per readLevel() call
+    and per published reading, and the filtered level's error against the
+    true (slosh-free) level. SENSOR_TRACE=<path> also replays a recorded
+    raw-code trace (one code per line at ADS_SAMPLE_RATE_SPS).
+
+    pio test -e native-sensor   runs only this suite, optimised
+*/
+
+#ifndef SENSOR_BENCH_SECONDS
+#define SENSOR_BENCH_SECONDS 3600
+#endif
+
+namespace TestConstants {
+    constexpr uint32_t SAMPLER_WAIT_MS = 10;   // WaterPressureSensor::SAMPLER_WAIT_MS
+    constexpr uint32_t WAKE_STEP_US = 50;      // virtual-time resolution of the wait
+    constexpr int      ZERO_MV = 600;          // 0 cm
+    constexpr int      SPAN_MV = 2600;         // SPAN_CM
+    constexpr float    SPAN_CM = 50.0f;
+    constexpr float    MV_PER_CM = (SPAN_MV - ZERO_MV) / SPAN_CM;
+    constexpr float    PI_F = 3.14159265f;
+    // Accuracy gates for the benchmark scenario (regressions fail the suite)
+    constexpr float    BENCH_RMS_MAX_CM = 0.35f;
+    constexpr float    BENCH_ABS_MAX_CM = 1.5f;
+}
+
+// ============================================================================
+// What the transducer sees
+// ============================================================================
+
+struct Water {
+    float    baseCm;
+    float    rampCmPerMin;
+    float    cycleCm;        // slow fill / pump-out sine around baseCm
+    float    cyclePeriodS;
+    float    sloshCm;        // wave slosh, averaged away by oversampling
+    float    sloshHz;
+    int      noiseCodes;     // uniform +/- ADC noise
+    float    stepCm;         // added from stepAtUs on
+    uint64_t stepAtUs;
+    uint32_t seed;
+};
+
+static Water calmWater(float level_cm) {
+    Water w = {};
+    w.baseCm = level_cm;
+    w.noiseCodes = 3;
+    w.stepAtUs = UINT64_MAX;
+    w.seed = 12345;
+    return w;
+}
+
+static float trueLevel(const Water& w, uint64_t us) {
+    float t = (float)((double)us / 1e6);
+    float level = w.baseCm + w.rampCmPerMin * t / 60.0f;
+    if (w.cyclePeriodS > 0) level += w.cycleCm * sinf(2 * TestConstants::PI_F * t / w.cyclePeriodS);
+    if (us >= w.stepAtUs) level += w.stepCm;
+    return level;
+}
+
+static int32_t codeForLevel(float level_cm) {
+    float mv = TestConstants::ZERO_MV + level_cm * TestConstants::MV_PER_CM;
+    return (int32_t)lroundf(mv * ADS_GAIN_ONE_CODES_PER_MV);
+}
+
+static int16_t waterSource(void* ctx, uint8_t, uint64_t us) {
+    Water& w = *static_cast<Water*>(ctx);
+    float t = (float)((double)us / 1e6);
+    float level = trueLevel(w, us) + w.sloshCm * sinf(2 * TestConstants::PI_F * w.sloshHz * t);
+    int32_t code = codeForLevel(level);
+    if (w.noiseCodes > 0) {
+        w.seed = w.seed * 1103515245u + 12345u;
+        code += (int32_t)((w.seed >> 16) % (uint32_t)(2 * w.noiseCodes + 1)) - w.noiseCodes;
+    }
+    if (code > 32767) code = 32767;
+    if (code < -32768) code = -32768;
+    return (int16_t)code;
+}
+
+// ============================================================================
+// Harness
+// ============================================================================
+
+static void setupSensor(WaterPressureSensor& sensor, Water& water) {
+    nativeI2cFault() = false;
+    nativeAds().setAlertPin(ADS_ALERT_PIN);
+    nativeAds().setRdyWired(true);
+    nativeAds().setSource(0, waterSource, &water);
+    sensor.setCalibrationPoint(0, TestConstants::ZERO_MV, 0.0f);
+    sensor.setCalibrationPoint(1, TestConstants::SPAN_MV, TestConstants::SPAN_CM);
+}
+
+struct RunStats {
+    uint32_t readings;
+    uint32_t invalid;
+    uint32_t calls;
+    SensorReading last;
+};
+
+// The sampling task's ulTaskNotifyTake(): returns once the RDY ISR has run
+// since the last wake (at once if it ran during readLevel()), or after
+// SAMPLER_WAIT_MS, never past endUs.
+static void waitForRdy(uint32_t& seenRuns, uint64_t endUs) {
+    uint64_t deadline = nativeClock().us + (uint64_t)TestConstants::SAMPLER_WAIT_MS * 1000;
+    if (deadline > endUs) deadline = endUs;
+    while (nativeIsrRuns(ADS_ALERT_PIN) == seenRuns && nativeClock().us < deadline) {
+        uint64_t step = deadline - nativeClock().us;
+        nativeAdvanceUs(step < TestConstants::WAKE_STEP_US ? step : TestConstants::WAKE_STEP_US);
+    }
+    seenRuns = nativeIsrRuns(ADS_ALERT_PIN);
+}
+
+// readLevel() on every wake for ms of virtual time, as the sampling task
+// does. onReading sees each newly published reading.
+typedef void (*ReadingFn)(const SensorReading& r, void* ctx);
+
+static RunStats runSampler(WaterPressureSensor& sensor, uint32_t ms,
+                           ReadingFn onReading = nullptr, void* ctx = nullptr) {
+    RunStats st = {};
+    int64_t lastTick = sensor.getLatestReading().tickUs;
+    uint32_t seenRuns = nativeIsrRuns(ADS_ALERT_PIN);
+    uint64_t endUs = nativeClock().us + (uint64_t)ms * 1000;
+    while (nativeClock().us < endUs) {
+        waitForRdy(seenRuns, endUs);
+        SensorReading r = sensor.readLevel();
+        st.calls++;
+        if (r.tickUs == lastTick) continue;
+        lastTick = r.tickUs;
+        st.readings++;
+        if (!r.valid) st.invalid++;
+        st.last = r;
+        if (onReading) onReading(r, ctx);
+    }
+    return st;
+}
+
+struct ErrorStats {
+    const Water* water;
+    uint64_t fromUs;
+    double   sumSq;
+    float    maxAbs;
+    uint32_t n;
+};
+
+static void trackError(const SensorReading& r, void* ctx) {
+    ErrorStats& e = *static_cast<ErrorStats*>(ctx);
+    if (!r.valid || (uint64_t)r.tickUs < e.fromUs) return;
+    float err = r.level_cm - trueLevel(*e.water, (uint64_t)r.tickUs);
+    e.sumSq += (double)err * err;
+    if (fabsf(err) > e.maxAbs) e.maxAbs = fabsf(err);
+    e.n++;
+}
+
+static float rms(const ErrorStats& e) { return e.n ? (float)sqrt(e.sumSq / e.n) : NAN; }
+
+void setUp() {
+    nativeI2cFault() = false;
+}
+
+void tearDown() {}
+
+// ============================================================================
+// Acquisition
+// ============================================================================
+
+void test_pipeline_init_reads_level_through_rdy() {
+    Water water = calmWater(20.0f);
+    WaterPressureSensor sensor(false);
+    setupSensor(sensor, water);
+
+    uint32_t conversionsBefore = nativeAds().conversions();
+    TEST_ASSERT_TRUE(sensor.init());
+    SensorReading r = sensor.getLatestReading();
+    TEST_ASSERT_TRUE(r.valid);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 20.0f, r.level_cm);
+
+    // ~1 Hz published readings, each averaging a second of conversions
+    conversionsBefore = nativeAds().conversions();
+    uint32_t readsBefore = nativeAds().reads();
+    uint32_t transactionsBefore = nativeWire().transactions;
+    RunStats st = runSampler(sensor, 10000);
+    TEST_ASSERT_TRUE(st.readings >= 9 && st.readings <= 11);
+    TEST_ASSERT_EQUAL(0, st.invalid);
+    uint32_t conversions = nativeAds().conversions() - conversionsBefore;
+    TEST_ASSERT_TRUE(conversions >= 10 * ADS_SAMPLE_RATE_SPS - 2);
+    // Every conversion is read (one I2C read per RDY edge), with the bus
+    // time of each read charged to the clock
+    uint32_t reads = nativeAds().reads() - readsBefore;
+    TEST_ASSERT_TRUE(reads >= conversions - 2);
+    TEST_ASSERT_EQUAL(0, sensor.getMissedConversionCount());
+    // Pointer write + read per conversion, no presence probe on top
+    TEST_ASSERT_EQUAL(2 * reads, nativeWire().transactions - transactionsBefore);
+}
+
+void test_pipeline_oversampling_and_median_reject_slosh() {
+    Water water = calmWater(25.0f);
+    water.sloshCm = 3.0f;      // +/- 3 cm waves at 1.3 Hz
+    water.sloshHz = 1.3f;
+    water.noiseCodes = 20;
+    WaterPressureSensor sensor(false);
+    setupSensor(sensor, water);
+    TEST_ASSERT_TRUE(sensor.init());
+
+    ErrorStats e = { &water, 0, 0.0, 0.0f, 0 };
+    e.fromUs = nativeClock().us + 15000000ULL; // median window filled
+    runSampler(sensor, 300000, trackError, &e);
+    TEST_ASSERT_TRUE(e.n > 250);
+    // Raw slosh alone is 2.1 cm RMS
+    TEST_ASSERT_TRUE(rms(e) < 0.3f);
+    TEST_ASSERT_TRUE(e.maxAbs < 1.0f);
+}
+
+void test_pipeline_step_reaches_median_within_window() {
+    Water water = calmWater(10.0f);
+    WaterPressureSensor sensor(false);
+    setupSensor(sensor, water);
+    TEST_ASSERT_TRUE(sensor.init());
+    runSampler(sensor, 15000);
+
+    water.stepCm = 20.0f;
+    water.stepAtUs = nativeClock().us;
+    uint32_t ms = 0;
+    while (ms < 30000 && sensor.getLatestReading().level_cm < 29.5f) {
+        runSampler(sensor, 100);
+        ms += 100;
+    }
+    // Median of READINGS_BUFFER_SIZE ~1 Hz samples flips past half the window
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, 30.0f, sensor.getLatestReading().level_cm);
+    TEST_ASSERT_TRUE(ms <= (READINGS_BUFFER_SIZE / 2 + 2) * 1000u);
+}
+
+// ============================================================================
+// Rate of change
+// ============================================================================
+
+void test_pipeline_rate_tracks_steady_fill() {
+    Water water = calmWater(10.0f);
+    water.rampCmPerMin = 10.0f / 30.0f;  // 10 cm per 30 min
+    water.sloshCm = 1.0f;
+    water.sloshHz = 0.9f;
+    water.noiseCodes = 10;
+    WaterPressureSensor sensor(false);
+    setupSensor(sensor, water);
+    TEST_ASSERT_TRUE(sensor.init());
+
+    runSampler(sensor, RATE_MIN_SPAN_MS - 60000);
+    TEST_ASSERT_TRUE(isnan(sensor.getRateOfChange_cm30min()));
+
+    runSampler(sensor, 20UL * 60000UL);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 10.0f, sensor.getRateOfChange_cm30min());
+    TEST_ASSERT_TRUE(sensor.getRateStdErr_cm30min() < 0.5f);
+}
+
+// ============================================================================
+// Calibration
+// ============================================================================
+
+void test_pipeline_clearing_table_keeps_legacy_zero() {
+    Water water = calmWater(10.0f);
+    WaterPressureSensor sensor(false);
+    setupSensor(sensor, water);
+    TEST_ASSERT_TRUE(sensor.init());
+
+    // 2.5 cm below the two-point zero: 550 mV, under its validity floor
+    water.baseCm = -2.5f;
+    runSampler(sensor, 2000);
+    TEST_ASSERT_FALSE(sensor.getLatestReading().valid);
+
+    // A table whose lowest point sits below the zero makes 550 mV valid...
+    const CalibrationPoint table[] = { { 500, 0.0f }, { 1550, 20.0f }, { 2600, 50.0f } };
+    TEST_ASSERT_TRUE(sensor.setCalibrationTable(table, 3));
+    TEST_ASSERT_EQUAL(TestConstants::ZERO_MV, sensor.getZeroPointMilliVolts());
+    runSampler(sensor, 2000);
+    TEST_ASSERT_TRUE(sensor.getLatestReading().valid);
+
+    // ...and clearing it restores the user's two-point line and floor
+    TEST_ASSERT_TRUE(sensor.setCalibrationTable(nullptr, 0));
+    TEST_ASSERT_EQUAL(TestConstants::ZERO_MV, sensor.getZeroPointMilliVolts());
+    TEST_ASSERT_TRUE(sensor.hasTwoPointCalibration());
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 0.0f, sensor.voltageToCentimeters(TestConstants::ZERO_MV));
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, TestConstants::SPAN_CM,
+                             sensor.voltageToCentimeters(TestConstants::SPAN_MV));
+    runSampler(sensor, 2000);
+    TEST_ASSERT_FALSE(sensor.getLatestReading().valid);
+}
+
+// ============================================================================
+// Fault handling
+// ============================================================================
+
+void test_pipeline_flatline_marks_readings_invalid() {
+    Water water = calmWater(15.0f);
+    water.noiseCodes = 0;       // a frozen line: the exact same code forever
+    WaterPressureSensor sensor(false);
+    setupSensor(sensor, water);
+    TEST_ASSERT_TRUE(sensor.init());
+
+    RunStats st = runSampler(sensor, (STUCK_SAMPLE_THRESHOLD - 10) * 1000u);
+    TEST_ASSERT_EQUAL(0, st.invalid);
+    st = runSampler(sensor, 20000);
+    TEST_ASSERT_FALSE(st.last.valid);
+
+    // One LSB of jitter is enough to prove the line is alive again
+    water.noiseCodes = 1;
+    runSampler(sensor, 3000);
+    TEST_ASSERT_TRUE(sensor.getLatestReading().valid);
+}
+
+void test_pipeline_silent_rdy_falls_back_to_polling() {
+    Water water = calmWater(18.0f);
+    WaterPressureSensor sensor(false);
+    setupSensor(sensor, water);
+    TEST_ASSERT_TRUE(sensor.init());
+    runSampler(sensor, 5000);
+
+    nativeAds().setRdyWired(false);  // ALERT/RDY wire lost
+    RunStats st = runSampler(sensor, ADS_RDY_TIMEOUT_MS + 10000);
+    // At most the window in flight is lost; polling keeps ~1 Hz
+    TEST_ASSERT_TRUE(st.readings >= 9);
+    TEST_ASSERT_TRUE(st.last.valid);
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, 18.0f, st.last.level_cm);
+}
+
+void test_pipeline_unwired_rdy_polls_from_boot() {
+    Water water = calmWater(12.0f);
+    WaterPressureSensor sensor(false);
+    setupSensor(sensor, water);
+    nativeAds().setRdyWired(false);
+    TEST_ASSERT_TRUE(sensor.init());
+    RunStats st = runSampler(sensor, 10000);
+    TEST_ASSERT_TRUE(st.readings >= 9 && st.readings <= 11);
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, 12.0f, st.last.level_cm);
+}
+
+void test_pipeline_bus_fault_reports_invalid_then_recovers() {
+    Water water = calmWater(22.0f);
+    WaterPressureSensor sensor(false);
+    setupSensor(sensor, water);
+    TEST_ASSERT_TRUE(sensor.init());
+    runSampler(sensor, 3000);
+
+    nativeI2cFault() = true;
+    RunStats st = runSampler(sensor, 5000);
+    // Invalid readings keep flowing so the state machine sees the fault
+    TEST_ASSERT_TRUE(st.invalid >= 3);
+    TEST_ASSERT_FALSE(st.last.valid);
+
+    nativeI2cFault() = false;
+    runSampler(sensor, 15000);
+    SensorReading r = sensor.getLatestReading();
+    TEST_ASSERT_TRUE(r.valid);
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, 22.0f, r.level_cm);
+    TEST_ASSERT_TRUE(sensor.getBusRecoveryCount() >= 1);
+}
+
+// ============================================================================
+// Low-power wake comparator
+// ============================================================================
+
+void test_pipeline_wake_comparator_latches_at_level() {
+    Water water = calmWater(10.0f);
+    water.noiseCodes = 0;
+    WaterPressureSensor sensor(false);
+    setupSensor(sensor, water);
+    TEST_ASSERT_TRUE(sensor.init());
+
+    TEST_ASSERT_TRUE(sensor.armWakeComparator(20.0f));
+    TEST_ASSERT_TRUE(nativeAds().comparatorMode());
+    TEST_ASSERT_EQUAL(8, nativeAds().samplesPerSecond());
+
+    water.rampCmPerMin = 1.0f;
+    water.baseCm = 10.0f - (float)((double)nativeClock().us / 60e6); // 10 cm now, +1 cm/min
+    uint32_t minutes = 0;
+    while (digitalRead(ADS_ALERT_PIN) == HIGH && minutes < 20 * 60) {
+        delay(1000);
+        minutes++;
+    }
+    float at = trueLevel(water, nativeClock().us);
+    TEST_ASSERT_EQUAL(LOW, digitalRead(ADS_ALERT_PIN));
+    // Fired within one second of ramp (1/60 cm) past the threshold
+    TEST_ASSERT_TRUE(at >= 20.0f - 0.02f && at < 20.0f + 0.05f);
+}
+
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+// Runs `seconds` of sampling and prints the cost and, against `water`'s true
+// level, the accuracy. With a trace the input replays it instead.
+static void benchScenario(const char* label, Water& water, const std::vector<int16_t>* trace,
+                          uint32_t seconds, bool gateAccuracy) {
+    WaterPressureSensor sensor(false);
+    setupSensor(sensor, water);
+    if (trace) {
+        nativeAds().setTrace(0, trace->data(), trace->size(), 1000000u / ADS_SAMPLE_RATE_SPS,
+                             nativeClock().us);
+    }
+    sensor.init();
+
+    ErrorStats e = { &water, nativeClock().us + 15000000ULL, 0.0, 0.0f, 0 };
+    auto t0 = std::chrono::steady_clock::now();
+    RunStats st = runSampler(sensor, seconds * 1000u, trace ? nullptr : trackError, &e);
+    auto t1 = std::chrono::steady_clock::now();
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+
+    printf("\n[SENSOR-BENCH] %s: %u s simulated, %u readLevel() calls, %u readings (%u invalid)\n",
+           label, seconds, st.calls, st.readings, st.invalid);
+    printf("[SENSOR-BENCH]   %.1f ns/call, %.0f ns/reading (incl. the ADS1115 model)\n",
+           st.calls ? ns / st.calls : 0.0, st.readings ? ns / st.readings : 0.0);
+    if (!trace) {
+        printf("[SENSOR-BENCH]   level error vs truth: rms=%.3f cm max=%.3f cm over %u readings\n",
+               rms(e), e.maxAbs, e.n);
+    }
+    printf("[SENSOR-BENCH]   rate=%.2f +/- %.2f cm/30min\n",
+           sensor.getRateOfChange_cm30min(), sensor.getRateStdErr_cm30min());
+
+    if (gateAccuracy) {
+        TEST_ASSERT_TRUE(e.n > seconds / 2);
+        TEST_ASSERT_TRUE(rms(e) < TestConstants::BENCH_RMS_MAX_CM);
+        TEST_ASSERT_TRUE(e.maxAbs < TestConstants::BENCH_ABS_MAX_CM);
+    }
+#ifdef SENSOR_BENCH_MAX_NS_PER_READING
+    TEST_ASSERT_TRUE(st.readings > 0 && ns / st.readings < SENSOR_BENCH_MAX_NS_PER_READING);
+#endif
+}
+
+void test_pipeline_benchmark_synthetic() {
+    // Slow fill / pump-out cycle with slosh and noise
+    Water water = calmWater(20.0f);
+    water.cycleCm = 10.0f;
+    water.cyclePeriodS = 7200.0f;
+    water.sloshCm = 2.0f;
+    water.sloshHz = 0.8f;
+    water.noiseCodes = 16;
+    benchScenario("synthetic", water, nullptr, SENSOR_BENCH_SECONDS, true);
+}
+
+void test_pipeline_benchmark_recorded_trace() {
+    const char* path = getenv("SENSOR_TRACE");
+    if (!path) {
+        TEST_IGNORE_MESSAGE("SENSOR_TRACE not set");
+        return;
+    }
+    FILE* f = fopen(path, "r");
+    TEST_ASSERT_NOT_NULL(f);
+    std::vector<int16_t> codes;
+    long code;
+    while (fscanf(f, "%ld", &code) == 1) codes.push_back((int16_t)code);
+    fclose(f);
+    TEST_ASSERT_TRUE(codes.size() >= ADS_SAMPLE_RATE_SPS);
+
+    Water unused = calmWater(0.0f);
+    benchScenario(path, unused, &codes, (uint32_t)(codes.size() / ADS_SAMPLE_RATE_SPS), false);
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_pipeline_init_reads_level_through_rdy);
+    RUN_TEST(test_pipeline_oversampling_and_median_reject_slosh);
+    RUN_TEST(test_pipeline_step_reaches_median_within_window);
+
+    RUN_TEST(test_pipeline_rate_tracks_steady_fill);
+
+    RUN_TEST(test_pipeline_clearing_table_keeps_legacy_zero);
+
+    RUN_TEST(test_pipeline_flatline_marks_readings_invalid);
+    RUN_TEST(test_pipeline_silent_rdy_falls_back_to_polling);
+    RUN_TEST(test_pipeline_unwired_rdy_polls_from_boot);
+    RUN_TEST(test_pipeline_bus_fault_reports_invalid_then_recovers);
+
+    RUN_TEST(test_pipeline_wake_comparator_latches_at_level);
+
+    RUN_TEST(test_pipeline_benchmark_synthetic);
+    RUN_TEST(test_pipeline_benchmark_recorded_trace);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING && NATIVE_SENSOR_SHIM
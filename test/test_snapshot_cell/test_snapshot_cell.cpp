@@ -0,0 +1,105 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/SnapshotCell.h"
+#include "../../include/StateMachine.h"   // AlarmSettings, the real payload
+
+static AlarmSettings withLevel(float cm) {
+    AlarmSettings s = ALARM_SETTINGS_DEFAULTS;
+    s.emergencyWaterLevel_cm = cm;
+    return s;
+}
+
+// ============================================================================
+// Versioning and refresh
+// ============================================================================
+
+void test_snapshot_starts_at_version_one_with_initial_value() {
+    SnapshotCell<AlarmSettings> cell(withLevel(25.0f));
+    TEST_ASSERT_EQUAL_UINT32(1, cell.version());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 25.0f, cell.read().emergencyWaterLevel_cm);
+}
+
+void test_snapshot_publish_bumps_version_and_value() {
+    SnapshotCell<AlarmSettings> cell(ALARM_SETTINGS_DEFAULTS);
+    for (int i = 1; i <= 5; i++) {
+        cell.publish(withLevel(10.0f * i));
+        TEST_ASSERT_EQUAL_UINT32(1 + i, cell.version());
+        TEST_ASSERT_FLOAT_WITHIN(0.001f, 10.0f * i, cell.read().emergencyWaterLevel_cm);
+    }
+}
+
+void test_snapshot_refresh_copies_only_on_change() {
+    SnapshotCell<AlarmSettings> cell(withLevel(30.0f));
+    AlarmSettings local = withLevel(-1.0f);
+    uint32_t seen = 0;
+
+    TEST_ASSERT_TRUE(cell.refresh(local, seen));   // first call always copies
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 30.0f, local.emergencyWaterLevel_cm);
+    TEST_ASSERT_EQUAL_UINT32(1, seen);
+
+    local.emergencyWaterLevel_cm = -1.0f;          // prove no copy happens
+    TEST_ASSERT_FALSE(cell.refresh(local, seen));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, -1.0f, local.emergencyWaterLevel_cm);
+
+    cell.publish(withLevel(42.0f));
+    TEST_ASSERT_TRUE(cell.refresh(local, seen));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 42.0f, local.emergencyWaterLevel_cm);
+    TEST_ASSERT_EQUAL_UINT32(2, seen);
+}
+
+// ============================================================================
+// Interleavings (what another core could do mid-copy)
+// ============================================================================
+
+void test_snapshot_read_survives_one_concurrent_publish() {
+    SnapshotCell<AlarmSettings> cell(withLevel(30.0f));
+    uint32_t v = cell.readBegin();
+    cell.publish(withLevel(99.0f));     // lands in the other buffer
+    TEST_ASSERT_TRUE(cell.readValid(v));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 30.0f, cell.peek(v).emergencyWaterLevel_cm);
+}
+
+void test_snapshot_read_during_write_sees_previous_value() {
+    SnapshotCell<AlarmSettings> cell(withLevel(30.0f));
+    AlarmSettings& pending = cell.writeBegin();
+    pending = withLevel(77.0f);         // half-written from the reader's view
+    uint32_t v = cell.readBegin();
+    TEST_ASSERT_EQUAL_UINT32(1, v);     // still the old version
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 30.0f, cell.peek(v).emergencyWaterLevel_cm);
+    TEST_ASSERT_TRUE(cell.readValid(v));
+    cell.writeCommit();
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 77.0f, cell.read().emergencyWaterLevel_cm);
+}
+
+void test_snapshot_read_rejected_when_its_buffer_is_reused() {
+    SnapshotCell<AlarmSettings> cell(withLevel(30.0f));
+    uint32_t v = cell.readBegin();
+    cell.publish(withLevel(40.0f));
+    cell.writeBegin() = withLevel(50.0f); // second publish starts on v's buffer
+    TEST_ASSERT_FALSE(cell.readValid(v));
+    cell.writeCommit();
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 50.0f, cell.read().emergencyWaterLevel_cm);
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_snapshot_starts_at_version_one_with_initial_value);
+    RUN_TEST(test_snapshot_publish_bumps_version_and_value);
+    RUN_TEST(test_snapshot_refresh_copies_only_on_change);
+
+    RUN_TEST(test_snapshot_read_survives_one_concurrent_publish);
+    RUN_TEST(test_snapshot_read_during_write_sees_previous_value);
+    RUN_TEST(test_snapshot_read_rejected_when_its_buffer_is_reused);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
@@ -0,0 +1,82 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/SpscRing.h"
+
+struct Item {
+    int id;
+    float value;
+};
+
+// ============================================================================
+// SpscRing tests
+// ============================================================================
+
+void test_ring_empty_pop_fails() {
+    SpscRing<Item, 4> ring;
+    Item out;
+    TEST_ASSERT_FALSE(ring.pop(out));
+    TEST_ASSERT_EQUAL(0, ring.size());
+}
+
+void test_ring_preserves_fifo_order() {
+    SpscRing<Item, 4> ring;
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(ring.push(Item{i, i * 1.5f}));
+    }
+    Item out;
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(ring.pop(out));
+        TEST_ASSERT_EQUAL(i, out.id);
+        TEST_ASSERT_FLOAT_WITHIN(0.0001f, i * 1.5f, out.value);
+    }
+    TEST_ASSERT_FALSE(ring.pop(out));
+}
+
+void test_ring_full_refuses_newest() {
+    SpscRing<Item, 4> ring;
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(ring.push(Item{i, 0.0f}));
+    }
+    TEST_ASSERT_FALSE(ring.push(Item{99, 0.0f}));
+    TEST_ASSERT_EQUAL(4, ring.size());
+
+    Item out;
+    TEST_ASSERT_TRUE(ring.pop(out));
+    TEST_ASSERT_EQUAL(0, out.id); // oldest survives, newest was refused
+}
+
+void test_ring_wraps_many_times() {
+    SpscRing<Item, 8> ring;
+    Item out;
+    int next = 0;
+    for (int round = 0; round < 1000; round++) {
+        for (int k = 0; k < 5; k++) {
+            TEST_ASSERT_TRUE(ring.push(Item{round * 5 + k, 0.0f}));
+        }
+        for (int k = 0; k < 5; k++) {
+            TEST_ASSERT_TRUE(ring.pop(out));
+            TEST_ASSERT_EQUAL(next++, out.id);
+        }
+    }
+    TEST_ASSERT_EQUAL(0, ring.size());
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_ring_empty_pop_fails);
+    RUN_TEST(test_ring_preserves_fifo_order);
+    RUN_TEST(test_ring_full_refuses_newest);
+    RUN_TEST(test_ring_wraps_many_times);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
@@ -355,7 +355,7 @@ void test_config_exits_after_server_timeout_via_full_update() {
 
     // Step 1: Full update transitions NORMAL → CONFIG
     StateMachineOutput out = updateStateMachine(ctx, reading, 1000, 0.0f, false);
-    TEST_ASSERT_TRUE(out.stateChanged);
+    TEST_ASSERT_TRUE(out.has(SM_EVENT_STATE_CHANGED));
     TEST_ASSERT_EQUAL(CONFIG, ctx.currentState);
 
     // Step 2: Next update — the in-CONFIG clear consumes the entry flag,
@@ -366,7 +366,7 @@ void test_config_exits_after_server_timeout_via_full_update() {
 
     // Step 3: Server times out (no client connected) — configServerActive=false
     out = updateStateMachine(ctx, reading, 245000, 0.0f, false);
-    TEST_ASSERT_TRUE(out.stateChanged);
+    TEST_ASSERT_TRUE(out.has(SM_EVENT_STATE_CHANGED));
     TEST_ASSERT_EQUAL(NORMAL, ctx.currentState);
 }
 
@@ -400,7 +400,7 @@ void test_config_mid_session_button_press_does_not_block_timeout_exit() {
 
     // Server later times out with no client activity — exit must not be blocked
     out = updateStateMachine(ctx, reading, 245000, 0.0f, false);
-    TEST_ASSERT_TRUE(out.stateChanged);
+    TEST_ASSERT_TRUE(out.has(SM_EVENT_STATE_CHANGED));
     TEST_ASSERT_EQUAL(NORMAL, ctx.currentState);
 }
 
@@ -565,6 +565,26 @@ void test_alert_pin_off_when_silenced() {
     TEST_ASSERT_FALSE(computeAlertPinState(ctx));
 }
 
+void test_alert_pin_mode_per_tier() {
+    StateMachineContext ctx = createDefaultContext();
+    ctx.currentState = NORMAL;
+    TEST_ASSERT_EQUAL(ALERT_PIN_OFF, computeAlertPinMode(ctx));
+
+    ctx.currentState = EMERGENCY;
+    ctx.urgentEmergencyConditions = false;
+    TEST_ASSERT_EQUAL(ALERT_PIN_SOLID, computeAlertPinMode(ctx));
+
+    // Tier 2 pulses whichever half of the horn cycle the timer is in
+    ctx.urgentEmergencyConditions = true;
+    ctx.hornCurrentlyOn = false;
+    TEST_ASSERT_EQUAL(ALERT_PIN_PULSING, computeAlertPinMode(ctx));
+    ctx.hornCurrentlyOn = true;
+    TEST_ASSERT_EQUAL(ALERT_PIN_PULSING, computeAlertPinMode(ctx));
+
+    ctx.notificationsSilenced = true;
+    TEST_ASSERT_EQUAL(ALERT_PIN_OFF, computeAlertPinMode(ctx));
+}
+
 // S3: the alert pin must not assert a flood indication off a stale reading.
 void test_alert_pin_off_on_sensor_fault() {
     StateMachineContext ctx = createDefaultContext();
@@ -578,6 +598,7 @@ void test_alert_pin_off_on_sensor_fault() {
     ctx.urgentEmergencyConditions = true;
     ctx.hornCurrentlyOn = true;
     TEST_ASSERT_FALSE(computeAlertPinState(ctx));
+    TEST_ASSERT_EQUAL(ALERT_PIN_OFF, computeAlertPinMode(ctx));
 }
 
 // ============================================================================
@@ -592,13 +613,13 @@ void test_full_update_normal_to_emergency() {
     StateMachineSensorReading reading = createEmergencyReading();
     StateMachineOutput output = updateStateMachine(ctx, reading, 1000, NAN, false);
 
-    TEST_ASSERT_FALSE(output.stateChanged); // Not yet, need timeout
+    TEST_ASSERT_FALSE(output.has(SM_EVENT_STATE_CHANGED)); // Not yet, need timeout
     TEST_ASSERT_TRUE(ctx.emergencyConditions);
     
     // Second update after timeout - should transition
     output = updateStateMachine(ctx, reading, 6001, NAN, false);
     
-    TEST_ASSERT_TRUE(output.stateChanged);
+    TEST_ASSERT_TRUE(output.has(SM_EVENT_STATE_CHANGED));
     TEST_ASSERT_EQUAL(EMERGENCY, output.newState);
     TEST_ASSERT_EQUAL(EMERGENCY, ctx.currentState);
 }
@@ -613,8 +634,12 @@ void test_full_update_emergency_notification() {
     StateMachineSensorReading reading = createEmergencyReading();
     StateMachineOutput output = updateStateMachine(ctx, reading, 10001, NAN, false);
 
-    TEST_ASSERT_TRUE(output.sendEmergencyNotification);
-    // Caller constructs the message from output.displayLevel_cm / output.sensorFaultActive
+    TEST_ASSERT_TRUE(output.has(SM_EVENT_EMERGENCY));
+    // The notifier formats the text from the queued event's payload
+    const StateMachineEventRecord* ev = output.find(SM_EVENT_EMERGENCY);
+    TEST_ASSERT_NOT_NULL(ev);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, TestConstants::EMERGENCY_LEVEL_CM, ev->emergency.level_cm);
+    TEST_ASSERT_FALSE(ev->emergency.sensorFault);
     TEST_ASSERT_EQUAL(10001, ctx.lastEmergencyMessageTime);
 }
 
@@ -629,10 +654,122 @@ void test_full_update_horn_activation() {
     StateMachineSensorReading reading = createUrgentEmergencyReading();
     StateMachineOutput output = updateStateMachine(ctx, reading, 2001, NAN, false);
 
-    TEST_ASSERT_TRUE(output.setHornState);
+    TEST_ASSERT_TRUE(output.has(SM_EVENT_HORN));
     TEST_ASSERT_TRUE(output.hornOn);
     TEST_ASSERT_TRUE(ctx.hornCurrentlyOn);
     TEST_ASSERT_TRUE(output.alertPinOn); // GPIO 26 mirrors the horn while pulsing
+    TEST_ASSERT_EQUAL(ALERT_PIN_PULSING, output.alertPinMode);
+}
+
+// ============================================================================
+// TEST: Multi-Compartment Selection
+// ============================================================================
+
+void test_compartment_wettest_valid_drives_update() {
+    StateMachineContext ctx = createDefaultContext();
+    StateMachineSensorReading comps[3] = {
+        createNormalReading(), createEmergencyReading(), createReading(true, 20.0f)
+    };
+    StateMachineSensorReading combined;
+
+    TEST_ASSERT_EQUAL(1, selectCompartment(ctx, comps, 3, &combined));
+    TEST_ASSERT_TRUE(combined.valid);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, TestConstants::EMERGENCY_LEVEL_CM, combined.level_cm);
+}
+
+void test_compartment_failure_reports_sensor_error_below_threshold() {
+    StateMachineContext ctx = createDefaultContext();
+    StateMachineSensorReading comps[2] = { createNormalReading(), createInvalidReading() };
+    float rates[2] = { NAN, NAN };
+
+    StateMachineOutput output = updateStateMachine(ctx, comps, rates, 2, 1000, false);
+
+    TEST_ASSERT_EQUAL(1, output.compartment);
+    TEST_ASSERT_TRUE(ctx.sensorError);
+    TEST_ASSERT_EQUAL(ERROR, ctx.currentState);
+}
+
+void test_compartment_failure_does_not_mask_flood_elsewhere() {
+    StateMachineContext ctx = createDefaultContext();
+    StateMachineSensorReading comps[2] = { createInvalidReading(), createEmergencyReading() };
+    float rates[2] = { NAN, 4.5f };
+
+    updateStateMachine(ctx, comps, rates, 2, 1000, false);
+    TEST_ASSERT_FALSE(ctx.sensorError);
+    TEST_ASSERT_TRUE(ctx.emergencyConditions);
+
+    StateMachineOutput output = updateStateMachine(ctx, comps, rates, 2, 6001, false);
+    TEST_ASSERT_EQUAL(EMERGENCY, ctx.currentState);
+    TEST_ASSERT_TRUE(output.has(SM_EVENT_EMERGENCY));
+    TEST_ASSERT_EQUAL(1, output.compartment);
+    const StateMachineEventRecord* ev = output.find(SM_EVENT_EMERGENCY);
+    TEST_ASSERT_NOT_NULL(ev);
+    TEST_ASSERT_EQUAL(1, ev->compartment);
+    TEST_ASSERT_EQUAL(2, ev->compartmentCount);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 4.5f, ev->emergency.rate_cm30min);
+}
+
+// ============================================================================
+// TEST: Event Queue
+// ============================================================================
+
+void test_events_sensor_failure_queues_down_time() {
+    StateMachineContext ctx = createDefaultContext();
+    StateMachineSensorReading bad = createInvalidReading();
+
+    updateStateMachine(ctx, bad, 1000, NAN, false);
+    StateMachineOutput output = updateStateMachine(ctx, bad, 1000 + SENSOR_ERROR_NOTIFY_DELAY_MS, NAN, false);
+
+    TEST_ASSERT_TRUE(output.has(SM_EVENT_SENSOR_FAILURE));
+    TEST_ASSERT_EQUAL(1, output.eventCount);
+    TEST_ASSERT_EQUAL(SM_EVENT_SENSOR_FAILURE, output.queue[0].type);
+    TEST_ASSERT_EQUAL_UINT32(SENSOR_ERROR_NOTIFY_DELAY_MS / 1000, output.queue[0].sensorFailure.downSeconds);
+}
+
+void test_events_recovery_queued_only_after_notified_failure() {
+    StateMachineContext ctx = createDefaultContext();
+    StateMachineSensorReading bad = createInvalidReading();
+    StateMachineSensorReading good = createNormalReading();
+
+    updateStateMachine(ctx, bad, 1000, NAN, false);
+    StateMachineOutput output = updateStateMachine(ctx, good, 2000, NAN, false);
+    TEST_ASSERT_FALSE(output.has(SM_EVENT_SENSOR_RECOVERED)); // never told the owner
+    TEST_ASSERT_NULL(output.find(SM_EVENT_SENSOR_RECOVERED));
+
+    updateStateMachine(ctx, bad, 3000, NAN, false);
+    updateStateMachine(ctx, bad, 3000 + SENSOR_ERROR_NOTIFY_DELAY_MS, NAN, false);
+    output = updateStateMachine(ctx, good, 4000 + SENSOR_ERROR_NOTIFY_DELAY_MS, NAN, false);
+    TEST_ASSERT_TRUE(output.has(SM_EVENT_SENSOR_RECOVERED));
+    TEST_ASSERT_NOT_NULL(output.find(SM_EVENT_SENSOR_RECOVERED));
+}
+
+void test_events_state_change_sets_bit_without_record() {
+    StateMachineContext ctx = createDefaultContext();
+    StateMachineSensorReading reading = createNormalReading();
+    ctx.configCommandReceived = true;
+
+    StateMachineOutput output = updateStateMachine(ctx, reading, 1000, NAN, false);
+
+    TEST_ASSERT_TRUE(output.has(SM_EVENT_STATE_CHANGED));
+    TEST_ASSERT_EQUAL(CONFIG, output.newState);
+    TEST_ASSERT_EQUAL(0, output.eventCount);   // nothing for the notifier
+}
+
+void test_events_urgent_flag_carried_in_emergency_payload() {
+    StateMachineContext ctx = createDefaultContext();
+    ctx.currentState = EMERGENCY;
+    ctx.urgentEmergencyConditions = true;
+    ctx.emergencyConditions = true;
+    ctx.lastEmergencyMessageTime = 0;
+    ctx.emergencyNotifFreq_ms = 10000;
+
+    StateMachineSensorReading reading = createUrgentEmergencyReading();
+    StateMachineOutput output = updateStateMachine(ctx, reading, 10001, 3.0f, false);
+
+    const StateMachineEventRecord* ev = output.find(SM_EVENT_EMERGENCY);
+    TEST_ASSERT_NOT_NULL(ev);
+    TEST_ASSERT_TRUE(ev->emergency.urgent);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 3.0f, ev->emergency.rate_cm30min);
 }
 
 // ============================================================================
@@ -647,9 +784,9 @@ void test_silence_toggle_enables_silence() {
     StateMachineOutput output = handleSilenceToggle(ctx);
     
     TEST_ASSERT_TRUE(ctx.notificationsSilenced);
-    TEST_ASSERT_TRUE(output.sendSilenceConfirmation);
-    // Note: handleSilenceToggle's contract is the boolean flags only; the
-    // confirmation text is built by the caller (main.cpp), not in output.message.
+    TEST_ASSERT_TRUE(output.has(SM_EVENT_SILENCED));
+    // The confirmation text is formatted by the notifier from the queued event
+    TEST_ASSERT_NOT_NULL(output.find(SM_EVENT_SILENCED));
 }
 
 void test_silence_toggle_disables_silence() {
@@ -660,7 +797,7 @@ void test_silence_toggle_disables_silence() {
     StateMachineOutput output = handleSilenceToggle(ctx);
     
     TEST_ASSERT_FALSE(ctx.notificationsSilenced);
-    TEST_ASSERT_TRUE(output.sendUnsilenceConfirmation);
+    TEST_ASSERT_TRUE(output.has(SM_EVENT_UNSILENCED));
 }
 
 void test_silence_toggle_turns_off_horn() {
@@ -671,7 +808,7 @@ void test_silence_toggle_turns_off_horn() {
     
     StateMachineOutput output = handleSilenceToggle(ctx);
     
-    TEST_ASSERT_TRUE(output.setHornState);
+    TEST_ASSERT_TRUE(output.has(SM_EVENT_HORN));
     TEST_ASSERT_FALSE(output.hornOn);
     TEST_ASSERT_FALSE(ctx.hornCurrentlyOn);
 }
@@ -684,7 +821,7 @@ void test_silence_toggle_only_works_in_emergency() {
     StateMachineOutput output = handleSilenceToggle(ctx);
     
     TEST_ASSERT_FALSE(ctx.notificationsSilenced);
-    TEST_ASSERT_FALSE(output.sendSilenceConfirmation);
+    TEST_ASSERT_FALSE(output.has(SM_EVENT_SILENCED));
 }
 
 // ============================================================================
@@ -701,7 +838,7 @@ void test_silence_cleared_on_return_to_normal() {
     StateMachineSensorReading reading = createNormalReading();
     StateMachineOutput output = updateStateMachine(ctx, reading, 6001, NAN, false);
 
-    TEST_ASSERT_TRUE(output.stateChanged);
+    TEST_ASSERT_TRUE(output.has(SM_EVENT_STATE_CHANGED));
     TEST_ASSERT_EQUAL(NORMAL, ctx.currentState);
     TEST_ASSERT_FALSE(ctx.notificationsSilenced);
 }
@@ -784,12 +921,24 @@ void runAllTests() {
     RUN_TEST(test_alert_pin_solid_in_tier1_emergency);
     RUN_TEST(test_alert_pin_follows_horn_in_tier2_emergency);
     RUN_TEST(test_alert_pin_off_when_silenced);
+    RUN_TEST(test_alert_pin_mode_per_tier);
     RUN_TEST(test_alert_pin_off_on_sensor_fault);
 
     // Full state machine update tests
     RUN_TEST(test_full_update_normal_to_emergency);
     RUN_TEST(test_full_update_emergency_notification);
     RUN_TEST(test_full_update_horn_activation);
+
+    // Multi-compartment selection tests
+    RUN_TEST(test_compartment_wettest_valid_drives_update);
+    RUN_TEST(test_compartment_failure_reports_sensor_error_below_threshold);
+    RUN_TEST(test_compartment_failure_does_not_mask_flood_elsewhere);
+
+    // Event bitmask and notification queue
+    RUN_TEST(test_events_sensor_failure_queues_down_time);
+    RUN_TEST(test_events_recovery_queued_only_after_notified_failure);
+    RUN_TEST(test_events_state_change_sets_bit_without_record);
+    RUN_TEST(test_events_urgent_flag_carried_in_emergency_payload);
     
     // Silence toggle tests
     RUN_TEST(test_silence_toggle_enables_silence);
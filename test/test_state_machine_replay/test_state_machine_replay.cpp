@@ -0,0 +1,437 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/StateMachine.h"
+
+/*
+    Replay harness for updateStateMachine().
+
+    Streams a level trace through the state machine the way loop() does —
+    one call per sensor reading, context initialised as in setup() — and
+    reports state transitions, notification decisions and nanoseconds per
+    step. Two trace sources:
+
+      - synthetic: a deterministic mix of calm water, slow fills that cross
+        both tiers, pump-outs, level hovering on a threshold and sensor
+        dropouts. REPLAY_SAMPLES steps (default 2,000,000 = ~23 days at
+        1 Hz), starting an hour before millis() wraps.
+
+      - recorded: the [STATUS] lines of a timestamped MQTT log
+        ("YYYY-MM-DD HH:MM:SS | topic payload", as in test-logs/mqtt_log.txt),
+        held at 1 Hz between the 10 s status samples. REPLAY_LOG overrides the
+        path; thresholds are taken from the log's [EVENT] lines when present.
+
+    pio test -e native        runs it alongside the other suites
+    pio test -e native-bench  runs only this suite, optimised, 10M steps
+*/
+
+#ifndef REPLAY_SAMPLES
+#define REPLAY_SAMPLES 2000000
+#endif
+
+namespace TestConstants {
+    constexpr uint32_t STEP_MS        = 1000;                   // sensor publish period
+    constexpr uint32_t START_MS       = 0xFFFFFFFFu - 3600000u; // wraps after 1 h
+    constexpr uint32_t SEED           = 0x5eed1234u;
+    constexpr const char* DEFAULT_LOG = "test-logs/mqtt_log.txt";
+}
+
+// ============================================================================
+// Replay harness
+// ============================================================================
+
+struct ReplayStats {
+    uint64_t steps;
+    uint64_t stepsInState[4];
+    uint32_t transitions[4][4];      // [from][to]
+    uint32_t emergencyNotifications;
+    uint32_t sensorFailureNotifications;
+    uint32_t sensorRecoveryNotifications;
+    uint32_t hornToggles;
+    uint32_t hornOutsideEmergency;   // invariant: must stay 0
+    uint32_t notificationTooSoon;    // invariant: must stay 0
+    double   nsPerStep;
+};
+
+struct TraceSample {
+    StateMachineSensorReading reading;
+    uint32_t time_ms;
+};
+
+class StateMachineReplay {
+public:
+    StateMachineReplay(const AlarmSettings& settings, uint32_t startMs) {
+        memset(&stats, 0, sizeof(stats));
+        // Mirror setup(): timers start at boot time, first alert immediate
+        ctx.setSettings(settings);
+        ctx.currentState                 = NORMAL;
+        ctx.lastStateChangeTime          = startMs;
+        ctx.emergencyConditionsTrueTime  = startMs;
+        ctx.emergencyConditionsFalseTime = startMs;
+        ctx.lastEmergencyMessageTime     = 0;
+        ctx.lastHornToggleTime           = 0;
+        ctx.sensorErrorTrueTime          = startMs;
+        ctx.lastSensorErrorNotifyTime    = 0;
+        lastNotificationMs = 0;
+        notifiedThisEpisode = false;
+    }
+
+    void run(const TraceSample* trace, size_t n) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; i++) {
+            step(trace[i].reading, trace[i].time_ms);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+        stats.nsPerStep = (n > 0) ? ns / (double)n : 0.0;
+    }
+
+    State state() const { return ctx.currentState; }
+
+    void print(const char* label) const {
+        static const char* names[4] = { "ERROR", "NORMAL", "EMERGENCY", "CONFIG" };
+        printf("\n[REPLAY] %s: %llu steps, %.1f ns/step\n", label,
+               (unsigned long long)stats.steps, stats.nsPerStep);
+        for (int s = 0; s < 4; s++) {
+            printf("[REPLAY]   %-9s %5.1f%% of steps\n", names[s],
+                   stats.steps ? 100.0 * (double)stats.stepsInState[s] / (double)stats.steps : 0.0);
+        }
+        for (int f = 0; f < 4; f++) {
+            for (int t = 0; t < 4; t++) {
+                if (stats.transitions[f][t]) {
+                    printf("[REPLAY]   %s -> %s: %u\n", names[f], names[t], stats.transitions[f][t]);
+                }
+            }
+        }
+        printf("[REPLAY]   notifications: emergency=%u sensor_failure=%u sensor_recovery=%u\n",
+               stats.emergencyNotifications, stats.sensorFailureNotifications,
+               stats.sensorRecoveryNotifications);
+        printf("[REPLAY]   horn toggles: %u\n", stats.hornToggles);
+    }
+
+    ReplayStats stats;
+
+private:
+    StateMachineContext ctx;
+    uint32_t lastNotificationMs;
+    bool     notifiedThisEpisode;
+
+    void step(const StateMachineSensorReading& reading, uint32_t now) {
+        State before = ctx.currentState;
+        StateMachineOutput out = updateStateMachine(ctx, reading, now, NAN);
+
+        stats.steps++;
+        stats.stepsInState[ctx.currentState]++;
+        if (out.has(SM_EVENT_STATE_CHANGED)) {
+            stats.transitions[before][out.newState]++;
+            if (out.newState != EMERGENCY) notifiedThisEpisode = false;
+        }
+        if (out.has(SM_EVENT_EMERGENCY)) {
+            // Repeat alerts within one EMERGENCY episode honour the interval
+            if (notifiedThisEpisode &&
+                now - lastNotificationMs < (uint32_t)ctx.emergencyNotifFreq_ms) {
+                stats.notificationTooSoon++;
+            }
+            notifiedThisEpisode = true;
+            lastNotificationMs = now;
+            stats.emergencyNotifications++;
+        }
+        if (out.has(SM_EVENT_SENSOR_FAILURE)) stats.sensorFailureNotifications++;
+        if (out.has(SM_EVENT_SENSOR_RECOVERED)) stats.sensorRecoveryNotifications++;
+        if (out.has(SM_EVENT_HORN)) stats.hornToggles++;
+        if (ctx.hornCurrentlyOn && ctx.currentState != EMERGENCY) stats.hornOutsideEmergency++;
+    }
+};
+
+// ============================================================================
+// Trace sources
+// ============================================================================
+
+// xorshift32 — deterministic across hosts, unlike rand()
+static uint32_t nextRandom(uint32_t& s) {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+}
+
+static float uniform(uint32_t& s, float lo, float hi) {
+    return lo + (hi - lo) * (float)(nextRandom(s) >> 8) / 16777216.0f;
+}
+
+// Episodes of calm water, fill-to-tier-2 and pump-out, threshold hover and
+// sensor dropout, each ~10 min to ~3 h long, with +/-0.3 cm sample noise.
+static std::vector<TraceSample> makeSyntheticTrace(size_t n, const AlarmSettings& s,
+                                                   uint32_t seed) {
+    std::vector<TraceSample> trace;
+    trace.reserve(n);
+    uint32_t rng = seed;
+    uint32_t now = TestConstants::START_MS;
+    float level = 2.0f;
+
+    while (trace.size() < n) {
+        uint32_t kind = nextRandom(rng) % 8;
+        uint32_t len  = 600 + nextRandom(rng) % 10200;
+        float target  = level;
+        float rate    = 0.0f; // cm per step
+        bool  dropout = false;
+        float hover   = 0.0f;
+
+        if (kind <= 3) {                      // calm, drifting back to the bilge floor
+            target = uniform(rng, 0.0f, 5.0f);
+        } else if (kind <= 5) {               // fill past tier 2, or pump out
+            target = (level < s.emergencyWaterLevel_cm)
+                         ? s.urgentEmergencyWaterLevel_cm + uniform(rng, 1.0f, 15.0f)
+                         : uniform(rng, 0.0f, 5.0f);
+            rate = uniform(rng, 0.005f, 0.1f);
+        } else if (kind == 6) {               // sitting on a threshold
+            hover = (nextRandom(rng) & 1) ? s.emergencyWaterLevel_cm
+                                          : s.urgentEmergencyWaterLevel_cm;
+            len = 60 + nextRandom(rng) % 600;
+        } else {                              // sensor dropout
+            dropout = true;
+            len = 5 + nextRandom(rng) % 240;
+        }
+
+        for (uint32_t i = 0; i < len && trace.size() < n; i++) {
+            TraceSample t;
+            t.time_ms = now;
+            now += TestConstants::STEP_MS;
+
+            if (dropout) {
+                t.reading.valid = false;
+                t.reading.level_cm = -10.0f;
+            } else if (hover != 0.0f) {
+                t.reading.valid = true;
+                t.reading.level_cm = hover + uniform(rng, -0.05f, 0.05f);
+                level = hover;
+            } else {
+                if (rate > 0.0f) {
+                    if (level < target) level = fminf(level + rate, target);
+                    else level = fmaxf(level - rate, target);
+                } else {
+                    level += (target - level) * 0.01f;
+                }
+                t.reading.valid = true;
+                t.reading.level_cm = level + uniform(rng, -0.3f, 0.3f);
+            }
+            trace.push_back(t);
+        }
+    }
+    return trace;
+}
+
+static long daysFromCivil(int y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const long era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = (unsigned)(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (long)doe - 719468;
+}
+
+struct RecordedLog {
+    std::vector<TraceSample> trace;
+    std::vector<State> recordedState;       // per trace sample, from the log
+    std::vector<bool>  isStatusSample;      // true where the log had a [STATUS] line
+    AlarmSettings settings;
+    uint32_t recordedTransitions;           // "[STATE] Transitioning from" lines
+    uint32_t recordedAlerts;                // "Sending alert message" lines
+};
+
+static bool parseStateName(const char* name, State& out) {
+    if (strncmp(name, "NORMAL", 6) == 0)    { out = NORMAL;    return true; }
+    if (strncmp(name, "EMERGENCY", 9) == 0) { out = EMERGENCY; return true; }
+    if (strncmp(name, "ERROR", 5) == 0)     { out = ERROR;     return true; }
+    if (strncmp(name, "CONFIG", 6) == 0)    { out = CONFIG;    return true; }
+    return false;
+}
+
+// Reads "YYYY-MM-DD HH:MM:SS | <topic> [STATUS] State=X, WaterLevel=L cm,
+// SensorError=E, ..." lines and zero-order-holds them onto the 1 Hz grid.
+static bool loadRecordedLog(const char* path, RecordedLog& log) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+
+    log.settings = ALARM_SETTINGS_DEFAULTS;
+    log.recordedTransitions = 0;
+    log.recordedAlerts = 0;
+    char line[512];
+    bool havePrev = false;
+    long prevSec = 0;
+    TraceSample prev;
+    State prevState = NORMAL;
+    long firstSec = 0;
+
+    while (fgets(line, sizeof(line), f)) {
+        int y, mo, d, h, mi, se;
+        if (sscanf(line, "%d-%d-%d %d:%d:%d", &y, &mo, &d, &h, &mi, &se) != 6) continue;
+        long sec = daysFromCivil(y, (unsigned)mo, (unsigned)d) * 86400L + h * 3600L + mi * 60L + se;
+
+        const char* p;
+        float thr;
+        if ((p = strstr(line, "Tier 1 Emergency conditions detected")) &&
+            (p = strstr(p, "threshold=")) && sscanf(p, "threshold=%f", &thr) == 1) {
+            log.settings.emergencyWaterLevel_cm = thr;
+            continue;
+        }
+        if ((p = strstr(line, "Tier 2 URGENT Emergency conditions detected")) &&
+            (p = strstr(p, "threshold=")) && sscanf(p, "threshold=%f", &thr) == 1) {
+            log.settings.urgentEmergencyWaterLevel_cm = thr;
+            continue;
+        }
+
+        if (strstr(line, "[STATE] Transitioning from")) { log.recordedTransitions++; continue; }
+        if (strstr(line, "Sending alert message"))      { log.recordedAlerts++;      continue; }
+
+        if (!(p = strstr(line, "[STATUS] State="))) continue;
+        char stateName[16];
+        float level;
+        int sensorError;
+        if (sscanf(p, "[STATUS] State=%15[A-Z], WaterLevel=%f cm, SensorError=%d",
+                   stateName, &level, &sensorError) != 3) continue;
+        State recorded;
+        if (!parseStateName(stateName, recorded)) continue;
+
+        if (!havePrev) firstSec = sec;
+        if (havePrev) {
+            // Hold the previous sample until this one's timestamp
+            for (long s = prevSec + 1; s < sec; s++) {
+                prev.time_ms = TestConstants::START_MS + (uint32_t)((s - firstSec) * 1000);
+                log.trace.push_back(prev);
+                log.recordedState.push_back(prevState);
+                log.isStatusSample.push_back(false);
+            }
+        }
+        TraceSample t;
+        t.time_ms = TestConstants::START_MS + (uint32_t)((sec - firstSec) * 1000);
+        t.reading.valid = (sensorError == 0);
+        t.reading.level_cm = level;
+        log.trace.push_back(t);
+        log.recordedState.push_back(recorded);
+        log.isStatusSample.push_back(true);
+
+        prev = t;
+        prevSec = sec;
+        prevState = recorded;
+        havePrev = true;
+    }
+    fclose(f);
+    return !log.trace.empty();
+}
+
+// ============================================================================
+// Synthetic replay
+// ============================================================================
+
+void test_replay_synthetic_trace() {
+    std::vector<TraceSample> trace =
+        makeSyntheticTrace(REPLAY_SAMPLES, ALARM_SETTINGS_DEFAULTS, TestConstants::SEED);
+
+    StateMachineReplay replay(ALARM_SETTINGS_DEFAULTS, TestConstants::START_MS);
+    replay.run(trace.data(), trace.size());
+    replay.print("synthetic");
+
+    const ReplayStats& st = replay.stats;
+    TEST_ASSERT_EQUAL_UINT64(REPLAY_SAMPLES, st.steps);
+    TEST_ASSERT_EQUAL_UINT64(st.steps, st.stepsInState[ERROR] + st.stepsInState[NORMAL] +
+                                       st.stepsInState[EMERGENCY] + st.stepsInState[CONFIG]);
+
+    // The trace exercises every path it was built for...
+    TEST_ASSERT_GREATER_THAN(0, st.transitions[NORMAL][EMERGENCY]);
+    TEST_ASSERT_GREATER_THAN(0, st.transitions[EMERGENCY][NORMAL]);
+    TEST_ASSERT_GREATER_THAN(0, st.transitions[NORMAL][ERROR]);
+    TEST_ASSERT_GREATER_THAN(0, st.transitions[ERROR][NORMAL]);
+    TEST_ASSERT_GREATER_THAN(0, st.sensorFailureNotifications);
+    TEST_ASSERT_GREATER_THAN(0, st.hornToggles);
+
+    // ...and the safety invariants hold over all of it.
+    TEST_ASSERT_EQUAL_UINT32(0, st.transitions[NORMAL][CONFIG]); // no button presses in trace
+    TEST_ASSERT_EQUAL_UINT32(0, st.hornOutsideEmergency);
+    TEST_ASSERT_EQUAL_UINT32(0, st.notificationTooSoon);
+    TEST_ASSERT_GREATER_OR_EQUAL(st.transitions[NORMAL][EMERGENCY], st.emergencyNotifications);
+    TEST_ASSERT_LESS_OR_EQUAL(st.sensorFailureNotifications, st.sensorRecoveryNotifications);
+}
+
+void test_replay_is_deterministic() {
+    const size_t n = 200000;
+    std::vector<TraceSample> trace =
+        makeSyntheticTrace(n, ALARM_SETTINGS_DEFAULTS, TestConstants::SEED);
+
+    StateMachineReplay a(ALARM_SETTINGS_DEFAULTS, TestConstants::START_MS);
+    StateMachineReplay b(ALARM_SETTINGS_DEFAULTS, TestConstants::START_MS);
+    a.run(trace.data(), trace.size());
+    b.run(trace.data(), trace.size());
+
+    TEST_ASSERT_EQUAL_MEMORY(a.stats.transitions, b.stats.transitions, sizeof(a.stats.transitions));
+    TEST_ASSERT_EQUAL_MEMORY(a.stats.stepsInState, b.stats.stepsInState, sizeof(a.stats.stepsInState));
+    TEST_ASSERT_EQUAL_UINT32(a.stats.emergencyNotifications, b.stats.emergencyNotifications);
+    TEST_ASSERT_EQUAL_UINT32(a.stats.hornToggles, b.stats.hornToggles);
+    TEST_ASSERT_EQUAL(a.state(), b.state());
+}
+
+// ============================================================================
+// Recorded replay
+// ============================================================================
+
+void test_replay_recorded_log() {
+    const char* path = getenv("REPLAY_LOG");
+    if (!path) path = TestConstants::DEFAULT_LOG;
+
+    RecordedLog log;
+    if (!loadRecordedLog(path, log)) {
+        TEST_IGNORE_MESSAGE("no recorded log (set REPLAY_LOG or run from the project root)");
+        return;
+    }
+
+    StateMachineReplay replay(log.settings, TestConstants::START_MS);
+    uint32_t statusSamples = 0;
+    uint32_t agreeing = 0;
+    for (size_t i = 0; i < log.trace.size(); i++) {
+        replay.run(&log.trace[i], 1);
+        if (log.isStatusSample[i]) {
+            statusSamples++;
+            if (replay.state() == log.recordedState[i]) agreeing++;
+        }
+    }
+    replay.stats.nsPerStep = 0.0; // per-sample run() calls: timing not meaningful here
+    replay.print(path);
+    printf("[REPLAY]   thresholds: tier1=%.2f cm tier2=%.2f cm\n",
+           log.settings.emergencyWaterLevel_cm, log.settings.urgentEmergencyWaterLevel_cm);
+    printf("[REPLAY]   recorded: %u transitions, %u alerts (alert interval is a device setting the log doesn't carry)\n",
+           log.recordedTransitions, log.recordedAlerts);
+    printf("[REPLAY]   state agrees with the log at %u of %u status samples\n",
+           agreeing, statusSamples);
+
+    const ReplayStats& st = replay.stats;
+    TEST_ASSERT_EQUAL_UINT32(0, st.hornOutsideEmergency);
+    TEST_ASSERT_EQUAL_UINT32(0, st.notificationTooSoon);
+    // The 10 s status cadence blurs transition edges by up to one sample, so
+    // compare loosely: the replay must track the recorded state nearly always.
+    TEST_ASSERT_GREATER_OR_EQUAL(statusSamples * 95 / 100, agreeing);
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_replay_synthetic_trace);
+    RUN_TEST(test_replay_is_deterministic);
+
+    RUN_TEST(test_replay_recorded_log);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
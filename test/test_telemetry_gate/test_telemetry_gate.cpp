@@ -0,0 +1,100 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+#include <math.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/TelemetryGate.h"
+
+static const uint32_t HEARTBEAT_MS = 15UL * 60000UL;
+
+static TelemetryGate makeGate() {
+    return TelemetryGate(1.0f, 0.5f, HEARTBEAT_MS);
+}
+
+// ============================================================================
+// Deadbands
+// ============================================================================
+
+void test_gate_first_sample_always_reports() {
+    TelemetryGate g = makeGate();
+    TEST_ASSERT_EQUAL(TelemetryGate::REASON_FIRST, g.check(0, 10.0f, 0.0f, 0));
+    g.sent(0, 10.0f, 0.0f, 0);
+    TEST_ASSERT_EQUAL(TelemetryGate::REASON_NONE, g.check(10000, 10.0f, 0.0f, 0));
+}
+
+void test_gate_level_deadband_measured_from_last_sent() {
+    TelemetryGate g = makeGate();
+    g.sent(0, 10.0f, 0.0f, 0);
+    TEST_ASSERT_EQUAL(TelemetryGate::REASON_NONE, g.check(10000, 10.6f, 0.0f, 0));
+    TEST_ASSERT_EQUAL(TelemetryGate::REASON_NONE, g.check(20000, 9.1f, 0.0f, 0));
+    // A slow creep adds up: 0.4 + 0.4 + 0.3 past the last sent value
+    TEST_ASSERT_EQUAL(TelemetryGate::REASON_LEVEL, g.check(30000, 11.1f, 0.0f, 0));
+}
+
+void test_gate_rate_deadband() {
+    TelemetryGate g = makeGate();
+    g.sent(0, 10.0f, 0.2f, 0);
+    TEST_ASSERT_EQUAL(TelemetryGate::REASON_NONE, g.check(10000, 10.0f, 0.5f, 0));
+    TEST_ASSERT_EQUAL(TelemetryGate::REASON_RATE, g.check(10000, 10.0f, 0.8f, 0));
+}
+
+// ============================================================================
+// Discrete changes and validity
+// ============================================================================
+
+void test_gate_discrete_change_reports_immediately() {
+    TelemetryGate g = makeGate();
+    g.sent(0, 10.0f, 0.0f, 1);
+    TEST_ASSERT_EQUAL(TelemetryGate::REASON_DISCRETE, g.check(100, 10.0f, 0.0f, 2));
+}
+
+void test_gate_nan_transitions_are_reported_once() {
+    TelemetryGate g = makeGate();
+    g.sent(0, 10.0f, NAN, 0);
+    // The rate becoming available is a change; a still-missing rate isn't
+    TEST_ASSERT_EQUAL(TelemetryGate::REASON_NONE, g.check(1000, 10.0f, NAN, 0));
+    TEST_ASSERT_EQUAL(TelemetryGate::REASON_VALIDITY, g.check(1000, 10.0f, 0.1f, 0));
+
+    g.sent(1000, 10.0f, 0.1f, 0);
+    TEST_ASSERT_EQUAL(TelemetryGate::REASON_VALIDITY, g.check(2000, NAN, 0.1f, 0));
+    g.sent(2000, NAN, 0.1f, 0);
+    TEST_ASSERT_EQUAL(TelemetryGate::REASON_NONE, g.check(3000, NAN, 0.1f, 0));
+}
+
+// ============================================================================
+// Heartbeat and reset
+// ============================================================================
+
+void test_gate_heartbeat_and_reset() {
+    TelemetryGate g = makeGate();
+    uint32_t t0 = 0xFFFF0000u;          // heartbeat arithmetic survives millis() wrap
+    g.sent(t0, 10.0f, 0.0f, 0);
+    TEST_ASSERT_EQUAL(TelemetryGate::REASON_NONE, g.check(t0 + HEARTBEAT_MS - 1, 10.0f, 0.0f, 0));
+    TEST_ASSERT_EQUAL(TelemetryGate::REASON_HEARTBEAT, g.check(t0 + HEARTBEAT_MS, 10.0f, 0.0f, 0));
+
+    g.reset();
+    TEST_ASSERT_EQUAL(TelemetryGate::REASON_FIRST, g.check(t0 + 1, 10.0f, 0.0f, 0));
+    TEST_ASSERT_EQUAL_STRING("heartbeat", TelemetryGate::reasonName(TelemetryGate::REASON_HEARTBEAT));
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_gate_first_sample_always_reports);
+    RUN_TEST(test_gate_level_deadband_measured_from_last_sent);
+    RUN_TEST(test_gate_rate_deadband);
+
+    RUN_TEST(test_gate_discrete_change_reports_immediately);
+    RUN_TEST(test_gate_nan_transitions_are_reported_once);
+
+    RUN_TEST(test_gate_heartbeat_and_reset);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
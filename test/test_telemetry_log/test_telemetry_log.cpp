@@ -0,0 +1,182 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+#include <string.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/TelemetryLog.h"
+
+// NOR-flash stand-in: erase sets 0xFF, write can only clear bits.
+class RamFlash : public FlashRegion {
+public:
+    explicit RamFlash(size_t sectors) : bytes(sectors * TelemetryLog::SECTOR) {
+        memset(mem, 0xFF, sizeof(mem));
+    }
+    size_t size() const override { return bytes; }
+    bool read(size_t off, void* out, size_t len) override {
+        memcpy(out, mem + off, len);
+        return true;
+    }
+    bool write(size_t off, const void* data, size_t len) override {
+        const uint8_t* p = (const uint8_t*)data;
+        for (size_t i = 0; i < len; i++) mem[off + i] &= p[i];
+        writes++;
+        return true;
+    }
+    bool erase(size_t off, size_t len) override {
+        memset(mem + off, 0xFF, len);
+        erases++;
+        return true;
+    }
+
+    uint8_t  mem[4 * TelemetryLog::SECTOR];
+    size_t   bytes;
+    uint32_t writes = 0;
+    uint32_t erases = 0;
+};
+
+static TelemetryRecord reading(float level) {
+    TelemetryRecord r;
+    memset(&r, 0, sizeof(r));
+    r.time = 1760000000;
+    r.level_cc = TelemetryRecord::toCenti(level);
+    r.rate_cc = TelemetryRecord::toCenti(NAN);
+    r.flags = TelemetryRecord::FLAG_VALID;
+    return r;
+}
+
+// ============================================================================
+// Records
+// ============================================================================
+
+void test_record_centi_conversion() {
+    TEST_ASSERT_EQUAL_INT16(4210, TelemetryRecord::toCenti(42.1f));
+    TEST_ASSERT_EQUAL_INT16(-50, TelemetryRecord::toCenti(-0.5f));
+    TEST_ASSERT_EQUAL_INT16(32767, TelemetryRecord::toCenti(1000.0f));
+    TEST_ASSERT_EQUAL_INT16(TelemetryRecord::LEVEL_NONE, TelemetryRecord::toCenti(NAN));
+    TEST_ASSERT_TRUE(isnan(TelemetryRecord::fromCenti(TelemetryRecord::LEVEL_NONE)));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 42.1f, TelemetryRecord::fromCenti(4210));
+}
+
+void test_log_rejects_small_region() {
+    RamFlash flash(1);
+    TelemetryLog log;
+    TEST_ASSERT_FALSE(log.begin(&flash));
+    TEST_ASSERT_FALSE(log.ready());
+    TEST_ASSERT_FALSE(log.append(reading(1.0f)));
+}
+
+// ============================================================================
+// Append / read
+// ============================================================================
+
+void test_log_append_and_read_back() {
+    RamFlash flash(4);
+    TelemetryLog log;
+    TEST_ASSERT_TRUE(log.begin(&flash));
+    TEST_ASSERT_EQUAL_UINT32(0, log.nextSeq());
+    for (int i = 0; i < 10; i++) TEST_ASSERT_TRUE(log.append(reading(10.0f + i)));
+    TEST_ASSERT_EQUAL_UINT32(10, log.nextSeq());
+    TEST_ASSERT_EQUAL_UINT32(0, log.oldestSeq());
+
+    TelemetryRecord r;
+    TEST_ASSERT_TRUE(log.read(7, r));
+    TEST_ASSERT_EQUAL_UINT32(7, r.seq);
+    TEST_ASSERT_EQUAL_INT16(1700, r.level_cc);
+    TEST_ASSERT_FALSE(log.read(10, r));
+    // One erase for the first sector, one write per record
+    TEST_ASSERT_EQUAL_UINT32(1, flash.erases);
+    TEST_ASSERT_EQUAL_UINT32(10, flash.writes);
+}
+
+void test_log_recovers_head_after_reboot() {
+    RamFlash flash(4);
+    {
+        TelemetryLog log;
+        log.begin(&flash);
+        for (int i = 0; i < 300; i++) log.append(reading((float)i));
+    }
+    TelemetryLog again;
+    TEST_ASSERT_TRUE(again.begin(&flash));
+    TEST_ASSERT_EQUAL_UINT32(300, again.nextSeq());
+    TelemetryRecord r;
+    TEST_ASSERT_TRUE(again.read(299, r));
+    TEST_ASSERT_EQUAL_INT16(29900, r.level_cc);
+}
+
+// ============================================================================
+// Sector rotation
+// ============================================================================
+
+void test_log_rotates_sectors_and_drops_oldest() {
+    RamFlash flash(4);                           // 1024 slots
+    TelemetryLog log;
+    log.begin(&flash);
+    const uint32_t total = 1024 + 300;
+    for (uint32_t i = 0; i < total; i++) log.append(reading((float)(i % 100)));
+
+    // After wrapping, the sector being filled has lost its old contents:
+    // three full sectors plus the 44 records written into the fourth
+    TEST_ASSERT_EQUAL_UINT32(total - (3 * 256 + 300 % 256), log.oldestSeq());
+    TelemetryRecord r;
+    TEST_ASSERT_FALSE(log.read(log.oldestSeq() - 1, r));
+    TEST_ASSERT_TRUE(log.read(log.oldestSeq(), r));
+    TEST_ASSERT_EQUAL_UINT32(log.oldestSeq(), r.seq);
+    // Every sector erased evenly: 4 on the first lap, 2 more on the second
+    TEST_ASSERT_EQUAL_UINT32(6, flash.erases);
+
+    TelemetryLog again;
+    again.begin(&flash);
+    TEST_ASSERT_EQUAL_UINT32(total, again.nextSeq());
+}
+
+void test_log_recovers_from_erase_without_write() {
+    RamFlash flash(2);                           // 512 slots
+    TelemetryLog log;
+    log.begin(&flash);
+    for (int i = 0; i < 512; i++) log.append(reading(1.0f));
+    // Power cut right after erasing sector 0 for seq 512
+    flash.erase(0, TelemetryLog::SECTOR);
+
+    TelemetryLog again;
+    again.begin(&flash);
+    TEST_ASSERT_EQUAL_UINT32(512, again.nextSeq());
+    TEST_ASSERT_TRUE(again.append(reading(2.0f)));
+    TelemetryRecord r;
+    TEST_ASSERT_TRUE(again.read(512, r));
+    TEST_ASSERT_TRUE(again.read(511, r));
+}
+
+void test_log_skips_torn_record() {
+    RamFlash flash(2);
+    TelemetryLog log;
+    log.begin(&flash);
+    for (int i = 0; i < 5; i++) log.append(reading(1.0f));
+    flash.mem[2 * sizeof(TelemetryRecord) + 8] ^= 0x10;     // corrupt seq 2's level
+
+    TelemetryRecord r;
+    TEST_ASSERT_FALSE(log.read(2, r));
+    TEST_ASSERT_TRUE(log.read(3, r));
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_record_centi_conversion);
+    RUN_TEST(test_log_rejects_small_region);
+
+    RUN_TEST(test_log_append_and_read_back);
+    RUN_TEST(test_log_recovers_head_after_reboot);
+
+    RUN_TEST(test_log_rotates_sectors_and_drops_oldest);
+    RUN_TEST(test_log_recovers_from_erase_without_write);
+    RUN_TEST(test_log_skips_torn_record);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
@@ -0,0 +1,135 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/TopicTrie.h"
+
+// Collects visited ids as a bit mask
+static void collect(uint8_t id, void* arg) {
+    *(uint32_t*)arg |= (1u << id);
+}
+
+static uint32_t matches(const TopicTrie& t, const char* topic) {
+    uint32_t mask = 0;
+    t.match(topic, collect, &mask);
+    return mask;
+}
+
+// ============================================================================
+// Filter validation
+// ============================================================================
+
+void test_trie_validates_filters() {
+    TEST_ASSERT_TRUE(TopicTrie::validFilter("a/b/c"));
+    TEST_ASSERT_TRUE(TopicTrie::validFilter("a/+/c"));
+    TEST_ASSERT_TRUE(TopicTrie::validFilter("a/#"));
+    TEST_ASSERT_TRUE(TopicTrie::validFilter("#"));
+    TEST_ASSERT_TRUE(TopicTrie::validFilter("a//b"));
+    TEST_ASSERT_FALSE(TopicTrie::validFilter(""));
+    TEST_ASSERT_FALSE(TopicTrie::validFilter("a/#/c"));
+    TEST_ASSERT_FALSE(TopicTrie::validFilter("a/b#"));
+    TEST_ASSERT_FALSE(TopicTrie::validFilter("a/+b/c"));
+
+    TopicTrie t;
+    TEST_ASSERT_FALSE(t.insert("a/#/c", 0));
+    TEST_ASSERT_EQUAL_UINT8(0, t.linksUsed());
+}
+
+// ============================================================================
+// Matching
+// ============================================================================
+
+void test_trie_exact_and_plus() {
+    TopicTrie t;
+    t.insert("boat/a1/cmd/silence", 0);
+    t.insert("boat/+/cmd/silence", 1);
+    t.insert("boat/a1/cmd/+", 2);
+    t.insert("boat/a1/cmd", 3);
+
+    TEST_ASSERT_EQUAL_HEX32(0x7, matches(t, "boat/a1/cmd/silence"));
+    TEST_ASSERT_EQUAL_HEX32(0x2, matches(t, "boat/b2/cmd/silence"));
+    TEST_ASSERT_EQUAL_HEX32(0x4, matches(t, "boat/a1/cmd/ota"));
+    TEST_ASSERT_EQUAL_HEX32(0x8, matches(t, "boat/a1/cmd"));
+    // '+' is exactly one level
+    TEST_ASSERT_EQUAL_HEX32(0x0, matches(t, "boat/a1/cmd/ota/now"));
+    TEST_ASSERT_EQUAL_HEX32(0x0, matches(t, "boat/cmd/silence"));
+}
+
+void test_trie_hash_matches_parent_and_below() {
+    TopicTrie t;
+    t.insert("boat/a1/#", 0);
+    t.insert("#", 1);
+
+    TEST_ASSERT_EQUAL_HEX32(0x3, matches(t, "boat/a1"));
+    TEST_ASSERT_EQUAL_HEX32(0x3, matches(t, "boat/a1/cmd/threshold/level"));
+    TEST_ASSERT_EQUAL_HEX32(0x2, matches(t, "boat"));
+    TEST_ASSERT_EQUAL_HEX32(0x2, matches(t, "other/topic"));
+}
+
+void test_trie_dollar_topics_skip_leading_wildcards() {
+    TopicTrie t;
+    t.insert("#", 0);
+    t.insert("+/broker/uptime", 1);
+    t.insert("$SYS/broker/uptime", 2);
+    t.insert("$SYS/#", 3);
+
+    TEST_ASSERT_EQUAL_HEX32(0xC, matches(t, "$SYS/broker/uptime"));
+    TEST_ASSERT_EQUAL_HEX32(0x3, matches(t, "x/broker/uptime"));
+}
+
+void test_trie_empty_levels_and_duplicates() {
+    TopicTrie t;
+    t.insert("a//b", 0);
+    t.insert("a/+/b", 1);
+    int calls = 0;
+    // The same id under two filters is visited once per filter
+    t.insert("a/#", 2);
+    t.insert("a/+/+", 2);
+    TEST_ASSERT_EQUAL_size_t(4, t.match("a//b", [](uint8_t, void* arg) { (*(int*)arg)++; }, &calls));
+    TEST_ASSERT_EQUAL_INT(4, calls);
+    TEST_ASSERT_EQUAL_HEX32(0x6, matches(t, "a/x/b"));
+}
+
+// ============================================================================
+// Capacity
+// ============================================================================
+
+void test_trie_shares_prefixes_and_reports_full() {
+    TopicTrie t;
+    char filter[48];
+    for (uint8_t i = 0; i < TopicTrie::MAX_LINKS; i++) {
+        snprintf(filter, sizeof(filter), "boat/a1b2c3/cmd/c%u", i);
+        TEST_ASSERT_TRUE(t.insert(filter, i));
+    }
+    // root + 3 shared levels + one leaf per command
+    TEST_ASSERT_EQUAL_UINT8(4 + TopicTrie::MAX_LINKS, t.nodesUsed());
+    TEST_ASSERT_FALSE(t.insert("boat/a1b2c3/cmd/extra", 0));
+
+    uint32_t mask = 0;
+    TEST_ASSERT_EQUAL_size_t(1, t.match("boat/a1b2c3/cmd/c17", collect, &mask));
+    TEST_ASSERT_EQUAL_HEX32(1u << 17, mask);
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_trie_validates_filters);
+
+    RUN_TEST(test_trie_exact_and_plus);
+    RUN_TEST(test_trie_hash_matches_parent_and_below);
+    RUN_TEST(test_trie_dollar_topics_skip_leading_wildcards);
+    RUN_TEST(test_trie_empty_levels_and_duplicates);
+
+    RUN_TEST(test_trie_shares_prefixes_and_reports_full);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING
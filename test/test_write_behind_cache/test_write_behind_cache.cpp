@@ -0,0 +1,152 @@
+#ifdef UNIT_TESTING
+
+#include <unity.h>
+#include <string.h>
+
+// The unit under test — header-only, pure C++, no ESP32 dependencies
+#include "../../include/WriteBehindCache.h"
+
+typedef WriteBehindCache<4, 64> Cache;
+
+static bool putInt(Cache& c, const char* ns, const char* key, int32_t v, uint32_t now) {
+    return c.put(ns, key, Cache::T_INT, &v, sizeof(v), now);
+}
+
+static int32_t pendingInt(const Cache& c, const char* ns, const char* key) {
+    const Cache::Entry* e = c.find(ns, key);
+    TEST_ASSERT_NOT_NULL(e);
+    TEST_ASSERT_EQUAL_UINT8(Cache::T_INT, e->type);
+    int32_t v;
+    memcpy(&v, c.data(*e), sizeof(v));
+    return v;
+}
+
+// ============================================================================
+// Coalescing
+// ============================================================================
+
+void test_cache_coalesces_same_key() {
+    Cache c;
+    for (int32_t v = 0; v < 20; v++) TEST_ASSERT_TRUE(putInt(c, "emergency", "horn_on_ms", v, 100));
+    TEST_ASSERT_EQUAL_UINT8(1, c.size());
+    TEST_ASSERT_EQUAL_UINT32(19, c.coalescedCount());
+    TEST_ASSERT_EQUAL_INT32(19, pendingInt(c, "emergency", "horn_on_ms"));
+    // Same key in another namespace is a separate write
+    TEST_ASSERT_TRUE(putInt(c, "ota_config", "horn_on_ms", 7, 100));
+    TEST_ASSERT_EQUAL_UINT8(2, c.size());
+    TEST_ASSERT_EQUAL_INT32(19, pendingInt(c, "emergency", "horn_on_ms"));
+}
+
+void test_cache_remove_overrides_put_and_back() {
+    Cache c;
+    putInt(c, "calib", "point2_mv", 1500, 0);
+    TEST_ASSERT_TRUE(c.put("calib", "point2_mv", Cache::T_REMOVE, nullptr, 0, 0));
+    TEST_ASSERT_EQUAL_UINT8(Cache::T_REMOVE, c.find("calib", "point2_mv")->type);
+    putInt(c, "calib", "point2_mv", 1600, 0);
+    TEST_ASSERT_EQUAL_INT32(1600, pendingInt(c, "calib", "point2_mv"));
+    TEST_ASSERT_EQUAL_UINT8(1, c.size());
+}
+
+void test_cache_rejects_bad_names_and_full_table() {
+    Cache c;
+    TEST_ASSERT_FALSE(putInt(c, "emergency", "a_key_that_is_too_long", 1, 0));
+    TEST_ASSERT_FALSE(putInt(c, nullptr, "k", 1, 0));
+    putInt(c, "n", "k1", 1, 0);
+    putInt(c, "n", "k2", 2, 0);
+    putInt(c, "n", "k3", 3, 0);
+    putInt(c, "n", "k4", 4, 0);
+    TEST_ASSERT_FALSE(putInt(c, "n", "k5", 5, 0));
+    // Updating a pending key still works when the table is full
+    TEST_ASSERT_TRUE(putInt(c, "n", "k2", 22, 0));
+    TEST_ASSERT_EQUAL_INT32(22, pendingInt(c, "n", "k2"));
+}
+
+// ============================================================================
+// Value pool
+// ============================================================================
+
+void test_cache_compacts_pool_on_growth() {
+    Cache c;
+    // Two 20-byte strings and a short one, then regrow the first: the
+    // stale copies are reclaimed instead of failing
+    const char* a = "aaaaaaaaaaaaaaaaaaa";
+    const char* b = "bbbbbbbbbbbbbbbbbbb";
+    TEST_ASSERT_TRUE(c.put("notify", "a", Cache::T_STRING, a, 20, 0));
+    TEST_ASSERT_TRUE(c.put("notify", "b", Cache::T_STRING, b, 20, 0));
+    TEST_ASSERT_TRUE(c.put("notify", "c", Cache::T_STRING, "c", 2, 0));
+    const char* longer = "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA";   // 40 with NUL
+    TEST_ASSERT_TRUE(c.put("notify", "a", Cache::T_STRING, longer, 40, 0));
+    TEST_ASSERT_EQUAL_size_t(62, c.poolBytesUsed());
+
+    TEST_ASSERT_EQUAL_STRING(longer, (const char*)c.data(*c.find("notify", "a")));
+    TEST_ASSERT_EQUAL_STRING(b, (const char*)c.data(*c.find("notify", "b")));
+    TEST_ASSERT_EQUAL_STRING("c", (const char*)c.data(*c.find("notify", "c")));
+
+    // A value that can never fit is refused, old value kept
+    char huge[70];
+    memset(huge, 'h', sizeof(huge));
+    TEST_ASSERT_FALSE(c.put("notify", "b", Cache::T_BYTES, huge, sizeof(huge), 0));
+    TEST_ASSERT_EQUAL_STRING(b, (const char*)c.data(*c.find("notify", "b")));
+}
+
+// ============================================================================
+// Commit timing
+// ============================================================================
+
+void test_cache_due_after_quiet_period_or_max_delay() {
+    Cache c;
+    TEST_ASSERT_FALSE(c.due(0, 2000, 10000));
+    putInt(c, "emergency", "level_cm", 30, 1000);
+    TEST_ASSERT_FALSE(c.due(2999, 2000, 10000));
+    TEST_ASSERT_TRUE(c.due(3000, 2000, 10000));
+
+    // A slider drag: one put every 500 ms keeps it quiet-pending, until the
+    // max delay from the first put forces a commit
+    Cache drag;
+    uint32_t t = 0xFFFFF000u;                    // across the millis() wrap
+    for (int i = 0; i < 19; i++, t += 500) {
+        putInt(drag, "emergency", "level_cm", i, t);
+        TEST_ASSERT_FALSE(drag.due(t + 499, 2000, 10000));
+    }
+    putInt(drag, "emergency", "level_cm", 19, t);
+    TEST_ASSERT_FALSE(drag.due(t + 499, 2000, 10000));
+    TEST_ASSERT_TRUE(drag.due(t + 500, 2000, 10000));      // 10 s after the first
+    TEST_ASSERT_EQUAL_UINT8(1, drag.size());
+}
+
+void test_cache_take_moves_batch_and_resets() {
+    Cache c;
+    Cache batch;
+    putInt(c, "emergency", "level_cm", 30, 0);
+    c.put("notify", "sms.phone", Cache::T_STRING, "+15550100", 10, 0);
+    c.take(batch);
+
+    TEST_ASSERT_TRUE(c.empty());
+    TEST_ASSERT_EQUAL_size_t(0, c.poolBytesUsed());
+    TEST_ASSERT_FALSE(c.due(100000, 2000, 10000));
+    TEST_ASSERT_EQUAL_UINT8(2, batch.size());
+    TEST_ASSERT_TRUE(batch.hasNamespace("notify"));
+    TEST_ASSERT_EQUAL_INT32(30, pendingInt(batch, "emergency", "level_cm"));
+    TEST_ASSERT_EQUAL_STRING("+15550100", (const char*)batch.data(*batch.find("notify", "sms.phone")));
+}
+
+// ============================================================================
+// Test runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_cache_coalesces_same_key);
+    RUN_TEST(test_cache_remove_overrides_put_and_back);
+    RUN_TEST(test_cache_rejects_bad_names_and_full_table);
+
+    RUN_TEST(test_cache_compacts_pool_on_growth);
+
+    RUN_TEST(test_cache_due_after_quiet_period_or_max_delay);
+    RUN_TEST(test_cache_take_moves_batch_and_resets);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TESTING